@@ -1,8 +1,8 @@
 // -----------------------------------------------------------------------------
 // src/app.cpp
 // GTK application setup
-// Creates the GTK application, window, periodic refresh task, and backend warm
-// up task used during startup.
+// Creates the GTK application, window, installed-change monitor, idle memory
+// reclaim, and backend warm up task used during startup.
 // -----------------------------------------------------------------------------
 #include "app.hpp"
 
@@ -10,34 +10,44 @@
 #include "debug_trace.hpp"
 #include "dnf_backend/dnf_backend.hpp"
 #include "i18n.hpp"
+#include "trace_spans.hpp"
+#include "transaction_service_client.hpp"
+#include "ui/idle_memory_reclaim.hpp"
+#include "ui/installed_change_monitor.hpp"
 #include "ui/main_window.hpp"
+#include "ui/package_query_controller.hpp"
+#include "ui/search_prewarm.hpp"
+#include "ui/task_executor.hpp"
 #include "ui/ui_helpers.hpp"
 #include "ui/widgets.hpp"
 #include "ui/widgets_internal.hpp"
 
-#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
 #include <gtk/gtk.h>
 
 // -----------------------------------------------------------------------------
 // Function forward declarations
 // -----------------------------------------------------------------------------
 static void activate(GtkApplication *app, gpointer user_data);
-static void setup_periodic_tasks(void);
-static gboolean on_periodic_installed_refresh_tick(gpointer user_data);
-static void start_installed_refresh_task(void);
-static void
-on_installed_refresh_task(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable);
-static void on_installed_refresh_task_finished(GObject *source_object, GAsyncResult *result, gpointer user_data);
+static void configure_backend_scan_workers(void);
+static void configure_backend_startup_mode(void);
+static void configure_backend_repo_load_parallelism(void);
+static void watch_repo_load_progress(SearchWidgets *widgets);
+static void show_repo_load_report(SearchWidgets *widgets);
 static void startup_warmup_data_free(gpointer data);
 static gboolean start_backend_warmup_idle(gpointer user_data);
 static void start_backend_warmup_task(SearchWidgets *widgets);
 static void on_backend_warmup_task(GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable);
 static void on_backend_warmup_task_finished(GObject *source_object, GAsyncResult *result, gpointer user_data);
-#ifdef DNFUI_DEBUG_TRACE
+static bool start_live_revalidation_task(SearchWidgets *widgets);
+static void on_live_revalidation_task(GTask *task,
+                                      gpointer source_object,
+                                      gpointer task_data,
+                                      GCancellable *cancellable);
+static void on_live_revalidation_task_finished(GObject *source_object, GAsyncResult *result, gpointer user_data);
 static const char *base_repo_state_trace_name(BaseRepoState state);
-#endif
-
-static std::atomic<bool> g_installed_refresh_running { false };
 
 struct StartupWarmupData {
   SearchWidgets *widgets = nullptr;
@@ -47,7 +57,6 @@ struct StartupWarmupData {
 // -----------------------------------------------------------------------------
 // Return the text used in trace logs for one repository state.
 // -----------------------------------------------------------------------------
-#ifdef DNFUI_DEBUG_TRACE
 static const char *
 base_repo_state_trace_name(BaseRepoState state)
 {
@@ -62,7 +71,6 @@ base_repo_state_trace_name(BaseRepoState state)
     return "unknown";
   }
 }
-#endif
 
 // -----------------------------------------------------------------------------
 // Run GTK application and return process exit status
@@ -71,88 +79,133 @@ int
 app_run_dnfui(int argc, char **argv)
 {
   dnfui_i18n_init();
+  debug_trace_init();
+  trace_spans_init("dnfui");
+  configure_backend_scan_workers();
+  configure_backend_startup_mode();
+  configure_backend_repo_load_parallelism();
 
   GtkApplication *app = gtk_application_new("com.fedora.dnfui", G_APPLICATION_DEFAULT_FLAGS);
   g_signal_connect(app, "activate", G_CALLBACK(activate), NULL);
 
   int status = g_application_run(G_APPLICATION(app), argc, argv);
   g_object_unref(app);
+  trace_spans_write();
 
   return status;
 }
 
 // -----------------------------------------------------------------------------
-// Setup periodic background tasks
+// Opt in to sharded cold package scans when DNFUI_SCAN_WORKERS is set. The
+// value is a worker count, or "auto" to use one worker per hardware thread.
 // -----------------------------------------------------------------------------
 static void
-setup_periodic_tasks(void)
+configure_backend_scan_workers(void)
 {
-  // --- Periodic refresh of installed package names every 5 minutes ---
-  g_timeout_add_seconds(300, on_periodic_installed_refresh_tick, nullptr);
+  const char *workers_text = g_getenv("DNFUI_SCAN_WORKERS");
+  if (!workers_text || !*workers_text) {
+    return;
+  }
+
+  unsigned workers = 0;
+  if (g_strcmp0(workers_text, "auto") == 0) {
+    workers = std::thread::hardware_concurrency();
+  } else {
+    workers = static_cast<unsigned>(g_ascii_strtoull(workers_text, nullptr, 10));
+  }
+
+  dnf_backend_set_scan_worker_count(workers);
+  DNFUI_TRACE("Backend scan workers configured workers=%u", dnf_backend_get_scan_worker_count());
 }
 
 // -----------------------------------------------------------------------------
-// Start one periodic installed-package refresh tick.
+// Start from cached repository metadata so the first package list does not
+// wait for the network. DNFUI_STARTUP_MODE=live-first restores the old order
+// that loads live metadata before the first query.
 // -----------------------------------------------------------------------------
-static gboolean
-on_periodic_installed_refresh_tick(gpointer)
+static void
+configure_backend_startup_mode(void)
 {
-  start_installed_refresh_task();
-  return TRUE;
+  const char *mode_text = g_getenv("DNFUI_STARTUP_MODE");
+  BaseStartupMode mode = BaseStartupMode::CACHED_FIRST;
+  if (g_strcmp0(mode_text, "live-first") == 0) {
+    mode = BaseStartupMode::LIVE_FIRST;
+  }
+
+  BaseManager::instance().set_startup_mode(mode);
+  DNFUI_TRACE("Backend startup mode configured mode=%s",
+              mode == BaseStartupMode::CACHED_FIRST ? "cached-first" : "live-first");
 }
 
 // -----------------------------------------------------------------------------
-// Refresh the installed-package snapshot in the background so the periodic
-// refresh does not block the GTK main thread.
+// Limit concurrent repository metadata loads when DNFUI_REPO_LOAD_PARALLELISM
+// is set. Unset keeps the libdnf5 max_parallel_downloads configuration.
 // -----------------------------------------------------------------------------
 static void
-start_installed_refresh_task(void)
+configure_backend_repo_load_parallelism(void)
 {
-  if (g_installed_refresh_running.exchange(true)) {
-    DNFUI_TRACE("Installed package refresh skipped because the previous refresh is still running");
+  const char *limit_text = g_getenv("DNFUI_REPO_LOAD_PARALLELISM");
+  if (!limit_text || !*limit_text) {
     return;
   }
 
-  DNFUI_TRACE("Installed package refresh task start");
-
-  GTask *task = g_task_new(nullptr, nullptr, on_installed_refresh_task_finished, nullptr);
-  g_task_run_in_thread(task, on_installed_refresh_task);
-  g_object_unref(task);
+  unsigned limit = static_cast<unsigned>(g_ascii_strtoull(limit_text, nullptr, 10));
+  BaseManager::instance().set_repo_load_parallelism(limit);
+  DNFUI_TRACE("Backend repo load parallelism configured limit=%u", limit);
 }
 
+struct RepoLoadProgressUpdate {
+  std::weak_ptr<SearchWidgets> widgets;
+  std::string text;
+};
+
 // -----------------------------------------------------------------------------
-// Refresh installed-package state on a worker thread.
+// Show each finished repository download in the warm-up label. The observer
+// runs on the loading thread, so the label update is queued to the GTK thread.
 // -----------------------------------------------------------------------------
 static void
-on_installed_refresh_task(GTask *task, gpointer, gpointer, GCancellable *)
+watch_repo_load_progress(SearchWidgets *widgets)
 {
-  try {
-    dnf_backend_refresh_installed_nevras();
-    g_task_return_boolean(task, TRUE);
-  } catch (const std::exception &e) {
-    g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", e.what());
-  } catch (...) {
-    g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", _("Installed package refresh failed."));
-  }
+  std::weak_ptr<SearchWidgets> weak_widgets = widgets->shared_from_this();
+  BaseManager::instance().set_repo_load_observer([weak_widgets](const BaseRepoLoadTiming &timing) {
+    auto *update = new RepoLoadProgressUpdate();
+    update->widgets = weak_widgets;
+    gchar *text = timing.download_failed
+        ? g_strdup_printf(_("Loading package data... %s failed"), timing.repo_id.c_str())
+        : g_strdup_printf(_("Loading package data... %s (%.1f s)"),
+                          timing.repo_id.c_str(),
+                          static_cast<double>(timing.download_us) / 1000000.0);
+    update->text = text;
+    g_free(text);
+
+    g_idle_add_full(
+        G_PRIORITY_DEFAULT,
+        +[](gpointer data) -> gboolean {
+          auto *update = static_cast<RepoLoadProgressUpdate *>(data);
+          auto widgets = update->widgets.lock();
+          if (widgets && !widgets->window_state.destroyed && widgets->window_state.backend_warmup_label) {
+            gtk_label_set_text(widgets->window_state.backend_warmup_label, update->text.c_str());
+          }
+          return G_SOURCE_REMOVE;
+        },
+        update,
+        +[](gpointer data) { delete static_cast<RepoLoadProgressUpdate *>(data); });
+  });
 }
 
 // -----------------------------------------------------------------------------
-// Finish one installed-package refresh tick on the GTK thread.
+// Put the per-repository timing of the last load in the status tooltip.
 // -----------------------------------------------------------------------------
 static void
-on_installed_refresh_task_finished(GObject *, GAsyncResult *result, gpointer)
+show_repo_load_report(SearchWidgets *widgets)
 {
-  GError *error = nullptr;
-  g_task_propagate_boolean(G_TASK(result), &error);
-
-  if (error) {
-    DNFUI_TRACE("Installed package refresh task failed: %s", error->message);
-  } else {
-    DNFUI_TRACE("Installed package refresh task done");
+  const BaseRepoLoadReport report = BaseManager::instance().stats().last_repo_load;
+  if (report.mode.empty()) {
+    return;
   }
 
-  g_clear_error(&error);
-  g_installed_refresh_running = false;
+  const std::string text = base_repo_load_report_format(report);
+  gtk_widget_set_tooltip_text(GTK_WIDGET(widgets->query.status_label), text.c_str());
 }
 
 // -----------------------------------------------------------------------------
@@ -199,12 +252,13 @@ start_backend_warmup_task(SearchWidgets *widgets)
 
   DNFUI_TRACE("Backend warm up task start");
   gtk_widget_set_visible(GTK_WIDGET(widgets->window_state.backend_warmup_label), TRUE);
+  watch_repo_load_progress(widgets);
 
   widgets->window_state.backend_warmup_cancellable = g_cancellable_new();
 
   GTask *task = widgets_task_new_for_search_widgets(
       widgets, widgets->window_state.backend_warmup_cancellable, on_backend_warmup_task_finished);
-  g_task_run_in_thread(task, on_backend_warmup_task);
+  ui_task_run_in_thread(task, on_backend_warmup_task, UiTaskClass::REFRESH);
   g_object_unref(task);
 }
 
@@ -214,13 +268,23 @@ start_backend_warmup_task(SearchWidgets *widgets)
 static void
 on_backend_warmup_task(GTask *task, gpointer, gpointer, GCancellable *cancellable)
 {
+  DNFUI_TRACE_SPAN("startup", "backend warm up");
   if (g_cancellable_is_cancelled(cancellable)) {
     g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "%s", _("Backend warm up was cancelled."));
     return;
   }
 
   try {
+    // Map the index saved by the last launch first, so List Packages and name
+    // searches have rows to show while the Base loads.
+    dnf_backend_open_package_index_file();
     BaseManager::instance().acquire_read();
+    // Build the package index as well so the first List or Search click only
+    // filters prepared rows.
+    dnf_backend_warm_package_index(cancellable);
+    // The reverse-dependency index only serves the Dependencies tab. It is
+    // built last, and queries can already read the package index meanwhile.
+    dnf_backend_warm_installed_reverse_deps(cancellable);
     if (g_cancellable_is_cancelled(cancellable)) {
       g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "%s", _("Backend warm up was cancelled."));
       return;
@@ -241,6 +305,10 @@ on_backend_warmup_task(GTask *task, gpointer, gpointer, GCancellable *cancellabl
 static void
 on_backend_warmup_task_finished(GObject *, GAsyncResult *result, gpointer user_data)
 {
+  // Queries use the live Base from here on, even when the warm up failed or
+  // was cancelled, so the mapped index file is released on every path.
+  dnf_backend_close_package_index_file();
+
   SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
   GTask *task = G_TASK(result);
   if (widgets_task_should_skip_completion(task, widgets)) {
@@ -256,12 +324,17 @@ on_backend_warmup_task_finished(GObject *, GAsyncResult *result, gpointer user_d
     return;
   }
 
+  bool revalidating = false;
   if (error) {
     DNFUI_TRACE("Backend warm up task failed: %s", error->message);
   } else {
     DNFUI_TRACE("Backend warm up task done: %s", base_repo_state_trace_name(*repo_state));
     if (*repo_state == BaseRepoState::LIVE_METADATA) {
       ui_helpers_set_status(widgets->query.status_label, _("Ready. Live repository metadata loaded."), "gray");
+    } else if (*repo_state == BaseRepoState::CACHED_METADATA && BaseManager::instance().live_revalidation_pending()) {
+      ui_helpers_set_status(
+          widgets->query.status_label, _("Ready. Using cached repository metadata while live metadata loads."), "blue");
+      revalidating = start_live_revalidation_task(widgets);
     } else if (*repo_state == BaseRepoState::CACHED_METADATA) {
       ui_helpers_set_status(widgets->query.status_label, _("Ready. Using cached repository metadata."), "blue");
     } else {
@@ -271,21 +344,128 @@ on_backend_warmup_task_finished(GObject *, GAsyncResult *result, gpointer user_d
 
   g_clear_error(&error);
   delete repo_state;
+  show_repo_load_report(widgets);
+
+  // Replace the last session's rows, or rows from the package index file, with
+  // the live query result. A failed warm up reloads too, so the query reports
+  // the error instead of stale rows. The reload queues the search pre-warm.
+  if (widgets->query_state.showing_view_snapshot) {
+    package_query_reload_current_view(widgets);
+  } else {
+    search_prewarm_schedule(widgets);
+  }
+
+  // Warm the transaction service only now so its repo load does not compete
+  // with the one the window was waiting for.
+  transaction_service_client_warm_up();
 
-  if (widgets && widgets->window_state.backend_warmup_label) {
+  // A live revalidation keeps the label for its own download progress.
+  if (widgets && widgets->window_state.backend_warmup_label && !revalidating) {
     gtk_widget_set_visible(GTK_WIDGET(widgets->window_state.backend_warmup_label), FALSE);
   }
 }
 
+// -----------------------------------------------------------------------------
+// Load live repository metadata behind a cached-first startup Base. The
+// window keeps serving the cached Base until the live one is swapped in.
+// Returns true when the task was started.
+// -----------------------------------------------------------------------------
+static bool
+start_live_revalidation_task(SearchWidgets *widgets)
+{
+  if (!widgets || !widgets->window_state.backend_warmup_cancellable) {
+    return false;
+  }
+
+  DNFUI_TRACE("Live metadata revalidation task start");
+  if (widgets->window_state.backend_warmup_label) {
+    gtk_label_set_text(widgets->window_state.backend_warmup_label, _("Loading live repository metadata..."));
+  }
+  GTask *task = widgets_task_new_for_search_widgets(
+      widgets, widgets->window_state.backend_warmup_cancellable, on_live_revalidation_task_finished);
+  ui_task_run_in_thread(task, on_live_revalidation_task, UiTaskClass::REFRESH);
+  g_object_unref(task);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Run the live repository load on a worker thread.
+// -----------------------------------------------------------------------------
+static void
+on_live_revalidation_task(GTask *task, gpointer, gpointer, GCancellable *cancellable)
+{
+  try {
+    BaseRepoState repo_state = BaseManager::instance().revalidate_live_metadata();
+    if (repo_state == BaseRepoState::LIVE_METADATA) {
+      // Prepare the index for the new generation before the view reloads.
+      dnf_backend_warm_package_index(cancellable);
+    }
+    g_task_return_pointer(
+        task, new BaseRepoState(repo_state), [](gpointer p) { delete static_cast<BaseRepoState *>(p); });
+  } catch (const std::exception &e) {
+    g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", e.what());
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Reload the visible package view once live metadata replaced the cached Base.
+// A failed live load keeps the cached view and only updates the status text.
+// -----------------------------------------------------------------------------
+static void
+on_live_revalidation_task_finished(GObject *, GAsyncResult *result, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  GTask *task = G_TASK(result);
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    return;
+  }
+
+  GError *error = nullptr;
+  BaseRepoState *repo_state = static_cast<BaseRepoState *>(g_task_propagate_pointer(task, &error));
+
+  if (widgets->window_state.backend_warmup_label) {
+    gtk_widget_set_visible(GTK_WIDGET(widgets->window_state.backend_warmup_label), FALSE);
+  }
+  show_repo_load_report(widgets);
+
+  if (error) {
+    DNFUI_TRACE("Live metadata revalidation task failed: %s", error->message);
+    g_clear_error(&error);
+    return;
+  }
+
+  DNFUI_TRACE("Live metadata revalidation task done: %s", base_repo_state_trace_name(*repo_state));
+  if (*repo_state == BaseRepoState::LIVE_METADATA) {
+    // The swap bumped the Base generation, so cached rows are already stale.
+    package_query_clear_search_cache();
+    ui_helpers_set_status(widgets->query.status_label, _("Live repository metadata loaded."), "gray");
+    package_query_reload_current_view(widgets);
+  } else {
+    ui_helpers_set_status(
+        widgets->query.status_label, _("Live repo refresh failed. Using cached repository metadata."), "blue");
+  }
+
+  delete repo_state;
+}
+
 // -----------------------------------------------------------------------------
 // GTK app setup (start here)
 // -----------------------------------------------------------------------------
 static void
 activate(GtkApplication *app, gpointer)
 {
+  DNFUI_TRACE_SPAN("startup", "activate");
   MainWindow main_window = main_window_create(app);
 
-  setup_periodic_tasks();
+  // Pick up transactions run outside the app, such as from the dnf CLI.
+  installed_change_monitor_start(main_window.widgets);
+  // Give cached query state back after the window stayed idle for a while.
+  idle_memory_reclaim_start(GTK_WINDOW(main_window.window), main_window.widgets);
+
+  // Fill the history and the table from the last session before the window
+  // shows. The warm up below replaces these rows once the Base is ready.
+  package_query_load_history(main_window.widgets);
+  package_query_show_view_snapshot(main_window.widgets);
 
   // Show the fully initialized window
   gtk_window_present(GTK_WINDOW(main_window.window));
@@ -6,13 +6,20 @@
 // -----------------------------------------------------------------------------
 #include "base_manager.hpp"
 #include "debug_trace.hpp"
+#include "trace_spans.hpp"
 
 #include <libdnf5/conf/const.hpp>
 #include <libdnf5/repo/repo.hpp>
+#include <libdnf5/repo/repo_query.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
+#include <utility>
 
 namespace {
 
@@ -25,8 +32,160 @@ enum class RepoLoadMode {
 struct BuiltBase {
   std::shared_ptr<libdnf5::Base> base;
   BaseRepoState repo_state = BaseRepoState::LIVE_METADATA;
+  BaseStateFingerprint fingerprint;
+  // Captured after the load, so it includes metadata the load downloaded.
+  BaseStateFingerprint loaded_fingerprint;
 };
 
+// Contention and rebuild counters. The mutex is held only to bump a few
+// integers, never while a Base lock is waited for.
+std::mutex g_stats_mutex;
+BaseManagerStats g_stats;
+// Current write lock owner. The name points at a static caller string.
+const char *g_write_holder = nullptr;
+std::chrono::steady_clock::time_point g_write_held_since;
+// Told about each finished repository download. Guarded by g_stats_mutex.
+BaseRepoLoadObserver g_repo_load_observer;
+// Requested concurrent repository loads. Zero keeps the libdnf5 default.
+std::atomic<unsigned> g_repo_load_parallelism { 0 };
+// Repo directory and cache used instead of the system ones.
+std::mutex g_repo_config_mutex;
+BaseRepoConfigOverride g_repo_config_override;
+// libdnf5 rejects max_parallel_downloads above this value.
+constexpr unsigned kMaxRepoLoadParallelism = 20;
+// Forks kept per snapshot. Each one holds a full copy of the loaded
+// metadata, so this matches the transaction service preview workers.
+constexpr size_t kMaxBaseForks = 2;
+
+// -----------------------------------------------------------------------------
+// Return the microseconds elapsed since start.
+// -----------------------------------------------------------------------------
+static uint64_t
+elapsed_us_since(std::chrono::steady_clock::time_point start)
+{
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+// -----------------------------------------------------------------------------
+// Record how long one acquire call waited for its lock.
+// -----------------------------------------------------------------------------
+static void
+record_lock_wait(BaseAccessKind kind, std::chrono::steady_clock::time_point start)
+{
+  const uint64_t waited_us = elapsed_us_since(start);
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  (kind == BaseAccessKind::READ ? g_stats.read_wait : g_stats.write_wait).record(waited_us);
+}
+
+// -----------------------------------------------------------------------------
+// Return the rebuild histogram for one repo load mode.
+// -----------------------------------------------------------------------------
+static BaseTimingHistogram &
+rebuild_histogram_for_mode(RepoLoadMode mode)
+{
+  switch (mode) {
+  case RepoLoadMode::CACHE_ONLY_METADATA:
+    return g_stats.rebuild_cache_only;
+  case RepoLoadMode::SYSTEM_ONLY:
+    return g_stats.rebuild_system_only;
+  case RepoLoadMode::FULL:
+  default:
+    return g_stats.rebuild_full;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Append one histogram line to the diagnostics report.
+// -----------------------------------------------------------------------------
+static void
+append_histogram_line(std::ostringstream &out, const char *label, const BaseTimingHistogram &histogram)
+{
+  out << "  " << label << ": count=" << histogram.count;
+  if (histogram.count > 0) {
+    out << " avg=" << histogram.total_us / histogram.count << "us"
+        << " p50<=" << histogram.approximate_percentile_us(0.50) << "us"
+        << " p99<=" << histogram.approximate_percentile_us(0.99) << "us"
+        << " max=" << histogram.max_us << "us";
+  }
+  out << "\n";
+}
+
+// -----------------------------------------------------------------------------
+// Return a short label for one repo load mode.
+// -----------------------------------------------------------------------------
+static const char *
+repo_load_mode_label(RepoLoadMode mode)
+{
+  switch (mode) {
+  case RepoLoadMode::CACHE_ONLY_METADATA:
+    return "cache only metadata";
+  case RepoLoadMode::SYSTEM_ONLY:
+    return "system only";
+  case RepoLoadMode::FULL:
+  default:
+    return "full";
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Keep the timing of one repo load for the diagnostics and trace it.
+// -----------------------------------------------------------------------------
+static void
+record_repo_load(BaseRepoLoadReport report)
+{
+  if (debug_trace_enabled()) {
+    const std::string text = base_repo_load_report_format(report);
+    size_t line_start = 0;
+    while (line_start < text.size()) {
+      const size_t line_end = text.find('\n', line_start);
+      DNFUI_TRACE("%s", text.substr(line_start, line_end - line_start).c_str());
+      line_start = line_end == std::string::npos ? text.size() : line_end + 1;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  g_stats.last_repo_load = std::move(report);
+}
+
+// -----------------------------------------------------------------------------
+// Return a copy of the current repository download observer.
+// -----------------------------------------------------------------------------
+static BaseRepoLoadObserver
+current_repo_load_observer()
+{
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  return g_repo_load_observer;
+}
+
+// -----------------------------------------------------------------------------
+// Stop a Base build between steps once its caller gave up on it.
+// -----------------------------------------------------------------------------
+static void
+throw_if_rebuild_cancelled(const std::atomic<bool> *cancel)
+{
+  if (cancel && cancel->load()) {
+    throw std::runtime_error("Package base rebuild was cancelled.");
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Return a short label for one repo state.
+// -----------------------------------------------------------------------------
+static const char *
+repo_state_label(BaseRepoState state)
+{
+  switch (state) {
+  case BaseRepoState::CACHED_METADATA:
+    return "cached metadata";
+  case BaseRepoState::INSTALLED_ONLY:
+    return "installed only";
+  case BaseRepoState::LIVE_METADATA:
+  default:
+    return "live metadata";
+  }
+}
+
 // -----------------------------------------------------------------------------
 // Build one fully configured Base before any repo metadata is loaded.
 // -----------------------------------------------------------------------------
@@ -40,6 +199,19 @@ create_configured_base(RepoLoadMode mode)
   base->load_config();
   DNFUI_TRACE("BaseManager load config done");
 
+  BaseRepoConfigOverride config_override;
+  {
+    std::lock_guard<std::mutex> lock(g_repo_config_mutex);
+    config_override = g_repo_config_override;
+  }
+  if (!config_override.reposdir.empty()) {
+    base->get_config().get_reposdir_option().set(std::vector<std::string> { config_override.reposdir });
+  }
+  if (!config_override.cachedir.empty()) {
+    base->get_config().get_cachedir_option().set(config_override.cachedir);
+    base->get_config().get_system_cachedir_option().set(config_override.cachedir);
+  }
+
   if (mode == RepoLoadMode::CACHE_ONLY_METADATA) {
     // When live repo refresh is not available, keep repo-backed queries working
     // from cached metadata instead of dropping immediately to installed-only mode.
@@ -47,6 +219,13 @@ create_configured_base(RepoLoadMode mode)
     base->get_config().get_cachedir_option().set(base->get_config().get_system_cachedir_option().get_value());
   }
 
+  const unsigned parallelism = g_repo_load_parallelism.load(std::memory_order_relaxed);
+  if (parallelism > 0) {
+    // libdnf5 fetches repository metadata concurrently up to this limit and
+    // loads each repo into the sack as its download completes.
+    base->get_config().get_max_parallel_downloads_option().set(parallelism);
+  }
+
   if (mode == RepoLoadMode::FULL) {
     // Changelog lookups for available packages need repo "other" metadata.
     base->get_config().get_optional_metadata_types_option().add_item(libdnf5::Option::Priority::RUNTIME,
@@ -69,7 +248,7 @@ create_configured_base(RepoLoadMode mode)
 // only trigger when this step fails for the full repo set.
 // -----------------------------------------------------------------------------
 static void
-load_repo_data(libdnf5::Base &base, RepoLoadMode mode)
+load_repo_data(libdnf5::Base &base, RepoLoadMode mode, const std::atomic<bool> *cancel)
 {
   auto repo_sack = base.get_repo_sack();
 
@@ -91,22 +270,76 @@ load_repo_data(libdnf5::Base &base, RepoLoadMode mode)
   if (mode == RepoLoadMode::SYSTEM_ONLY) {
     repo_sack->load_repos(libdnf5::repo::Repo::Type::SYSTEM);
   } else {
-    repo_sack->load_repos();
+    BaseRepoLoadRecorder recorder(base, repo_load_mode_label(mode), current_repo_load_observer(), cancel);
+    try {
+      repo_sack->load_repos();
+    } catch (...) {
+      record_repo_load(recorder.finish(false));
+      throw;
+    }
+    record_repo_load(recorder.finish(true));
   }
   DNFUI_TRACE("BaseManager load repos done");
 }
 
+// -----------------------------------------------------------------------------
+// Mark the cached metadata of one enabled repo as expired so the next load
+// downloads it again while the other repos keep loading from their caches.
+// Throws std::invalid_argument when no enabled repo has that id.
+// -----------------------------------------------------------------------------
+static void
+expire_enabled_repo(libdnf5::Base &base, const std::string &repo_id)
+{
+  libdnf5::repo::RepoQuery repos(base);
+  repos.filter_enabled(true);
+  repos.filter_id(repo_id);
+  if (repos.empty()) {
+    throw std::invalid_argument("Repository " + repo_id + " is not enabled.");
+  }
+  for (const auto &repo : repos) {
+    repo->expire();
+  }
+  DNFUI_TRACE("BaseManager expired repo %s", repo_id.c_str());
+}
+
 } // namespace
 
 // -----------------------------------------------------------------------------
-// Build one Base and load repository data for the requested mode.
+// Build one Base and load repository data for the requested mode. cancel
+// aborts metadata downloads and is checked again around the repo load. A full
+// load also downloads the metadata of expire_repo_id again when it is set.
 // -----------------------------------------------------------------------------
 static BuiltBase
-build_base_for_mode(RepoLoadMode mode)
+build_base_for_mode(RepoLoadMode mode,
+                    const std::atomic<bool> *cancel = nullptr,
+                    const std::string &expire_repo_id = {})
 {
+  DNFUI_TRACE_SPAN("base", "load", repo_load_mode_label(mode));
+  // Time every attempt, including failed ones, so slow fallbacks show up.
+  const auto start = std::chrono::steady_clock::now();
+  struct RebuildTimer {
+    RepoLoadMode mode;
+    std::chrono::steady_clock::time_point start;
+    ~RebuildTimer()
+    {
+      const uint64_t elapsed_us = elapsed_us_since(start);
+      std::lock_guard<std::mutex> lock(g_stats_mutex);
+      rebuild_histogram_for_mode(mode).record(elapsed_us);
+    }
+  } rebuild_timer { mode, start };
+
   BuiltBase result;
   result.base = create_configured_base(mode);
-  load_repo_data(*result.base, mode);
+  if (mode == RepoLoadMode::FULL && !expire_repo_id.empty()) {
+    expire_enabled_repo(*result.base, expire_repo_id);
+  }
+  throw_if_rebuild_cancelled(cancel);
+  // Capture before loading so changes made during the load trigger the next
+  // rebuild instead of being hidden by it.
+  result.fingerprint = base_state_fingerprint_capture(*result.base, mode != RepoLoadMode::SYSTEM_ONLY);
+  load_repo_data(*result.base, mode, cancel);
+  throw_if_rebuild_cancelled(cancel);
+  result.loaded_fingerprint = base_state_fingerprint_capture(*result.base, mode != RepoLoadMode::SYSTEM_ONLY);
   if (mode == RepoLoadMode::CACHE_ONLY_METADATA) {
     result.repo_state = BaseRepoState::CACHED_METADATA;
   } else if (mode == RepoLoadMode::SYSTEM_ONLY) {
@@ -119,27 +352,34 @@ build_base_for_mode(RepoLoadMode mode)
 // -----------------------------------------------------------------------------
 // Try the normal live repo load first, then cached metadata, then finally
 // installed-package-only mode so the app stays usable when the network is down.
+// A cancelled build stops instead of trying the next fallback, and so does a
+// refresh of a repo that is not enabled.
 // -----------------------------------------------------------------------------
 static BuiltBase
-build_base_with_offline_fallback()
+build_base_with_offline_fallback(const std::atomic<bool> *cancel = nullptr, const std::string &expire_repo_id = {})
 {
   try {
-    return build_base_for_mode(RepoLoadMode::FULL);
+    return build_base_for_mode(RepoLoadMode::FULL, cancel, expire_repo_id);
+  } catch (const std::invalid_argument &) {
+    throw;
   } catch (const std::exception &repo_error) {
+    throw_if_rebuild_cancelled(cancel);
     std::cerr << "Warning: repo load failed: " << repo_error.what() << std::endl;
     DNFUI_TRACE("BaseManager load repos failed: %s", repo_error.what());
     std::cerr << "Warning: live repo load failed, retrying from cached metadata: " << repo_error.what() << std::endl;
     DNFUI_TRACE("BaseManager live repo load failed, trying cached metadata fallback: %s", repo_error.what());
 
     try {
-      return build_base_for_mode(RepoLoadMode::CACHE_ONLY_METADATA);
+      return build_base_for_mode(RepoLoadMode::CACHE_ONLY_METADATA, cancel);
     } catch (const std::exception &cache_error) {
+      throw_if_rebuild_cancelled(cancel);
       std::cerr << "Warning: cached repo metadata load failed: " << cache_error.what() << std::endl;
       DNFUI_TRACE("BaseManager cached repo load failed, trying system-only fallback: %s", cache_error.what());
 
       try {
-        return build_base_for_mode(RepoLoadMode::SYSTEM_ONLY);
+        return build_base_for_mode(RepoLoadMode::SYSTEM_ONLY, cancel);
       } catch (const std::exception &fallback_error) {
+        throw_if_rebuild_cancelled(cancel);
         throw std::runtime_error(
             "DNF backend initialization failed after repo load error: " + std::string(repo_error.what()) +
             "; cached metadata fallback failed: " + cache_error.what() +
@@ -149,6 +389,146 @@ build_base_with_offline_fallback()
   }
 }
 
+// -----------------------------------------------------------------------------
+// Load one fork for a snapshot with the given inputs. Repo-backed forks load
+// from the metadata cache the published Base left behind, so they never go to
+// the network. Returns nullptr when the fork saw different inputs.
+// -----------------------------------------------------------------------------
+static std::shared_ptr<libdnf5::Base>
+build_fork_base(const BaseStateFingerprint &wanted)
+{
+  DNFUI_TRACE_SPAN("base", "load fork");
+  const RepoLoadMode mode = wanted.includes_repos ? RepoLoadMode::CACHE_ONLY_METADATA : RepoLoadMode::SYSTEM_ONLY;
+  auto base = create_configured_base(mode);
+  load_repo_data(*base, mode, nullptr);
+  if (!base_state_fingerprint_capture(*base, wanted.includes_repos).same_inputs(wanted)) {
+    DNFUI_TRACE("BaseManager fork inputs differ from the published Base");
+    return nullptr;
+  }
+  return base;
+}
+
+// -----------------------------------------------------------------------------
+// Lease the first idle fork of one snapshot, or return an empty lease.
+// -----------------------------------------------------------------------------
+static BaseForkLease
+lease_idle_fork(const std::shared_ptr<BaseSnapshot> &snapshot, uint64_t snapshot_generation)
+{
+  std::lock_guard<std::mutex> lock(snapshot->forks_mutex);
+  for (const auto &fork : snapshot->forks) {
+    std::unique_lock<std::mutex> fork_lock(fork->mutex, std::try_to_lock);
+    if (fork_lock.owns_lock()) {
+      ++fork->lease_serial;
+      return BaseForkLease(snapshot, fork, std::move(fork_lock), snapshot_generation);
+    }
+  }
+  return {};
+}
+
+// -----------------------------------------------------------------------------
+// Count one fork lease, and one fork build when built is true.
+// -----------------------------------------------------------------------------
+static void
+record_fork_lease(bool built)
+{
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  ++g_stats.fork_leases;
+  if (built) {
+    ++g_stats.forks_built;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Count one acquire_fork call that found no usable fork.
+// -----------------------------------------------------------------------------
+static void
+record_fork_unavailable()
+{
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  ++g_stats.fork_unavailable;
+}
+
+// -----------------------------------------------------------------------------
+// Count one Base dropped by release_idle.
+// -----------------------------------------------------------------------------
+static void
+record_idle_release()
+{
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  ++g_stats.idle_releases;
+}
+
+// -----------------------------------------------------------------------------
+// Add one sample to the histogram.
+// -----------------------------------------------------------------------------
+void
+BaseTimingHistogram::record(uint64_t us)
+{
+  const size_t bucket = std::min<size_t>(std::bit_width(us), kBucketCount - 1);
+  ++buckets[bucket];
+  ++count;
+  total_us += us;
+  max_us = std::max(max_us, us);
+}
+
+// -----------------------------------------------------------------------------
+// Walk the buckets until the requested share of samples is covered.
+// -----------------------------------------------------------------------------
+uint64_t
+BaseTimingHistogram::approximate_percentile_us(double fraction) const
+{
+  if (count == 0) {
+    return 0;
+  }
+
+  const uint64_t wanted = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(count) + 0.5));
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+    seen += buckets[bucket];
+    if (seen >= wanted) {
+      const uint64_t upper = bucket == 0 ? 0 : (uint64_t { 1 } << bucket) - 1;
+      return std::min(upper, max_us);
+    }
+  }
+  return max_us;
+}
+
+// -----------------------------------------------------------------------------
+// Start timing a held lock and remember the write lock owner.
+// -----------------------------------------------------------------------------
+BaseHoldTimer::BaseHoldTimer(BaseAccessKind k, const char *h)
+    : kind(k)
+    , holder(h ? h : "unknown")
+    , start(std::chrono::steady_clock::now())
+{
+  if (kind == BaseAccessKind::WRITE) {
+    std::lock_guard<std::mutex> lock(g_stats_mutex);
+    g_write_holder = holder;
+    g_write_held_since = start;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Record the hold time for the final owner of the timer.
+// -----------------------------------------------------------------------------
+BaseHoldTimer::~BaseHoldTimer()
+{
+  if (!armed) {
+    return;
+  }
+
+  const uint64_t held_us = elapsed_us_since(start);
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  if (kind == BaseAccessKind::READ) {
+    g_stats.read_hold.record(held_us);
+    return;
+  }
+
+  g_stats.write_hold.record(held_us);
+  g_stats.write_hold_by_holder[holder].record(held_us);
+  g_write_holder = nullptr;
+}
+
 // -----------------------------------------------------------------------------
 // Return the single BaseManager used by the process.
 // -----------------------------------------------------------------------------
@@ -165,87 +545,468 @@ BaseManager::instance()
 BaseRepoState
 BaseManager::current_repo_state() const
 {
-  std::shared_lock<std::shared_mutex> shared(base_mutex);
+  std::lock_guard<std::mutex> lock(snapshot_mutex);
   return repo_state;
 }
 
 // -----------------------------------------------------------------------------
-// Return read access to the current Base.
+// Copy the published snapshot pointer together with its generation.
 // -----------------------------------------------------------------------------
-BaseRead
-BaseManager::acquire_read()
+std::shared_ptr<BaseSnapshot>
+BaseManager::published_snapshot(uint64_t &snapshot_generation) const
 {
-  // Use the existing Base when it is already available.
-  {
-    std::shared_lock<std::shared_mutex> shared(base_mutex);
-    if (base_ptr) {
-      return { *base_ptr, BaseGuard(std::move(shared)), generation.load(std::memory_order_relaxed) };
+  std::lock_guard<std::mutex> lock(snapshot_mutex);
+  snapshot_generation = generation.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+// -----------------------------------------------------------------------------
+// Return the published snapshot, building the first Base while the caller
+// holds build_mutex. Readers of an existing snapshot are never blocked here.
+// -----------------------------------------------------------------------------
+std::shared_ptr<BaseSnapshot>
+BaseManager::ensure_snapshot_locked(uint64_t &snapshot_generation)
+{
+  if (auto current = published_snapshot(snapshot_generation)) {
+    return current;
+  }
+
+  BuiltBase built;
+  bool from_cached_first = false;
+  if (startup_mode.load(std::memory_order_relaxed) == BaseStartupMode::CACHED_FIRST) {
+    try {
+      built = build_base_for_mode(RepoLoadMode::CACHE_ONLY_METADATA);
+      from_cached_first = true;
+    } catch (const std::exception &e) {
+      // Usually a first run without cached metadata. Use the normal order.
+      DNFUI_TRACE("BaseManager cached-first startup failed, loading live metadata: %s", e.what());
     }
   }
+  if (!built.base) {
+    built = build_base_with_offline_fallback();
+  }
+  if (!built.base) {
+    // Never return a null Base reference.
+    throw std::runtime_error("DNF backend not initialized (Base is null).");
+  }
+  publish_snapshot(
+      built.base, built.repo_state, std::move(built.fingerprint), std::move(built.loaded_fingerprint), false);
+  revalidation_pending.store(from_cached_first, std::memory_order_relaxed);
+  return published_snapshot(snapshot_generation);
+}
+
+// -----------------------------------------------------------------------------
+// Swap in a newly built Base. Readers pinned to the previous snapshot keep it
+// alive until their guards are released.
+// -----------------------------------------------------------------------------
+void
+BaseManager::publish_snapshot(std::shared_ptr<libdnf5::Base> base,
+                              BaseRepoState state,
+                              BaseStateFingerprint built_from,
+                              BaseStateFingerprint loaded_from,
+                              bool bump_generation)
+{
+  auto next = std::make_shared<BaseSnapshot>();
+  next->base = std::move(base);
+  next->loaded_inputs = std::move(loaded_from);
+
+  std::lock_guard<std::mutex> lock(snapshot_mutex);
+  snapshot = std::move(next);
+  repo_state = state;
+  fingerprint = std::move(built_from);
+
+  // Publish the generation change together with the new Base so readers never
+  // drop their cached results without a replacement snapshot to use.
+  if (bump_generation) {
+    generation.fetch_add(1, std::memory_order_relaxed);
+  }
+}
 
-  // Build the Base while holding the write lock.
+// -----------------------------------------------------------------------------
+// Compare the inputs of the published Base with the current system state.
+// Degraded Bases never count as current so a rebuild can recover live
+// metadata once the network is back. Configuring a Base without loading repos
+// only reads configuration files, so this check stays cheap.
+// -----------------------------------------------------------------------------
+bool
+BaseManager::published_base_is_current(bool include_repos) const
+{
+  BaseStateFingerprint published;
   {
-    std::unique_lock<std::shared_mutex> unique(base_mutex);
-    if (!base_ptr) {
-      ensure_base_initialized();
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    const BaseRepoState wanted = include_repos ? BaseRepoState::LIVE_METADATA : BaseRepoState::INSTALLED_ONLY;
+    if (!snapshot || repo_state != wanted || fingerprint.includes_repos != include_repos) {
+      return false;
     }
-    if (!base_ptr) {
-      // Never return a null Base reference.
-      throw std::runtime_error("DNF backend not initialized (Base is null).");
+    published = fingerprint;
+  }
+
+  if (published.metadata_may_be_expired(std::chrono::steady_clock::now())) {
+    return false;
+  }
+
+  try {
+    auto configured = create_configured_base(include_repos ? RepoLoadMode::FULL : RepoLoadMode::SYSTEM_ONLY);
+    return base_state_fingerprint_capture(*configured, include_repos).same_inputs(published);
+  } catch (const std::exception &e) {
+    // Let the real rebuild report configuration errors.
+    DNFUI_TRACE("BaseManager change check failed: %s", e.what());
+    return false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Check the published repo-backed Base without waiting for a running build.
+// -----------------------------------------------------------------------------
+bool
+BaseManager::published_repo_base_is_current()
+{
+  std::unique_lock<std::mutex> build(build_mutex, std::try_to_lock);
+  return build.owns_lock() && published_base_is_current(true);
+}
+
+// -----------------------------------------------------------------------------
+// Compare the installed-state stamps of the published Base with the files now
+// on disk. No Base configuration is loaded, since the fingerprint records the
+// install root it was taken under.
+// -----------------------------------------------------------------------------
+bool
+BaseManager::published_installed_state_changed() const
+{
+  BaseStateFingerprint published;
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    if (!snapshot) {
+      return false;
     }
+    published = fingerprint;
   }
 
-  // Take the read lock again for the returned guard.
-  std::shared_lock<std::shared_mutex> shared(base_mutex);
-  if (!base_ptr) {
-    // The Base should not disappear while this lock is held.
-    throw std::runtime_error("DNF backend not initialized (Base is null).");
+  return base_state_fingerprint_installed_state_stamps(published.installroot) != published.rpmdb_files;
+}
+
+// -----------------------------------------------------------------------------
+// Copy the loaded inputs of the published repo-backed snapshot.
+// -----------------------------------------------------------------------------
+bool
+BaseManager::published_repo_inputs(BaseStateFingerprint &inputs, uint64_t &snapshot_generation) const
+{
+  std::lock_guard<std::mutex> lock(snapshot_mutex);
+  if (!snapshot || repo_state == BaseRepoState::INSTALLED_ONLY || !snapshot->loaded_inputs.includes_repos) {
+    return false;
+  }
+
+  inputs = snapshot->loaded_inputs;
+  snapshot_generation = generation.load(std::memory_order_relaxed);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Configure a repo-backed Base without loading its repos and capture it.
+// -----------------------------------------------------------------------------
+BaseStateFingerprint
+BaseManager::capture_repo_inputs()
+{
+  auto configured = create_configured_base(RepoLoadMode::FULL);
+  return base_state_fingerprint_capture(*configured, true);
+}
+
+// -----------------------------------------------------------------------------
+// Record one rebuild that was skipped because nothing changed.
+// -----------------------------------------------------------------------------
+static void
+record_rebuild_skipped()
+{
+  DNFUI_TRACE("BaseManager rebuild skipped, inputs unchanged");
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  ++g_stats.rebuilds_skipped;
+}
+
+// -----------------------------------------------------------------------------
+// Return read access to the current Base.
+// -----------------------------------------------------------------------------
+BaseRead
+BaseManager::acquire_read()
+{
+  const auto wait_start = std::chrono::steady_clock::now();
+  uint64_t snapshot_generation = 0;
+  std::shared_ptr<BaseSnapshot> current = published_snapshot(snapshot_generation);
+
+  // Build the first Base when none has been published yet.
+  if (!current) {
+    std::lock_guard<std::mutex> build(build_mutex);
+    current = ensure_snapshot_locked(snapshot_generation);
   }
-  return { *base_ptr, BaseGuard(std::move(shared)), generation.load(std::memory_order_relaxed) };
+
+  std::shared_lock<std::shared_mutex> shared(current->mutex);
+  record_lock_wait(BaseAccessKind::READ, wait_start);
+  libdnf5::Base &base = *current->base;
+  return { base, BaseGuard(std::move(current), std::move(shared)), snapshot_generation };
 }
 
 // -----------------------------------------------------------------------------
 // Return write access to the current Base.
 // -----------------------------------------------------------------------------
 std::pair<libdnf5::Base &, BaseWriteGuard>
-BaseManager::acquire_write()
+BaseManager::acquire_write(const char *holder)
+{
+  const auto wait_start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> build(build_mutex);
+  uint64_t snapshot_generation = 0;
+  std::shared_ptr<BaseSnapshot> current = ensure_snapshot_locked(snapshot_generation);
+
+  std::unique_lock<std::shared_mutex> write_lock(current->mutex);
+  record_lock_wait(BaseAccessKind::WRITE, wait_start);
+  libdnf5::Base &base = *current->base;
+  return { base, BaseWriteGuard(std::move(build), std::move(current), std::move(write_lock), holder) };
+}
+
+// -----------------------------------------------------------------------------
+// Lease an idle fork of the published Base, loading a new one while fewer than
+// kMaxBaseForks exist. Loading runs under build_mutex like every other Base
+// build, so it never reads the rpmdb while a transaction changes it.
+// -----------------------------------------------------------------------------
+BaseForkLease
+BaseManager::acquire_fork()
 {
-  std::unique_lock<std::shared_mutex> write_lock(base_mutex);
-  if (!base_ptr) {
-    ensure_base_initialized();
+  uint64_t snapshot_generation = 0;
+  std::shared_ptr<BaseSnapshot> current = published_snapshot(snapshot_generation);
+  if (current) {
+    if (BaseForkLease lease = lease_idle_fork(current, snapshot_generation)) {
+      record_fork_lease(false);
+      return lease;
+    }
   }
-  if (!base_ptr) {
-    // Never return a null Base reference.
-    throw std::runtime_error("DNF backend not initialized (Base is null).");
+
+  std::lock_guard<std::mutex> build(build_mutex);
+  current = ensure_snapshot_locked(snapshot_generation);
+  // Another preview may have built a fork, or finished with one, meanwhile.
+  if (BaseForkLease lease = lease_idle_fork(current, snapshot_generation)) {
+    record_fork_lease(false);
+    return lease;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(current->forks_mutex);
+    if (current->forks.size() >= kMaxBaseForks) {
+      record_fork_unavailable();
+      return {};
+    }
+  }
+
+  auto fork = std::make_shared<BaseFork>();
+  try {
+    fork->base = build_fork_base(current->loaded_inputs);
+  } catch (const std::exception &e) {
+    DNFUI_TRACE("BaseManager fork load failed: %s", e.what());
+  }
+  if (!fork->base) {
+    record_fork_unavailable();
+    return {};
+  }
+
+  std::unique_lock<std::mutex> fork_lock(fork->mutex);
+  ++fork->lease_serial;
+  {
+    std::lock_guard<std::mutex> lock(current->forks_mutex);
+    current->forks.push_back(fork);
+  }
+  record_fork_lease(true);
+  return BaseForkLease(current, std::move(fork), std::move(fork_lock), snapshot_generation);
+}
+
+// -----------------------------------------------------------------------------
+// Lease an idle fork of the published snapshot without building one.
+// -----------------------------------------------------------------------------
+BaseForkLease
+BaseManager::acquire_idle_fork()
+{
+  uint64_t snapshot_generation = 0;
+  std::shared_ptr<BaseSnapshot> current = published_snapshot(snapshot_generation);
+  if (!current) {
+    return {};
+  }
+
+  BaseForkLease lease = lease_idle_fork(current, snapshot_generation);
+  if (lease) {
+    record_fork_lease(false);
+  }
+  return lease;
+}
+
+// -----------------------------------------------------------------------------
+// Lease one fork again for the apply of a transaction resolved on it.
+// -----------------------------------------------------------------------------
+BaseForkLease
+BaseManager::reclaim_fork(const std::shared_ptr<BaseFork> &fork, uint64_t serial)
+{
+  if (!fork) {
+    return {};
+  }
+
+  uint64_t snapshot_generation = 0;
+  std::shared_ptr<BaseSnapshot> current = published_snapshot(snapshot_generation);
+  if (!current) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(current->forks_mutex);
+  if (std::find(current->forks.begin(), current->forks.end(), fork) == current->forks.end()) {
+    return {};
+  }
+
+  // A busy fork is being used by another preview, which bumps the serial.
+  std::unique_lock<std::mutex> fork_lock(fork->mutex, std::try_to_lock);
+  if (!fork_lock.owns_lock() || fork->lease_serial != serial) {
+    return {};
+  }
+
+  ++fork->lease_serial;
+  return BaseForkLease(current, fork, std::move(fork_lock), snapshot_generation);
+}
+
+// -----------------------------------------------------------------------------
+// Check whether a fork is still published and unused since the given serial.
+// -----------------------------------------------------------------------------
+bool
+BaseManager::fork_is_current(const std::shared_ptr<BaseFork> &fork, uint64_t serial) const
+{
+  uint64_t snapshot_generation = 0;
+  std::shared_ptr<BaseSnapshot> current = published_snapshot(snapshot_generation);
+  if (!fork || !current) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(current->forks_mutex);
+  if (std::find(current->forks.begin(), current->forks.end(), fork) == current->forks.end()) {
+    return false;
   }
 
-  return { *base_ptr, BaseWriteGuard(std::move(write_lock)) };
+  std::unique_lock<std::mutex> fork_lock(fork->mutex, std::try_to_lock);
+  return fork_lock.owns_lock() && fork->lease_serial == serial;
 }
 
 // -----------------------------------------------------------------------------
-// Rebuild the cached Base after repository refresh or transaction work.
+// Rebuild the cached Base after repository refresh or transaction work. The
+// replacement is built without holding any lock readers need, so queries,
+// details loads, and installed refreshes keep running on the previous Base
+// during the whole repo download and parse.
 // -----------------------------------------------------------------------------
 BaseRepoState
-BaseManager::rebuild()
+BaseManager::rebuild(BaseRebuildPolicy policy, const std::atomic<bool> *cancel)
 {
   // Allow only one Base rebuild at a time.
-  std::unique_lock lock(base_mutex);
+  std::lock_guard<std::mutex> build(build_mutex);
+  // The caller may have given up while another rebuild held the lock.
+  throw_if_rebuild_cancelled(cancel);
+
+  if (policy == BaseRebuildPolicy::IF_CHANGED && published_base_is_current(true)) {
+    record_rebuild_skipped();
+    return current_repo_state();
+  }
 
   // Build the replacement first so a refresh failure does not discard the last
   // usable Base. Offline fallback keeps the UI query paths working from cached
   // metadata or, as a last resort, from the local rpmdb only.
-  BuiltBase rebuilt = build_base_with_offline_fallback();
+  BuiltBase rebuilt = build_base_with_offline_fallback(cancel);
   if (!rebuilt.base) {
     throw std::runtime_error("Repository rebuild failed (Base is null).");
   }
 
-  base_ptr = rebuilt.base;
-  repo_state = rebuilt.repo_state;
+  const BaseRepoState rebuilt_state = rebuilt.repo_state;
+  publish_snapshot(std::move(rebuilt.base),
+                   rebuilt_state,
+                   std::move(rebuilt.fingerprint),
+                   std::move(rebuilt.loaded_fingerprint),
+                   true);
+  return rebuilt_state;
+}
+
+// -----------------------------------------------------------------------------
+// Refresh one repository. libdnf5 cannot drop or reload a single repo in a
+// loaded package sack, so a new Base is still built, but only the expired repo
+// goes to the network and every other repo loads from its metadata and solv
+// cache. Readers keep the previous Base until the new one is published.
+// -----------------------------------------------------------------------------
+BaseRepoState
+BaseManager::refresh_repo(const std::string &repo_id, const std::atomic<bool> *cancel)
+{
+  std::lock_guard<std::mutex> build(build_mutex);
+  throw_if_rebuild_cancelled(cancel);
+
+  BuiltBase rebuilt = build_base_with_offline_fallback(cancel, repo_id);
+  if (!rebuilt.base) {
+    throw std::runtime_error("Repository refresh failed (Base is null).");
+  }
+
+  const BaseRepoState rebuilt_state = rebuilt.repo_state;
+  publish_snapshot(std::move(rebuilt.base),
+                   rebuilt_state,
+                   std::move(rebuilt.fingerprint),
+                   std::move(rebuilt.loaded_fingerprint),
+                   true);
+  return rebuilt_state;
+}
+
+// -----------------------------------------------------------------------------
+// Replace a cached-metadata Base with a live one. Only the full repo load is
+// tried, so a failed network load keeps serving the cached Base instead of
+// rebuilding the same cached state again.
+// -----------------------------------------------------------------------------
+BaseRepoState
+BaseManager::revalidate_live_metadata()
+{
+  std::lock_guard<std::mutex> build(build_mutex);
+  revalidation_pending.store(false, std::memory_order_relaxed);
+
+  // A Refresh or transaction rebuild may already have loaded live metadata.
+  if (current_repo_state() == BaseRepoState::LIVE_METADATA) {
+    return BaseRepoState::LIVE_METADATA;
+  }
+
+  try {
+    BuiltBase live = build_base_for_mode(RepoLoadMode::FULL);
+    publish_snapshot(std::move(live.base),
+                     live.repo_state,
+                     std::move(live.fingerprint),
+                     std::move(live.loaded_fingerprint),
+                     true);
+    return live.repo_state;
+  } catch (const std::exception &e) {
+    std::cerr << "Warning: live repo load failed, keeping cached metadata: " << e.what() << std::endl;
+    DNFUI_TRACE("BaseManager live revalidation failed: %s", e.what());
+    return current_repo_state();
+  }
+}
 
-  // Publish the generation change only after the new Base is ready so readers
-  // never drop their cached results without a replacement snapshot to use.
-  generation.fetch_add(1, std::memory_order_relaxed);
-  return rebuilt.repo_state;
+// -----------------------------------------------------------------------------
+// Drop the published snapshot. Readers and fork leases that still pin it keep
+// their copy alive until they finish. The fingerprint is cleared with it, so
+// the Base built on the next acquire is never mistaken for the released one.
+// -----------------------------------------------------------------------------
+bool
+BaseManager::release_idle()
+{
+  std::unique_lock<std::mutex> build(build_mutex, std::try_to_lock);
+  if (!build.owns_lock()) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    if (!snapshot) {
+      return false;
+    }
+    snapshot.reset();
+    fingerprint = BaseStateFingerprint();
+    // Results cached for the released Base refer to packages that no longer
+    // exist, so every generation-keyed cache has to drop them.
+    generation.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  record_idle_release();
+  DNFUI_TRACE("BaseManager released the idle Base");
+  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -254,18 +1015,26 @@ BaseManager::rebuild()
 // repository availability.
 // -----------------------------------------------------------------------------
 void
-BaseManager::rebuild_system_only()
+BaseManager::rebuild_system_only(BaseRebuildPolicy policy, const std::atomic<bool> *cancel)
 {
-  std::unique_lock lock(base_mutex);
+  std::lock_guard<std::mutex> build(build_mutex);
+  throw_if_rebuild_cancelled(cancel);
 
-  auto rebuilt_base = build_initialized_system_only_base();
-  if (!rebuilt_base) {
+  if (policy == BaseRebuildPolicy::IF_CHANGED && published_base_is_current(false)) {
+    record_rebuild_skipped();
+    return;
+  }
+
+  BuiltBase rebuilt = build_base_for_mode(RepoLoadMode::SYSTEM_ONLY, cancel);
+  if (!rebuilt.base) {
     throw std::runtime_error("System-only repository rebuild failed (Base is null).");
   }
 
-  base_ptr = rebuilt_base;
-  repo_state = BaseRepoState::INSTALLED_ONLY;
-  generation.fetch_add(1, std::memory_order_relaxed);
+  publish_snapshot(std::move(rebuilt.base),
+                   BaseRepoState::INSTALLED_ONLY,
+                   std::move(rebuilt.fingerprint),
+                   std::move(rebuilt.loaded_fingerprint),
+                   true);
 }
 
 // -----------------------------------------------------------------------------
@@ -276,33 +1045,103 @@ BaseManager::rebuild_system_only()
 void
 BaseManager::ensure_system_only_initialized_if_needed()
 {
-  std::unique_lock<std::shared_mutex> unique(base_mutex);
-  if (!base_ptr) {
-    base_ptr = build_initialized_system_only_base();
-    repo_state = BaseRepoState::INSTALLED_ONLY;
+  std::lock_guard<std::mutex> build(build_mutex);
+  uint64_t snapshot_generation = 0;
+  if (!published_snapshot(snapshot_generation)) {
+    BuiltBase built = build_base_for_mode(RepoLoadMode::SYSTEM_ONLY);
+    publish_snapshot(std::move(built.base),
+                     BaseRepoState::INSTALLED_ONLY,
+                     std::move(built.fingerprint),
+                     std::move(built.loaded_fingerprint),
+                     false);
   }
 }
 
 // -----------------------------------------------------------------------------
-// Build a Base that reads only the local installed package database.
+// Store the concurrent repository load limit used by later Base builds.
 // -----------------------------------------------------------------------------
-std::shared_ptr<libdnf5::Base>
-BaseManager::build_initialized_system_only_base()
+void
+BaseManager::set_repo_load_parallelism(unsigned limit)
 {
-  return build_base_for_mode(RepoLoadMode::SYSTEM_ONLY).base;
+  g_repo_load_parallelism.store(std::min(limit, kMaxRepoLoadParallelism), std::memory_order_relaxed);
 }
 
 // -----------------------------------------------------------------------------
-// Create the shared Base while the caller holds the write lock.
+// Replace the repository download observer.
 // -----------------------------------------------------------------------------
 void
-BaseManager::ensure_base_initialized()
+BaseManager::set_repo_load_observer(BaseRepoLoadObserver observer)
 {
-  if (!base_ptr) {
-    BuiltBase built = build_base_with_offline_fallback();
-    base_ptr = built.base;
-    repo_state = built.repo_state;
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  g_repo_load_observer = std::move(observer);
+}
+
+// -----------------------------------------------------------------------------
+// Store the repo directory and cache used by later Base builds.
+// -----------------------------------------------------------------------------
+void
+BaseManager::set_repo_config_override(BaseRepoConfigOverride config_override)
+{
+  std::lock_guard<std::mutex> lock(g_repo_config_mutex);
+  g_repo_config_override = std::move(config_override);
+}
+
+// -----------------------------------------------------------------------------
+// Copy the counters under the stats mutex.
+// -----------------------------------------------------------------------------
+BaseManagerStats
+BaseManager::stats() const
+{
+  std::lock_guard<std::mutex> lock(g_stats_mutex);
+  BaseManagerStats copy = g_stats;
+  if (g_write_holder) {
+    copy.write_holder = g_write_holder;
+    copy.write_held_for_us = elapsed_us_since(g_write_held_since);
+  }
+  return copy;
+}
+
+// -----------------------------------------------------------------------------
+// Format the counters as plain text for the debug menu and the service.
+// -----------------------------------------------------------------------------
+std::string
+BaseManager::diagnostics_report() const
+{
+  const BaseManagerStats current = stats();
+
+  std::ostringstream out;
+  out << "BaseManager diagnostics\n";
+  out << "  generation: " << current_generation() << "\n";
+  out << "  repo state: " << repo_state_label(current_repo_state()) << "\n";
+  if (current.write_holder.empty()) {
+    out << "  write holder: none\n";
+  } else {
+    out << "  write holder: " << current.write_holder << " (held " << current.write_held_for_us << "us)\n";
   }
+
+  out << "Lock wait\n";
+  append_histogram_line(out, "read", current.read_wait);
+  append_histogram_line(out, "write", current.write_wait);
+  out << "Lock hold\n";
+  append_histogram_line(out, "read", current.read_hold);
+  append_histogram_line(out, "write", current.write_hold);
+  for (const auto &[holder, histogram] : current.write_hold_by_holder) {
+    append_histogram_line(out, ("write by " + holder).c_str(), histogram);
+  }
+  out << "Preview forks\n";
+  out << "  built: " << current.forks_built << ", leased: " << current.fork_leases
+      << ", unavailable: " << current.fork_unavailable << "\n";
+  out << "Rebuild duration\n";
+  out << "  skipped unchanged: " << current.rebuilds_skipped << "\n";
+  out << "  released idle: " << current.idle_releases << "\n";
+  append_histogram_line(out, "full", current.rebuild_full);
+  append_histogram_line(out, "cache only metadata", current.rebuild_cache_only);
+  append_histogram_line(out, "system only", current.rebuild_system_only);
+  if (!current.last_repo_load.mode.empty()) {
+    out << base_repo_load_report_format(current.last_repo_load);
+  }
+
+  return out.str();
 }
 
 #ifdef DNFUI_BUILD_TESTS
@@ -312,9 +1151,16 @@ BaseManager::ensure_base_initialized()
 void
 BaseManager::reset_for_tests()
 {
-  std::unique_lock<std::shared_mutex> unique(base_mutex);
-  base_ptr.reset();
+  std::lock_guard<std::mutex> build(build_mutex);
+  std::lock_guard<std::mutex> lock(snapshot_mutex);
+  snapshot.reset();
+  fingerprint = BaseStateFingerprint();
   generation.store(0, std::memory_order_relaxed);
+  startup_mode.store(BaseStartupMode::LIVE_FIRST, std::memory_order_relaxed);
+  revalidation_pending.store(false, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> stats_lock(g_stats_mutex);
+  g_stats = BaseManagerStats();
 }
 #endif
 
@@ -3,44 +3,266 @@
 // -----------------------------------------------------------------------------
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <string>
+#include <vector>
 
 #include <libdnf5/base/base.hpp>
 
+#include "base_repo_load_timing.hpp"
+#include "base_state_fingerprint.hpp"
+
+// -----------------------------------------------------------------------------
+// A private Base loaded from the same inputs as one published snapshot. Goal
+// resolution changes solver state inside the Base it runs on, so each fork
+// serves one preview or apply at a time while the published Base stays
+// available to readers.
+// -----------------------------------------------------------------------------
+struct BaseFork {
+  std::shared_ptr<libdnf5::Base> base;
+  // Held by the preview or apply using this fork.
+  std::mutex mutex;
+  // Bumped under mutex for each lease, so a transaction resolved during one
+  // lease can tell whether another preview used the fork since.
+  uint64_t lease_serial = 0;
+};
+
+// -----------------------------------------------------------------------------
+// One published Base. Readers share its mutex and acquire_write takes it
+// exclusively. Rebuilds publish a new snapshot instead of locking this one, so
+// readers that still hold it keep using the old Base until they finish.
+// -----------------------------------------------------------------------------
+struct BaseSnapshot {
+  std::shared_ptr<libdnf5::Base> base;
+  std::shared_mutex mutex;
+  // Inputs seen right after the repos were loaded. A fork is only used when
+  // it loads from exactly these inputs.
+  BaseStateFingerprint loaded_inputs;
+  // Forks built for this snapshot. They are dropped together with it.
+  std::mutex forks_mutex;
+  std::vector<std::shared_ptr<BaseFork>> forks;
+};
+
+// -----------------------------------------------------------------------------
+// Power-of-two latency histogram in microseconds. Bucket 0 counts zero-length
+// samples, bucket i counts samples in [2^(i-1), 2^i), and the last bucket also
+// takes everything longer.
+// -----------------------------------------------------------------------------
+struct BaseTimingHistogram {
+  static constexpr size_t kBucketCount = 32;
+
+  std::array<uint64_t, kBucketCount> buckets {};
+  uint64_t count = 0;
+  uint64_t total_us = 0;
+  uint64_t max_us = 0;
+
+  // -----------------------------------------------------------------------------
+  // Add one sample.
+  // -----------------------------------------------------------------------------
+  void record(uint64_t us);
+  // -----------------------------------------------------------------------------
+  // Return the upper bound of the bucket that holds the given fraction of all
+  // samples, clamped to the largest sample seen. Returns 0 when empty.
+  // -----------------------------------------------------------------------------
+  uint64_t approximate_percentile_us(double fraction) const;
+};
+
+// Lock kinds tracked by the BaseManager counters.
+enum class BaseAccessKind {
+  READ,
+  WRITE,
+};
+
+// -----------------------------------------------------------------------------
+// Copy of the BaseManager contention counters. Wait time runs from the acquire
+// call until the lock is held, hold time from then until the guard is
+// released. Rebuild durations are recorded per repo load attempt, including
+// attempts that failed and fell back to the next mode.
+// -----------------------------------------------------------------------------
+struct BaseManagerStats {
+  BaseTimingHistogram read_wait;
+  BaseTimingHistogram read_hold;
+  BaseTimingHistogram write_wait;
+  BaseTimingHistogram write_hold;
+  BaseTimingHistogram rebuild_full;
+  BaseTimingHistogram rebuild_cache_only;
+  BaseTimingHistogram rebuild_system_only;
+  // Per-repository timing of the most recent repo-backed load.
+  BaseRepoLoadReport last_repo_load;
+  // IF_CHANGED rebuilds that kept the current Base.
+  uint64_t rebuilds_skipped = 0;
+  // Forks loaded for previews, leases handed out, and acquire_fork calls that
+  // found no usable fork and left the caller to take the write lock.
+  uint64_t forks_built = 0;
+  uint64_t fork_leases = 0;
+  uint64_t fork_unavailable = 0;
+  // Bases dropped by release_idle.
+  uint64_t idle_releases = 0;
+  // Write hold time keyed by the caller name passed to acquire_write.
+  std::map<std::string, BaseTimingHistogram> write_hold_by_holder;
+  // Caller currently holding the write lock, or empty when it is free.
+  std::string write_holder;
+  uint64_t write_held_for_us = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Records how long one guard keeps its lock. Guards declare it last so it is
+// destroyed, and the hold time recorded, before the lock is released.
+// -----------------------------------------------------------------------------
+class BaseHoldTimer {
+  public:
+  // -----------------------------------------------------------------------------
+  // Start timing a lock that was just acquired. holder names the write caller.
+  // -----------------------------------------------------------------------------
+  BaseHoldTimer(BaseAccessKind kind, const char *holder);
+  // -----------------------------------------------------------------------------
+  // Take over the running timer so only the final owner records it.
+  // -----------------------------------------------------------------------------
+  BaseHoldTimer(BaseHoldTimer &&other) noexcept
+      : kind(other.kind)
+      , holder(other.holder)
+      , start(other.start)
+      , armed(other.armed)
+  {
+    other.armed = false;
+  }
+  BaseHoldTimer(const BaseHoldTimer &) = delete;
+  BaseHoldTimer &operator=(const BaseHoldTimer &) = delete;
+  BaseHoldTimer &operator=(BaseHoldTimer &&) = delete;
+  // -----------------------------------------------------------------------------
+  // Record the hold time when this timer is still armed.
+  // -----------------------------------------------------------------------------
+  ~BaseHoldTimer();
+
+  private:
+  BaseAccessKind kind;
+  const char *holder;
+  std::chrono::steady_clock::time_point start;
+  bool armed = true;
+};
+
 // -----------------------------------------------------------------------------
 // Lock guard helpers for thread-safe Base access
-// These small classes automatically hold a shared (read) or unique (write)
-// lock on the BaseManager mutex for the duration of a backend operation.
+// These small classes pin one Base snapshot and hold a shared (read) or unique
+// (write) lock on it for the duration of a backend operation.
 // -----------------------------------------------------------------------------
 class BaseGuard {
   public:
   // -----------------------------------------------------------------------------
-  // Take ownership of a shared BaseManager lock.
+  // Take ownership of a pinned snapshot and its shared lock.
   // -----------------------------------------------------------------------------
-  explicit BaseGuard(std::shared_lock<std::shared_mutex> &&l)
-      : lock(std::move(l))
+  BaseGuard(std::shared_ptr<BaseSnapshot> s, std::shared_lock<std::shared_mutex> &&l)
+      : snapshot(std::move(s))
+      , lock(std::move(l))
+      , hold_timer(BaseAccessKind::READ, nullptr)
   {
   }
 
   private:
+  // Declared before the lock so the lock is released before the snapshot.
+  std::shared_ptr<BaseSnapshot> snapshot;
   std::shared_lock<std::shared_mutex> lock;
+  BaseHoldTimer hold_timer;
 };
 
 class BaseWriteGuard {
   public:
   // -----------------------------------------------------------------------------
-  // Take ownership of a unique BaseManager lock.
-  // -----------------------------------------------------------------------------
-  explicit BaseWriteGuard(std::unique_lock<std::shared_mutex> &&l)
-      : lock(std::move(l))
+  // Take ownership of the build lock, a pinned snapshot, and its unique lock.
+  // holder names the caller for the write lock diagnostics.
+  // -----------------------------------------------------------------------------
+  BaseWriteGuard(std::unique_lock<std::mutex> &&b,
+                 std::shared_ptr<BaseSnapshot> s,
+                 std::unique_lock<std::shared_mutex> &&l,
+                 const char *holder)
+      : build_lock(std::move(b))
+      , snapshot(std::move(s))
+      , lock(std::move(l))
+      , hold_timer(BaseAccessKind::WRITE, holder)
   {
   }
 
   private:
+  // Keeps rebuilds from loading the rpmdb while a transaction changes it.
+  std::unique_lock<std::mutex> build_lock;
+  std::shared_ptr<BaseSnapshot> snapshot;
   std::unique_lock<std::shared_mutex> lock;
+  BaseHoldTimer hold_timer;
+};
+
+// -----------------------------------------------------------------------------
+// Exclusive use of one fork. An empty lease means no fork was available.
+// -----------------------------------------------------------------------------
+class BaseForkLease {
+  public:
+  BaseForkLease() = default;
+  // -----------------------------------------------------------------------------
+  // Take ownership of a locked fork and pin the snapshot it belongs to.
+  // -----------------------------------------------------------------------------
+  BaseForkLease(std::shared_ptr<BaseSnapshot> s,
+                std::shared_ptr<BaseFork> f,
+                std::unique_lock<std::mutex> &&l,
+                uint64_t snapshot_generation)
+      : snapshot(std::move(s))
+      , fork(std::move(f))
+      , lock(std::move(l))
+      , generation(snapshot_generation)
+  {
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return true when the lease holds a fork.
+  // -----------------------------------------------------------------------------
+  explicit operator bool() const
+  {
+    return fork != nullptr;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the leased Base. Only valid for a non-empty lease.
+  // -----------------------------------------------------------------------------
+  libdnf5::Base &base() const
+  {
+    return *fork->base;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the fork for a later reclaim_fork call.
+  // -----------------------------------------------------------------------------
+  const std::shared_ptr<BaseFork> &handle() const
+  {
+    return fork;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the lease serial this lease was given.
+  // -----------------------------------------------------------------------------
+  uint64_t serial() const
+  {
+    return fork ? fork->lease_serial : 0;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the generation of the snapshot the fork was loaded for.
+  // -----------------------------------------------------------------------------
+  uint64_t snapshot_generation() const
+  {
+    return generation;
+  }
+
+  private:
+  std::shared_ptr<BaseSnapshot> snapshot;
+  std::shared_ptr<BaseFork> fork;
+  std::unique_lock<std::mutex> lock;
+  uint64_t generation = 0;
 };
 
 // -----------------------------------------------------------------------------
@@ -62,6 +284,32 @@ enum class BaseRepoState {
   INSTALLED_ONLY,
 };
 
+// Whether a rebuild may be skipped.
+// IF_CHANGED keeps the current Base when its rpmdb, enabled repos, cached repo
+// metadata, and repo configuration are unchanged and no metadata has expired.
+// FORCE always builds a new Base, as the Refresh Repositories button does.
+enum class BaseRebuildPolicy {
+  IF_CHANGED,
+  FORCE,
+};
+
+// How the first Base is built.
+// LIVE_FIRST loads live metadata and falls back to cache only when that fails.
+// CACHED_FIRST publishes a Base from cached metadata at once and leaves the
+// live load to revalidate_live_metadata, so the first query never waits for
+// the network. It falls back to LIVE_FIRST when no usable cache exists.
+enum class BaseStartupMode {
+  LIVE_FIRST,
+  CACHED_FIRST,
+};
+
+// Repository configuration used in place of the system one. An empty field
+// keeps the system value. cachedir replaces both the user and system cache.
+struct BaseRepoConfigOverride {
+  std::string reposdir;
+  std::string cachedir;
+};
+
 // -----------------------------------------------------------------------------
 // Shared access point for the cached libdnf5 Base instance.
 // -----------------------------------------------------------------------------
@@ -77,9 +325,32 @@ class BaseManager {
   // -----------------------------------------------------------------------------
   BaseRead acquire_read();
   // -----------------------------------------------------------------------------
-  // Return write access to the cached Base with its lock guard.
+  // Return write access to the cached Base with its lock guard. holder is a
+  // static caller name shown in the diagnostics while the lock is held.
+  // -----------------------------------------------------------------------------
+  std::pair<libdnf5::Base &, BaseWriteGuard> acquire_write(const char *holder = "unknown");
+  // -----------------------------------------------------------------------------
+  // Lease a private fork of the published Base for goal resolution. Previews
+  // on different forks run in parallel and never block readers or each other.
+  // Returns an empty lease when every fork is busy or no fork loads from the
+  // same inputs, and the caller should then resolve under acquire_write.
+  // -----------------------------------------------------------------------------
+  BaseForkLease acquire_fork();
+  // -----------------------------------------------------------------------------
+  // Lease a fork of the published Base only when one is already loaded and
+  // idle. Never takes the build lock, so it cannot wait on a rebuild or build
+  // a new fork. Returns an empty lease otherwise.
+  // -----------------------------------------------------------------------------
+  BaseForkLease acquire_idle_fork();
+  // -----------------------------------------------------------------------------
+  // Lease the given fork again when it still belongs to the published Base and
+  // nobody leased it after serial. Returns an empty lease otherwise.
+  // -----------------------------------------------------------------------------
+  BaseForkLease reclaim_fork(const std::shared_ptr<BaseFork> &fork, uint64_t serial);
   // -----------------------------------------------------------------------------
-  std::pair<libdnf5::Base &, BaseWriteGuard> acquire_write();
+  // Return true when reclaim_fork would currently succeed for fork and serial.
+  // -----------------------------------------------------------------------------
+  bool fork_is_current(const std::shared_ptr<BaseFork> &fork, uint64_t serial) const;
 
   // -----------------------------------------------------------------------------
   // Return the current Base generation counter.
@@ -93,20 +364,111 @@ class BaseManager {
   // Return the repo state of the cached Base.
   // -----------------------------------------------------------------------------
   BaseRepoState current_repo_state() const;
+  // -----------------------------------------------------------------------------
+  // Return true when the published Base holds live repository metadata and
+  // nothing it was built from changed since. Never builds a Base, and returns
+  // false at once while another thread holds the build lock.
+  // -----------------------------------------------------------------------------
+  bool published_repo_base_is_current();
+  // -----------------------------------------------------------------------------
+  // Return true when a Base is published and the rpmdb or the libdnf5 system
+  // state it was built from changed on disk since. Reads file stamps only, so
+  // the GTK thread can call it.
+  // -----------------------------------------------------------------------------
+  bool published_installed_state_changed() const;
+  // -----------------------------------------------------------------------------
+  // Copy the inputs the published Base loaded its repos from, together with
+  // its generation. Returns false when the published Base is system-only.
+  // -----------------------------------------------------------------------------
+  bool published_repo_inputs(BaseStateFingerprint &inputs, uint64_t &snapshot_generation) const;
+  // -----------------------------------------------------------------------------
+  // Capture the inputs a repo-backed build would load now. Reads configuration
+  // and file stamps only, and throws when the configuration cannot be loaded.
+  // -----------------------------------------------------------------------------
+  static BaseStateFingerprint capture_repo_inputs();
 
   // -----------------------------------------------------------------------------
-  // Rebuild the cached Base from live metadata with fallback.
+  // Rebuild the cached Base from live metadata with fallback. Returns the
+  // current repo state without rebuilding when the policy allows it and
+  // nothing the Base was built from has changed. Once cancel is set, metadata
+  // downloads abort, no further fallback is tried, and the call throws with
+  // the published Base left in place.
+  // -----------------------------------------------------------------------------
+  BaseRepoState rebuild(BaseRebuildPolicy policy = BaseRebuildPolicy::IF_CHANGED,
+                        const std::atomic<bool> *cancel = nullptr);
   // -----------------------------------------------------------------------------
-  BaseRepoState rebuild();
+  // Rebuild the cached Base with the metadata of repo_id downloaded again and
+  // every other repo loaded from its cache, with the same fallback and cancel
+  // handling as rebuild. Throws std::invalid_argument when repo_id is not an
+  // enabled repo.
   // -----------------------------------------------------------------------------
-  // Rebuild the cached Base from the local rpmdb only.
+  BaseRepoState refresh_repo(const std::string &repo_id, const std::atomic<bool> *cancel = nullptr);
   // -----------------------------------------------------------------------------
-  void rebuild_system_only();
+  // Rebuild the cached Base from the local rpmdb only. Skipped under
+  // IF_CHANGED when the current Base is already system-only and the rpmdb is
+  // unchanged. cancel is checked before the rpmdb load starts.
+  // -----------------------------------------------------------------------------
+  void rebuild_system_only(BaseRebuildPolicy policy = BaseRebuildPolicy::IF_CHANGED,
+                           const std::atomic<bool> *cancel = nullptr);
   // -----------------------------------------------------------------------------
   // Initialize a system-only Base when no Base exists yet.
   // -----------------------------------------------------------------------------
   void ensure_system_only_initialized_if_needed();
 
+  // -----------------------------------------------------------------------------
+  // Choose how the first Base is built. Set this before the first acquire.
+  // -----------------------------------------------------------------------------
+  void set_startup_mode(BaseStartupMode mode)
+  {
+    startup_mode.store(mode, std::memory_order_relaxed);
+  }
+  // -----------------------------------------------------------------------------
+  // Return true when the published Base came from a cached-first startup and
+  // live metadata has not been loaded since.
+  // -----------------------------------------------------------------------------
+  bool live_revalidation_pending() const
+  {
+    return revalidation_pending.load(std::memory_order_relaxed);
+  }
+  // -----------------------------------------------------------------------------
+  // Load live metadata and swap it in, bumping the generation. When the live
+  // load fails the current Base is kept. Returns the resulting repo state.
+  // -----------------------------------------------------------------------------
+  BaseRepoState revalidate_live_metadata();
+  // -----------------------------------------------------------------------------
+  // Drop the published Base and its forks so an idle process does not keep the
+  // repository metadata resident, bumping the generation. The next acquire
+  // builds a Base again. Returns false without releasing anything while a
+  // build or write holds the Base, or when no Base is published.
+  // -----------------------------------------------------------------------------
+  bool release_idle();
+
+  // -----------------------------------------------------------------------------
+  // Limit how many repositories load their metadata concurrently. Zero keeps
+  // the libdnf5 max_parallel_downloads setting. Applies to later builds.
+  // -----------------------------------------------------------------------------
+  void set_repo_load_parallelism(unsigned limit);
+  // -----------------------------------------------------------------------------
+  // Set the function told about each finished repository download. It runs on
+  // the loading thread.
+  // -----------------------------------------------------------------------------
+  void set_repo_load_observer(BaseRepoLoadObserver observer);
+  // -----------------------------------------------------------------------------
+  // Load repositories from another repo directory and cache in later builds.
+  // The benchmark uses this to load synthetic repositories without touching
+  // the system configuration. The rpmdb is still the system one.
+  // -----------------------------------------------------------------------------
+  void set_repo_config_override(BaseRepoConfigOverride config_override);
+
+  // -----------------------------------------------------------------------------
+  // Return a copy of the lock contention and rebuild counters.
+  // -----------------------------------------------------------------------------
+  BaseManagerStats stats() const;
+  // -----------------------------------------------------------------------------
+  // Return a human-readable dump of the counters for debugging.
+  // -----------------------------------------------------------------------------
+  std::string diagnostics_report() const;
+
 #ifdef DNFUI_BUILD_TESTS
   // -----------------------------------------------------------------------------
   // Drop cached backend state for test setup.
@@ -129,21 +491,46 @@ class BaseManager {
   BaseManager &operator=(const BaseManager &) = delete;
 
   // -----------------------------------------------------------------------------
-  // Build a Base initialized from the local rpmdb only.
+  // Return the published snapshot and its generation, or nullptr when no Base
+  // has been built yet.
+  // -----------------------------------------------------------------------------
+  std::shared_ptr<BaseSnapshot> published_snapshot(uint64_t &snapshot_generation) const;
+  // -----------------------------------------------------------------------------
+  // Return the published snapshot, building the first Base when none exists.
+  // The caller must hold build_mutex.
+  // -----------------------------------------------------------------------------
+  std::shared_ptr<BaseSnapshot> ensure_snapshot_locked(uint64_t &snapshot_generation);
+  // -----------------------------------------------------------------------------
+  // Swap in a newly built Base. Only the pointer exchange runs under the
+  // snapshot mutex.
   // -----------------------------------------------------------------------------
-  std::shared_ptr<libdnf5::Base> build_initialized_system_only_base();
+  void publish_snapshot(std::shared_ptr<libdnf5::Base> base,
+                        BaseRepoState state,
+                        BaseStateFingerprint built_from,
+                        BaseStateFingerprint loaded_from,
+                        bool bump_generation);
   // -----------------------------------------------------------------------------
-  // Initialize the cached Base when it has not been built yet.
+  // Return true when a rebuild of the given kind would load the same inputs
+  // as the published Base. The caller must hold build_mutex.
   // -----------------------------------------------------------------------------
-  void ensure_base_initialized();
+  bool published_base_is_current(bool include_repos) const;
 
-  std::shared_ptr<libdnf5::Base> base_ptr;
+  std::shared_ptr<BaseSnapshot> snapshot;
   BaseRepoState repo_state = BaseRepoState::LIVE_METADATA;
+  // Inputs the published Base was built from.
+  BaseStateFingerprint fingerprint;
 
   std::atomic<uint64_t> generation { 0 };
+  std::atomic<BaseStartupMode> startup_mode { BaseStartupMode::LIVE_FIRST };
+  std::atomic<bool> revalidation_pending { false };
 
-  // Shared mutex allows many readers but only one writer
-  mutable std::shared_mutex base_mutex;
+  // Guards snapshot, repo_state, and fingerprint. Held only to copy or exchange
+  // the pointer.
+  mutable std::mutex snapshot_mutex;
+  // Serializes Base builds and write access, so only one rebuild loads repos
+  // at a time and no rebuild reads the rpmdb while a transaction runs. Readers
+  // never take it once the first Base is published.
+  std::mutex build_mutex;
 };
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,238 @@
+// -----------------------------------------------------------------------------
+// src/base_repo_load_timing.cpp
+// Per-repository timing for one Base repo load
+// Download times come from libdnf5 download callbacks. Metadata and solv cache
+// reuse are detected by comparing file stamps before and after the load.
+// -----------------------------------------------------------------------------
+#include "base_repo_load_timing.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+#include <utility>
+
+#include <libdnf5/repo/download_callbacks.hpp>
+#include <libdnf5/repo/repo_query.hpp>
+
+struct BaseRepoLoadRecorder::State {
+  std::mutex mutex;
+  BaseRepoLoadObserver observer;
+  const std::atomic<bool> *cancel = nullptr;
+  std::vector<BaseRepoLoadTiming> repos;
+  // Download descriptions are repo names or ids, so both map to one slot.
+  std::map<std::string, size_t> slot_by_label;
+  std::vector<std::filesystem::path> repomd_paths;
+  std::vector<std::filesystem::path> solv_paths;
+  std::vector<std::string> repomd_before;
+  std::vector<std::string> solv_before;
+};
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Return "size mtime" for one regular file, or an empty string when missing.
+// -----------------------------------------------------------------------------
+std::string
+file_stamp(const std::filesystem::path &path)
+{
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return {};
+  }
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return {};
+  }
+  return std::to_string(size) + " " + std::to_string(mtime.time_since_epoch().count());
+}
+
+// -----------------------------------------------------------------------------
+// Return the microseconds elapsed since start.
+// -----------------------------------------------------------------------------
+uint64_t
+elapsed_us_since(std::chrono::steady_clock::time_point start)
+{
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+// libdnf5 download callbacks that time each repository metadata download.
+class RepoLoadTimingCallbacks final : public libdnf5::repo::DownloadCallbacks {
+  public:
+  // -----------------------------------------------------------------------------
+  // Share the recorder state that collects the timings.
+  // -----------------------------------------------------------------------------
+  explicit RepoLoadTimingCallbacks(std::shared_ptr<BaseRepoLoadRecorder::State> state)
+      : state(std::move(state))
+  {
+  }
+
+  // -----------------------------------------------------------------------------
+  // Start timing one download.
+  // -----------------------------------------------------------------------------
+  void *add_new_download(void *, const char *description, double) override
+  {
+    auto *download = new Download;
+    download->start = std::chrono::steady_clock::now();
+    if (description) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      auto it = state->slot_by_label.find(description);
+      if (it != state->slot_by_label.end()) {
+        download->slot = it->second;
+      }
+    }
+    return download;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Abort the download once the caller cancelled the repo load.
+  // -----------------------------------------------------------------------------
+  int progress(void *, double, double) override
+  {
+    return state->cancel && state->cancel->load() ? ABORT : OK;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Record the download time and tell the observer which repo finished.
+  // -----------------------------------------------------------------------------
+  int end(void *user_cb_data, TransferStatus status, const char *) override
+  {
+    std::unique_ptr<Download> download(static_cast<Download *>(user_cb_data));
+    if (!download || download->slot == kNoSlot) {
+      return OK;
+    }
+
+    BaseRepoLoadTiming finished;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      BaseRepoLoadTiming &timing = state->repos[download->slot];
+      timing.download_us += elapsed_us_since(download->start);
+      timing.metadata_downloaded = timing.metadata_downloaded || status == TransferStatus::SUCCESSFUL;
+      timing.download_failed = status == TransferStatus::ERROR;
+      finished = timing;
+    }
+
+    if (state->observer) {
+      state->observer(finished);
+    }
+    return OK;
+  }
+
+  private:
+  static constexpr size_t kNoSlot = static_cast<size_t>(-1);
+
+  struct Download {
+    size_t slot = kNoSlot;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  std::shared_ptr<BaseRepoLoadRecorder::State> state;
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Snapshot the enabled repos and install the timing download callbacks.
+// -----------------------------------------------------------------------------
+BaseRepoLoadRecorder::BaseRepoLoadRecorder(libdnf5::Base &b,
+                                           std::string m,
+                                           BaseRepoLoadObserver observer,
+                                           const std::atomic<bool> *cancel)
+    : base(b)
+    , state(std::make_shared<State>())
+    , mode(std::move(m))
+    , start(std::chrono::steady_clock::now())
+{
+  state->observer = std::move(observer);
+  state->cancel = cancel;
+
+  libdnf5::repo::RepoQuery repos(base);
+  repos.filter_enabled(true);
+  for (const auto &repo : repos) {
+    const size_t slot = state->repos.size();
+    BaseRepoLoadTiming timing;
+    timing.repo_id = repo->get_id();
+    state->repos.push_back(timing);
+    state->slot_by_label.emplace(repo->get_id(), slot);
+    state->slot_by_label.emplace(repo->get_name(), slot);
+
+    const std::filesystem::path cachedir(repo->get_cachedir());
+    state->repomd_paths.push_back(cachedir / "repodata" / "repomd.xml");
+    state->solv_paths.push_back(cachedir / "solv" / (repo->get_id() + ".solv"));
+    state->repomd_before.push_back(file_stamp(state->repomd_paths.back()));
+    state->solv_before.push_back(file_stamp(state->solv_paths.back()));
+  }
+
+  base.set_download_callbacks(std::make_unique<RepoLoadTimingCallbacks>(state));
+}
+
+// -----------------------------------------------------------------------------
+// Clear the timing callbacks so later downloads on this Base are not recorded.
+// -----------------------------------------------------------------------------
+BaseRepoLoadRecorder::~BaseRepoLoadRecorder()
+{
+  base.set_download_callbacks(std::unique_ptr<libdnf5::repo::DownloadCallbacks>());
+}
+
+// -----------------------------------------------------------------------------
+// Compare the cache file stamps with the ones taken before the load.
+// -----------------------------------------------------------------------------
+BaseRepoLoadReport
+BaseRepoLoadRecorder::finish(bool succeeded)
+{
+  BaseRepoLoadReport report;
+  report.mode = mode;
+  report.total_us = elapsed_us_since(start);
+  report.succeeded = succeeded;
+
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    report.repos = state->repos;
+  }
+
+  for (size_t slot = 0; slot < report.repos.size(); ++slot) {
+    BaseRepoLoadTiming &timing = report.repos[slot];
+    // Stamps also catch downloads whose description did not name the repo.
+    if (file_stamp(state->repomd_paths[slot]) != state->repomd_before[slot]) {
+      timing.metadata_downloaded = true;
+    }
+    timing.solv_cache_hit =
+        !state->solv_before[slot].empty() && file_stamp(state->solv_paths[slot]) == state->solv_before[slot];
+  }
+
+  std::stable_sort(report.repos.begin(), report.repos.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.download_us > rhs.download_us;
+  });
+  return report;
+}
+
+// -----------------------------------------------------------------------------
+// Format the report with the slowest repositories first.
+// -----------------------------------------------------------------------------
+std::string
+base_repo_load_report_format(const BaseRepoLoadReport &report)
+{
+  std::ostringstream out;
+  out << "Repository load (" << report.mode << "): " << report.total_us / 1000 << " ms, "
+      << (report.succeeded ? "ok" : "failed") << "\n";
+  for (const auto &timing : report.repos) {
+    out << "  " << timing.repo_id << ": ";
+    if (timing.download_failed) {
+      out << "download failed after " << timing.download_us / 1000 << " ms";
+    } else if (timing.metadata_downloaded) {
+      out << "downloaded in " << timing.download_us / 1000 << " ms";
+    } else {
+      out << "cached metadata";
+    }
+    out << ", solv cache " << (timing.solv_cache_hit ? "hit" : "miss") << "\n";
+  }
+  return out.str();
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
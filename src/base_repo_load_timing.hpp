@@ -0,0 +1,91 @@
+// -----------------------------------------------------------------------------
+// src/base_repo_load_timing.hpp
+// Per-repository timing for one Base repo load
+//
+// libdnf5 loads all enabled repositories in one load_repos call. This records
+// which repositories downloaded metadata, how long each download took, and
+// whether the solv cache from an earlier load was reused, so a slow startup
+// can be traced to one mirror or repository.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libdnf5/base/base.hpp>
+
+// -----------------------------------------------------------------------------
+// Timing for one enabled repository.
+// -----------------------------------------------------------------------------
+struct BaseRepoLoadTiming {
+  std::string repo_id;
+  // Wall time spent downloading metadata. Zero when the cached copy was used.
+  uint64_t download_us = 0;
+  bool metadata_downloaded = false;
+  bool download_failed = false;
+  // True when the solv cache written by an earlier load was reused unchanged.
+  bool solv_cache_hit = false;
+};
+
+// -----------------------------------------------------------------------------
+// Timing for one load_repos call.
+// -----------------------------------------------------------------------------
+struct BaseRepoLoadReport {
+  std::string mode;
+  uint64_t total_us = 0;
+  bool succeeded = false;
+  std::vector<BaseRepoLoadTiming> repos;
+};
+
+// Called from the loading thread whenever one repository finished downloading.
+using BaseRepoLoadObserver = std::function<void(const BaseRepoLoadTiming &timing)>;
+
+// -----------------------------------------------------------------------------
+// Records one repo load of a configured Base. Construct it right before
+// load_repos and call finish afterwards. The recorder installs download
+// callbacks on the Base and clears them again when destroyed.
+// -----------------------------------------------------------------------------
+class BaseRepoLoadRecorder {
+  public:
+  // -----------------------------------------------------------------------------
+  // Snapshot the enabled repos and their solv caches and start the clock.
+  // Metadata downloads abort once cancel is set.
+  // -----------------------------------------------------------------------------
+  BaseRepoLoadRecorder(libdnf5::Base &base,
+                       std::string mode,
+                       BaseRepoLoadObserver observer,
+                       const std::atomic<bool> *cancel = nullptr);
+  BaseRepoLoadRecorder(const BaseRepoLoadRecorder &) = delete;
+  BaseRepoLoadRecorder &operator=(const BaseRepoLoadRecorder &) = delete;
+  // -----------------------------------------------------------------------------
+  // Clear the download callbacks installed by the constructor.
+  // -----------------------------------------------------------------------------
+  ~BaseRepoLoadRecorder();
+
+  // -----------------------------------------------------------------------------
+  // Stop the clock and return the report, sorted by slowest download first.
+  // -----------------------------------------------------------------------------
+  BaseRepoLoadReport finish(bool succeeded);
+
+  struct State;
+
+  private:
+  libdnf5::Base &base;
+  std::shared_ptr<State> state;
+  std::string mode;
+  std::chrono::steady_clock::time_point start;
+};
+
+// -----------------------------------------------------------------------------
+// Format one report as plain text, one line per repository.
+// -----------------------------------------------------------------------------
+std::string base_repo_load_report_format(const BaseRepoLoadReport &report);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,235 @@
+// -----------------------------------------------------------------------------
+// src/base_state_fingerprint.cpp
+// Cheap change detection for the inputs of one Base build
+// Reads only file metadata and repository configuration. Nothing here loads
+// repository metadata or opens the rpmdb.
+// -----------------------------------------------------------------------------
+#include "base_state_fingerprint.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#include <libdnf5/repo/repo_query.hpp>
+
+namespace {
+
+// Installed-package state relative to the install root. Fedora keeps the rpmdb
+// in /usr/lib/sysimage/rpm and /var/lib/rpm is usually a compatibility link.
+// libdnf5 keeps install reasons and the transaction history in its system
+// state directory, and `dnf mark` changes only those.
+const char *const kInstalledStateDirectories[] = {
+  "usr/lib/sysimage/rpm",
+  "var/lib/rpm",
+  "usr/lib/sysimage/libdnf5",
+};
+
+// Default dnf and repository configuration directories. Only the startup
+// stamps use them, since no Base config is loaded yet at that point.
+const char *const kDefaultConfigDirectories[] = {
+  "/etc/dnf",
+  "/etc/yum.repos.d",
+  "/etc/distro.repos.d",
+};
+
+// -----------------------------------------------------------------------------
+// Append one "path size mtime" stamp when path names a regular file.
+// -----------------------------------------------------------------------------
+void
+append_file_stamp(std::vector<std::string> &stamps, const std::filesystem::path &path)
+{
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(path, ec)) {
+    return;
+  }
+
+  const auto size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return;
+  }
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return;
+  }
+
+  stamps.push_back(path.string() + " " + std::to_string(size) + " " +
+                   std::to_string(mtime.time_since_epoch().count()));
+}
+
+// -----------------------------------------------------------------------------
+// Return the path part of one "path size mtime" stamp. The path may contain
+// spaces, so the two numbers are split off from the end.
+// -----------------------------------------------------------------------------
+std::string
+stamp_path(const std::string &stamp)
+{
+  const size_t mtime_at = stamp.rfind(' ');
+  if (mtime_at == std::string::npos || mtime_at == 0) {
+    return stamp;
+  }
+  const size_t size_at = stamp.rfind(' ', mtime_at - 1);
+  return size_at == std::string::npos ? stamp : stamp.substr(0, size_at);
+}
+
+// -----------------------------------------------------------------------------
+// Return true when entry is the "id stamp" or "id no-cache" entry of repo_id.
+// Config file stamps start with an absolute path and never match a repo id.
+// -----------------------------------------------------------------------------
+bool
+is_repo_entry_for(const std::string &entry, const std::string &repo_id)
+{
+  return entry.size() > repo_id.size() && entry.starts_with(repo_id) && entry[repo_id.size()] == ' ';
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Drop the entry of repo_id from both sides before comparing the repo entries.
+// A repo that was enabled or disabled since still counts as a change.
+// -----------------------------------------------------------------------------
+bool
+BaseStateFingerprint::same_inputs_except_repo(const BaseStateFingerprint &other, const std::string &repo_id) const
+{
+  if (includes_repos != other.includes_repos || rpmdb_files != other.rpmdb_files) {
+    return false;
+  }
+
+  auto without_repo = [&repo_id](const std::vector<std::string> &entries, bool &found) {
+    std::vector<std::string> kept;
+    kept.reserve(entries.size());
+    for (const auto &entry : entries) {
+      if (is_repo_entry_for(entry, repo_id)) {
+        found = true;
+      } else {
+        kept.push_back(entry);
+      }
+    }
+    return kept;
+  };
+  bool found_here = false;
+  bool found_there = false;
+  const auto mine = without_repo(repo_entries, found_here);
+  const auto theirs = without_repo(other.repo_entries, found_there);
+  return found_here == found_there && mine == theirs;
+}
+
+// -----------------------------------------------------------------------------
+// List the rpmdb and libdnf5 system state directories under one install root.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+base_state_fingerprint_installed_state_directories(const std::string &installroot)
+{
+  std::vector<std::string> directories;
+  for (const char *directory : kInstalledStateDirectories) {
+    directories.push_back((std::filesystem::path(installroot) / directory).string());
+  }
+  return directories;
+}
+
+// -----------------------------------------------------------------------------
+// SQLite rewrites its shared-memory index while readers load a database, so
+// that file changes without any package change and must not count as one.
+// -----------------------------------------------------------------------------
+bool
+base_state_fingerprint_tracks_file(const std::string &path)
+{
+  return !path.ends_with("-shm");
+}
+
+// -----------------------------------------------------------------------------
+// Stamp the installed-package state files under one install root.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+base_state_fingerprint_installed_state_stamps(const std::string &installroot)
+{
+  std::vector<std::string> stamps =
+      base_state_fingerprint_file_stamps(base_state_fingerprint_installed_state_directories(installroot));
+  std::erase_if(stamps,
+                [](const std::string &stamp) { return !base_state_fingerprint_tracks_file(stamp_path(stamp)); });
+  return stamps;
+}
+
+// -----------------------------------------------------------------------------
+// Stamp every regular file in the given directories without recursing.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+base_state_fingerprint_file_stamps(const std::vector<std::string> &directories)
+{
+  std::vector<std::string> stamps;
+  for (const auto &directory : directories) {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(directory, ec);
+    if (ec) {
+      continue;
+    }
+    for (const auto &entry : it) {
+      append_file_stamp(stamps, entry.path());
+    }
+  }
+
+  std::sort(stamps.begin(), stamps.end());
+  return stamps;
+}
+
+// -----------------------------------------------------------------------------
+// Capture the rpmdb stamps, and for repo-backed builds the enabled repo ids,
+// their cached repomd.xml stamps, and the configuration file stamps.
+// -----------------------------------------------------------------------------
+BaseStateFingerprint
+base_state_fingerprint_capture(libdnf5::Base &base, bool include_repos)
+{
+  BaseStateFingerprint fingerprint;
+  fingerprint.includes_repos = include_repos;
+  fingerprint.captured_at = std::chrono::steady_clock::now();
+
+  auto &config = base.get_config();
+  fingerprint.installroot = config.get_installroot_option().get_value();
+  fingerprint.rpmdb_files = base_state_fingerprint_installed_state_stamps(fingerprint.installroot);
+
+  if (!include_repos) {
+    return fingerprint;
+  }
+
+  std::vector<std::string> repo_ids;
+  libdnf5::repo::RepoQuery repos(base);
+  repos.filter_enabled(true);
+  for (const auto &repo : repos) {
+    std::vector<std::string> repomd;
+    append_file_stamp(repomd, std::filesystem::path(repo->get_cachedir()) / "repodata" / "repomd.xml");
+    repo_ids.push_back(repo->get_id() + (repomd.empty() ? std::string(" no-cache") : " " + repomd.front()));
+
+    const int64_t expire = repo->get_config().get_metadata_expire_option().get_value();
+    if (expire >= 0 && (fingerprint.metadata_expire_seconds < 0 || expire < fingerprint.metadata_expire_seconds)) {
+      fingerprint.metadata_expire_seconds = expire;
+    }
+  }
+  std::sort(repo_ids.begin(), repo_ids.end());
+
+  // Configuration edits can change a repo URL without changing the enabled
+  // set, so the config file stamps are part of the fingerprint too.
+  std::vector<std::string> config_files =
+      base_state_fingerprint_file_stamps(config.get_reposdir_option().get_value());
+  append_file_stamp(config_files, config.get_config_file_path_option().get_value());
+
+  fingerprint.repo_entries = std::move(repo_ids);
+  fingerprint.repo_entries.insert(fingerprint.repo_entries.end(), config_files.begin(), config_files.end());
+  return fingerprint;
+}
+
+// -----------------------------------------------------------------------------
+// Stamp the host installed-package state and the default configuration
+// directories.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+base_state_fingerprint_startup_stamps()
+{
+  std::vector<std::string> stamps = base_state_fingerprint_installed_state_stamps("/");
+  std::vector<std::string> config_dirs(std::begin(kDefaultConfigDirectories), std::end(kDefaultConfigDirectories));
+  std::vector<std::string> config_files = base_state_fingerprint_file_stamps(config_dirs);
+  stamps.insert(stamps.end(), config_files.begin(), config_files.end());
+  return stamps;
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
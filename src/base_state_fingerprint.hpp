@@ -0,0 +1,103 @@
+// -----------------------------------------------------------------------------
+// src/base_state_fingerprint.hpp
+// Cheap change detection for the inputs of one Base build
+//
+// A full Base rebuild reloads all repository metadata. Before doing that,
+// BaseManager compares the rpmdb and libdnf5 system state files, the enabled
+// repository set, the cached repomd.xml files, and the repository
+// configuration files against the values seen when the current Base was
+// built, and skips the rebuild when none of them changed.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <libdnf5/base/base.hpp>
+
+// -----------------------------------------------------------------------------
+// File stamps and repository settings that one Base build depended on.
+// -----------------------------------------------------------------------------
+struct BaseStateFingerprint {
+  // Install root the stamps below were taken under.
+  std::string installroot;
+  // Sorted "path size mtime" stamps for the rpmdb files and the libdnf5 system
+  // state files that hold install reasons and the transaction history.
+  std::vector<std::string> rpmdb_files;
+  // Sorted enabled repo ids with their repomd.xml stamps, followed by the
+  // main and repository configuration file stamps. Empty for system-only
+  // fingerprints.
+  std::vector<std::string> repo_entries;
+  bool includes_repos = false;
+  // Shortest positive metadata_expire of the enabled repos in seconds, or -1
+  // when no enabled repo expires.
+  int64_t metadata_expire_seconds = -1;
+  std::chrono::steady_clock::time_point captured_at;
+
+  // -----------------------------------------------------------------------------
+  // Compare the recorded inputs. The capture time is not part of the identity.
+  // -----------------------------------------------------------------------------
+  bool same_inputs(const BaseStateFingerprint &other) const
+  {
+    return includes_repos == other.includes_repos && rpmdb_files == other.rpmdb_files &&
+           repo_entries == other.repo_entries;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Compare the recorded inputs while ignoring the entry of one repo id, so a
+  // refresh of that repo alone can tell that nothing else changed.
+  // -----------------------------------------------------------------------------
+  bool same_inputs_except_repo(const BaseStateFingerprint &other, const std::string &repo_id) const;
+
+  // -----------------------------------------------------------------------------
+  // Return true when cached metadata may have expired since the capture, so a
+  // normal repo load could download newer metadata.
+  // -----------------------------------------------------------------------------
+  bool metadata_may_be_expired(std::chrono::steady_clock::time_point now) const
+  {
+    return includes_repos && metadata_expire_seconds >= 0 &&
+           now - captured_at >= std::chrono::seconds(metadata_expire_seconds);
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Capture the fingerprint of one configured Base before its repos are loaded.
+// include_repos adds the enabled repository set and its cached metadata.
+// -----------------------------------------------------------------------------
+BaseStateFingerprint base_state_fingerprint_capture(libdnf5::Base &base, bool include_repos);
+
+// -----------------------------------------------------------------------------
+// Return sorted "path size mtime" stamps for the regular files in the given
+// directories. Missing directories contribute nothing.
+// -----------------------------------------------------------------------------
+std::vector<std::string> base_state_fingerprint_file_stamps(const std::vector<std::string> &directories);
+
+// -----------------------------------------------------------------------------
+// Return the directories under installroot whose files make up the installed
+// package state: the rpmdb and the libdnf5 system state.
+// -----------------------------------------------------------------------------
+std::vector<std::string> base_state_fingerprint_installed_state_directories(const std::string &installroot);
+// -----------------------------------------------------------------------------
+// Return false for files in those directories that change without any package
+// change, such as SQLite shared-memory indexes.
+// -----------------------------------------------------------------------------
+bool base_state_fingerprint_tracks_file(const std::string &path);
+// -----------------------------------------------------------------------------
+// Return the sorted stamps of the tracked installed-state files under
+// installroot. This is the rpmdb_files part of a fingerprint.
+// -----------------------------------------------------------------------------
+std::vector<std::string> base_state_fingerprint_installed_state_stamps(const std::string &installroot);
+
+// -----------------------------------------------------------------------------
+// Return stamps that can be taken before any Base exists: the installed-state
+// files of the host and the files in the default dnf and repository
+// configuration directories. The last-session view snapshot is tagged with
+// them.
+// -----------------------------------------------------------------------------
+std::vector<std::string> base_state_fingerprint_startup_stamps();
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
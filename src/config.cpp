@@ -21,6 +21,9 @@ constexpr int DEFAULT_WINDOW_WIDTH = 1200;
 constexpr int DEFAULT_WINDOW_HEIGHT = 820;
 constexpr int MIN_WINDOW_WIDTH = 600;
 constexpr int MIN_WINDOW_HEIGHT = 400;
+constexpr int DEFAULT_SEARCH_CACHE_MB = 64;
+constexpr int DEFAULT_IDLE_RECLAIM_MINUTES = 30;
+constexpr int DEFAULT_PREWARM_SEARCHES = 8;
 
 // -----------------------------------------------------------------------------
 // Return the user config file path.
@@ -133,6 +136,67 @@ config_load_paned_position()
   return DEFAULT_PANED_POSITION;
 }
 
+// -----------------------------------------------------------------------------
+// Load the search result cache budget. The key is only read, so it is set by
+// editing the config file, e.g. search_cache_mb=256 on a large repo set.
+// -----------------------------------------------------------------------------
+size_t
+config_load_search_cache_bytes()
+{
+  auto config = config_load_map();
+  int megabytes = DEFAULT_SEARCH_CACHE_MB;
+  if (!config_try_parse_int(config, "search_cache_mb", megabytes) || megabytes < 0) {
+    megabytes = DEFAULT_SEARCH_CACHE_MB;
+  }
+
+  return static_cast<size_t>(megabytes) * 1024 * 1024;
+}
+
+// -----------------------------------------------------------------------------
+// Load how long the window may stay idle before cached query state is dropped.
+// Read-only like search_cache_mb; idle_reclaim_minutes=0 turns reclaiming off.
+// -----------------------------------------------------------------------------
+unsigned
+config_load_idle_reclaim_seconds()
+{
+  auto config = config_load_map();
+  int minutes = DEFAULT_IDLE_RECLAIM_MINUTES;
+  if (!config_try_parse_int(config, "idle_reclaim_minutes", minutes) || minutes < 0) {
+    minutes = DEFAULT_IDLE_RECLAIM_MINUTES;
+  }
+
+  return static_cast<unsigned>(minutes) * 60;
+}
+
+// -----------------------------------------------------------------------------
+// Load whether an idle reclaim also drops the libdnf5 Base. Off unless the
+// config file sets idle_release_base=1, since the next query reloads the repos.
+// -----------------------------------------------------------------------------
+bool
+config_load_idle_release_base()
+{
+  auto config = config_load_map();
+  int enabled = 0;
+  return config_try_parse_int(config, "idle_release_base", enabled) && enabled != 0;
+}
+
+// -----------------------------------------------------------------------------
+// Load how many of the most used history searches are computed ahead of time
+// after each Base rebuild. Read-only like search_cache_mb; prewarm_searches=0
+// turns it off.
+// -----------------------------------------------------------------------------
+unsigned
+config_load_prewarm_search_count()
+{
+  auto config = config_load_map();
+  int count = DEFAULT_PREWARM_SEARCHES;
+  if (!config_try_parse_int(config, "prewarm_searches", count) || count < 0) {
+    count = DEFAULT_PREWARM_SEARCHES;
+  }
+
+  return static_cast<unsigned>(count);
+}
+
 // -----------------------------------------------------------------------------
 // Save the current divider position.
 // -----------------------------------------------------------------------------
@@ -3,6 +3,7 @@
 // -----------------------------------------------------------------------------
 #pragma once
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <gtk/gtk.h>
@@ -16,6 +17,22 @@ std::map<std::string, std::string> config_load_map();
 // -----------------------------------------------------------------------------
 int config_load_paned_position();
 // -----------------------------------------------------------------------------
+// Load the search result cache byte budget.
+// -----------------------------------------------------------------------------
+size_t config_load_search_cache_bytes();
+// -----------------------------------------------------------------------------
+// Load the idle period before cached state is reclaimed, or 0 when disabled.
+// -----------------------------------------------------------------------------
+unsigned config_load_idle_reclaim_seconds();
+// -----------------------------------------------------------------------------
+// Load whether an idle reclaim also releases the libdnf5 Base.
+// -----------------------------------------------------------------------------
+bool config_load_idle_release_base();
+// -----------------------------------------------------------------------------
+// Load how many frequent history searches are computed ahead of time.
+// -----------------------------------------------------------------------------
+unsigned config_load_prewarm_search_count();
+// -----------------------------------------------------------------------------
 // Save the full configuration key value map.
 // -----------------------------------------------------------------------------
 void config_save_map(const std::map<std::string, std::string> &config);
@@ -0,0 +1,446 @@
+// -----------------------------------------------------------------------------
+// src/debug_trace.cpp
+// Debug trace rings and flush thread
+// Every thread that traces owns one single-producer ring of fixed-size
+// records. The flush thread is the only consumer, except for the crash path,
+// which reads the rings without advancing them. Rings are never freed: a ring
+// left by an exited thread is adopted by the next new thread once it is empty,
+// so memory stays bounded by the peak number of tracing threads.
+// -----------------------------------------------------------------------------
+#include "debug_trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include <unistd.h>
+
+std::atomic<bool> g_debug_trace_enabled { false };
+
+namespace {
+
+// One record holds the timestamp, the thread, and the formatted text.
+constexpr size_t kTraceRecordSize = 256;
+constexpr size_t kTraceTextCapacity = kTraceRecordSize - sizeof(uint64_t) - 2 * sizeof(uint32_t);
+// Records per ring. A power of two, 256 KiB per tracing thread.
+constexpr uint64_t kTraceRingRecords = 1024;
+constexpr size_t kMaxTraceRings = 256;
+constexpr auto kTraceFlushInterval = std::chrono::milliseconds(50);
+
+struct TraceRecord {
+  uint64_t time_us;
+  uint32_t thread_id;
+  uint32_t length;
+  char text[kTraceTextCapacity];
+};
+static_assert(sizeof(TraceRecord) == kTraceRecordSize);
+
+struct TraceRing {
+  std::atomic<bool> in_use { true };
+  // head is written only by the owning thread and tail only by the consumer.
+  alignas(64) std::atomic<uint64_t> head { 0 };
+  alignas(64) std::atomic<uint64_t> tail { 0 };
+  std::atomic<uint64_t> dropped { 0 };
+  TraceRecord records[kTraceRingRecords];
+};
+
+// -----------------------------------------------------------------------------
+// Release the ring of an exiting thread so a later thread can adopt it.
+// -----------------------------------------------------------------------------
+struct TraceRingOwner {
+  TraceRing *ring = nullptr;
+  bool unavailable = false;
+
+  ~TraceRingOwner()
+  {
+    if (ring) {
+      ring->in_use.store(false, std::memory_order_release);
+    }
+  }
+};
+
+struct DrainedTraceLine {
+  uint64_t time_us;
+  uint32_t thread_id;
+  std::string text;
+};
+
+std::atomic<TraceRing *> g_trace_rings[kMaxTraceRings];
+std::atomic<uint32_t> g_next_trace_thread_id { 1 };
+std::atomic<uint64_t> g_unringed_drops { 0 };
+const std::chrono::steady_clock::time_point g_trace_start = std::chrono::steady_clock::now();
+
+// The flush thread and the final drain are the only consumers.
+std::mutex g_drain_mutex;
+std::mutex g_flusher_mutex;
+std::condition_variable g_flusher_cv;
+bool g_flusher_stop = false;
+std::thread g_flusher;
+
+thread_local TraceRingOwner t_trace_ring;
+
+// -----------------------------------------------------------------------------
+// Return microseconds since the trace clock started.
+// -----------------------------------------------------------------------------
+uint64_t
+trace_now_us()
+{
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_trace_start).count());
+}
+
+// -----------------------------------------------------------------------------
+// Return a small id for the calling thread, assigned on its first line.
+// -----------------------------------------------------------------------------
+uint32_t
+current_trace_thread_id()
+{
+  thread_local uint32_t id = g_next_trace_thread_id.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+
+// -----------------------------------------------------------------------------
+// Adopt an empty ring left by an exited thread, or register a new one. Returns
+// nullptr when every ring slot is taken.
+// -----------------------------------------------------------------------------
+TraceRing *
+acquire_trace_ring()
+{
+  for (auto &slot : g_trace_rings) {
+    TraceRing *ring = slot.load(std::memory_order_acquire);
+    if (!ring) {
+      continue;
+    }
+    bool expected = false;
+    if (!ring->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+      continue;
+    }
+    if (ring->tail.load(std::memory_order_acquire) == ring->head.load(std::memory_order_relaxed)) {
+      return ring;
+    }
+    // Still holds lines of the previous thread; leave it to the flush thread.
+    ring->in_use.store(false, std::memory_order_release);
+  }
+
+  auto *ring = new TraceRing;
+  for (auto &slot : g_trace_rings) {
+    TraceRing *expected = nullptr;
+    if (slot.compare_exchange_strong(expected, ring, std::memory_order_acq_rel)) {
+      return ring;
+    }
+  }
+  delete ring;
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Move every buffered record out of the rings. Callers hold g_drain_mutex.
+// -----------------------------------------------------------------------------
+std::vector<DrainedTraceLine>
+drain_trace_rings()
+{
+  std::vector<DrainedTraceLine> lines;
+  const uint64_t now_us = trace_now_us();
+
+  for (auto &slot : g_trace_rings) {
+    TraceRing *ring = slot.load(std::memory_order_acquire);
+    if (!ring) {
+      continue;
+    }
+
+    const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    for (uint64_t i = tail; i < head; ++i) {
+      const TraceRecord &record = ring->records[i & (kTraceRingRecords - 1)];
+      lines.push_back({ record.time_us, record.thread_id, std::string(record.text, record.length) });
+    }
+    ring->tail.store(head, std::memory_order_release);
+
+    const uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+      lines.push_back({ now_us, 0, "dropped " + std::to_string(dropped) + " trace lines, ring full" });
+    }
+  }
+
+  const uint64_t unringed = g_unringed_drops.exchange(0, std::memory_order_relaxed);
+  if (unringed > 0) {
+    lines.push_back({ now_us, 0, "dropped " + std::to_string(unringed) + " trace lines, no free ring" });
+  }
+
+  // Records of one thread are already in order; merge the threads by time.
+  std::stable_sort(lines.begin(), lines.end(), [](const DrainedTraceLine &a, const DrainedTraceLine &b) {
+    return a.time_us < b.time_us;
+  });
+  return lines;
+}
+
+// -----------------------------------------------------------------------------
+// Format one drained line the way it is printed.
+// -----------------------------------------------------------------------------
+std::string
+format_trace_line(const DrainedTraceLine &line)
+{
+  char prefix[64];
+  std::snprintf(prefix,
+                sizeof prefix,
+                "[trace] %llu.%06llu t%u ",
+                static_cast<unsigned long long>(line.time_us / 1000000),
+                static_cast<unsigned long long>(line.time_us % 1000000),
+                line.thread_id);
+  return prefix + line.text;
+}
+
+// -----------------------------------------------------------------------------
+// Drain the rings and write the lines to stdout.
+// -----------------------------------------------------------------------------
+void
+flush_trace_rings()
+{
+  std::lock_guard<std::mutex> lock(g_drain_mutex);
+  const std::vector<DrainedTraceLine> lines = drain_trace_rings();
+  if (lines.empty()) {
+    return;
+  }
+
+  std::string out;
+  for (const auto &line : lines) {
+    out += format_trace_line(line);
+    out += '\n';
+  }
+  std::fwrite(out.data(), 1, out.size(), stdout);
+  std::fflush(stdout);
+}
+
+// -----------------------------------------------------------------------------
+// Drain the rings on an interval until shutdown asks the thread to stop.
+// -----------------------------------------------------------------------------
+void
+run_trace_flusher()
+{
+  std::unique_lock<std::mutex> lock(g_flusher_mutex);
+  while (!g_flusher_stop) {
+    g_flusher_cv.wait_for(lock, kTraceFlushInterval, [] { return g_flusher_stop; });
+    lock.unlock();
+    flush_trace_rings();
+    lock.lock();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Write text to stdout from a signal handler.
+// -----------------------------------------------------------------------------
+void
+write_signal_safe(const char *text, size_t length)
+{
+  while (length > 0) {
+    const ssize_t written = write(STDOUT_FILENO, text, length);
+    if (written <= 0) {
+      return;
+    }
+    text += written;
+    length -= static_cast<size_t>(written);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Write value in decimal, zero padded to width, from a signal handler.
+// -----------------------------------------------------------------------------
+void
+write_signal_safe_number(uint64_t value, int width)
+{
+  char digits[24];
+  int count = 0;
+  do {
+    digits[sizeof digits - 1 - count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value > 0 || count < width);
+  write_signal_safe(digits + sizeof digits - count, static_cast<size_t>(count));
+}
+
+// -----------------------------------------------------------------------------
+// Write the buffered lines on a fatal or termination signal, then let the
+// default action run. Only write() is used, and the rings are read without
+// moving their tails, so a batch the flush thread was writing at the same
+// moment can appear twice.
+// -----------------------------------------------------------------------------
+void
+on_trace_fatal_signal(int signum)
+{
+  for (auto &slot : g_trace_rings) {
+    TraceRing *ring = slot.load(std::memory_order_acquire);
+    if (!ring) {
+      continue;
+    }
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    for (uint64_t i = ring->tail.load(std::memory_order_acquire); i < head; ++i) {
+      const TraceRecord &record = ring->records[i & (kTraceRingRecords - 1)];
+      write_signal_safe("[trace] ", 8);
+      write_signal_safe_number(record.time_us / 1000000, 1);
+      write_signal_safe(".", 1);
+      write_signal_safe_number(record.time_us % 1000000, 6);
+      write_signal_safe(" t", 2);
+      write_signal_safe_number(record.thread_id, 1);
+      write_signal_safe(" ", 1);
+      write_signal_safe(record.text, record.length);
+      write_signal_safe("\n", 1);
+    }
+  }
+
+  // SA_RESETHAND already restored the default action.
+  std::raise(signum);
+}
+
+// -----------------------------------------------------------------------------
+// Install the signal handler for crashes and termination. Handlers installed
+// later, like the service's SIGINT and SIGTERM handlers, take precedence and
+// reach the normal shutdown flush instead.
+// -----------------------------------------------------------------------------
+void
+install_trace_signal_handlers()
+{
+  struct sigaction action = {};
+  action.sa_handler = on_trace_fatal_signal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESETHAND;
+  for (int signum : { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGINT, SIGTERM }) {
+    sigaction(signum, &action, nullptr);
+  }
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// An empty DNFUI_DEBUG_TRACE keeps the build default.
+// -----------------------------------------------------------------------------
+void
+debug_trace_init()
+{
+#ifdef DNFUI_DEBUG_TRACE
+  bool enabled = true;
+#else
+  bool enabled = false;
+#endif
+  const char *value = std::getenv("DNFUI_DEBUG_TRACE");
+  if (value && *value) {
+    enabled = std::strcmp(value, "0") != 0;
+  }
+  if (!enabled || g_flusher.joinable()) {
+    return;
+  }
+
+  install_trace_signal_handlers();
+  g_flusher_stop = false;
+  g_flusher = std::thread(run_trace_flusher);
+  // Runs before the static destructors, so the joinable thread is never
+  // destroyed, and covers every return from main.
+  std::atexit(debug_trace_shutdown);
+  g_debug_trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Lines recorded by threads still running after this call are not written.
+// -----------------------------------------------------------------------------
+void
+debug_trace_shutdown()
+{
+  g_debug_trace_enabled.store(false, std::memory_order_relaxed);
+  if (g_flusher.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(g_flusher_mutex);
+      g_flusher_stop = true;
+    }
+    g_flusher_cv.notify_one();
+    g_flusher.join();
+  }
+  flush_trace_rings();
+}
+
+// -----------------------------------------------------------------------------
+// Format straight into the next free record, so the line costs one vsnprintf
+// and two atomic stores on the calling thread.
+// -----------------------------------------------------------------------------
+void
+debug_trace_emit(const char *format, ...)
+{
+  if (!t_trace_ring.ring) {
+    if (t_trace_ring.unavailable) {
+      g_unringed_drops.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    t_trace_ring.ring = acquire_trace_ring();
+    if (!t_trace_ring.ring) {
+      t_trace_ring.unavailable = true;
+      g_unringed_drops.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  TraceRing &ring = *t_trace_ring.ring;
+  const uint64_t head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= kTraceRingRecords) {
+    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  TraceRecord &record = ring.records[head & (kTraceRingRecords - 1)];
+  record.time_us = trace_now_us();
+  record.thread_id = current_trace_thread_id();
+
+  va_list args;
+  va_start(args, format);
+  const int written = std::vsnprintf(record.text, sizeof record.text, format, args);
+  va_end(args);
+
+  if (written < 0) {
+    record.length = 0;
+  } else if (static_cast<size_t>(written) >= sizeof record.text) {
+    // Mark cut lines so a reader does not take them for the whole message.
+    std::memcpy(record.text + sizeof record.text - 4, "...", 3);
+    record.length = sizeof record.text - 1;
+  } else {
+    record.length = static_cast<uint32_t>(written);
+  }
+
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Test-only hook: turn recording on or off without the flush thread.
+// -----------------------------------------------------------------------------
+void
+debug_trace_testonly_set_enabled(bool enabled)
+{
+  if (enabled) {
+    std::lock_guard<std::mutex> lock(g_drain_mutex);
+    drain_trace_rings();
+  }
+  g_debug_trace_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Test-only hook: drain every ring and return the formatted lines.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+debug_trace_testonly_drain()
+{
+  std::lock_guard<std::mutex> lock(g_drain_mutex);
+  std::vector<std::string> lines;
+  for (const auto &line : drain_trace_rings()) {
+    lines.push_back(format_trace_line(line));
+  }
+  return lines;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
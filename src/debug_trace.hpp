@@ -1,17 +1,68 @@
+// -----------------------------------------------------------------------------
+// src/debug_trace.hpp
+// Debug trace lines
+//
+// DNFUI_TRACE is compiled into every build and gated by one relaxed load at
+// runtime, so a disabled trace point skips its arguments entirely. When
+// tracing is on, each line is formatted straight into a fixed-size record of a
+// per-thread ring and the calling thread returns without taking a lock or
+// touching stdout. A background thread drains the rings to stdout, and a
+// crash or termination signal writes out whatever is still buffered.
+// DNFUI_DEBUG_TRACE=1 turns tracing on, =0 turns it off. Builds configured with
+// -Ddebug_trace=true start with tracing on.
+// -----------------------------------------------------------------------------
 #pragma once
 
-#include <cstdio>
+#include <atomic>
+#include <string>
+#include <vector>
 
-#ifdef DNFUI_DEBUG_TRACE
-#define DNFUI_TRACE(...)      \
-  do {                        \
-    std::printf("[trace] ");  \
-    std::printf(__VA_ARGS__); \
-    std::printf("\n");        \
-    std::fflush(stdout);      \
-  } while (0)
-#else
-#define DNFUI_TRACE(...) \
-  do {                   \
-  } while (0)
+extern std::atomic<bool> g_debug_trace_enabled;
+
+// -----------------------------------------------------------------------------
+// Return true when trace lines are being recorded.
+// -----------------------------------------------------------------------------
+inline bool
+debug_trace_enabled()
+{
+  return g_debug_trace_enabled.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Read DNFUI_DEBUG_TRACE and start the flush thread when tracing is on. Call
+// once, early in main. The remaining lines are written at exit.
+// -----------------------------------------------------------------------------
+void debug_trace_init();
+// -----------------------------------------------------------------------------
+// Stop recording, stop the flush thread, and write the remaining lines.
+// -----------------------------------------------------------------------------
+void debug_trace_shutdown();
+// -----------------------------------------------------------------------------
+// Record one trace line on the calling thread's ring. Lines longer than one
+// record are cut, and lines that find the ring full are counted as dropped.
+// -----------------------------------------------------------------------------
+void debug_trace_emit(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Test-only hook: turn recording on or off without the flush thread. Turning
+// it on discards lines still buffered.
+// -----------------------------------------------------------------------------
+void debug_trace_testonly_set_enabled(bool enabled);
+// -----------------------------------------------------------------------------
+// Test-only hook: drain every ring and return the formatted lines in time
+// order.
+// -----------------------------------------------------------------------------
+std::vector<std::string> debug_trace_testonly_drain();
 #endif
+
+#define DNFUI_TRACE(...)                      \
+  do {                                        \
+    if (debug_trace_enabled()) [[unlikely]] { \
+      debug_trace_emit(__VA_ARGS__);          \
+    }                                         \
+  } while (0)
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
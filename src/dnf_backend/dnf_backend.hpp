@@ -13,14 +13,22 @@
 // are reorganized.
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include <gio/gio.h>
 
+#include "dnf_backend/dnf_package_string.hpp"
+
 // -----------------------------------------------------------------------------
 // libdnf5 backend helpers
 // -----------------------------------------------------------------------------
@@ -59,15 +67,20 @@ enum class PackageInstallReason {
   EXTERNAL,
 };
 
+// -----------------------------------------------------------------------------
+// Package row fields use shared immutable storage so copying rows between the index,
+// query results and UI caches does not duplicate package metadata. Epoch,
+// architecture and repository are interned because few distinct values exist.
+// -----------------------------------------------------------------------------
 struct PackageRow {
-  std::string nevra;
-  std::string name;
-  std::string epoch;
-  std::string version;
-  std::string release;
-  std::string arch;
-  std::string repo;
-  std::string summary;
+  PackageString nevra;
+  PackageString name;
+  PackageString epoch;
+  PackageString version;
+  PackageString release;
+  PackageString arch;
+  PackageString repo;
+  PackageString summary;
   PackageInstallReason install_reason = PackageInstallReason::UNKNOWN;
   PackageRepoCandidateRelation repo_candidate_relation = PackageRepoCandidateRelation::UNKNOWN;
 
@@ -97,7 +110,7 @@ struct PackageRow {
   // -----------------------------------------------------------------------------
   std::string name_arch_key() const
   {
-    return name + "\n" + arch;
+    return name.str() + "\n" + arch.str();
   }
 
   // -----------------------------------------------------------------------------
@@ -111,7 +124,7 @@ struct PackageRow {
     if (release.empty()) {
       return version;
     }
-    return version + "-" + release;
+    return version.str() + "-" + release.str();
   }
 };
 
@@ -129,7 +142,31 @@ enum class PackageInstallState {
   INSTALLED_NEWER_THAN_REPO,
 };
 
+// Package action of one resolved preview item.
+enum class TransactionPreviewAction {
+  INSTALL,
+  UPGRADE,
+  DOWNGRADE,
+  REINSTALL,
+  REMOVE,
+};
+
+// One resolved package change with the data the summary needs to sort, group,
+// and total the transaction without parsing labels.
+struct TransactionPreviewItem {
+  std::string nevra;
+  TransactionPreviewAction action = TransactionPreviewAction::INSTALL;
+  // Repository the package comes from, "@System" for installed packages.
+  std::string repo;
+  // Zero for removals, which download nothing.
+  uint64_t download_size = 0;
+  uint64_t install_size = 0;
+  // Why the package is part of the transaction.
+  PackageInstallReason reason = PackageInstallReason::UNKNOWN;
+};
+
 // Resolved transaction preview used by the confirmation dialog before apply.
+// The per-action label lists mirror items for callers that only show names.
 struct TransactionPreview {
   std::vector<std::string> install;
   std::vector<std::string> upgrade;
@@ -137,6 +174,7 @@ struct TransactionPreview {
   std::vector<std::string> reinstall;
   std::vector<std::string> remove;
   long long disk_space_delta = 0;
+  std::vector<TransactionPreviewItem> items;
 
   // -----------------------------------------------------------------------------
   // Return true when the preview contains no resolved package actions.
@@ -145,10 +183,66 @@ struct TransactionPreview {
   {
     return install.empty() && upgrade.empty() && downgrade.empty() && reinstall.empty() && remove.empty();
   }
+
+  // -----------------------------------------------------------------------------
+  // Add one item and its label to the list for its action. The disk space
+  // delta is left to the caller, since replaced packages change it too.
+  // -----------------------------------------------------------------------------
+  void add_item(TransactionPreviewItem item)
+  {
+    switch (item.action) {
+    case TransactionPreviewAction::INSTALL:
+      install.push_back(item.nevra);
+      break;
+    case TransactionPreviewAction::UPGRADE:
+      upgrade.push_back(item.nevra);
+      break;
+    case TransactionPreviewAction::DOWNGRADE:
+      downgrade.push_back(item.nevra);
+      break;
+    case TransactionPreviewAction::REINSTALL:
+      reinstall.push_back(item.nevra);
+      break;
+    case TransactionPreviewAction::REMOVE:
+      remove.push_back(item.nevra);
+      break;
+    }
+    items.push_back(std::move(item));
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the download size of all items. Packages already in the local
+  // cache are counted too, so this is an upper bound.
+  // -----------------------------------------------------------------------------
+  uint64_t download_size_total() const
+  {
+    uint64_t total = 0;
+    for (const auto &item : items) {
+      total += item.download_size;
+    }
+    return total;
+  }
 };
 
 using TransactionProgressCallback = std::function<void(const std::string &)>;
 
+// Aggregate byte counts across all package downloads of one transaction.
+struct TransactionDownloadProgress {
+  uint64_t bytes_done = 0;
+  uint64_t bytes_total = 0;
+  // Transfer rate measured since the previous event.
+  uint64_t bytes_per_second = 0;
+  unsigned active_downloads = 0;
+};
+
+using TransactionDownloadProgressCallback = std::function<void(const TransactionDownloadProgress &)>;
+
+// Resolved libdnf5 transaction kept from a preview so apply can run it without
+// resolving the same request again. It is bound to the Base generation it was
+// resolved on and is only reused while that generation is still current.
+struct ResolvedTransaction;
+using ResolvedTransactionPtr = std::shared_ptr<ResolvedTransaction>;
+
 // -----------------------------------------------------------------------------
 // Search flags used by backend search queries. The UI can update them from the
 // search controls, and each backend worker copies a snapshot before scanning so
@@ -157,6 +251,9 @@ using TransactionProgressCallback = std::function<void(const std::string &)>;
 struct DnfBackendSearchOptions {
   bool search_in_description = false;
   bool exact_match = false;
+  // Match file paths (patterns starting with /) and provides instead of
+  // names and descriptions. search_in_description is ignored then.
+  bool search_in_files = false;
 };
 
 // -----------------------------------------------------------------------------
@@ -168,6 +265,35 @@ void dnf_backend_set_search_options(const DnfBackendSearchOptions &options);
 // -----------------------------------------------------------------------------
 DnfBackendSearchOptions dnf_backend_get_search_options();
 
+// -----------------------------------------------------------------------------
+// Set how many worker threads cold package scans may use. Zero and one keep the
+// default single-threaded scan; larger values opt in to sharded scanning.
+// -----------------------------------------------------------------------------
+void dnf_backend_set_scan_worker_count(unsigned count);
+// -----------------------------------------------------------------------------
+// Return the configured worker count for cold package scans.
+// -----------------------------------------------------------------------------
+unsigned dnf_backend_get_scan_worker_count();
+
+// Immutable installed-package state from one installed refresh. Its contents
+// are backend-owned; the UI only passes it back to the lookups below.
+struct InstalledPackageSnapshot;
+using InstalledPackageSnapshotPtr = std::shared_ptr<const InstalledPackageSnapshot>;
+
+// Install state and action-gating facts of one row, read from one snapshot.
+struct PackageRowClassification {
+  PackageInstallState state = PackageInstallState::AVAILABLE;
+  // This exact NEVRA is installed.
+  bool installed_exact = false;
+  // Installed and owns the running GUI executable.
+  bool self_protected = false;
+};
+
+// -----------------------------------------------------------------------------
+// Return the installed-package snapshot published last, never nullptr. Loading
+// it takes no lock, so callers classifying many rows load it once per batch.
+// -----------------------------------------------------------------------------
+InstalledPackageSnapshotPtr dnf_backend_get_installed_snapshot();
 // -----------------------------------------------------------------------------
 // Return true when the installed-package snapshot contains the exact NEVRA.
 // -----------------------------------------------------------------------------
@@ -187,6 +313,22 @@ void dnf_backend_refresh_installed_nevras();
 // Classify one visible package row for UI status badges and action gating.
 // -----------------------------------------------------------------------------
 PackageInstallState dnf_backend_get_package_install_state(const PackageRow &row);
+// -----------------------------------------------------------------------------
+// Classify one row against a snapshot the caller already loaded.
+// -----------------------------------------------------------------------------
+PackageInstallState dnf_backend_get_package_install_state(const InstalledPackageSnapshot &snapshot,
+                                                          const PackageRow &row);
+// -----------------------------------------------------------------------------
+// Classify one row against a snapshot the caller already loaded.
+// -----------------------------------------------------------------------------
+PackageRowClassification dnf_backend_classify_package_row(const InstalledPackageSnapshot &snapshot,
+                                                          const PackageRow &row);
+// -----------------------------------------------------------------------------
+// Classify a whole result set against one snapshot, in row order. Takes no
+// lock and does not touch the Base, so query workers can run it.
+// -----------------------------------------------------------------------------
+std::vector<PackageRowClassification> dnf_backend_classify_package_rows(const InstalledPackageSnapshot &snapshot,
+                                                                        const std::vector<PackageRow> &rows);
 
 // -----------------------------------------------------------------------------
 // Return the default package-table sort priority for one package state.
@@ -209,6 +351,12 @@ bool dnf_backend_is_package_installed_exact(const PackageRow &row);
 // available package sources. Local-only packages therefore return false.
 // -----------------------------------------------------------------------------
 bool dnf_backend_can_reinstall_package(const PackageRow &row);
+// -----------------------------------------------------------------------------
+// Return the NEVRAs among rows that snapshot lists as installed and that the
+// current package sources still offer, from one query under one Base read lock.
+// -----------------------------------------------------------------------------
+std::set<std::string> dnf_backend_get_reinstallable_nevras(const InstalledPackageSnapshot &snapshot,
+                                                           const std::vector<PackageRow> &rows);
 
 // -----------------------------------------------------------------------------
 // Return true when this installed package owns the running GUI executable and
@@ -244,6 +392,144 @@ std::vector<PackageRow> dnf_backend_get_upgradeable_package_rows_interruptible(G
 // -----------------------------------------------------------------------------
 std::vector<PackageRow> dnf_backend_search_package_rows_interruptible(const std::string &pattern,
                                                                       GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Search with the given flags instead of the published ones, for background
+// work that must not depend on the current search controls.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow> dnf_backend_search_package_rows_interruptible(const std::string &pattern,
+                                                                      const DnfBackendSearchOptions &options,
+                                                                      GCancellable *cancellable);
+
+// One page of ranked search results. rows hold the page in rank order and
+// total_matches counts every row the unranked search would return.
+struct PackageSearchPage {
+  std::vector<PackageRow> rows;
+  size_t offset = 0;
+  size_t total_matches = 0;
+
+  // -----------------------------------------------------------------------------
+  // Return how many ranked rows follow this page.
+  // -----------------------------------------------------------------------------
+  size_t more_available() const
+  {
+    const size_t shown = offset + rows.size();
+    return total_matches > shown ? total_matches - shown : 0;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Search like dnf_backend_search_package_rows_interruptible, but order matches
+// by exact name, name prefix, name substring, and then description hit, and
+// return only rows [offset, offset + limit). Request the next page with
+// offset + rows.size(). Only the returned rows are copied.
+// -----------------------------------------------------------------------------
+PackageSearchPage dnf_backend_search_package_rows_ranked(const std::string &pattern,
+                                                         size_t offset,
+                                                         size_t limit,
+                                                         GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Ranked search with the given flags instead of the published ones, for callers
+// such as the service that answer several clients with their own flags.
+// -----------------------------------------------------------------------------
+PackageSearchPage dnf_backend_search_package_rows_ranked(const std::string &pattern,
+                                                         const DnfBackendSearchOptions &options,
+                                                         size_t offset,
+                                                         size_t limit,
+                                                         GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Search like dnf_backend_search_package_rows_interruptible with the given
+// flags, but only over packages with one of the given names. Returns the rows a
+// full search would return for those names, in the same order.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow> dnf_backend_search_package_rows_for_names(const std::string &pattern,
+                                                                  const DnfBackendSearchOptions &options,
+                                                                  const std::set<std::string> &names,
+                                                                  GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Copy the installed rows of the package index for the current Base generation
+// and report that generation. Without build_if_missing, returns false when the
+// index has not been built yet instead of scanning the package sack.
+// -----------------------------------------------------------------------------
+bool dnf_backend_get_indexed_installed_rows(bool build_if_missing,
+                                            GCancellable *cancellable,
+                                            uint64_t &generation_out,
+                                            std::vector<PackageRow> &rows_out);
+// -----------------------------------------------------------------------------
+// Copy the available rows of the package index the same way. Also returns
+// false when the repo scan of the index failed.
+// -----------------------------------------------------------------------------
+bool dnf_backend_get_indexed_available_rows(bool build_if_missing,
+                                            GCancellable *cancellable,
+                                            uint64_t &generation_out,
+                                            std::vector<PackageRow> &rows_out);
+
+// -----------------------------------------------------------------------------
+// Receives one batch of rows from a streaming package query. Batches are passed
+// on the worker thread that runs the query, in final result order, so
+// concatenating them yields the same rows as the matching interruptible query.
+// The batch is handed over by value so the receiver can move the rows on.
+// -----------------------------------------------------------------------------
+using PackageRowBatchCallback = std::function<void(std::vector<PackageRow> batch)>;
+
+// -----------------------------------------------------------------------------
+// Streaming variants of the package list and search queries. Rows are copied
+// out of the package index one batch at a time and each batch goes to on_batch
+// as soon as it is full, so the caller never holds a second full copy of the
+// result. Nothing more is delivered once the cancellable is set. Returns the
+// number of rows delivered.
+// -----------------------------------------------------------------------------
+size_t dnf_backend_get_installed_package_rows_streaming(GCancellable *cancellable,
+                                                        const PackageRowBatchCallback &on_batch);
+size_t dnf_backend_get_browse_package_rows_streaming(GCancellable *cancellable,
+                                                     const PackageRowBatchCallback &on_batch);
+size_t dnf_backend_get_upgradeable_package_rows_streaming(GCancellable *cancellable,
+                                                          const PackageRowBatchCallback &on_batch);
+size_t dnf_backend_search_package_rows_streaming(const std::string &pattern,
+                                                 GCancellable *cancellable,
+                                                 const PackageRowBatchCallback &on_batch);
+std::vector<PackageRow> dnf_backend_get_browse_package_rows_streaming(GCancellable *cancellable,
+                                                                      const PackageRowBatchCallback &on_batch);
+std::vector<PackageRow> dnf_backend_get_upgradeable_package_rows_streaming(GCancellable *cancellable,
+                                                                           const PackageRowBatchCallback &on_batch);
+std::vector<PackageRow> dnf_backend_search_package_rows_streaming(const std::string &pattern,
+                                                                  GCancellable *cancellable,
+                                                                  const PackageRowBatchCallback &on_batch);
+
+// -----------------------------------------------------------------------------
+// Build the shared package index used by browse, search, installed-list, and
+// upgradeable queries for the current Base generation.
+// -----------------------------------------------------------------------------
+void dnf_backend_warm_package_index(GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Map the package index file written by an earlier launch, when the rpmdb and
+// the repository metadata it was built from are unchanged. Reads configuration
+// only, without loading any repository. Returns true when a file is mapped.
+// -----------------------------------------------------------------------------
+bool dnf_backend_open_package_index_file();
+// -----------------------------------------------------------------------------
+// Fill rows and their install states from the mapped package index file: the
+// browse view for an empty pattern, or a name search otherwise. Returns false
+// when no file is mapped or search_options include descriptions.
+// -----------------------------------------------------------------------------
+bool dnf_backend_query_package_index_file(const std::string &pattern,
+                                          const DnfBackendSearchOptions &search_options,
+                                          std::vector<PackageRow> &rows,
+                                          std::vector<PackageInstallState> &states);
+// -----------------------------------------------------------------------------
+// Drop the mapped package index file once the live index serves queries.
+// -----------------------------------------------------------------------------
+void dnf_backend_close_package_index_file();
+// -----------------------------------------------------------------------------
+// Build the installed reverse-dependency index behind the "Required By" list
+// of the Dependencies tab for the current Base generation.
+// -----------------------------------------------------------------------------
+void dnf_backend_warm_installed_reverse_deps(GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Drop the package, reverse-dependency, and installed file indexes. They hold
+// package ids and a weak pointer into the Base, so callers release them along
+// with an idle Base. The next query rebuilds them on demand.
+// -----------------------------------------------------------------------------
+void dnf_backend_release_package_indexes();
 
 // -----------------------------------------------------------------------------
 // Return installed package rows that exactly match one NEVRA.
@@ -254,23 +540,79 @@ std::vector<PackageRow> dnf_backend_get_installed_package_rows_by_nevra(const st
 // -----------------------------------------------------------------------------
 std::vector<PackageRow> dnf_backend_get_available_package_rows_by_nevra(const std::string &pkg_nevra);
 // -----------------------------------------------------------------------------
+// Return installed package rows that exactly match any of the given NEVRAs,
+// resolved in one query and ordered by their position in the request.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow> dnf_backend_get_installed_package_rows_by_nevras(const std::vector<std::string> &pkg_nevras);
+// -----------------------------------------------------------------------------
+// Return available package rows that exactly match any of the given NEVRAs,
+// resolved in one query and ordered by their position in the request.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow> dnf_backend_get_available_package_rows_by_nevras(const std::vector<std::string> &pkg_nevras);
+// -----------------------------------------------------------------------------
 // Return formatted package details for one NEVRA.
 // -----------------------------------------------------------------------------
 std::string dnf_backend_get_package_info(const std::string &pkg_nevra);
+// Installed file list of one package. Every path is followed by a newline in
+// one shared buffer, so a list of any size costs one string and one offset per
+// path, and the buffer itself is the copyable text of the whole list.
+struct PackageFileList {
+  // False when the NEVRA has no installed copy, so there is no file list.
+  bool installed = false;
+  std::string text;
+  // Start of each path in text.
+  std::vector<size_t> offsets;
+
+  // -----------------------------------------------------------------------------
+  // Return the number of paths.
+  // -----------------------------------------------------------------------------
+  size_t size() const
+  {
+    return offsets.size();
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return one path without its trailing newline.
+  // -----------------------------------------------------------------------------
+  std::string_view path(size_t index) const
+  {
+    const size_t end = index + 1 < offsets.size() ? offsets[index + 1] : text.size();
+    return std::string_view(text).substr(offsets[index], end - offsets[index] - 1);
+  }
+};
+
 // -----------------------------------------------------------------------------
-// Return the installed file list for one NEVRA.
+// Return the complete installed file list for one NEVRA.
 // -----------------------------------------------------------------------------
-std::string dnf_backend_get_installed_package_files(const std::string &pkg_nevra, size_t max_files_for_display = 1500);
+PackageFileList dnf_backend_get_installed_package_file_list(const std::string &pkg_nevra);
 // -----------------------------------------------------------------------------
 // Return formatted dependency details for one NEVRA.
 // -----------------------------------------------------------------------------
 std::string dnf_backend_get_package_deps(const std::string &pkg_nevra);
 // -----------------------------------------------------------------------------
-// Return formatted changelog entries for one NEVRA.
+// One page of formatted changelog entries, newest first.
+// -----------------------------------------------------------------------------
+struct PackageChangelogPage {
+  // Formatted entries of this page, or a message when there are none.
+  std::string text;
+  // Number of changelog entries of the package.
+  size_t total_entries = 0;
+  // Index of the first entry after this page. Equals total_entries on the last page.
+  size_t next_entry = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Return up to max_entries formatted changelog entries of one NEVRA, starting
+// at first_entry. Each entry is formatted once and kept for later pages of the
+// same package until the Base generation changes.
 // -----------------------------------------------------------------------------
-std::string dnf_backend_get_package_changelog(const std::string &pkg_nevra);
+PackageChangelogPage
+dnf_backend_get_package_changelog_page(const std::string &pkg_nevra, size_t first_entry, size_t max_entries);
 // -----------------------------------------------------------------------------
 // Resolve the pending transaction and summarize the final package changes for UI review.
+// resolved_out, when given, receives the resolved transaction for a later apply.
+// Setting cancel makes the preview fail at the next check instead of returning
+// a result nobody waits for.
 // -----------------------------------------------------------------------------
 bool dnf_backend_preview_transaction(const std::vector<std::string> &install_nevras,
                                      const std::vector<std::string> &remove_nevras,
@@ -278,16 +620,54 @@ bool dnf_backend_preview_transaction(const std::vector<std::string> &install_nev
                                      TransactionPreview &preview,
                                      std::string &error_out,
                                      const TransactionProgressCallback &progress_cb = {},
-                                     bool upgrade_all = false);
-// -----------------------------------------------------------------------------
-// Resolve and apply the requested transaction and report progress.
+                                     bool upgrade_all = false,
+                                     ResolvedTransactionPtr *resolved_out = nullptr,
+                                     const std::atomic<bool> *cancel = nullptr);
+// -----------------------------------------------------------------------------
+// Resolve an upgrade-all preview on an already idle fork of the published
+// Base. Returns false without resolving when every fork is busy or none is
+// loaded, because it never takes the build lock or the write lock.
+// -----------------------------------------------------------------------------
+bool dnf_backend_preview_upgrade_all_on_idle_fork(TransactionPreview &preview,
+                                                  std::string &error_out,
+                                                  ResolvedTransactionPtr *resolved_out,
+                                                  const std::atomic<bool> *cancel = nullptr);
+// -----------------------------------------------------------------------------
+// Resolve and apply the requested transaction and report progress. When
+// resolved comes from a preview of the same request and the Base generation
+// has not changed since, it is applied directly instead of resolving again.
+// download_progress_cb receives the aggregate package download byte counts.
+// Setting cancel aborts package downloads and stops before RPM runs. A running
+// RPM transaction is never interrupted.
 // -----------------------------------------------------------------------------
 bool dnf_backend_apply_transaction(const std::vector<std::string> &install_nevras,
                                    const std::vector<std::string> &remove_nevras,
                                    const std::vector<std::string> &reinstall_nevras,
                                    std::string &error_out,
                                    const TransactionProgressCallback &progress_cb = {},
-                                   bool upgrade_all = false);
+                                   bool upgrade_all = false,
+                                   const ResolvedTransactionPtr &resolved = {},
+                                   const TransactionDownloadProgressCallback &download_progress_cb = {},
+                                   const std::atomic<bool> *cancel = nullptr);
+// -----------------------------------------------------------------------------
+// Return true when a preview-resolved transaction can still be applied as is,
+// that is, it was not used yet and the Base generation is unchanged.
+// -----------------------------------------------------------------------------
+bool dnf_backend_resolved_transaction_is_current(const ResolvedTransactionPtr &resolved);
+// -----------------------------------------------------------------------------
+// Download the packages of a preview-resolved transaction into the package
+// cache so a later apply of the same resolution finds them there. Stops early
+// once cancel is set. Returns false when the resolution is no longer current,
+// a download failed, or the prefetch was cancelled. The resolution stays
+// usable for apply either way. resolved_mutex is the lock the caller guards
+// resolved with; the moved fork lease is recorded under it.
+// -----------------------------------------------------------------------------
+bool dnf_backend_prefetch_transaction(const ResolvedTransactionPtr &resolved,
+                                      std::mutex &resolved_mutex,
+                                      std::string &error_out,
+                                      const TransactionProgressCallback &progress_cb,
+                                      const std::atomic<bool> &cancel,
+                                      const TransactionDownloadProgressCallback &download_progress_cb = {});
 
 #ifdef DNFUI_BUILD_TESTS
 // -----------------------------------------------------------------------------
@@ -304,6 +684,21 @@ void dnf_backend_testonly_replace_installed_snapshot(const std::set<std::string>
 // whether all rows kept UNKNOWN repo-candidate relation afterwards.
 // -----------------------------------------------------------------------------
 bool dnf_backend_testonly_annotation_fallback_leaves_rows_unknown(std::vector<PackageRow> &rows);
+// -----------------------------------------------------------------------------
+// Test-only hook: return true when a package index is already published for
+// the current Base generation.
+// -----------------------------------------------------------------------------
+bool dnf_backend_testonly_package_index_is_current();
+// -----------------------------------------------------------------------------
+// Test-only hook: return true when an installed reverse-dependency index is
+// already published for the current Base generation.
+// -----------------------------------------------------------------------------
+bool dnf_backend_testonly_reverse_deps_is_current();
+// -----------------------------------------------------------------------------
+// Test-only hook: return whether text matches pattern under the casefolded
+// name and description matching used by package search.
+// -----------------------------------------------------------------------------
+bool dnf_backend_testonly_casefold_matches(const std::string &text, const std::string &pattern, bool exact_match);
 #endif
 
 // -----------------------------------------------------------------------------
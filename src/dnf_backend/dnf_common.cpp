@@ -8,10 +8,15 @@
 // -----------------------------------------------------------------------------
 #include "dnf_backend/dnf_internal.hpp"
 
+#include <cstdint>
+#include <cstring>
+#include <map>
 #include <string>
+#include <string_view>
 
 #include <gio/gio.h>
 
+#include <libdnf5/rpm/package_query.hpp>
 #include <libdnf5/transaction/transaction_item_reason.hpp>
 
 namespace dnf_backend_internal {
@@ -19,7 +24,7 @@ namespace dnf_backend_internal {
 // -----------------------------------------------------------------------------
 // Translate libdnf5 install reasons into the backend-owned row model.
 // -----------------------------------------------------------------------------
-static PackageInstallReason
+PackageInstallReason
 package_install_reason_from_libdnf(libdnf5::transaction::TransactionItemReason reason)
 {
   switch (reason) {
@@ -48,28 +53,59 @@ package_install_reason_from_libdnf(libdnf5::transaction::TransactionItemReason r
 // -----------------------------------------------------------------------------
 PackageRow
 make_package_row(const libdnf5::rpm::Package &pkg, PackageRepoCandidateRelation repo_candidate_relation)
+{
+  return make_package_row(read_scanned_package(pkg, false), repo_candidate_relation);
+}
+
+// -----------------------------------------------------------------------------
+// Build a presentation row from fields already copied out of libdnf5.
+// -----------------------------------------------------------------------------
+PackageRow
+make_package_row(const ScannedPackage &pkg, PackageRepoCandidateRelation repo_candidate_relation)
 {
   PackageRow row;
-  row.nevra = pkg.get_nevra();
-  row.name = pkg.get_name();
-  row.epoch = pkg.get_epoch();
-  row.version = pkg.get_version();
-  row.release = pkg.get_release();
-  row.arch = pkg.get_arch();
-  row.repo = pkg.get_repo_id();
-  row.summary = pkg.get_summary();
-  if (pkg.is_installed()) {
-    row.install_reason = package_install_reason_from_libdnf(pkg.get_reason());
+  row.nevra = pkg.nevra;
+  row.name = pkg.name;
+  row.epoch = PackageString::interned(pkg.epoch);
+  row.version = pkg.version;
+  row.release = pkg.release;
+  row.arch = PackageString::interned(pkg.arch);
+  row.repo = PackageString::interned(pkg.repo_id);
+  row.summary = pkg.summary.empty() ? PackageString::interned("(no summary)") : PackageString(pkg.summary);
+  if (pkg.installed) {
+    row.install_reason = package_install_reason_from_libdnf(pkg.reason);
   }
   row.repo_candidate_relation = repo_candidate_relation;
 
-  if (row.summary.empty()) {
-    row.summary = "(no summary)";
-  }
-
   return row;
 }
 
+// -----------------------------------------------------------------------------
+// Copy the package fields out of the libsolv pool.
+// -----------------------------------------------------------------------------
+ScannedPackage
+read_scanned_package(const libdnf5::rpm::Package &pkg, bool with_description)
+{
+  ScannedPackage scanned;
+  scanned.nevra = pkg.get_nevra();
+  scanned.name = pkg.get_name();
+  scanned.epoch = pkg.get_epoch();
+  scanned.version = pkg.get_version();
+  scanned.release = pkg.get_release();
+  scanned.arch = pkg.get_arch();
+  scanned.repo_id = pkg.get_repo_id();
+  scanned.summary = pkg.get_summary();
+  if (with_description) {
+    scanned.description = pkg.get_description();
+  }
+  scanned.installed = pkg.is_installed();
+  if (scanned.installed) {
+    scanned.reason = pkg.get_reason();
+  }
+  scanned.id = pkg.get_id();
+  return scanned;
+}
+
 // -----------------------------------------------------------------------------
 // Return true when a package query task has been cancelled by the UI worker
 // that owns the provided cancellable.
@@ -80,6 +116,146 @@ package_query_cancelled(GCancellable *cancellable)
   return cancellable && g_cancellable_is_cancelled(cancellable);
 }
 
+// -----------------------------------------------------------------------------
+// Keep the newest row for one package name and architecture tuple.
+// -----------------------------------------------------------------------------
+void
+remember_newest_row(std::map<std::string, PackageRow> &rows_by_name_arch, const PackageRow &row)
+{
+  auto [it, inserted] = rows_by_name_arch.emplace(row.name_arch_key(), row);
+  if (!inserted && libdnf5::rpm::evrcmp(row, it->second) > 0) {
+    it->second = row;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Lowercase one ASCII byte. GLib casefolding maps ASCII text exactly this way.
+// -----------------------------------------------------------------------------
+static inline char
+ascii_lower(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when text contains only 7-bit ASCII bytes. The loop tests eight
+// bytes per step so long descriptions are classified without a per-byte branch.
+// -----------------------------------------------------------------------------
+static bool
+text_is_ascii(std::string_view text)
+{
+  constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= text.size(); i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, text.data() + i, sizeof(word));
+    if (word & kHighBits) {
+      return false;
+    }
+  }
+  for (; i < text.size(); ++i) {
+    if (static_cast<unsigned char>(text[i]) & 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when ASCII text lowercases to folded. Both views must have the
+// same length. Differences are accumulated without early exit so the compiler
+// can vectorize the loop.
+// -----------------------------------------------------------------------------
+static bool
+ascii_equals_folded(std::string_view text, std::string_view folded)
+{
+  unsigned char diff = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    diff |= static_cast<unsigned char>(ascii_lower(text[i]) ^ folded[i]);
+  }
+  return diff == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Return the part of text GLib reads when folding a NUL-terminated C string,
+// so the ASCII fast path sees exactly the bytes the GLib path would.
+// -----------------------------------------------------------------------------
+static std::string_view
+casefold_input(const std::string &text)
+{
+  return std::string_view(text.c_str());
+}
+
+// -----------------------------------------------------------------------------
+// Fold UTF-8 package search text before comparing it against libdnf5 metadata
+// fields. This keeps manual name and description matching aligned with GTK's
+// case-insensitive text handling for non-ASCII package summaries. Pure ASCII
+// text, which covers nearly all package names, is lowered directly.
+// -----------------------------------------------------------------------------
+std::string
+utf8_casefold_copy(const std::string &text)
+{
+  const std::string_view input = casefold_input(text);
+  if (text_is_ascii(input)) {
+    std::string result(input);
+    for (char &c : result) {
+      c = ascii_lower(c);
+    }
+    return result;
+  }
+
+  char *folded = g_utf8_casefold(text.c_str(), -1);
+  std::string result = folded ? folded : "";
+  g_free(folded);
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when the casefolded text equals an already casefolded pattern.
+// ASCII text is compared in place without allocating.
+// -----------------------------------------------------------------------------
+bool
+utf8_casefold_equals(const std::string &text, const std::string &pattern_folded)
+{
+  const std::string_view input = casefold_input(text);
+  if (!text_is_ascii(input)) {
+    return utf8_casefold_copy(text) == pattern_folded;
+  }
+
+  return input.size() == pattern_folded.size() && ascii_equals_folded(input, pattern_folded);
+}
+
+// -----------------------------------------------------------------------------
+// Return true when the casefolded text contains an already casefolded pattern.
+// ASCII text is searched in place without allocating; other text falls back to
+// a GLib casefolded copy.
+// -----------------------------------------------------------------------------
+bool
+utf8_casefold_contains(const std::string &text, const std::string &pattern_folded)
+{
+  const std::string_view input = casefold_input(text);
+  if (!text_is_ascii(input)) {
+    return utf8_casefold_copy(text).find(pattern_folded) != std::string::npos;
+  }
+
+  if (pattern_folded.empty()) {
+    return true;
+  }
+  if (pattern_folded.size() > input.size()) {
+    return false;
+  }
+
+  const std::string_view pattern(pattern_folded);
+  const size_t last = input.size() - pattern.size();
+  for (size_t pos = 0; pos <= last; ++pos) {
+    if (ascii_lower(input[pos]) == pattern[0] && ascii_equals_folded(input.substr(pos, pattern.size()), pattern)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 } // namespace dnf_backend_internal
 
 // -----------------------------------------------------------------------------
@@ -107,6 +283,22 @@ dnf_backend_install_reason_to_string(PackageInstallReason reason)
   }
 }
 
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Test-only hook: match text against a raw search pattern with the same
+// casefolded kernel used by package search.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_testonly_casefold_matches(const std::string &text, const std::string &pattern, bool exact_match)
+{
+  const std::string pattern_folded = dnf_backend_internal::utf8_casefold_copy(pattern);
+  if (exact_match) {
+    return dnf_backend_internal::utf8_casefold_equals(text, pattern_folded);
+  }
+  return dnf_backend_internal::utf8_casefold_contains(text, pattern_folded);
+}
+#endif
+
 // -----------------------------------------------------------------------------
 // EOF
 // -----------------------------------------------------------------------------
@@ -2,20 +2,23 @@
 // src/dnf_backend/dnf_details.cpp
 // Package detail text queries
 //
-// Formats info, file lists, dependencies, and changelog entries for the GTK
-// details pane. These helpers are read-only libdnf5 queries and do not mutate
+// Formats info, dependencies, and paged changelog entries and collects file lists
+// for the GTK details pane. These helpers are read-only libdnf5 queries and do not mutate
 // the installed-package UI cache.
 // -----------------------------------------------------------------------------
 #include "dnf_backend/dnf_internal.hpp"
 
 #include "base_manager.hpp"
 #include "debug_trace.hpp"
+#include "trace_spans.hpp"
 
+#include <algorithm>
 #include <ctime>
 #include <iomanip>
-#include <set>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <gio/gio.h>
 
@@ -37,31 +40,22 @@ format_package_size(unsigned long long size_bytes)
 }
 
 // -----------------------------------------------------------------------------
-// Collect installed packages whose requires match capabilities provided by the
-// selected installed package. This keeps reverse dependency reporting narrow
-// and focused on the current system state.
+// Return installed packages that require a capability provided by the selected
+// installed package. The per-generation reverse-dependency index answers this
+// from a prepared list, so core libraries with thousands of dependents do not
+// rerun a provides match over the installed set on every selection.
 // -----------------------------------------------------------------------------
-static std::set<std::string>
-collect_installed_reverse_dependency_nevras(libdnf5::Base &base, const libdnf5::rpm::Package &pkg)
+static std::vector<std::string>
+collect_installed_reverse_dependency_nevras(libdnf5::Base &base,
+                                            uint64_t generation,
+                                            const libdnf5::rpm::Package &pkg)
 {
-  std::set<std::string> required_by_nevras;
   if (!pkg.is_installed()) {
-    return required_by_nevras;
+    return {};
   }
 
-  libdnf5::rpm::PackageQuery required_by(base);
-  required_by.filter_installed();
-  required_by.filter_requires(pkg.get_provides());
-
-  for (const auto &dependent_pkg : required_by) {
-    if (dependent_pkg.get_nevra() == pkg.get_nevra()) {
-      continue;
-    }
-
-    required_by_nevras.insert(dependent_pkg.get_nevra());
-  }
-
-  return required_by_nevras;
+  auto index = acquire_installed_reverse_deps(base, generation, nullptr);
+  return index ? installed_required_by(*index, pkg.get_nevra()) : std::vector<std::string>();
 }
 
 // -----------------------------------------------------------------------------
@@ -73,6 +67,7 @@ collect_installed_reverse_dependency_nevras(libdnf5::Base &base, const libdnf5::
 std::string
 dnf_backend_get_package_info(const std::string &pkg_nevra)
 {
+  DNFUI_TRACE_SPAN("details", "info", pkg_nevra);
   auto [base, guard, generation] = BaseManager::instance().acquire_read();
   libdnf5::rpm::PackageQuery query(base);
 
@@ -147,59 +142,43 @@ dnf_backend_get_package_info(const std::string &pkg_nevra)
 }
 
 // -----------------------------------------------------------------------------
-// Return newline-separated file paths for an installed package. Large file
-// lists can overwhelm GTK clipboard transfer, so callers can pass a
-// positive max_files_for_display to append a truncation notice after that many
-// visible entries. Passing 0 returns the full list.
+// Return every file path of an installed package in rpmdb order. The paths go
+// into one buffer, so the details view can render any number of them without
+// truncating the list.
 // -----------------------------------------------------------------------------
-std::string
-dnf_backend_get_installed_package_files(const std::string &pkg_nevra, size_t max_files_for_display)
+PackageFileList
+dnf_backend_get_installed_package_file_list(const std::string &pkg_nevra)
 {
-  DNFUI_TRACE("Backend file list start nevra=%s max_display=%zu", pkg_nevra.c_str(), max_files_for_display);
+  DNFUI_TRACE_SPAN("details", "files", pkg_nevra);
+  DNFUI_TRACE("Backend file list start nevra=%s", pkg_nevra.c_str());
   auto [base, guard, generation] = BaseManager::instance().acquire_read();
   libdnf5::rpm::PackageQuery query(base);
 
   query.filter_nevra(pkg_nevra);
   query.filter_installed();
 
+  PackageFileList files;
   if (query.empty()) {
     DNFUI_TRACE("Backend file list not installed nevra=%s", pkg_nevra.c_str());
-    return "File list available only for installed packages.";
+    return files;
   }
 
   query.filter_latest_evr();
   auto pkg = *query.begin();
 
-  std::ostringstream files;
-  size_t file_count = 0;
-  size_t displayed_count = 0;
-  const bool should_truncate = max_files_for_display > 0;
-
+  files.installed = true;
   for (const auto &f : pkg.get_files()) {
-    ++file_count;
-    if (!should_truncate || displayed_count < max_files_for_display) {
-      files << f << "\n";
-      ++displayed_count;
-    }
+    files.offsets.push_back(files.text.size());
+    files.text += f;
+    files.text += '\n';
   }
+  files.text.shrink_to_fit();
+  files.offsets.shrink_to_fit();
 
-  std::string result = files.str();
-  if (result.empty()) {
-    result = "No files recorded for this installed package.";
-  } else if (should_truncate && file_count > max_files_for_display) {
-    const size_t hidden_count = file_count - displayed_count;
-    files << "\n--- " << hidden_count << " more file" << (hidden_count == 1 ? "" : "s") << " not shown ---\n"
-          << "--- Use the package manager CLI for complete list ---\n";
-    result = files.str();
-  }
-
-  DNFUI_TRACE("Backend file list done nevra=%s total=%zu displayed=%zu bytes=%zu",
-              pkg_nevra.c_str(),
-              file_count,
-              displayed_count,
-              result.size());
+  DNFUI_TRACE(
+      "Backend file list done nevra=%s total=%zu bytes=%zu", pkg_nevra.c_str(), files.size(), files.text.size());
 
-  return result;
+  return files;
 }
 
 // -----------------------------------------------------------------------------
@@ -210,6 +189,7 @@ dnf_backend_get_installed_package_files(const std::string &pkg_nevra, size_t max
 std::string
 dnf_backend_get_package_deps(const std::string &pkg_nevra)
 {
+  DNFUI_TRACE_SPAN("details", "dependencies", pkg_nevra);
   auto [base, guard, generation] = BaseManager::instance().acquire_read();
   libdnf5::rpm::PackageQuery query(base);
 
@@ -225,7 +205,7 @@ dnf_backend_get_package_deps(const std::string &pkg_nevra)
   installed.filter_installed();
   libdnf5::rpm::PackageQuery &best = installed.empty() ? query : installed;
   auto pkg = *best.begin();
-  std::set<std::string> required_by_nevras = collect_installed_reverse_dependency_nevras(base, pkg);
+  std::vector<std::string> required_by_nevras = collect_installed_reverse_dependency_nevras(base, generation, pkg);
 
   std::ostringstream out;
 
@@ -260,21 +240,52 @@ dnf_backend_get_package_deps(const std::string &pkg_nevra)
   return out.str();
 }
 
+// Changelog entries of the package whose pages were loaded last. "Load more"
+// asks for the next page of the same package, so only that one is kept.
+struct CachedChangelog {
+  uint64_t generation = 0;
+  std::string nevra;
+  std::vector<libdnf5::rpm::Changelog> entries;
+  // Formatted text of each entry, filled in the first time a page shows it.
+  // Formatted text is never empty.
+  std::vector<std::string> formatted;
+};
+
+static std::mutex g_changelog_mutex;
+static CachedChangelog g_changelog;
+
 // -----------------------------------------------------------------------------
-// Retrieve and format changelog entries for one exact NEVRA. Installed package
-// metadata is preferred because rpmdb entries often contain a fuller local
-// history than repository metadata.
+// Format one changelog entry for the details pane.
 // -----------------------------------------------------------------------------
-std::string
-dnf_backend_get_package_changelog(const std::string &pkg_nevra)
+static std::string
+format_changelog_entry(const libdnf5::rpm::Changelog &entry)
 {
-  auto [base, guard, generation] = BaseManager::instance().acquire_read();
-  libdnf5::rpm::PackageQuery query(base);
+  std::time_t ts = static_cast<std::time_t>(entry.get_timestamp());
+  std::tm tm_buf {};
+  localtime_r(&ts, &tm_buf);
 
+  std::ostringstream out;
+  out << "Date: " << std::put_time(&tm_buf, "%Y-%m-%d") << "\n"
+      << "Author: " << entry.get_author() << "\n"
+      << entry.get_text() << "\n\n";
+  return out.str();
+}
+
+// -----------------------------------------------------------------------------
+// Load the changelog entries of one exact NEVRA into the cache. Installed
+// package metadata is preferred because rpmdb entries often contain a fuller
+// local history than repository metadata. Returns false when no package matches.
+// Expects g_changelog_mutex to be held.
+// -----------------------------------------------------------------------------
+static bool
+load_changelog_locked(libdnf5::Base &base, uint64_t generation, const std::string &pkg_nevra)
+{
+  libdnf5::rpm::PackageQuery query(base);
   query.filter_nevra(pkg_nevra);
 
+  g_changelog = CachedChangelog {};
   if (query.empty()) {
-    return "No changelog available.";
+    return false;
   }
 
   // Prefer the installed copy: repo metadata often omits older changelog
@@ -285,24 +296,47 @@ dnf_backend_get_package_changelog(const std::string &pkg_nevra)
   libdnf5::rpm::PackageQuery &best = installed.empty() ? query : installed;
   auto pkg = *best.begin();
 
-  std::ostringstream out;
+  g_changelog.generation = generation;
+  g_changelog.nevra = pkg_nevra;
+  g_changelog.entries = pkg.get_changelogs();
+  g_changelog.formatted.resize(g_changelog.entries.size());
+  return true;
+}
 
-  auto entries = pkg.get_changelogs();
-  if (entries.empty()) {
-    return "No changelog entries found.";
+// -----------------------------------------------------------------------------
+// Return one page of changelog entries. Only the entries of the requested page
+// are formatted, so a long rpmdb history costs one page per request.
+// -----------------------------------------------------------------------------
+PackageChangelogPage
+dnf_backend_get_package_changelog_page(const std::string &pkg_nevra, size_t first_entry, size_t max_entries)
+{
+  DNFUI_TRACE_SPAN("details", "changelog page", pkg_nevra);
+  auto [base, guard, generation] = BaseManager::instance().acquire_read();
+  std::lock_guard<std::mutex> lock(g_changelog_mutex);
+
+  PackageChangelogPage page;
+  bool cached = g_changelog.generation == generation && g_changelog.nevra == pkg_nevra;
+  if (!cached && !load_changelog_locked(base, generation, pkg_nevra)) {
+    page.text = "No changelog available.";
+    return page;
   }
 
-  for (const auto &entry : entries) {
-    std::time_t ts = static_cast<std::time_t>(entry.get_timestamp());
-    std::tm tm_buf {};
-    localtime_r(&ts, &tm_buf);
+  page.total_entries = g_changelog.entries.size();
+  if (page.total_entries == 0) {
+    page.text = "No changelog entries found.";
+    return page;
+  }
 
-    out << "Date: " << std::put_time(&tm_buf, "%Y-%m-%d") << "\n"
-        << "Author: " << entry.get_author() << "\n"
-        << entry.get_text() << "\n\n";
+  first_entry = std::min(first_entry, page.total_entries);
+  page.next_entry = first_entry + std::min(max_entries, page.total_entries - first_entry);
+  for (size_t i = first_entry; i < page.next_entry; ++i) {
+    if (g_changelog.formatted[i].empty()) {
+      g_changelog.formatted[i] = format_changelog_entry(g_changelog.entries[i]);
+    }
+    page.text += g_changelog.formatted[i];
   }
 
-  return out.str();
+  return page;
 }
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,161 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_download_progress.cpp
+// Aggregate package download progress
+// Sums the per-package byte counts libdnf5 reports and samples the transfer
+// rate once per published event.
+// -----------------------------------------------------------------------------
+#include "dnf_backend/dnf_download_progress.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Convert one libdnf5 byte count to an integer, treating negatives as unknown.
+// -----------------------------------------------------------------------------
+uint64_t
+byte_count(double bytes)
+{
+  return bytes > 0.0 ? static_cast<uint64_t>(bytes) : 0;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Start with no downloads.
+// -----------------------------------------------------------------------------
+DownloadProgressAggregator::DownloadProgressAggregator(std::chrono::milliseconds interval)
+    : interval(interval)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Add one download slot and its expected size to the totals.
+// -----------------------------------------------------------------------------
+size_t
+DownloadProgressAggregator::start(double expected_bytes, Clock::time_point now)
+{
+  Slot slot;
+  slot.total = byte_count(expected_bytes);
+  slot.active = true;
+  slots.push_back(slot);
+  bytes_total += slot.total;
+  ++active;
+
+  if (!sampled) {
+    // The rate of the first event is measured from the first download start.
+    sampled = true;
+    last_sample = now;
+  }
+  return slots.size() - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Move the totals by the change in one download since its last update.
+// -----------------------------------------------------------------------------
+bool
+DownloadProgressAggregator::update(size_t index, double total_bytes, double downloaded_bytes, Clock::time_point now)
+{
+  if (index >= slots.size() || !slots[index].active) {
+    return false;
+  }
+
+  Slot &slot = slots[index];
+  const uint64_t total = byte_count(total_bytes);
+  if (total > slot.total) {
+    bytes_total += total - slot.total;
+    slot.total = total;
+  }
+
+  const uint64_t done = std::min(byte_count(downloaded_bytes), slot.total);
+  if (done > slot.done) {
+    bytes_done += done - slot.done;
+    transferred += done - slot.done;
+    slot.done = done;
+  }
+  return sample_if_due(now, false);
+}
+
+// -----------------------------------------------------------------------------
+// Settle one download slot and publish once nothing is active any more.
+// -----------------------------------------------------------------------------
+bool
+DownloadProgressAggregator::finish(size_t index, DownloadOutcome outcome, Clock::time_point now)
+{
+  if (index >= slots.size() || !slots[index].active) {
+    return false;
+  }
+
+  Slot &slot = slots[index];
+  slot.active = false;
+  --active;
+
+  switch (outcome) {
+  case DownloadOutcome::DOWNLOADED:
+  case DownloadOutcome::ALREADY_PRESENT:
+    bytes_done += slot.total - slot.done;
+    slot.done = slot.total;
+    break;
+  case DownloadOutcome::FAILED:
+    bytes_total -= slot.total;
+    bytes_done -= slot.done;
+    slot.total = 0;
+    slot.done = 0;
+    break;
+  }
+  return sample_if_due(now, active == 0);
+}
+
+// -----------------------------------------------------------------------------
+// Copy the totals into one event.
+// -----------------------------------------------------------------------------
+TransactionDownloadProgress
+DownloadProgressAggregator::current() const
+{
+  TransactionDownloadProgress progress;
+  progress.bytes_done = bytes_done;
+  progress.bytes_total = bytes_total;
+  progress.bytes_per_second = bytes_per_second;
+  progress.active_downloads = active;
+  return progress;
+}
+
+// -----------------------------------------------------------------------------
+// Measure the rate over the time since the previous event.
+// -----------------------------------------------------------------------------
+bool
+DownloadProgressAggregator::sample_if_due(Clock::time_point now, bool force)
+{
+  const auto elapsed = now - last_sample;
+  if (!force && elapsed < interval) {
+    return false;
+  }
+
+  const auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  if (elapsed_us > 0) {
+    bytes_per_second = (transferred - last_sample_transferred) * 1000000 / static_cast<uint64_t>(elapsed_us);
+  }
+  last_sample = now;
+  last_sample_transferred = transferred;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Format the bytes and their average rate in MiB.
+// -----------------------------------------------------------------------------
+std::string
+download_progress_format_summary(uint64_t bytes, std::chrono::microseconds elapsed)
+{
+  const double mib = static_cast<double>(bytes) / (1024.0 * 1024.0);
+  const double seconds = static_cast<double>(elapsed.count()) / 1000000.0;
+  const double rate = seconds > 0.0 ? mib / seconds : 0.0;
+
+  char line[128];
+  std::snprintf(line, sizeof(line), "Downloaded %.1f MiB in %.1f s (%.1f MiB/s).", mib, seconds, rate);
+  return line;
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_download_progress.hpp
+// Aggregate package download progress
+//
+// libdnf5 reports progress per package download, and several downloads run in
+// parallel. This sums the expected and downloaded bytes of all of them,
+// samples the transfer rate, and decides when the next aggregate event is due
+// so observers see a bounded number of events per second.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Shortest interval between two aggregate download progress events.
+inline constexpr std::chrono::milliseconds kDownloadProgressInterval { 250 };
+
+// How one package download ended.
+enum class DownloadOutcome {
+  DOWNLOADED,
+  ALREADY_PRESENT,
+  FAILED,
+};
+
+// -----------------------------------------------------------------------------
+// Byte totals for one set of parallel package downloads. Not thread safe;
+// libdnf5 calls the download callbacks from the thread running the download.
+// -----------------------------------------------------------------------------
+class DownloadProgressAggregator {
+  public:
+  using Clock = std::chrono::steady_clock;
+
+  // -----------------------------------------------------------------------------
+  // Use interval as the shortest time between two published events.
+  // -----------------------------------------------------------------------------
+  explicit DownloadProgressAggregator(std::chrono::milliseconds interval = kDownloadProgressInterval);
+
+  // -----------------------------------------------------------------------------
+  // Register one download expected to transfer expected_bytes and return its
+  // slot for later updates. expected_bytes may be zero when it is unknown.
+  // -----------------------------------------------------------------------------
+  size_t start(double expected_bytes, Clock::time_point now);
+
+  // -----------------------------------------------------------------------------
+  // Record the progress of one download. Returns true when an event is due.
+  // -----------------------------------------------------------------------------
+  bool update(size_t slot, double total_bytes, double downloaded_bytes, Clock::time_point now);
+
+  // -----------------------------------------------------------------------------
+  // Record how one download ended. Files that were already present count as
+  // done without adding to the transfer rate, and failed downloads leave the
+  // totals. Returns true when an event is due, always after the last active
+  // download ended.
+  // -----------------------------------------------------------------------------
+  bool finish(size_t slot, DownloadOutcome outcome, Clock::time_point now);
+
+  // -----------------------------------------------------------------------------
+  // Return the aggregate state as of the last update.
+  // -----------------------------------------------------------------------------
+  TransactionDownloadProgress current() const;
+
+  // -----------------------------------------------------------------------------
+  // Return the bytes actually transferred, excluding files already present.
+  // -----------------------------------------------------------------------------
+  uint64_t transferred_bytes() const
+  {
+    return transferred;
+  }
+
+  private:
+  struct Slot {
+    uint64_t total = 0;
+    uint64_t done = 0;
+    bool active = false;
+  };
+
+  // -----------------------------------------------------------------------------
+  // Update the rate sample and return true when the interval has passed.
+  // -----------------------------------------------------------------------------
+  bool sample_if_due(Clock::time_point now, bool force);
+
+  std::chrono::milliseconds interval;
+  std::vector<Slot> slots;
+  uint64_t bytes_total = 0;
+  uint64_t bytes_done = 0;
+  uint64_t transferred = 0;
+  unsigned active = 0;
+  uint64_t bytes_per_second = 0;
+  bool sampled = false;
+  Clock::time_point last_sample;
+  uint64_t last_sample_transferred = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Format one download summary line such as
+// "Downloaded 12.5 MiB in 4.0 s (3.1 MiB/s)."
+// -----------------------------------------------------------------------------
+std::string download_progress_format_summary(uint64_t bytes, std::chrono::microseconds elapsed);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,238 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_file_index.cpp
+// Per-generation installed file index and file owner search
+//
+// Maps every installed file path to the installed package that owns it. The
+// index is built once per BaseManager generation, so "which package owns this
+// file" searches do not walk the file lists of every installed package again.
+// Provides searches and available packages go to libdnf5, which already keeps
+// its own lookup tables for them.
+// -----------------------------------------------------------------------------
+#include "dnf_backend/dnf_internal.hpp"
+
+#include "base_manager.hpp"
+#include "debug_trace.hpp"
+#include "dnf_backend/dnf_generation_cache.hpp"
+#include "trace_spans.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fnmatch.h>
+
+#include <gio/gio.h>
+
+#include <libdnf5/base/base.hpp>
+#include <libdnf5/rpm/package_query.hpp>
+
+namespace {
+
+// Characters that make a path pattern a shell glob.
+constexpr const char *kGlobChars = "*?[";
+
+// Last published file index.
+dnf_backend_internal::GenerationIndexCache<dnf_backend_internal::InstalledFileIndex> g_file_index;
+
+// -----------------------------------------------------------------------------
+// Return the path one entry points at.
+// -----------------------------------------------------------------------------
+std::string_view
+entry_path(const dnf_backend_internal::InstalledFileIndex &index, const dnf_backend_internal::InstalledFileEntry &entry)
+{
+  return std::string_view(index.path_bytes).substr(entry.offset, entry.length);
+}
+
+// -----------------------------------------------------------------------------
+// Return true when the pattern holds a glob character.
+// -----------------------------------------------------------------------------
+bool
+pattern_has_glob(const std::string &pattern)
+{
+  return pattern.find_first_of(kGlobChars) != std::string::npos;
+}
+
+// -----------------------------------------------------------------------------
+// Build the index while the caller holds the Base read lock. Returns nullptr
+// when cancelled.
+// -----------------------------------------------------------------------------
+std::shared_ptr<dnf_backend_internal::InstalledFileIndex>
+build_file_index(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable)
+{
+  auto index = std::make_shared<dnf_backend_internal::InstalledFileIndex>();
+  index->generation = generation;
+  index->base = base.get_weak_ptr();
+
+  libdnf5::rpm::PackageQuery installed(base);
+  installed.filter_installed();
+
+  for (const auto &pkg : installed) {
+    if (dnf_backend_internal::package_query_cancelled(cancellable)) {
+      return nullptr;
+    }
+
+    const auto package = static_cast<uint32_t>(index->nevras.size());
+    index->nevras.push_back(pkg.get_nevra());
+    for (const auto &path : pkg.get_files()) {
+      index->entries.push_back({ static_cast<uint32_t>(index->path_bytes.size()),
+                                 static_cast<uint32_t>(path.size()),
+                                 package });
+      index->path_bytes += path;
+    }
+  }
+
+  const auto &built = *index;
+  std::sort(index->entries.begin(),
+            index->entries.end(),
+            [&built](const dnf_backend_internal::InstalledFileEntry &a,
+                     const dnf_backend_internal::InstalledFileEntry &b) {
+              int cmp = entry_path(built, a).compare(entry_path(built, b));
+              return cmp != 0 ? cmp < 0 : a.package < b.package;
+            });
+  index->entries.shrink_to_fit();
+  index->path_bytes.shrink_to_fit();
+
+  DNFUI_TRACE("Installed file index built generation=%llu installed=%zu files=%zu bytes=%zu",
+              static_cast<unsigned long long>(generation),
+              index->nevras.size(),
+              index->entries.size(),
+              index->path_bytes.size());
+  return index;
+}
+
+} // namespace
+
+namespace dnf_backend_internal {
+
+// -----------------------------------------------------------------------------
+// Return the file index for the locked Base generation. The first file search
+// after a rebuild pays for the build; later searches reuse it. The caller must
+// hold the Base read lock for generation.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const InstalledFileIndex>
+acquire_installed_file_index(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable)
+{
+  return g_file_index.acquire(base, generation, [&]() {
+    DNFUI_TRACE_SPAN("query", "build file index");
+    return build_file_index(base, generation, cancellable);
+  });
+}
+
+// -----------------------------------------------------------------------------
+// Match the sorted paths under the literal part of the pattern. Exact and
+// prefix patterns stop at the first path past the prefix; a glob checks every
+// path before its first glob character matches.
+// -----------------------------------------------------------------------------
+std::set<std::string>
+installed_file_owners(const InstalledFileIndex &index, const std::string &pattern, bool exact)
+{
+  std::set<std::string> owners;
+  const bool glob = !exact && pattern_has_glob(pattern);
+  const std::string_view literal =
+      glob ? std::string_view(pattern).substr(0, pattern.find_first_of(kGlobChars)) : std::string_view(pattern);
+
+  auto it = std::lower_bound(index.entries.begin(),
+                             index.entries.end(),
+                             literal,
+                             [&index](const InstalledFileEntry &entry, std::string_view key) {
+                               return entry_path(index, entry) < key;
+                             });
+  for (; it != index.entries.end(); ++it) {
+    const std::string_view path = entry_path(index, *it);
+    if (!path.starts_with(literal) || (exact && path.size() != literal.size())) {
+      break;
+    }
+    if (glob && fnmatch(pattern.c_str(), std::string(path).c_str(), 0) != 0) {
+      continue;
+    }
+    owners.insert(index.nevras[it->package]);
+  }
+  return owners;
+}
+
+// -----------------------------------------------------------------------------
+// Resolve the owners or providers and map them back to index entries. Older
+// available versions map to the newest candidate of their name and
+// architecture, which is the row the table shows for them.
+// -----------------------------------------------------------------------------
+bool
+search_file_owner_entries(libdnf5::Base &base,
+                          uint64_t generation,
+                          const PackageIndex &index,
+                          const std::string &pattern,
+                          const DnfBackendSearchOptions &search_options,
+                          GCancellable *cancellable,
+                          std::vector<const PackageIndexEntry *> &available_matches,
+                          std::vector<const PackageIndexEntry *> &installed_matches)
+{
+  const auto cmp = search_options.exact_match ? libdnf5::sack::QueryCmp::EQ : libdnf5::sack::QueryCmp::GLOB;
+  std::set<std::string> installed_nevras;
+  std::vector<libdnf5::rpm::Package> available_packages;
+
+  if (!pattern.empty() && pattern.front() == '/') {
+    auto file_index = acquire_installed_file_index(base, generation, cancellable);
+    if (!file_index) {
+      return false;
+    }
+    installed_nevras = installed_file_owners(*file_index, pattern, search_options.exact_match);
+
+    // Without a glob, a path pattern is a prefix, like the installed lookup.
+    const std::string file_pattern =
+        search_options.exact_match || pattern_has_glob(pattern) ? pattern : pattern + "*";
+    libdnf5::rpm::PackageQuery available(base);
+    available.filter_available();
+    available.filter_file({ file_pattern }, cmp);
+    available_packages.assign(available.begin(), available.end());
+  } else {
+    libdnf5::rpm::PackageQuery providers(base);
+    providers.filter_provides({ pattern }, cmp);
+    for (const auto &pkg : providers) {
+      if (pkg.is_installed()) {
+        installed_nevras.insert(pkg.get_nevra());
+      } else {
+        available_packages.push_back(pkg);
+      }
+    }
+  }
+
+  if (package_query_cancelled(cancellable)) {
+    return false;
+  }
+
+  for (const auto &entry : index.installed) {
+    if (installed_nevras.count(entry.row.nevra.str()) > 0) {
+      installed_matches.push_back(&entry);
+    }
+  }
+
+  PackageRow key;
+  for (const auto &pkg : available_packages) {
+    key.name = pkg.get_name();
+    key.arch = pkg.get_arch();
+    if (const PackageIndexEntry *entry = find_indexed_repo_entry(index, key)) {
+      available_matches.push_back(entry);
+    }
+  }
+  // The entries live in one vector, so address order is index order.
+  std::sort(available_matches.begin(), available_matches.end());
+  available_matches.erase(std::unique(available_matches.begin(), available_matches.end()), available_matches.end());
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Drop the published index. Readers that copied the pointer keep their copy.
+// -----------------------------------------------------------------------------
+void
+reset_installed_file_index()
+{
+  g_file_index.reset();
+}
+
+} // namespace dnf_backend_internal
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
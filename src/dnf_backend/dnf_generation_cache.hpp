@@ -0,0 +1,98 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_generation_cache.hpp
+// Per-generation published index slot
+//
+// The package, reverse-dependency, and installed file indexes are each built
+// once per BaseManager generation and then shared by every reader. This slot
+// holds the last published index of one kind, hands it out only for the Base
+// and generation it was built from, and lets one caller at a time build a
+// missing index.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <libdnf5/base/base.hpp>
+
+namespace dnf_backend_internal {
+
+// -----------------------------------------------------------------------------
+// Published index of type Index, which must carry the generation and the weak
+// Base pointer it was built from. Readers copy the shared pointer under the
+// mutex and then read the index without holding any backend lock.
+// -----------------------------------------------------------------------------
+template <typename Index>
+class GenerationIndexCache {
+  public:
+  // -----------------------------------------------------------------------------
+  // Return the published index when it was built from this exact Base
+  // generation. The weak Base pointer also rejects an index left behind by a
+  // Base that was replaced without a generation change, such as a test-only
+  // reset.
+  // -----------------------------------------------------------------------------
+  std::shared_ptr<const Index> find(libdnf5::Base &base, uint64_t generation) const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!published || published->generation != generation) {
+      return nullptr;
+    }
+    if (!published->base.is_valid() || published->base.get() != &base) {
+      return nullptr;
+    }
+
+    return published;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the index for the locked Base generation, calling build for it when
+  // none is published yet. Builds are serialized so concurrent first readers
+  // after a rebuild do not all scan the package sack. build returns nullptr
+  // when cancelled, which leaves nothing published. The caller must hold the
+  // Base read lock for generation.
+  // -----------------------------------------------------------------------------
+  template <typename Build>
+  std::shared_ptr<const Index> acquire(libdnf5::Base &base, uint64_t generation, Build &&build)
+  {
+    if (auto index = find(base, generation)) {
+      return index;
+    }
+
+    std::lock_guard<std::mutex> build_lock(build_mutex);
+    // Another worker may have finished the same build while this one waited.
+    if (auto index = find(base, generation)) {
+      return index;
+    }
+
+    std::shared_ptr<const Index> index = std::forward<Build>(build)();
+    if (!index) {
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    published = index;
+    return index;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Drop the published index. Readers that copied the pointer keep their copy.
+  // -----------------------------------------------------------------------------
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    published.reset();
+  }
+
+  private:
+  mutable std::mutex mutex;
+  std::mutex build_mutex;
+  std::shared_ptr<const Index> published;
+};
+
+} // namespace dnf_backend_internal
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,1029 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_index.cpp
+// Per-generation package index
+//
+// Owns the read-only package rows shared by browse, search, installed-list, and
+// upgradeable queries. The index is built from libdnf5 once per BaseManager
+// generation, so repeated queries only filter backend-owned rows instead of
+// walking every package and converting it again.
+// -----------------------------------------------------------------------------
+#include "dnf_backend/dnf_internal.hpp"
+
+#include "base_manager.hpp"
+#include "debug_trace.hpp"
+#include "dnf_backend/dnf_generation_cache.hpp"
+#include "dnf_backend/dnf_index_file.hpp"
+#include "trace_spans.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gio/gio.h>
+
+#include <libdnf5/base/base.hpp>
+#include <libdnf5/rpm/package_query.hpp>
+
+namespace {
+
+// Last published package index.
+dnf_backend_internal::GenerationIndexCache<dnf_backend_internal::PackageIndex> g_package_index;
+
+// On-disk index mapped at startup, serving browse and name searches until the
+// live index replaces it, and the key of the file last mapped or written.
+std::shared_ptr<const PackageIndexFile> g_package_index_file;
+std::vector<std::string> g_package_index_file_key;
+std::mutex g_package_index_file_mutex;
+
+// -----------------------------------------------------------------------------
+// Convert one scanned package into an index entry with its casefolded name. The
+// description, the longest text of a package, is loaded on the first search
+// that matches against it.
+// -----------------------------------------------------------------------------
+dnf_backend_internal::PackageIndexEntry
+make_package_index_entry(const dnf_backend_internal::ScannedPackage &pkg)
+{
+  dnf_backend_internal::PackageIndexEntry entry;
+  entry.row = dnf_backend_internal::make_package_row(pkg, PackageRepoCandidateRelation::UNKNOWN);
+  entry.name_folded = dnf_backend_internal::utf8_casefold_copy(entry.row.name);
+  entry.package_id = pkg.id;
+  return entry;
+}
+
+// -----------------------------------------------------------------------------
+// Order index entries by package name and then architecture, matching the old
+// "name\narch" string key order used by the visible package list.
+// -----------------------------------------------------------------------------
+bool
+name_arch_less(const PackageRow &a, const PackageRow &b)
+{
+  int cmp = a.name.compare(b.name);
+  return cmp != 0 ? cmp < 0 : a.arch < b.arch;
+}
+
+// -----------------------------------------------------------------------------
+// Scan the newest visible repo candidate for each name and architecture tuple.
+// Returns false when the scan was cancelled.
+// -----------------------------------------------------------------------------
+bool
+index_available_packages(libdnf5::Base &base,
+                         GCancellable *cancellable,
+                         NameArchInterner &interner,
+                         dnf_backend_internal::PackageIndex &index)
+{
+  libdnf5::rpm::PackageQuery query(base);
+  query.filter_available();
+  query.filter_latest_evr();
+
+  std::vector<std::vector<dnf_backend_internal::PackageIndexEntry>> shards;
+  bool completed = dnf_backend_internal::scan_packages_sharded(
+      query,
+      cancellable,
+      false,
+      [&shards](size_t shard_count) { shards.resize(shard_count); },
+      [&shards](size_t shard, const dnf_backend_internal::ScannedPackage &pkg) {
+        shards[shard].push_back(make_package_index_entry(pkg));
+      });
+  if (!completed) {
+    return false;
+  }
+
+  size_t scanned = 0;
+  for (const auto &entries : shards) {
+    scanned += entries.size();
+  }
+
+  // Merge in shard order so equal-EVR ties keep the same winner as a serial scan.
+  NameArchSlotMap merge_slots(scanned);
+  for (auto &entries : shards) {
+    for (auto &entry : entries) {
+      entry.name_arch_id = interner.key_for(entry.row.name, entry.row.arch);
+      auto [slot, inserted] =
+          merge_slots.try_emplace(entry.name_arch_id, static_cast<uint32_t>(index.available.size()));
+      if (inserted) {
+        index.available.push_back(std::move(entry));
+      } else if (libdnf5::rpm::evrcmp(entry.row, index.available[slot].row) > 0) {
+        index.available[slot] = std::move(entry);
+      }
+    }
+  }
+
+  std::sort(index.available.begin(), index.available.end(), [](const auto &a, const auto &b) {
+    return name_arch_less(a.row, b.row);
+  });
+
+  index.available_slots = NameArchSlotMap(index.available.size());
+  for (uint32_t slot = 0; slot < index.available.size(); ++slot) {
+    index.available_slots.try_emplace(index.available[slot].name_arch_id, slot);
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Scan installed packages and fill the exact NEVRA and name and architecture
+// lookups published by the installed-list query. Returns false when cancelled.
+// -----------------------------------------------------------------------------
+bool
+index_installed_packages(libdnf5::Base &base,
+                         GCancellable *cancellable,
+                         NameArchInterner &interner,
+                         dnf_backend_internal::PackageIndex &index)
+{
+  libdnf5::rpm::PackageQuery query(base);
+  query.filter_installed();
+
+  std::vector<std::vector<dnf_backend_internal::PackageIndexEntry>> shards;
+  bool completed = dnf_backend_internal::scan_packages_sharded(
+      query,
+      cancellable,
+      false,
+      [&shards](size_t shard_count) { shards.resize(shard_count); },
+      [&shards](size_t shard, const dnf_backend_internal::ScannedPackage &pkg) {
+        shards[shard].push_back(make_package_index_entry(pkg));
+      });
+  if (!completed) {
+    return false;
+  }
+
+  for (auto &entries : shards) {
+    for (auto &entry : entries) {
+      entry.name_arch_id = interner.key_for(entry.row.name, entry.row.arch);
+      index.installed.push_back(std::move(entry));
+    }
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Scan the latest repo candidates that upgrade installed packages. Returns
+// false when cancelled.
+// -----------------------------------------------------------------------------
+bool
+index_upgradeable_packages(libdnf5::Base &base, GCancellable *cancellable, dnf_backend_internal::PackageIndex &index)
+{
+  libdnf5::rpm::PackageQuery query(base);
+  query.filter_available();
+  query.filter_upgrades();
+  query.filter_latest_evr();
+
+  std::map<std::string, PackageRow> rows_by_name_arch;
+  for (auto pkg : query) {
+    if (dnf_backend_internal::package_query_cancelled(cancellable)) {
+      return false;
+    }
+
+    dnf_backend_internal::remember_newest_row(
+        rows_by_name_arch, dnf_backend_internal::make_package_row(pkg, PackageRepoCandidateRelation::UNKNOWN));
+  }
+
+  index.upgradeable.reserve(rows_by_name_arch.size());
+  for (auto &[key, row] : rows_by_name_arch) {
+    index.upgradeable.push_back(std::move(row));
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Build one complete index while the caller holds the Base read lock. Repo
+// scan failures are recorded instead of thrown so the installed-list view can
+// keep working from the rpmdb alone, matching the live best-effort annotation.
+// -----------------------------------------------------------------------------
+std::shared_ptr<dnf_backend_internal::PackageIndex>
+build_package_index(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable)
+{
+  DNFUI_TRACE_SPAN("query", "build package index");
+  auto index = std::make_shared<dnf_backend_internal::PackageIndex>();
+  index->generation = generation;
+  index->base = base.get_weak_ptr();
+
+  NameArchInterner interner;
+  if (!index_installed_packages(base, cancellable, interner, *index)) {
+    return nullptr;
+  }
+
+  try {
+    if (!index_available_packages(base, cancellable, interner, *index) ||
+        !index_upgradeable_packages(base, cancellable, *index)) {
+      return nullptr;
+    }
+  } catch (const std::exception &e) {
+    DNFUI_TRACE("Package index repo scan failed: %s", e.what());
+    index->available.clear();
+    index->available_slots = NameArchSlotMap();
+    index->upgradeable.clear();
+    index->available_error = e.what();
+  }
+
+  for (auto &entry : index->installed) {
+    if (index->available_error.empty()) {
+      uint32_t slot = index->available_slots.find(entry.name_arch_id);
+      entry.row.repo_candidate_relation = dnf_backend_internal::repo_candidate_relation_for(
+          entry.row, slot == NameArchSlotMap::kNoSlot ? nullptr : &index->available[slot].row);
+    }
+    index->installed_nevras.insert(entry.row.nevra);
+    dnf_backend_internal::remember_newest_row(index->installed_rows_by_name_arch, entry.row);
+  }
+
+  index->self_protected_names = dnf_backend_internal::collect_self_protected_package_names(base);
+
+  DNFUI_TRACE("Package index built generation=%llu available=%zu installed=%zu upgradeable=%zu",
+              static_cast<unsigned long long>(generation),
+              index->available.size(),
+              index->installed.size(),
+              index->upgradeable.size());
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+// Return the key of the on-disk index for one set of Base inputs: the rpmdb
+// stamps followed by the enabled repos with their repomd.xml stamps and the
+// configuration file stamps.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+package_index_file_key(const BaseStateFingerprint &inputs)
+{
+  std::vector<std::string> key = inputs.rpmdb_files;
+  key.insert(key.end(), inputs.repo_entries.begin(), inputs.repo_entries.end());
+  return key;
+}
+
+// -----------------------------------------------------------------------------
+// Classify one visible row against the installed entries of the index, the way
+// dnf_backend_get_package_install_state does against the installed snapshot.
+// -----------------------------------------------------------------------------
+PackageInstallState
+indexed_install_state(const dnf_backend_internal::PackageIndex &index, const PackageRow &row)
+{
+  if (index.installed_nevras.count(row.nevra) > 0) {
+    switch (row.repo_candidate_relation) {
+    case PackageRepoCandidateRelation::NONE:
+      return PackageInstallState::LOCAL_ONLY;
+    case PackageRepoCandidateRelation::NEWER:
+      return PackageInstallState::UPGRADEABLE;
+    case PackageRepoCandidateRelation::OLDER:
+      return PackageInstallState::INSTALLED_NEWER_THAN_REPO;
+    default:
+      return PackageInstallState::INSTALLED;
+    }
+  }
+
+  auto it = index.installed_rows_by_name_arch.find(row.name_arch_key());
+  if (it == index.installed_rows_by_name_arch.end()) {
+    return PackageInstallState::AVAILABLE;
+  }
+
+  return libdnf5::rpm::evrcmp(row, it->second) > 0 ? PackageInstallState::UPGRADEABLE
+                                                    : PackageInstallState::INSTALLED_NEWER_THAN_REPO;
+}
+
+// Thrown out of a lazy description load when the requesting search is
+// cancelled, so std::call_once leaves the descriptions for the next search.
+struct DescriptionLoadCancelled {};
+
+// -----------------------------------------------------------------------------
+// Read and casefold the description of every entry from its package id.
+// Cancels by throwing DescriptionLoadCancelled after clearing the loaded text.
+// -----------------------------------------------------------------------------
+void
+load_package_index_descriptions(libdnf5::Base &base,
+                                const dnf_backend_internal::PackageIndex &index,
+                                GCancellable *cancellable)
+{
+  auto load = [&](const std::vector<dnf_backend_internal::PackageIndexEntry> &entries) {
+    for (const auto &entry : entries) {
+      if (dnf_backend_internal::package_query_cancelled(cancellable)) {
+        return false;
+      }
+      libdnf5::rpm::Package pkg(base.get_weak_ptr(), entry.package_id);
+      entry.description_folded = dnf_backend_internal::utf8_casefold_copy(pkg.get_description());
+    }
+    return true;
+  };
+
+  if (!load(index.available) || !load(index.installed)) {
+    for (const auto *entries : { &index.available, &index.installed }) {
+      for (const auto &entry : *entries) {
+        std::string().swap(entry.description_folded);
+      }
+    }
+    throw DescriptionLoadCancelled {};
+  }
+}
+
+// Thrown out of a lazy trigram build when the requesting search is cancelled,
+// so std::call_once leaves the postings unbuilt for the next search to retry.
+struct TrigramBuildCancelled {};
+
+// -----------------------------------------------------------------------------
+// Pack three bytes of casefolded text into one posting list key.
+// -----------------------------------------------------------------------------
+uint32_t
+trigram_key(const std::string &text, size_t pos)
+{
+  return (static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16) |
+         (static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8) |
+         static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+}
+
+// -----------------------------------------------------------------------------
+// Add every trigram of one text field to the postings for one entry id. Ids are
+// added in ascending order, so checking the list tail is enough to keep each id
+// at most once per trigram.
+// -----------------------------------------------------------------------------
+void
+add_trigram_postings(dnf_backend_internal::PackageTrigramPostings &postings, const std::string &text, uint32_t id)
+{
+  for (size_t pos = 0; pos + 3 <= text.size(); ++pos) {
+    auto &ids = postings[trigram_key(text, pos)];
+    if (ids.empty() || ids.back() != id) {
+      ids.push_back(id);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Release the spare capacity left behind by incremental posting list growth.
+// -----------------------------------------------------------------------------
+void
+shrink_trigram_postings(dnf_backend_internal::PackageTrigramPostings &postings)
+{
+  for (auto &[key, ids] : postings) {
+    ids.shrink_to_fit();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Build the trigram postings of one text field for both entry lists. Cancels
+// by throwing TrigramBuildCancelled after discarding the partial postings.
+// -----------------------------------------------------------------------------
+void
+build_trigram_index(const dnf_backend_internal::PackageIndex &index,
+                    dnf_backend_internal::PackageTrigramIndex &trigrams,
+                    std::string dnf_backend_internal::PackageIndexEntry::*field,
+                    GCancellable *cancellable)
+{
+  auto cancel_build = [&trigrams]() {
+    trigrams.available.clear();
+    trigrams.installed.clear();
+    throw TrigramBuildCancelled {};
+  };
+
+  for (uint32_t id = 0; id < index.available.size(); ++id) {
+    if ((id & 0x3ff) == 0 && dnf_backend_internal::package_query_cancelled(cancellable)) {
+      cancel_build();
+    }
+    add_trigram_postings(trigrams.available, index.available[id].*field, id);
+  }
+
+  for (uint32_t id = 0; id < index.installed.size(); ++id) {
+    if ((id & 0x3ff) == 0 && dnf_backend_internal::package_query_cancelled(cancellable)) {
+      cancel_build();
+    }
+    add_trigram_postings(trigrams.installed, index.installed[id].*field, id);
+  }
+
+  shrink_trigram_postings(trigrams.available);
+  shrink_trigram_postings(trigrams.installed);
+}
+
+// -----------------------------------------------------------------------------
+// Return the ascending entry ids whose indexed text contains every trigram of
+// the pattern. The pattern must be at least three bytes long. Lists are
+// intersected from the shortest upward so rare trigrams prune early.
+// -----------------------------------------------------------------------------
+std::vector<uint32_t>
+trigram_candidates(const dnf_backend_internal::PackageTrigramPostings &postings, const std::string &pattern)
+{
+  std::vector<const std::vector<uint32_t> *> lists;
+  for (size_t pos = 0; pos + 3 <= pattern.size(); ++pos) {
+    auto it = postings.find(trigram_key(pattern, pos));
+    if (it == postings.end()) {
+      return {};
+    }
+    lists.push_back(&it->second);
+  }
+
+  std::sort(lists.begin(), lists.end(), [](const auto *a, const auto *b) {
+    return a->size() != b->size() ? a->size() < b->size() : a < b;
+  });
+  lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+  std::vector<uint32_t> candidates = *lists.front();
+  std::vector<uint32_t> narrowed;
+  for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+    narrowed.clear();
+    std::set_intersection(
+        candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(narrowed));
+    candidates.swap(narrowed);
+  }
+
+  return candidates;
+}
+
+// -----------------------------------------------------------------------------
+// Merge two ascending candidate id lists into one without duplicates.
+// -----------------------------------------------------------------------------
+std::vector<uint32_t>
+merge_trigram_candidates(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b)
+{
+  std::vector<uint32_t> merged;
+  merged.reserve(a.size() + b.size());
+  std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(merged));
+  return merged;
+}
+
+// -----------------------------------------------------------------------------
+// Verify trigram candidates against the full search semantics and collect the
+// matching entries. Returns false when cancelled.
+// -----------------------------------------------------------------------------
+template <typename EntryAt>
+bool
+collect_verified_candidates(const std::vector<uint32_t> &candidates,
+                            EntryAt entry_at,
+                            const std::string &pattern_lower,
+                            const DnfBackendSearchOptions &search_options,
+                            GCancellable *cancellable,
+                            std::vector<const dnf_backend_internal::PackageIndexEntry *> &matches)
+{
+  for (uint32_t id : candidates) {
+    if (dnf_backend_internal::package_query_cancelled(cancellable)) {
+      return false;
+    }
+    const dnf_backend_internal::PackageIndexEntry *entry = entry_at(id);
+    if (dnf_backend_internal::package_index_entry_matches(*entry, pattern_lower, search_options)) {
+      matches.push_back(entry);
+    }
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Return the lazily built trigram postings for one text field, or nullptr when
+// the requesting search was cancelled before the build finished.
+// -----------------------------------------------------------------------------
+const dnf_backend_internal::PackageTrigramIndex *
+ensure_trigram_index(const dnf_backend_internal::PackageIndex &index,
+                     std::once_flag &once,
+                     dnf_backend_internal::PackageTrigramIndex &trigrams,
+                     std::string dnf_backend_internal::PackageIndexEntry::*field,
+                     GCancellable *cancellable)
+{
+  try {
+    std::call_once(once, [&]() {
+      build_trigram_index(index, trigrams, field, cancellable);
+      DNFUI_TRACE("Package trigram index built generation=%llu available_keys=%zu installed_keys=%zu",
+                  static_cast<unsigned long long>(index.generation),
+                  trigrams.available.size(),
+                  trigrams.installed.size());
+    });
+  } catch (const TrigramBuildCancelled &) {
+    return nullptr;
+  }
+
+  return &trigrams;
+}
+
+} // namespace
+
+namespace dnf_backend_internal {
+
+// -----------------------------------------------------------------------------
+// Return the shared package index for the locked Base generation. The first
+// caller after a rebuild pays for the libdnf5 scan; later callers reuse the
+// published index. The caller must hold the Base read lock for generation.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const PackageIndex>
+acquire_package_index(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable)
+{
+  return g_package_index.acquire(
+      base, generation, [&]() { return build_package_index(base, generation, cancellable); });
+}
+
+// -----------------------------------------------------------------------------
+// Load the descriptions once per index. The caller's read lock keeps the Base
+// the package ids belong to alive.
+// -----------------------------------------------------------------------------
+bool
+ensure_package_index_descriptions(libdnf5::Base &base, const PackageIndex &index, GCancellable *cancellable)
+{
+  if (!index.base.is_valid() || index.base.get() != &base) {
+    return false;
+  }
+
+  try {
+    std::call_once(index.descriptions_once, [&]() {
+      DNFUI_TRACE_SPAN("query", "load index descriptions");
+      load_package_index_descriptions(base, index, cancellable);
+      DNFUI_TRACE("Package index descriptions loaded generation=%llu entries=%zu",
+                  static_cast<unsigned long long>(index.generation),
+                  index.available.size() + index.installed.size());
+    });
+  } catch (const DescriptionLoadCancelled &) {
+    return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Return the published index for this Base generation, or nullptr when it has
+// not been built yet. Periodic and exact-NEVRA paths use this to share the
+// index without paying for a build.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const PackageIndex>
+find_package_index(libdnf5::Base &base, uint64_t generation)
+{
+  return g_package_index.find(base, generation);
+}
+
+// -----------------------------------------------------------------------------
+// Look up the newest repo candidate for one name and architecture tuple. The
+// available entries are sorted by name and then architecture, so this is a
+// binary search over the index instead of a repo query.
+// -----------------------------------------------------------------------------
+const PackageRow *
+find_indexed_repo_candidate(const PackageIndex &index, const PackageRow &row)
+{
+  const PackageIndexEntry *entry = find_indexed_repo_entry(index, row);
+  return entry ? &entry->row : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Look up the available entry for one name and architecture tuple.
+// -----------------------------------------------------------------------------
+const PackageIndexEntry *
+find_indexed_repo_entry(const PackageIndex &index, const PackageRow &row)
+{
+  auto it = std::lower_bound(index.available.begin(),
+                             index.available.end(),
+                             row,
+                             [](const PackageIndexEntry &entry, const PackageRow &key) {
+                               return name_arch_less(entry.row, key);
+                             });
+  if (it == index.available.end() || it->row.name != row.name || it->row.arch != row.arch) {
+    return nullptr;
+  }
+
+  return &*it;
+}
+
+// -----------------------------------------------------------------------------
+// Copy the indexed installed rows into an installed snapshot.
+// -----------------------------------------------------------------------------
+InstalledQueryResult
+installed_query_result_from_index(const PackageIndex &index)
+{
+  InstalledQueryResult installed;
+  installed.rows.reserve(index.installed.size());
+  for (const auto &entry : index.installed) {
+    installed.rows.push_back(entry.row);
+  }
+  installed.nevras = index.installed_nevras;
+  installed.rows_by_name_arch = index.installed_rows_by_name_arch;
+  return installed;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when one indexed row matches the active search term using the
+// same name and description flag semantics as the main UI search controls.
+// -----------------------------------------------------------------------------
+bool
+package_index_entry_matches(const PackageIndexEntry &entry,
+                            const std::string &pattern_lower,
+                            const DnfBackendSearchOptions &search_options)
+{
+  if (search_options.exact_match) {
+    return entry.name_folded == pattern_lower;
+  }
+
+  if (entry.name_folded.find(pattern_lower) != std::string::npos) {
+    return true;
+  }
+
+  if (!search_options.search_in_description) {
+    return false;
+  }
+
+  return entry.description_folded.find(pattern_lower) != std::string::npos;
+}
+
+// -----------------------------------------------------------------------------
+// Collect the index entries matching one search. Exact-name searches and
+// patterns shorter than one trigram fall back to a linear scan because they
+// cannot use the postings.
+// -----------------------------------------------------------------------------
+bool
+search_package_index(const PackageIndex &index,
+                     const std::string &pattern_lower,
+                     const DnfBackendSearchOptions &search_options,
+                     GCancellable *cancellable,
+                     std::vector<const PackageIndexEntry *> &available_matches,
+                     std::vector<const PackageIndexEntry *> &installed_matches)
+{
+  available_matches.clear();
+  installed_matches.clear();
+
+  if (search_options.exact_match || pattern_lower.size() < 3) {
+    for (const auto &entry : index.available) {
+      if (package_query_cancelled(cancellable)) {
+        return false;
+      }
+      if (package_index_entry_matches(entry, pattern_lower, search_options)) {
+        available_matches.push_back(&entry);
+      }
+    }
+    for (const auto &entry : index.installed) {
+      if (package_query_cancelled(cancellable)) {
+        return false;
+      }
+      if (package_index_entry_matches(entry, pattern_lower, search_options)) {
+        installed_matches.push_back(&entry);
+      }
+    }
+    return true;
+  }
+
+  const PackageTrigramIndex *names = ensure_trigram_index(
+      index, index.name_trigrams_once, index.name_trigrams, &PackageIndexEntry::name_folded, cancellable);
+  if (!names) {
+    return false;
+  }
+
+  std::vector<uint32_t> available_candidates = trigram_candidates(names->available, pattern_lower);
+  std::vector<uint32_t> installed_candidates = trigram_candidates(names->installed, pattern_lower);
+
+  if (search_options.search_in_description) {
+    const PackageTrigramIndex *descriptions = ensure_trigram_index(index,
+                                                                   index.description_trigrams_once,
+                                                                   index.description_trigrams,
+                                                                   &PackageIndexEntry::description_folded,
+                                                                   cancellable);
+    if (!descriptions) {
+      return false;
+    }
+
+    available_candidates =
+        merge_trigram_candidates(available_candidates, trigram_candidates(descriptions->available, pattern_lower));
+    installed_candidates =
+        merge_trigram_candidates(installed_candidates, trigram_candidates(descriptions->installed, pattern_lower));
+  }
+
+  return collect_verified_candidates(
+             available_candidates,
+             [&index](uint32_t id) { return &index.available[id]; },
+             pattern_lower,
+             search_options,
+             cancellable,
+             available_matches) &&
+         collect_verified_candidates(
+             installed_candidates,
+             [&index](uint32_t id) { return &index.installed[id]; },
+             pattern_lower,
+             search_options,
+             cancellable,
+             installed_matches);
+}
+
+// -----------------------------------------------------------------------------
+// Build the merged package view used by search and browse: start with the
+// matched repo-backed candidates, then add installed-only rows for name and
+// architecture tuples that are missing from enabled repositories. If an
+// installed package is newer than the repo candidate, keep the installed row
+// so the UI can surface that state directly. Lookups use the interned tuple
+// keys and the merge only moves entry pointers, so it allocates no per-row keys
+// and callers copy just the rows they return. The result stays ordered by name
+// and then architecture.
+//
+// Note on repo_candidate_relation in the returned rows:
+//   - Installed rows that are promoted into the result (LOCAL_ONLY, OLDER, or
+//     the installed-newer-than-repo case) carry a fully resolved relation.
+//   - Available rows that stay in the result without a matching installed
+//     entry keep repo_candidate_relation = UNKNOWN because no installed
+//     counterpart was found during this pass.
+//   - dnf_backend_get_package_install_state handles UNKNOWN on available rows
+//     through its installed-cache EVR comparison fallback.
+//
+// Code that reads repo_candidate_relation directly should treat UNKNOWN on a
+// non-installed row as "no installed counterpart known", not as a failed repo
+// lookup.
+// -----------------------------------------------------------------------------
+std::vector<VisibleIndexEntry>
+visible_entries_from_index_matches(const std::vector<const PackageIndexEntry *> &available_matches,
+                                   const std::vector<const PackageIndexEntry *> &installed_matches)
+{
+  // Keep only the newest matched installed entry for each tuple.
+  NameArchSlotMap installed_slots(installed_matches.size());
+  std::vector<const PackageIndexEntry *> newest_installed;
+  newest_installed.reserve(installed_matches.size());
+  for (const auto *entry : installed_matches) {
+    auto [slot, inserted] =
+        installed_slots.try_emplace(entry->name_arch_id, static_cast<uint32_t>(newest_installed.size()));
+    if (inserted) {
+      newest_installed.push_back(entry);
+    } else if (libdnf5::rpm::evrcmp(entry->row, newest_installed[slot]->row) > 0) {
+      newest_installed[slot] = entry;
+    }
+  }
+
+  NameArchSlotMap available_slots(available_matches.size());
+  std::vector<VisibleIndexEntry> visible;
+  visible.reserve(available_matches.size() + newest_installed.size());
+  for (const auto *entry : available_matches) {
+    available_slots.try_emplace(entry->name_arch_id, static_cast<uint32_t>(visible.size()));
+    visible.push_back({ entry, entry->row.repo_candidate_relation });
+  }
+
+  std::vector<VisibleIndexEntry> installed_only;
+  for (const auto *entry : newest_installed) {
+    uint32_t slot = available_slots.find(entry->name_arch_id);
+    const PackageRow *candidate = slot == NameArchSlotMap::kNoSlot ? nullptr : &visible[slot].entry->row;
+    VisibleIndexEntry installed { entry, repo_candidate_relation_for(entry->row, candidate) };
+
+    if (!candidate) {
+      installed_only.push_back(installed);
+    } else if (libdnf5::rpm::evrcmp(entry->row, *candidate) > 0) {
+      visible[slot] = installed;
+    }
+  }
+
+  if (!installed_only.empty()) {
+    auto visible_less = [](const VisibleIndexEntry &a, const VisibleIndexEntry &b) {
+      return name_arch_less(a.entry->row, b.entry->row);
+    };
+    std::sort(installed_only.begin(), installed_only.end(), visible_less);
+    const auto repo_rows_end = static_cast<std::ptrdiff_t>(visible.size());
+    visible.insert(visible.end(), installed_only.begin(), installed_only.end());
+    std::inplace_merge(visible.begin(), visible.begin() + repo_rows_end, visible.end(), visible_less);
+  }
+
+  return visible;
+}
+
+// -----------------------------------------------------------------------------
+// Copy one visible entry into the row returned to callers.
+// -----------------------------------------------------------------------------
+PackageRow
+visible_entry_row(const VisibleIndexEntry &visible)
+{
+  PackageRow row = visible.entry->row;
+  row.repo_candidate_relation = visible.relation;
+  return row;
+}
+
+// -----------------------------------------------------------------------------
+// Merge matched entries and copy every visible row.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+visible_rows_from_index_matches(const std::vector<const PackageIndexEntry *> &available_matches,
+                                const std::vector<const PackageIndexEntry *> &installed_matches)
+{
+  std::vector<VisibleIndexEntry> visible = visible_entries_from_index_matches(available_matches, installed_matches);
+
+  std::vector<PackageRow> rows;
+  rows.reserve(visible.size());
+  for (const auto &entry : visible) {
+    rows.push_back(visible_entry_row(entry));
+  }
+
+  return rows;
+}
+
+// -----------------------------------------------------------------------------
+// Return the search rank of one matched entry: exact name, then name prefix,
+// then name substring, then description-only hits.
+// -----------------------------------------------------------------------------
+int
+package_search_rank(const PackageIndexEntry &entry, const std::string &pattern_lower)
+{
+  if (entry.name_folded == pattern_lower) {
+    return 0;
+  }
+  if (entry.name_folded.starts_with(pattern_lower)) {
+    return 1;
+  }
+  if (entry.name_folded.find(pattern_lower) != std::string::npos) {
+    return 2;
+  }
+  return 3;
+}
+
+// -----------------------------------------------------------------------------
+// Rank the visible entries and copy only the rows of one page. A bounded
+// max-heap keeps the best offset + limit entries, so rows past the page are
+// never copied or sorted. Equal ranks keep the name and architecture order of
+// the merged view, which makes consecutive pages disjoint and stable.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+ranked_rows_from_visible_entries(const std::vector<VisibleIndexEntry> &visible,
+                                 const std::string &pattern_lower,
+                                 size_t offset,
+                                 size_t limit)
+{
+  std::vector<PackageRow> rows;
+  if (offset >= visible.size() || limit == 0) {
+    return rows;
+  }
+
+  using RankedSlot = std::pair<int, size_t>;
+  const size_t keep = offset + std::min(limit, visible.size() - offset);
+  std::vector<RankedSlot> heap;
+  heap.reserve(keep);
+  for (size_t pos = 0; pos < visible.size(); ++pos) {
+    RankedSlot ranked { package_search_rank(*visible[pos].entry, pattern_lower), pos };
+    if (heap.size() < keep) {
+      heap.push_back(ranked);
+      std::push_heap(heap.begin(), heap.end());
+    } else if (ranked < heap.front()) {
+      std::pop_heap(heap.begin(), heap.end());
+      heap.back() = ranked;
+      std::push_heap(heap.begin(), heap.end());
+    }
+  }
+
+  std::sort_heap(heap.begin(), heap.end());
+  rows.reserve(heap.size() - offset);
+  for (size_t i = offset; i < heap.size(); ++i) {
+    rows.push_back(visible_entry_row(visible[heap[i].second]));
+  }
+
+  return rows;
+}
+
+// -----------------------------------------------------------------------------
+// Drop the published package index.
+// -----------------------------------------------------------------------------
+void
+reset_package_index()
+{
+  g_package_index.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Capture the current inputs without loading any repo and map the file only
+// when it was written for exactly those inputs.
+// -----------------------------------------------------------------------------
+bool
+open_package_index_file()
+{
+  const std::string path = package_index_file_default_path();
+  if (path.empty()) {
+    return false;
+  }
+
+  std::vector<std::string> key;
+  try {
+    key = package_index_file_key(BaseManager::capture_repo_inputs());
+  } catch (const std::exception &e) {
+    DNFUI_TRACE("Package index file skipped: %s", e.what());
+    return false;
+  }
+
+  auto file = PackageIndexFile::map(path, key);
+  if (!file) {
+    DNFUI_TRACE("Package index file skipped: missing or outdated");
+    return false;
+  }
+
+  DNFUI_TRACE("Package index file mapped rows=%zu", file->size());
+  std::lock_guard<std::mutex> lock(g_package_index_file_mutex);
+  g_package_index_file = std::move(file);
+  g_package_index_file_key = std::move(key);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Match names in the mapping and copy only the matching rows. The file holds
+// the merged browse rows in their visible order, so browse copies every row.
+// -----------------------------------------------------------------------------
+bool
+query_package_index_file(const std::string &pattern,
+                         const DnfBackendSearchOptions &search_options,
+                         std::vector<PackageRow> &rows,
+                         std::vector<PackageInstallState> &states)
+{
+  std::shared_ptr<const PackageIndexFile> file;
+  {
+    std::lock_guard<std::mutex> lock(g_package_index_file_mutex);
+    file = g_package_index_file;
+  }
+  if (!file || (!pattern.empty() && (search_options.search_in_description || search_options.search_in_files))) {
+    return false;
+  }
+
+  std::vector<uint32_t> ids;
+  if (pattern.empty()) {
+    ids.resize(file->size());
+    for (uint32_t i = 0; i < ids.size(); ++i) {
+      ids[i] = i;
+    }
+  } else {
+    ids = file->match_name(utf8_casefold_copy(pattern), search_options.exact_match);
+  }
+
+  rows.clear();
+  states.clear();
+  rows.reserve(ids.size());
+  states.reserve(ids.size());
+  for (uint32_t id : ids) {
+    rows.push_back(file->row(id));
+    states.push_back(file->state(id));
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Drop the mapping. Readers that copied the pointer keep their view until they
+// finish.
+// -----------------------------------------------------------------------------
+void
+close_package_index_file()
+{
+  std::lock_guard<std::mutex> lock(g_package_index_file_mutex);
+  g_package_index_file.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Only an index built from the published repo-backed Base, without a repo scan
+// error, is written, so the file never holds installed-only or failed rows.
+// -----------------------------------------------------------------------------
+void
+store_package_index_file(const PackageIndex &index)
+{
+  DNFUI_TRACE_SPAN("query", "write index file");
+  const std::string path = package_index_file_default_path();
+  BaseStateFingerprint inputs;
+  uint64_t generation = 0;
+  if (path.empty() || !index.available_error.empty() ||
+      !BaseManager::instance().published_repo_inputs(inputs, generation) || generation != index.generation) {
+    return;
+  }
+
+  std::vector<std::string> key = package_index_file_key(inputs);
+  {
+    std::lock_guard<std::mutex> lock(g_package_index_file_mutex);
+    if (key == g_package_index_file_key) {
+      return;
+    }
+  }
+
+  std::vector<const PackageIndexEntry *> available;
+  available.reserve(index.available.size());
+  for (const auto &entry : index.available) {
+    available.push_back(&entry);
+  }
+  std::vector<const PackageIndexEntry *> installed;
+  installed.reserve(index.installed.size());
+  for (const auto &entry : index.installed) {
+    installed.push_back(&entry);
+  }
+
+  std::vector<VisibleIndexEntry> visible = visible_entries_from_index_matches(available, installed);
+  std::vector<PackageIndexFileRow> rows;
+  rows.reserve(visible.size());
+  for (const auto &entry : visible) {
+    PackageIndexFileRow row;
+    row.row = visible_entry_row(entry);
+    row.state = indexed_install_state(index, row.row);
+    row.name_folded = entry.entry->name_folded;
+    rows.push_back(std::move(row));
+  }
+
+  if (!package_index_file_write(path, package_index_file_encode(key, rows))) {
+    DNFUI_TRACE("Package index file write failed: %s", path.c_str());
+    return;
+  }
+
+  DNFUI_TRACE("Package index file written rows=%zu", rows.size());
+  std::lock_guard<std::mutex> lock(g_package_index_file_mutex);
+  g_package_index_file_key = std::move(key);
+}
+
+} // namespace dnf_backend_internal
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Test-only hook: return true when a package index is published for the
+// current Base generation, without building one.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_testonly_package_index_is_current()
+{
+  auto [base, guard, generation] = BaseManager::instance().acquire_read();
+  return g_package_index.find(base, generation) != nullptr;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
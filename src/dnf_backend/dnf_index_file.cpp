@@ -0,0 +1,419 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_index_file.cpp
+// On-disk package index
+// The header and records use little-endian 32-bit fields at fixed offsets, and
+// every string field is an offset and length into the string table. The whole
+// file is checked once when it is mapped, so field reads need no bounds checks.
+// -----------------------------------------------------------------------------
+#include "dnf_backend/dnf_index_file.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+namespace {
+
+// The magic names the file kind and kFormatVersion its layout. Files of any
+// other version are ignored and replaced by the next successful index build.
+constexpr char kIndexFileMagic[8] = { 'D', 'N', 'F', 'U', 'I', 'I', 'D', 'X' };
+constexpr uint32_t kFormatVersion = 1;
+
+// Header: magic, version, record size, row count, then the offset and size of
+// the key, the offset of the records, and the offset and size of the strings.
+constexpr size_t kHeaderSize = 40;
+constexpr size_t kVersionOffset = 8;
+constexpr size_t kRecordSizeOffset = 12;
+constexpr size_t kRowCountOffset = 16;
+constexpr size_t kKeyOffsetOffset = 20;
+constexpr size_t kKeySizeOffset = 24;
+constexpr size_t kRecordsOffsetOffset = 28;
+constexpr size_t kStringsOffsetOffset = 32;
+constexpr size_t kStringsSizeOffset = 36;
+
+// Record: an offset and length per string field, then the install reason,
+// repo candidate relation, and install state bytes and one padding byte.
+constexpr size_t kFieldCount = static_cast<size_t>(PackageIndexFileField::COUNT);
+constexpr size_t kEnumsOffset = kFieldCount * 8;
+constexpr size_t kRecordSize = kEnumsOffset + 4;
+
+// -----------------------------------------------------------------------------
+// Read one little-endian 32-bit value.
+// -----------------------------------------------------------------------------
+uint32_t
+get_u32(const unsigned char *at)
+{
+  return static_cast<uint32_t>(at[0]) | (static_cast<uint32_t>(at[1]) << 8) | (static_cast<uint32_t>(at[2]) << 16) |
+         (static_cast<uint32_t>(at[3]) << 24);
+}
+
+// -----------------------------------------------------------------------------
+// Append one little-endian 32-bit value.
+// -----------------------------------------------------------------------------
+void
+put_u32(std::string &out, uint32_t value)
+{
+  for (int shift = 0; shift < 32; shift += 8) {
+    out.push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Overwrite one little-endian 32-bit value at pos.
+// -----------------------------------------------------------------------------
+void
+set_u32(std::string &out, size_t pos, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    out[pos + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Join the key stamps the way the file stores them, one per line.
+// -----------------------------------------------------------------------------
+std::string
+joined_key(const std::vector<std::string> &key)
+{
+  std::string text;
+  for (const auto &stamp : key) {
+    text += stamp;
+    text += '\n';
+  }
+  return text;
+}
+
+// -----------------------------------------------------------------------------
+// Return the string of one row field.
+// -----------------------------------------------------------------------------
+const std::string &
+row_field(const PackageIndexFileRow &row, PackageIndexFileField column)
+{
+  switch (column) {
+  case PackageIndexFileField::NEVRA:
+    return row.row.nevra.str();
+  case PackageIndexFileField::NAME:
+    return row.row.name.str();
+  case PackageIndexFileField::EPOCH:
+    return row.row.epoch.str();
+  case PackageIndexFileField::VERSION:
+    return row.row.version.str();
+  case PackageIndexFileField::RELEASE:
+    return row.row.release.str();
+  case PackageIndexFileField::ARCH:
+    return row.row.arch.str();
+  case PackageIndexFileField::REPO:
+    return row.row.repo.str();
+  case PackageIndexFileField::SUMMARY:
+    return row.row.summary.str();
+  case PackageIndexFileField::NAME_FOLDED:
+  default:
+    return row.name_folded;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Return true for the fields with few distinct values, which share one copy in
+// the string table.
+// -----------------------------------------------------------------------------
+bool
+shared_field(PackageIndexFileField column)
+{
+  return column == PackageIndexFileField::EPOCH || column == PackageIndexFileField::ARCH ||
+         column == PackageIndexFileField::REPO;
+}
+
+// -----------------------------------------------------------------------------
+// Check every record of a mapped file against the string table and the enum
+// ranges.
+// -----------------------------------------------------------------------------
+bool
+records_are_valid(const unsigned char *records, size_t row_count, uint32_t strings_size)
+{
+  for (size_t i = 0; i < row_count; ++i) {
+    const unsigned char *record = records + i * kRecordSize;
+    for (size_t column = 0; column < kFieldCount; ++column) {
+      uint64_t offset = get_u32(record + column * 8);
+      uint64_t length = get_u32(record + column * 8 + 4);
+      if (offset + length > strings_size) {
+        return false;
+      }
+    }
+    if (record[kEnumsOffset] > static_cast<unsigned char>(PackageInstallReason::EXTERNAL) ||
+        record[kEnumsOffset + 1] > static_cast<unsigned char>(PackageRepoCandidateRelation::OLDER) ||
+        record[kEnumsOffset + 2] > static_cast<unsigned char>(PackageInstallState::INSTALLED_NEWER_THAN_REPO)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Keep the checked mapping. Offsets were validated by map().
+// -----------------------------------------------------------------------------
+PackageIndexFile::PackageIndexFile(const unsigned char *data, size_t size)
+    : data(data)
+    , data_size(size)
+    , row_count(get_u32(data + kRowCountOffset))
+    , records(data + get_u32(data + kRecordsOffsetOffset))
+    , strings(reinterpret_cast<const char *>(data + get_u32(data + kStringsOffsetOffset)))
+{
+}
+
+// -----------------------------------------------------------------------------
+// Unmap the file.
+// -----------------------------------------------------------------------------
+PackageIndexFile::~PackageIndexFile()
+{
+  munmap(const_cast<unsigned char *>(data), data_size);
+}
+
+// -----------------------------------------------------------------------------
+// Map the whole file and check the header, the key, and every record before
+// handing out any view into it.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const PackageIndexFile>
+PackageIndexFile::map(const std::string &path, const std::vector<std::string> &key)
+{
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kHeaderSize) || st.st_size > UINT32_MAX) {
+    close(fd);
+    return nullptr;
+  }
+
+  const size_t size = static_cast<size_t>(st.st_size);
+  void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file open on its own.
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+
+  const auto *data = static_cast<const unsigned char *>(mapped);
+  auto reject = [mapped, size]() -> std::shared_ptr<const PackageIndexFile> {
+    munmap(mapped, size);
+    return nullptr;
+  };
+
+  if (std::string_view(reinterpret_cast<const char *>(data), sizeof kIndexFileMagic) !=
+          std::string_view(kIndexFileMagic, sizeof kIndexFileMagic) ||
+      get_u32(data + kVersionOffset) != kFormatVersion || get_u32(data + kRecordSizeOffset) != kRecordSize) {
+    return reject();
+  }
+
+  const uint64_t row_count = get_u32(data + kRowCountOffset);
+  const uint64_t key_offset = get_u32(data + kKeyOffsetOffset);
+  const uint64_t key_size = get_u32(data + kKeySizeOffset);
+  const uint64_t records_offset = get_u32(data + kRecordsOffsetOffset);
+  const uint64_t strings_offset = get_u32(data + kStringsOffsetOffset);
+  const uint64_t strings_size = get_u32(data + kStringsSizeOffset);
+  if (key_offset != kHeaderSize || records_offset != ((key_offset + key_size + 3) & ~uint64_t { 3 }) ||
+      strings_offset != records_offset + row_count * kRecordSize || strings_offset + strings_size != size) {
+    return reject();
+  }
+
+  const std::string expected_key = joined_key(key);
+  if (std::string_view(reinterpret_cast<const char *>(data + key_offset), key_size) != expected_key) {
+    return reject();
+  }
+
+  if (!records_are_valid(data + records_offset, row_count, static_cast<uint32_t>(strings_size))) {
+    return reject();
+  }
+
+  return std::shared_ptr<const PackageIndexFile>(new PackageIndexFile(data, size));
+}
+
+// -----------------------------------------------------------------------------
+// Return the start of record i.
+// -----------------------------------------------------------------------------
+const unsigned char *
+PackageIndexFile::record(size_t i) const
+{
+  return records + i * kRecordSize;
+}
+
+// -----------------------------------------------------------------------------
+// Return one string field of row i as a view into the string table.
+// -----------------------------------------------------------------------------
+std::string_view
+PackageIndexFile::field(size_t i, PackageIndexFileField column) const
+{
+  const unsigned char *at = record(i) + static_cast<size_t>(column) * 8;
+  return std::string_view(strings + get_u32(at), get_u32(at + 4));
+}
+
+// -----------------------------------------------------------------------------
+// Return the install state saved for row i.
+// -----------------------------------------------------------------------------
+PackageInstallState
+PackageIndexFile::state(size_t i) const
+{
+  return static_cast<PackageInstallState>(record(i)[kEnumsOffset + 2]);
+}
+
+// -----------------------------------------------------------------------------
+// Copy row i. Fields with few distinct values use the interned buffers shared
+// with the live index.
+// -----------------------------------------------------------------------------
+PackageRow
+PackageIndexFile::row(size_t i) const
+{
+  auto text = [this, i](PackageIndexFileField column) { return std::string(field(i, column)); };
+
+  PackageRow row;
+  row.nevra = text(PackageIndexFileField::NEVRA);
+  row.name = text(PackageIndexFileField::NAME);
+  row.epoch = PackageString::interned(text(PackageIndexFileField::EPOCH));
+  row.version = text(PackageIndexFileField::VERSION);
+  row.release = text(PackageIndexFileField::RELEASE);
+  row.arch = PackageString::interned(text(PackageIndexFileField::ARCH));
+  row.repo = PackageString::interned(text(PackageIndexFileField::REPO));
+  row.summary = text(PackageIndexFileField::SUMMARY);
+  row.install_reason = static_cast<PackageInstallReason>(record(i)[kEnumsOffset]);
+  row.repo_candidate_relation = static_cast<PackageRepoCandidateRelation>(record(i)[kEnumsOffset + 1]);
+  return row;
+}
+
+// -----------------------------------------------------------------------------
+// Compare the casefolded names in place without copying any row.
+// -----------------------------------------------------------------------------
+std::vector<uint32_t>
+PackageIndexFile::match_name(const std::string &pattern_folded, bool exact_match) const
+{
+  std::vector<uint32_t> ids;
+  for (size_t i = 0; i < row_count; ++i) {
+    std::string_view name = field(i, PackageIndexFileField::NAME_FOLDED);
+    if (exact_match ? name == pattern_folded : name.find(pattern_folded) != std::string_view::npos) {
+      ids.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  return ids;
+}
+
+// -----------------------------------------------------------------------------
+// Lay out the header, key, records, and string table in that order. Returns an
+// empty string when the rows do not fit the 32-bit offsets.
+// -----------------------------------------------------------------------------
+std::string
+package_index_file_encode(const std::vector<std::string> &key, const std::vector<PackageIndexFileRow> &rows)
+{
+  std::string strings;
+  std::unordered_map<std::string, uint32_t> shared_offsets;
+  std::string records;
+  records.reserve(rows.size() * kRecordSize);
+  for (const auto &row : rows) {
+    for (size_t column = 0; column < kFieldCount; ++column) {
+      const auto field = static_cast<PackageIndexFileField>(column);
+      const std::string &value = row_field(row, field);
+      uint32_t offset = static_cast<uint32_t>(strings.size());
+      if (shared_field(field)) {
+        auto [it, inserted] = shared_offsets.try_emplace(value, offset);
+        offset = it->second;
+        if (inserted) {
+          strings += value;
+        }
+      } else {
+        strings += value;
+      }
+      put_u32(records, offset);
+      put_u32(records, static_cast<uint32_t>(value.size()));
+    }
+    records.push_back(static_cast<char>(row.row.install_reason));
+    records.push_back(static_cast<char>(row.row.repo_candidate_relation));
+    records.push_back(static_cast<char>(row.state));
+    records.push_back('\0');
+  }
+
+  const std::string key_text = joined_key(key);
+  const size_t records_offset = (kHeaderSize + key_text.size() + 3) & ~size_t { 3 };
+  const size_t strings_offset = records_offset + records.size();
+  if (strings_offset + strings.size() > UINT32_MAX) {
+    return {};
+  }
+
+  std::string out(kIndexFileMagic, sizeof kIndexFileMagic);
+  out.resize(kHeaderSize);
+  set_u32(out, kVersionOffset, kFormatVersion);
+  set_u32(out, kRecordSizeOffset, kRecordSize);
+  set_u32(out, kRowCountOffset, static_cast<uint32_t>(rows.size()));
+  set_u32(out, kKeyOffsetOffset, kHeaderSize);
+  set_u32(out, kKeySizeOffset, static_cast<uint32_t>(key_text.size()));
+  set_u32(out, kRecordsOffsetOffset, static_cast<uint32_t>(records_offset));
+  set_u32(out, kStringsOffsetOffset, static_cast<uint32_t>(strings_offset));
+  set_u32(out, kStringsSizeOffset, static_cast<uint32_t>(strings.size()));
+
+  out.reserve(strings_offset + strings.size());
+  out += key_text;
+  out.resize(records_offset, '\0');
+  out += records;
+  out += strings;
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+// Write a temporary file and rename it over the old one.
+// -----------------------------------------------------------------------------
+bool
+package_index_file_write(const std::string &path, const std::string &data)
+{
+  if (path.empty() || data.empty()) {
+    return false;
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+  const std::string tmp_path = path + ".tmp";
+
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file.good()) {
+      return false;
+    }
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file.good()) {
+      file.close();
+      std::filesystem::remove(tmp_path, ec);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_path, ec);
+    return false;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Return the index file path in the user cache directory.
+// -----------------------------------------------------------------------------
+std::string
+package_index_file_default_path()
+{
+  const char *cache_dir = g_get_user_cache_dir();
+  if (!cache_dir || !*cache_dir) {
+    return {};
+  }
+
+  return (std::filesystem::path(cache_dir) / "dnfui-package-index.bin").string();
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_index_file.hpp
+// On-disk package index
+//
+// A successful repo-backed index build writes the merged browse rows to one
+// versioned file in the user cache directory. The file holds a header, the key
+// stamps it was written for, one fixed-width record per row, and a string table
+// the records point into. A later process maps it read-only and serves browse
+// and name searches straight from the mapping until the Base is loaded, as long
+// as the rpmdb and repository metadata stamps still match the key.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// String columns of one record, in file order.
+enum class PackageIndexFileField {
+  NEVRA,
+  NAME,
+  EPOCH,
+  VERSION,
+  RELEASE,
+  ARCH,
+  REPO,
+  SUMMARY,
+  NAME_FOLDED,
+  COUNT,
+};
+
+// -----------------------------------------------------------------------------
+// One row handed to the encoder. name_folded is the casefolded name that name
+// searches match against.
+// -----------------------------------------------------------------------------
+struct PackageIndexFileRow {
+  PackageRow row;
+  PackageInstallState state = PackageInstallState::AVAILABLE;
+  std::string name_folded;
+};
+
+// -----------------------------------------------------------------------------
+// Read-only view of one mapped index file. Field reads return views into the
+// mapping, so rows are only copied when a caller materializes them.
+// -----------------------------------------------------------------------------
+class PackageIndexFile {
+  public:
+  // -----------------------------------------------------------------------------
+  // Map the file at path. Returns nullptr when it is missing, of another
+  // format version, damaged, or written for a different key.
+  // -----------------------------------------------------------------------------
+  static std::shared_ptr<const PackageIndexFile> map(const std::string &path, const std::vector<std::string> &key);
+
+  // -----------------------------------------------------------------------------
+  // Unmap the file.
+  // -----------------------------------------------------------------------------
+  ~PackageIndexFile();
+  // -----------------------------------------------------------------------------
+  // Prevent copying, which would unmap the file twice.
+  // -----------------------------------------------------------------------------
+  PackageIndexFile(const PackageIndexFile &) = delete;
+  PackageIndexFile &operator=(const PackageIndexFile &) = delete;
+
+  // -----------------------------------------------------------------------------
+  // Return the number of rows.
+  // -----------------------------------------------------------------------------
+  size_t size() const
+  {
+    return row_count;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return one string field of row i.
+  // -----------------------------------------------------------------------------
+  std::string_view field(size_t i, PackageIndexFileField column) const;
+  // -----------------------------------------------------------------------------
+  // Return the install state saved for row i.
+  // -----------------------------------------------------------------------------
+  PackageInstallState state(size_t i) const;
+  // -----------------------------------------------------------------------------
+  // Copy row i into a PackageRow.
+  // -----------------------------------------------------------------------------
+  PackageRow row(size_t i) const;
+  // -----------------------------------------------------------------------------
+  // Return the ids of the rows whose casefolded name equals pattern_folded, or
+  // contains it unless exact_match is set, in file order.
+  // -----------------------------------------------------------------------------
+  std::vector<uint32_t> match_name(const std::string &pattern_folded, bool exact_match) const;
+
+  private:
+  // -----------------------------------------------------------------------------
+  // Wrap a mapping that map() has already checked.
+  // -----------------------------------------------------------------------------
+  PackageIndexFile(const unsigned char *data, size_t size);
+
+  // -----------------------------------------------------------------------------
+  // Return the start of record i.
+  // -----------------------------------------------------------------------------
+  const unsigned char *record(size_t i) const;
+
+  const unsigned char *data = nullptr;
+  size_t data_size = 0;
+  size_t row_count = 0;
+  const unsigned char *records = nullptr;
+  const char *strings = nullptr;
+};
+
+// -----------------------------------------------------------------------------
+// Encode rows into the file format, tagged with key.
+// -----------------------------------------------------------------------------
+std::string package_index_file_encode(const std::vector<std::string> &key,
+                                      const std::vector<PackageIndexFileRow> &rows);
+// -----------------------------------------------------------------------------
+// Replace the file at path with data through a temporary file and a rename, so
+// processes that still map the old file keep reading it. Returns false when
+// the file could not be written.
+// -----------------------------------------------------------------------------
+bool package_index_file_write(const std::string &path, const std::string &data);
+// -----------------------------------------------------------------------------
+// Return the index file path in the user cache directory, or an empty string
+// when there is none.
+// -----------------------------------------------------------------------------
+std::string package_index_file_default_path();
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
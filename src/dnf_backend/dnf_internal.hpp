@@ -10,17 +10,23 @@
 #pragma once
 
 #include "dnf_backend/dnf_backend.hpp"
+#include "dnf_backend/dnf_name_arch_map.hpp"
 
+#include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <gio/gio.h>
 
 #include <libdnf5/base/base.hpp>
 #include <libdnf5/rpm/package_query.hpp>
+#include <libdnf5/transaction/transaction_item_reason.hpp>
 
 namespace dnf_backend_internal {
 
@@ -35,18 +41,210 @@ struct InstalledQueryResult {
 
 using AvailableRowsProvider = std::function<std::map<std::string, PackageRow>(GCancellable *)>;
 
+// Plain copy of the libdnf5 package fields a scan converts into rows. libsolv
+// pool access is not thread-safe, so a sharded scan reads these on the calling
+// thread and only the row building runs on worker threads.
+struct ScannedPackage {
+  std::string nevra;
+  std::string name;
+  std::string epoch;
+  std::string version;
+  std::string release;
+  std::string arch;
+  std::string repo_id;
+  std::string summary;
+  // Left empty unless the scan was asked to read descriptions.
+  std::string description;
+  bool installed = false;
+  libdnf5::transaction::TransactionItemReason reason = libdnf5::transaction::TransactionItemReason::NONE;
+  libdnf5::rpm::PackageId id;
+};
+
+// Per-package callback of a sharded scan. The shard index selects the output
+// slot the callback may write to without further locking.
+using PackageScanVisitor = std::function<void(size_t shard, const ScannedPackage &pkg)>;
+
+// One indexed package row plus the casefolded text matched by search filters
+// and the interned name and architecture key used by merge lookups. The libdnf5
+// package id lets fields the row does not carry be read back later from the
+// Base generation the index was built from.
+struct PackageIndexEntry {
+  PackageRow row;
+  std::string name_folded;
+  // Empty until ensure_package_index_descriptions loads the whole index.
+  mutable std::string description_folded;
+  uint64_t name_arch_id = 0;
+  libdnf5::rpm::PackageId package_id;
+};
+
+// One row of the merged browse and search view. It points at the index entry
+// the row is copied from, and carries the repo-candidate relation resolved by
+// the merge so rows are only copied once the caller knows it needs them.
+struct VisibleIndexEntry {
+  const PackageIndexEntry *entry = nullptr;
+  PackageRepoCandidateRelation relation = PackageRepoCandidateRelation::UNKNOWN;
+};
+
+// Casefolded byte trigram posting lists. Each list holds ascending entry ids so
+// substring candidates can be found by intersecting the lists of a pattern.
+using PackageTrigramPostings = std::unordered_map<uint32_t, std::vector<uint32_t>>;
+
+// Trigram postings for one indexed text field over the available and installed
+// entry lists of a PackageIndex.
+struct PackageTrigramIndex {
+  PackageTrigramPostings available;
+  PackageTrigramPostings installed;
+};
+
+// Read-only package rows derived from one BaseManager generation. The index is
+// built once under a Base read lock and then shared by browse, search,
+// installed-list, and upgradeable queries, which filter it without touching
+// libdnf5 again until the next rebuild.
+//
+// Available entries hold one newest repo candidate per name and architecture
+// tuple, sorted by name and then architecture, and available_slots maps each
+// interned tuple key to its position. Available entries keep
+// repo_candidate_relation = UNKNOWN like the live collector does. Installed
+// entries are already annotated against the indexed repo candidates, unless
+// the repo scan failed and available_error is set.
+//
+// Name and description trigram postings are built lazily on the first
+// substring search that needs them, so browse-only sessions never pay for them.
+struct PackageIndex {
+  uint64_t generation = 0;
+  libdnf5::BaseWeakPtr base;
+  std::vector<PackageIndexEntry> available;
+  NameArchSlotMap available_slots;
+  std::string available_error;
+  std::vector<PackageIndexEntry> installed;
+  std::set<std::string> installed_nevras;
+  std::map<std::string, PackageRow> installed_rows_by_name_arch;
+  std::vector<PackageRow> upgradeable;
+  std::set<std::string> self_protected_names;
+
+  mutable std::once_flag descriptions_once;
+  mutable std::once_flag name_trigrams_once;
+  mutable PackageTrigramIndex name_trigrams;
+  mutable std::once_flag description_trigrams_once;
+  mutable PackageTrigramIndex description_trigrams;
+};
+
+// Installed reverse dependencies derived from one BaseManager generation.
+// Installed packages get dense ids, and required_by[id] lists the ids of the
+// other installed packages that require a capability the package provides,
+// sorted by NEVRA. Lookups cost the NEVRA hash plus the package's in-degree.
+struct InstalledReverseDeps {
+  uint64_t generation = 0;
+  libdnf5::BaseWeakPtr base;
+  std::vector<std::string> nevras;
+  std::unordered_map<std::string, uint32_t> nevras_to_ids;
+  std::vector<std::vector<uint32_t>> required_by;
+};
+
+// One installed file path, stored as a slice of InstalledFileIndex::path_bytes,
+// plus the dense id of the installed package that owns it.
+struct InstalledFileEntry {
+  uint32_t offset = 0;
+  uint32_t length = 0;
+  uint32_t package = 0;
+};
+
+// Installed file paths derived from one BaseManager generation. The paths of
+// every installed package are packed into one buffer and the entries are
+// sorted by path, so exact and prefix lookups are a binary search and a glob
+// only checks the paths under its literal prefix.
+struct InstalledFileIndex {
+  uint64_t generation = 0;
+  libdnf5::BaseWeakPtr base;
+  std::string path_bytes;
+  std::vector<InstalledFileEntry> entries;
+  std::vector<std::string> nevras;
+};
+
+// -----------------------------------------------------------------------------
+// Translate one libdnf5 install reason into the backend-owned enum.
+// -----------------------------------------------------------------------------
+PackageInstallReason package_install_reason_from_libdnf(libdnf5::transaction::TransactionItemReason reason);
+
 // -----------------------------------------------------------------------------
 // Convert one libdnf5 package object to the backend-owned presentation row.
 // -----------------------------------------------------------------------------
 PackageRow
 make_package_row(const libdnf5::rpm::Package &pkg,
                  PackageRepoCandidateRelation repo_candidate_relation = PackageRepoCandidateRelation::UNKNOWN);
+// -----------------------------------------------------------------------------
+// Build the same row from fields already read out of libdnf5. Touches no
+// libdnf5 state, so scan workers can call it.
+// -----------------------------------------------------------------------------
+PackageRow
+make_package_row(const ScannedPackage &pkg,
+                 PackageRepoCandidateRelation repo_candidate_relation = PackageRepoCandidateRelation::UNKNOWN);
+// -----------------------------------------------------------------------------
+// Read the fields make_package_row needs, and the description when asked to.
+// Must run on the thread that holds the Base read lock.
+// -----------------------------------------------------------------------------
+ScannedPackage read_scanned_package(const libdnf5::rpm::Package &pkg, bool with_description);
 
 // -----------------------------------------------------------------------------
 // Return true when the active package query task was cancelled by the UI.
 // -----------------------------------------------------------------------------
 bool package_query_cancelled(GCancellable *cancellable);
 
+// -----------------------------------------------------------------------------
+// Keep the newest row for one package name and architecture tuple.
+// -----------------------------------------------------------------------------
+void remember_newest_row(std::map<std::string, PackageRow> &rows_by_name_arch, const PackageRow &row);
+// -----------------------------------------------------------------------------
+// Return a UTF-8 casefolded copy of package search text.
+// -----------------------------------------------------------------------------
+std::string utf8_casefold_copy(const std::string &text);
+// -----------------------------------------------------------------------------
+// Match package text against an already casefolded pattern. ASCII text is
+// compared in place; other text is folded with GLib first.
+// -----------------------------------------------------------------------------
+bool utf8_casefold_equals(const std::string &text, const std::string &pattern_folded);
+bool utf8_casefold_contains(const std::string &text, const std::string &pattern_folded);
+// -----------------------------------------------------------------------------
+// Return true when one package matches the active search term using the same
+// name and description flag semantics as the main UI search controls. The
+// description is only fetched when the name does not match and description
+// search is on.
+// -----------------------------------------------------------------------------
+template <typename DescriptionFn>
+bool
+package_text_matches_search(const std::string &name,
+                            DescriptionFn &&description,
+                            const std::string &pattern_lower,
+                            const DnfBackendSearchOptions &search_options)
+{
+  if (search_options.exact_match) {
+    return utf8_casefold_equals(name, pattern_lower);
+  }
+
+  if (utf8_casefold_contains(name, pattern_lower)) {
+    return true;
+  }
+
+  if (!search_options.search_in_description) {
+    return false;
+  }
+
+  return utf8_casefold_contains(description(), pattern_lower);
+}
+
+// -----------------------------------------------------------------------------
+// Visit every package of one query, split into contiguous shards on worker
+// threads when parallel scanning is enabled. The package fields are read on the
+// calling thread first, with descriptions only when with_descriptions is set.
+// Merging the per-shard output in shard order reproduces the single-threaded
+// visit order. Returns false when the scan was cancelled.
+// -----------------------------------------------------------------------------
+bool scan_packages_sharded(const libdnf5::rpm::PackageQuery &query,
+                           GCancellable *cancellable,
+                           bool with_descriptions,
+                           const std::function<void(size_t shard_count)> &prepare_shards,
+                           const PackageScanVisitor &visit);
+
 // -----------------------------------------------------------------------------
 // Collect query rows keyed by package name and architecture. These helpers intentionally
 // require a caller-supplied Base reference so the caller controls the Base lock
@@ -65,6 +263,12 @@ InstalledQueryResult collect_installed_rows(libdnf5::Base &base,
                                             const std::string *pattern = nullptr);
 
 // -----------------------------------------------------------------------------
+// Return how one installed row compares to its newest visible repo candidate.
+// A null candidate means no repo candidate exists for the tuple.
+// -----------------------------------------------------------------------------
+PackageRepoCandidateRelation repo_candidate_relation_for(const PackageRow &installed_row,
+                                                         const PackageRow *candidate_row);
+// -----------------------------------------------------------------------------
 // Repo-candidate annotation and browse and search merge helpers shared by query and
 // test-only fallback paths.
 // -----------------------------------------------------------------------------
@@ -77,10 +281,170 @@ void annotate_installed_rows_with_repo_candidates_best_effort(std::vector<Packag
                                                               GCancellable *cancellable,
                                                               const AvailableRowsProvider &available_rows_provider);
 // -----------------------------------------------------------------------------
-// Merge available and installed row maps into the visible package list.
+// Merge matched available and installed index entries into the visible
+// package list. available_matches must be in index order.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+visible_rows_from_index_matches(const std::vector<const PackageIndexEntry *> &available_matches,
+                                const std::vector<const PackageIndexEntry *> &installed_matches);
+// -----------------------------------------------------------------------------
+// Merge matched available and installed index entries into the visible view
+// without copying rows. The result has the same order as
+// visible_rows_from_index_matches.
+// -----------------------------------------------------------------------------
+std::vector<VisibleIndexEntry>
+visible_entries_from_index_matches(const std::vector<const PackageIndexEntry *> &available_matches,
+                                   const std::vector<const PackageIndexEntry *> &installed_matches);
+// -----------------------------------------------------------------------------
+// Copy one visible entry into a package row.
+// -----------------------------------------------------------------------------
+PackageRow visible_entry_row(const VisibleIndexEntry &visible);
+// -----------------------------------------------------------------------------
+// Return the search rank of one matched entry, lower is better: 0 for an exact
+// name, 1 for a name prefix, 2 for a name substring, 3 for a description hit.
+// -----------------------------------------------------------------------------
+int package_search_rank(const PackageIndexEntry &entry, const std::string &pattern_lower);
+// -----------------------------------------------------------------------------
+// Return rows [offset, offset + limit) of the visible entries ordered by search
+// rank, keeping the merged order within one rank.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow> ranked_rows_from_visible_entries(const std::vector<VisibleIndexEntry> &visible,
+                                                         const std::string &pattern_lower,
+                                                         size_t offset,
+                                                         size_t limit);
+
+// -----------------------------------------------------------------------------
+// Return the package index for the Base generation the caller has locked,
+// building it on first use. Returns nullptr when the build was cancelled; a
+// cancelled build is never published for other callers.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const PackageIndex>
+acquire_package_index(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Load the casefolded descriptions of every entry on first use. Browse and name
+// searches never read them, so the index build skips them. The caller must hold
+// the Base read lock for the generation the index was built from. Returns false
+// when cancelled, and the next description search loads them again.
+// -----------------------------------------------------------------------------
+bool ensure_package_index_descriptions(libdnf5::Base &base, const PackageIndex &index, GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Return the published package index for the locked Base generation without
+// building it. Returns nullptr when no query has built it yet.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const PackageIndex> find_package_index(libdnf5::Base &base, uint64_t generation);
+// -----------------------------------------------------------------------------
+// Return the newest indexed repo candidate for the row's name and architecture,
+// or nullptr when the index has none.
+// -----------------------------------------------------------------------------
+const PackageRow *find_indexed_repo_candidate(const PackageIndex &index, const PackageRow &row);
+// -----------------------------------------------------------------------------
+// Return the available index entry for the row's name and architecture, or
+// nullptr when the index has none.
+// -----------------------------------------------------------------------------
+const PackageIndexEntry *find_indexed_repo_entry(const PackageIndex &index, const PackageRow &row);
+// -----------------------------------------------------------------------------
+// Copy the installed rows and exact-NEVRA lookups held by the index into the
+// form published as the installed snapshot.
+// -----------------------------------------------------------------------------
+InstalledQueryResult installed_query_result_from_index(const PackageIndex &index);
+// -----------------------------------------------------------------------------
+// Return true when one indexed row matches the casefolded search pattern.
+// -----------------------------------------------------------------------------
+bool package_index_entry_matches(const PackageIndexEntry &entry,
+                                 const std::string &pattern_lower,
+                                 const DnfBackendSearchOptions &search_options);
+// -----------------------------------------------------------------------------
+// Collect the available and installed index entries that match one casefolded
+// search pattern. Substring searches of three or more bytes intersect trigram
+// postings and verify only the candidates; shorter patterns and exact-name
+// searches scan the entry lists. Returns false when cancelled.
+// -----------------------------------------------------------------------------
+bool search_package_index(const PackageIndex &index,
+                          const std::string &pattern_lower,
+                          const DnfBackendSearchOptions &search_options,
+                          GCancellable *cancellable,
+                          std::vector<const PackageIndexEntry *> &available_matches,
+                          std::vector<const PackageIndexEntry *> &installed_matches);
+// -----------------------------------------------------------------------------
+// Drop the published package index so the next query rebuilds it.
+// -----------------------------------------------------------------------------
+void reset_package_index();
+
+// -----------------------------------------------------------------------------
+// Map the on-disk package index when its key matches the rpmdb and repository
+// metadata stamps a repo-backed build would load now. Returns true when a file
+// is mapped.
+// -----------------------------------------------------------------------------
+bool open_package_index_file();
+// -----------------------------------------------------------------------------
+// Answer a browse (empty pattern) or name search from the mapped on-disk
+// index. Returns false when no file is mapped or the search also matches
+// descriptions or files, which the file does not hold.
+// -----------------------------------------------------------------------------
+bool query_package_index_file(const std::string &pattern,
+                              const DnfBackendSearchOptions &search_options,
+                              std::vector<PackageRow> &rows,
+                              std::vector<PackageInstallState> &states);
+// -----------------------------------------------------------------------------
+// Drop the mapped on-disk index.
+// -----------------------------------------------------------------------------
+void close_package_index_file();
+// -----------------------------------------------------------------------------
+// Write the browse rows of a complete repo-backed index to disk, tagged with the
+// inputs of the published Base, unless the file already holds that key.
+// -----------------------------------------------------------------------------
+void store_package_index_file(const PackageIndex &index);
+
+// -----------------------------------------------------------------------------
+// Return the installed reverse-dependency index for the Base generation the
+// caller has locked, building it on first use. Returns nullptr when the build
+// was cancelled; a cancelled build is never published for other callers.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const InstalledReverseDeps>
+acquire_installed_reverse_deps(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Return the installed packages that require one installed NEVRA, in NEVRA
+// order, or an empty list when the NEVRA is not installed.
+// -----------------------------------------------------------------------------
+std::vector<std::string> installed_required_by(const InstalledReverseDeps &index, const std::string &nevra);
+// -----------------------------------------------------------------------------
+// Drop the published reverse-dependency index so the next lookup rebuilds it.
+// -----------------------------------------------------------------------------
+void reset_installed_reverse_deps();
+
+// -----------------------------------------------------------------------------
+// Return the installed file index for the Base generation the caller has
+// locked, building it on first use. Returns nullptr when the build was
+// cancelled; a cancelled build is never published for other callers.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const InstalledFileIndex>
+acquire_installed_file_index(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Return the NEVRAs of the installed packages owning a path that matches one
+// path pattern: equal to it for an exact match, a shell glob when it holds
+// *, ? or [, and a path prefix otherwise.
+// -----------------------------------------------------------------------------
+std::set<std::string> installed_file_owners(const InstalledFileIndex &index, const std::string &pattern, bool exact);
+// -----------------------------------------------------------------------------
+// Collect the package index entries of the packages that own a matching file
+// (patterns starting with /) or provide a matching capability (any other
+// pattern). Installed paths come from the installed file index; available
+// paths come from whatever file lists the loaded repo metadata holds. The
+// caller must hold the Base read lock for generation. Returns false when
+// cancelled.
+// -----------------------------------------------------------------------------
+bool search_file_owner_entries(libdnf5::Base &base,
+                               uint64_t generation,
+                               const PackageIndex &index,
+                               const std::string &pattern,
+                               const DnfBackendSearchOptions &search_options,
+                               GCancellable *cancellable,
+                               std::vector<const PackageIndexEntry *> &available_matches,
+                               std::vector<const PackageIndexEntry *> &installed_matches);
+// -----------------------------------------------------------------------------
+// Drop the published installed file index so the next lookup rebuilds it.
 // -----------------------------------------------------------------------------
-std::vector<PackageRow> visible_rows_from_maps(std::map<std::string, PackageRow> available_rows,
-                                               std::map<std::string, PackageRow> installed_rows);
+void reset_installed_file_index();
 
 // -----------------------------------------------------------------------------
 // State-cache helpers owned by dnf_state.cpp and used by query refresh paths.
@@ -0,0 +1,126 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_name_arch_map.hpp
+// Interned package name and architecture keys
+//
+// Package identity lookups used to key std::map trees with a freshly built
+// "name\narch" string per row. These helpers intern names and architectures
+// into 32-bit ids once per package index, pack each tuple into one 64-bit key,
+// and look keys up in a flat open-addressing table that does not allocate per
+// row.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Assign stable 32-bit ids to package name and architecture strings.
+// -----------------------------------------------------------------------------
+class NameArchInterner {
+  public:
+  // -----------------------------------------------------------------------------
+  // Return the packed key for one package name and architecture tuple.
+  // -----------------------------------------------------------------------------
+  uint64_t key_for(const std::string &name, const std::string &arch)
+  {
+    return (static_cast<uint64_t>(intern(names, name)) << 32) | intern(arches, arch);
+  }
+
+  private:
+  // -----------------------------------------------------------------------------
+  // Return the id for one string, assigning the next id on first use.
+  // -----------------------------------------------------------------------------
+  static uint32_t intern(std::unordered_map<std::string, uint32_t> &ids, const std::string &text)
+  {
+    auto [it, inserted] = ids.emplace(text, static_cast<uint32_t>(ids.size()));
+    return it->second;
+  }
+
+  std::unordered_map<std::string, uint32_t> names;
+  std::unordered_map<std::string, uint32_t> arches;
+};
+
+// -----------------------------------------------------------------------------
+// Open-addressing map from packed name and architecture keys to row slots.
+// The table is sized once for the expected number of keys and uses linear
+// probing, so lookups and inserts never allocate.
+// -----------------------------------------------------------------------------
+class NameArchSlotMap {
+  public:
+  static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+  // -----------------------------------------------------------------------------
+  // Size the table for up to expected_keys keys at no more than half load.
+  // -----------------------------------------------------------------------------
+  explicit NameArchSlotMap(size_t expected_keys = 0)
+  {
+    size_t capacity = 16;
+    while (capacity < expected_keys * 2) {
+      capacity <<= 1;
+    }
+    keys.assign(capacity, kEmptyKey);
+    slots.assign(capacity, kNoSlot);
+    mask = capacity - 1;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the slot stored for key, or kNoSlot when the key is absent.
+  // -----------------------------------------------------------------------------
+  uint32_t find(uint64_t key) const
+  {
+    for (size_t pos = hash(key) & mask;; pos = (pos + 1) & mask) {
+      if (keys[pos] == key) {
+        return slots[pos];
+      }
+      if (keys[pos] == kEmptyKey) {
+        return kNoSlot;
+      }
+    }
+  }
+
+  // -----------------------------------------------------------------------------
+  // Insert key with slot when absent. Returns the stored slot and whether the
+  // key was inserted. Callers must not insert more keys than the table was
+  // sized for.
+  // -----------------------------------------------------------------------------
+  std::pair<uint32_t, bool> try_emplace(uint64_t key, uint32_t slot)
+  {
+    for (size_t pos = hash(key) & mask;; pos = (pos + 1) & mask) {
+      if (keys[pos] == key) {
+        return { slots[pos], false };
+      }
+      if (keys[pos] == kEmptyKey) {
+        keys[pos] = key;
+        slots[pos] = slot;
+        return { slot, true };
+      }
+    }
+  }
+
+  private:
+  // Interned ids stay below UINT32_MAX, so this packed key is never produced.
+  static constexpr uint64_t kEmptyKey = UINT64_MAX;
+
+  // -----------------------------------------------------------------------------
+  // Mix the packed key so sequential ids spread across the table.
+  // -----------------------------------------------------------------------------
+  static size_t hash(uint64_t key)
+  {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+  }
+
+  std::vector<uint64_t> keys;
+  std::vector<uint32_t> slots;
+  size_t mask = 0;
+};
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,187 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_package_string.hpp
+// Shared immutable package metadata strings
+//
+// PackageRow values are copied from the package index into every list, search
+// and snapshot result. PackageString keeps each field in one shared immutable
+// buffer so those copies only bump a reference count, and interns the
+// low-cardinality fields such as architecture, repository and epoch so every
+// row naming the same value points at one pooled string.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// -----------------------------------------------------------------------------
+// Immutable string value with shared storage. Reads go through str(), which
+// returns a stable reference for the lifetime of the value, and assignment
+// replaces the shared buffer instead of mutating it.
+// -----------------------------------------------------------------------------
+class PackageString {
+  public:
+  // -----------------------------------------------------------------------------
+  // Construct an empty string that shares one static empty buffer.
+  // -----------------------------------------------------------------------------
+  PackageString()
+      : text(empty_text())
+  {
+  }
+
+  // -----------------------------------------------------------------------------
+  // Construct a string that owns a new shared copy of value.
+  // -----------------------------------------------------------------------------
+  PackageString(std::string value)
+      : text(value.empty() ? empty_text() : std::make_shared<const std::string>(std::move(value)))
+  {
+  }
+
+  // -----------------------------------------------------------------------------
+  // Construct a string that owns a new shared copy of a C string.
+  // -----------------------------------------------------------------------------
+  PackageString(const char *value)
+      : PackageString(std::string(value ? value : ""))
+  {
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the pooled string for value. Equal values share one buffer for the
+  // lifetime of the process, so only use this for fields with few distinct
+  // values.
+  // -----------------------------------------------------------------------------
+  static PackageString interned(const std::string &value)
+  {
+    if (value.empty()) {
+      return PackageString();
+    }
+
+    auto &pool = intern_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    auto it = pool.strings.find(value);
+    if (it == pool.strings.end()) {
+      auto text = std::make_shared<const std::string>(value);
+      it = pool.strings.emplace(std::string_view(*text), std::move(text)).first;
+    }
+
+    PackageString result;
+    result.text = it->second;
+    return result;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the underlying string.
+  // -----------------------------------------------------------------------------
+  const std::string &str() const
+  {
+    return *text;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Allow PackageString to be passed wherever a const std::string & is read.
+  // -----------------------------------------------------------------------------
+  operator const std::string &() const
+  {
+    return *text;
+  }
+
+  const char *c_str() const
+  {
+    return text->c_str();
+  }
+
+  bool empty() const
+  {
+    return text->empty();
+  }
+
+  size_t size() const
+  {
+    return text->size();
+  }
+
+  int compare(const PackageString &other) const
+  {
+    return text == other.text ? 0 : text->compare(*other.text);
+  }
+
+  int compare(const std::string &other) const
+  {
+    return text->compare(other);
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return true when both values share one buffer, as interned equal values do.
+  // -----------------------------------------------------------------------------
+  bool shares_storage_with(const PackageString &other) const
+  {
+    return text == other.text;
+  }
+
+  friend bool operator==(const PackageString &lhs, const PackageString &rhs)
+  {
+    return lhs.text == rhs.text || *lhs.text == *rhs.text;
+  }
+
+  friend bool operator==(const PackageString &lhs, const std::string &rhs)
+  {
+    return *lhs.text == rhs;
+  }
+
+  friend bool operator==(const PackageString &lhs, const char *rhs)
+  {
+    return *lhs.text == rhs;
+  }
+
+  friend std::strong_ordering operator<=>(const PackageString &lhs, const PackageString &rhs)
+  {
+    return lhs.compare(rhs) <=> 0;
+  }
+
+  friend std::strong_ordering operator<=>(const PackageString &lhs, const std::string &rhs)
+  {
+    return lhs.compare(rhs) <=> 0;
+  }
+
+  friend std::ostream &operator<<(std::ostream &out, const PackageString &value)
+  {
+    return out << *value.text;
+  }
+
+  private:
+  // Pooled strings keyed by a view into their own shared buffer.
+  struct InternPool {
+    std::mutex mutex;
+    std::unordered_map<std::string_view, std::shared_ptr<const std::string>> strings;
+  };
+
+  // -----------------------------------------------------------------------------
+  // Return the process-wide intern pool.
+  // -----------------------------------------------------------------------------
+  static InternPool &intern_pool()
+  {
+    static InternPool pool;
+    return pool;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Return the shared empty buffer used by default-constructed values.
+  // -----------------------------------------------------------------------------
+  static const std::shared_ptr<const std::string> &empty_text()
+  {
+    static const std::shared_ptr<const std::string> empty = std::make_shared<const std::string>();
+    return empty;
+  }
+
+  std::shared_ptr<const std::string> text;
+};
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
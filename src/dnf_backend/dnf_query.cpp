@@ -10,9 +10,13 @@
 
 #include "base_manager.hpp"
 #include "debug_trace.hpp"
+#include "trace_spans.hpp"
 
 #include <algorithm>
+#include <functional>
 #include <map>
+#include <set>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -26,55 +30,16 @@
 namespace dnf_backend_internal {
 
 // -----------------------------------------------------------------------------
-// Keep the newest row for one package name and architecture tuple.
-// -----------------------------------------------------------------------------
-static void
-remember_newest_row(std::map<std::string, PackageRow> &rows_by_name_arch, const PackageRow &row)
-{
-  auto [it, inserted] = rows_by_name_arch.emplace(row.name_arch_key(), row);
-  if (!inserted && libdnf5::rpm::evrcmp(row, it->second) > 0) {
-    it->second = row;
-  }
-}
-
-// -----------------------------------------------------------------------------
-// Fold UTF-8 package search text before comparing it against libdnf5 metadata
-// fields. This keeps manual name and description matching aligned with GTK's
-// case-insensitive text handling for non-ASCII package summaries.
-// -----------------------------------------------------------------------------
-static std::string
-utf8_casefold_copy(const std::string &text)
-{
-  char *folded = g_utf8_casefold(text.c_str(), -1);
-  std::string result = folded ? folded : "";
-  g_free(folded);
-  return result;
-}
-
-// -----------------------------------------------------------------------------
-// Return true when one package matches the active search term using the same
-// name and description flag semantics as the main UI search controls.
+// Match one scanned package against the active search term. The description is
+// only set when the scan read descriptions.
 // -----------------------------------------------------------------------------
 static bool
-package_matches_search(const libdnf5::rpm::Package &pkg,
-                       const std::string &pattern_lower,
-                       const DnfBackendSearchOptions &search_options)
+scanned_package_matches_search(const ScannedPackage &pkg,
+                               const std::string &pattern_lower,
+                               const DnfBackendSearchOptions &search_options)
 {
-  std::string name = utf8_casefold_copy(pkg.get_name());
-  if (search_options.exact_match) {
-    return name == pattern_lower;
-  }
-
-  if (name.find(pattern_lower) != std::string::npos) {
-    return true;
-  }
-
-  if (!search_options.search_in_description) {
-    return false;
-  }
-
-  std::string description = utf8_casefold_copy(pkg.get_description());
-  return description.find(pattern_lower) != std::string::npos;
+  return package_text_matches_search(
+      pkg.name, [&pkg]() -> const std::string & { return pkg.description; }, pattern_lower, search_options);
 }
 
 // -----------------------------------------------------------------------------
@@ -101,23 +66,34 @@ collect_available_rows_by_name_arch(libdnf5::Base &base,
   }
 
   const std::string pattern_lower = pattern ? utf8_casefold_copy(*pattern) : "";
-  std::map<std::string, PackageRow> rows_by_name_arch;
+  std::vector<std::vector<PackageRow>> shards;
+
+  const bool match_descriptions = pattern && search_options.search_in_description;
+  bool completed = scan_packages_sharded(
+      query,
+      cancellable,
+      match_descriptions,
+      [&shards](size_t shard_count) { shards.resize(shard_count); },
+      [&](size_t shard, const ScannedPackage &pkg) {
+        if (match_descriptions && !scanned_package_matches_search(pkg, pattern_lower, search_options)) {
+          return;
+        }
+
+        // Provenance is UNKNOWN until compared against the installed set. The
+        // merge or annotation helpers resolve it when installed rows are available.
+        shards[shard].push_back(make_package_row(pkg, PackageRepoCandidateRelation::UNKNOWN));
+      });
 
-  for (auto pkg : query) {
-    if (package_query_cancelled(cancellable)) {
-      rows_by_name_arch.clear();
-      return rows_by_name_arch;
-    }
+  std::map<std::string, PackageRow> rows_by_name_arch;
+  if (!completed) {
+    return rows_by_name_arch;
+  }
 
-    if (pattern && search_options.search_in_description &&
-        !package_matches_search(pkg, pattern_lower, search_options)) {
-      continue;
+  // Merge in shard order so equal-EVR ties keep the same winner as a serial scan.
+  for (const auto &rows : shards) {
+    for (const auto &row : rows) {
+      remember_newest_row(rows_by_name_arch, row);
     }
-
-    // Provenance is UNKNOWN until compared against the installed set. The
-    // merge or annotation helpers resolve it when installed rows are available.
-    PackageRow row = make_package_row(pkg, PackageRepoCandidateRelation::UNKNOWN);
-    remember_newest_row(rows_by_name_arch, row);
   }
 
   return rows_by_name_arch;
@@ -140,22 +116,28 @@ collect_installed_rows(libdnf5::Base &base,
   libdnf5::rpm::PackageQuery query(base);
   query.filter_installed();
 
-  for (auto pkg : query) {
-    if (package_query_cancelled(cancellable)) {
-      result.rows.clear();
-      result.nevras.clear();
-      result.rows_by_name_arch.clear();
-      return result;
-    }
+  std::vector<std::vector<PackageRow>> shards;
+  bool completed = scan_packages_sharded(
+      query,
+      cancellable,
+      pattern && search_options.search_in_description,
+      [&shards](size_t shard_count) { shards.resize(shard_count); },
+      [&](size_t shard, const ScannedPackage &pkg) {
+        if (pattern && !scanned_package_matches_search(pkg, pattern_lower, search_options)) {
+          return;
+        }
+        shards[shard].push_back(make_package_row(pkg));
+      });
+  if (!completed) {
+    return result;
+  }
 
-    if (pattern && !package_matches_search(pkg, pattern_lower, search_options)) {
-      continue;
+  for (auto &rows : shards) {
+    for (auto &row : rows) {
+      result.nevras.insert(row.nevra);
+      remember_newest_row(result.rows_by_name_arch, row);
+      result.rows.push_back(std::move(row));
     }
-
-    PackageRow row = make_package_row(pkg);
-    result.nevras.insert(row.nevra);
-    remember_newest_row(result.rows_by_name_arch, row);
-    result.rows.push_back(row);
   }
 
   return result;
@@ -163,26 +145,36 @@ collect_installed_rows(libdnf5::Base &base,
 
 // -----------------------------------------------------------------------------
 // Compare one installed row against the newest visible repo candidate for the
-// same name and architecture tuple and annotate the row with the resolved relationship.
+// same name and architecture tuple.
 // -----------------------------------------------------------------------------
-void
-annotate_installed_row_with_repo_candidate(PackageRow &installed_row,
-                                           const std::map<std::string, PackageRow> &available_rows)
+PackageRepoCandidateRelation
+repo_candidate_relation_for(const PackageRow &installed_row, const PackageRow *candidate_row)
 {
-  auto it = available_rows.find(installed_row.name_arch_key());
-  if (it == available_rows.end()) {
-    installed_row.repo_candidate_relation = PackageRepoCandidateRelation::NONE;
-    return;
+  if (!candidate_row) {
+    return PackageRepoCandidateRelation::NONE;
   }
 
-  int cmp = libdnf5::rpm::evrcmp(it->second, installed_row);
+  int cmp = libdnf5::rpm::evrcmp(*candidate_row, installed_row);
   if (cmp > 0) {
-    installed_row.repo_candidate_relation = PackageRepoCandidateRelation::NEWER;
-  } else if (cmp < 0) {
-    installed_row.repo_candidate_relation = PackageRepoCandidateRelation::OLDER;
-  } else {
-    installed_row.repo_candidate_relation = PackageRepoCandidateRelation::SAME;
+    return PackageRepoCandidateRelation::NEWER;
   }
+  if (cmp < 0) {
+    return PackageRepoCandidateRelation::OLDER;
+  }
+  return PackageRepoCandidateRelation::SAME;
+}
+
+// -----------------------------------------------------------------------------
+// Annotate one installed row with the resolved relationship to the newest
+// visible repo candidate for the same name and architecture tuple.
+// -----------------------------------------------------------------------------
+void
+annotate_installed_row_with_repo_candidate(PackageRow &installed_row,
+                                           const std::map<std::string, PackageRow> &available_rows)
+{
+  auto it = available_rows.find(installed_row.name_arch_key());
+  installed_row.repo_candidate_relation =
+      repo_candidate_relation_for(installed_row, it == available_rows.end() ? nullptr : &it->second);
 }
 
 // -----------------------------------------------------------------------------
@@ -213,206 +205,745 @@ annotate_installed_rows_with_repo_candidates_best_effort(std::vector<PackageRow>
   }
 }
 
+} // namespace dnf_backend_internal
+
+using namespace dnf_backend_internal;
+
 // -----------------------------------------------------------------------------
-// Build the merged package view used by search and browse: start with the
-// visible repo-backed candidates, then add installed-only rows for name and architecture
-// tuples that are missing from enabled repositories. If an installed package is
-// newer than the repo candidate, keep the installed row so the UI can surface
-// that state directly.
-//
-// Note on repo_candidate_relation in the returned rows:
-//   - Installed rows that are promoted into the map (LOCAL_ONLY, OLDER, or the
-//     installed-newer-than-repo case) carry a fully resolved relation.
-//   - Available rows that stay in the map without a matching installed entry
-//     keep repo_candidate_relation = UNKNOWN because no installed counterpart
-//     was found during this pass.
-//   - dnf_backend_get_package_install_state handles UNKNOWN on available rows
-//     through its installed-cache EVR comparison fallback.
-//
-// Code that reads repo_candidate_relation directly should treat UNKNOWN on a
-// non-installed row as "no installed counterpart known", not as a failed repo
-// lookup.
+// Return the package index for the current Base generation. The Base read lock
+// is held only while the index is looked up or built, so callers filter the
+// returned rows without blocking a concurrent rebuild. Searches that match
+// descriptions get them loaded under the same lock.
 // -----------------------------------------------------------------------------
-std::vector<PackageRow>
-visible_rows_from_maps(std::map<std::string, PackageRow> available_rows,
-                       std::map<std::string, PackageRow> installed_rows)
+static std::shared_ptr<const PackageIndex>
+current_package_index(GCancellable *cancellable, const DnfBackendSearchOptions *search_options = nullptr)
 {
-  for (auto &[key, installed_row] : installed_rows) {
-    annotate_installed_row_with_repo_candidate(installed_row, available_rows);
+  auto [base, guard, generation] = BaseManager::instance().acquire_read();
+  auto index = acquire_package_index(base, generation, cancellable);
+  if (index && search_options && search_options->search_in_description && !search_options->exact_match &&
+      !ensure_package_index_descriptions(base, *index, cancellable)) {
+    return nullptr;
+  }
+  return index;
+}
 
-    auto visible_it = available_rows.find(key);
-    if (visible_it == available_rows.end()) {
-      available_rows.emplace(key, installed_row);
-      continue;
-    }
+// -----------------------------------------------------------------------------
+// Surface a failed repo scan to repo-backed queries the same way a live
+// libdnf5 query failure would.
+// -----------------------------------------------------------------------------
+static void
+require_indexed_repo_rows(const PackageIndex &index)
+{
+  if (!index.available_error.empty()) {
+    throw std::runtime_error(index.available_error);
+  }
+}
 
-    if (libdnf5::rpm::evrcmp(installed_row, visible_it->second) > 0) {
-      visible_it->second = installed_row;
-    }
+// -----------------------------------------------------------------------------
+// Collect the index entries of the packages owning or providing the pattern.
+// The Base read lock stays held across the libdnf5 file and provides queries,
+// and index keeps the matched entries alive once it is released. Returns false
+// when cancelled.
+// -----------------------------------------------------------------------------
+static bool
+search_file_owners(const std::string &pattern,
+                   const DnfBackendSearchOptions &search_options,
+                   GCancellable *cancellable,
+                   std::shared_ptr<const PackageIndex> &index,
+                   std::vector<const PackageIndexEntry *> &available_matches,
+                   std::vector<const PackageIndexEntry *> &installed_matches)
+{
+  DNFUI_TRACE_SPAN("query", "file search", pattern);
+  auto [base, guard, generation] = BaseManager::instance().acquire_read();
+  index = acquire_package_index(base, generation, cancellable);
+  if (!index || package_query_cancelled(cancellable)) {
+    return false;
   }
+  require_indexed_repo_rows(*index);
 
+  return search_file_owner_entries(
+      base, generation, *index, pattern, search_options, cancellable, available_matches, installed_matches);
+}
+
+// -----------------------------------------------------------------------------
+// Copy the rows of merged visible entries.
+// -----------------------------------------------------------------------------
+static std::vector<PackageRow>
+rows_from_visible_entries(const std::vector<VisibleIndexEntry> &visible)
+{
   std::vector<PackageRow> rows;
-  rows.reserve(available_rows.size());
-  for (auto &[key, row] : available_rows) {
-    rows.push_back(row);
+  rows.reserve(visible.size());
+  for (const auto &entry : visible) {
+    rows.push_back(visible_entry_row(entry));
   }
   return rows;
 }
 
-} // namespace dnf_backend_internal
+// -----------------------------------------------------------------------------
+// Match pattern against the package index and merge the matches into visible
+// entries. Returns the index that keeps the entries alive, or null when
+// cancelled.
+// -----------------------------------------------------------------------------
+static std::shared_ptr<const PackageIndex>
+search_visible_entries(const std::string &pattern,
+                       const DnfBackendSearchOptions &search_options,
+                       GCancellable *cancellable,
+                       std::vector<VisibleIndexEntry> &visible)
+{
+  std::shared_ptr<const PackageIndex> index;
+  std::vector<const PackageIndexEntry *> available_matches;
+  std::vector<const PackageIndexEntry *> installed_matches;
 
-using namespace dnf_backend_internal;
+  if (search_options.search_in_files) {
+    if (!search_file_owners(pattern, search_options, cancellable, index, available_matches, installed_matches)) {
+      return nullptr;
+    }
+  } else {
+    index = current_package_index(cancellable, &search_options);
+    if (!index || package_query_cancelled(cancellable)) {
+      return nullptr;
+    }
+    require_indexed_repo_rows(*index);
+
+    const std::string pattern_lower = utf8_casefold_copy(pattern);
+    if (!search_package_index(
+            *index, pattern_lower, search_options, cancellable, available_matches, installed_matches)) {
+      return nullptr;
+    }
+  }
+
+  visible = visible_entries_from_index_matches(available_matches, installed_matches);
+  return index;
+}
 
 // -----------------------------------------------------------------------------
-// Search merged repo and installed-only package rows and stop early when the
-// task cancellable is set.
+// Search with the published search flags.
 // -----------------------------------------------------------------------------
 std::vector<PackageRow>
 dnf_backend_search_package_rows_interruptible(const std::string &pattern, GCancellable *cancellable)
 {
-  const DnfBackendSearchOptions search_options = dnf_backend_get_search_options();
+  return dnf_backend_search_package_rows_interruptible(pattern, dnf_backend_get_search_options(), cancellable);
+}
 
-  auto [base, guard, generation] = BaseManager::instance().acquire_read();
-  auto available_rows = collect_available_rows_by_name_arch(base, cancellable, search_options, &pattern);
+// -----------------------------------------------------------------------------
+// Search merged repo and installed-only package rows and stop early when the
+// task cancellable is set. Matching runs over the per-generation package
+// index and its trigram postings, so repeat searches do not rescan the
+// libdnf5 package sack or casefold descriptions again.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+dnf_backend_search_package_rows_interruptible(const std::string &pattern,
+                                              const DnfBackendSearchOptions &search_options,
+                                              GCancellable *cancellable)
+{
+  DNFUI_TRACE_SPAN("query", "search", pattern);
+  std::vector<VisibleIndexEntry> visible;
+  auto index = search_visible_entries(pattern, search_options, cancellable, visible);
+  if (!index) {
+    return {};
+  }
+
+  return rows_from_visible_entries(visible);
+}
+
+// -----------------------------------------------------------------------------
+// Rank with the published search flags.
+// -----------------------------------------------------------------------------
+PackageSearchPage
+dnf_backend_search_package_rows_ranked(const std::string &pattern,
+                                       size_t offset,
+                                       size_t limit,
+                                       GCancellable *cancellable)
+{
+  return dnf_backend_search_package_rows_ranked(pattern, dnf_backend_get_search_options(), offset, limit, cancellable);
+}
+
+// -----------------------------------------------------------------------------
+// Return one page of ranked search results from the package index. Matching
+// is the same as the unranked search; ranking keeps only the best
+// offset + limit entries, so broad terms do not copy or sort every match.
+// -----------------------------------------------------------------------------
+PackageSearchPage
+dnf_backend_search_package_rows_ranked(const std::string &pattern,
+                                       const DnfBackendSearchOptions &search_options,
+                                       size_t offset,
+                                       size_t limit,
+                                       GCancellable *cancellable)
+{
+  DNFUI_TRACE_SPAN("query", "ranked search", pattern);
+  PackageSearchPage page;
+  page.offset = offset;
+
+  std::shared_ptr<const PackageIndex> index;
+  const std::string pattern_lower = utf8_casefold_copy(pattern);
+  std::vector<const PackageIndexEntry *> available_matches;
+  std::vector<const PackageIndexEntry *> installed_matches;
+  if (search_options.search_in_files) {
+    if (!search_file_owners(pattern, search_options, cancellable, index, available_matches, installed_matches)) {
+      return page;
+    }
+  } else {
+    index = current_package_index(cancellable, &search_options);
+    if (!index || package_query_cancelled(cancellable)) {
+      return page;
+    }
+    require_indexed_repo_rows(*index);
+
+    if (!search_package_index(
+            *index, pattern_lower, search_options, cancellable, available_matches, installed_matches)) {
+      return page;
+    }
+  }
+
+  std::vector<VisibleIndexEntry> visible = visible_entries_from_index_matches(available_matches, installed_matches);
   if (package_query_cancelled(cancellable)) {
+    return page;
+  }
+
+  page.total_matches = visible.size();
+  page.rows = ranked_rows_from_visible_entries(visible, pattern_lower, offset, limit);
+  return page;
+}
+
+// -----------------------------------------------------------------------------
+// Match only the index entries of the given names. Rows are merged per name
+// and architecture, so restricting both entry lists to whole names gives the
+// same rows for those names as the full search.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+dnf_backend_search_package_rows_for_names(const std::string &pattern,
+                                          const DnfBackendSearchOptions &options,
+                                          const std::set<std::string> &names,
+                                          GCancellable *cancellable)
+{
+  DNFUI_TRACE_SPAN("query", "search names", pattern);
+  if (names.empty()) {
     return {};
   }
 
-  InstalledQueryResult installed = collect_installed_rows(base, cancellable, search_options, &pattern);
+  if (options.search_in_files) {
+    std::shared_ptr<const PackageIndex> index;
+    std::vector<const PackageIndexEntry *> available_matches;
+    std::vector<const PackageIndexEntry *> installed_matches;
+    if (!search_file_owners(pattern, options, cancellable, index, available_matches, installed_matches)) {
+      return {};
+    }
+    auto outside_names = [&names](const PackageIndexEntry *entry) { return names.count(entry->row.name.str()) == 0; };
+    std::erase_if(available_matches, outside_names);
+    std::erase_if(installed_matches, outside_names);
+    return visible_rows_from_index_matches(available_matches, installed_matches);
+  }
+
+  auto index = current_package_index(cancellable, &options);
+  if (!index || package_query_cancelled(cancellable)) {
+    return {};
+  }
+  require_indexed_repo_rows(*index);
+
+  const std::string pattern_lower = utf8_casefold_copy(pattern);
+  auto collect = [&](const std::vector<PackageIndexEntry> &entries, std::vector<const PackageIndexEntry *> &matches) {
+    for (const auto &entry : entries) {
+      if (names.count(entry.row.name.str()) > 0 && package_index_entry_matches(entry, pattern_lower, options)) {
+        matches.push_back(&entry);
+      }
+    }
+  };
+
+  std::vector<const PackageIndexEntry *> available_matches;
+  std::vector<const PackageIndexEntry *> installed_matches;
+  collect(index->available, available_matches);
+  collect(index->installed, installed_matches);
   if (package_query_cancelled(cancellable)) {
     return {};
   }
 
-  return visible_rows_from_maps(std::move(available_rows), std::move(installed.rows_by_name_arch));
+  return visible_rows_from_index_matches(available_matches, installed_matches);
 }
 
 // -----------------------------------------------------------------------------
-// Query installed packages via libdnf5 and return structured rows in one pass.
-// The exact-NEVRA cache is updated only after a complete uncancelled scan, so a
-// cancelled worker cannot publish a partial installed snapshot.
-//
-// Thread-safety:
-//   The Base read lock and g_installed_mutex must never be held at the same
-//   time. Rows are collected while the Base lock is held, then the lock is
-//   released before publish_installed_snapshot acquires g_installed_mutex.
+// Copy the installed index rows together with the generation they belong to.
+// The generation comes from the same read lock as the index, so callers can
+// tell whether a rebuild happened between two calls.
 // -----------------------------------------------------------------------------
-std::vector<PackageRow>
-dnf_backend_get_installed_package_rows_interruptible(GCancellable *cancellable)
+bool
+dnf_backend_get_indexed_installed_rows(bool build_if_missing,
+                                       GCancellable *cancellable,
+                                       uint64_t &generation_out,
+                                       std::vector<PackageRow> &rows_out)
 {
-  InstalledQueryResult installed;
-  std::set<std::string> protected_names;
+  std::shared_ptr<const PackageIndex> index;
   {
     auto [base, guard, generation] = BaseManager::instance().acquire_read();
-    const DnfBackendSearchOptions search_options {};
-    installed = collect_installed_rows(base, cancellable, search_options);
-    if (package_query_cancelled(cancellable)) {
-      return {};
-    }
+    generation_out = generation;
+    index = build_if_missing ? acquire_package_index(base, generation, cancellable)
+                             : find_package_index(base, generation);
+  }
+  if (!index || package_query_cancelled(cancellable)) {
+    return false;
+  }
 
-    annotate_installed_rows_with_repo_candidates_best_effort(
-        installed.rows, cancellable, [&base](GCancellable *annotation_cancellable) {
-          const DnfBackendSearchOptions annotation_search_options {};
-          return collect_available_rows_by_name_arch(base, annotation_cancellable, annotation_search_options);
-        });
-    protected_names = collect_self_protected_package_names(base);
+  rows_out.clear();
+  rows_out.reserve(index->installed.size());
+  for (const auto &entry : index->installed) {
+    rows_out.push_back(entry.row);
   }
+  return true;
+}
 
-  // Publish the new installed-package cache only after a complete uncancelled scan.
-  publish_installed_snapshot(installed, protected_names);
-  return installed.rows;
+// -----------------------------------------------------------------------------
+// Copy the available index rows like the installed ones above. An index whose
+// repo scan failed has no usable available rows, so it reports false too.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_get_indexed_available_rows(bool build_if_missing,
+                                       GCancellable *cancellable,
+                                       uint64_t &generation_out,
+                                       std::vector<PackageRow> &rows_out)
+{
+  std::shared_ptr<const PackageIndex> index;
+  {
+    auto [base, guard, generation] = BaseManager::instance().acquire_read();
+    generation_out = generation;
+    index = build_if_missing ? acquire_package_index(base, generation, cancellable)
+                             : find_package_index(base, generation);
+  }
+  if (!index || !index->available_error.empty() || package_query_cancelled(cancellable)) {
+    return false;
+  }
+
+  rows_out.clear();
+  rows_out.reserve(index->available.size());
+  for (const auto &entry : index->available) {
+    rows_out.push_back(entry.row);
+  }
+  return true;
 }
 
 // -----------------------------------------------------------------------------
-// Query the combined browse view via libdnf5. The returned rows include the
-// newest available candidate for each package stream plus installed-only local
-// RPMs that are missing from enabled repositories.
+// Return the package index for an installed listing after publishing its
+// installed snapshot. The exact-NEVRA cache is updated only after a complete
+// uncancelled index build, so a cancelled worker cannot publish a partial
+// installed snapshot. Returns null when cancelled.
+//
+// Thread-safety:
+//   The index is acquired under the Base lock, then the lock is released
+//   before publish_installed_snapshot builds and publishes the snapshot.
 // -----------------------------------------------------------------------------
-std::vector<PackageRow>
-dnf_backend_get_browse_package_rows_interruptible(GCancellable *cancellable)
+static std::shared_ptr<const PackageIndex>
+installed_listing_index(GCancellable *cancellable)
 {
-  const DnfBackendSearchOptions search_options {};
+  auto index = current_package_index(cancellable);
+  if (!index || package_query_cancelled(cancellable)) {
+    return nullptr;
+  }
 
-  auto [base, guard, generation] = BaseManager::instance().acquire_read();
-  auto available_rows = collect_available_rows_by_name_arch(base, cancellable, search_options);
-  if (package_query_cancelled(cancellable)) {
+  // The snapshot only keeps the NEVRA set and the newest row per tuple, so the
+  // listed rows are not copied into it.
+  InstalledQueryResult installed;
+  installed.nevras = index->installed_nevras;
+  installed.rows_by_name_arch = index->installed_rows_by_name_arch;
+  publish_installed_snapshot(std::move(installed), index->self_protected_names);
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+// Return installed packages from the per-generation package index. The rows
+// are already annotated with repo provenance when repo data was available.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+dnf_backend_get_installed_package_rows_interruptible(GCancellable *cancellable)
+{
+  DNFUI_TRACE_SPAN("query", "list installed");
+  auto index = installed_listing_index(cancellable);
+  if (!index) {
     return {};
   }
 
-  InstalledQueryResult installed = collect_installed_rows(base, cancellable, search_options);
+  std::vector<PackageRow> rows;
+  rows.reserve(index->installed.size());
+  for (const auto &entry : index->installed) {
+    rows.push_back(entry.row);
+  }
+  return rows;
+}
+
+// -----------------------------------------------------------------------------
+// Merge the whole package index into the browse view entries. Returns the
+// index that keeps the entries alive, or null when cancelled.
+// -----------------------------------------------------------------------------
+static std::shared_ptr<const PackageIndex>
+browse_visible_entries(GCancellable *cancellable, std::vector<VisibleIndexEntry> &visible)
+{
+  auto index = current_package_index(cancellable);
+  if (!index || package_query_cancelled(cancellable)) {
+    return nullptr;
+  }
+  require_indexed_repo_rows(*index);
+
+  std::vector<const PackageIndexEntry *> available_entries;
+  available_entries.reserve(index->available.size());
+  for (const auto &entry : index->available) {
+    available_entries.push_back(&entry);
+  }
+
+  std::vector<const PackageIndexEntry *> installed_entries;
+  installed_entries.reserve(index->installed.size());
+  for (const auto &entry : index->installed) {
+    installed_entries.push_back(&entry);
+  }
   if (package_query_cancelled(cancellable)) {
+    return nullptr;
+  }
+
+  visible = visible_entries_from_index_matches(available_entries, installed_entries);
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+// Return the combined browse view from the per-generation package index. The
+// returned rows include the newest available candidate for each package
+// stream plus installed-only local RPMs that are missing from enabled
+// repositories.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+dnf_backend_get_browse_package_rows_interruptible(GCancellable *cancellable)
+{
+  DNFUI_TRACE_SPAN("query", "browse");
+  std::vector<VisibleIndexEntry> visible;
+  auto index = browse_visible_entries(cancellable, visible);
+  if (!index) {
     return {};
   }
 
-  return visible_rows_from_maps(std::move(available_rows), std::move(installed.rows_by_name_arch));
+  return rows_from_visible_entries(visible);
 }
 
 // -----------------------------------------------------------------------------
-// Query available repo packages that are upgrades to installed packages.
+// Return the package index for an upgradeable listing, or null when cancelled.
+// -----------------------------------------------------------------------------
+static std::shared_ptr<const PackageIndex>
+upgradeable_listing_index(GCancellable *cancellable)
+{
+  auto index = current_package_index(cancellable);
+  if (!index || package_query_cancelled(cancellable)) {
+    return nullptr;
+  }
+  require_indexed_repo_rows(*index);
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+// Return available repo packages that are upgrades to installed packages.
 // The returned rows are the available update candidates so selecting one shows
 // the version that would be installed by an upgrade transaction.
 // -----------------------------------------------------------------------------
 std::vector<PackageRow>
 dnf_backend_get_upgradeable_package_rows_interruptible(GCancellable *cancellable)
 {
-  auto [base, guard, generation] = BaseManager::instance().acquire_read();
+  DNFUI_TRACE_SPAN("query", "list upgradeable");
+  auto index = upgradeable_listing_index(cancellable);
+  if (!index) {
+    return {};
+  }
 
-  libdnf5::rpm::PackageQuery query(base);
-  query.filter_available();
-  query.filter_upgrades();
-  query.filter_latest_evr();
+  return index->upgradeable;
+}
 
-  std::map<std::string, PackageRow> rows_by_name_arch;
-  for (auto pkg : query) {
+// Rows per batch passed to streaming query callbacks. Large enough to keep the
+// per-batch GTK overhead small, small enough that the first rows show up
+// without waiting for the whole result to be appended.
+static constexpr size_t kStreamBatchRows = 500;
+
+// -----------------------------------------------------------------------------
+// Build count rows with row_at and hand them to on_batch in consecutive
+// batches of up to kStreamBatchRows rows. Each batch is moved out as soon as
+// it is full, so the first rows reach the caller while the rest are still
+// being copied out of the index. Stops between batches once the task
+// cancellable is set. Returns the number of rows handed to on_batch, or count
+// when there is no callback.
+// -----------------------------------------------------------------------------
+static size_t
+stream_package_row_batches(size_t count,
+                           const std::function<PackageRow(size_t)> &row_at,
+                           GCancellable *cancellable,
+                           const PackageRowBatchCallback &on_batch)
+{
+  if (!on_batch) {
+    return count;
+  }
+
+  size_t streamed = 0;
+  for (size_t begin = 0; begin < count; begin += kStreamBatchRows) {
     if (package_query_cancelled(cancellable)) {
-      rows_by_name_arch.clear();
-      break;
+      return streamed;
     }
 
-    PackageRow row = make_package_row(pkg, PackageRepoCandidateRelation::UNKNOWN);
-    remember_newest_row(rows_by_name_arch, row);
+    const size_t end = std::min(count, begin + kStreamBatchRows);
+    std::vector<PackageRow> batch;
+    batch.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+      batch.push_back(row_at(i));
+    }
+    streamed += batch.size();
+    on_batch(std::move(batch));
   }
+  return streamed;
+}
 
-  std::vector<PackageRow> rows;
-  rows.reserve(rows_by_name_arch.size());
-  for (auto &[key, row] : rows_by_name_arch) {
-    rows.push_back(row);
+// -----------------------------------------------------------------------------
+// Stream installed packages to on_batch.
+// -----------------------------------------------------------------------------
+size_t
+dnf_backend_get_installed_package_rows_streaming(GCancellable *cancellable, const PackageRowBatchCallback &on_batch)
+{
+  DNFUI_TRACE_SPAN("query", "list installed");
+  auto index = installed_listing_index(cancellable);
+  if (!index) {
+    return 0;
   }
 
-  return rows;
+  const auto &entries = index->installed;
+  return stream_package_row_batches(
+      entries.size(), [&entries](size_t i) { return entries[i].row; }, cancellable, on_batch);
+}
+
+// -----------------------------------------------------------------------------
+// Stream the combined browse view to on_batch.
+// -----------------------------------------------------------------------------
+size_t
+dnf_backend_get_browse_package_rows_streaming(GCancellable *cancellable, const PackageRowBatchCallback &on_batch)
+{
+  DNFUI_TRACE_SPAN("query", "browse");
+  std::vector<VisibleIndexEntry> visible;
+  auto index = browse_visible_entries(cancellable, visible);
+  if (!index) {
+    return 0;
+  }
+
+  return stream_package_row_batches(
+      visible.size(), [&visible](size_t i) { return visible_entry_row(visible[i]); }, cancellable, on_batch);
 }
 
 // -----------------------------------------------------------------------------
-// Return installed package rows that exactly match one NEVRA. Repo provenance is
-// annotated when repository data is available so pending-action navigation can still show
-// local-only or newer-than-repo status when possible.
+// Stream upgrade candidates to on_batch.
+// -----------------------------------------------------------------------------
+size_t
+dnf_backend_get_upgradeable_package_rows_streaming(GCancellable *cancellable, const PackageRowBatchCallback &on_batch)
+{
+  DNFUI_TRACE_SPAN("query", "list upgradeable");
+  auto index = upgradeable_listing_index(cancellable);
+  if (!index) {
+    return 0;
+  }
+
+  const auto &rows = index->upgradeable;
+  return stream_package_row_batches(rows.size(), [&rows](size_t i) { return rows[i]; }, cancellable, on_batch);
+}
+
+// -----------------------------------------------------------------------------
+// Stream search results for pattern to on_batch.
+// -----------------------------------------------------------------------------
+size_t
+dnf_backend_search_package_rows_streaming(const std::string &pattern,
+                                          GCancellable *cancellable,
+                                          const PackageRowBatchCallback &on_batch)
+{
+  DNFUI_TRACE_SPAN("query", "search", pattern);
+  std::vector<VisibleIndexEntry> visible;
+  auto index = search_visible_entries(pattern, dnf_backend_get_search_options(), cancellable, visible);
+  if (!index) {
+    return 0;
+  }
+
+  return stream_package_row_batches(
+      visible.size(), [&visible](size_t i) { return visible_entry_row(visible[i]); }, cancellable, on_batch);
+}
+
+// -----------------------------------------------------------------------------
+// Build the package index for the current Base generation ahead of the first
+// interactive query, and save it for the next launch. Cancellation leaves
+// nothing published or written.
+// -----------------------------------------------------------------------------
+void
+dnf_backend_warm_package_index(GCancellable *cancellable)
+{
+  auto index = current_package_index(cancellable);
+  if (index && !package_query_cancelled(cancellable)) {
+    store_package_index_file(*index);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Map the package index saved by an earlier launch.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_open_package_index_file()
+{
+  return open_package_index_file();
+}
+
+// -----------------------------------------------------------------------------
+// Answer a browse or name search from the mapped package index file.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_query_package_index_file(const std::string &pattern,
+                                     const DnfBackendSearchOptions &search_options,
+                                     std::vector<PackageRow> &rows,
+                                     std::vector<PackageInstallState> &states)
+{
+  DNFUI_TRACE_SPAN("query", "index file query", pattern);
+  return query_package_index_file(pattern, search_options, rows, states);
+}
+
+// -----------------------------------------------------------------------------
+// Drop the mapped package index file.
+// -----------------------------------------------------------------------------
+void
+dnf_backend_close_package_index_file()
+{
+  close_package_index_file();
+}
+
+// -----------------------------------------------------------------------------
+// Drop the in-memory indexes built for the current Base generation.
+// -----------------------------------------------------------------------------
+void
+dnf_backend_release_package_indexes()
+{
+  reset_package_index();
+  reset_installed_reverse_deps();
+  reset_installed_file_index();
+}
+
+// -----------------------------------------------------------------------------
+// Return nevra without a zero epoch. libdnf5 prints NEVRAs without "0:" while
+// callers may pass it, and both spellings name the same package.
+// -----------------------------------------------------------------------------
+static std::string
+nevra_without_zero_epoch(const std::string &nevra)
+{
+  const size_t release_dash = nevra.rfind('-');
+  if (release_dash == std::string::npos || release_dash == 0) {
+    return nevra;
+  }
+
+  const size_t version_dash = nevra.rfind('-', release_dash - 1);
+  if (version_dash == std::string::npos || nevra.compare(version_dash + 1, 2, "0:") != 0) {
+    return nevra;
+  }
+
+  return nevra.substr(0, version_dash + 1) + nevra.substr(version_dash + 3);
+}
+
+// -----------------------------------------------------------------------------
+// Order rows by the position of their NEVRA in the requested list so callers
+// can map results back to their input regardless of libdnf5 query order. Rows
+// whose NEVRA is not in the list keep their relative order at the end.
+// -----------------------------------------------------------------------------
+static void
+sort_rows_by_requested_nevra(std::vector<PackageRow> &rows, const std::vector<std::string> &pkg_nevras)
+{
+  std::map<std::string, size_t> positions;
+  for (size_t i = 0; i < pkg_nevras.size(); ++i) {
+    positions.emplace(nevra_without_zero_epoch(pkg_nevras[i]), i);
+  }
+
+  auto position_of = [&positions, unmatched = pkg_nevras.size()](const PackageRow &row) {
+    auto it = positions.find(nevra_without_zero_epoch(row.nevra.str()));
+    return it == positions.end() ? unmatched : it->second;
+  };
+  std::stable_sort(rows.begin(), rows.end(), [&position_of](const PackageRow &lhs, const PackageRow &rhs) {
+    return position_of(lhs) < position_of(rhs);
+  });
+}
+
+// -----------------------------------------------------------------------------
+// Collect the newest visible repo candidate for each name and architecture
+// tuple of the given package names. One name-scoped query covers every name,
+// so batched exact lookups do not load the entire available package set.
+// -----------------------------------------------------------------------------
+static std::map<std::string, PackageRow>
+collect_available_rows_for_names(libdnf5::Base &base, const std::vector<std::string> &names)
+{
+  std::map<std::string, PackageRow> rows_by_name_arch;
+  if (names.empty()) {
+    return rows_by_name_arch;
+  }
+
+  libdnf5::rpm::PackageQuery query(base);
+  query.filter_available();
+  query.filter_latest_evr();
+  query.filter_name(names, libdnf5::sack::QueryCmp::EQ);
+
+  for (auto pkg : query) {
+    remember_newest_row(rows_by_name_arch, make_package_row(pkg, PackageRepoCandidateRelation::UNKNOWN));
+  }
+
+  return rows_by_name_arch;
+}
+
+// -----------------------------------------------------------------------------
+// Return installed package rows that exactly match any of the given NEVRAs.
+// All NEVRAs are resolved in one query under one Base read lock, and repo
+// provenance is annotated from one shared candidate map: the published package
+// index when one exists for this generation, otherwise one name-scoped
+// available query. Annotation stays best-effort so pending-action navigation
+// still works from the local rpmdb when repository data is unavailable.
 // -----------------------------------------------------------------------------
 std::vector<PackageRow>
-dnf_backend_get_installed_package_rows_by_nevra(const std::string &pkg_nevra)
+dnf_backend_get_installed_package_rows_by_nevras(const std::vector<std::string> &pkg_nevras)
 {
   std::vector<PackageRow> packages;
+  if (pkg_nevras.empty()) {
+    return packages;
+  }
 
   auto [base, guard, generation] = BaseManager::instance().acquire_read();
   libdnf5::rpm::PackageQuery query(base);
-  query.filter_nevra(pkg_nevra);
+  query.filter_nevra(pkg_nevras);
   query.filter_installed();
 
   for (auto pkg : query) {
     packages.push_back(make_package_row(pkg));
   }
+  sort_rows_by_requested_nevra(packages, pkg_nevras);
+
+  // Reuse the repo candidates of an already built package index when one is
+  // published for this generation.
+  auto index = find_package_index(base, generation);
+  if (index && index->available_error.empty()) {
+    for (auto &row : packages) {
+      row.repo_candidate_relation = repo_candidate_relation_for(row, find_indexed_repo_candidate(*index, row));
+    }
+    return packages;
+  }
 
-  // Scope the annotation query to the package name so we load only the one
-  // relevant name and architecture entry instead of the entire available package set.
-  const std::string annotation_pattern = packages.empty() ? "" : packages[0].name;
+  // Scope the annotation query to the matched package names so we load only
+  // the relevant name and architecture entries instead of the entire available
+  // package set.
+  std::vector<std::string> annotation_names;
+  for (const auto &row : packages) {
+    if (std::find(annotation_names.begin(), annotation_names.end(), row.name.str()) == annotation_names.end()) {
+      annotation_names.push_back(row.name.str());
+    }
+  }
   annotate_installed_rows_with_repo_candidates_best_effort(
-      packages, nullptr, [&base, &annotation_pattern](GCancellable *annotation_cancellable) {
-        const DnfBackendSearchOptions search_options {};
-        return collect_available_rows_by_name_arch(
-            base, annotation_cancellable, search_options, annotation_pattern.empty() ? nullptr : &annotation_pattern);
+      packages, nullptr, [&base, &annotation_names](GCancellable *) {
+        return collect_available_rows_for_names(base, annotation_names);
       });
 
   return packages;
 }
 
+// -----------------------------------------------------------------------------
+// Return installed package rows that exactly match one NEVRA.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+dnf_backend_get_installed_package_rows_by_nevra(const std::string &pkg_nevra)
+{
+  return dnf_backend_get_installed_package_rows_by_nevras({ pkg_nevra });
+}
+
 #ifdef DNFUI_BUILD_TESTS
 // -----------------------------------------------------------------------------
 // Test-only hook that forces annotation failure and verifies rows retain
@@ -434,30 +965,44 @@ dnf_backend_testonly_annotation_fallback_leaves_rows_unknown(std::vector<Package
     return row.repo_candidate_relation == PackageRepoCandidateRelation::UNKNOWN;
   });
 }
+
 #endif
 
 // -----------------------------------------------------------------------------
-// Return available package rows that exactly match one NEVRA. This helper stays
-// repo-only and is used for install-side pending-action navigation and details
-// loading.
+// Return available package rows that exactly match any of the given NEVRAs in
+// one query under one Base read lock. This helper stays repo-only and is used
+// for install-side pending-action navigation and details loading.
 // -----------------------------------------------------------------------------
 std::vector<PackageRow>
-dnf_backend_get_available_package_rows_by_nevra(const std::string &pkg_nevra)
+dnf_backend_get_available_package_rows_by_nevras(const std::vector<std::string> &pkg_nevras)
 {
   std::vector<PackageRow> packages;
+  if (pkg_nevras.empty()) {
+    return packages;
+  }
 
   auto [base, guard, generation] = BaseManager::instance().acquire_read();
   libdnf5::rpm::PackageQuery query(base);
-  query.filter_nevra(pkg_nevra);
+  query.filter_nevra(pkg_nevras);
   query.filter_available();
 
   for (auto pkg : query) {
     packages.push_back(make_package_row(pkg));
   }
+  sort_rows_by_requested_nevra(packages, pkg_nevras);
 
   return packages;
 }
 
+// -----------------------------------------------------------------------------
+// Return available package rows that exactly match one NEVRA.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+dnf_backend_get_available_package_rows_by_nevra(const std::string &pkg_nevra)
+{
+  return dnf_backend_get_available_package_rows_by_nevras({ pkg_nevra });
+}
+
 // -----------------------------------------------------------------------------
 // EOF
 // -----------------------------------------------------------------------------
@@ -0,0 +1,172 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_reverse_deps.cpp
+// Per-generation installed reverse-dependency index
+//
+// Maps every installed package to the installed packages that require one of
+// its capabilities. The index is built once per BaseManager generation, so the
+// Dependencies tab answers "Required By" from a prepared list instead of
+// matching the provides of one package against every installed package.
+// -----------------------------------------------------------------------------
+#include "dnf_backend/dnf_internal.hpp"
+
+#include "base_manager.hpp"
+#include "debug_trace.hpp"
+#include "dnf_backend/dnf_generation_cache.hpp"
+#include "trace_spans.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gio/gio.h>
+
+#include <libdnf5/base/base.hpp>
+#include <libdnf5/rpm/package_query.hpp>
+
+namespace {
+
+// Last published reverse-dependency index.
+dnf_backend_internal::GenerationIndexCache<dnf_backend_internal::InstalledReverseDeps> g_reverse_deps;
+
+// -----------------------------------------------------------------------------
+// Build the index while the caller holds the Base read lock. Each distinct
+// requirement is resolved to its installed providers once, so a requirement
+// shared by most packages, such as a libc soname, costs one provides lookup.
+// Returns nullptr when cancelled.
+// -----------------------------------------------------------------------------
+std::shared_ptr<dnf_backend_internal::InstalledReverseDeps>
+build_reverse_deps(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable)
+{
+  auto index = std::make_shared<dnf_backend_internal::InstalledReverseDeps>();
+  index->generation = generation;
+  index->base = base.get_weak_ptr();
+
+  libdnf5::rpm::PackageQuery installed(base);
+  installed.filter_installed();
+
+  std::vector<libdnf5::rpm::Package> packages(installed.begin(), installed.end());
+  std::unordered_map<int, uint32_t> ids_by_solvable;
+  index->nevras.reserve(packages.size());
+  for (const auto &pkg : packages) {
+    ids_by_solvable.emplace(pkg.get_id().id, static_cast<uint32_t>(index->nevras.size()));
+    index->nevras_to_ids.emplace(pkg.get_nevra(), static_cast<uint32_t>(index->nevras.size()));
+    index->nevras.push_back(pkg.get_nevra());
+  }
+
+  index->required_by.resize(packages.size());
+  std::unordered_map<std::string, std::vector<uint32_t>> providers_by_requirement;
+  for (uint32_t dependent = 0; dependent < packages.size(); ++dependent) {
+    if (dnf_backend_internal::package_query_cancelled(cancellable)) {
+      return nullptr;
+    }
+
+    for (const auto &requirement : packages[dependent].get_requires()) {
+      auto [it, inserted] = providers_by_requirement.try_emplace(requirement.to_string());
+      if (inserted) {
+        libdnf5::rpm::PackageQuery providers(installed);
+        providers.filter_provides(requirement);
+        for (const auto &provider : providers) {
+          it->second.push_back(ids_by_solvable.at(provider.get_id().id));
+        }
+      }
+
+      for (uint32_t provider : it->second) {
+        if (provider != dependent) {
+          index->required_by[provider].push_back(dependent);
+        }
+      }
+    }
+  }
+
+  // Sort by NEVRA, matching the order the per-package query reported.
+  for (auto &dependents : index->required_by) {
+    std::sort(dependents.begin(), dependents.end(), [&index](uint32_t a, uint32_t b) {
+      return index->nevras[a] < index->nevras[b];
+    });
+    dependents.erase(std::unique(dependents.begin(), dependents.end()), dependents.end());
+    dependents.shrink_to_fit();
+  }
+
+  DNFUI_TRACE("Installed reverse-dependency index built generation=%llu installed=%zu requirements=%zu",
+              static_cast<unsigned long long>(generation),
+              index->nevras.size(),
+              providers_by_requirement.size());
+  return index;
+}
+
+} // namespace
+
+namespace dnf_backend_internal {
+
+// -----------------------------------------------------------------------------
+// Return the reverse-dependency index for the locked Base generation. The first
+// caller after a rebuild pays for the build; later callers reuse it. The caller
+// must hold the Base read lock for generation.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const InstalledReverseDeps>
+acquire_installed_reverse_deps(libdnf5::Base &base, uint64_t generation, GCancellable *cancellable)
+{
+  return g_reverse_deps.acquire(base, generation, [&]() { return build_reverse_deps(base, generation, cancellable); });
+}
+
+// -----------------------------------------------------------------------------
+// Look up one installed NEVRA and copy its dependents in NEVRA order.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+installed_required_by(const InstalledReverseDeps &index, const std::string &nevra)
+{
+  std::vector<std::string> dependents;
+  auto it = index.nevras_to_ids.find(nevra);
+  if (it == index.nevras_to_ids.end()) {
+    return dependents;
+  }
+
+  dependents.reserve(index.required_by[it->second].size());
+  for (uint32_t id : index.required_by[it->second]) {
+    dependents.push_back(index.nevras[id]);
+  }
+  return dependents;
+}
+
+// -----------------------------------------------------------------------------
+// Drop the published index. Readers that copied the pointer keep their copy.
+// -----------------------------------------------------------------------------
+void
+reset_installed_reverse_deps()
+{
+  g_reverse_deps.reset();
+}
+
+} // namespace dnf_backend_internal
+
+// -----------------------------------------------------------------------------
+// Build the reverse-dependency index for the current Base generation ahead of
+// the first Dependencies tab load. Cancellation leaves nothing published.
+// -----------------------------------------------------------------------------
+void
+dnf_backend_warm_installed_reverse_deps(GCancellable *cancellable)
+{
+  DNFUI_TRACE_SPAN("query", "build reverse dependencies");
+  auto [base, guard, generation] = BaseManager::instance().acquire_read();
+  dnf_backend_internal::acquire_installed_reverse_deps(base, generation, cancellable);
+}
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Test-only hook: return true when a reverse-dependency index is published for
+// the current Base generation, without building one.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_testonly_reverse_deps_is_current()
+{
+  auto [base, guard, generation] = BaseManager::instance().acquire_read();
+  return g_reverse_deps.find(base, generation) != nullptr;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,166 @@
+// -----------------------------------------------------------------------------
+// src/dnf_backend/dnf_scan.cpp
+// Sharded package scan helper
+//
+// Reads the fields of one libdnf5 package query on the calling thread, then
+// splits them into contiguous shards and converts each shard on its own worker
+// thread. libsolv pool access is not thread-safe, so workers never touch a
+// libdnf5 package. The caller merges the per-shard output in shard order, so
+// the merged result matches the single-threaded scan exactly. Parallel
+// scanning is opt-in; the default scan stays on the calling thread.
+// -----------------------------------------------------------------------------
+#include "dnf_backend/dnf_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <gio/gio.h>
+
+#include <libdnf5/rpm/package_query.hpp>
+
+namespace {
+
+// Requested worker count for cold package scans. Zero and one both mean the
+// default single-threaded scan.
+std::atomic<unsigned> g_scan_worker_count { 0 };
+
+// Upper bound for the requested worker count so a bad setting cannot start an
+// unbounded number of threads for one scan.
+constexpr unsigned kMaxScanWorkers = 32;
+
+// Shards smaller than this spend more time starting threads than converting
+// packages, so small queries stay single-threaded.
+constexpr size_t kMinPackagesPerShard = 2048;
+
+// -----------------------------------------------------------------------------
+// Return the number of shards one scan of package_count packages should use.
+// -----------------------------------------------------------------------------
+size_t
+package_scan_shard_count(size_t package_count)
+{
+  const size_t workers = g_scan_worker_count.load(std::memory_order_relaxed);
+  if (workers <= 1) {
+    return 1;
+  }
+
+  return std::clamp<size_t>(package_count / kMinPackagesPerShard, 1, workers);
+}
+
+} // namespace
+
+namespace dnf_backend_internal {
+
+// -----------------------------------------------------------------------------
+// Visit every package of one query, either on the calling thread or split into
+// contiguous shards on worker threads. prepare_shards receives the shard count
+// before any package is visited so the caller can size its per-shard output.
+// Each worker checks the task cancellable before every package and stops all
+// shards once one of them sees it. The first worker exception is rethrown on
+// the calling thread after all workers have joined. Returns false when the
+// scan was cancelled.
+// -----------------------------------------------------------------------------
+bool
+scan_packages_sharded(const libdnf5::rpm::PackageQuery &query,
+                      GCancellable *cancellable,
+                      bool with_descriptions,
+                      const std::function<void(size_t shard_count)> &prepare_shards,
+                      const PackageScanVisitor &visit)
+{
+  if (g_scan_worker_count.load(std::memory_order_relaxed) <= 1) {
+    prepare_shards(1);
+    for (auto pkg : query) {
+      if (package_query_cancelled(cancellable)) {
+        return false;
+      }
+      visit(0, read_scanned_package(pkg, with_descriptions));
+    }
+    return true;
+  }
+
+  // Copy the package fields out of the pool on this thread, which holds the
+  // Base read lock. Only the casefolding and row building run in parallel.
+  std::vector<ScannedPackage> packages;
+  for (auto pkg : query) {
+    if (package_query_cancelled(cancellable)) {
+      return false;
+    }
+    packages.push_back(read_scanned_package(pkg, with_descriptions));
+  }
+
+  const size_t shard_count = package_scan_shard_count(packages.size());
+  prepare_shards(shard_count);
+  if (shard_count <= 1) {
+    for (const auto &pkg : packages) {
+      if (package_query_cancelled(cancellable)) {
+        return false;
+      }
+      visit(0, pkg);
+    }
+    return true;
+  }
+
+  const size_t shard_size = (packages.size() + shard_count - 1) / shard_count;
+  std::atomic<bool> stop { false };
+  std::vector<std::exception_ptr> errors(shard_count);
+  std::vector<std::thread> workers;
+  workers.reserve(shard_count);
+
+  for (size_t shard = 0; shard < shard_count; ++shard) {
+    const size_t begin = std::min(packages.size(), shard * shard_size);
+    const size_t end = std::min(packages.size(), begin + shard_size);
+    workers.emplace_back([&, shard, begin, end]() {
+      try {
+        for (size_t i = begin; i < end; ++i) {
+          if (stop.load(std::memory_order_relaxed) || package_query_cancelled(cancellable)) {
+            stop.store(true, std::memory_order_relaxed);
+            return;
+          }
+          visit(shard, packages[i]);
+        }
+      } catch (...) {
+        errors[shard] = std::current_exception();
+        stop.store(true, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  for (const auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  return !stop.load(std::memory_order_relaxed);
+}
+
+} // namespace dnf_backend_internal
+
+// -----------------------------------------------------------------------------
+// Set how many worker threads cold package scans may use.
+// -----------------------------------------------------------------------------
+void
+dnf_backend_set_scan_worker_count(unsigned count)
+{
+  g_scan_worker_count.store(std::min(count, kMaxScanWorkers), std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Return the configured worker count for cold package scans.
+// -----------------------------------------------------------------------------
+unsigned
+dnf_backend_get_scan_worker_count()
+{
+  return g_scan_worker_count.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -13,29 +13,67 @@
 #include <atomic>
 #include <filesystem>
 #include <map>
-#include <mutex>
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <libdnf5/rpm/package_query.hpp>
 
+// Installed-package state published as one immutable value. Readers keep the
+// snapshot they loaded, so a refresh never changes it under them. Lookups hash
+// the row fields directly and build no keys.
+struct InstalledPackageSnapshot {
+  // NEVRAs of installed packages for UI highlighting.
+  std::unordered_set<std::string> nevras;
+  // Newest installed row of each architecture, grouped by package name, for
+  // upgrade-state classification.
+  std::unordered_map<std::string, std::vector<PackageRow>> rows_by_name;
+  // Installed package names that own the running GUI binary.
+  std::unordered_set<std::string> self_protected_names;
+};
+
 namespace {
 
-// Cached NEVRAs of installed packages for UI highlighting.
-std::set<std::string> g_installed_nevras;
-// Mutex for thread-safe access to the installed-package cache and derived state.
-std::mutex g_installed_mutex;
+// Published installed-package snapshot. Replaced as a whole by each refresh.
+std::atomic<InstalledPackageSnapshotPtr> g_installed_snapshot { std::make_shared<const InstalledPackageSnapshot>() };
 // Packed search flags read by query workers when they start a search. Keeping
 // both options in one atomic makes dnf_backend_get_search_options a single
 // coherent snapshot.
 constexpr unsigned kSearchInDescriptionBit = 1U << 0;
 constexpr unsigned kExactMatchBit = 1U << 1;
+constexpr unsigned kSearchInFilesBit = 1U << 2;
 std::atomic<unsigned> g_search_option_bits { 0 };
-// Cached installed rows keyed by name and arch for upgrade-state classification.
-std::map<std::string, PackageRow> g_installed_rows_by_name_arch;
-// Installed package names that own the running GUI binary.
-std::set<std::string> g_self_protected_package_names;
+
+// -----------------------------------------------------------------------------
+// Return the loaded snapshot.
+// -----------------------------------------------------------------------------
+InstalledPackageSnapshotPtr
+load_installed_snapshot()
+{
+  return g_installed_snapshot.load(std::memory_order_acquire);
+}
+
+// -----------------------------------------------------------------------------
+// Build a snapshot from the containers of one installed scan.
+// -----------------------------------------------------------------------------
+InstalledPackageSnapshotPtr
+make_installed_snapshot(const std::set<std::string> &nevras,
+                        const std::map<std::string, PackageRow> &rows_by_name_arch,
+                        const std::set<std::string> &protected_names)
+{
+  auto snapshot = std::make_shared<InstalledPackageSnapshot>();
+  snapshot->nevras.reserve(nevras.size());
+  snapshot->nevras.insert(nevras.begin(), nevras.end());
+  snapshot->rows_by_name.reserve(rows_by_name_arch.size());
+  for (const auto &[key, row] : rows_by_name_arch) {
+    snapshot->rows_by_name[row.name.str()].push_back(row);
+  }
+  snapshot->self_protected_names.insert(protected_names.begin(), protected_names.end());
+  return snapshot;
+}
 
 // -----------------------------------------------------------------------------
 // Resolve the current GUI executable path so the app can block self-removal
@@ -83,16 +121,14 @@ collect_self_protected_package_names(libdnf5::Base &base)
 
 // -----------------------------------------------------------------------------
 // Publish installed-package state only after callers have finished all libdnf
-// Base reads. Holding the Base lock while taking g_installed_mutex would make
-// future UI cache callers vulnerable to lock-order deadlocks.
+// Base reads, so building the hash tables never extends a Base lock. Readers
+// that loaded the previous snapshot keep using it until they load again.
 // -----------------------------------------------------------------------------
 void
 publish_installed_snapshot(InstalledQueryResult installed, std::set<std::string> protected_names)
 {
-  std::lock_guard<std::mutex> lock(g_installed_mutex);
-  g_installed_nevras.swap(installed.nevras);
-  g_installed_rows_by_name_arch.swap(installed.rows_by_name_arch);
-  g_self_protected_package_names.swap(protected_names);
+  g_installed_snapshot.store(make_installed_snapshot(installed.nevras, installed.rows_by_name_arch, protected_names),
+                             std::memory_order_release);
 }
 
 } // namespace dnf_backend_internal
@@ -112,6 +148,9 @@ dnf_backend_set_search_options(const DnfBackendSearchOptions &options)
   if (options.exact_match) {
     bits |= kExactMatchBit;
   }
+  if (options.search_in_files) {
+    bits |= kSearchInFilesBit;
+  }
   g_search_option_bits.store(bits, std::memory_order_relaxed);
 }
 
@@ -125,17 +164,27 @@ dnf_backend_get_search_options()
   return {
     .search_in_description = (bits & kSearchInDescriptionBit) != 0,
     .exact_match = (bits & kExactMatchBit) != 0,
+    .search_in_files = (bits & kSearchInFilesBit) != 0,
   };
 }
 
+// -----------------------------------------------------------------------------
+// Return the published snapshot. The store always holds one, so an empty
+// snapshot stands in until the first refresh.
+// -----------------------------------------------------------------------------
+InstalledPackageSnapshotPtr
+dnf_backend_get_installed_snapshot()
+{
+  return load_installed_snapshot();
+}
+
 // -----------------------------------------------------------------------------
 // Return true when the installed-package snapshot contains one exact NEVRA.
 // -----------------------------------------------------------------------------
 bool
 dnf_backend_installed_snapshot_contains(const std::string &nevra)
 {
-  std::lock_guard<std::mutex> lock(g_installed_mutex);
-  return g_installed_nevras.count(nevra) > 0;
+  return load_installed_snapshot()->nevras.count(nevra) > 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -144,19 +193,20 @@ dnf_backend_installed_snapshot_contains(const std::string &nevra)
 size_t
 dnf_backend_installed_snapshot_size()
 {
-  std::lock_guard<std::mutex> lock(g_installed_mutex);
-  return g_installed_nevras.size();
+  return load_installed_snapshot()->nevras.size();
 }
 
 // -----------------------------------------------------------------------------
 // Refresh the exact-installed and self-protection snapshots used by UI state
 // classification. This path is intentionally local-first: it does not require
-// repository metadata and should keep working from the rpmdb alone.
+// repository metadata and should keep working from the rpmdb alone. When the
+// package index for the current generation is already built, its installed
+// rows are published instead of scanning the rpmdb again.
 //
 // Thread-safety:
-//   The Base read lock and g_installed_mutex must never be held simultaneously.
 //   Installed rows are collected into local containers while the Base lock is
-//   held, then published after that lock has been released.
+//   held, then the snapshot is built and published after that lock has been
+//   released.
 // -----------------------------------------------------------------------------
 void
 dnf_backend_refresh_installed_nevras()
@@ -165,10 +215,16 @@ dnf_backend_refresh_installed_nevras()
   std::set<std::string> protected_names;
   {
     auto [base, guard, generation] = BaseManager::instance().acquire_read();
-    const DnfBackendSearchOptions search_options {};
-    installed = collect_installed_rows(base, nullptr, search_options);
-    protected_names = collect_self_protected_package_names(base);
-  } // Base read lock released before acquiring g_installed_mutex
+    // The package index already holds the rpmdb scan for this generation.
+    if (auto index = find_package_index(base, generation)) {
+      installed = installed_query_result_from_index(*index);
+      protected_names = index->self_protected_names;
+    } else {
+      const DnfBackendSearchOptions search_options {};
+      installed = collect_installed_rows(base, nullptr, search_options);
+      protected_names = collect_self_protected_package_names(base);
+    }
+  } // Base read lock released before the snapshot is built
 
   publish_installed_snapshot(installed, protected_names);
 }
@@ -192,8 +248,18 @@ dnf_backend_is_package_installed_exact(const PackageRow &row)
 PackageInstallState
 dnf_backend_get_package_install_state(const PackageRow &row)
 {
-  std::lock_guard<std::mutex> lock(g_installed_mutex);
-  if (g_installed_nevras.count(row.nevra) > 0) {
+  return dnf_backend_get_package_install_state(*load_installed_snapshot(), row);
+}
+
+// -----------------------------------------------------------------------------
+// Classify a row against one loaded snapshot. The exact NEVRA and the name are
+// hashed as they are; the architecture is matched among the few installed rows
+// of that name.
+// -----------------------------------------------------------------------------
+PackageInstallState
+dnf_backend_get_package_install_state(const InstalledPackageSnapshot &snapshot, const PackageRow &row)
+{
+  if (snapshot.nevras.count(row.nevra) > 0) {
     switch (row.repo_candidate_relation) {
     case PackageRepoCandidateRelation::UNKNOWN:
       // Annotation was not run or failed. The package is
@@ -213,16 +279,49 @@ dnf_backend_get_package_install_state(const PackageRow &row)
     }
   }
 
-  auto it = g_installed_rows_by_name_arch.find(row.name_arch_key());
-  if (it == g_installed_rows_by_name_arch.end()) {
+  auto it = snapshot.rows_by_name.find(row.name);
+  if (it == snapshot.rows_by_name.end()) {
     return PackageInstallState::AVAILABLE;
   }
 
-  if (libdnf5::rpm::evrcmp(row, it->second) > 0) {
-    return PackageInstallState::UPGRADEABLE;
+  for (const auto &installed : it->second) {
+    if (installed.arch == row.arch) {
+      if (libdnf5::rpm::evrcmp(row, installed) > 0) {
+        return PackageInstallState::UPGRADEABLE;
+      }
+      return PackageInstallState::INSTALLED_NEWER_THAN_REPO;
+    }
   }
 
-  return PackageInstallState::INSTALLED_NEWER_THAN_REPO;
+  return PackageInstallState::AVAILABLE;
+}
+
+// -----------------------------------------------------------------------------
+// Classify one row as the table and the action buttons need it. Every field
+// comes from the same snapshot.
+// -----------------------------------------------------------------------------
+PackageRowClassification
+dnf_backend_classify_package_row(const InstalledPackageSnapshot &snapshot, const PackageRow &row)
+{
+  PackageRowClassification result;
+  result.state = dnf_backend_get_package_install_state(snapshot, row);
+  result.installed_exact = snapshot.nevras.count(row.nevra) > 0;
+  result.self_protected = result.installed_exact && snapshot.self_protected_names.count(row.name) > 0;
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Classify every row of one result set against the same snapshot.
+// -----------------------------------------------------------------------------
+std::vector<PackageRowClassification>
+dnf_backend_classify_package_rows(const InstalledPackageSnapshot &snapshot, const std::vector<PackageRow> &rows)
+{
+  std::vector<PackageRowClassification> result;
+  result.reserve(rows.size());
+  for (const auto &row : rows) {
+    result.push_back(dnf_backend_classify_package_row(snapshot, row));
+  }
+  return result;
 }
 
 // -----------------------------------------------------------------------------
@@ -262,11 +361,39 @@ dnf_backend_can_reinstall_package(const PackageRow &row)
 
   auto [base, guard, generation] = BaseManager::instance().acquire_read();
   libdnf5::rpm::PackageQuery query(base);
-  query.filter_nevra(row.nevra);
+  query.filter_nevra(row.nevra.str());
   query.filter_available();
   return !query.empty();
 }
 
+// -----------------------------------------------------------------------------
+// Batched form of dnf_backend_can_reinstall_package for bulk marking. Rows the
+// snapshot does not list as installed are left out before the query runs.
+// -----------------------------------------------------------------------------
+std::set<std::string>
+dnf_backend_get_reinstallable_nevras(const InstalledPackageSnapshot &snapshot, const std::vector<PackageRow> &rows)
+{
+  std::set<std::string> reinstallable;
+  std::vector<std::string> installed;
+  for (const auto &row : rows) {
+    if (snapshot.nevras.count(row.nevra) > 0) {
+      installed.push_back(row.nevra);
+    }
+  }
+  if (installed.empty()) {
+    return reinstallable;
+  }
+
+  auto [base, guard, generation] = BaseManager::instance().acquire_read();
+  libdnf5::rpm::PackageQuery query(base);
+  query.filter_nevra(installed);
+  query.filter_available();
+  for (const auto &pkg : query) {
+    reinstallable.insert(pkg.get_nevra());
+  }
+  return reinstallable;
+}
+
 // -----------------------------------------------------------------------------
 // Check the cached self-protection snapshot collected from the owner of the
 // running GUI executable during the latest installed-package refresh.
@@ -274,8 +401,7 @@ dnf_backend_can_reinstall_package(const PackageRow &row)
 bool
 dnf_backend_is_package_self_protected(const PackageRow &row)
 {
-  std::lock_guard<std::mutex> lock(g_installed_mutex);
-  return g_self_protected_package_names.count(row.name) > 0;
+  return load_installed_snapshot()->self_protected_names.count(row.name) > 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -285,12 +411,8 @@ dnf_backend_is_package_self_protected(const PackageRow &row)
 bool
 dnf_backend_is_self_protected_transaction_spec(const std::string &spec)
 {
-  std::set<std::string> protected_names;
-  {
-    std::lock_guard<std::mutex> lock(g_installed_mutex);
-    protected_names = g_self_protected_package_names;
-  }
-
+  const InstalledPackageSnapshotPtr snapshot = load_installed_snapshot();
+  const std::unordered_set<std::string> &protected_names = snapshot->self_protected_names;
   if (protected_names.empty()) {
     return false;
   }
@@ -327,10 +449,7 @@ dnf_backend_is_self_protected_transaction_spec(const std::string &spec)
 void
 dnf_backend_testonly_clear_installed_snapshot()
 {
-  std::lock_guard<std::mutex> lock(g_installed_mutex);
-  g_installed_nevras.clear();
-  g_installed_rows_by_name_arch.clear();
-  g_self_protected_package_names.clear();
+  g_installed_snapshot.store(std::make_shared<const InstalledPackageSnapshot>(), std::memory_order_release);
 }
 
 // -----------------------------------------------------------------------------
@@ -340,10 +459,7 @@ dnf_backend_testonly_clear_installed_snapshot()
 void
 dnf_backend_testonly_replace_installed_snapshot(const std::set<std::string> &nevras)
 {
-  std::lock_guard<std::mutex> lock(g_installed_mutex);
-  g_installed_nevras = nevras;
-  g_installed_rows_by_name_arch.clear();
-  g_self_protected_package_names.clear();
+  g_installed_snapshot.store(make_installed_snapshot(nevras, {}, {}), std::memory_order_release);
 }
 #endif
 
@@ -10,10 +10,17 @@
 
 #include "base_manager.hpp"
 #include "debug_trace.hpp"
+#include "dnf_backend/dnf_download_progress.hpp"
+#include "dnf_backend/dnf_internal.hpp"
+#include "trace_spans.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -24,7 +31,9 @@
 #include <libdnf5/base/transaction.hpp>
 #include <libdnf5/base/transaction_package.hpp>
 #include <libdnf5/repo/download_callbacks.hpp>
+#include <libdnf5/repo/package_downloader.hpp>
 #include <libdnf5/rpm/package_query.hpp>
+#include <libdnf5/transaction/transaction_item_action.hpp>
 
 #ifdef DNFUI_BUILD_TESTS
 // -----------------------------------------------------------------------------
@@ -158,23 +167,31 @@ transaction_package_label(const libdnf5::base::TransactionPackage &item)
 }
 
 // libdnf5 download callbacks that stream package download progress to the UI.
+// Text lines report each package; the aggregate byte counts across all
+// parallel downloads go to download_cb at a bounded rate.
 class StreamingDownloadCallbacks final : public libdnf5::repo::DownloadCallbacks {
   public:
   // -----------------------------------------------------------------------------
-  // Store the callback used to report download progress.
+  // Store the callbacks used to report download progress. Downloads are
+  // aborted once cancel is set.
   // -----------------------------------------------------------------------------
-  explicit StreamingDownloadCallbacks(TransactionProgressCallback progress_cb)
+  explicit StreamingDownloadCallbacks(TransactionProgressCallback progress_cb,
+                                      TransactionDownloadProgressCallback download_cb = {},
+                                      const std::atomic<bool> *cancel = nullptr)
       : progress_cb(std::move(progress_cb))
+      , download_cb(std::move(download_cb))
+      , cancel(cancel)
   {
   }
 
   // -----------------------------------------------------------------------------
   // Start progress reporting for one package download.
   // -----------------------------------------------------------------------------
-  void *add_new_download(void *, const char *description, double) override
+  void *add_new_download(void *, const char *description, double total_to_download) override
   {
     auto *state = new DownloadState;
     state->description = description ? description : "package";
+    state->slot = totals.start(total_to_download, DownloadProgressAggregator::Clock::now());
     emit_progress_line(progress_cb, "Downloading: " + state->description);
     return state;
   }
@@ -184,11 +201,19 @@ class StreamingDownloadCallbacks final : public libdnf5::repo::DownloadCallbacks
   // -----------------------------------------------------------------------------
   int progress(void *user_cb_data, double total_to_download, double downloaded) override
   {
+    if (cancel && cancel->load()) {
+      return ABORT;
+    }
+
     auto *state = static_cast<DownloadState *>(user_cb_data);
     if (!state || total_to_download <= 0.0) {
       return OK;
     }
 
+    if (totals.update(state->slot, total_to_download, downloaded, DownloadProgressAggregator::Clock::now())) {
+      publish_totals();
+    }
+
     int percent = static_cast<int>((downloaded * 100.0) / total_to_download);
     percent = std::clamp(percent, 0, 100);
     int bucket = percent / 10;
@@ -210,6 +235,18 @@ class StreamingDownloadCallbacks final : public libdnf5::repo::DownloadCallbacks
     std::unique_ptr<DownloadState> state(static_cast<DownloadState *>(user_cb_data));
     std::string description = state ? state->description : "package";
 
+    if (state) {
+      DownloadOutcome outcome = DownloadOutcome::DOWNLOADED;
+      if (status == TransferStatus::ALREADYEXISTS) {
+        outcome = DownloadOutcome::ALREADY_PRESENT;
+      } else if (status == TransferStatus::ERROR) {
+        outcome = DownloadOutcome::FAILED;
+      }
+      if (totals.finish(state->slot, outcome, DownloadProgressAggregator::Clock::now())) {
+        publish_totals();
+      }
+    }
+
     switch (status) {
     case TransferStatus::SUCCESSFUL:
     case TransferStatus::ALREADYEXISTS:
@@ -227,13 +264,35 @@ class StreamingDownloadCallbacks final : public libdnf5::repo::DownloadCallbacks
     return OK;
   }
 
+  // -----------------------------------------------------------------------------
+  // Return the bytes transferred so far, excluding files already present.
+  // -----------------------------------------------------------------------------
+  uint64_t transferred_bytes() const
+  {
+    return totals.transferred_bytes();
+  }
+
   private:
   struct DownloadState {
     std::string description;
     int last_reported_bucket = -1;
+    size_t slot = 0;
   };
 
+  // -----------------------------------------------------------------------------
+  // Send the current aggregate byte counts to the observer.
+  // -----------------------------------------------------------------------------
+  void publish_totals()
+  {
+    if (download_cb) {
+      download_cb(totals.current());
+    }
+  }
+
   TransactionProgressCallback progress_cb;
+  TransactionDownloadProgressCallback download_cb;
+  const std::atomic<bool> *cancel = nullptr;
+  DownloadProgressAggregator totals;
 };
 
 // Reset Base download callbacks when leaving transaction apply scope.
@@ -279,9 +338,40 @@ add_remove_request(libdnf5::Base &base, libdnf5::Goal &goal, const std::string &
   goal.add_rpm_remove(spec);
 }
 
+// One preview resolution, bound to the Base it was resolved on. Previews
+// usually resolve on a BaseManager fork, which is then reclaimed for apply.
+// Otherwise the published Base pointer is compared along with the generation
+// so a test reset that restarts the counter cannot make a stale transaction
+// look current.
+struct ResolvedTransaction {
+  // Weak so a request that is never applied does not keep the fork's loaded
+  // metadata alive after its snapshot was replaced. fork_serial stays zero
+  // when the transaction was resolved on the published Base.
+  std::weak_ptr<BaseFork> fork;
+  uint64_t fork_serial = 0;
+  std::unique_ptr<libdnf5::base::Transaction> transaction;
+  const libdnf5::Base *base = nullptr;
+  uint64_t generation = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Return true and set error_out once the caller cancelled the transaction work.
+// -----------------------------------------------------------------------------
+static bool
+transaction_cancelled(const std::atomic<bool> *cancel, std::string &error_out)
+{
+  if (!cancel || !cancel->load()) {
+    return false;
+  }
+
+  error_out = "Transaction was cancelled.";
+  return true;
+}
+
 // -----------------------------------------------------------------------------
 // Resolve the transaction through one shared code path so preview and apply
-// use identical resolution logic.
+// use identical resolution logic. libdnf5 cannot interrupt a running solve,
+// so cancel is checked before it starts and its result is dropped afterwards.
 // -----------------------------------------------------------------------------
 static bool
 resolve_transaction_plan(libdnf5::Base &base,
@@ -291,10 +381,15 @@ resolve_transaction_plan(libdnf5::Base &base,
                          std::string &error_out,
                          const TransactionProgressCallback &progress_cb,
                          std::unique_ptr<libdnf5::base::Transaction> &transaction_out,
-                         bool upgrade_all)
+                         bool upgrade_all,
+                         const std::atomic<bool> *cancel)
 {
   transaction_out.reset();
 
+  if (transaction_cancelled(cancel, error_out)) {
+    return false;
+  }
+
   if (!upgrade_all && install_nevras.empty() && remove_nevras.empty() && reinstall_nevras.empty()) {
     error_out = "No packages specified in transaction.";
     return false;
@@ -332,7 +427,14 @@ resolve_transaction_plan(libdnf5::Base &base,
     goal.add_rpm_upgrade();
   }
 
+  if (transaction_cancelled(cancel, error_out)) {
+    return false;
+  }
+
   auto transaction = goal.resolve();
+  if (transaction_cancelled(cancel, error_out)) {
+    return false;
+  }
 
   auto goal_problem = transaction.get_problems();
   if (goal_problem != libdnf5::GoalProblem::NO_PROBLEM) {
@@ -372,41 +474,133 @@ resolve_transaction_plan(libdnf5::Base &base,
 
 // -----------------------------------------------------------------------------
 // Add one resolved transaction item to the confirmation preview model.
+// Replaced packages are not listed but still free their installed size.
 // -----------------------------------------------------------------------------
 static void
 append_preview_item(TransactionPreview &preview, const libdnf5::base::TransactionPackage &item)
 {
   using Action = libdnf5::base::TransactionPackage::Action;
 
-  const std::string label = transaction_package_label(item);
-  const long long install_size = static_cast<long long>(item.get_package().get_install_size());
+  const auto &pkg = item.get_package();
+  const long long install_size = static_cast<long long>(pkg.get_install_size());
 
+  TransactionPreviewItem preview_item;
   switch (item.get_action()) {
   case Action::INSTALL:
-    preview.install.push_back(label);
+    preview_item.action = TransactionPreviewAction::INSTALL;
     preview.disk_space_delta += install_size;
     break;
   case Action::UPGRADE:
-    preview.upgrade.push_back(label);
+    preview_item.action = TransactionPreviewAction::UPGRADE;
     preview.disk_space_delta += install_size;
     break;
   case Action::DOWNGRADE:
-    preview.downgrade.push_back(label);
+    preview_item.action = TransactionPreviewAction::DOWNGRADE;
     preview.disk_space_delta += install_size;
     break;
   case Action::REINSTALL:
-    preview.reinstall.push_back(label);
+    preview_item.action = TransactionPreviewAction::REINSTALL;
     break;
   case Action::REMOVE:
-    preview.remove.push_back(label);
+    preview_item.action = TransactionPreviewAction::REMOVE;
     preview.disk_space_delta -= install_size;
     break;
   case Action::REPLACED:
     preview.disk_space_delta -= install_size;
-    break;
+    return;
   default:
-    break;
+    return;
   }
+
+  preview_item.nevra = transaction_package_label(item);
+  preview_item.repo = pkg.get_repo_id();
+  if (preview_item.action != TransactionPreviewAction::REMOVE) {
+    preview_item.download_size = static_cast<uint64_t>(pkg.get_download_size());
+  }
+  preview_item.install_size = static_cast<uint64_t>(pkg.get_install_size());
+  preview_item.reason = dnf_backend_internal::package_install_reason_from_libdnf(item.get_reason());
+  preview.add_item(std::move(preview_item));
+}
+
+// -----------------------------------------------------------------------------
+// Resolve one request on the given Base, fill the preview, and keep the
+// transaction in resolved_out when the caller asked for it.
+// -----------------------------------------------------------------------------
+static bool
+resolve_preview_on_base(libdnf5::Base &base,
+                        const std::vector<std::string> &install_nevras,
+                        const std::vector<std::string> &remove_nevras,
+                        const std::vector<std::string> &reinstall_nevras,
+                        TransactionPreview &preview,
+                        std::string &error_out,
+                        const TransactionProgressCallback &progress_cb,
+                        bool upgrade_all,
+                        ResolvedTransactionPtr *resolved_out,
+                        const std::atomic<bool> *cancel)
+{
+  std::unique_ptr<libdnf5::base::Transaction> transaction;
+  if (!resolve_transaction_plan(base,
+                                install_nevras,
+                                remove_nevras,
+                                reinstall_nevras,
+                                error_out,
+                                progress_cb,
+                                transaction,
+                                upgrade_all,
+                                cancel)) {
+    DNFUI_TRACE("Transaction preview resolve failed: %s", error_out.c_str());
+    return false;
+  }
+
+  for (const auto &item : transaction->get_transaction_packages()) {
+    append_preview_item(preview, item);
+  }
+
+  DNFUI_TRACE("Transaction preview done items=%zu", transaction->get_transaction_packages_count());
+  if (resolved_out) {
+    auto resolved = std::make_shared<ResolvedTransaction>();
+    resolved->transaction = std::move(transaction);
+    resolved->base = &base;
+    *resolved_out = std::move(resolved);
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Resolve one request on a leased fork and bind the resolution to that lease,
+// so apply can reclaim the same fork later.
+// -----------------------------------------------------------------------------
+static bool
+resolve_preview_on_fork(BaseForkLease &fork,
+                        const std::vector<std::string> &install_nevras,
+                        const std::vector<std::string> &remove_nevras,
+                        const std::vector<std::string> &reinstall_nevras,
+                        TransactionPreview &preview,
+                        std::string &error_out,
+                        const TransactionProgressCallback &progress_cb,
+                        bool upgrade_all,
+                        ResolvedTransactionPtr *resolved_out,
+                        const std::atomic<bool> *cancel)
+{
+  DNFUI_TRACE("Transaction preview resolving on fork serial=%llu", static_cast<unsigned long long>(fork.serial()));
+  if (!resolve_preview_on_base(fork.base(),
+                               install_nevras,
+                               remove_nevras,
+                               reinstall_nevras,
+                               preview,
+                               error_out,
+                               progress_cb,
+                               upgrade_all,
+                               resolved_out,
+                               cancel)) {
+    return false;
+  }
+  if (resolved_out) {
+    (*resolved_out)->fork = fork.handle();
+    (*resolved_out)->fork_serial = fork.serial();
+    (*resolved_out)->generation = fork.snapshot_generation();
+  }
+  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -422,10 +616,16 @@ dnf_backend_preview_transaction(const std::vector<std::string> &install_nevras,
                                 TransactionPreview &preview,
                                 std::string &error_out,
                                 const TransactionProgressCallback &progress_cb,
-                                bool upgrade_all)
+                                bool upgrade_all,
+                                ResolvedTransactionPtr *resolved_out,
+                                const std::atomic<bool> *cancel)
 {
+  DNFUI_TRACE_SPAN("transaction", "preview");
   error_out.clear();
   preview = TransactionPreview();
+  if (resolved_out) {
+    resolved_out->reset();
+  }
 
   try {
     DNFUI_TRACE("Transaction preview start install=%zu remove=%zu reinstall=%zu upgrade_all=%d",
@@ -433,20 +633,39 @@ dnf_backend_preview_transaction(const std::vector<std::string> &install_nevras,
                 remove_nevras.size(),
                 reinstall_nevras.size(),
                 upgrade_all ? 1 : 0);
-    auto [base, guard] = BaseManager::instance().acquire_write();
-    std::unique_ptr<libdnf5::base::Transaction> transaction;
+    // Resolve on a private fork so concurrent previews use separate Bases and
+    // leave the published one to readers.
+    if (BaseForkLease fork = BaseManager::instance().acquire_fork()) {
+      return resolve_preview_on_fork(fork,
+                                     install_nevras,
+                                     remove_nevras,
+                                     reinstall_nevras,
+                                     preview,
+                                     error_out,
+                                     progress_cb,
+                                     upgrade_all,
+                                     resolved_out,
+                                     cancel);
+    }
 
-    if (!resolve_transaction_plan(
-            base, install_nevras, remove_nevras, reinstall_nevras, error_out, progress_cb, transaction, upgrade_all)) {
-      DNFUI_TRACE("Transaction preview resolve failed: %s", error_out.c_str());
+    auto [base, guard] = BaseManager::instance().acquire_write("dnf_backend_preview_transaction");
+    if (!resolve_preview_on_base(base,
+                                 install_nevras,
+                                 remove_nevras,
+                                 reinstall_nevras,
+                                 preview,
+                                 error_out,
+                                 progress_cb,
+                                 upgrade_all,
+                                 resolved_out,
+                                 cancel)) {
       return false;
     }
-
-    for (const auto &item : transaction->get_transaction_packages()) {
-      append_preview_item(preview, item);
+    if (resolved_out) {
+      // Generation bumps happen under the build lock the write guard holds, so
+      // this is the generation the transaction was resolved on.
+      (*resolved_out)->generation = BaseManager::instance().current_generation();
     }
-
-    DNFUI_TRACE("Transaction preview done items=%zu", transaction->get_transaction_packages_count());
     return true;
   } catch (const std::exception &e) {
     error_out = e.what();
@@ -455,6 +674,40 @@ dnf_backend_preview_transaction(const std::vector<std::string> &install_nevras,
   }
 }
 
+// -----------------------------------------------------------------------------
+// Resolve upgrade-all only when a fork of the published Base is idle. Unlike
+// dnf_backend_preview_transaction it never builds a fork under the build lock
+// and never falls back to the write lock, so background callers cannot hold
+// up a rebuild or an interactive preview.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_preview_upgrade_all_on_idle_fork(TransactionPreview &preview,
+                                             std::string &error_out,
+                                             ResolvedTransactionPtr *resolved_out,
+                                             const std::atomic<bool> *cancel)
+{
+  DNFUI_TRACE_SPAN("transaction", "preview");
+  error_out.clear();
+  preview = TransactionPreview();
+  if (resolved_out) {
+    resolved_out->reset();
+  }
+
+  try {
+    BaseForkLease fork = BaseManager::instance().acquire_idle_fork();
+    if (!fork) {
+      error_out = "No idle package base is available.";
+      DNFUI_TRACE("Transaction preview skipped: no idle fork");
+      return false;
+    }
+    return resolve_preview_on_fork(fork, {}, {}, {}, preview, error_out, {}, true, resolved_out, cancel);
+  } catch (const std::exception &e) {
+    error_out = e.what();
+    DNFUI_TRACE("Transaction preview failed: %s", e.what());
+    return false;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // Apply a resolved package transaction after the caller has completed any
 // required authorization. The transaction service enforces Polkit before
@@ -467,8 +720,12 @@ dnf_backend_apply_transaction(const std::vector<std::string> &install_nevras,
                               const std::vector<std::string> &reinstall_nevras,
                               std::string &error_out,
                               const TransactionProgressCallback &progress_cb,
-                              bool upgrade_all)
+                              bool upgrade_all,
+                              const ResolvedTransactionPtr &resolved,
+                              const TransactionDownloadProgressCallback &download_progress_cb,
+                              const std::atomic<bool> *cancel)
 {
+  DNFUI_TRACE_SPAN("transaction", "apply");
   error_out.clear();
 
   try {
@@ -478,13 +735,46 @@ dnf_backend_apply_transaction(const std::vector<std::string> &install_nevras,
                 reinstall_nevras.size(),
                 upgrade_all ? 1 : 0);
     // Exclusive access to shared libdnf Base for transactional changes.
-    auto [base, guard] = BaseManager::instance().acquire_write();
+    auto [base, guard] = BaseManager::instance().acquire_write("dnf_backend_apply_transaction");
+    // Declared before the transaction so a reclaimed fork outlives it.
+    BaseForkLease fork;
+    libdnf5::Base *run_base = &base;
     std::unique_ptr<libdnf5::base::Transaction> transaction;
 
-    if (!resolve_transaction_plan(
-            base, install_nevras, remove_nevras, reinstall_nevras, error_out, progress_cb, transaction, upgrade_all)) {
-      DNFUI_TRACE("Transaction apply resolve failed: %s", error_out.c_str());
-      return false;
+    if (resolved && resolved->transaction && resolved->generation == BaseManager::instance().current_generation()) {
+      if (auto resolved_fork = resolved->fork.lock()) {
+        fork = BaseManager::instance().reclaim_fork(resolved_fork, resolved->fork_serial);
+        if (fork) {
+          run_base = &fork.base();
+          transaction = std::move(resolved->transaction);
+        }
+      } else if (resolved->fork_serial == 0 && resolved->base == &base) {
+        transaction = std::move(resolved->transaction);
+      }
+    }
+
+    if (transaction) {
+      // Nothing was published since the preview and no other preview used the
+      // Base it resolved on, so resolving again would give the same result.
+      DNFUI_TRACE("Transaction apply reusing preview resolution generation=%llu",
+                  static_cast<unsigned long long>(resolved->generation));
+      emit_progress_line(progress_cb, "Using the dependency changes resolved for the preview.");
+    } else {
+      if (resolved) {
+        DNFUI_TRACE("Transaction apply re-resolving, Base or fork changed since preview");
+      }
+      if (!resolve_transaction_plan(base,
+                                    install_nevras,
+                                    remove_nevras,
+                                    reinstall_nevras,
+                                    error_out,
+                                    progress_cb,
+                                    transaction,
+                                    upgrade_all,
+                                    cancel)) {
+        DNFUI_TRACE("Transaction apply resolve failed: %s", error_out.c_str());
+        return false;
+      }
     }
 
     if (transaction->get_transaction_packages().empty()) {
@@ -502,13 +792,39 @@ dnf_backend_apply_transaction(const std::vector<std::string> &install_nevras,
                          transaction_action_label(item.get_action()) + ": " + transaction_package_label(item));
     }
 
-    base.set_download_callbacks(std::make_unique<StreamingDownloadCallbacks>(progress_cb));
-    DownloadCallbacksReset download_callbacks_reset(base);
+    auto download_callbacks = std::make_unique<StreamingDownloadCallbacks>(progress_cb, download_progress_cb, cancel);
+    StreamingDownloadCallbacks *downloads = download_callbacks.get();
+    run_base->set_download_callbacks(std::move(download_callbacks));
+    DownloadCallbacksReset download_callbacks_reset(*run_base);
     emit_progress_line(progress_cb, "Starting package downloads...");
     DNFUI_TRACE("Transaction download start");
-    transaction->download();
+    const auto download_start = std::chrono::steady_clock::now();
+    try {
+      transaction->download();
+    } catch (const std::exception &) {
+      // An aborted download throws, so report it as the cancellation it is.
+      if (!transaction_cancelled(cancel, error_out)) {
+        throw;
+      }
+      emit_progress_line(progress_cb, error_out);
+      return false;
+    }
+    const auto download_elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - download_start);
     DNFUI_TRACE("Transaction download done");
     emit_progress_line(progress_cb, "Package downloads finished.");
+    if (downloads->transferred_bytes() > 0) {
+      // The average rate helps spot slow mirrors after the fact.
+      emit_progress_line(progress_cb,
+                         download_progress_format_summary(downloads->transferred_bytes(), download_elapsed));
+    }
+
+    // Cancellation stops here at the latest. Once RPM starts changing the
+    // system, the transaction runs to the end.
+    if (transaction_cancelled(cancel, error_out)) {
+      emit_progress_line(progress_cb, error_out);
+      return false;
+    }
 
     DNFUI_TRACE("Transaction run start");
     auto run_result = transaction->run();
@@ -549,6 +865,105 @@ dnf_backend_apply_transaction(const std::vector<std::string> &install_nevras,
   }
 }
 
+// -----------------------------------------------------------------------------
+// Check a preview resolution against the published Base without applying it.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_resolved_transaction_is_current(const ResolvedTransactionPtr &resolved)
+{
+  if (!resolved || !resolved->transaction) {
+    return false;
+  }
+
+  if (resolved->fork_serial != 0) {
+    return resolved->generation == BaseManager::instance().current_generation() &&
+           BaseManager::instance().fork_is_current(resolved->fork.lock(), resolved->fork_serial);
+  }
+
+  auto read = BaseManager::instance().acquire_read();
+  return resolved->base == &read.base && resolved->generation == read.generation;
+}
+
+// -----------------------------------------------------------------------------
+// Download the inbound packages of a fork-resolved transaction while holding
+// that fork, the same set libdnf5 downloads in Transaction::download. The
+// fork is leased again for the download, so the resolution is moved to the
+// new lease afterwards and apply can still reclaim it. The fork fields of
+// resolved are only read and written under resolved_mutex.
+// -----------------------------------------------------------------------------
+bool
+dnf_backend_prefetch_transaction(const ResolvedTransactionPtr &resolved,
+                                 std::mutex &resolved_mutex,
+                                 std::string &error_out,
+                                 const TransactionProgressCallback &progress_cb,
+                                 const std::atomic<bool> &cancel,
+                                 const TransactionDownloadProgressCallback &download_progress_cb)
+{
+  DNFUI_TRACE_SPAN("transaction", "prefetch");
+  error_out.clear();
+
+  std::shared_ptr<BaseFork> resolved_fork;
+  uint64_t fork_serial = 0;
+  uint64_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(resolved_mutex);
+    if (!resolved || !resolved->transaction || resolved->fork_serial == 0) {
+      // Resolutions on the published Base would need the write lock apply uses.
+      error_out = "No preview resolution is available for prefetch.";
+      return false;
+    }
+    resolved_fork = resolved->fork.lock();
+    fork_serial = resolved->fork_serial;
+    generation = resolved->generation;
+  }
+
+  try {
+    BaseForkLease fork;
+    if (generation == BaseManager::instance().current_generation()) {
+      fork = BaseManager::instance().reclaim_fork(resolved_fork, fork_serial);
+    }
+    if (!fork) {
+      error_out = "The preview resolution is no longer current.";
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> lock(resolved_mutex);
+      resolved->fork_serial = fork.serial();
+    }
+
+    libdnf5::repo::PackageDownloader downloader(fork.base());
+    downloader.set_resume(true);
+    size_t count = 0;
+    for (const auto &item : resolved->transaction->get_transaction_packages()) {
+      if (libdnf5::transaction::transaction_item_action_is_inbound(item.get_action()) &&
+          item.get_package().get_repo()->get_type() != libdnf5::repo::Repo::Type::COMMANDLINE) {
+        downloader.add(item.get_package());
+        ++count;
+      }
+    }
+    if (count == 0) {
+      return true;
+    }
+
+    fork.base().set_download_callbacks(
+        std::make_unique<StreamingDownloadCallbacks>(progress_cb, download_progress_cb, &cancel));
+    DownloadCallbacksReset download_callbacks_reset(fork.base());
+    DNFUI_TRACE("Transaction prefetch start packages=%zu", count);
+    downloader.download();
+    DNFUI_TRACE("Transaction prefetch done");
+    if (cancel.load()) {
+      error_out = "Package prefetch was cancelled.";
+      return false;
+    }
+    return true;
+  } catch (const std::exception &e) {
+    // An aborted download throws too, so cancellation is reported the same way.
+    error_out = cancel.load() ? "Package prefetch was cancelled." : e.what();
+    DNFUI_TRACE("Transaction prefetch stopped: %s", e.what());
+    return false;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // EOF
 // -----------------------------------------------------------------------------
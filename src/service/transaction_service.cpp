@@ -14,15 +14,33 @@
 #include "service/transaction_service_dbus.hpp"
 #include "service/transaction_service_introspection.hpp"
 #include "service/transaction_service_preview_formatter.hpp"
+#include "service/transaction_service_preview_payload.hpp"
+#include "service/transaction_service_progress_batch.hpp"
+#include "service/transaction_service_query.hpp"
 #include "service/transaction_service_request_parser.hpp"
+#include "service/transaction_service_request_payload.hpp"
+#include "service/transaction_service_speculative_preview.hpp"
+#include "service/transaction_service_statistics.hpp"
 #include "transaction_request.hpp"
 
 #include <gio/gio.h>
+#include <gio/gunixfdlist.h>
 #include <glib-unix.h>
 #include <polkit/polkit.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -84,6 +102,42 @@ test_force_empty_upgrade_all_preview_requested(const TransactionRequest &request
   const char *force_empty = g_getenv("DNFUI_TEST_FORCE_EMPTY_UPGRADE_ALL_PREVIEW");
   return request.upgrade_all && force_empty && g_strcmp0(force_empty, "1") == 0;
 }
+
+// -----------------------------------------------------------------------------
+// In test builds, allow one package prefetch to announce that it has started
+// and hold until it is cancelled, then record that the cancel reached it. The
+// hold ends after ten seconds so a missed cancel cannot hang the service.
+// -----------------------------------------------------------------------------
+static void
+run_test_prefetch_hold_hook_if_requested(const std::atomic<bool> &cancel)
+{
+  const char *started_file = g_getenv("DNFUI_TEST_PREFETCH_STARTED_FILE");
+  const char *cancelled_file = g_getenv("DNFUI_TEST_PREFETCH_CANCELLED_FILE");
+  if (!started_file || !*started_file || !cancelled_file || !*cancelled_file) {
+    return;
+  }
+
+  g_file_set_contents(started_file, "", 0, nullptr);
+  for (int i = 0; i < 1000 && !cancel.load(); ++i) {
+    g_usleep(10 * 1000);
+  }
+  if (cancel.load()) {
+    g_file_set_contents(cancelled_file, "", 0, nullptr);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// In test builds, record that an idle exit check was put off because request
+// objects or work were still live.
+// -----------------------------------------------------------------------------
+static void
+run_test_idle_exit_deferred_hook_if_requested()
+{
+  const char *deferred_file = g_getenv("DNFUI_TEST_IDLE_EXIT_DEFERRED_FILE");
+  if (deferred_file && *deferred_file) {
+    g_file_set_contents(deferred_file, "", 0, nullptr);
+  }
+}
 #else
 // -----------------------------------------------------------------------------
 // Do nothing when preview failure injection is not compiled in.
@@ -109,6 +163,22 @@ test_force_empty_upgrade_all_preview_requested(const TransactionRequest &)
 {
   return false;
 }
+
+// -----------------------------------------------------------------------------
+// Do nothing when prefetch hold injection is not compiled in.
+// -----------------------------------------------------------------------------
+static void
+run_test_prefetch_hold_hook_if_requested(const std::atomic<bool> &)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Do nothing when idle exit reporting is not compiled in.
+// -----------------------------------------------------------------------------
+static void
+run_test_idle_exit_deferred_hook_if_requested()
+{
+}
 #endif
 
 } // namespace
@@ -123,7 +193,17 @@ constexpr const char *kTransactionInterface = kTransactionServiceRequestInterfac
 constexpr const char *kApplyActionId = "com.fedora.dnfui.apply-transactions";
 constexpr size_t kMaxLiveTransactionSessions = 32;
 constexpr size_t kMaxLiveTransactionSessionsPerClient = 8;
+// Live StartTransactionFd requests per client, which bounds the specs one
+// client can keep in the service.
+constexpr size_t kMaxLiveBulkSessionsPerClient = 1;
 constexpr unsigned kMaxPreviewWorkers = 2;
+// Read-only package queries running at once, across all clients.
+constexpr unsigned kMaxConcurrentQueries = 4;
+// Quiet time after the last request before the background upgrade-all preview.
+constexpr guint kSpeculativeUpgradeAllIdleSeconds = 10;
+// Longest wait between dropping the Base of an idle service and exiting. A
+// shorter idle timeout shortens it as well.
+constexpr guint kIdleExitGraceMs = 60 * 1000;
 
 // -----------------------------------------------------------------------------
 // Transaction service runtime state
@@ -144,10 +224,14 @@ struct TransactionSession {
   TransactionService *service = nullptr;
   guint registration_id = 0;
   std::string object_path;
-  // Protects preview, stage, success, details, and pending_apply_invocation.
+  // Protects preview, resolved, the fork fields of resolved, stage, success,
+  // details, and pending_apply_invocation.
   std::mutex state_mutex;
   TransactionRequest request;
   TransactionPreview preview;
+  // Transaction resolved by the preview. Apply runs it directly while the
+  // Base generation it was resolved on is still current.
+  ResolvedTransactionPtr resolved;
   std::atomic<bool> finished { false };
   std::atomic<bool> cancelled { false };
   std::atomic<bool> release_requested { false };
@@ -157,6 +241,44 @@ struct TransactionSession {
   GDBusMethodInvocation *pending_apply_invocation = nullptr;
   std::string owner_name;
   guint owner_watch_id = 0;
+  // Set for sessions started through StartTransactionFd, whatever their size.
+  bool bulk = false;
+  // Last queue position reported through Progress. Main loop only.
+  size_t reported_queue_position = 0;
+  // Start of the current preview or apply, for the per-stage latencies.
+  // Main loop only.
+  std::chrono::steady_clock::time_point work_started;
+  // When the preview entered preview_queue. Guarded by preview_queue_mutex.
+  std::chrono::steady_clock::time_point queued_at;
+  // Protects progress_batch, download_progress, download_progress_pending,
+  // progress_flush_source, and progress_closed.
+  std::mutex progress_mutex;
+  // Worker progress lines waiting for the next flush on the main loop.
+  TransactionProgressBatch progress_batch;
+  // Newest aggregate download progress waiting for the next flush.
+  TransactionDownloadProgress download_progress;
+  bool download_progress_pending = false;
+  // Pending flush timeout, or null when no flush is scheduled.
+  GSource *progress_flush_source = nullptr;
+  // Set once Finished was emitted so late worker lines are dropped.
+  bool progress_closed = false;
+  // Protects prefetch_running. prefetch_done is signalled when it drops.
+  std::mutex prefetch_mutex;
+  std::condition_variable prefetch_done;
+  // Set while the package prefetch thread holds the raw session pointer.
+  bool prefetch_running = false;
+  // Aborts the package prefetch. Set by Release, cancel, and shutdown.
+  std::atomic<bool> prefetch_cancel { false };
+};
+
+// -----------------------------------------------------------------------------
+// Rows of one listed view for the Base generation they were read from, shared
+// by every client that pages through the view.
+// -----------------------------------------------------------------------------
+struct ServiceQueryViewRows {
+  uint64_t generation = 0;
+  std::vector<PackageRow> rows;
+  std::vector<PackageInstallState> states;
 };
 
 struct TransactionService {
@@ -173,7 +295,44 @@ struct TransactionService {
   std::atomic<bool> shutting_down { false };
   bool keep_alive_until_exit = false;
   std::map<std::string, std::unique_ptr<TransactionSession>> transactions;
+  // Persistent preview workers. Each queued session pushes one pool job, and a
+  // job runs whichever session is at the front of preview_queue, so sessions
+  // removed from the queue leave a job behind that finds nothing to do.
+  GThreadPool *preview_pool = nullptr;
+  // Protects preview_queue. Sessions in it have not touched the Base yet.
+  std::mutex preview_queue_mutex;
+  std::deque<TransactionSession *> preview_queue;
+  // Number of pool workers currently running a preview.
   std::atomic<unsigned> preview_workers { 0 };
+  // Set while a Warmup call is loading the package base.
+  std::atomic<bool> warmup_running { false };
+  // Resolve upgrade-all in the background while no request is active.
+  bool speculative_upgrade_all = false;
+  // Download the packages of ready previews before Apply is called.
+  bool prefetch_packages = false;
+  // Pending idle timeout for the background preview. Main loop only.
+  guint speculation_timer_id = 0;
+  // Set while the background upgrade-all preview is resolving.
+  std::atomic<bool> speculation_running { false };
+  // Set when a request arrived while the background preview was resolving, so
+  // its result is dropped instead of cached.
+  std::atomic<bool> speculation_cancel { false };
+  SpeculativeUpgradeAllPreview speculative_upgrade_all_preview;
+  // Number of read-only package queries running on their own threads.
+  std::atomic<unsigned> queries_running { 0 };
+  // Protects query_views.
+  std::mutex query_views_mutex;
+  // Last listed rows per TransactionServicePackageView.
+  std::array<std::shared_ptr<const ServiceQueryViewRows>, 3> query_views;
+  // Latency histograms reported by GetStatistics.
+  TransactionServiceStatistics statistics;
+  // Milliseconds without requests before the service exits, or 0 to keep
+  // running.
+  unsigned idle_exit_ms = 0;
+  // Pending idle exit check. Main loop only.
+  guint idle_exit_timer_id = 0;
+  // Set once the idle service dropped its Base, so the next check exits.
+  bool idle_memory_released = false;
 };
 
 // -----------------------------------------------------------------------------
@@ -210,13 +369,26 @@ static bool transaction_apply_should_stop_before_work(TransactionSession *sessio
 static bool transaction_request_needs_available_repos(const TransactionRequest &request);
 
 // -----------------------------------------------------------------------------
-// Main loop dispatch helpers
+// Background upgrade-all preview helpers
 // -----------------------------------------------------------------------------
-struct QueuedProgressMessage {
-  TransactionSession *session = nullptr;
-  std::string line;
-};
+static void schedule_speculative_upgrade_all(TransactionService *service);
+static void interrupt_speculative_upgrade_all(TransactionService *service);
+
+// -----------------------------------------------------------------------------
+// Idle exit helpers
+// -----------------------------------------------------------------------------
+static void note_service_activity(TransactionService *service);
+static gboolean on_idle_exit_timeout(gpointer user_data);
+
+// -----------------------------------------------------------------------------
+// Package prefetch helpers
+// -----------------------------------------------------------------------------
+static void start_transaction_prefetch(TransactionSession *session);
+static bool transaction_prefetch_running(TransactionSession *session);
 
+// -----------------------------------------------------------------------------
+// Main loop dispatch helpers
+// -----------------------------------------------------------------------------
 struct QueuedFinishedResult {
   TransactionSession *session = nullptr;
   TransactionStage stage = TransactionStage::PREVIEW_FAILED;
@@ -262,59 +434,216 @@ service_request_limit_reached(TransactionService *service, const std::string &ow
 }
 
 // -----------------------------------------------------------------------------
-// Try to reserve one preview worker slot.
+// Mark one pool worker idle again after its preview finished.
 // -----------------------------------------------------------------------------
-static bool
-try_acquire_preview_worker(TransactionService *service)
+static void
+release_preview_worker(TransactionService *service)
 {
   if (!service) {
+    return;
+  }
+
+  service->preview_workers.fetch_sub(1);
+}
+
+struct PreviewWorkerGuard {
+  TransactionService *service = nullptr;
+
+  // -----------------------------------------------------------------------------
+  // Mark the worker idle when the preview returns or throws.
+  // -----------------------------------------------------------------------------
+  ~PreviewWorkerGuard()
+  {
+    release_preview_worker(service);
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Tell every queued preview its current position when all workers are busy.
+// Runs on the main loop, which is also the only place sessions leave the queue
+// without a worker, so every queued pointer is still a live session here.
+// -----------------------------------------------------------------------------
+static void
+report_preview_queue_positions(TransactionService *service)
+{
+  if (!service || service->shutting_down.load()) {
+    return;
+  }
+
+  std::vector<TransactionSession *> queued;
+  {
+    std::lock_guard<std::mutex> lock(service->preview_queue_mutex);
+    queued.assign(service->preview_queue.begin(), service->preview_queue.end());
+  }
+
+  // While a worker is idle the front of the queue is about to start, so no
+  // waiting message is worth sending.
+  const unsigned busy = service->preview_workers.load();
+  const size_t idle = busy < kMaxPreviewWorkers ? kMaxPreviewWorkers - busy : 0;
+
+  for (size_t i = 0; i < queued.size(); i++) {
+    if (i < idle) {
+      continue;
+    }
+
+    TransactionSession *session = queued[i];
+    const size_t position = i - idle + 1;
+    if (session->reported_queue_position == position) {
+      continue;
+    }
+
+    session->reported_queue_position = position;
+    emit_transaction_progress(session,
+                              dnfui_i18n_format(_("Waiting for other package previews (position %zu in queue)."),
+                                                position));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Main loop trampoline for report_preview_queue_positions.
+// -----------------------------------------------------------------------------
+static gboolean
+dispatch_preview_queue_positions(gpointer user_data)
+{
+  report_preview_queue_positions(static_cast<TransactionService *>(user_data));
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Remove one session from the preview queue before a worker picked it up.
+// Returns true when the session was still queued. Main loop only.
+// -----------------------------------------------------------------------------
+static bool
+remove_queued_preview(TransactionSession *session)
+{
+  if (!session || !session->service) {
     return false;
   }
 
-  unsigned current = service->preview_workers.load();
-  while (current < kMaxPreviewWorkers) {
-    if (service->preview_workers.compare_exchange_weak(current, current + 1)) {
-      return true;
+  TransactionService *service = session->service;
+  bool removed = false;
+  {
+    std::lock_guard<std::mutex> lock(service->preview_queue_mutex);
+    auto it = std::find(service->preview_queue.begin(), service->preview_queue.end(), session);
+    if (it != service->preview_queue.end()) {
+      service->preview_queue.erase(it);
+      removed = true;
     }
   }
 
-  return false;
+  if (removed) {
+    DNFUI_TRACE("Transaction service removed queued preview path=%s", session->object_path.c_str());
+    report_preview_queue_positions(service);
+  }
+  return removed;
+}
+
+// -----------------------------------------------------------------------------
+// Take the pending progress lines and cancel the scheduled flush. close stops
+// workers from queueing more lines until the session runs again.
+// -----------------------------------------------------------------------------
+static std::vector<std::string>
+take_transaction_progress(TransactionSession *session, bool close)
+{
+  std::lock_guard<std::mutex> lock(session->progress_mutex);
+  if (close) {
+    session->progress_closed = true;
+  }
+  if (session->progress_flush_source) {
+    g_source_destroy(session->progress_flush_source);
+    g_source_unref(session->progress_flush_source);
+    session->progress_flush_source = nullptr;
+  }
+  session->download_progress_pending = false;
+  return session->progress_batch.take();
+}
+
+// -----------------------------------------------------------------------------
+// Take the pending aggregate download progress. Returns false when no event
+// arrived since the last flush.
+// -----------------------------------------------------------------------------
+static bool
+take_transaction_download_progress(TransactionSession *session, TransactionDownloadProgress &progress_out)
+{
+  std::lock_guard<std::mutex> lock(session->progress_mutex);
+  if (!session->download_progress_pending) {
+    return false;
+  }
+  session->download_progress_pending = false;
+  progress_out = session->download_progress;
+  return true;
 }
 
 // -----------------------------------------------------------------------------
-// Release one previously reserved preview worker slot.
+// Send the newest aggregate download progress as one DownloadProgress signal
+// and the pending progress lines as one ProgressBatch signal. Progress carries
+// only the newest line so single-line listeners still see current state.
 // -----------------------------------------------------------------------------
 static void
-release_preview_worker(TransactionService *service)
+flush_transaction_progress(TransactionSession *session, bool close)
 {
-  if (!service) {
+  if (!session || !session->service) {
     return;
   }
 
-  service->preview_workers.fetch_sub(1);
-}
+  TransactionDownloadProgress download;
+  const bool has_download = take_transaction_download_progress(session, download);
+  const std::vector<std::string> lines = take_transaction_progress(session, close);
+  if (!session->service->connection) {
+    return;
+  }
 
-struct PreviewWorkerGuard {
-  TransactionService *service = nullptr;
+  if (has_download) {
+    g_dbus_connection_emit_signal(session->service->connection,
+                                  nullptr,
+                                  session->object_path.c_str(),
+                                  kTransactionInterface,
+                                  "DownloadProgress",
+                                  g_variant_new("(tttu)",
+                                                static_cast<guint64>(download.bytes_done),
+                                                static_cast<guint64>(download.bytes_total),
+                                                static_cast<guint64>(download.bytes_per_second),
+                                                static_cast<guint32>(download.active_downloads)),
+                                  nullptr);
+  }
 
-  ~PreviewWorkerGuard()
-  {
-    release_preview_worker(service);
+  if (lines.empty()) {
+    return;
   }
-};
+
+  GVariantBuilder builder;
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("as"));
+  for (const auto &line : lines) {
+    g_variant_builder_add(&builder, "s", line.c_str());
+  }
+  g_dbus_connection_emit_signal(session->service->connection,
+                                nullptr,
+                                session->object_path.c_str(),
+                                kTransactionInterface,
+                                "ProgressBatch",
+                                g_variant_new("(as)", &builder),
+                                nullptr);
+  g_dbus_connection_emit_signal(session->service->connection,
+                                nullptr,
+                                session->object_path.c_str(),
+                                kTransactionInterface,
+                                "Progress",
+                                g_variant_new("(s)", lines.back().c_str()),
+                                nullptr);
+}
 
 // -----------------------------------------------------------------------------
-// Copy one queued progress message onto the main loop and emit it on D-Bus.
+// Flush the progress lines collected during one batching interval.
 // -----------------------------------------------------------------------------
 static gboolean
-dispatch_transaction_progress(gpointer user_data)
+dispatch_transaction_progress_flush(gpointer user_data)
 {
-  std::unique_ptr<QueuedProgressMessage> message(static_cast<QueuedProgressMessage *>(user_data));
-  if (!message || !message->session) {
+  auto *session = static_cast<TransactionSession *>(user_data);
+  if (!session || session->service->shutting_down.load()) {
     return G_SOURCE_REMOVE;
   }
 
-  emit_transaction_progress(message->session, message->line);
+  flush_transaction_progress(session, false);
   return G_SOURCE_REMOVE;
 }
 
@@ -368,9 +697,20 @@ dispatch_transaction_release(gpointer user_data)
   }
 
   // Keep the session alive until running preview or apply work has reached a
-  // finished state. Worker threads still hold a raw session pointer.
+  // finished state. Worker threads still hold a raw session pointer. A preview
+  // that is still queued never reached a worker, so it finishes here and the
+  // finished handler queues this release again.
   if (!session->finished.load()) {
     session->cancelled = true;
+    if (remove_queued_preview(session)) {
+      emit_transaction_finished(session, TransactionStage::CANCELLED, false, _("Transaction preview was cancelled."));
+    }
+    return G_SOURCE_REMOVE;
+  }
+
+  // The prefetch thread queues this release again once its download stopped.
+  session->prefetch_cancel = true;
+  if (transaction_prefetch_running(session)) {
     return G_SOURCE_REMOVE;
   }
 
@@ -383,7 +723,8 @@ dispatch_transaction_release(gpointer user_data)
 }
 
 // -----------------------------------------------------------------------------
-// Emit one progress line for a live transaction request object.
+// Emit one progress line for a live transaction request object right away,
+// together with any worker lines still waiting for their batch. Main loop only.
 // -----------------------------------------------------------------------------
 static void
 emit_transaction_progress(TransactionSession *session, const std::string &line)
@@ -392,13 +733,11 @@ emit_transaction_progress(TransactionSession *session, const std::string &line)
     return;
   }
 
-  g_dbus_connection_emit_signal(session->service->connection,
-                                nullptr,
-                                session->object_path.c_str(),
-                                kTransactionInterface,
-                                "Progress",
-                                g_variant_new("(s)", line.c_str()),
-                                nullptr);
+  {
+    std::lock_guard<std::mutex> lock(session->progress_mutex);
+    session->progress_batch.append(line);
+  }
+  flush_transaction_progress(session, false);
 }
 
 // -----------------------------------------------------------------------------
@@ -416,6 +755,10 @@ emit_transaction_finished(TransactionSession *session, TransactionStage stage, b
     return;
   }
 
+  // Clients treat Finished as the last signal, so queued lines go out first.
+  flush_transaction_progress(session, true);
+  session->service->statistics.record_since(transaction_stage_name(stage), session->work_started);
+
   {
     std::lock_guard<std::mutex> lock(session->state_mutex);
     session->stage = stage;
@@ -434,11 +777,34 @@ emit_transaction_finished(TransactionSession *session, TransactionStage stage, b
   // finish processing is responsible for completing the deferred cleanup.
   if (session->release_requested.load()) {
     queue_transaction_release(session);
+  } else if (stage == TransactionStage::PREVIEW_READY && success) {
+    start_transaction_prefetch(session);
+  }
+
+  schedule_speculative_upgrade_all(session->service);
+}
+
+// -----------------------------------------------------------------------------
+// Schedule the next batch flush unless one is pending. The caller must hold
+// progress_mutex.
+// -----------------------------------------------------------------------------
+static void
+schedule_transaction_progress_flush_locked(TransactionSession *session)
+{
+  if (session->progress_flush_source) {
+    return;
   }
+
+  GSource *source = g_timeout_source_new(kTransactionProgressBatchIntervalMs);
+  g_source_set_callback(source, dispatch_transaction_progress_flush, session, nullptr);
+  g_source_attach(source, session->service->main_context);
+  session->progress_flush_source = source;
 }
 
 // -----------------------------------------------------------------------------
-// Queue one transaction progress line back onto the service main loop.
+// Queue one transaction progress line for the next batch flush on the service
+// main loop. The first line of a batch schedules the flush, so one request
+// object sends at most one batch per kTransactionProgressBatchIntervalMs.
 // -----------------------------------------------------------------------------
 static void
 queue_transaction_progress(TransactionSession *session, const std::string &line)
@@ -447,10 +813,34 @@ queue_transaction_progress(TransactionSession *session, const std::string &line)
     return;
   }
 
-  auto *message = new QueuedProgressMessage();
-  message->session = session;
-  message->line = line;
-  g_main_context_invoke(session->service->main_context, dispatch_transaction_progress, message);
+  std::lock_guard<std::mutex> lock(session->progress_mutex);
+  if (session->progress_closed) {
+    return;
+  }
+
+  session->progress_batch.append(line);
+  schedule_transaction_progress_flush_locked(session);
+}
+
+// -----------------------------------------------------------------------------
+// Keep the newest aggregate download progress for the next batch flush. Older
+// events not yet sent are replaced, so the signal shares the batch rate.
+// -----------------------------------------------------------------------------
+static void
+queue_transaction_download_progress(TransactionSession *session, const TransactionDownloadProgress &progress)
+{
+  if (!session || session->finished.load()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(session->progress_mutex);
+  if (session->progress_closed) {
+    return;
+  }
+
+  session->download_progress = progress;
+  session->download_progress_pending = true;
+  schedule_transaction_progress_flush_locked(session);
 }
 
 // -----------------------------------------------------------------------------
@@ -537,6 +927,12 @@ set_transaction_running(TransactionSession *session, TransactionStage stage)
     return;
   }
 
+  {
+    std::lock_guard<std::mutex> lock(session->progress_mutex);
+    session->progress_closed = false;
+  }
+
+  session->work_started = std::chrono::steady_clock::now();
   std::lock_guard<std::mutex> lock(session->state_mutex);
   session->stage = stage;
   session->finished = false;
@@ -576,6 +972,7 @@ complete_apply_request(TransactionSession *session, GDBusMethodInvocation *invoc
 struct AuthorizationCallbackContext {
   TransactionService *service = nullptr;
   std::string object_path;
+  std::chrono::steady_clock::time_point started_at;
 };
 
 // -----------------------------------------------------------------------------
@@ -598,6 +995,7 @@ on_apply_authorization_result(GObject *source_object, GAsyncResult *res, gpointe
                 context->object_path.c_str());
     return;
   }
+  context->service->statistics.record_since("authorization", context->started_at);
 
   // The request may have been released while authorization was running.
   auto it = context->service->transactions.find(context->object_path);
@@ -723,6 +1121,7 @@ start_authorize_apply_request(TransactionSession *session, GDBusMethodInvocation
   auto *callback_context = new AuthorizationCallbackContext();
   callback_context->service = session->service;
   callback_context->object_path = session->object_path;
+  callback_context->started_at = std::chrono::steady_clock::now();
 
   DNFUI_TRACE("Transaction service apply authorization start (async) path=%s", session->object_path.c_str());
   polkit_authority_check_authorization(authority,
@@ -816,7 +1215,7 @@ run_transaction_preview(TransactionSession *session)
         session->preview = preview;
       }
       queue_transaction_finished(
-          session, TransactionStage::PREVIEW_READY, true, format_transaction_preview_details(preview));
+          session, TransactionStage::PREVIEW_READY, true, format_transaction_preview_result_details(preview));
       return;
     }
 
@@ -824,17 +1223,28 @@ run_transaction_preview(TransactionSession *session)
       if (transaction_request_needs_available_repos(session->request)) {
         // The transaction service is a long-lived process, so packages installed or
         // removed outside the GUI can leave its cached Base out of date. Rebuild it
-        // before each preview so resolve and apply requests always use the current
-        // rpmdb and repository metadata snapshot.
+        // before each preview when the rpmdb or repository metadata changed so
+        // resolve and apply requests always use the current snapshot, and keep
+        // the loaded Base when nothing changed since the last preview.
         queue_transaction_progress(session, _("Refreshing backend state..."));
-        BaseManager::instance().rebuild();
+        TransactionLatencyTimer timer(session->service->statistics, "rebuild");
+        BaseManager::instance().rebuild(BaseRebuildPolicy::IF_CHANGED, &session->cancelled);
       } else {
         // Remove-only requests are local-first and should stay usable without
         // waiting on remote repository availability.
         queue_transaction_progress(session, _("Refreshing installed package state..."));
-        BaseManager::instance().rebuild_system_only();
+        TransactionLatencyTimer timer(session->service->statistics, "rebuild-installed-only");
+        BaseManager::instance().rebuild_system_only(BaseRebuildPolicy::IF_CHANGED, &session->cancelled);
       }
     } catch (const std::exception &e) {
+      // Cancel and client disconnect abort the rebuild, so stop here instead
+      // of retrying on the previous package state.
+      if (session->cancelled.load()) {
+        DNFUI_TRACE("Transaction service preview cancelled during refresh path=%s", session->object_path.c_str());
+        queue_transaction_finished(
+            session, TransactionStage::CANCELLED, false, _("Transaction preview was cancelled."));
+        return;
+      }
       DNFUI_TRACE(
           "Transaction service preview refresh failed path=%s error=%s", session->object_path.c_str(), e.what());
       queue_transaction_progress(session,
@@ -844,13 +1254,26 @@ run_transaction_preview(TransactionSession *session)
       }
     }
 
-    bool ok = dnf_backend_preview_transaction(session->request.install,
-                                              session->request.remove,
-                                              session->request.reinstall,
-                                              preview,
-                                              error_out,
-                                              progress_cb,
-                                              session->request.upgrade_all);
+    ResolvedTransactionPtr resolved;
+    bool ok = false;
+    if (session->request.upgrade_all &&
+        session->service->speculative_upgrade_all_preview.take_if_current(preview, resolved)) {
+      // The background preview resolved the same request on the Base the
+      // refresh above just confirmed, so its result is used as is.
+      DNFUI_TRACE("Transaction service preview uses background result path=%s", session->object_path.c_str());
+      queue_transaction_progress(session, _("Using the upgrade preview prepared in the background."));
+      ok = true;
+    } else {
+      ok = dnf_backend_preview_transaction(session->request.install,
+                                           session->request.remove,
+                                           session->request.reinstall,
+                                           preview,
+                                           error_out,
+                                           progress_cb,
+                                           session->request.upgrade_all,
+                                           &resolved,
+                                           &session->cancelled);
+    }
 
     if (session->cancelled.load()) {
       DNFUI_TRACE("Transaction service preview cancelled path=%s", session->object_path.c_str());
@@ -867,13 +1290,14 @@ run_transaction_preview(TransactionSession *session)
     {
       std::lock_guard<std::mutex> lock(session->state_mutex);
       session->preview = preview;
+      session->resolved = std::move(resolved);
     }
     DNFUI_TRACE("Transaction service preview done path=%s items=%zu",
                 session->object_path.c_str(),
                 preview.install.size() + preview.upgrade.size() + preview.downgrade.size() + preview.reinstall.size() +
                     preview.remove.size());
     queue_transaction_finished(
-        session, TransactionStage::PREVIEW_READY, true, format_transaction_preview_details(preview));
+        session, TransactionStage::PREVIEW_READY, true, format_transaction_preview_result_details(preview));
   } catch (const std::exception &e) {
     DNFUI_TRACE("Transaction service preview exception path=%s error=%s", session->object_path.c_str(), e.what());
     queue_transaction_finished(session, TransactionStage::PREVIEW_FAILED, false, e.what());
@@ -884,7 +1308,37 @@ run_transaction_preview(TransactionSession *session)
 }
 
 // -----------------------------------------------------------------------------
-// Start the transaction preview worker for one new request object.
+// Run the oldest queued preview on one pool worker. The job data is unused
+// because cancelled sessions are taken out of the queue, not out of the pool.
+// -----------------------------------------------------------------------------
+static void
+run_queued_transaction_preview(gpointer, gpointer user_data)
+{
+  TransactionService *service = static_cast<TransactionService *>(user_data);
+  if (!service || service->shutting_down.load()) {
+    return;
+  }
+
+  TransactionSession *session = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(service->preview_queue_mutex);
+    if (service->preview_queue.empty()) {
+      return;
+    }
+    session = service->preview_queue.front();
+    service->preview_queue.pop_front();
+    service->preview_workers.fetch_add(1);
+    service->statistics.record_since("queue-wait", session->queued_at);
+  }
+
+  PreviewWorkerGuard guard { service };
+  g_main_context_invoke(service->main_context, dispatch_preview_queue_positions, service);
+  run_transaction_preview(session);
+}
+
+// -----------------------------------------------------------------------------
+// Queue the preview for one new request object. Previews run in arrival order
+// on the worker pool, and requests that have to wait are told their position.
 // -----------------------------------------------------------------------------
 static gboolean
 start_transaction_preview(gpointer user_data)
@@ -894,23 +1348,24 @@ start_transaction_preview(gpointer user_data)
     return G_SOURCE_REMOVE;
   }
 
-  if (!try_acquire_preview_worker(session->service)) {
-    queue_transaction_finished(
-        session, TransactionStage::PREVIEW_FAILED, false, _("Too many transaction previews are already running."));
-    return G_SOURCE_REMOVE;
+  TransactionService *service = session->service;
+  interrupt_speculative_upgrade_all(service);
+  {
+    std::lock_guard<std::mutex> lock(service->preview_queue_mutex);
+    session->queued_at = std::chrono::steady_clock::now();
+    service->preview_queue.push_back(session);
   }
 
-  GThread *thread = g_thread_new(
-      "dnf-ui-preview",
-      +[](gpointer data) -> gpointer {
-        TransactionSession *session = static_cast<TransactionSession *>(data);
-        PreviewWorkerGuard guard { session ? session->service : nullptr };
+  GError *error = nullptr;
+  if (!g_thread_pool_push(service->preview_pool, service, &error)) {
+    std::string details = error && error->message ? error->message : _("Failed to start the preview worker.");
+    g_clear_error(&error);
+    remove_queued_preview(session);
+    queue_transaction_finished(session, TransactionStage::PREVIEW_FAILED, false, details);
+    return G_SOURCE_REMOVE;
+  }
 
-        run_transaction_preview(session);
-        return nullptr;
-      },
-      session);
-  g_thread_unref(thread);
+  report_preview_queue_positions(service);
   return G_SOURCE_REMOVE;
 }
 
@@ -952,13 +1407,38 @@ run_transaction_apply(TransactionSession *session)
     queue_transaction_progress(session, _("Loading package base..."));
     auto progress_cb = [session](const std::string &line) { queue_transaction_progress(session, line); };
 
+    {
+      // Downloads the prefetch already started are the ones apply needs, so
+      // let them finish and reuse the files instead of stopping them.
+      std::unique_lock<std::mutex> lock(session->prefetch_mutex);
+      if (session->prefetch_running) {
+        queue_transaction_progress(session, _("Finishing package downloads started during the preview..."));
+        session->prefetch_done.wait(lock, [session] { return !session->prefetch_running; });
+      }
+    }
+
+    ResolvedTransactionPtr resolved;
+    {
+      // Apply runs once per request, so take the preview resolution out of
+      // the session instead of sharing it.
+      std::lock_guard<std::mutex> lock(session->state_mutex);
+      resolved = std::move(session->resolved);
+    }
+
+    auto download_cb = [session](const TransactionDownloadProgress &progress) {
+      queue_transaction_download_progress(session, progress);
+    };
+
     DNFUI_TRACE("Transaction service apply start path=%s", session->object_path.c_str());
     bool ok = dnf_backend_apply_transaction(session->request.install,
                                             session->request.remove,
                                             session->request.reinstall,
                                             error_out,
                                             progress_cb,
-                                            session->request.upgrade_all);
+                                            session->request.upgrade_all,
+                                            resolved,
+                                            download_cb,
+                                            &session->cancelled);
 
     std::string details;
     TransactionStage stage = TransactionStage::APPLY_FAILED;
@@ -972,9 +1452,11 @@ run_transaction_apply(TransactionSession *session)
       try {
         if (transaction_request_needs_available_repos(session->request)) {
           queue_transaction_progress(session, _("Refreshing backend state..."));
+          TransactionLatencyTimer timer(session->service->statistics, "rebuild");
           BaseManager::instance().rebuild();
         } else {
           queue_transaction_progress(session, _("Refreshing installed package state..."));
+          TransactionLatencyTimer timer(session->service->statistics, "rebuild-installed-only");
           BaseManager::instance().rebuild_system_only();
         }
       } catch (const std::exception &e) {
@@ -982,6 +1464,11 @@ run_transaction_apply(TransactionSession *session)
         details += _("Backend refresh failed: ");
         details += e.what();
       }
+    } else if (session->cancelled.load()) {
+      // The client went away while packages were downloading. Nothing was
+      // changed on the system, so this is a cancellation, not a failure.
+      details = _("Transaction apply was cancelled before packages were installed.");
+      stage = TransactionStage::CANCELLED;
     } else {
       details = error_out;
     }
@@ -1017,6 +1504,7 @@ start_transaction_apply(gpointer user_data)
     return G_SOURCE_REMOVE;
   }
 
+  interrupt_speculative_upgrade_all(session->service);
   GThread *thread = g_thread_new(
       "dnf-ui-apply",
       +[](gpointer data) -> gpointer {
@@ -1029,35 +1517,133 @@ start_transaction_apply(gpointer user_data)
 }
 
 // -----------------------------------------------------------------------------
-// Return true when apply should stop before package work begins.
-// Release and client disconnect handling already mark the session cancelled.
+// Package prefetch
+// -----------------------------------------------------------------------------
+// Return true while the prefetch thread still uses the session.
 // -----------------------------------------------------------------------------
 static bool
-transaction_apply_should_stop_before_work(TransactionSession *session, std::string &details_out)
+transaction_prefetch_running(TransactionSession *session)
 {
-  details_out.clear();
+  std::lock_guard<std::mutex> lock(session->prefetch_mutex);
+  return session->prefetch_running;
+}
 
-  if (session->service->shutting_down.load()) {
-    details_out = _("Transaction service is shutting down.");
-    return true;
+// -----------------------------------------------------------------------------
+// Download the packages of one ready preview into the package cache. Lines are
+// dropped while the preview stays finished and reach the client once Apply
+// reopens the request object and waits for the downloads.
+// -----------------------------------------------------------------------------
+static void
+run_transaction_prefetch(TransactionSession *session)
+{
+  ResolvedTransactionPtr resolved;
+  {
+    std::lock_guard<std::mutex> lock(session->state_mutex);
+    resolved = session->resolved;
   }
 
-  if (session->release_requested.load() || session->cancelled.load()) {
-    details_out = _("Transaction apply was cancelled before it started.");
-    return true;
+  std::string error_out;
+  auto progress_cb = [session](const std::string &line) { queue_transaction_progress(session, line); };
+  auto download_cb = [session](const TransactionDownloadProgress &progress) {
+    queue_transaction_download_progress(session, progress);
+  };
+  DNFUI_TRACE("Transaction service prefetch start path=%s", session->object_path.c_str());
+  run_test_prefetch_hold_hook_if_requested(session->prefetch_cancel);
+  bool ok = dnf_backend_prefetch_transaction(
+      resolved, session->state_mutex, error_out, progress_cb, session->prefetch_cancel, download_cb);
+  DNFUI_TRACE("Transaction service prefetch done path=%s ok=%d error=%s",
+              session->object_path.c_str(),
+              ok ? 1 : 0,
+              error_out.c_str());
+
+  // Copy what the deferred release needs first, because the session may be
+  // freed as soon as prefetch_running drops.
+  TransactionService *service = session->service;
+  std::string object_path = session->object_path;
+  bool release = false;
+  {
+    std::lock_guard<std::mutex> lock(session->prefetch_mutex);
+    session->prefetch_running = false;
+    release = session->release_requested.load();
+    session->prefetch_done.notify_all();
   }
 
-  return false;
+  if (release && !service->shutting_down.load()) {
+    auto *queued = new QueuedSessionRelease();
+    queued->service = service;
+    queued->object_path = object_path;
+    g_main_context_invoke(service->main_context, dispatch_transaction_release, queued);
+  }
 }
 
 // -----------------------------------------------------------------------------
-// Per transaction object handling
-// -----------------------------------------------------------------------------
-// Handle one D-Bus method call for a live transaction request object.
+// Start the package prefetch for one ready preview when the service was asked
+// to prefetch. Main loop only.
 // -----------------------------------------------------------------------------
 static void
-on_transaction_method_call(GDBusConnection *,
-                           const gchar *,
+start_transaction_prefetch(TransactionSession *session)
+{
+  TransactionService *service = session->service;
+  if (!service->prefetch_packages || service->shutting_down.load()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(session->state_mutex);
+    if (!session->resolved) {
+      return;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(session->prefetch_mutex);
+    if (session->prefetch_running) {
+      return;
+    }
+    session->prefetch_running = true;
+  }
+  session->prefetch_cancel = false;
+
+  GThread *thread = g_thread_new(
+      "dnf-ui-prefetch",
+      +[](gpointer data) -> gpointer {
+        run_transaction_prefetch(static_cast<TransactionSession *>(data));
+        return nullptr;
+      },
+      session);
+  g_thread_unref(thread);
+}
+
+// -----------------------------------------------------------------------------
+// Return true when apply should stop before package work begins.
+// Release and client disconnect handling already mark the session cancelled.
+// -----------------------------------------------------------------------------
+static bool
+transaction_apply_should_stop_before_work(TransactionSession *session, std::string &details_out)
+{
+  details_out.clear();
+
+  if (session->service->shutting_down.load()) {
+    details_out = _("Transaction service is shutting down.");
+    return true;
+  }
+
+  if (session->release_requested.load() || session->cancelled.load()) {
+    details_out = _("Transaction apply was cancelled before it started.");
+    return true;
+  }
+
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Per transaction object handling
+// -----------------------------------------------------------------------------
+// Handle one D-Bus method call for a live transaction request object.
+// -----------------------------------------------------------------------------
+static void
+on_transaction_method_call(GDBusConnection *,
+                           const gchar *,
                            const gchar *object_path,
                            const gchar *interface_name,
                            const gchar *method_name,
@@ -1073,6 +1659,7 @@ on_transaction_method_call(GDBusConnection *,
         invocation, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, "%s", _("Transaction session is not available."));
     return;
   }
+  note_service_activity(session->service);
 
   if (g_strcmp0(interface_name, kTransactionInterface) != 0) {
     g_dbus_method_invocation_return_error(
@@ -1117,6 +1704,11 @@ on_transaction_method_call(GDBusConnection *,
     }
 
     session->cancelled = true;
+    // A ready preview may be downloading its packages. Stop that too, so the
+    // cancelled request does not keep downloading on its fork lease.
+    session->prefetch_cancel = true;
+    // A queued preview is dropped before any worker or Base access sees it.
+    remove_queued_preview(session);
 
     // If the preview worker already finished (PREVIEW_READY), clear the flag so
     // emit_transaction_progress can send the cancellation line before the Finished signal.
@@ -1250,6 +1842,36 @@ on_transaction_method_call(GDBusConnection *,
     return;
   }
 
+  if (g_strcmp0(method_name, "GetPreviewFd") == 0) {
+    TransactionPreview preview_copy;
+    {
+      std::lock_guard<std::mutex> lock(session->state_mutex);
+
+      if (session->stage != TransactionStage::PREVIEW_READY || !session->finished.load() || !session->success) {
+        g_dbus_method_invocation_return_error(
+            invocation, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, "%s", _("Transaction preview is not available."));
+        return;
+      }
+
+      preview_copy = session->preview;
+    }
+
+    // The fd goes only to the caller, and the sealed payload cannot change
+    // after the client checked it.
+    std::string error_out;
+    const int fd =
+        transaction_preview_payload_create_memfd(transaction_preview_payload_encode(preview_copy), error_out);
+    if (fd < 0) {
+      g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, "%s", error_out.c_str());
+      return;
+    }
+
+    GUnixFDList *fd_list = g_unix_fd_list_new_from_array(&fd, 1);
+    g_dbus_method_invocation_return_value_with_unix_fd_list(invocation, g_variant_new("(h)", 0), fd_list);
+    g_object_unref(fd_list);
+    return;
+  }
+
   if (g_strcmp0(method_name, "GetResult") == 0) {
     const char *stage_name = nullptr;
     bool finished = false;
@@ -1352,6 +1974,7 @@ create_transaction_session(TransactionService *service,
   session->object_path =
       std::string(kManagerObjectPath) + "/requests/" + std::to_string(service->next_transaction_id++);
   session->owner_name = owner_name;
+  session->work_started = std::chrono::steady_clock::now();
 
   if (service_request_limit_reached(service, session->owner_name, error_out)) {
     return nullptr;
@@ -1390,10 +2013,564 @@ create_transaction_session(TransactionService *service,
   return raw;
 }
 
+// -----------------------------------------------------------------------------
+// Background upgrade-all preview
+// -----------------------------------------------------------------------------
+// Return true when no request is queued, resolving, or applying, so the
+// background preview would not compete with interactive work.
+// -----------------------------------------------------------------------------
+static bool
+transaction_service_is_idle(TransactionService *service)
+{
+  if (service->shutting_down.load() || service->apply_running.load() || service->warmup_running.load() ||
+      service->speculation_running.load() || service->queries_running.load() != 0) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(service->preview_queue_mutex);
+    if (!service->preview_queue.empty() || service->preview_workers.load() != 0) {
+      return false;
+    }
+  }
+
+  for (const auto &[path, session] : service->transactions) {
+    if (!session->finished.load()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Resolve upgrade-all on an idle fork of the published Base and cache the
+// result. Never refreshes the Base or loads a fork itself: when the published
+// Base is stale, being rebuilt, or has no idle fork, the job does nothing and
+// the next interactive preview does the work.
+// -----------------------------------------------------------------------------
+static void
+run_speculative_upgrade_all(TransactionService *service)
+{
+  DNFUI_TRACE("Transaction service background upgrade preview start");
+  try {
+    if (!service->speculation_cancel.load() && BaseManager::instance().published_repo_base_is_current()) {
+      TransactionPreview preview;
+      std::string error_out;
+      ResolvedTransactionPtr resolved;
+      bool ok = dnf_backend_preview_upgrade_all_on_idle_fork(
+          preview, error_out, &resolved, &service->speculation_cancel);
+      // libdnf5 cannot stop a running solve, so a request that arrived
+      // meanwhile only keeps the result out of the cache.
+      if (ok && resolved && !service->speculation_cancel.load()) {
+        service->speculative_upgrade_all_preview.store(preview, std::move(resolved));
+        DNFUI_TRACE("Transaction service background upgrade preview cached");
+      }
+    }
+  } catch (const std::exception &e) {
+    // The interactive preview resolves again and reports the failure itself.
+    DNFUI_TRACE("Transaction service background upgrade preview failed error=%s", e.what());
+  }
+  service->speculation_running = false;
+}
+
+// -----------------------------------------------------------------------------
+// Start the background preview once the service stayed idle for the delay.
+// -----------------------------------------------------------------------------
+static gboolean
+on_speculative_upgrade_all_timeout(gpointer user_data)
+{
+  TransactionService *service = static_cast<TransactionService *>(user_data);
+  service->speculation_timer_id = 0;
+  if (!transaction_service_is_idle(service) || service->speculative_upgrade_all_preview.has_current()) {
+    return G_SOURCE_REMOVE;
+  }
+
+  service->speculation_cancel = false;
+  service->speculation_running = true;
+  GThread *thread = g_thread_new(
+      "dnf-ui-speculate",
+      +[](gpointer data) -> gpointer {
+        run_speculative_upgrade_all(static_cast<TransactionService *>(data));
+        return nullptr;
+      },
+      service);
+  g_thread_unref(thread);
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Restart the idle delay for the background upgrade-all preview. Main loop only.
+// -----------------------------------------------------------------------------
+static void
+schedule_speculative_upgrade_all(TransactionService *service)
+{
+  if (!service || !service->speculative_upgrade_all || service->shutting_down.load()) {
+    return;
+  }
+
+  if (service->speculation_timer_id != 0) {
+    g_source_remove(service->speculation_timer_id);
+  }
+  service->speculation_timer_id =
+      g_timeout_add_seconds(kSpeculativeUpgradeAllIdleSeconds, on_speculative_upgrade_all_timeout, service);
+}
+
+// -----------------------------------------------------------------------------
+// Main loop trampoline for schedule_speculative_upgrade_all.
+// -----------------------------------------------------------------------------
+static gboolean
+dispatch_speculative_upgrade_all_schedule(gpointer user_data)
+{
+  schedule_speculative_upgrade_all(static_cast<TransactionService *>(user_data));
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Give the Base back to interactive work: drop the pending idle delay and keep
+// a background preview that is still resolving out of the cache. Main loop only.
+// -----------------------------------------------------------------------------
+static void
+interrupt_speculative_upgrade_all(TransactionService *service)
+{
+  if (!service) {
+    return;
+  }
+
+  if (service->speculation_timer_id != 0) {
+    g_source_remove(service->speculation_timer_id);
+    service->speculation_timer_id = 0;
+  }
+  if (service->speculation_running.load()) {
+    DNFUI_TRACE("Transaction service background upgrade preview interrupted");
+    service->speculation_cancel = true;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Load the package base in the background before the first preview needs it.
+// A preview that starts meanwhile waits on the same build lock and then finds
+// the Base current, so it skips its own rebuild.
+// -----------------------------------------------------------------------------
+static void
+start_base_warmup(TransactionService *service)
+{
+  bool expected = false;
+  if (service->shutting_down.load() || !service->warmup_running.compare_exchange_strong(expected, true)) {
+    return;
+  }
+
+  GThread *thread = g_thread_new(
+      "dnf-ui-warmup",
+      +[](gpointer data) -> gpointer {
+        auto *service = static_cast<TransactionService *>(data);
+        DNFUI_TRACE("Transaction service warm up start");
+        try {
+          // Same policy as repo-backed previews, so an unchanged system costs
+          // only the fingerprint check.
+          {
+            TransactionLatencyTimer timer(service->statistics, "rebuild");
+            BaseManager::instance().rebuild();
+          }
+          // Previews resolve on a fork, so load one and leave it idle for them.
+          BaseForkLease fork = BaseManager::instance().acquire_fork();
+          DNFUI_TRACE("Transaction service warm up done");
+        } catch (const std::exception &e) {
+          // The first preview retries the load and reports the failure itself.
+          DNFUI_TRACE("Transaction service warm up failed error=%s", e.what());
+        }
+        service->warmup_running = false;
+        g_main_context_invoke(service->main_context, dispatch_speculative_upgrade_all_schedule, service);
+        return nullptr;
+      },
+      service);
+  g_thread_unref(thread);
+}
+
+// -----------------------------------------------------------------------------
+// Idle exit
+// -----------------------------------------------------------------------------
+// Drop everything the service loaded for earlier requests and hand the freed
+// heap back. Readers that still pin the Base keep it until they finish.
+// -----------------------------------------------------------------------------
+static void
+release_idle_service_memory(TransactionService *service)
+{
+  service->speculative_upgrade_all_preview.clear();
+  {
+    std::lock_guard<std::mutex> lock(service->query_views_mutex);
+    for (auto &view : service->query_views) {
+      view.reset();
+    }
+  }
+  if (BaseManager::instance().release_idle()) {
+    dnf_backend_release_package_indexes();
+  }
+
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Replace the pending idle exit check with one after ms. Whole seconds use a
+// seconds timer, which the main loop may batch with other wakeups. Main loop
+// only.
+// -----------------------------------------------------------------------------
+static void
+schedule_idle_exit_check(TransactionService *service, guint ms)
+{
+  if (service->idle_exit_timer_id != 0) {
+    g_source_remove(service->idle_exit_timer_id);
+  }
+  service->idle_exit_timer_id = ms % 1000 == 0 ? g_timeout_add_seconds(ms / 1000, on_idle_exit_timeout, service)
+                                               : g_timeout_add(ms, on_idle_exit_timeout, service);
+}
+
+// -----------------------------------------------------------------------------
+// Drop the Base once the service stayed idle for the timeout, and release the
+// bus name and exit when it is still idle at the following check. Sessions a
+// client has not released yet keep the service running, since the client may
+// still apply them.
+// -----------------------------------------------------------------------------
+static gboolean
+on_idle_exit_timeout(gpointer user_data)
+{
+  TransactionService *service = static_cast<TransactionService *>(user_data);
+  service->idle_exit_timer_id = 0;
+  if (!service->transactions.empty() || !transaction_service_is_idle(service)) {
+    run_test_idle_exit_deferred_hook_if_requested();
+    service->idle_memory_released = false;
+    schedule_idle_exit_check(service, service->idle_exit_ms);
+    return G_SOURCE_REMOVE;
+  }
+
+  if (!service->idle_memory_released) {
+    DNFUI_TRACE("Transaction service idle, releasing the package base");
+    release_idle_service_memory(service);
+    service->idle_memory_released = true;
+    schedule_idle_exit_check(service, std::min(kIdleExitGraceMs, service->idle_exit_ms));
+    return G_SOURCE_REMOVE;
+  }
+
+  // Give up the name before the loop stops, so the bus activates a new
+  // instance for the next call instead of routing it to this one.
+  DNFUI_TRACE("Transaction service idle, exiting");
+  if (service->owner_id != 0) {
+    g_bus_unown_name(service->owner_id);
+    service->owner_id = 0;
+  }
+  g_main_loop_quit(service->loop);
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Restart the idle timeout after a method call. Main loop only.
+// -----------------------------------------------------------------------------
+static void
+note_service_activity(TransactionService *service)
+{
+  if (service->idle_exit_ms == 0 || service->shutting_down.load()) {
+    return;
+  }
+
+  service->idle_memory_released = false;
+  schedule_idle_exit_check(service, service->idle_exit_ms);
+}
+
+// -----------------------------------------------------------------------------
+// Read-only package queries
+// -----------------------------------------------------------------------------
+// One SearchPackages, ListPackages, or GetPackageDetails call waiting for its
+// query thread.
+// -----------------------------------------------------------------------------
+struct ServiceQueryJob {
+  TransactionService *service = nullptr;
+  GDBusMethodInvocation *invocation = nullptr;
+  std::string method;
+  // Search pattern or package NEVRA.
+  std::string text;
+  DnfBackendSearchOptions search_options;
+  TransactionServicePackageView view = TransactionServicePackageView::INSTALLED;
+  size_t offset = 0;
+  size_t limit = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Return the rows of view for the current Base generation, listing them once
+// per generation for all clients.
+// -----------------------------------------------------------------------------
+static std::shared_ptr<const ServiceQueryViewRows>
+service_query_view_rows(TransactionService *service, TransactionServicePackageView view)
+{
+  const uint64_t generation = BaseManager::instance().current_generation();
+  const size_t slot = static_cast<size_t>(view);
+  {
+    std::lock_guard<std::mutex> lock(service->query_views_mutex);
+    if (service->query_views[slot] && service->query_views[slot]->generation == generation) {
+      return service->query_views[slot];
+    }
+  }
+
+  auto rows = std::make_shared<ServiceQueryViewRows>();
+  rows->generation = generation;
+  switch (view) {
+  case TransactionServicePackageView::INSTALLED:
+    rows->rows = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+    break;
+  case TransactionServicePackageView::AVAILABLE:
+    rows->rows = dnf_backend_get_browse_package_rows_interruptible(nullptr);
+    break;
+  case TransactionServicePackageView::UPGRADEABLE:
+    rows->rows = dnf_backend_get_upgradeable_package_rows_interruptible(nullptr);
+    break;
+  }
+
+  const InstalledPackageSnapshotPtr snapshot = dnf_backend_get_installed_snapshot();
+  rows->states.reserve(rows->rows.size());
+  for (const auto &classification : dnf_backend_classify_package_rows(*snapshot, rows->rows)) {
+    rows->states.push_back(classification.state);
+  }
+
+  std::lock_guard<std::mutex> lock(service->query_views_mutex);
+  service->query_views[slot] = rows;
+  return rows;
+}
+
+// -----------------------------------------------------------------------------
+// Build the reply of one query against the current Base.
+// -----------------------------------------------------------------------------
+static GVariant *
+build_service_query_reply(ServiceQueryJob &job)
+{
+  if (job.method == "GetPackageDetails") {
+    const std::string details = dnf_backend_get_package_info(job.text);
+    return g_variant_new("(s)", details.c_str());
+  }
+
+  TransactionServicePackagePage page;
+  if (job.method == "SearchPackages") {
+    PackageSearchPage search =
+        dnf_backend_search_package_rows_ranked(job.text, job.search_options, job.offset, job.limit, nullptr);
+    const InstalledPackageSnapshotPtr snapshot = dnf_backend_get_installed_snapshot();
+    for (const auto &classification : dnf_backend_classify_package_rows(*snapshot, search.rows)) {
+      page.states.push_back(classification.state);
+    }
+    page.rows = std::move(search.rows);
+    page.total = search.total_matches;
+    page.generation = BaseManager::instance().current_generation();
+  } else {
+    std::shared_ptr<const ServiceQueryViewRows> view = service_query_view_rows(job.service, job.view);
+    const size_t first = std::min(job.offset, view->rows.size());
+    const size_t last = std::min(view->rows.size(), first + job.limit);
+    page.rows.assign(view->rows.begin() + first, view->rows.begin() + last);
+    page.states.assign(view->states.begin() + first, view->states.begin() + last);
+    page.total = view->rows.size();
+    page.generation = view->generation;
+  }
+
+  // The page tuple is the whole reply.
+  return transaction_service_package_page_to_variant(page);
+}
+
+// -----------------------------------------------------------------------------
+// Run one query on its own thread and answer the call from there. The Base is
+// refreshed first like for a warm up, so an unchanged system costs only the
+// fingerprint check and every client reads the same warm Base.
+// -----------------------------------------------------------------------------
+static gpointer
+run_service_query(gpointer data)
+{
+  std::unique_ptr<ServiceQueryJob> job(static_cast<ServiceQueryJob *>(data));
+  TransactionService *service = job->service;
+  DNFUI_TRACE("Transaction service query start method=%s", job->method.c_str());
+  try {
+    TransactionLatencyTimer timer(service->statistics, "query");
+    BaseManager::instance().rebuild();
+    dnf_backend_refresh_installed_nevras();
+    g_dbus_method_invocation_return_value(job->invocation, build_service_query_reply(*job));
+  } catch (const std::exception &e) {
+    DNFUI_TRACE("Transaction service query failed method=%s error=%s", job->method.c_str(), e.what());
+    g_dbus_method_invocation_return_error(job->invocation, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, "%s", e.what());
+  }
+  g_object_unref(job->invocation);
+  service->queries_running--;
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Check the arguments of one query call and start its thread, or answer the
+// call with the reason it was rejected.
+// -----------------------------------------------------------------------------
+static void
+start_service_query(TransactionService *service,
+                    const gchar *method_name,
+                    GVariant *parameters,
+                    GDBusMethodInvocation *invocation)
+{
+  auto job = std::make_unique<ServiceQueryJob>();
+  job->service = service;
+  job->method = method_name;
+
+  const gchar *text = nullptr;
+  guint32 offset = 0;
+  guint32 limit = 0;
+  if (job->method == "SearchPackages") {
+    gboolean search_in_description = FALSE;
+    gboolean exact_match = FALSE;
+    g_variant_get(parameters, "(&sbbuu)", &text, &search_in_description, &exact_match, &offset, &limit);
+    job->search_options.search_in_description = search_in_description;
+    job->search_options.exact_match = exact_match;
+  } else if (job->method == "ListPackages") {
+    const gchar *view = nullptr;
+    g_variant_get(parameters, "(&suu)", &view, &offset, &limit);
+    if (!transaction_service_package_view_from_name(view, job->view)) {
+      g_dbus_method_invocation_return_error(
+          invocation, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS, "%s", _("Unknown package view."));
+      return;
+    }
+  } else {
+    g_variant_get(parameters, "(&s)", &text);
+  }
+
+  job->text = text ? text : "";
+  if (job->method != "ListPackages" && (job->text.empty() || job->text.size() > kTransactionRequestMaxSpecLength)) {
+    g_dbus_method_invocation_return_error(
+        invocation, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS, "%s", _("The package query text is empty or too long."));
+    return;
+  }
+  job->offset = offset;
+  job->limit = std::min<size_t>(limit, kTransactionServiceQueryMaxPageRows);
+
+  // Queries share the Base with previews, so only a few run at once.
+  if (service->queries_running.fetch_add(1) >= kMaxConcurrentQueries) {
+    service->queries_running--;
+    g_dbus_method_invocation_return_error(invocation,
+                                          G_DBUS_ERROR,
+                                          G_DBUS_ERROR_LIMITS_EXCEEDED,
+                                          "%s",
+                                          _("The transaction service is busy with other package queries."));
+    return;
+  }
+
+  job->invocation = G_DBUS_METHOD_INVOCATION(g_object_ref(invocation));
+  GThread *thread = g_thread_new("dnf-ui-query", run_service_query, job.release());
+  g_thread_unref(thread);
+}
+
+// -----------------------------------------------------------------------------
+// Build the GetStatistics reply: live request counts, peak RSS, the latency
+// bucket bounds, and one histogram per recorded stage.
+// -----------------------------------------------------------------------------
+static GVariant *
+build_service_statistics(TransactionService *service)
+{
+  guint32 active_sessions = 0;
+  for (const auto &[path, session] : service->transactions) {
+    if (!session->finished.load()) {
+      ++active_sessions;
+    }
+  }
+  guint32 queued_previews = 0;
+  {
+    std::lock_guard<std::mutex> lock(service->preview_queue_mutex);
+    queued_previews = static_cast<guint32>(service->preview_queue.size());
+  }
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+
+  GVariantBuilder bounds;
+  g_variant_builder_init(&bounds, G_VARIANT_TYPE("at"));
+  for (uint64_t bound : kTransactionLatencyBucketBoundsMs) {
+    g_variant_builder_add(&bounds, "t", static_cast<guint64>(bound));
+  }
+
+  GVariantBuilder latencies;
+  g_variant_builder_init(&latencies, G_VARIANT_TYPE("a{sv}"));
+  for (const auto &[name, histogram] : service->statistics.snapshot()) {
+    GVariantBuilder buckets;
+    g_variant_builder_init(&buckets, G_VARIANT_TYPE("at"));
+    for (uint64_t bucket : histogram.buckets) {
+      g_variant_builder_add(&buckets, "t", static_cast<guint64>(bucket));
+    }
+
+    GVariantBuilder entry;
+    g_variant_builder_init(&entry, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&entry, "{sv}", "count", g_variant_new_uint64(histogram.count));
+    g_variant_builder_add(&entry, "{sv}", "sum-us", g_variant_new_uint64(histogram.sum_us));
+    g_variant_builder_add(&entry, "{sv}", "max-us", g_variant_new_uint64(histogram.max_us));
+    g_variant_builder_add(&entry, "{sv}", "buckets", g_variant_builder_end(&buckets));
+    g_variant_builder_add(&latencies, "{sv}", name.c_str(), g_variant_builder_end(&entry));
+  }
+
+  GVariantBuilder statistics;
+  g_variant_builder_init(&statistics, G_VARIANT_TYPE("a{sv}"));
+  g_variant_builder_add(&statistics, "{sv}", "sessions", g_variant_new_uint32(service->transactions.size()));
+  g_variant_builder_add(&statistics, "{sv}", "active-sessions", g_variant_new_uint32(active_sessions));
+  g_variant_builder_add(&statistics, "{sv}", "queued-previews", g_variant_new_uint32(queued_previews));
+  g_variant_builder_add(
+      &statistics, "{sv}", "peak-rss-kib", g_variant_new_uint64(static_cast<guint64>(usage.ru_maxrss)));
+  g_variant_builder_add(&statistics, "{sv}", "bucket-bounds-ms", g_variant_builder_end(&bounds));
+  g_variant_builder_add(&statistics, "{sv}", "latencies", g_variant_builder_end(&latencies));
+  return g_variant_builder_end(&statistics);
+}
+
+// -----------------------------------------------------------------------------
+// Return true when owner_name already holds a live bulk request.
+// -----------------------------------------------------------------------------
+static bool
+service_bulk_request_limit_reached(TransactionService *service, const std::string &owner_name, std::string &error_out)
+{
+  size_t owner_count = 0;
+  for (const auto &[path, session] : service->transactions) {
+    (void)path;
+    if (session && session->owner_name == owner_name && session->bulk) {
+      owner_count++;
+    }
+  }
+
+  if (owner_count >= kMaxLiveBulkSessionsPerClient) {
+    error_out = _("This client already has an active bulk transaction request.");
+    return true;
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Read the request of a StartTransactionFd call from the fd it carries.
+// -----------------------------------------------------------------------------
+static bool
+read_transaction_request_fd(GDBusMethodInvocation *invocation,
+                            GVariant *parameters,
+                            TransactionRequest &request_out,
+                            std::string &error_out)
+{
+  GUnixFDList *fd_list = g_dbus_message_get_unix_fd_list(g_dbus_method_invocation_get_message(invocation));
+  gint32 handle = -1;
+  g_variant_get(parameters, "(h)", &handle);
+  if (!fd_list || handle < 0 || handle >= g_unix_fd_list_get_length(fd_list)) {
+    error_out = _("The bulk transaction request carries no fd.");
+    return false;
+  }
+
+  GError *error = nullptr;
+  const int fd = g_unix_fd_list_get(fd_list, handle, &error);
+  if (fd < 0) {
+    error_out = error ? error->message : _("The bulk transaction request carries no fd.");
+    g_clear_error(&error);
+    return false;
+  }
+
+  const bool ok = transaction_request_payload_read_memfd(fd, request_out, error_out);
+  close(fd);
+  return ok;
+}
+
 // -----------------------------------------------------------------------------
 // Manager object handling
 // -----------------------------------------------------------------------------
-// Handle StartTransaction calls on the transaction service manager object.
+// Handle StartTransaction, StartTransactionFd, GetDiagnostics, GetStatistics,
+// Warmup, and the read-only package query calls on the transaction service
+// manager object.
 // -----------------------------------------------------------------------------
 static void
 on_manager_method_call(GDBusConnection *,
@@ -1411,18 +2588,50 @@ on_manager_method_call(GDBusConnection *,
         invocation, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, "%s", _("Service is not available."));
     return;
   }
+  note_service_activity(service);
+
+  if (g_strcmp0(interface_name, kManagerInterface) == 0 && g_strcmp0(method_name, "GetDiagnostics") == 0) {
+    // Read-only counters, so no Polkit check or session is needed.
+    const std::string report = BaseManager::instance().diagnostics_report();
+    g_dbus_method_invocation_return_value(invocation, g_variant_new("(s)", report.c_str()));
+    return;
+  }
+
+  if (g_strcmp0(interface_name, kManagerInterface) == 0 && g_strcmp0(method_name, "GetStatistics") == 0) {
+    // Read-only counters like GetDiagnostics, so no Polkit check is needed.
+    g_dbus_method_invocation_return_value(invocation, g_variant_new("(@a{sv})", build_service_statistics(service)));
+    return;
+  }
+
+  if (g_strcmp0(interface_name, kManagerInterface) == 0 &&
+      (g_strcmp0(method_name, "SearchPackages") == 0 || g_strcmp0(method_name, "ListPackages") == 0 ||
+       g_strcmp0(method_name, "GetPackageDetails") == 0)) {
+    // Read-only like GetDiagnostics, so no Polkit check or session is needed.
+    start_service_query(service, method_name, parameters, invocation);
+    return;
+  }
+
+  if (g_strcmp0(interface_name, kManagerInterface) == 0 && g_strcmp0(method_name, "Warmup") == 0) {
+    // Loading the Base changes no system state, so no Polkit check is needed.
+    // Repeated calls while a load runs are ignored.
+    start_base_warmup(service);
+    g_dbus_method_invocation_return_value(invocation, nullptr);
+    return;
+  }
 
   if (g_strcmp0(interface_name, kManagerInterface) != 0 ||
-      (g_strcmp0(method_name, "StartTransaction") != 0 && g_strcmp0(method_name, "StartUpgradeAllTransaction") != 0)) {
+      (g_strcmp0(method_name, "StartTransaction") != 0 && g_strcmp0(method_name, "StartTransactionFd") != 0 &&
+       g_strcmp0(method_name, "StartUpgradeAllTransaction") != 0)) {
     g_dbus_method_invocation_return_error(
         invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD, "%s", _("Unknown method."));
     return;
   }
 
+  const bool bulk = g_strcmp0(method_name, "StartTransactionFd") == 0;
   TransactionRequest request;
   if (g_strcmp0(method_name, "StartUpgradeAllTransaction") == 0) {
     request.upgrade_all = true;
-  } else {
+  } else if (!bulk) {
     request = transaction_service_request_from_variant(parameters);
   }
   std::string error_out;
@@ -1433,7 +2642,22 @@ on_manager_method_call(GDBusConnection *,
     return;
   }
 
-  if (!request.validate(error_out)) {
+  if (bulk) {
+    // Check the limits before reading, so a client that is already at its
+    // limit cannot make the service parse more payloads.
+    if (service_request_limit_reached(service, owner_name, error_out) ||
+        service_bulk_request_limit_reached(service, owner_name, error_out)) {
+      g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, "%s", error_out.c_str());
+      return;
+    }
+    if (!read_transaction_request_fd(invocation, parameters, request, error_out)) {
+      g_dbus_method_invocation_return_error(
+          invocation, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS, "%s", error_out.c_str());
+      return;
+    }
+  }
+
+  if (!request.validate(error_out, bulk ? kTransactionRequestMaxBulkItems : kTransactionRequestMaxItems)) {
     g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS, "%s", error_out.c_str());
     return;
   }
@@ -1448,17 +2672,19 @@ on_manager_method_call(GDBusConnection *,
     return;
   }
 
-  DNFUI_TRACE("Transaction service start install=%zu remove=%zu reinstall=%zu upgrade_all=%d",
+  DNFUI_TRACE("Transaction service start install=%zu remove=%zu reinstall=%zu upgrade_all=%d bulk=%d",
               request.install.size(),
               request.remove.size(),
               request.reinstall.size(),
-              request.upgrade_all ? 1 : 0);
+              request.upgrade_all ? 1 : 0,
+              bulk ? 1 : 0);
 
   TransactionSession *session = create_transaction_session(service, request, owner_name, error_out);
   if (!session) {
     g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, "%s", error_out.c_str());
     return;
   }
+  session->bulk = bulk;
 
   g_dbus_method_invocation_return_value(invocation, g_variant_new("(o)", session->object_path.c_str()));
   // Queue the preview start after the request object is returned to the caller.
@@ -1521,6 +2747,8 @@ on_bus_acquired(GDBusConnection *connection, const gchar *, gpointer user_data)
   }
 
   DNFUI_TRACE("Transaction service bus ready");
+  // A service that was activated but never called still exits.
+  note_service_activity(service);
 }
 
 // -----------------------------------------------------------------------------
@@ -1549,6 +2777,36 @@ cleanup_service(TransactionService &service)
   service.shutting_down = true;
   bool keep_alive_until_exit = false;
 
+  // Queued previews have not started, so they are dropped instead of waited on.
+  {
+    std::lock_guard<std::mutex> lock(service.preview_queue_mutex);
+    for (TransactionSession *session : service.preview_queue) {
+      session->cancelled = true;
+    }
+    service.preview_queue.clear();
+  }
+  if (service.preview_pool) {
+    // Running workers keep going, so their state follows the keep-alive rule
+    // below instead of being waited on here.
+    g_thread_pool_free(service.preview_pool, TRUE, FALSE);
+    service.preview_pool = nullptr;
+  }
+
+  // A warm up, background preview, or query thread still holds the raw service
+  // pointer.
+  if (service.speculation_timer_id != 0) {
+    g_source_remove(service.speculation_timer_id);
+    service.speculation_timer_id = 0;
+  }
+  service.speculation_cancel = true;
+  if (service.idle_exit_timer_id != 0) {
+    g_source_remove(service.idle_exit_timer_id);
+    service.idle_exit_timer_id = 0;
+  }
+  if (service.warmup_running.load() || service.speculation_running.load() || service.queries_running.load() != 0) {
+    keep_alive_until_exit = true;
+  }
+
   // Reply to any pending authorization requests with an error before destroying sessions.
   for (auto &[path, session] : service.transactions) {
     GDBusMethodInvocation *pending_apply_invocation = nullptr;
@@ -1573,9 +2831,17 @@ cleanup_service(TransactionService &service)
       keep_alive_until_exit = true;
       session->cancelled = true;
     }
+
+    session->prefetch_cancel = true;
+    if (transaction_prefetch_running(session.get())) {
+      keep_alive_until_exit = true;
+    }
   }
 
   for (auto &[path, session] : service.transactions) {
+    // Lines still waiting for a flush have no listener left to receive them.
+    take_transaction_progress(session.get(), true);
+
     if (session->owner_watch_id != 0) {
       g_bus_unwatch_name(session->owner_watch_id);
       session->owner_watch_id = 0;
@@ -1634,10 +2900,24 @@ transaction_service_run(const TransactionServiceOptions &options)
 {
   auto service = std::make_unique<TransactionService>();
   service->bus_type = options.bus_type;
+  service->speculative_upgrade_all = options.speculative_upgrade_all;
+  service->prefetch_packages = options.prefetch_packages;
+  service->idle_exit_ms = options.idle_exit_ms;
   service->loop = g_main_loop_new(nullptr, FALSE);
   service->main_context = g_main_loop_get_context(service->loop);
 
   GError *error = nullptr;
+  service->preview_pool =
+      g_thread_pool_new(run_queued_transaction_preview, service.get(), kMaxPreviewWorkers, TRUE, &error);
+  if (!service->preview_pool) {
+    std::fputs(
+        dnfui_i18n_format(_("Failed to start preview workers: %s\n"), error ? error->message : _("unknown")).c_str(),
+        stderr);
+    g_clear_error(&error);
+    cleanup_service(*service);
+    return 1;
+  }
+
   service->manager_node_info = g_dbus_node_info_new_for_xml(kTransactionServiceManagerIntrospectionXml, &error);
   if (!service->manager_node_info) {
     std::fputs(
@@ -13,6 +13,12 @@
 // -----------------------------------------------------------------------------
 struct TransactionServiceOptions {
   GBusType bus_type = G_BUS_TYPE_SESSION;
+  // Resolve upgrade-all in the background while the service is idle.
+  bool speculative_upgrade_all = false;
+  // Download the packages of a ready preview before Apply is called.
+  bool prefetch_packages = false;
+  // Exit after this many milliseconds without requests, or keep running when 0.
+  unsigned idle_exit_ms = 0;
 };
 
 // -----------------------------------------------------------------------------
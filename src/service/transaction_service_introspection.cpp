@@ -14,9 +14,42 @@ const char kTransactionServiceManagerIntrospectionXml[] = R"XML(
       <arg name="reinstall" type="as" direction="in"/>
       <arg name="transaction_path" type="o" direction="out"/>
     </method>
+    <method name="StartTransactionFd">
+      <arg name="request" type="h" direction="in"/>
+      <arg name="transaction_path" type="o" direction="out"/>
+    </method>
     <method name="StartUpgradeAllTransaction">
       <arg name="transaction_path" type="o" direction="out"/>
     </method>
+    <method name="GetDiagnostics">
+      <arg name="report" type="s" direction="out"/>
+    </method>
+    <method name="GetStatistics">
+      <arg name="statistics" type="a{sv}" direction="out"/>
+    </method>
+    <method name="Warmup"/>
+    <method name="SearchPackages">
+      <arg name="pattern" type="s" direction="in"/>
+      <arg name="search_in_description" type="b" direction="in"/>
+      <arg name="exact_match" type="b" direction="in"/>
+      <arg name="offset" type="u" direction="in"/>
+      <arg name="limit" type="u" direction="in"/>
+      <arg name="rows" type="a(ssssssssyyy)" direction="out"/>
+      <arg name="total" type="u" direction="out"/>
+      <arg name="generation" type="t" direction="out"/>
+    </method>
+    <method name="ListPackages">
+      <arg name="view" type="s" direction="in"/>
+      <arg name="offset" type="u" direction="in"/>
+      <arg name="limit" type="u" direction="in"/>
+      <arg name="rows" type="a(ssssssssyyy)" direction="out"/>
+      <arg name="total" type="u" direction="out"/>
+      <arg name="generation" type="t" direction="out"/>
+    </method>
+    <method name="GetPackageDetails">
+      <arg name="nevra" type="s" direction="in"/>
+      <arg name="details" type="s" direction="out"/>
+    </method>
   </interface>
 </node>
 )XML";
@@ -35,6 +68,9 @@ const char kTransactionServiceRequestIntrospectionXml[] = R"XML(
       <arg name="remove" type="as" direction="out"/>
       <arg name="disk_space_delta" type="x" direction="out"/>
     </method>
+    <method name="GetPreviewFd">
+      <arg name="preview" type="h" direction="out"/>
+    </method>
     <method name="GetResult">
       <arg name="stage" type="s" direction="out"/>
       <arg name="finished" type="b" direction="out"/>
@@ -44,6 +80,15 @@ const char kTransactionServiceRequestIntrospectionXml[] = R"XML(
     <signal name="Progress">
       <arg name="line" type="s"/>
     </signal>
+    <signal name="ProgressBatch">
+      <arg name="lines" type="as"/>
+    </signal>
+    <signal name="DownloadProgress">
+      <arg name="bytes_done" type="t"/>
+      <arg name="bytes_total" type="t"/>
+      <arg name="bytes_per_second" type="t"/>
+      <arg name="active_downloads" type="u"/>
+    </signal>
     <signal name="Finished">
       <arg name="stage" type="s"/>
       <arg name="success" type="b"/>
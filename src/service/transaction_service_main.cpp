@@ -6,10 +6,55 @@
 // -----------------------------------------------------------------------------
 #include "transaction_service.hpp"
 
+#include "debug_trace.hpp"
 #include "i18n.hpp"
+#include "trace_spans.hpp"
 
 #include <cstdio>
 #include <cstring>
+#include <string_view>
+
+#include <glib.h>
+
+// Option prefix followed by the idle timeout in seconds.
+static constexpr std::string_view kIdleExitOption = "--idle-exit=";
+
+// -----------------------------------------------------------------------------
+// Parse --idle-exit=SECONDS into milliseconds. SECONDS is a decimal number with
+// up to three fraction digits, such as 600 or 0.2. Returns false for anything
+// else.
+// -----------------------------------------------------------------------------
+static bool
+parse_idle_exit_ms(const char *text, unsigned &ms_out)
+{
+  if (!text || !g_ascii_isdigit(*text)) {
+    return false;
+  }
+
+  char *end = nullptr;
+  const guint64 seconds = g_ascii_strtoull(text, &end, 10);
+  if (!end || seconds > G_MAXUINT / 1000) {
+    return false;
+  }
+
+  guint64 ms = seconds * 1000;
+  const char *rest = end;
+  if (*rest == '.') {
+    ++rest;
+    if (!g_ascii_isdigit(*rest)) {
+      return false;
+    }
+    for (guint64 scale = 100; scale > 0 && g_ascii_isdigit(*rest); scale /= 10, ++rest) {
+      ms += static_cast<guint64>(*rest - '0') * scale;
+    }
+  }
+  if (*rest != '\0' || ms > G_MAXUINT) {
+    return false;
+  }
+
+  ms_out = static_cast<unsigned>(ms);
+  return true;
+}
 
 // -----------------------------------------------------------------------------
 // Transaction service main entrypoint
@@ -18,6 +63,8 @@ int
 main(int argc, char **argv)
 {
   dnfui_i18n_init();
+  debug_trace_init();
+  trace_spans_init("dnfui-service");
 
   TransactionServiceOptions options;
 
@@ -26,8 +73,19 @@ main(int argc, char **argv)
       options.bus_type = G_BUS_TYPE_SYSTEM;
     } else if (std::strcmp(argv[i], "--session") == 0) {
       options.bus_type = G_BUS_TYPE_SESSION;
+    } else if (std::strcmp(argv[i], "--speculative-upgrade-all") == 0) {
+      options.speculative_upgrade_all = true;
+    } else if (std::strcmp(argv[i], "--prefetch-packages") == 0) {
+      options.prefetch_packages = true;
+    } else if (std::string_view(argv[i]).starts_with(kIdleExitOption)) {
+      const char *seconds = argv[i] + kIdleExitOption.size();
+      if (!parse_idle_exit_ms(seconds, options.idle_exit_ms)) {
+        std::fputs(dnfui_i18n_format(_("Invalid idle timeout: %s\n"), seconds).c_str(), stderr);
+        return 1;
+      }
     } else if (std::strcmp(argv[i], "--help") == 0) {
-      std::puts(_("Usage: dnfui-service [--session] [--system]"));
+      std::puts(_("Usage: dnfui-service [--session] [--system] [--speculative-upgrade-all] [--prefetch-packages] "
+                  "[--idle-exit=SECONDS]"));
       return 0;
     } else {
       std::fputs(dnfui_i18n_format(_("Unknown option: %s\n"), argv[i]).c_str(), stderr);
@@ -35,5 +93,7 @@ main(int argc, char **argv)
     }
   }
 
-  return transaction_service_run(options);
+  const int status = transaction_service_run(options);
+  trace_spans_write();
+  return status;
 }
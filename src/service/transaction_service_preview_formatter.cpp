@@ -60,10 +60,10 @@ append_transaction_preview_section(std::ostringstream &summary,
 }
 
 // -----------------------------------------------------------------------------
-// Format the full resolved transaction preview as a readable summary string.
+// Format the package counts and disk space change of the preview.
 // -----------------------------------------------------------------------------
 std::string
-format_transaction_preview_details(const TransactionPreview &preview)
+format_transaction_preview_counts(const TransactionPreview &preview)
 {
   std::ostringstream summary;
 
@@ -83,7 +83,18 @@ format_transaction_preview_details(const TransactionPreview &preview)
   append_count_line(preview.downgrade.size(), "%zu package will be downgraded.", "%zu packages will be downgraded.");
   append_count_line(preview.reinstall.size(), "%zu package will be reinstalled.", "%zu packages will be reinstalled.");
   append_count_line(preview.remove.size(), "%zu package will be removed.", "%zu packages will be removed.");
-  summary << format_transaction_preview_space_change(preview.disk_space_delta) << "\n\n";
+  summary << format_transaction_preview_space_change(preview.disk_space_delta) << "\n";
+  return summary.str();
+}
+
+// -----------------------------------------------------------------------------
+// Format the full resolved transaction preview as a readable summary string.
+// -----------------------------------------------------------------------------
+std::string
+format_transaction_preview_details(const TransactionPreview &preview)
+{
+  std::ostringstream summary;
+  summary << format_transaction_preview_counts(preview) << "\n";
 
   append_transaction_preview_section(summary, _("To be installed"), preview.install);
   append_transaction_preview_section(summary, _("To be upgraded"), preview.upgrade);
@@ -93,3 +104,18 @@ format_transaction_preview_details(const TransactionPreview &preview)
 
   return summary.str();
 }
+
+// -----------------------------------------------------------------------------
+// Keep large package lists out of the Finished signal, which every bus peer
+// subscribed to the request object receives.
+// -----------------------------------------------------------------------------
+std::string
+format_transaction_preview_result_details(const TransactionPreview &preview)
+{
+  const size_t items = preview.install.size() + preview.upgrade.size() + preview.downgrade.size() +
+                       preview.reinstall.size() + preview.remove.size();
+  if (items > kTransactionPreviewInlineItemLimit) {
+    return format_transaction_preview_counts(preview);
+  }
+  return format_transaction_preview_details(preview);
+}
@@ -6,11 +6,28 @@
 // -----------------------------------------------------------------------------
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 struct TransactionPreview;
 
+// Previews with more package items than this report only counts in the
+// Finished and GetResult details. Clients read the package lists through
+// GetPreviewFd or GetPreview instead, so they cross the bus once.
+inline constexpr size_t kTransactionPreviewInlineItemLimit = 64;
+
 // -----------------------------------------------------------------------------
 // Format the full resolved transaction preview as a readable summary string.
 // -----------------------------------------------------------------------------
 std::string format_transaction_preview_details(const TransactionPreview &preview);
+
+// -----------------------------------------------------------------------------
+// Format only the package counts and disk space change of the preview.
+// -----------------------------------------------------------------------------
+std::string format_transaction_preview_counts(const TransactionPreview &preview);
+
+// -----------------------------------------------------------------------------
+// Format the details sent with a ready preview: the full summary for small
+// previews and only the counts above kTransactionPreviewInlineItemLimit.
+// -----------------------------------------------------------------------------
+std::string format_transaction_preview_result_details(const TransactionPreview &preview);
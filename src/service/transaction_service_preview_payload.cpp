@@ -0,0 +1,310 @@
+// -----------------------------------------------------------------------------
+// transaction_service_preview_payload.cpp
+// Transaction preview bulk transfer
+// Keeps the payload format and memfd handling away from the D-Bus code shared
+// by the service and the GUI client.
+// -----------------------------------------------------------------------------
+#include "service/transaction_service_preview_payload.hpp"
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// First line of every payload. Bump the version when the format changes.
+constexpr std::string_view kPayloadHeader = "dnfui-preview 2";
+
+// Seals a payload fd must carry before its contents are trusted.
+constexpr int kPayloadSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+
+// Separates the fields of one item line. None of the fields contain tabs.
+constexpr char kFieldSeparator = '\t';
+
+// Payload names of the preview actions, indexed by TransactionPreviewAction.
+constexpr std::string_view kActionNames[] = { "install", "upgrade", "downgrade", "reinstall", "remove" };
+static_assert(std::size(kActionNames) == static_cast<size_t>(TransactionPreviewAction::REMOVE) + 1);
+
+// Payload names of the install reasons, indexed by PackageInstallReason.
+constexpr std::string_view kReasonNames[] = {
+  "unknown",
+  "dependency",
+  "user",
+  "clean",
+  "weak-dependency",
+  "group",
+  "external",
+};
+static_assert(std::size(kReasonNames) == static_cast<size_t>(PackageInstallReason::EXTERNAL) + 1);
+
+// -----------------------------------------------------------------------------
+// Look up one payload name. Returns false for names this version does not know.
+// -----------------------------------------------------------------------------
+template <typename Enum, size_t N>
+bool
+enum_from_name(const std::string_view (&names)[N], std::string_view name, Enum &value)
+{
+  for (size_t i = 0; i < N; ++i) {
+    if (names[i] == name) {
+      value = static_cast<Enum>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Parse one unsigned decimal number that spans the whole field.
+// -----------------------------------------------------------------------------
+bool
+parse_unsigned(std::string_view field, uint64_t &value)
+{
+  if (field.empty()) {
+    return false;
+  }
+  const std::string text(field);
+  char *end = nullptr;
+  errno = 0;
+  const unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+  if (errno != 0 || !end || *end != '\0' || text.front() == '-') {
+    return false;
+  }
+  value = static_cast<uint64_t>(parsed);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Append one "action reason download install repo nevra" item line.
+// -----------------------------------------------------------------------------
+void
+append_item(std::string &payload, const TransactionPreviewItem &item)
+{
+  payload += kActionNames[static_cast<size_t>(item.action)];
+  payload += kFieldSeparator;
+  payload += kReasonNames[static_cast<size_t>(item.reason)];
+  payload += kFieldSeparator;
+  payload += std::to_string(item.download_size);
+  payload += kFieldSeparator;
+  payload += std::to_string(item.install_size);
+  payload += kFieldSeparator;
+  payload += item.repo;
+  payload += kFieldSeparator;
+  payload += item.nevra;
+  payload += '\n';
+}
+
+// -----------------------------------------------------------------------------
+// Parse one item line written by append_item.
+// -----------------------------------------------------------------------------
+bool
+parse_item(std::string_view line, TransactionPreviewItem &item)
+{
+  std::string_view fields[6];
+  for (size_t i = 0; i < 5; ++i) {
+    const size_t end = line.find(kFieldSeparator);
+    if (end == std::string_view::npos) {
+      return false;
+    }
+    fields[i] = line.substr(0, end);
+    line.remove_prefix(end + 1);
+  }
+  fields[5] = line;
+
+  if (!enum_from_name(kActionNames, fields[0], item.action) || !enum_from_name(kReasonNames, fields[1], item.reason) ||
+      !parse_unsigned(fields[2], item.download_size) || !parse_unsigned(fields[3], item.install_size) ||
+      fields[5].empty()) {
+    return false;
+  }
+
+  item.repo = std::string(fields[4]);
+  item.nevra = std::string(fields[5]);
+  return true;
+}
+
+// Sequential line reader over one payload buffer.
+struct PayloadReader {
+  std::string_view rest;
+
+  // -----------------------------------------------------------------------------
+  // Take the next line without its terminator. Fails on a missing terminator.
+  // -----------------------------------------------------------------------------
+  bool next_line(std::string_view &line)
+  {
+    const size_t end = rest.find('\n');
+    if (end == std::string_view::npos) {
+      return false;
+    }
+    line = rest.substr(0, end);
+    rest.remove_prefix(end + 1);
+    return true;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Read one "name value" line and parse value as a decimal number.
+  // -----------------------------------------------------------------------------
+  bool next_field(std::string_view name, long long &value)
+  {
+    std::string_view line;
+    if (!next_line(line) || line.size() <= name.size() + 1 || line.substr(0, name.size()) != name ||
+        line[name.size()] != ' ') {
+      return false;
+    }
+
+    const std::string text(line.substr(name.size() + 1));
+    char *end = nullptr;
+    errno = 0;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return errno == 0 && end && *end == '\0';
+  }
+
+  // -----------------------------------------------------------------------------
+  // Read the item count and the items, adding each to preview.
+  // -----------------------------------------------------------------------------
+  bool next_items(TransactionPreview &preview)
+  {
+    long long count = 0;
+    if (!next_field("items", count) || count < 0 || static_cast<unsigned long long>(count) > rest.size()) {
+      return false;
+    }
+
+    preview.items.reserve(static_cast<size_t>(count));
+    for (long long i = 0; i < count; ++i) {
+      std::string_view line;
+      TransactionPreviewItem item;
+      if (!next_line(line) || !parse_item(line, item)) {
+        return false;
+      }
+      preview.add_item(std::move(item));
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Write the header, the disk space delta, and one line per item. The label
+// lists are not written, since the reader rebuilds them from the items.
+// -----------------------------------------------------------------------------
+std::string
+transaction_preview_payload_encode(const TransactionPreview &preview)
+{
+  std::string payload(kPayloadHeader);
+  payload += '\n';
+  payload += "disk-space-delta " + std::to_string(preview.disk_space_delta) + "\n";
+  payload += "items " + std::to_string(preview.items.size()) + "\n";
+  for (const auto &item : preview.items) {
+    append_item(payload, item);
+  }
+  return payload;
+}
+
+// -----------------------------------------------------------------------------
+// Read the items back and rebuild the per-action label lists from them.
+// -----------------------------------------------------------------------------
+bool
+transaction_preview_payload_decode(const char *data, size_t size, TransactionPreview &preview_out)
+{
+  preview_out = TransactionPreview();
+  if (!data) {
+    return false;
+  }
+
+  PayloadReader reader { std::string_view(data, size) };
+  std::string_view header;
+  long long disk_space_delta = 0;
+  TransactionPreview preview;
+  if (!reader.next_line(header) || header != kPayloadHeader ||
+      !reader.next_field("disk-space-delta", disk_space_delta) || !reader.next_items(preview) ||
+      !reader.rest.empty()) {
+    return false;
+  }
+
+  preview.disk_space_delta = disk_space_delta;
+  preview_out = std::move(preview);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Create, fill, and seal one memfd.
+// -----------------------------------------------------------------------------
+int
+transaction_preview_payload_create_memfd(const std::string &payload, std::string &error_out)
+{
+  error_out.clear();
+  const int fd = memfd_create("dnfui-preview", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    error_out = std::string("memfd_create failed: ") + std::strerror(errno);
+    return -1;
+  }
+
+  size_t written = 0;
+  while (written < payload.size()) {
+    const ssize_t n = write(fd, payload.data() + written, payload.size() - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      error_out = std::string("Writing the preview payload failed: ") + std::strerror(errno);
+      close(fd);
+      return -1;
+    }
+    written += static_cast<size_t>(n);
+  }
+
+  if (fcntl(fd, F_ADD_SEALS, kPayloadSeals) != 0 || lseek(fd, 0, SEEK_SET) != 0) {
+    error_out = std::string("Sealing the preview payload failed: ") + std::strerror(errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// -----------------------------------------------------------------------------
+// Check the seals, map the fd read-only, and decode the mapping.
+// -----------------------------------------------------------------------------
+bool
+transaction_preview_payload_read_memfd(int fd, TransactionPreview &preview_out, std::string &error_out)
+{
+  preview_out = TransactionPreview();
+  error_out.clear();
+
+  const int seals = fcntl(fd, F_GET_SEALS);
+  if (seals < 0 || (seals & kPayloadSeals) != kPayloadSeals) {
+    error_out = "The preview payload is not sealed.";
+    return false;
+  }
+
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+      static_cast<unsigned long long>(st.st_size) > kTransactionPreviewPayloadMaxBytes) {
+    error_out = "The preview payload has an invalid size.";
+    return false;
+  }
+
+  const size_t size = static_cast<size_t>(st.st_size);
+  void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    error_out = std::string("Mapping the preview payload failed: ") + std::strerror(errno);
+    return false;
+  }
+
+  const bool ok = transaction_preview_payload_decode(static_cast<const char *>(data), size, preview_out);
+  munmap(data, size);
+  if (!ok) {
+    error_out = "The preview payload is malformed.";
+  }
+  return ok;
+}
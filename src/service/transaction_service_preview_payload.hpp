@@ -0,0 +1,43 @@
+// -----------------------------------------------------------------------------
+// transaction_service_preview_payload.hpp
+// Transaction preview bulk transfer
+// Encodes a resolved preview once into a sealed memfd that the service passes
+// to the requesting client as a Unix fd, so large package lists cross the bus
+// only once and only to that client.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+struct TransactionPreview;
+
+// Largest payload a client maps. Bounds what a misbehaving peer can make the
+// client read.
+inline constexpr size_t kTransactionPreviewPayloadMaxBytes = 64 * 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+// Encode preview as a line-based payload with one tab-separated line per
+// item. Package strings never contain line breaks or tabs.
+// -----------------------------------------------------------------------------
+std::string transaction_preview_payload_encode(const TransactionPreview &preview);
+
+// -----------------------------------------------------------------------------
+// Decode one payload written by transaction_preview_payload_encode and rebuild
+// the per-action label lists. Returns false and leaves preview_out empty when
+// the payload is malformed or uses another format version.
+// -----------------------------------------------------------------------------
+bool transaction_preview_payload_decode(const char *data, size_t size, TransactionPreview &preview_out);
+
+// -----------------------------------------------------------------------------
+// Write payload into a new memfd and seal it against any further change.
+// Returns the fd positioned at the start, or -1 with error_out set.
+// -----------------------------------------------------------------------------
+int transaction_preview_payload_create_memfd(const std::string &payload, std::string &error_out);
+
+// -----------------------------------------------------------------------------
+// Map a sealed payload fd read-only and decode it. Fds that are not sealed
+// against writes are rejected, since the sender could change them while they
+// are read. Does not close fd.
+// -----------------------------------------------------------------------------
+bool transaction_preview_payload_read_memfd(int fd, TransactionPreview &preview_out, std::string &error_out);
@@ -0,0 +1,62 @@
+// -----------------------------------------------------------------------------
+// transaction_service_progress_batch.cpp
+// Transaction service progress line batching
+// Keeps the coalescing rules separate from the D-Bus signal scheduling.
+// -----------------------------------------------------------------------------
+#include "service/transaction_service_progress_batch.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Prefix of the percentage lines written by the backend download callbacks.
+static constexpr const char *kDownloadProgressPrefix = "Download progress: ";
+
+// -----------------------------------------------------------------------------
+// Return the download name of a percentage line, or an empty string when the
+// line is not one.
+// -----------------------------------------------------------------------------
+static std::string
+download_progress_key(const std::string &line)
+{
+  const std::string prefix(kDownloadProgressPrefix);
+  if (line.compare(0, prefix.size(), prefix) != 0 || line.empty() || line.back() != ')') {
+    return {};
+  }
+
+  const size_t percent_start = line.rfind(" (");
+  if (percent_start == std::string::npos || percent_start < prefix.size()) {
+    return {};
+  }
+  return line.substr(prefix.size(), percent_start - prefix.size());
+}
+
+// -----------------------------------------------------------------------------
+// Add one line, replacing an older percentage line of the same download.
+// -----------------------------------------------------------------------------
+void
+TransactionProgressBatch::append(const std::string &line)
+{
+  const std::string key = download_progress_key(line);
+  if (!key.empty()) {
+    for (auto &pending : lines) {
+      if (download_progress_key(pending) == key) {
+        pending = line;
+        return;
+      }
+    }
+  }
+
+  lines.push_back(line);
+}
+
+// -----------------------------------------------------------------------------
+// Hand the pending lines to the caller.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+TransactionProgressBatch::take()
+{
+  std::vector<std::string> taken;
+  taken.swap(lines);
+  return taken;
+}
@@ -0,0 +1,42 @@
+// -----------------------------------------------------------------------------
+// transaction_service_progress_batch.hpp
+// Transaction service progress line batching
+// Collects the progress lines queued by worker threads between two flushes so
+// the service sends them as one D-Bus signal instead of one signal per line.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Shortest interval between two progress flushes of one request object.
+inline constexpr unsigned kTransactionProgressBatchIntervalMs = 100;
+
+// -----------------------------------------------------------------------------
+// Pending progress lines for one transaction request object. Not thread safe;
+// the service guards each batch with its session progress mutex.
+// -----------------------------------------------------------------------------
+class TransactionProgressBatch {
+  public:
+  // -----------------------------------------------------------------------------
+  // Add one line. A download percentage line replaces the pending percentage
+  // line of the same download so only the newest value is sent.
+  // -----------------------------------------------------------------------------
+  void append(const std::string &line);
+
+  // -----------------------------------------------------------------------------
+  // Return the pending lines in queue order and leave the batch empty.
+  // -----------------------------------------------------------------------------
+  std::vector<std::string> take();
+
+  // -----------------------------------------------------------------------------
+  // Return true when no line is pending.
+  // -----------------------------------------------------------------------------
+  bool empty() const
+  {
+    return lines.empty();
+  }
+
+  private:
+  std::vector<std::string> lines;
+};
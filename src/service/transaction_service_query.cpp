@@ -0,0 +1,169 @@
+// -----------------------------------------------------------------------------
+// transaction_service_query.cpp
+// Read-only package queries served by the transaction service
+// Keeps the page format shared by the service and the GUI client away from the
+// D-Bus method handling.
+// -----------------------------------------------------------------------------
+#include "service/transaction_service_query.hpp"
+
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+// D-Bus names of the views, indexed by TransactionServicePackageView.
+constexpr std::string_view kViewNames[] = { "installed", "available", "upgradeable" };
+static_assert(std::size(kViewNames) == static_cast<size_t>(TransactionServicePackageView::UPGRADEABLE) + 1);
+
+// -----------------------------------------------------------------------------
+// Convert one wire byte back to Enum when it names a value of this version.
+// -----------------------------------------------------------------------------
+template <typename Enum>
+bool
+enum_from_byte(guchar value, Enum last, Enum &value_out)
+{
+  if (value > static_cast<guchar>(last)) {
+    return false;
+  }
+  value_out = static_cast<Enum>(value);
+  return true;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Map view to its entry in kViewNames.
+// -----------------------------------------------------------------------------
+const char *
+transaction_service_package_view_name(TransactionServicePackageView view)
+{
+  return kViewNames[static_cast<size_t>(view)].data();
+}
+
+// -----------------------------------------------------------------------------
+// Search kViewNames for name.
+// -----------------------------------------------------------------------------
+bool
+transaction_service_package_view_from_name(const char *name, TransactionServicePackageView &view_out)
+{
+  if (!name) {
+    return false;
+  }
+  for (size_t i = 0; i < std::size(kViewNames); ++i) {
+    if (kViewNames[i] == name) {
+      view_out = static_cast<TransactionServicePackageView>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Write one tuple per row. Rows without a state are sent as AVAILABLE.
+// -----------------------------------------------------------------------------
+GVariant *
+transaction_service_package_page_to_variant(const TransactionServicePackagePage &page)
+{
+  GVariantBuilder rows;
+  g_variant_builder_init(&rows, G_VARIANT_TYPE("a(ssssssssyyy)"));
+  for (size_t i = 0; i < page.rows.size(); ++i) {
+    const PackageRow &row = page.rows[i];
+    const PackageInstallState state = i < page.states.size() ? page.states[i] : PackageInstallState::AVAILABLE;
+    g_variant_builder_add(&rows,
+                          "(ssssssssyyy)",
+                          row.nevra.c_str(),
+                          row.name.c_str(),
+                          row.epoch.c_str(),
+                          row.version.c_str(),
+                          row.release.c_str(),
+                          row.arch.c_str(),
+                          row.repo.c_str(),
+                          row.summary.c_str(),
+                          static_cast<guchar>(row.install_reason),
+                          static_cast<guchar>(row.repo_candidate_relation),
+                          static_cast<guchar>(state));
+  }
+
+  return g_variant_new(kTransactionServicePackagePageType,
+                       &rows,
+                       static_cast<guint32>(page.total),
+                       static_cast<guint64>(page.generation));
+}
+
+// -----------------------------------------------------------------------------
+// Read the rows back, interning the few distinct epoch, arch, and repo values
+// like backend rows do.
+// -----------------------------------------------------------------------------
+bool
+transaction_service_package_page_from_variant(GVariant *value, TransactionServicePackagePage &page_out)
+{
+  page_out = TransactionServicePackagePage();
+  if (!value || !g_variant_is_of_type(value, G_VARIANT_TYPE(kTransactionServicePackagePageType))) {
+    return false;
+  }
+
+  GVariantIter *rows = nullptr;
+  guint32 total = 0;
+  guint64 generation = 0;
+  g_variant_get(value, kTransactionServicePackagePageType, &rows, &total, &generation);
+
+  TransactionServicePackagePage page;
+  page.rows.reserve(g_variant_iter_n_children(rows));
+  page.states.reserve(g_variant_iter_n_children(rows));
+
+  const gchar *nevra = nullptr;
+  const gchar *name = nullptr;
+  const gchar *epoch = nullptr;
+  const gchar *version = nullptr;
+  const gchar *release = nullptr;
+  const gchar *arch = nullptr;
+  const gchar *repo = nullptr;
+  const gchar *summary = nullptr;
+  guchar reason = 0;
+  guchar relation = 0;
+  guchar state = 0;
+  bool ok = true;
+  while (g_variant_iter_next(rows,
+                             "(&s&s&s&s&s&s&s&syyy)",
+                             &nevra,
+                             &name,
+                             &epoch,
+                             &version,
+                             &release,
+                             &arch,
+                             &repo,
+                             &summary,
+                             &reason,
+                             &relation,
+                             &state)) {
+    PackageRow row;
+    PackageInstallState row_state = PackageInstallState::AVAILABLE;
+    if (!enum_from_byte(reason, PackageInstallReason::EXTERNAL, row.install_reason) ||
+        !enum_from_byte(relation, PackageRepoCandidateRelation::OLDER, row.repo_candidate_relation) ||
+        !enum_from_byte(state, PackageInstallState::INSTALLED_NEWER_THAN_REPO, row_state)) {
+      ok = false;
+      break;
+    }
+
+    row.nevra = PackageString(nevra);
+    row.name = PackageString(name);
+    row.epoch = PackageString::interned(epoch);
+    row.version = PackageString(version);
+    row.release = PackageString(release);
+    row.arch = PackageString::interned(arch);
+    row.repo = PackageString::interned(repo);
+    row.summary = PackageString(summary);
+    page.rows.push_back(std::move(row));
+    page.states.push_back(row_state);
+  }
+  g_variant_iter_free(rows);
+  if (!ok) {
+    return false;
+  }
+
+  page.total = total;
+  page.generation = generation;
+  page_out = std::move(page);
+  return true;
+}
@@ -0,0 +1,67 @@
+// -----------------------------------------------------------------------------
+// transaction_service_query.hpp
+// Read-only package queries served by the transaction service
+// Packs package rows into compact D-Bus pages so clients can search and browse
+// through the warm Base of the service instead of loading their own.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+// D-Bus type of one page: rows, the total row count of the query, and the
+// Base generation the rows were read from.
+inline constexpr const char *kTransactionServicePackagePageType = "(a(ssssssssyyy)ut)";
+
+// Largest page the service returns. Larger limits are clamped, so one call
+// cannot make the service copy a whole repository into one message.
+inline constexpr size_t kTransactionServiceQueryMaxPageRows = 1000;
+
+// Fixed package lists a client can page through.
+enum class TransactionServicePackageView {
+  INSTALLED,
+  AVAILABLE,
+  UPGRADEABLE,
+};
+
+// -----------------------------------------------------------------------------
+// One page of rows read from the service, with the install state of each row
+// as the service classified it.
+// -----------------------------------------------------------------------------
+struct TransactionServicePackagePage {
+  std::vector<PackageRow> rows;
+  // Install state of each row, in row order.
+  std::vector<PackageInstallState> states;
+  size_t offset = 0;
+  size_t total = 0;
+  uint64_t generation = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Return the D-Bus name of view.
+// -----------------------------------------------------------------------------
+const char *transaction_service_package_view_name(TransactionServicePackageView view);
+
+// -----------------------------------------------------------------------------
+// Look up a view by its D-Bus name. Returns false for unknown names.
+// -----------------------------------------------------------------------------
+bool transaction_service_package_view_from_name(const char *name, TransactionServicePackageView &view_out);
+
+// -----------------------------------------------------------------------------
+// Pack page into a floating kTransactionServicePackagePageType value.
+// -----------------------------------------------------------------------------
+GVariant *transaction_service_package_page_to_variant(const TransactionServicePackagePage &page);
+
+// -----------------------------------------------------------------------------
+// Unpack a page built by transaction_service_package_page_to_variant. offset is
+// not part of the reply and is left for the caller to fill in. Returns false
+// and leaves page_out empty when the value has another type or carries enum
+// values this version does not know.
+// -----------------------------------------------------------------------------
+bool transaction_service_package_page_from_variant(GVariant *value, TransactionServicePackagePage &page_out);
@@ -0,0 +1,288 @@
+// -----------------------------------------------------------------------------
+// transaction_service_request_payload.cpp
+// Bulk transaction request transfer
+// Keeps the request payload format and memfd handling away from the D-Bus
+// code shared by the service and the GUI client.
+// -----------------------------------------------------------------------------
+#include "service/transaction_service_request_payload.hpp"
+
+#include "i18n.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// First line of every payload. Bump the version when the format changes.
+constexpr std::string_view kPayloadHeader = "dnfui-request 1";
+
+// Seals a payload fd must carry before its contents are trusted.
+constexpr int kPayloadSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+
+// Separates the action from the package spec.
+constexpr char kFieldSeparator = '\t';
+
+// Longest line the parser buffers: the longest action name, the separator,
+// and the longest allowed spec.
+constexpr size_t kMaxLineLength = kTransactionRequestMaxSpecLength + 16;
+
+// Bytes read from the fd per chunk.
+constexpr size_t kReadChunkBytes = 64 * 1024;
+
+// -----------------------------------------------------------------------------
+// Append one "action spec" line per spec.
+// -----------------------------------------------------------------------------
+void
+append_specs(std::string &payload, std::string_view action, const std::vector<std::string> &specs)
+{
+  for (const auto &spec : specs) {
+    payload += action;
+    payload += kFieldSeparator;
+    payload += spec;
+    payload += '\n';
+  }
+}
+
+// Incremental parser that checks each line as soon as it is complete.
+struct RequestPayloadParser {
+  TransactionRequest request;
+  std::string partial;
+  bool header_seen = false;
+  std::string error;
+
+  // -----------------------------------------------------------------------------
+  // Check and store one complete line.
+  // -----------------------------------------------------------------------------
+  bool take_line(std::string_view line)
+  {
+    if (!header_seen) {
+      if (line != kPayloadHeader) {
+        error = _("The transaction request payload uses an unknown format.");
+        return false;
+      }
+      header_seen = true;
+      return true;
+    }
+
+    const size_t separator = line.find(kFieldSeparator);
+    if (separator == std::string_view::npos) {
+      error = _("The transaction request payload is malformed.");
+      return false;
+    }
+
+    const std::string_view action = line.substr(0, separator);
+    const std::string_view spec = line.substr(separator + 1);
+    std::vector<std::string> *target = nullptr;
+    if (action == "install") {
+      target = &request.install;
+    } else if (action == "remove") {
+      target = &request.remove;
+    } else if (action == "reinstall") {
+      target = &request.reinstall;
+    } else {
+      error = _("The transaction request payload contains an unknown action.");
+      return false;
+    }
+
+    if (spec.empty() || spec.find(kFieldSeparator) != std::string_view::npos) {
+      error = _("The transaction request payload is malformed.");
+      return false;
+    }
+    if (spec.size() > kTransactionRequestMaxSpecLength) {
+      error = _("Transaction request contains a package spec that is too long.");
+      return false;
+    }
+    if (request.item_count() >= kTransactionRequestMaxBulkItems) {
+      error = _("Transaction request contains too many package actions.");
+      return false;
+    }
+
+    target->emplace_back(spec);
+    return true;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Parse the complete lines of one chunk and keep the unfinished tail.
+  // -----------------------------------------------------------------------------
+  bool feed(std::string_view chunk)
+  {
+    while (!chunk.empty()) {
+      const size_t end = chunk.find('\n');
+      if (end == std::string_view::npos) {
+        partial.append(chunk);
+        break;
+      }
+
+      bool ok = false;
+      if (partial.empty()) {
+        ok = take_line(chunk.substr(0, end));
+      } else {
+        partial.append(chunk.substr(0, end));
+        ok = take_line(partial);
+        partial.clear();
+      }
+      if (!ok) {
+        return false;
+      }
+      chunk.remove_prefix(end + 1);
+    }
+
+    if (partial.size() > kMaxLineLength) {
+      error = _("Transaction request contains a package spec that is too long.");
+      return false;
+    }
+    return true;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Fail on a missing header or an unterminated last line.
+  // -----------------------------------------------------------------------------
+  bool finish()
+  {
+    if (!header_seen || !partial.empty()) {
+      error = _("The transaction request payload is malformed.");
+      return false;
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Write the header and one line per package action.
+// -----------------------------------------------------------------------------
+std::string
+transaction_request_payload_encode(const TransactionRequest &request)
+{
+  std::string payload(kPayloadHeader);
+  payload += '\n';
+  append_specs(payload, "install", request.install);
+  append_specs(payload, "remove", request.remove);
+  append_specs(payload, "reinstall", request.reinstall);
+  return payload;
+}
+
+// -----------------------------------------------------------------------------
+// Feed the whole buffer to the incremental parser.
+// -----------------------------------------------------------------------------
+bool
+transaction_request_payload_decode(const char *data,
+                                   size_t size,
+                                   TransactionRequest &request_out,
+                                   std::string &error_out)
+{
+  request_out = TransactionRequest();
+  error_out.clear();
+
+  RequestPayloadParser parser;
+  if (!data || size > kTransactionRequestPayloadMaxBytes) {
+    error_out = _("The transaction request payload has an invalid size.");
+    return false;
+  }
+  if (!parser.feed(std::string_view(data, size)) || !parser.finish()) {
+    error_out = parser.error;
+    return false;
+  }
+
+  request_out = std::move(parser.request);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Create, fill, and seal one memfd.
+// -----------------------------------------------------------------------------
+int
+transaction_request_payload_create_memfd(const std::string &payload, std::string &error_out)
+{
+  error_out.clear();
+  const int fd = memfd_create("dnfui-request", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    error_out = dnfui_i18n_format(_("memfd_create failed: %s"), std::strerror(errno));
+    return -1;
+  }
+
+  size_t written = 0;
+  while (written < payload.size()) {
+    const ssize_t n = write(fd, payload.data() + written, payload.size() - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      error_out = dnfui_i18n_format(_("Writing the transaction request payload failed: %s"), std::strerror(errno));
+      close(fd);
+      return -1;
+    }
+    written += static_cast<size_t>(n);
+  }
+
+  if (fcntl(fd, F_ADD_SEALS, kPayloadSeals) != 0 || lseek(fd, 0, SEEK_SET) != 0) {
+    error_out = dnfui_i18n_format(_("Sealing the transaction request payload failed: %s"), std::strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// -----------------------------------------------------------------------------
+// Check the seals and the size, then parse the fd one chunk at a time so a
+// bad line stops the read without loading the rest.
+// -----------------------------------------------------------------------------
+bool
+transaction_request_payload_read_memfd(int fd, TransactionRequest &request_out, std::string &error_out)
+{
+  request_out = TransactionRequest();
+  error_out.clear();
+
+  // Only sealed memfds pass, so the read below never blocks on a pipe or
+  // socket and the sender cannot change the contents while they are parsed.
+  const int seals = fcntl(fd, F_GET_SEALS);
+  if (seals < 0 || (seals & kPayloadSeals) != kPayloadSeals) {
+    error_out = _("The transaction request payload is not sealed.");
+    return false;
+  }
+
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+      static_cast<unsigned long long>(st.st_size) > kTransactionRequestPayloadMaxBytes) {
+    error_out = _("The transaction request payload has an invalid size.");
+    return false;
+  }
+
+  RequestPayloadParser parser;
+  std::vector<char> chunk(kReadChunkBytes);
+  const size_t size = static_cast<size_t>(st.st_size);
+  size_t offset = 0;
+  while (offset < size) {
+    const ssize_t n = pread(fd, chunk.data(), std::min(chunk.size(), size - offset), static_cast<off_t>(offset));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      error_out = dnfui_i18n_format(_("Reading the transaction request payload failed: %s"), std::strerror(errno));
+      return false;
+    }
+    if (!parser.feed(std::string_view(chunk.data(), static_cast<size_t>(n)))) {
+      error_out = parser.error;
+      return false;
+    }
+    offset += static_cast<size_t>(n);
+  }
+
+  if (!parser.finish()) {
+    error_out = parser.error;
+    return false;
+  }
+
+  request_out = std::move(parser.request);
+  return true;
+}
@@ -0,0 +1,46 @@
+// -----------------------------------------------------------------------------
+// transaction_service_request_payload.hpp
+// Bulk transaction request transfer
+// Encodes a request with more than kTransactionRequestMaxItems package actions
+// into a sealed memfd that the client passes to StartTransactionFd, so large
+// package sets are resolved in one transaction without huge D-Bus arrays.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "transaction_request.hpp"
+
+#include <cstddef>
+#include <string>
+
+// Largest payload the service reads. Together with the item limit this bounds
+// the memory and validation work one bulk request can cost the service.
+inline constexpr size_t kTransactionRequestPayloadMaxBytes = 4 * 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+// Encode request as a line-based payload with one "action spec" line per
+// package action. Package specs never contain line breaks or tabs.
+// -----------------------------------------------------------------------------
+std::string transaction_request_payload_encode(const TransactionRequest &request);
+
+// -----------------------------------------------------------------------------
+// Decode one payload written by transaction_request_payload_encode. Every line
+// is checked as it is parsed, so oversized or malformed input stops early.
+// Returns false with error_out set and leaves request_out empty on failure.
+// -----------------------------------------------------------------------------
+bool transaction_request_payload_decode(const char *data,
+                                        size_t size,
+                                        TransactionRequest &request_out,
+                                        std::string &error_out);
+
+// -----------------------------------------------------------------------------
+// Write payload into a new memfd and seal it against any further change.
+// Returns the fd positioned at the start, or -1 with error_out set.
+// -----------------------------------------------------------------------------
+int transaction_request_payload_create_memfd(const std::string &payload, std::string &error_out);
+
+// -----------------------------------------------------------------------------
+// Read a sealed payload fd in chunks and decode it. Fds that are not sealed
+// against writes or that exceed kTransactionRequestPayloadMaxBytes are
+// rejected before anything is read. Does not close fd.
+// -----------------------------------------------------------------------------
+bool transaction_request_payload_read_memfd(int fd, TransactionRequest &request_out, std::string &error_out);
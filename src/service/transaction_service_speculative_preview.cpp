@@ -0,0 +1,61 @@
+// -----------------------------------------------------------------------------
+// transaction_service_speculative_preview.cpp
+// Background upgrade-all preview cache
+// Keeps the hand-out rules separate from the idle scheduling in the service.
+// -----------------------------------------------------------------------------
+#include "service/transaction_service_speculative_preview.hpp"
+
+#include <utility>
+
+// -----------------------------------------------------------------------------
+// Replace the cached entry.
+// -----------------------------------------------------------------------------
+void
+SpeculativeUpgradeAllPreview::store(const TransactionPreview &new_preview, ResolvedTransactionPtr new_resolved)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  preview = new_preview;
+  resolved = std::move(new_resolved);
+}
+
+// -----------------------------------------------------------------------------
+// Hand out the cached entry once, and only while it is current.
+// -----------------------------------------------------------------------------
+bool
+SpeculativeUpgradeAllPreview::take_if_current(TransactionPreview &preview_out, ResolvedTransactionPtr &resolved_out)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!resolved) {
+    return false;
+  }
+
+  const bool current = dnf_backend_resolved_transaction_is_current(resolved);
+  if (current) {
+    preview_out = std::move(preview);
+    resolved_out = std::move(resolved);
+  }
+  preview = TransactionPreview();
+  resolved.reset();
+  return current;
+}
+
+// -----------------------------------------------------------------------------
+// Check whether the cached entry still matches the published Base.
+// -----------------------------------------------------------------------------
+bool
+SpeculativeUpgradeAllPreview::has_current() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return resolved && dnf_backend_resolved_transaction_is_current(resolved);
+}
+
+// -----------------------------------------------------------------------------
+// Drop the cached entry.
+// -----------------------------------------------------------------------------
+void
+SpeculativeUpgradeAllPreview::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  preview = TransactionPreview();
+  resolved.reset();
+}
@@ -0,0 +1,46 @@
+// -----------------------------------------------------------------------------
+// transaction_service_speculative_preview.hpp
+// Background upgrade-all preview cache
+// Holds one upgrade-all resolution computed while the service was idle so a
+// later upgrade-all request can use it instead of resolving again.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <mutex>
+
+// -----------------------------------------------------------------------------
+// Cached upgrade-all preview and the transaction it was resolved to. The entry
+// is tied to the Base generation it was resolved on through the resolved
+// transaction, so it is only handed out while that Base is still current.
+// -----------------------------------------------------------------------------
+class SpeculativeUpgradeAllPreview {
+  public:
+  // -----------------------------------------------------------------------------
+  // Replace the cached entry with a new resolution.
+  // -----------------------------------------------------------------------------
+  void store(const TransactionPreview &preview, ResolvedTransactionPtr resolved);
+
+  // -----------------------------------------------------------------------------
+  // Move the cached entry out when it still matches the published Base. A
+  // stale entry is dropped. Each entry is handed out at most once because
+  // apply consumes the resolved transaction.
+  // -----------------------------------------------------------------------------
+  bool take_if_current(TransactionPreview &preview_out, ResolvedTransactionPtr &resolved_out);
+
+  // -----------------------------------------------------------------------------
+  // Return true when an entry for the published Base is cached.
+  // -----------------------------------------------------------------------------
+  bool has_current() const;
+
+  // -----------------------------------------------------------------------------
+  // Drop the cached entry, which keeps its fork of the Base loaded.
+  // -----------------------------------------------------------------------------
+  void clear();
+
+  private:
+  mutable std::mutex mutex;
+  TransactionPreview preview;
+  ResolvedTransactionPtr resolved;
+};
@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------
+// transaction_service_statistics.cpp
+// Transaction service latency statistics
+// Keeps the histogram bookkeeping separate from the D-Bus encoding in the
+// service.
+// -----------------------------------------------------------------------------
+#include "service/transaction_service_statistics.hpp"
+
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+// Add one sample to its bucket and the running totals.
+// -----------------------------------------------------------------------------
+void
+TransactionLatencyHistogram::record(std::chrono::microseconds latency)
+{
+  const uint64_t us = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+  ++count;
+  sum_us += us;
+  max_us = std::max(max_us, us);
+
+  size_t bucket = 0;
+  while (bucket < kTransactionLatencyBucketBoundsMs.size() && us > kTransactionLatencyBucketBoundsMs[bucket] * 1000) {
+    ++bucket;
+  }
+  ++buckets[bucket];
+}
+
+// -----------------------------------------------------------------------------
+// Add one sample under name, creating the histogram on first use.
+// -----------------------------------------------------------------------------
+void
+TransactionServiceStatistics::record(const std::string &name, std::chrono::microseconds latency)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  histograms[name].record(latency);
+}
+
+// -----------------------------------------------------------------------------
+// Add the time elapsed since start under name.
+// -----------------------------------------------------------------------------
+void
+TransactionServiceStatistics::record_since(const std::string &name, std::chrono::steady_clock::time_point start)
+{
+  record(name,
+         std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+}
+
+// -----------------------------------------------------------------------------
+// Copy the histograms under the lock.
+// -----------------------------------------------------------------------------
+std::map<std::string, TransactionLatencyHistogram>
+TransactionServiceStatistics::snapshot() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return histograms;
+}
@@ -0,0 +1,93 @@
+// -----------------------------------------------------------------------------
+// transaction_service_statistics.hpp
+// Transaction service latency statistics
+// Counts and latency histograms for the service work stages, kept for the
+// GetStatistics manager method so monitoring can scrape them over D-Bus.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// Upper bucket bounds in milliseconds. Samples above the last bound go to one
+// more overflow bucket.
+inline constexpr std::array<uint64_t, 11> kTransactionLatencyBucketBoundsMs {
+  10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000,
+};
+
+// -----------------------------------------------------------------------------
+// Sample count, sum, maximum, and bucket counts for one named latency.
+// -----------------------------------------------------------------------------
+struct TransactionLatencyHistogram {
+  uint64_t count = 0;
+  uint64_t sum_us = 0;
+  uint64_t max_us = 0;
+  std::array<uint64_t, kTransactionLatencyBucketBoundsMs.size() + 1> buckets {};
+
+  // -----------------------------------------------------------------------------
+  // Add one sample to the bucket whose bound is the first not below it.
+  // -----------------------------------------------------------------------------
+  void record(std::chrono::microseconds latency);
+};
+
+// -----------------------------------------------------------------------------
+// Thread-safe set of named latency histograms. Worker threads and the main
+// loop record into it, and GetStatistics copies it.
+// -----------------------------------------------------------------------------
+class TransactionServiceStatistics {
+  public:
+  // -----------------------------------------------------------------------------
+  // Add one latency sample under name.
+  // -----------------------------------------------------------------------------
+  void record(const std::string &name, std::chrono::microseconds latency);
+
+  // -----------------------------------------------------------------------------
+  // Add the time from start until now under name.
+  // -----------------------------------------------------------------------------
+  void record_since(const std::string &name, std::chrono::steady_clock::time_point start);
+
+  // -----------------------------------------------------------------------------
+  // Return a copy of all histograms, sorted by name.
+  // -----------------------------------------------------------------------------
+  std::map<std::string, TransactionLatencyHistogram> snapshot() const;
+
+  private:
+  mutable std::mutex mutex;
+  std::map<std::string, TransactionLatencyHistogram> histograms;
+};
+
+// -----------------------------------------------------------------------------
+// Record the lifetime of one scope under name, for example one Base rebuild.
+// -----------------------------------------------------------------------------
+class TransactionLatencyTimer {
+  public:
+  // -----------------------------------------------------------------------------
+  // Start the clock.
+  // -----------------------------------------------------------------------------
+  TransactionLatencyTimer(TransactionServiceStatistics &statistics, std::string name)
+      : statistics(statistics)
+      , name(std::move(name))
+      , start(std::chrono::steady_clock::now())
+  {
+  }
+  TransactionLatencyTimer(const TransactionLatencyTimer &) = delete;
+  TransactionLatencyTimer &operator=(const TransactionLatencyTimer &) = delete;
+
+  // -----------------------------------------------------------------------------
+  // Record the elapsed time, also when the scope is left by an exception.
+  // -----------------------------------------------------------------------------
+  ~TransactionLatencyTimer()
+  {
+    statistics.record_since(name, start);
+  }
+
+  private:
+  TransactionServiceStatistics &statistics;
+  std::string name;
+  std::chrono::steady_clock::time_point start;
+};
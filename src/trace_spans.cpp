@@ -0,0 +1,241 @@
+// -----------------------------------------------------------------------------
+// src/trace_spans.cpp
+// Runtime span tracing with Chrome trace export
+// Finished spans are appended to one vector under a short lock and written as
+// complete ("X") events, so a span that ends on another thread than the one
+// that started it still shows up in one piece.
+// -----------------------------------------------------------------------------
+#include "trace_spans.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+
+#include <unistd.h>
+
+namespace {
+
+// Spans past this count are dropped and counted, so a long session with
+// tracing on cannot grow without bound.
+constexpr size_t kMaxTraceSpans = 1000000;
+
+std::atomic<bool> g_trace_enabled { false };
+std::atomic<uint32_t> g_next_thread_id { 1 };
+const std::chrono::steady_clock::time_point g_trace_start = std::chrono::steady_clock::now();
+
+std::mutex g_trace_mutex;
+std::vector<TraceSpanEvent> g_trace_events;
+uint64_t g_trace_dropped = 0;
+std::string g_trace_path;
+std::string g_trace_process_name;
+
+// -----------------------------------------------------------------------------
+// Return a small id for the calling thread, assigned on its first span.
+// -----------------------------------------------------------------------------
+uint32_t
+current_trace_thread_id()
+{
+  thread_local uint32_t id = g_next_thread_id.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+
+// -----------------------------------------------------------------------------
+// Append text as a JSON string literal.
+// -----------------------------------------------------------------------------
+void
+append_json_string(std::string &out, const std::string &text)
+{
+  out += '"';
+  for (unsigned char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += static_cast<char>(c);
+    } else if (c < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof escaped, "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += static_cast<char>(c);
+    }
+  }
+  out += '"';
+}
+
+// -----------------------------------------------------------------------------
+// Replace every "%p" in the configured path with the process id.
+// -----------------------------------------------------------------------------
+std::string
+expand_trace_path(const std::string &path)
+{
+  std::string expanded;
+  for (size_t i = 0; i < path.size(); ++i) {
+    if (path[i] == '%' && i + 1 < path.size() && path[i + 1] == 'p') {
+      expanded += std::to_string(getpid());
+      ++i;
+    } else {
+      expanded += path[i];
+    }
+  }
+  return expanded;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Enable collection when DNFUI_TRACE_FILE is set and not empty.
+// -----------------------------------------------------------------------------
+void
+trace_spans_init(const char *process_name)
+{
+  const char *path = std::getenv("DNFUI_TRACE_FILE");
+  if (!path || !*path) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    g_trace_path = expand_trace_path(path);
+    g_trace_process_name = process_name ? process_name : "";
+  }
+  g_trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Return true when spans are being collected.
+// -----------------------------------------------------------------------------
+bool
+trace_spans_enabled()
+{
+  return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Return microseconds since the trace start on the steady clock.
+// -----------------------------------------------------------------------------
+uint64_t
+trace_spans_now_us()
+{
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_trace_start).count());
+}
+
+// -----------------------------------------------------------------------------
+// Take the end time before the lock, so waiting for it is not counted.
+// -----------------------------------------------------------------------------
+void
+trace_spans_record(const char *category, const char *name, uint64_t start_us, std::string detail)
+{
+  if (!trace_spans_enabled()) {
+    return;
+  }
+
+  TraceSpanEvent event;
+  event.category = category ? category : "";
+  event.name = name ? name : "";
+  event.detail = std::move(detail);
+  event.thread_id = current_trace_thread_id();
+  event.start_us = start_us;
+  const uint64_t end_us = trace_spans_now_us();
+  event.duration_us = end_us > start_us ? end_us - start_us : 0;
+
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  if (g_trace_events.size() >= kMaxTraceSpans) {
+    ++g_trace_dropped;
+    return;
+  }
+  g_trace_events.push_back(std::move(event));
+}
+
+// -----------------------------------------------------------------------------
+// Lay out a process name record followed by one complete event per span.
+// -----------------------------------------------------------------------------
+std::string
+trace_spans_json()
+{
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  const std::string pid = std::to_string(getpid());
+
+  std::string out = "{\"traceEvents\":[";
+  out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":0,\"args\":{\"name\":";
+  append_json_string(out, g_trace_process_name);
+  out += "}}";
+
+  for (const auto &event : g_trace_events) {
+    out += ",\n{\"name\":";
+    append_json_string(out, event.name);
+    out += ",\"cat\":";
+    append_json_string(out, event.category);
+    out += ",\"ph\":\"X\",\"ts\":" + std::to_string(event.start_us) + ",\"dur\":" + std::to_string(event.duration_us) +
+           ",\"pid\":" + pid + ",\"tid\":" + std::to_string(event.thread_id);
+    if (!event.detail.empty()) {
+      out += ",\"args\":{\"detail\":";
+      append_json_string(out, event.detail);
+      out += '}';
+    }
+    out += '}';
+  }
+
+  out += "],\n\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_spans\":\"" + std::to_string(g_trace_dropped) +
+         "\"}}\n";
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+// Rewrite the whole trace file with every span collected so far.
+// -----------------------------------------------------------------------------
+void
+trace_spans_write()
+{
+  if (!trace_spans_enabled()) {
+    return;
+  }
+
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    path = g_trace_path;
+  }
+  if (path.empty()) {
+    return;
+  }
+
+  const std::string json = trace_spans_json();
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(json.data(), static_cast<std::streamsize>(json.size()));
+  if (!file.good()) {
+    std::fprintf(stderr, "dnfui: could not write trace file %s\n", path.c_str());
+  }
+}
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Test-only hook: collect spans in memory and drop earlier ones.
+// -----------------------------------------------------------------------------
+void
+trace_spans_testonly_enable(const char *process_name)
+{
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  g_trace_events.clear();
+  g_trace_dropped = 0;
+  g_trace_path.clear();
+  g_trace_process_name = process_name ? process_name : "";
+  g_trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Test-only hook: return a copy of the collected spans.
+// -----------------------------------------------------------------------------
+std::vector<TraceSpanEvent>
+trace_spans_testonly_events()
+{
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  return g_trace_events;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,130 @@
+// -----------------------------------------------------------------------------
+// src/trace_spans.hpp
+// Runtime span tracing with Chrome trace export
+//
+// Spans are separate from the DNFUI_TRACE text lines in debug_trace.hpp and
+// have their own switch. When DNFUI_TRACE_FILE names an output file, each
+// span records its category, name, thread, and monotonic start and duration,
+// and the process writes them as Chrome trace JSON on exit. The file opens in
+// Perfetto or chrome://tracing. A "%p" in the path is replaced by the process
+// id, so the GUI and the transaction service can write next to each other.
+// Without the variable a span costs one relaxed atomic load, though a detail
+// argument is still built by the caller.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// One finished span. start_us is relative to the process trace start.
+// -----------------------------------------------------------------------------
+struct TraceSpanEvent {
+  const char *category = "";
+  const char *name = "";
+  std::string detail;
+  uint32_t thread_id = 0;
+  uint64_t start_us = 0;
+  uint64_t duration_us = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Read DNFUI_TRACE_FILE and start collecting spans when it is set.
+// process_name labels the process in the trace viewer. Call once, early.
+// -----------------------------------------------------------------------------
+void trace_spans_init(const char *process_name);
+// -----------------------------------------------------------------------------
+// Return true when spans are being collected.
+// -----------------------------------------------------------------------------
+bool trace_spans_enabled();
+// -----------------------------------------------------------------------------
+// Return the current monotonic time in microseconds since the trace start.
+// -----------------------------------------------------------------------------
+uint64_t trace_spans_now_us();
+// -----------------------------------------------------------------------------
+// Record one span that started at start_us and ends now. Used for spans that
+// begin and end in different callbacks. category and name must be string
+// literals.
+// -----------------------------------------------------------------------------
+void trace_spans_record(const char *category, const char *name, uint64_t start_us, std::string detail = {});
+// -----------------------------------------------------------------------------
+// Write the collected spans to the trace file. Later spans are kept for the
+// next write, so calling this again rewrites the file with every span.
+// -----------------------------------------------------------------------------
+void trace_spans_write();
+// -----------------------------------------------------------------------------
+// Return the collected spans as Chrome trace JSON.
+// -----------------------------------------------------------------------------
+std::string trace_spans_json();
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Test-only hook: collect spans without an output file, dropping old ones.
+// -----------------------------------------------------------------------------
+void trace_spans_testonly_enable(const char *process_name);
+// -----------------------------------------------------------------------------
+// Test-only hook: return a copy of the collected spans.
+// -----------------------------------------------------------------------------
+std::vector<TraceSpanEvent> trace_spans_testonly_events();
+#endif
+
+// -----------------------------------------------------------------------------
+// Scoped span that records itself when it goes out of scope. The span is off
+// for its whole life when tracing was disabled at construction.
+// -----------------------------------------------------------------------------
+class TraceSpan {
+  public:
+  // -----------------------------------------------------------------------------
+  // Start one span. category and name must be string literals.
+  // -----------------------------------------------------------------------------
+  TraceSpan(const char *category, const char *name)
+      : category(category)
+      , name(name)
+      , active(trace_spans_enabled())
+      , start_us(active ? trace_spans_now_us() : 0)
+  {
+  }
+
+  // -----------------------------------------------------------------------------
+  // Start one span with a detail string, such as a package NEVRA, shown in
+  // the span arguments.
+  // -----------------------------------------------------------------------------
+  TraceSpan(const char *category, const char *name, std::string detail)
+      : TraceSpan(category, name)
+  {
+    if (active) {
+      this->detail = std::move(detail);
+    }
+  }
+
+  // -----------------------------------------------------------------------------
+  // Record the span.
+  // -----------------------------------------------------------------------------
+  ~TraceSpan()
+  {
+    if (active) {
+      trace_spans_record(category, name, start_us, std::move(detail));
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+  private:
+  const char *category;
+  const char *name;
+  bool active;
+  uint64_t start_us;
+  std::string detail;
+};
+
+#define DNFUI_TRACE_SPAN_CONCAT_INNER(a, b) a##b
+#define DNFUI_TRACE_SPAN_CONCAT(a, b) DNFUI_TRACE_SPAN_CONCAT_INNER(a, b)
+// Trace the rest of the enclosing scope as one span.
+#define DNFUI_TRACE_SPAN(...) TraceSpan DNFUI_TRACE_SPAN_CONCAT(dnfui_trace_span_, __LINE__)(__VA_ARGS__)
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
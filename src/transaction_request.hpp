@@ -11,6 +11,9 @@
 #include <vector>
 
 constexpr size_t kTransactionRequestMaxItems = 256;
+// Larger requests are sent as a sealed fd instead of string arrays, for
+// restoring a package set or a large cleanup in one transaction.
+constexpr size_t kTransactionRequestMaxBulkItems = 16384;
 constexpr size_t kTransactionRequestMaxSpecLength = 4096;
 
 // -----------------------------------------------------------------------------
@@ -44,8 +47,9 @@ struct TransactionRequest {
 
   // -----------------------------------------------------------------------------
   // Reject empty or oversized requests before they reach the service.
+  // max_items is raised to kTransactionRequestMaxBulkItems for bulk requests.
   // -----------------------------------------------------------------------------
-  bool validate(std::string &error_out) const
+  bool validate(std::string &error_out, size_t max_items = kTransactionRequestMaxItems) const
   {
     error_out.clear();
 
@@ -59,7 +63,7 @@ struct TransactionRequest {
       return false;
     }
 
-    if (item_count() > kTransactionRequestMaxItems) {
+    if (item_count() > max_items) {
       error_out = "Transaction request contains too many package actions.";
       return false;
     }
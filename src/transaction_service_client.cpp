@@ -3,7 +3,9 @@
 // GUI-side D-Bus client for the transaction service
 // Starts transaction requests, waits for preview and apply state changes, reads
 // structured preview data, forwards service progress lines, and releases
-// finished requests when the GUI no longer needs them.
+// finished requests when the GUI no longer needs them. Requests are driven by
+// asynchronous D-Bus calls and signals on the caller's main context; the
+// blocking helpers run the same code on a private context.
 // -----------------------------------------------------------------------------
 #include "transaction_service_client.hpp"
 
@@ -11,13 +13,23 @@
 #include "dnf_backend/dnf_backend.hpp"
 #include "i18n.hpp"
 #include "service/transaction_service_dbus.hpp"
+#include "service/transaction_service_preview_payload.hpp"
+#include "service/transaction_service_query.hpp"
+#include "service/transaction_service_request_payload.hpp"
 #include "transaction_request.hpp"
 
 #include <gio/gio.h>
+#include <gio/gunixfdlist.h>
 #include <glib.h>
 
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
 
 namespace {
 
@@ -31,10 +43,6 @@ struct TransactionServiceResult {
   std::string details;
 };
 
-struct TransactionServiceProgressForwarder {
-  const std::function<void(const std::string &)> *progress_callback = nullptr;
-};
-
 struct TransactionServiceConnectionCache {
   std::mutex mutex;
   GDBusConnection *connection = nullptr;
@@ -97,31 +105,81 @@ build_start_transaction_parameters(const TransactionRequest &request)
 }
 
 // -----------------------------------------------------------------------------
-// Connect to the D-Bus transaction service used by the GUI client
+// Return the bus type and address key the current connection must match
+// -----------------------------------------------------------------------------
+static GBusType
+get_transaction_service_bus_target(const char *&bus_address_out, std::string &bus_address_key_out)
+{
+  GBusType bus_type = get_transaction_service_bus_type();
+  bus_address_out = bus_type == G_BUS_TYPE_SESSION ? g_getenv("DBUS_SESSION_BUS_ADDRESS") : nullptr;
+  bus_address_key_out = bus_address_out ? bus_address_out : "";
+  return bus_type;
+}
+
+// -----------------------------------------------------------------------------
+// Return a new reference to the cached connection when it still matches the
+// selected bus, or nullptr after dropping a stale one
 // -----------------------------------------------------------------------------
 static GDBusConnection *
-connect_transaction_service(std::string &error_out)
+lookup_cached_transaction_service_connection(GBusType bus_type, const std::string &bus_address_key)
 {
-  error_out.clear();
+  TransactionServiceConnectionCache &cache = get_transaction_service_connection_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (cache.connection && cache.bus_type == bus_type && cache.bus_address == bus_address_key &&
+      !g_dbus_connection_is_closed(cache.connection)) {
+    DNFUI_TRACE("Transaction service client connect bus=%s cached",
+                bus_type == G_BUS_TYPE_SESSION ? "session" : "system");
+    return G_DBUS_CONNECTION(g_object_ref(cache.connection));
+  }
 
-  GBusType bus_type = get_transaction_service_bus_type();
-  const char *bus_address = bus_type == G_BUS_TYPE_SESSION ? g_getenv("DBUS_SESSION_BUS_ADDRESS") : nullptr;
-  std::string bus_address_key = bus_address ? bus_address : "";
+  if (cache.connection) {
+    g_object_unref(cache.connection);
+    cache.connection = nullptr;
+  }
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Cache a newly opened connection and return the one callers should use.
+// Another caller may have cached a matching connection first, in which case
+// the new one is dropped so all requests share one connection.
+// -----------------------------------------------------------------------------
+static GDBusConnection *
+store_transaction_service_connection(GDBusConnection *connection, GBusType bus_type, const std::string &bus_address_key)
+{
   TransactionServiceConnectionCache &cache = get_transaction_service_connection_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (!cache.connection) {
+    cache.connection = G_DBUS_CONNECTION(g_object_ref(connection));
+    cache.bus_type = bus_type;
+    cache.bus_address = bus_address_key;
+  } else if (cache.bus_type == bus_type && cache.bus_address == bus_address_key &&
+             !g_dbus_connection_is_closed(cache.connection)) {
+    g_object_unref(connection);
+    return G_DBUS_CONNECTION(g_object_ref(cache.connection));
+  } else {
+    g_object_unref(cache.connection);
+    cache.connection = G_DBUS_CONNECTION(g_object_ref(connection));
+    cache.bus_type = bus_type;
+    cache.bus_address = bus_address_key;
+  }
 
-  {
-    std::lock_guard<std::mutex> lock(cache.mutex);
-    if (cache.connection && cache.bus_type == bus_type && cache.bus_address == bus_address_key &&
-        !g_dbus_connection_is_closed(cache.connection)) {
-      DNFUI_TRACE("Transaction service client connect bus=%s cached",
-                  bus_type == G_BUS_TYPE_SESSION ? "session" : "system");
-      return G_DBUS_CONNECTION(g_object_ref(cache.connection));
-    }
+  return connection;
+}
 
-    if (cache.connection) {
-      g_object_unref(cache.connection);
-      cache.connection = nullptr;
-    }
+// -----------------------------------------------------------------------------
+// Connect to the D-Bus transaction service used by the GUI client
+// -----------------------------------------------------------------------------
+static GDBusConnection *
+connect_transaction_service(std::string &error_out)
+{
+  error_out.clear();
+
+  const char *bus_address = nullptr;
+  std::string bus_address_key;
+  GBusType bus_type = get_transaction_service_bus_target(bus_address, bus_address_key);
+  if (GDBusConnection *cached = lookup_cached_transaction_service_connection(bus_type, bus_address_key)) {
+    return cached;
   }
 
   DNFUI_TRACE("Transaction service client connect bus=%s", bus_type == G_BUS_TYPE_SESSION ? "session" : "system");
@@ -145,200 +203,119 @@ connect_transaction_service(std::string &error_out)
     return nullptr;
   }
 
-  {
-    std::lock_guard<std::mutex> lock(cache.mutex);
-    if (!cache.connection) {
-      cache.connection = G_DBUS_CONNECTION(g_object_ref(connection));
-      cache.bus_type = bus_type;
-      cache.bus_address = bus_address_key;
-    } else if (cache.bus_type == bus_type && cache.bus_address == bus_address_key &&
-               !g_dbus_connection_is_closed(cache.connection)) {
-      g_object_unref(connection);
-      return G_DBUS_CONNECTION(g_object_ref(cache.connection));
-    } else {
-      g_object_unref(cache.connection);
-      cache.connection = G_DBUS_CONNECTION(g_object_ref(connection));
-      cache.bus_type = bus_type;
-      cache.bus_address = bus_address_key;
-    }
-  }
-
-  return connection;
+  return store_transaction_service_connection(connection, bus_type, bus_address_key);
 }
 
+// Receives a connection reference, or nullptr and the reason it failed.
+using TransactionServiceConnectCallback = std::function<void(GDBusConnection *connection, const std::string &error)>;
+
+// State for one asynchronous bus connection attempt.
+struct TransactionServiceConnectAttempt {
+  TransactionServiceConnectCallback ready;
+  GBusType bus_type = G_BUS_TYPE_SYSTEM;
+  std::string bus_address_key;
+  bool for_address = false;
+};
+
 // -----------------------------------------------------------------------------
-// Start a new transaction request and return its service object path
+// Cache the connection opened asynchronously and hand it to the caller.
 // -----------------------------------------------------------------------------
-static bool
-start_transaction_request(GDBusConnection *connection,
-                          const TransactionRequest &request,
-                          std::string &transaction_path_out,
-                          std::string &error_out)
+static void
+on_transaction_service_connect_ready(GObject *, GAsyncResult *res, gpointer user_data)
 {
-  transaction_path_out.clear();
-  error_out.clear();
-
-  if (!connection) {
-    error_out = _("Transaction service connection is not available.");
-    return false;
-  }
+  std::unique_ptr<TransactionServiceConnectAttempt> attempt(static_cast<TransactionServiceConnectAttempt *>(user_data));
 
   GError *error = nullptr;
-  GVariant *start_reply = g_dbus_connection_call_sync(connection,
-                                                      kTransactionServiceName,
-                                                      kTransactionServiceManagerPath,
-                                                      kTransactionServiceManagerInterface,
-                                                      "StartTransaction",
-                                                      build_start_transaction_parameters(request),
-                                                      G_VARIANT_TYPE("(o)"),
-                                                      G_DBUS_CALL_FLAGS_NONE,
-                                                      -1,
-                                                      nullptr,
-                                                      &error);
-  if (!start_reply) {
-    error_out = error ? error->message : _("Could not start the transaction service request.");
+  GDBusConnection *connection = attempt->for_address ? g_dbus_connection_new_for_address_finish(res, &error)
+                                                     : g_bus_get_finish(res, &error);
+  if (!connection) {
+    std::string error_text = error ? error->message : _("Could not connect to the transaction service bus.");
     g_clear_error(&error);
-    return false;
+    attempt->ready(nullptr, error_text);
+    return;
   }
 
-  const gchar *path = nullptr;
-  g_variant_get(start_reply, "(&o)", &path);
-  transaction_path_out = path ? path : "";
-  g_variant_unref(start_reply);
+  attempt->ready(store_transaction_service_connection(connection, attempt->bus_type, attempt->bus_address_key), "");
+}
 
-  if (transaction_path_out.empty()) {
-    error_out = _("Transaction service returned an empty request path.");
-    return false;
+// -----------------------------------------------------------------------------
+// Connect to the transaction service bus without blocking. A cached connection
+// is handed to ready right away; a new one arrives on the thread-default main
+// context once the bus handshake completed.
+// -----------------------------------------------------------------------------
+static void
+connect_transaction_service_async(TransactionServiceConnectCallback ready)
+{
+  const char *bus_address = nullptr;
+  std::string bus_address_key;
+  GBusType bus_type = get_transaction_service_bus_target(bus_address, bus_address_key);
+  if (GDBusConnection *cached = lookup_cached_transaction_service_connection(bus_type, bus_address_key)) {
+    ready(cached, "");
+    return;
   }
 
-  DNFUI_TRACE("Transaction service client start path=%s", transaction_path_out.c_str());
+  DNFUI_TRACE("Transaction service client connect bus=%s", bus_type == G_BUS_TYPE_SESSION ? "session" : "system");
 
-  return true;
+  auto *attempt = new TransactionServiceConnectAttempt();
+  attempt->ready = std::move(ready);
+  attempt->bus_type = bus_type;
+  attempt->bus_address_key = bus_address_key;
+  if (bus_type == G_BUS_TYPE_SESSION && bus_address && *bus_address) {
+    attempt->for_address = true;
+    g_dbus_connection_new_for_address(
+        bus_address,
+        static_cast<GDBusConnectionFlags>(G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                          G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+        nullptr,
+        nullptr,
+        on_transaction_service_connect_ready,
+        attempt);
+  } else {
+    g_bus_get(bus_type, nullptr, on_transaction_service_connect_ready, attempt);
+  }
 }
 
 // -----------------------------------------------------------------------------
-// Start a new upgrade-all transaction request and return its service object path
+// Read the request path from a StartTransaction or StartUpgradeAllTransaction reply
 // -----------------------------------------------------------------------------
 static bool
-start_upgrade_all_transaction_request(GDBusConnection *connection,
-                                      std::string &transaction_path_out,
-                                      std::string &error_out)
+read_start_transaction_reply(GVariant *reply, std::string &transaction_path_out, std::string &error_out)
 {
-  transaction_path_out.clear();
-  error_out.clear();
-
-  if (!connection) {
-    error_out = _("Transaction service connection is not available.");
-    return false;
-  }
-
-  GError *error = nullptr;
-  GVariant *start_reply = g_dbus_connection_call_sync(connection,
-                                                      kTransactionServiceName,
-                                                      kTransactionServiceManagerPath,
-                                                      kTransactionServiceManagerInterface,
-                                                      "StartUpgradeAllTransaction",
-                                                      nullptr,
-                                                      G_VARIANT_TYPE("(o)"),
-                                                      G_DBUS_CALL_FLAGS_NONE,
-                                                      -1,
-                                                      nullptr,
-                                                      &error);
-  if (!start_reply) {
-    error_out = error ? error->message : _("Could not start the upgrade-all transaction service request.");
-    g_clear_error(&error);
-    return false;
-  }
-
   const gchar *path = nullptr;
-  g_variant_get(start_reply, "(&o)", &path);
+  g_variant_get(reply, "(&o)", &path);
   transaction_path_out = path ? path : "";
-  g_variant_unref(start_reply);
 
   if (transaction_path_out.empty()) {
     error_out = _("Transaction service returned an empty request path.");
     return false;
   }
-
-  DNFUI_TRACE("Transaction service client start upgrade-all path=%s", transaction_path_out.c_str());
-
   return true;
 }
 
 // -----------------------------------------------------------------------------
-// Read the current state of a service transaction request
+// Read stage, finished, success, and details from a GetResult reply
 // -----------------------------------------------------------------------------
-static bool
-get_transaction_result(GDBusConnection *connection,
-                       const std::string &transaction_path,
-                       TransactionServiceResult &result_out,
-                       std::string &error_out)
+static void
+read_transaction_result_reply(GVariant *reply, TransactionServiceResult &result_out)
 {
-  result_out = {};
-  error_out.clear();
-
-  GError *error = nullptr;
-  GVariant *reply = g_dbus_connection_call_sync(connection,
-                                                kTransactionServiceName,
-                                                transaction_path.c_str(),
-                                                kTransactionServiceRequestInterface,
-                                                "GetResult",
-                                                nullptr,
-                                                G_VARIANT_TYPE("(sbbs)"),
-                                                G_DBUS_CALL_FLAGS_NONE,
-                                                -1,
-                                                nullptr,
-                                                &error);
-  if (!reply) {
-    error_out = error ? error->message : _("Failed to read transaction service result.");
-    g_clear_error(&error);
-    return false;
-  }
-
-  // Read stage, finished, success, and details from the GetResult reply.
   const gchar *stage = nullptr;
   gboolean finished = FALSE;
   gboolean success = FALSE;
   const gchar *details = nullptr;
-  g_variant_get(reply, "(&sbbs)", &stage, &finished, &success, &details);
+  g_variant_get(reply, "(&sbb&s)", &stage, &finished, &success, &details);
   result_out.stage = stage ? stage : "";
   result_out.finished = finished;
   result_out.success = success;
   result_out.details = details ? details : "";
-  g_variant_unref(reply);
-
-  return true;
 }
 
 // -----------------------------------------------------------------------------
-// Read the structured preview data from a prepared service request
+// Read the structured preview data from a GetPreview reply
 // -----------------------------------------------------------------------------
-static bool
-get_transaction_preview(GDBusConnection *connection,
-                        const std::string &transaction_path,
-                        TransactionPreview &preview_out,
-                        std::string &error_out)
+static void
+read_transaction_preview_reply(GVariant *reply, TransactionPreview &preview_out)
 {
   preview_out = {};
-  error_out.clear();
-
-  GError *error = nullptr;
-  GVariant *reply = g_dbus_connection_call_sync(connection,
-                                                kTransactionServiceName,
-                                                transaction_path.c_str(),
-                                                kTransactionServiceRequestInterface,
-                                                "GetPreview",
-                                                nullptr,
-                                                G_VARIANT_TYPE("(asasasasasx)"),
-                                                G_DBUS_CALL_FLAGS_NONE,
-                                                -1,
-                                                nullptr,
-                                                &error);
-  if (!reply) {
-    error_out = error ? error->message : _("Failed to read transaction service preview.");
-    g_clear_error(&error);
-    return false;
-  }
 
   // Unpack the preview reply into owned string arrays and the disk space delta.
   gchar **install = nullptr;
@@ -371,9 +348,6 @@ get_transaction_preview(GDBusConnection *connection,
   g_strfreev(downgrade);
   g_strfreev(reinstall);
   g_strfreev(remove);
-  g_variant_unref(reply);
-
-  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -411,289 +385,888 @@ release_transaction_request(GDBusConnection *connection, const std::string &tran
 }
 
 // -----------------------------------------------------------------------------
-// State shared between wait_for_transaction_stage and its Finished signal handler.
+// One preview or apply request driven by D-Bus replies and signals on the
+// caller's main context. Every outstanding call and signal subscription holds
+// a reference, so late replies never touch freed state.
 // -----------------------------------------------------------------------------
-struct FinishedWaitState {
-  bool received = false;
-  bool service_disappeared = false;
-  std::string stage;
-  bool success = false;
-  std::string details;
+struct TransactionServiceOperation {
+  int refs = 1;
+  bool apply = false;
+  bool upgrade_all = false;
+  TransactionRequest request;
+  // Encoded request for StartTransactionFd, or empty for a normal start.
+  std::string bulk_payload;
+  GMainContext *context = nullptr;
+  GDBusConnection *connection = nullptr;
+  // Optional cancellable of an asynchronous preview and its handler id.
+  GCancellable *cancellable = nullptr;
+  gulong cancelled_id = 0;
+  // Set once the cancellable fired. Main context only.
+  bool cancel_requested = false;
+  std::string transaction_path;
+  // Stage the request has while the service is still working on it.
+  const char *running_stage = "preview-running";
+  guint finished_id = 0;
+  guint name_owner_changed_id = 0;
+  guint progress_id = 0;
+  bool waiting = false;
+  bool completed = false;
+  TransactionPreview preview;
+  std::function<void(const std::string &)> progress_callback;
+  TransactionServicePreviewCallback preview_done;
+  TransactionServiceApplyCallback apply_done;
 };
 
 // -----------------------------------------------------------------------------
-// Wait until the service transaction request leaves the given running stage.
-// Subscribes to the Finished D-Bus signal so the wait wakes up immediately
-// when the service reports a final state.
-// context must already be the thread-default context of the calling thread so
-// that signal callbacks are dispatched on the same context that is iterated.
+// Take one more reference on an operation.
 // -----------------------------------------------------------------------------
-static bool
-wait_for_transaction_stage(GDBusConnection *connection,
-                           const std::string &transaction_path,
-                           const char *running_stage,
-                           GMainContext *context,
-                           TransactionServiceResult &result_out,
-                           std::string &error_out)
+static TransactionServiceOperation *
+transaction_operation_ref(TransactionServiceOperation *op)
 {
-  error_out.clear();
+  ++op->refs;
+  return op;
+}
 
-  // Subscribe to Finished before the first state poll.
-  // This covers the short gap where the service could finish after the request
-  // starts but before the client begins waiting for the result.
-  FinishedWaitState wait_state;
-  guint finished_id = g_dbus_connection_signal_subscribe(
-      connection,
-      kTransactionServiceName,
-      kTransactionServiceRequestInterface,
-      "Finished",
-      transaction_path.c_str(),
-      nullptr,
-      G_DBUS_SIGNAL_FLAGS_NONE,
-      +[](GDBusConnection *,
-          const gchar *,
-          const gchar *,
-          const gchar *,
-          const gchar *,
-          GVariant *parameters,
-          gpointer user_data) {
-        auto *state = static_cast<FinishedWaitState *>(user_data);
-        const gchar *stage = nullptr;
-        gboolean success = FALSE;
-        const gchar *details = nullptr;
-        g_variant_get(parameters, "(&sbs)", &stage, &success, &details);
-        state->stage = stage ? stage : "";
-        state->success = success;
-        state->details = details ? details : "";
-        state->received = true;
-      },
-      &wait_state,
-      nullptr);
-
-  guint name_owner_changed_id = g_dbus_connection_signal_subscribe(
-      connection,
-      "org.freedesktop.DBus",
-      "org.freedesktop.DBus",
-      "NameOwnerChanged",
-      "/org/freedesktop/DBus",
-      kTransactionServiceName,
-      G_DBUS_SIGNAL_FLAGS_NONE,
-      +[](GDBusConnection *,
-          const gchar *,
-          const gchar *,
-          const gchar *,
-          const gchar *,
-          GVariant *parameters,
-          gpointer user_data) {
-        auto *state = static_cast<FinishedWaitState *>(user_data);
-        const gchar *name = nullptr;
-        const gchar *old_owner = nullptr;
-        const gchar *new_owner = nullptr;
-        g_variant_get(parameters, "(&s&s&s)", &name, &old_owner, &new_owner);
-        if (name && g_strcmp0(name, kTransactionServiceName) == 0 && old_owner && *old_owner &&
-            (!new_owner || !*new_owner)) {
-          state->service_disappeared = true;
-        }
-      },
-      &wait_state,
-      nullptr);
-
-  // One initial GetResult call handles the case where the service already
-  // reached a final state before our Finished subscription was registered.
-  if (!get_transaction_result(connection, transaction_path, result_out, error_out)) {
-    g_dbus_connection_signal_unsubscribe(connection, name_owner_changed_id);
-    g_dbus_connection_signal_unsubscribe(connection, finished_id);
-    return false;
+// -----------------------------------------------------------------------------
+// Drop one reference and free the operation with the last one.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_unref(gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  if (--op->refs > 0) {
+    return;
   }
 
-  // Block on context until the Finished signal fires or the initial poll
-  // already shows a final state. Any other signals pending on context
-  // (such as Progress callbacks in the apply path) are also dispatched here.
-  while (!wait_state.received && !wait_state.service_disappeared && result_out.stage == running_stage &&
-         !result_out.finished) {
-    g_main_context_iteration(context, TRUE);
+  if (op->connection) {
+    g_object_unref(op->connection);
   }
-
-  g_dbus_connection_signal_unsubscribe(connection, name_owner_changed_id);
-  g_dbus_connection_signal_unsubscribe(connection, finished_id);
-
-  // Return a normal client error if the service disappears while the client
-  // is still waiting for the final state signal.
-  if (wait_state.service_disappeared && !wait_state.received) {
-    error_out = _("Transaction service disappeared while waiting for the result.");
-    return false;
+  if (op->cancellable) {
+    g_object_unref(op->cancellable);
   }
-
-  // Fill the result from the final state signal and avoid a second GetResult call.
-  if (wait_state.received) {
-    result_out.stage = wait_state.stage;
-    result_out.finished = true;
-    result_out.success = wait_state.success;
-    result_out.details = wait_state.details;
+  if (op->context) {
+    g_main_context_unref(op->context);
   }
-
-  DNFUI_TRACE("Transaction service client stage path=%s stage=%s finished=%d success=%d",
-              transaction_path.c_str(),
-              result_out.stage.c_str(),
-              result_out.finished ? 1 : 0,
-              result_out.success ? 1 : 0);
-
-  return true;
+  delete op;
 }
 
 // -----------------------------------------------------------------------------
-// Forward transaction progress signals from the service to the GUI callback
+// Forward one progress line to the caller.
 // -----------------------------------------------------------------------------
 static void
-on_transaction_progress_signal(GDBusConnection *,
-                               const gchar *,
-                               const gchar *,
-                               const gchar *,
-                               const gchar *,
-                               GVariant *parameters,
-                               gpointer user_data)
+transaction_operation_progress(TransactionServiceOperation *op, const std::string &line)
 {
-  auto *forwarder = static_cast<TransactionServiceProgressForwarder *>(user_data);
-  if (!forwarder || !forwarder->progress_callback || !*forwarder->progress_callback) {
-    return;
+  if (op->progress_callback && !line.empty()) {
+    op->progress_callback(line);
   }
+}
 
-  const gchar *line = nullptr;
-  g_variant_get(parameters, "(&s)", &line);
-  if (!line || !*line) {
-    return;
+// -----------------------------------------------------------------------------
+// Drop every signal subscription the operation still holds.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_unsubscribe(TransactionServiceOperation *op)
+{
+  op->waiting = false;
+  guint *ids[] = { &op->finished_id, &op->name_owner_changed_id, &op->progress_id };
+  for (guint *id : ids) {
+    if (*id != 0) {
+      g_dbus_connection_signal_unsubscribe(op->connection, *id);
+      *id = 0;
+    }
   }
-
-  DNFUI_TRACE("Transaction service client progress line=%s", line);
-  (*forwarder->progress_callback)(line);
 }
 
 // -----------------------------------------------------------------------------
-// Wait for a started preview request and read its structured preview
+// Report the final result to the caller once and drop the operation's own
+// reference. Failed previews are released so the service can free them.
 // -----------------------------------------------------------------------------
-static bool
-wait_for_started_transaction_preview(GDBusConnection *connection,
-                                     const std::string &transaction_path,
-                                     TransactionPreview &preview_out,
-                                     std::string &error_out)
+static void
+transaction_operation_complete(TransactionServiceOperation *op, bool ok, const std::string &error)
 {
-  TransactionServiceResult result;
+  if (op->completed) {
+    return;
+  }
+  op->completed = true;
 
-  // Create a dedicated main context for the duration of the preview wait.
-  // The Finished signal subscription inside wait_for_transaction_stage is
-  // dispatched on the thread-default context, so it and the iterated context
-  // must be the same object.
-  GMainContext *wait_context = g_main_context_new();
-  g_main_context_push_thread_default(wait_context);
-  bool stage_ok =
-      wait_for_transaction_stage(connection, transaction_path, "preview-running", wait_context, result, error_out);
-  g_main_context_pop_thread_default(wait_context);
-  g_main_context_unref(wait_context);
-
-  if (!stage_ok) {
-    std::string release_error;
-    release_transaction_request(connection, transaction_path, release_error);
-    return false;
+  if (op->connection) {
+    transaction_operation_unsubscribe(op);
+  }
+  if (op->cancelled_id != 0) {
+    g_cancellable_disconnect(op->cancellable, op->cancelled_id);
+    op->cancelled_id = 0;
   }
 
-  if (result.stage != "preview-ready" || !result.finished || !result.success) {
-    error_out = result.details.empty() ? _("Privileged transaction preview failed.") : result.details;
+  if (!op->apply && !ok && op->connection && !op->transaction_path.empty()) {
     DNFUI_TRACE(
-        "Transaction service client preview failed path=%s error=%s", transaction_path.c_str(), error_out.c_str());
-    std::string release_error;
-    release_transaction_request(connection, transaction_path, release_error);
-    return false;
+        "Transaction service client preview failed path=%s error=%s", op->transaction_path.c_str(), error.c_str());
+    g_dbus_connection_call(op->connection,
+                           kTransactionServiceName,
+                           op->transaction_path.c_str(),
+                           kTransactionServiceRequestInterface,
+                           "Release",
+                           nullptr,
+                           nullptr,
+                           G_DBUS_CALL_FLAGS_NONE,
+                           -1,
+                           nullptr,
+                           nullptr,
+                           nullptr);
   }
 
-  if (!get_transaction_preview(connection, transaction_path, preview_out, error_out)) {
-    DNFUI_TRACE(
-        "Transaction service client get preview failed path=%s error=%s", transaction_path.c_str(), error_out.c_str());
-    std::string release_error;
-    release_transaction_request(connection, transaction_path, release_error);
-    return false;
+  if (op->apply) {
+    if (!ok) {
+      DNFUI_TRACE(
+          "Transaction service client apply failed path=%s error=%s", op->transaction_path.c_str(), error.c_str());
+    }
+    if (op->apply_done) {
+      op->apply_done(ok, error);
+    }
+  } else if (op->preview_done) {
+    static const TransactionPreview empty_preview;
+    std::string empty_path;
+    op->preview_done(ok, ok ? op->preview : empty_preview, ok ? op->transaction_path : empty_path, error);
   }
 
-  return true;
+  transaction_operation_unref(op);
 }
 
-} // namespace
-
 // -----------------------------------------------------------------------------
-// Resolve a service-backed transaction preview and return its request path
+// Report an error found before any D-Bus work started. The callback still
+// runs from the caller's main context, never from inside the start call.
 // -----------------------------------------------------------------------------
-bool
-transaction_service_client_preview_request(const TransactionRequest &request,
-                                           TransactionPreview &preview_out,
-                                           std::string &transaction_path_out,
-                                           std::string &error_out)
+static void
+transaction_operation_fail_later(TransactionServiceOperation *op, const std::string &error)
 {
-  preview_out = {};
-  transaction_path_out.clear();
-  error_out.clear();
-
-  if (!request.validate(error_out)) {
-    return false;
-  }
+  struct DeferredFailure {
+    TransactionServiceOperation *op;
+    std::string error;
+  };
 
-  if (request.upgrade_all) {
-    error_out = _("Use the upgrade-all preview helper for upgrade-all requests.");
-    return false;
-  }
+  GSource *source = g_idle_source_new();
+  g_source_set_callback(
+      source,
+      +[](gpointer user_data) -> gboolean {
+        auto *failure = static_cast<DeferredFailure *>(user_data);
+        transaction_operation_complete(failure->op, false, failure->error);
+        return G_SOURCE_REMOVE;
+      },
+      new DeferredFailure { op, error },
+      +[](gpointer user_data) { delete static_cast<DeferredFailure *>(user_data); });
+  g_source_attach(source, op->context);
+  g_source_unref(source);
+}
 
-  std::string connect_error;
-  GDBusConnection *connection = connect_transaction_service(connect_error);
-  if (!connection) {
-    error_out = connect_error;
-    return false;
+// -----------------------------------------------------------------------------
+// Finish one call reply handled by an operation callback.
+// -----------------------------------------------------------------------------
+static GVariant *
+transaction_operation_finish_call(GObject *source_object, GAsyncResult *res, std::string &error_out)
+{
+  GError *error = nullptr;
+  GVariant *reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res, &error);
+  if (!reply) {
+    error_out = error ? error->message : "";
+    g_clear_error(&error);
   }
+  return reply;
+}
 
-  if (!start_transaction_request(connection, request, transaction_path_out, error_out)) {
-    g_object_unref(connection);
-    return false;
+// -----------------------------------------------------------------------------
+// Handle the GetPreview reply of a preview that reached preview-ready.
+// -----------------------------------------------------------------------------
+static void
+on_operation_preview_reply(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  std::string error;
+  GVariant *reply = transaction_operation_finish_call(source_object, res, error);
+  if (!op->completed) {
+    if (!reply) {
+      transaction_operation_complete(
+          op, false, error.empty() ? _("Failed to read transaction service preview.") : error);
+    } else {
+      read_transaction_preview_reply(reply, op->preview);
+      transaction_operation_complete(op, true, "");
+    }
   }
 
-  if (!wait_for_started_transaction_preview(connection, transaction_path_out, preview_out, error_out)) {
-    g_object_unref(connection);
-    return false;
+  if (reply) {
+    g_variant_unref(reply);
   }
+  transaction_operation_unref(op);
+}
 
-  g_object_unref(connection);
-
-  return true;
+// -----------------------------------------------------------------------------
+// Read the preview as five string arrays. Used when the connection or the
+// service cannot pass the preview as a sealed fd.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_request_preview_arrays(TransactionServiceOperation *op)
+{
+  g_dbus_connection_call(op->connection,
+                         kTransactionServiceName,
+                         op->transaction_path.c_str(),
+                         kTransactionServiceRequestInterface,
+                         "GetPreview",
+                         nullptr,
+                         G_VARIANT_TYPE("(asasasasasx)"),
+                         G_DBUS_CALL_FLAGS_NONE,
+                         -1,
+                         nullptr,
+                         on_operation_preview_reply,
+                         transaction_operation_ref(op));
 }
 
 // -----------------------------------------------------------------------------
-// Resolve an upgrade-all service-backed transaction preview
+// Handle the GetPreviewFd reply. Any failure to receive or read the fd falls
+// back to GetPreview, so an older service still works.
 // -----------------------------------------------------------------------------
-bool
-transaction_service_client_preview_upgrade_all_request(TransactionPreview &preview_out,
-                                                       std::string &transaction_path_out,
-                                                       std::string &error_out)
+static void
+on_operation_preview_fd_reply(GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-  preview_out = {};
-  transaction_path_out.clear();
-  error_out.clear();
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  GError *error = nullptr;
+  GUnixFDList *fd_list = nullptr;
+  GVariant *reply =
+      g_dbus_connection_call_with_unix_fd_list_finish(G_DBUS_CONNECTION(source_object), &fd_list, res, &error);
+
+  if (!op->completed) {
+    std::string read_error;
+    bool ok = false;
+    if (reply && fd_list) {
+      gint32 handle = -1;
+      g_variant_get(reply, "(h)", &handle);
+      const int fd = g_unix_fd_list_get(fd_list, handle, &error);
+      if (fd >= 0) {
+        ok = transaction_preview_payload_read_memfd(fd, op->preview, read_error);
+        close(fd);
+      }
+    }
 
-  std::string connect_error;
-  GDBusConnection *connection = connect_transaction_service(connect_error);
-  if (!connection) {
-    error_out = connect_error;
-    return false;
+    if (ok) {
+      transaction_operation_complete(op, true, "");
+    } else {
+      DNFUI_TRACE("Transaction service client preview fd unavailable path=%s error=%s",
+                  op->transaction_path.c_str(),
+                  error ? error->message : read_error.c_str());
+      transaction_operation_request_preview_arrays(op);
+    }
   }
 
-  if (!start_upgrade_all_transaction_request(connection, transaction_path_out, error_out)) {
-    g_object_unref(connection);
-    return false;
+  g_clear_error(&error);
+  if (fd_list) {
+    g_object_unref(fd_list);
+  }
+  if (reply) {
+    g_variant_unref(reply);
   }
+  transaction_operation_unref(op);
+}
 
-  if (!wait_for_started_transaction_preview(connection, transaction_path_out, preview_out, error_out)) {
-    g_object_unref(connection);
+// -----------------------------------------------------------------------------
+// Read the ready preview, as a sealed fd when the connection passes fds.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_request_preview(TransactionServiceOperation *op)
+{
+  if (!(g_dbus_connection_get_capabilities(op->connection) & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING)) {
+    transaction_operation_request_preview_arrays(op);
+    return;
+  }
+
+  g_dbus_connection_call_with_unix_fd_list(op->connection,
+                                           kTransactionServiceName,
+                                           op->transaction_path.c_str(),
+                                           kTransactionServiceRequestInterface,
+                                           "GetPreviewFd",
+                                           nullptr,
+                                           G_VARIANT_TYPE("(h)"),
+                                           G_DBUS_CALL_FLAGS_NONE,
+                                           -1,
+                                           nullptr,
+                                           nullptr,
+                                           on_operation_preview_fd_reply,
+                                           transaction_operation_ref(op));
+}
+
+// -----------------------------------------------------------------------------
+// Act on the final state of the request, from Finished or from GetResult.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_handle_final(TransactionServiceOperation *op, const TransactionServiceResult &result)
+{
+  if (op->completed || !op->waiting) {
+    return;
+  }
+  transaction_operation_unsubscribe(op);
+
+  DNFUI_TRACE("Transaction service client stage path=%s stage=%s finished=%d success=%d",
+              op->transaction_path.c_str(),
+              result.stage.c_str(),
+              result.finished ? 1 : 0,
+              result.success ? 1 : 0);
+
+  if (op->apply) {
+    if (result.stage != "apply-succeeded" || !result.finished || !result.success) {
+      transaction_operation_complete(
+          op, false, result.details.empty() ? _("Privileged apply failed.") : result.details);
+      return;
+    }
+
+    transaction_operation_progress(op,
+                                   result.details.empty() ? _("Transaction applied successfully.") : result.details);
+    DNFUI_TRACE("Transaction service client apply done path=%s", op->transaction_path.c_str());
+    transaction_operation_complete(op, true, "");
+    return;
+  }
+
+  if (result.stage != "preview-ready" || !result.finished || !result.success) {
+    transaction_operation_complete(
+        op, false, result.details.empty() ? _("Privileged transaction preview failed.") : result.details);
+    return;
+  }
+  // The preview finished before the service saw the cancel.
+  if (op->cancel_requested) {
+    transaction_operation_complete(op, false, _("Transaction preview cancelled."));
+    return;
+  }
+
+  transaction_operation_request_preview(op);
+}
+
+// -----------------------------------------------------------------------------
+// Handle the first GetResult reply after the Finished subscription exists.
+// -----------------------------------------------------------------------------
+static void
+on_operation_result_reply(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  std::string error;
+  GVariant *reply = transaction_operation_finish_call(source_object, res, error);
+  if (!op->completed && op->waiting) {
+    if (!reply) {
+      transaction_operation_complete(
+          op, false, error.empty() ? _("Failed to read transaction service result.") : error);
+    } else {
+      TransactionServiceResult result;
+      read_transaction_result_reply(reply, result);
+      // A request still in its running stage finishes through the Finished signal.
+      if (result.stage != op->running_stage || result.finished) {
+        transaction_operation_handle_final(op, result);
+      }
+    }
+  }
+
+  if (reply) {
+    g_variant_unref(reply);
+  }
+  transaction_operation_unref(op);
+}
+
+// -----------------------------------------------------------------------------
+// Use the final state carried by the Finished signal.
+// -----------------------------------------------------------------------------
+static void
+on_operation_finished_signal(GDBusConnection *,
+                             const gchar *,
+                             const gchar *,
+                             const gchar *,
+                             const gchar *,
+                             GVariant *parameters,
+                             gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  const gchar *stage = nullptr;
+  gboolean success = FALSE;
+  const gchar *details = nullptr;
+  g_variant_get(parameters, "(&sb&s)", &stage, &success, &details);
+
+  TransactionServiceResult result;
+  result.stage = stage ? stage : "";
+  result.finished = true;
+  result.success = success;
+  result.details = details ? details : "";
+  transaction_operation_handle_final(op, result);
+}
+
+// -----------------------------------------------------------------------------
+// Fail the wait when the service loses its bus name before Finished arrives.
+// -----------------------------------------------------------------------------
+static void
+on_operation_name_owner_changed(GDBusConnection *,
+                                const gchar *,
+                                const gchar *,
+                                const gchar *,
+                                const gchar *,
+                                GVariant *parameters,
+                                gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  const gchar *name = nullptr;
+  const gchar *old_owner = nullptr;
+  const gchar *new_owner = nullptr;
+  g_variant_get(parameters, "(&s&s&s)", &name, &old_owner, &new_owner);
+  if (!op->waiting || !name || g_strcmp0(name, kTransactionServiceName) != 0 || !old_owner || !*old_owner ||
+      (new_owner && *new_owner)) {
+    return;
+  }
+
+  transaction_operation_complete(op, false, _("Transaction service disappeared while waiting for the result."));
+}
+
+// -----------------------------------------------------------------------------
+// Forward batched transaction progress lines from the service to the GUI callback
+// -----------------------------------------------------------------------------
+static void
+on_transaction_progress_signal(GDBusConnection *,
+                               const gchar *,
+                               const gchar *,
+                               const gchar *,
+                               const gchar *,
+                               GVariant *parameters,
+                               gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  if (op->completed || !op->progress_callback) {
+    return;
+  }
+
+  GVariantIter *lines = nullptr;
+  g_variant_get(parameters, "(as)", &lines);
+  const gchar *line = nullptr;
+  while (g_variant_iter_loop(lines, "&s", &line)) {
+    if (!line || !*line) {
+      continue;
+    }
+    DNFUI_TRACE("Transaction service client progress line=%s", line);
+    op->progress_callback(line);
+  }
+  g_variant_iter_free(lines);
+}
+
+// -----------------------------------------------------------------------------
+// Wait until the request leaves its running stage. Finished is subscribed
+// before the first GetResult call, which covers a service that finishes
+// between starting the request and the client beginning to wait.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_wait(TransactionServiceOperation *op)
+{
+  op->waiting = true;
+  op->finished_id = g_dbus_connection_signal_subscribe(op->connection,
+                                                       kTransactionServiceName,
+                                                       kTransactionServiceRequestInterface,
+                                                       "Finished",
+                                                       op->transaction_path.c_str(),
+                                                       nullptr,
+                                                       G_DBUS_SIGNAL_FLAGS_NONE,
+                                                       on_operation_finished_signal,
+                                                       transaction_operation_ref(op),
+                                                       transaction_operation_unref);
+  op->name_owner_changed_id = g_dbus_connection_signal_subscribe(op->connection,
+                                                                 "org.freedesktop.DBus",
+                                                                 "org.freedesktop.DBus",
+                                                                 "NameOwnerChanged",
+                                                                 "/org/freedesktop/DBus",
+                                                                 kTransactionServiceName,
+                                                                 G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                 on_operation_name_owner_changed,
+                                                                 transaction_operation_ref(op),
+                                                                 transaction_operation_unref);
+
+  g_dbus_connection_call(op->connection,
+                         kTransactionServiceName,
+                         op->transaction_path.c_str(),
+                         kTransactionServiceRequestInterface,
+                         "GetResult",
+                         nullptr,
+                         G_VARIANT_TYPE("(sbbs)"),
+                         G_DBUS_CALL_FLAGS_NONE,
+                         -1,
+                         nullptr,
+                         on_operation_result_reply,
+                         transaction_operation_ref(op));
+}
+
+// -----------------------------------------------------------------------------
+// Ask the service to cancel the preview. Its Finished signal then completes
+// the operation with an error, which releases the request.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_send_cancel(TransactionServiceOperation *op)
+{
+  DNFUI_TRACE("Transaction service client cancel path=%s", op->transaction_path.c_str());
+  g_dbus_connection_call(op->connection,
+                         kTransactionServiceName,
+                         op->transaction_path.c_str(),
+                         kTransactionServiceRequestInterface,
+                         "Cancel",
+                         nullptr,
+                         nullptr,
+                         G_DBUS_CALL_FLAGS_NONE,
+                         -1,
+                         nullptr,
+                         nullptr,
+                         nullptr);
+}
+
+// -----------------------------------------------------------------------------
+// Handle the StartTransaction or StartUpgradeAllTransaction reply.
+// -----------------------------------------------------------------------------
+static void
+on_operation_start_reply(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  std::string error;
+  GVariant *reply = transaction_operation_finish_call(source_object, res, error);
+  if (!reply) {
+    const char *fallback = op->upgrade_all ? _("Could not start the upgrade-all transaction service request.")
+                                           : _("Could not start the transaction service request.");
+    transaction_operation_complete(op, false, error.empty() ? fallback : error);
+  } else if (!read_start_transaction_reply(reply, op->transaction_path, error)) {
+    op->transaction_path.clear();
+    transaction_operation_complete(op, false, error);
+  } else {
+    DNFUI_TRACE("Transaction service client start%s path=%s",
+                op->upgrade_all ? " upgrade-all" : "",
+                op->transaction_path.c_str());
+    transaction_operation_wait(op);
+    if (op->cancel_requested) {
+      transaction_operation_send_cancel(op);
+    }
+  }
+
+  if (reply) {
+    g_variant_unref(reply);
+  }
+  transaction_operation_unref(op);
+}
+
+// -----------------------------------------------------------------------------
+// Handle the Apply reply, which arrives once authorization succeeded.
+// -----------------------------------------------------------------------------
+static void
+on_operation_apply_reply(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  std::string error;
+  GVariant *reply = transaction_operation_finish_call(source_object, res, error);
+  if (!reply) {
+    transaction_operation_complete(
+        op, false, error.empty() ? _("Could not start the privileged apply request.") : error);
+  } else {
+    g_variant_unref(reply);
+    transaction_operation_progress(op, _("Waiting for privileged apply to finish..."));
+    transaction_operation_wait(op);
+  }
+
+  transaction_operation_unref(op);
+}
+
+// -----------------------------------------------------------------------------
+// Start a request that exceeds the StartTransaction item limit by passing all
+// specs as one sealed fd, so the service resolves them in a single goal.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_start_bulk(TransactionServiceOperation *op)
+{
+  if (!(g_dbus_connection_get_capabilities(op->connection) & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING)) {
+    transaction_operation_complete(
+        op, false, _("The transaction service connection cannot pass large requests. Mark fewer packages."));
+    return;
+  }
+
+  std::string error;
+  const int fd = transaction_request_payload_create_memfd(op->bulk_payload, error);
+  if (fd < 0) {
+    transaction_operation_complete(op, false, error);
+    return;
+  }
+
+  // The fd list takes ownership of fd. The reply carries no fds, so the
+  // common start reply handler finishes the call.
+  GUnixFDList *fd_list = g_unix_fd_list_new_from_array(&fd, 1);
+  DNFUI_TRACE("Transaction service client start bulk items=%zu", op->request.item_count());
+  g_dbus_connection_call_with_unix_fd_list(op->connection,
+                                           kTransactionServiceName,
+                                           kTransactionServiceManagerPath,
+                                           kTransactionServiceManagerInterface,
+                                           "StartTransactionFd",
+                                           g_variant_new("(h)", 0),
+                                           G_VARIANT_TYPE("(o)"),
+                                           G_DBUS_CALL_FLAGS_NONE,
+                                           -1,
+                                           fd_list,
+                                           nullptr,
+                                           on_operation_start_reply,
+                                           transaction_operation_ref(op));
+  g_object_unref(fd_list);
+}
+
+// -----------------------------------------------------------------------------
+// Send the first request call once the operation has a connection.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_connected(TransactionServiceOperation *op, GDBusConnection *connection)
+{
+  op->connection = connection;
+  if (op->cancel_requested) {
+    // Cancelled while connecting, so no request exists yet.
+    transaction_operation_complete(op, false, _("Transaction preview cancelled."));
+    return;
+  }
+
+  if (op->apply) {
+    DNFUI_TRACE("Transaction service client start path=%s", op->transaction_path.c_str());
+    op->progress_id = g_dbus_connection_signal_subscribe(op->connection,
+                                                         kTransactionServiceName,
+                                                         kTransactionServiceRequestInterface,
+                                                         "ProgressBatch",
+                                                         op->transaction_path.c_str(),
+                                                         nullptr,
+                                                         G_DBUS_SIGNAL_FLAGS_NONE,
+                                                         on_transaction_progress_signal,
+                                                         transaction_operation_ref(op),
+                                                         transaction_operation_unref);
+
+    transaction_operation_progress(op, _("Privileged transaction preview ready."));
+    transaction_operation_progress(op, _("Requesting authorization and starting apply..."));
+    g_dbus_connection_call(op->connection,
+                           kTransactionServiceName,
+                           op->transaction_path.c_str(),
+                           kTransactionServiceRequestInterface,
+                           "Apply",
+                           nullptr,
+                           nullptr,
+                           G_DBUS_CALL_FLAGS_NONE,
+                           -1,
+                           nullptr,
+                           on_operation_apply_reply,
+                           transaction_operation_ref(op));
+    return;
+  }
+
+  if (!op->bulk_payload.empty()) {
+    transaction_operation_start_bulk(op);
+    return;
+  }
+
+  g_dbus_connection_call(op->connection,
+                         kTransactionServiceName,
+                         kTransactionServiceManagerPath,
+                         kTransactionServiceManagerInterface,
+                         op->upgrade_all ? "StartUpgradeAllTransaction" : "StartTransaction",
+                         op->upgrade_all ? nullptr : build_start_transaction_parameters(op->request),
+                         G_VARIANT_TYPE("(o)"),
+                         G_DBUS_CALL_FLAGS_NONE,
+                         -1,
+                         nullptr,
+                         on_operation_start_reply,
+                         transaction_operation_ref(op));
+}
+
+// -----------------------------------------------------------------------------
+// Act on a fired cancellable from the operation's main context. A request that
+// is still being created is cancelled once the service returned its path.
+// -----------------------------------------------------------------------------
+static gboolean
+dispatch_operation_cancel(gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  if (op->completed || op->cancel_requested) {
+    return G_SOURCE_REMOVE;
+  }
+
+  op->cancel_requested = true;
+  if (op->waiting) {
+    transaction_operation_send_cancel(op);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Forward a fired cancellable to the operation's main context, since
+// g_cancellable_cancel may run on another thread.
+// -----------------------------------------------------------------------------
+static void
+on_operation_cancelled(GCancellable *, gpointer user_data)
+{
+  auto *op = static_cast<TransactionServiceOperation *>(user_data);
+  GSource *source = g_idle_source_new();
+  g_source_set_callback(source, dispatch_operation_cancel, transaction_operation_ref(op), transaction_operation_unref);
+  g_source_attach(source, op->context);
+  g_source_unref(source);
+}
+
+// -----------------------------------------------------------------------------
+// Start an operation on the calling thread's default main context, reusing
+// the cached connection so concurrent requests share one bus connection.
+// -----------------------------------------------------------------------------
+static void
+transaction_operation_start(TransactionServiceOperation *op)
+{
+  op->context = g_main_context_ref_thread_default();
+  if (op->cancellable && g_cancellable_is_cancelled(op->cancellable)) {
+    transaction_operation_fail_later(op, _("Transaction preview cancelled."));
+    return;
+  }
+  if (op->cancellable) {
+    op->cancelled_id = g_cancellable_connect(op->cancellable,
+                                             G_CALLBACK(on_operation_cancelled),
+                                             transaction_operation_ref(op),
+                                             transaction_operation_unref);
+  }
+
+  transaction_operation_ref(op);
+  connect_transaction_service_async([op](GDBusConnection *connection, const std::string &error) {
+    if (!connection) {
+      transaction_operation_complete(op, false, error);
+    } else {
+      transaction_operation_connected(op, connection);
+    }
+    transaction_operation_unref(op);
+  });
+}
+
+// -----------------------------------------------------------------------------
+// Run one operation on a private main context until it completed and every
+// reply and subscription it started has let go of it.
+// -----------------------------------------------------------------------------
+static void
+run_transaction_operation_sync(TransactionServiceOperation *op)
+{
+  GMainContext *context = g_main_context_new();
+  g_main_context_push_thread_default(context);
+
+  transaction_operation_ref(op);
+  transaction_operation_start(op);
+  while (!op->completed || op->refs > 1) {
+    g_main_context_iteration(context, TRUE);
+  }
+  transaction_operation_unref(op);
+
+  g_main_context_pop_thread_default(context);
+  g_main_context_unref(context);
+}
+
+// -----------------------------------------------------------------------------
+// Create a preview operation, or report the request validation error.
+// -----------------------------------------------------------------------------
+static TransactionServiceOperation *
+new_preview_operation(const TransactionRequest *request, std::string &error_out)
+{
+  error_out.clear();
+  if (request) {
+    if (!request->validate(error_out, kTransactionRequestMaxBulkItems)) {
+      return nullptr;
+    }
+    if (request->upgrade_all) {
+      error_out = _("Use the upgrade-all preview helper for upgrade-all requests.");
+      return nullptr;
+    }
+  }
+
+  // Encode a bulk request up front, so one the service would reject as too
+  // large fails here without a connection or a D-Bus round trip.
+  std::string bulk_payload;
+  if (request && request->item_count() > kTransactionRequestMaxItems) {
+    bulk_payload = transaction_request_payload_encode(*request);
+    if (bulk_payload.size() > kTransactionRequestPayloadMaxBytes) {
+      error_out = _("The transaction request is too large. Mark fewer packages.");
+      return nullptr;
+    }
+  }
+
+  auto *op = new TransactionServiceOperation();
+  op->upgrade_all = request == nullptr;
+  if (request) {
+    op->request = *request;
+  }
+  op->bulk_payload = std::move(bulk_payload);
+  return op;
+}
+
+// -----------------------------------------------------------------------------
+// Create an apply operation, or report an empty request path.
+// -----------------------------------------------------------------------------
+static TransactionServiceOperation *
+new_apply_operation(const std::string &transaction_path,
+                    std::function<void(const std::string &)> progress_callback,
+                    std::string &error_out)
+{
+  error_out.clear();
+  if (transaction_path.empty()) {
+    error_out = _("Transaction service request path is empty.");
+    return nullptr;
+  }
+
+  auto *op = new TransactionServiceOperation();
+  op->apply = true;
+  op->running_stage = "apply-running";
+  op->transaction_path = transaction_path;
+  op->progress_callback = std::move(progress_callback);
+  transaction_operation_progress(op, _("Connecting to transaction service..."));
+  return op;
+}
+
+// -----------------------------------------------------------------------------
+// Run one preview operation synchronously and copy its result out.
+// -----------------------------------------------------------------------------
+static bool
+run_preview_operation_sync(TransactionServiceOperation *op,
+                           TransactionPreview &preview_out,
+                           std::string &transaction_path_out,
+                           std::string &error_out)
+{
+  bool ok = false;
+  op->preview_done = [&](bool success,
+                         const TransactionPreview &preview,
+                         const std::string &transaction_path,
+                         const std::string &error) {
+    ok = success;
+    preview_out = preview;
+    transaction_path_out = transaction_path;
+    error_out = error;
+  };
+  run_transaction_operation_sync(op);
+  return ok;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Resolve a service-backed transaction preview and return its request path
+// -----------------------------------------------------------------------------
+bool
+transaction_service_client_preview_request(const TransactionRequest &request,
+                                           TransactionPreview &preview_out,
+                                           std::string &transaction_path_out,
+                                           std::string &error_out)
+{
+  preview_out = {};
+  transaction_path_out.clear();
+
+  TransactionServiceOperation *op = new_preview_operation(&request, error_out);
+  if (!op) {
     return false;
   }
+  return run_preview_operation_sync(op, preview_out, transaction_path_out, error_out);
+}
 
-  g_object_unref(connection);
+// -----------------------------------------------------------------------------
+// Resolve an upgrade-all service-backed transaction preview
+// -----------------------------------------------------------------------------
+bool
+transaction_service_client_preview_upgrade_all_request(TransactionPreview &preview_out,
+                                                       std::string &transaction_path_out,
+                                                       std::string &error_out)
+{
+  preview_out = {};
+  transaction_path_out.clear();
 
-  return true;
+  TransactionServiceOperation *op = new_preview_operation(nullptr, error_out);
+  return run_preview_operation_sync(op, preview_out, transaction_path_out, error_out);
 }
 
 // -----------------------------------------------------------------------------
@@ -704,98 +1277,244 @@ transaction_service_client_apply_started_request(const std::string &transaction_
                                                  const std::function<void(const std::string &)> &progress_callback,
                                                  std::string &error_out)
 {
-  error_out.clear();
-
-  if (transaction_path.empty()) {
-    error_out = _("Transaction service request path is empty.");
+  TransactionServiceOperation *op = new_apply_operation(transaction_path, progress_callback, error_out);
+  if (!op) {
     return false;
   }
 
-  auto append_progress = [&](const std::string &message) {
-    if (progress_callback && !message.empty()) {
-      progress_callback(message);
-    }
+  bool ok = false;
+  op->apply_done = [&](bool success, const std::string &error) {
+    ok = success;
+    error_out = error;
   };
+  run_transaction_operation_sync(op);
+  return ok;
+}
 
-  append_progress(_("Connecting to transaction service..."));
+// -----------------------------------------------------------------------------
+// Start a service-backed transaction preview on the caller's main context
+// -----------------------------------------------------------------------------
+void
+transaction_service_client_preview_request_async(const TransactionRequest &request,
+                                                 TransactionServicePreviewCallback done,
+                                                 GCancellable *cancellable)
+{
+  std::string error;
+  TransactionServiceOperation *op = new_preview_operation(&request, error);
+  if (!op) {
+    op = new TransactionServiceOperation();
+    op->preview_done = std::move(done);
+    op->context = g_main_context_ref_thread_default();
+    transaction_operation_fail_later(op, error);
+    return;
+  }
 
-  std::string connect_error;
-  GDBusConnection *connection = connect_transaction_service(connect_error);
-  if (!connection) {
-    error_out = connect_error;
-    return false;
+  op->preview_done = std::move(done);
+  op->cancellable = cancellable ? G_CANCELLABLE(g_object_ref(cancellable)) : nullptr;
+  transaction_operation_start(op);
+}
+
+// -----------------------------------------------------------------------------
+// Start an upgrade-all transaction preview on the caller's main context
+// -----------------------------------------------------------------------------
+void
+transaction_service_client_preview_upgrade_all_request_async(TransactionServicePreviewCallback done,
+                                                             GCancellable *cancellable)
+{
+  std::string error;
+  TransactionServiceOperation *op = new_preview_operation(nullptr, error);
+  op->preview_done = std::move(done);
+  op->cancellable = cancellable ? G_CANCELLABLE(g_object_ref(cancellable)) : nullptr;
+  transaction_operation_start(op);
+}
+
+// -----------------------------------------------------------------------------
+// Start applying a previewed transaction request on the caller's main context
+// -----------------------------------------------------------------------------
+void
+transaction_service_client_apply_started_request_async(const std::string &transaction_path,
+                                                       std::function<void(const std::string &)> progress_callback,
+                                                       TransactionServiceApplyCallback done)
+{
+  std::string error;
+  TransactionServiceOperation *op = new_apply_operation(transaction_path, std::move(progress_callback), error);
+  if (!op) {
+    op = new TransactionServiceOperation();
+    op->apply = true;
+    op->apply_done = std::move(done);
+    op->context = g_main_context_ref_thread_default();
+    transaction_operation_fail_later(op, error);
+    return;
   }
 
-  bool ok = false;
-  TransactionServiceResult result;
-  GMainContext *signal_context = g_main_context_new();
-  g_main_context_push_thread_default(signal_context);
-  TransactionServiceProgressForwarder progress_forwarder { &progress_callback };
-  guint progress_subscription_id = 0;
-
-  do {
-    DNFUI_TRACE("Transaction service client start path=%s", transaction_path.c_str());
-    progress_subscription_id = g_dbus_connection_signal_subscribe(connection,
-                                                                  kTransactionServiceName,
-                                                                  kTransactionServiceRequestInterface,
-                                                                  "Progress",
-                                                                  transaction_path.c_str(),
-                                                                  nullptr,
-                                                                  G_DBUS_SIGNAL_FLAGS_NONE,
-                                                                  on_transaction_progress_signal,
-                                                                  &progress_forwarder,
-                                                                  nullptr);
-
-    append_progress(_("Privileged transaction preview ready."));
-    append_progress(_("Requesting authorization and starting apply..."));
-
-    GError *error = nullptr;
-    GVariant *apply_reply = g_dbus_connection_call_sync(connection,
-                                                        kTransactionServiceName,
-                                                        transaction_path.c_str(),
-                                                        kTransactionServiceRequestInterface,
-                                                        "Apply",
-                                                        nullptr,
-                                                        nullptr,
-                                                        G_DBUS_CALL_FLAGS_NONE,
-                                                        -1,
-                                                        nullptr,
-                                                        &error);
-    if (!apply_reply) {
-      error_out = error ? error->message : _("Could not start the privileged apply request.");
-      g_clear_error(&error);
-      break;
-    }
-    g_variant_unref(apply_reply);
+  op->apply_done = std::move(done);
+  transaction_operation_start(op);
+}
 
-    append_progress(_("Waiting for privileged apply to finish..."));
-    if (!wait_for_transaction_stage(connection, transaction_path, "apply-running", signal_context, result, error_out)) {
-      break;
+// -----------------------------------------------------------------------------
+// Ask the transaction service to start loading its package base
+// -----------------------------------------------------------------------------
+void
+transaction_service_client_warm_up()
+{
+  connect_transaction_service_async([](GDBusConnection *connection, const std::string &error) {
+    if (!connection) {
+      DNFUI_TRACE("Transaction service client warm up connect failed error=%s", error.c_str());
+      return;
     }
 
-    if (result.stage != "apply-succeeded" || !result.finished || !result.success) {
-      error_out = result.details.empty() ? _("Privileged apply failed.") : result.details;
-      break;
-    }
+    // Calling the manager D-Bus activates the service when it is not running.
+    g_dbus_connection_call(
+        connection,
+        kTransactionServiceName,
+        kTransactionServiceManagerPath,
+        kTransactionServiceManagerInterface,
+        "Warmup",
+        nullptr,
+        nullptr,
+        G_DBUS_CALL_FLAGS_NONE,
+        -1,
+        nullptr,
+        +[](GObject *source_object, GAsyncResult *res, gpointer) {
+          GError *error = nullptr;
+          GVariant *reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res, &error);
+          if (!reply) {
+            DNFUI_TRACE("Transaction service client warm up failed error=%s", error ? error->message : "");
+            g_clear_error(&error);
+            return;
+          }
+          DNFUI_TRACE("Transaction service client warm up requested");
+          g_variant_unref(reply);
+        },
+        nullptr);
+    g_object_unref(connection);
+  });
+}
+
+// -----------------------------------------------------------------------------
+// Call one read-only query method on the manager and return its reply, or
+// nullptr with error_out set.
+// -----------------------------------------------------------------------------
+static GVariant *
+call_transaction_service_query(const char *method_name,
+                               GVariant *parameters,
+                               const GVariantType *reply_type,
+                               std::string &error_out)
+{
+  error_out.clear();
+  GDBusConnection *connection = connect_transaction_service(error_out);
+  if (!connection) {
+    g_variant_unref(g_variant_ref_sink(parameters));
+    return nullptr;
+  }
 
-    append_progress(result.details.empty() ? _("Transaction applied successfully.") : result.details);
-    DNFUI_TRACE("Transaction service client apply done path=%s", transaction_path.c_str());
-    ok = true;
-  } while (false);
+  // The first query may load the package base of the service, including
+  // repository metadata, so it gets far longer than the D-Bus default.
+  constexpr int kQueryTimeoutMs = 10 * 60 * 1000;
+  GError *error = nullptr;
+  GVariant *reply = g_dbus_connection_call_sync(connection,
+                                                kTransactionServiceName,
+                                                kTransactionServiceManagerPath,
+                                                kTransactionServiceManagerInterface,
+                                                method_name,
+                                                parameters,
+                                                reply_type,
+                                                G_DBUS_CALL_FLAGS_NONE,
+                                                kQueryTimeoutMs,
+                                                nullptr,
+                                                &error);
+  if (!reply) {
+    error_out = error ? error->message : _("The transaction service package query failed.");
+    g_clear_error(&error);
+  }
+  g_object_unref(connection);
+  return reply;
+}
 
+// -----------------------------------------------------------------------------
+// Unpack one package page reply and release it.
+// -----------------------------------------------------------------------------
+static bool
+read_transaction_service_page(GVariant *reply,
+                              size_t offset,
+                              TransactionServicePackagePage &page_out,
+                              std::string &error_out)
+{
+  const bool ok = transaction_service_package_page_from_variant(reply, page_out);
+  g_variant_unref(reply);
   if (!ok) {
-    DNFUI_TRACE(
-        "Transaction service client apply failed path=%s error=%s", transaction_path.c_str(), error_out.c_str());
+    error_out = _("The transaction service returned an unreadable package page.");
+    return false;
   }
+  page_out.offset = offset;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Run a ranked search on the service Base with the given flags.
+// -----------------------------------------------------------------------------
+bool
+transaction_service_client_search_packages(const std::string &pattern,
+                                           const DnfBackendSearchOptions &options,
+                                           size_t offset,
+                                           size_t limit,
+                                           TransactionServicePackagePage &page_out,
+                                           std::string &error_out)
+{
+  page_out = TransactionServicePackagePage();
+  GVariant *reply = call_transaction_service_query("SearchPackages",
+                                                   g_variant_new("(sbbuu)",
+                                                                 pattern.c_str(),
+                                                                 options.search_in_description,
+                                                                 options.exact_match,
+                                                                 static_cast<guint32>(offset),
+                                                                 static_cast<guint32>(limit)),
+                                                   G_VARIANT_TYPE(kTransactionServicePackagePageType),
+                                                   error_out);
+  return reply && read_transaction_service_page(reply, offset, page_out, error_out);
+}
+
+// -----------------------------------------------------------------------------
+// Read one page of a fixed package list from the service Base.
+// -----------------------------------------------------------------------------
+bool
+transaction_service_client_list_packages(TransactionServicePackageView view,
+                                         size_t offset,
+                                         size_t limit,
+                                         TransactionServicePackagePage &page_out,
+                                         std::string &error_out)
+{
+  page_out = TransactionServicePackagePage();
+  GVariant *reply = call_transaction_service_query("ListPackages",
+                                                   g_variant_new("(suu)",
+                                                                 transaction_service_package_view_name(view),
+                                                                 static_cast<guint32>(offset),
+                                                                 static_cast<guint32>(limit)),
+                                                   G_VARIANT_TYPE(kTransactionServicePackagePageType),
+                                                   error_out);
+  return reply && read_transaction_service_page(reply, offset, page_out, error_out);
+}
 
-  if (progress_subscription_id != 0) {
-    g_dbus_connection_signal_unsubscribe(connection, progress_subscription_id);
+// -----------------------------------------------------------------------------
+// Read the details text of one package from the service Base.
+// -----------------------------------------------------------------------------
+bool
+transaction_service_client_get_package_details(const std::string &nevra,
+                                               std::string &details_out,
+                                               std::string &error_out)
+{
+  details_out.clear();
+  GVariant *reply = call_transaction_service_query(
+      "GetPackageDetails", g_variant_new("(s)", nevra.c_str()), G_VARIANT_TYPE("(s)"), error_out);
+  if (!reply) {
+    return false;
   }
-  g_main_context_pop_thread_default(signal_context);
-  g_main_context_unref(signal_context);
-  g_object_unref(connection);
 
-  return ok;
+  const gchar *details = nullptr;
+  g_variant_get(reply, "(&s)", &details);
+  details_out = details ? details : "";
+  g_variant_unref(reply);
+  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -6,11 +6,17 @@
 // -----------------------------------------------------------------------------
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <string>
 
+#include <gio/gio.h>
+
+struct DnfBackendSearchOptions;
 struct TransactionRequest;
 struct TransactionPreview;
+struct TransactionServicePackagePage;
+enum class TransactionServicePackageView;
 
 // -----------------------------------------------------------------------------
 // Prepare one transaction through the service and return its resolved preview.
@@ -33,6 +39,62 @@ bool transaction_service_client_apply_started_request(const std::string &transac
                                                       const std::function<void(const std::string &)> &progress_callback,
                                                       std::string &error_out);
 
+// -----------------------------------------------------------------------------
+// Completion callbacks for the asynchronous request helpers. On failure the
+// preview is empty, the path is empty, and error holds the reason.
+// -----------------------------------------------------------------------------
+using TransactionServicePreviewCallback = std::function<
+    void(bool ok, const TransactionPreview &preview, const std::string &transaction_path, const std::string &error)>;
+using TransactionServiceApplyCallback = std::function<void(bool ok, const std::string &error)>;
+
+// -----------------------------------------------------------------------------
+// Asynchronous variants of the helpers above. They return at once and run on
+// the calling thread's default main context, which must be running: progress
+// and the single done callback are dispatched there, never from inside the
+// start call. Several requests can be in flight on the shared connection.
+// Cancelling a preview's cancellable asks the service to stop it. The done
+// callback then reports an error and the request is released. A preview that
+// was already resolved still completes normally.
+// -----------------------------------------------------------------------------
+void transaction_service_client_preview_request_async(const TransactionRequest &request,
+                                                      TransactionServicePreviewCallback done,
+                                                      GCancellable *cancellable = nullptr);
+void transaction_service_client_preview_upgrade_all_request_async(TransactionServicePreviewCallback done,
+                                                                  GCancellable *cancellable = nullptr);
+void transaction_service_client_apply_started_request_async(const std::string &transaction_path,
+                                                            std::function<void(const std::string &)> progress_callback,
+                                                            TransactionServiceApplyCallback done);
+
+// -----------------------------------------------------------------------------
+// Ask the service, starting it if needed, to load its package base in the
+// background so the first preview does not pay for the repository load.
+// Returns at once and ignores failures.
+// -----------------------------------------------------------------------------
+void transaction_service_client_warm_up();
+
+// -----------------------------------------------------------------------------
+// Read-only package queries answered from the warm package base of the
+// service, so a client can search and browse without loading its own. They
+// block until the reply arrives, so call them from worker threads. Pages hold
+// at most kTransactionServiceQueryMaxPageRows rows; request the next page
+// with offset + rows.size(). A changed generation means the package base was
+// reloaded between two pages.
+// -----------------------------------------------------------------------------
+bool transaction_service_client_search_packages(const std::string &pattern,
+                                                const DnfBackendSearchOptions &options,
+                                                size_t offset,
+                                                size_t limit,
+                                                TransactionServicePackagePage &page_out,
+                                                std::string &error_out);
+bool transaction_service_client_list_packages(TransactionServicePackageView view,
+                                              size_t offset,
+                                              size_t limit,
+                                              TransactionServicePackagePage &page_out,
+                                              std::string &error_out);
+bool transaction_service_client_get_package_details(const std::string &nevra,
+                                                    std::string &details_out,
+                                                    std::string &error_out);
+
 // -----------------------------------------------------------------------------
 // Release one finished transaction request that is no longer needed.
 // -----------------------------------------------------------------------------
@@ -0,0 +1,249 @@
+// -----------------------------------------------------------------------------
+// src/ui/idle_memory_reclaim.cpp
+// Idle memory reclamation
+// Tracks window input and, once the window stayed idle with no query or
+// transaction running, drops cached query state and trims the heap.
+// -----------------------------------------------------------------------------
+#include "idle_memory_reclaim.hpp"
+
+#include "base_manager.hpp"
+#include "config.hpp"
+#include "debug_trace.hpp"
+#include "dnf_backend/dnf_backend.hpp"
+#include "package_query_controller.hpp"
+#include "search_prewarm.hpp"
+#include "task_executor.hpp"
+#include "widgets.hpp"
+#include "widgets_internal.hpp"
+
+#include <memory>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+// How often the idle time is checked. The idle period is given in minutes, so
+// reclaiming up to a minute late does not matter.
+constexpr guint kCheckSeconds = 60;
+
+// -----------------------------------------------------------------------------
+// Input tracking and check timer of the running window.
+// -----------------------------------------------------------------------------
+struct IdleMemoryReclaim {
+  std::weak_ptr<SearchWidgets> widgets;
+  GtkWindow *window = nullptr;
+  int64_t idle_us = 0;
+  bool release_base = false;
+  // Monotonic time of the last input event.
+  int64_t last_activity_us = 0;
+  // Set once the caches were dropped for the current idle stretch.
+  bool reclaimed = false;
+  // Set when that reclaim also released the Base.
+  bool base_released = false;
+  guint check_source_id = 0;
+};
+
+IdleMemoryReclaim *g_reclaim = nullptr;
+
+// -----------------------------------------------------------------------------
+// Drop the timer once the window is gone.
+// -----------------------------------------------------------------------------
+void
+stop_reclaim()
+{
+  if (!g_reclaim) {
+    return;
+  }
+
+  if (g_reclaim->check_source_id != 0) {
+    g_source_remove(g_reclaim->check_source_id);
+  }
+  delete g_reclaim;
+  g_reclaim = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Return true while a query, preview, or apply runs. Reclaiming then would
+// drop results the running task is about to use.
+// -----------------------------------------------------------------------------
+bool
+window_busy(const SearchWidgets &widgets)
+{
+  return widgets.transaction.apply_in_progress || widgets.transaction.preview_request_in_progress ||
+         widgets.transaction.speculative_preview_source_id != 0 ||
+         widgets.query_state.current_package_list_request_kind != PackageListRequestKind::NONE;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when releasing the Base would discard marked work. A prepared
+// preview is tied to the Base generation that resolved it.
+// -----------------------------------------------------------------------------
+bool
+window_holds_pending_work(const SearchWidgets &widgets)
+{
+  return !widgets.transaction.actions.empty() || widgets.transaction.prepared_preview;
+}
+
+// -----------------------------------------------------------------------------
+// Load the Base and the package index again in the background.
+// -----------------------------------------------------------------------------
+void
+on_rewarm_task(GTask *task, gpointer, gpointer, GCancellable *cancellable)
+{
+  try {
+    BaseManager::instance().acquire_read();
+    dnf_backend_warm_package_index(cancellable);
+    g_task_return_boolean(task, TRUE);
+  } catch (const std::exception &e) {
+    g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", e.what());
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Ignore re-warm errors. The next query loads the Base and reports them.
+// -----------------------------------------------------------------------------
+void
+on_rewarm_task_finished(GObject *, GAsyncResult *result, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  GTask *task = G_TASK(result);
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    return;
+  }
+
+  GError *error = nullptr;
+  if (!g_task_propagate_boolean(task, &error)) {
+    DNFUI_TRACE("Idle re-warm failed: %s", error ? error->message : "unknown error");
+    g_clear_error(&error);
+    return;
+  }
+  DNFUI_TRACE("Idle re-warm done");
+  // The reclaim dropped the cached searches along with the Base.
+  search_prewarm_schedule(widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Start loading the released Base while the user is back at the window.
+// -----------------------------------------------------------------------------
+void
+start_rewarm(IdleMemoryReclaim &reclaim, SearchWidgets *widgets)
+{
+  DNFUI_TRACE("Idle re-warm start");
+  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(reclaim.window));
+  GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_rewarm_task_finished);
+  ui_task_run_in_thread(task, on_rewarm_task, UiTaskClass::REFRESH);
+  g_object_unref(task);
+  g_object_unref(c);
+}
+
+// -----------------------------------------------------------------------------
+// Drop cached query state and return the freed heap to the system.
+// -----------------------------------------------------------------------------
+void
+reclaim_memory(IdleMemoryReclaim &reclaim, const SearchWidgets &widgets)
+{
+  package_query_clear_search_cache();
+
+  if (reclaim.release_base && !window_holds_pending_work(widgets) && BaseManager::instance().release_idle()) {
+    dnf_backend_release_package_indexes();
+    reclaim.base_released = true;
+  }
+
+#ifdef __GLIBC__
+  // glibc keeps freed blocks in its arenas, so the resident size would not
+  // shrink without an explicit trim.
+  malloc_trim(0);
+#endif
+
+  reclaim.reclaimed = true;
+  DNFUI_TRACE("Idle memory reclaimed base_released=%d", reclaim.base_released ? 1 : 0);
+}
+
+// -----------------------------------------------------------------------------
+// Reclaim once per idle stretch after the idle period passed.
+// -----------------------------------------------------------------------------
+gboolean
+on_check_timeout(gpointer user_data)
+{
+  IdleMemoryReclaim *reclaim = static_cast<IdleMemoryReclaim *>(user_data);
+  std::shared_ptr<SearchWidgets> widgets = reclaim->widgets.lock();
+  if (!widgets || widgets->window_state.destroyed) {
+    // stop_reclaim already removed this source by its id.
+    stop_reclaim();
+    return G_SOURCE_REMOVE;
+  }
+
+  if (reclaim->reclaimed || g_get_monotonic_time() - reclaim->last_activity_us < reclaim->idle_us ||
+      window_busy(*widgets)) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  reclaim_memory(*reclaim, *widgets);
+  return G_SOURCE_CONTINUE;
+}
+
+// -----------------------------------------------------------------------------
+// Note one input event. The first one after a released Base starts loading it
+// again, so the next query does not wait for the repo load.
+// -----------------------------------------------------------------------------
+gboolean
+on_window_event(GtkEventControllerLegacy *, GdkEvent *, gpointer)
+{
+  if (!g_reclaim) {
+    return FALSE;
+  }
+
+  g_reclaim->last_activity_us = g_get_monotonic_time();
+  if (!g_reclaim->reclaimed) {
+    return FALSE;
+  }
+
+  g_reclaim->reclaimed = false;
+  std::shared_ptr<SearchWidgets> widgets = g_reclaim->widgets.lock();
+  if (g_reclaim->base_released && widgets && !widgets->window_state.destroyed) {
+    start_rewarm(*g_reclaim, widgets.get());
+  }
+  g_reclaim->base_released = false;
+  return FALSE;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Watch every input event of the window in the capture phase, so events that
+// child widgets handle count as activity too.
+// -----------------------------------------------------------------------------
+void
+idle_memory_reclaim_start(GtkWindow *window, SearchWidgets *widgets)
+{
+  stop_reclaim();
+
+  const unsigned idle_seconds = config_load_idle_reclaim_seconds();
+  if (idle_seconds == 0) {
+    DNFUI_TRACE("Idle memory reclaim disabled");
+    return;
+  }
+
+  g_reclaim = new IdleMemoryReclaim();
+  g_reclaim->widgets = widgets->shared_from_this();
+  g_reclaim->window = window;
+  g_reclaim->idle_us = static_cast<int64_t>(idle_seconds) * G_USEC_PER_SEC;
+  g_reclaim->release_base = config_load_idle_release_base();
+  g_reclaim->last_activity_us = g_get_monotonic_time();
+
+  GtkEventController *controller = gtk_event_controller_legacy_new();
+  gtk_event_controller_set_propagation_phase(controller, GTK_PHASE_CAPTURE);
+  g_signal_connect(controller, "event", G_CALLBACK(on_window_event), nullptr);
+  gtk_widget_add_controller(GTK_WIDGET(window), controller);
+
+  g_reclaim->check_source_id = g_timeout_add_seconds(kCheckSeconds, on_check_timeout, g_reclaim);
+  DNFUI_TRACE("Idle memory reclaim started idle_seconds=%u release_base=%d",
+              idle_seconds,
+              g_reclaim->release_base ? 1 : 0);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
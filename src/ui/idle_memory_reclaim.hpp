@@ -0,0 +1,25 @@
+// -----------------------------------------------------------------------------
+// src/ui/idle_memory_reclaim.hpp
+// Idle memory reclamation
+//
+// Drops the search and details caches once the window saw no input for the
+// configured idle period, optionally releases the libdnf5 Base as well, and
+// hands the freed heap back to the system. The rows on screen stay as they
+// are, and the first input after a released Base loads it again in the
+// background.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <gtk/gtk.h>
+
+struct SearchWidgets;
+
+// -----------------------------------------------------------------------------
+// Start tracking input on window for the lifetime of the window behind
+// widgets. Does nothing when idle_reclaim_minutes is 0 in the config file.
+// -----------------------------------------------------------------------------
+void idle_memory_reclaim_start(GtkWindow *window, SearchWidgets *widgets);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
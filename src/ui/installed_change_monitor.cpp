@@ -0,0 +1,196 @@
+// -----------------------------------------------------------------------------
+// src/ui/installed_change_monitor.cpp
+// Installed package change monitor
+// Debounces file monitor events on the installed-state directories and hands
+// real changes to the post-transaction rebuild of the query controller.
+// -----------------------------------------------------------------------------
+#include "installed_change_monitor.hpp"
+
+#include "base_manager.hpp"
+#include "base_state_fingerprint.hpp"
+#include "debug_trace.hpp"
+#include "package_query_controller.hpp"
+#include "widgets.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gio/gio.h>
+
+namespace {
+
+// rpm and libdnf5 write their databases many times during one transaction, so
+// the check waits until no event arrived for this long.
+constexpr guint kSettleSeconds = 2;
+// Safety net for file systems that do not deliver change events.
+constexpr guint kFallbackSeconds = 30 * 60;
+
+// -----------------------------------------------------------------------------
+// File monitors and timers of the running window.
+// -----------------------------------------------------------------------------
+struct InstalledChangeMonitor {
+  std::weak_ptr<SearchWidgets> widgets;
+  std::vector<GFileMonitor *> monitors;
+  guint settle_source_id = 0;
+  guint fallback_source_id = 0;
+};
+
+InstalledChangeMonitor *g_monitor = nullptr;
+
+void schedule_settle_check(InstalledChangeMonitor &monitor);
+
+// -----------------------------------------------------------------------------
+// Drop the monitors and timers once the window is gone.
+// -----------------------------------------------------------------------------
+void
+stop_monitor()
+{
+  if (!g_monitor) {
+    return;
+  }
+
+  for (GFileMonitor *file_monitor : g_monitor->monitors) {
+    g_file_monitor_cancel(file_monitor);
+    g_object_unref(file_monitor);
+  }
+  if (g_monitor->settle_source_id != 0) {
+    g_source_remove(g_monitor->settle_source_id);
+  }
+  if (g_monitor->fallback_source_id != 0) {
+    g_source_remove(g_monitor->fallback_source_id);
+  }
+  delete g_monitor;
+  g_monitor = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuild when the installed state on disk no longer matches the published
+// Base. Returns false once the window is gone and the monitor was stopped.
+// -----------------------------------------------------------------------------
+bool
+check_installed_state(InstalledChangeMonitor &monitor)
+{
+  std::shared_ptr<SearchWidgets> widgets = monitor.widgets.lock();
+  if (!widgets || widgets->window_state.destroyed) {
+    stop_monitor();
+    return false;
+  }
+
+  // The rebuild after the apply picks up the final state. Check again later,
+  // in case the apply is given up and no rebuild follows.
+  if (widgets->transaction.apply_in_progress) {
+    schedule_settle_check(monitor);
+    return true;
+  }
+
+  // Reads, our own rebuilds, and transactions this app already rebuilt for
+  // leave the stamps of the published Base matching the files.
+  if (!BaseManager::instance().published_installed_state_changed()) {
+    DNFUI_TRACE("Installed state check found no change");
+    return true;
+  }
+
+  DNFUI_TRACE("Installed state changed outside the app, rebuilding");
+  package_query_rebuild_after_installed_change(widgets.get());
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Run the check once the installed-state files stopped changing.
+// -----------------------------------------------------------------------------
+gboolean
+on_settle_timeout(gpointer user_data)
+{
+  InstalledChangeMonitor *monitor = static_cast<InstalledChangeMonitor *>(user_data);
+  monitor->settle_source_id = 0;
+  check_installed_state(*monitor);
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Restart the settle timer, so a burst of writes runs one check at its end.
+// -----------------------------------------------------------------------------
+void
+schedule_settle_check(InstalledChangeMonitor &monitor)
+{
+  if (monitor.settle_source_id != 0) {
+    g_source_remove(monitor.settle_source_id);
+  }
+  monitor.settle_source_id = g_timeout_add_seconds(kSettleSeconds, on_settle_timeout, &monitor);
+}
+
+// -----------------------------------------------------------------------------
+// Run the fallback check.
+// -----------------------------------------------------------------------------
+gboolean
+on_fallback_timeout(gpointer user_data)
+{
+  InstalledChangeMonitor *monitor = static_cast<InstalledChangeMonitor *>(user_data);
+  if (!check_installed_state(*monitor)) {
+    // stop_monitor already removed this source by its id.
+    return G_SOURCE_REMOVE;
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+// -----------------------------------------------------------------------------
+// Note one file event. Events that cannot change installed state are ignored.
+// -----------------------------------------------------------------------------
+void
+on_installed_state_file_changed(GFileMonitor *, GFile *file, GFile *, GFileMonitorEvent event, gpointer user_data)
+{
+  if (event == G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED || event == G_FILE_MONITOR_EVENT_PRE_UNMOUNT ||
+      event == G_FILE_MONITOR_EVENT_UNMOUNTED) {
+    return;
+  }
+
+  char *path = g_file_get_path(file);
+  const bool tracked = path && base_state_fingerprint_tracks_file(path);
+  g_free(path);
+  if (tracked) {
+    schedule_settle_check(*static_cast<InstalledChangeMonitor *>(user_data));
+  }
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Watch the installed-state directories of the host install root, which is
+// the one the app Base loads. Missing directories are skipped.
+// -----------------------------------------------------------------------------
+void
+installed_change_monitor_start(SearchWidgets *widgets)
+{
+  stop_monitor();
+  g_monitor = new InstalledChangeMonitor();
+  g_monitor->widgets = widgets->shared_from_this();
+
+  for (const auto &directory : base_state_fingerprint_installed_state_directories("/")) {
+    if (!g_file_test(directory.c_str(), G_FILE_TEST_IS_DIR)) {
+      continue;
+    }
+
+    GFile *dir = g_file_new_for_path(directory.c_str());
+    GError *error = nullptr;
+    GFileMonitor *file_monitor = g_file_monitor_directory(dir, G_FILE_MONITOR_NONE, nullptr, &error);
+    g_object_unref(dir);
+    if (!file_monitor) {
+      DNFUI_TRACE("Installed state monitor unavailable for %s: %s",
+                  directory.c_str(),
+                  error ? error->message : "unknown error");
+      g_clear_error(&error);
+      continue;
+    }
+
+    g_signal_connect(file_monitor, "changed", G_CALLBACK(on_installed_state_file_changed), g_monitor);
+    g_monitor->monitors.push_back(file_monitor);
+  }
+
+  g_monitor->fallback_source_id = g_timeout_add_seconds(kFallbackSeconds, on_fallback_timeout, g_monitor);
+  DNFUI_TRACE("Installed state monitor started directories=%zu", g_monitor->monitors.size());
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,22 @@
+// -----------------------------------------------------------------------------
+// src/ui/installed_change_monitor.hpp
+// Installed package change monitor
+//
+// Watches the rpmdb and the libdnf5 system state of the host, so transactions
+// run outside the app, for example from the dnf command line, show up in the
+// window once the files settle. A long fallback timer runs the same check in
+// case file change events are not delivered.
+// -----------------------------------------------------------------------------
+#pragma once
+
+struct SearchWidgets;
+
+// -----------------------------------------------------------------------------
+// Start watching for the lifetime of the window behind widgets. A change
+// rebuilds the Base only when the published Base no longer matches the files.
+// -----------------------------------------------------------------------------
+void installed_change_monitor_start(SearchWidgets *widgets);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -6,11 +6,16 @@
 // -----------------------------------------------------------------------------
 #include "main_menu.hpp"
 
+#include "base_manager.hpp"
 #include "i18n.hpp"
+#include "package_query_cache.hpp"
 #include "package_query_controller.hpp"
+#include "task_executor.hpp"
 #include "ui_helpers.hpp"
 #include "widgets.hpp"
 
+#include <string>
+
 #ifndef DNFUI_VERSION
 #define DNFUI_VERSION "unknown"
 #endif
@@ -51,6 +56,20 @@ on_menu_clear_cache(GSimpleAction *, GVariant *, gpointer user_data)
   ui_helpers_set_status(data->widgets->query.status_label, _("Search cache cleared."), "green");
 }
 
+// -----------------------------------------------------------------------------
+// Reload only the repositories whose metadata expired from the menu.
+// -----------------------------------------------------------------------------
+static void
+on_menu_refresh_expired(GSimpleAction *, GVariant *, gpointer user_data)
+{
+  MainMenuActionData *data = static_cast<MainMenuActionData *>(user_data);
+  if (!data || !data->widgets) {
+    return;
+  }
+
+  widgets_refresh_expired_repositories(data->widgets);
+}
+
 // -----------------------------------------------------------------------------
 // Close the main window from the menu.
 // -----------------------------------------------------------------------------
@@ -101,6 +120,49 @@ on_menu_about(GSimpleAction *, GVariant *, gpointer user_data)
                         nullptr);
 }
 
+// -----------------------------------------------------------------------------
+// Show the BaseManager lock contention and rebuild counters and the search
+// cache and background task counters for debugging.
+// The report is taken once when the window opens.
+// -----------------------------------------------------------------------------
+static void
+on_menu_backend_diagnostics(GSimpleAction *, GVariant *, gpointer user_data)
+{
+  MainMenuActionData *data = static_cast<MainMenuActionData *>(user_data);
+  if (!data || !data->window) {
+    return;
+  }
+
+  const std::string report = BaseManager::instance().diagnostics_report() + package_query_cache_stats_report() +
+      ui_task_executor_stats_report();
+
+  GtkWindow *dialog = GTK_WINDOW(gtk_window_new());
+  gtk_window_set_title(dialog, _("Backend Diagnostics"));
+  gtk_window_set_default_size(dialog, 640, 420);
+  gtk_window_set_transient_for(dialog, GTK_WINDOW(data->window));
+  if (GtkApplication *app = gtk_window_get_application(GTK_WINDOW(data->window))) {
+    gtk_window_set_application(dialog, app);
+  }
+
+  GtkWidget *scroller = gtk_scrolled_window_new();
+  gtk_widget_set_hexpand(scroller, TRUE);
+  gtk_widget_set_vexpand(scroller, TRUE);
+  gtk_window_set_child(dialog, scroller);
+
+  // Use a text view so the counters can be selected and copied into reports.
+  GtkWidget *view = gtk_text_view_new();
+  gtk_text_view_set_editable(GTK_TEXT_VIEW(view), FALSE);
+  gtk_text_view_set_monospace(GTK_TEXT_VIEW(view), TRUE);
+  gtk_widget_set_margin_start(view, 10);
+  gtk_widget_set_margin_end(view, 10);
+  gtk_widget_set_margin_top(view, 10);
+  gtk_widget_set_margin_bottom(view, 10);
+  gtk_text_buffer_set_text(gtk_text_view_get_buffer(GTK_TEXT_VIEW(view)), report.c_str(), -1);
+  gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scroller), view);
+
+  gtk_window_present(dialog);
+}
+
 // -----------------------------------------------------------------------------
 // Show or hide the history panel from the menu.
 // -----------------------------------------------------------------------------
@@ -155,10 +217,12 @@ main_menu_create()
   GMenu *package_menu = g_menu_new();
   g_menu_append(package_menu, _("Clear List"), "win.clear-list");
   g_menu_append(package_menu, _("Clear Search Cache"), "win.clear-cache");
+  g_menu_append(package_menu, _("Refresh Expired Repositories"), "win.refresh-expired");
   g_menu_append_submenu(menu_bar, _("Package"), G_MENU_MODEL(package_menu));
   g_object_unref(package_menu);
 
   GMenu *help_menu = g_menu_new();
+  g_menu_append(help_menu, _("Backend Diagnostics"), "win.backend-diagnostics");
   g_menu_append(help_menu, _("About DNF UI"), "win.about");
   g_menu_append_submenu(menu_bar, _("Help"), G_MENU_MODEL(help_menu));
   g_object_unref(help_menu);
@@ -185,7 +249,7 @@ main_menu_connect_actions(const MainMenuWidgets &menu_widgets, SearchWidgets *wi
         delete static_cast<MainMenuActionData *>(p);
       });
 
-  GActionEntry entries[6] = {};
+  GActionEntry entries[8] = {};
   entries[0].name = "quit";
   entries[0].activate = on_menu_quit;
   entries[1].name = "clear-list";
@@ -200,6 +264,10 @@ main_menu_connect_actions(const MainMenuWidgets &menu_widgets, SearchWidgets *wi
   entries[4].change_state = on_menu_show_info_changed;
   entries[5].name = "about";
   entries[5].activate = on_menu_about;
+  entries[6].name = "backend-diagnostics";
+  entries[6].activate = on_menu_backend_diagnostics;
+  entries[7].name = "refresh-expired";
+  entries[7].activate = on_menu_refresh_expired;
 
   GSimpleActionGroup *actions = g_simple_action_group_new();
   g_action_map_add_action_entries(G_ACTION_MAP(actions), entries, G_N_ELEMENTS(entries), data);
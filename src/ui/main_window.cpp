@@ -9,9 +9,12 @@
 #include "config.hpp"
 #include "i18n.hpp"
 #include "main_menu.hpp"
+#include "package_info_controller.hpp"
+#include "package_query_cache.hpp"
 #include "package_query_controller.hpp"
 #include "package_table_view.hpp"
 #include "pending_transaction_controller.hpp"
+#include "search_prewarm.hpp"
 #include "ui_helpers.hpp"
 #include "widgets.hpp"
 
@@ -34,6 +37,7 @@ struct AppWidgets {
   GtkWidget *search_button = NULL;
   GtkWidget *desc_checkbox = NULL;
   GtkWidget *exact_checkbox = NULL;
+  GtkWidget *files_checkbox = NULL;
   GtkWidget *spinner = NULL;
 
   GtkWidget *list_button = NULL;
@@ -51,15 +55,26 @@ struct AppWidgets {
   GtkWidget *status_label = NULL;
   GtkWidget *inner_paned = NULL;
 
+  GtkWidget *status_filter = NULL;
+  GtkWidget *repo_filter = NULL;
+  GtkWidget *arch_filter = NULL;
+  GtkWidget *text_filter = NULL;
   GtkWidget *scrolled_list = NULL;
   GtkWidget *listbox = NULL;
   GtkWidget *notebook = NULL;
 
   GtkTextBuffer *details_buffer = NULL;
-  GtkTextBuffer *files_buffer = NULL;
+  DnfuiPackageFileListModel *files_model = NULL;
+  GtkWidget *files_filter = NULL;
+  GtkWidget *files_count_label = NULL;
+  GtkWidget *files_copy_button = NULL;
+  GtkWidget *files_stack = NULL;
+  GtkWidget *files_message_label = NULL;
   GtkTextBuffer *deps_buffer = NULL;
   GtkTextBuffer *changelog_buffer = NULL;
+  GtkWidget *changelog_scroller = NULL;
   GtkWidget *pending_list = NULL;
+  GtkWidget *pending_impact_label = NULL;
 
   GtkWidget *count_label = NULL;
   GtkWidget *warmup_label = NULL;
@@ -250,6 +265,13 @@ build_main_ui(AppWidgets *ui)
   gtk_box_append(GTK_BOX(hbox_search), exact_checkbox);
   ui->exact_checkbox = exact_checkbox;
 
+  GtkWidget *files_checkbox = gtk_check_button_new_with_label(_("Files and provides"));
+  gtk_widget_set_tooltip_text(files_checkbox,
+                              _("Find the packages that own a path such as /usr/bin/bash, or that provide a "
+                                "capability such as libc.so.6. Paths match as a prefix unless they hold * or ?"));
+  gtk_box_append(GTK_BOX(hbox_search), files_checkbox);
+  ui->files_checkbox = files_checkbox;
+
   GtkWidget *spinner = gtk_spinner_new();
   gtk_widget_set_visible(spinner, FALSE);
   gtk_box_append(GTK_BOX(hbox_search), spinner);
@@ -275,7 +297,7 @@ build_main_ui(AppWidgets *ui)
   ui->list_upgradeable_button = list_upgradeable_button;
 
   // --- Refresh Repositories button ---
-  // Triggers an asynchronous repository rebuild using BaseManager::rebuild()
+  // Triggers an asynchronous forced repository rebuild using BaseManager::rebuild()
   // Runs in a background thread to keep the GTK UI responsive
   GtkWidget *refresh_button = ui_helpers_create_icon_button("view-refresh-symbolic", _("Refresh Repositories"));
   gtk_box_append(GTK_BOX(hbox_buttons), refresh_button);
@@ -337,11 +359,43 @@ build_main_ui(AppWidgets *ui)
   gtk_paned_set_position(GTK_PANED(inner_paned), pos);
   ui->inner_paned = inner_paned;
 
-  // --- Top: package list ---
+  // --- Top: filter bar and package list ---
+  GtkWidget *vbox_list = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+  gtk_paned_set_start_child(GTK_PANED(inner_paned), vbox_list);
+
+  // The filter bar narrows the loaded rows. Choices are filled by the package table.
+  GtkWidget *filter_bar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+  gtk_widget_set_margin_start(filter_bar, 5);
+  gtk_widget_set_margin_end(filter_bar, 5);
+  gtk_widget_set_margin_top(filter_bar, 5);
+  gtk_widget_set_margin_bottom(filter_bar, 5);
+  gtk_box_append(GTK_BOX(vbox_list), filter_bar);
+
+  GtkWidget *text_filter = gtk_search_entry_new();
+  g_object_set(text_filter, "placeholder-text", _("Filter shown packages..."), NULL);
+  gtk_widget_set_hexpand(text_filter, TRUE);
+  gtk_box_append(GTK_BOX(filter_bar), text_filter);
+  ui->text_filter = text_filter;
+
+  GtkWidget *status_filter = gtk_drop_down_new(G_LIST_MODEL(gtk_string_list_new(NULL)), NULL);
+  gtk_widget_set_tooltip_text(status_filter, _("Show only packages with this status"));
+  gtk_box_append(GTK_BOX(filter_bar), status_filter);
+  ui->status_filter = status_filter;
+
+  GtkWidget *repo_filter = gtk_drop_down_new(G_LIST_MODEL(gtk_string_list_new(NULL)), NULL);
+  gtk_widget_set_tooltip_text(repo_filter, _("Show only packages from this repository"));
+  gtk_box_append(GTK_BOX(filter_bar), repo_filter);
+  ui->repo_filter = repo_filter;
+
+  GtkWidget *arch_filter = gtk_drop_down_new(G_LIST_MODEL(gtk_string_list_new(NULL)), NULL);
+  gtk_widget_set_tooltip_text(arch_filter, _("Show only packages for this architecture"));
+  gtk_box_append(GTK_BOX(filter_bar), arch_filter);
+  ui->arch_filter = arch_filter;
+
   GtkWidget *scrolled_list = gtk_scrolled_window_new();
   gtk_widget_set_hexpand(scrolled_list, TRUE);
   gtk_widget_set_vexpand(scrolled_list, TRUE);
-  gtk_paned_set_start_child(GTK_PANED(inner_paned), scrolled_list);
+  gtk_box_append(GTK_BOX(vbox_list), scrolled_list);
   ui->scrolled_list = scrolled_list;
 
   GtkWidget *listbox = gtk_list_box_new();
@@ -365,13 +419,79 @@ build_main_ui(AppWidgets *ui)
   gtk_notebook_append_page(GTK_NOTEBOOK(notebook), scrolled_details, tab_label_info);
 
   // --- Tab 2: File List ---
-  GtkTextBuffer *files_buffer = NULL;
-  GtkWidget *scrolled_files =
-      create_scrolled_text_view(_("Select an installed package to view its file list."), GTK_WRAP_NONE, &files_buffer);
-  ui->files_buffer = files_buffer;
+  GtkWidget *vbox_files = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+
+  GtkWidget *files_bar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+  gtk_widget_set_margin_start(files_bar, 5);
+  gtk_widget_set_margin_end(files_bar, 5);
+  gtk_widget_set_margin_top(files_bar, 5);
+  gtk_widget_set_margin_bottom(files_bar, 5);
+  gtk_box_append(GTK_BOX(vbox_files), files_bar);
+
+  GtkWidget *files_filter = gtk_search_entry_new();
+  g_object_set(files_filter, "placeholder-text", _("Filter files..."), NULL);
+  gtk_widget_set_hexpand(files_filter, TRUE);
+  gtk_box_append(GTK_BOX(files_bar), files_filter);
+  ui->files_filter = files_filter;
+
+  GtkWidget *files_count_label = gtk_label_new(NULL);
+  gtk_box_append(GTK_BOX(files_bar), files_count_label);
+  ui->files_count_label = files_count_label;
+
+  GtkWidget *files_copy_button = gtk_button_new_with_label(_("Copy All"));
+  gtk_widget_set_tooltip_text(files_copy_button, _("Copy the shown file paths to the clipboard"));
+  gtk_widget_set_sensitive(files_copy_button, FALSE);
+  gtk_box_append(GTK_BOX(files_bar), files_copy_button);
+  ui->files_copy_button = files_copy_button;
+
+  // The stack shows a message instead of the list when there are no files.
+  GtkWidget *files_stack = gtk_stack_new();
+  gtk_widget_set_vexpand(files_stack, TRUE);
+  gtk_box_append(GTK_BOX(vbox_files), files_stack);
+  ui->files_stack = files_stack;
+
+  GtkWidget *files_message_label = gtk_label_new(_("Select an installed package to view its file list."));
+  gtk_label_set_wrap(GTK_LABEL(files_message_label), TRUE);
+  gtk_widget_add_css_class(files_message_label, "dim-label");
+  gtk_stack_add_named(GTK_STACK(files_stack), files_message_label, "message");
+  ui->files_message_label = files_message_label;
+
+  // The list view only creates rows for the visible paths, so the full list of
+  // a large package shows without truncation.
+  GtkWidget *scrolled_files = gtk_scrolled_window_new();
+  gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled_files), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+  gtk_stack_add_named(GTK_STACK(files_stack), scrolled_files, "list");
+
+  DnfuiPackageFileListModel *files_model = package_file_list_model_new();
+  ui->files_model = files_model;
+
+  GtkListItemFactory *files_factory = gtk_signal_list_item_factory_new();
+  g_signal_connect(files_factory,
+                   "setup",
+                   G_CALLBACK(+[](GtkSignalListItemFactory *, GtkListItem *item, gpointer) {
+                     GtkWidget *label = gtk_label_new(nullptr);
+                     gtk_label_set_xalign(GTK_LABEL(label), 0.0f);
+                     gtk_widget_set_margin_start(label, 10);
+                     gtk_widget_set_margin_end(label, 10);
+                     gtk_list_item_set_child(item, label);
+                   }),
+                   NULL);
+  g_signal_connect(files_factory,
+                   "bind",
+                   G_CALLBACK(+[](GtkSignalListItemFactory *, GtkListItem *item, gpointer) {
+                     GtkStringObject *path = GTK_STRING_OBJECT(gtk_list_item_get_item(item));
+                     gtk_label_set_text(GTK_LABEL(gtk_list_item_get_child(item)),
+                                        path ? gtk_string_object_get_string(path) : "");
+                   }),
+                   NULL);
+
+  // The list view owns the selection model, which owns the file list model.
+  GtkWidget *files_view =
+      gtk_list_view_new(GTK_SELECTION_MODEL(gtk_no_selection_new(G_LIST_MODEL(files_model))), files_factory);
+  gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled_files), files_view);
 
   GtkWidget *tab_label_files = gtk_label_new(_("Files"));
-  gtk_notebook_append_page(GTK_NOTEBOOK(notebook), scrolled_files, tab_label_files);
+  gtk_notebook_append_page(GTK_NOTEBOOK(notebook), vbox_files, tab_label_files);
 
   // --- Tab 3: Dependencies ---
   GtkTextBuffer *deps_buffer = NULL;
@@ -387,14 +507,27 @@ build_main_ui(AppWidgets *ui)
   GtkWidget *scrolled_changelog =
       create_scrolled_text_view(_("Select a package to view its changelog."), GTK_WRAP_WORD, &changelog_buffer);
   ui->changelog_buffer = changelog_buffer;
+  ui->changelog_scroller = scrolled_changelog;
 
   GtkWidget *tab_label_changelog = gtk_label_new(_("Changelog"));
   gtk_notebook_append_page(GTK_NOTEBOOK(notebook), scrolled_changelog, tab_label_changelog);
 
   // --- Tab 5: Pending actions ---
+  GtkWidget *pending_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+
+  // Dependency impact of the background preview, hidden until one finished.
+  GtkWidget *pending_impact_label = gtk_label_new(NULL);
+  gtk_label_set_xalign(GTK_LABEL(pending_impact_label), 0.0);
+  gtk_label_set_wrap(GTK_LABEL(pending_impact_label), TRUE);
+  gtk_widget_add_css_class(pending_impact_label, "dim-label");
+  gtk_widget_set_visible(pending_impact_label, FALSE);
+  gtk_box_append(GTK_BOX(pending_box), pending_impact_label);
+  ui->pending_impact_label = pending_impact_label;
+
   GtkWidget *pending_scrolled = gtk_scrolled_window_new();
   gtk_widget_set_hexpand(pending_scrolled, TRUE);
   gtk_widget_set_vexpand(pending_scrolled, TRUE);
+  gtk_box_append(GTK_BOX(pending_box), pending_scrolled);
 
   GtkWidget *pending_list = gtk_list_box_new();
   // Pending rows act as direct action buttons and should not keep listbox selection state.
@@ -403,7 +536,7 @@ build_main_ui(AppWidgets *ui)
   ui->pending_list = pending_list;
 
   GtkWidget *tab_label_pending = gtk_label_new(_("Pending"));
-  gtk_notebook_append_page(GTK_NOTEBOOK(notebook), pending_scrolled, tab_label_pending);
+  gtk_notebook_append_page(GTK_NOTEBOOK(notebook), pending_box, tab_label_pending);
 
   // --- Bottom bar with item count ---
   GtkWidget *bottom_bar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
@@ -443,15 +576,26 @@ create_search_widgets(const AppWidgets *ui)
   widgets->query.status_label = GTK_LABEL(ui->status_label);
   widgets->query.desc_checkbox = GTK_CHECK_BUTTON(ui->desc_checkbox);
   widgets->query.exact_checkbox = GTK_CHECK_BUTTON(ui->exact_checkbox);
+  widgets->query.files_checkbox = GTK_CHECK_BUTTON(ui->files_checkbox);
 
   widgets->results.listbox = GTK_LIST_BOX(ui->listbox);
   widgets->results.list_scroller = GTK_SCROLLED_WINDOW(ui->scrolled_list);
   widgets->results.inner_paned = GTK_PANED(ui->inner_paned);
   widgets->results.details_buffer = ui->details_buffer;
-  widgets->results.files_buffer = ui->files_buffer;
+  widgets->results.files_model = ui->files_model;
+  widgets->results.files_filter = GTK_SEARCH_ENTRY(ui->files_filter);
+  widgets->results.files_count_label = GTK_LABEL(ui->files_count_label);
+  widgets->results.files_copy_button = GTK_BUTTON(ui->files_copy_button);
+  widgets->results.files_stack = GTK_STACK(ui->files_stack);
+  widgets->results.files_message_label = GTK_LABEL(ui->files_message_label);
   widgets->results.deps_buffer = ui->deps_buffer;
   widgets->results.changelog_buffer = ui->changelog_buffer;
+  widgets->results.details_notebook = GTK_NOTEBOOK(ui->notebook);
   widgets->results.count_label = GTK_LABEL(ui->count_label);
+  widgets->results.status_filter = GTK_DROP_DOWN(ui->status_filter);
+  widgets->results.repo_filter = GTK_DROP_DOWN(ui->repo_filter);
+  widgets->results.arch_filter = GTK_DROP_DOWN(ui->arch_filter);
+  widgets->results.text_filter = GTK_SEARCH_ENTRY(ui->text_filter);
 
   widgets->transaction.install_button = GTK_BUTTON(ui->install_button);
   widgets->transaction.remove_button = GTK_BUTTON(ui->remove_button);
@@ -460,6 +604,7 @@ create_search_widgets(const AppWidgets *ui)
   widgets->transaction.apply_button = GTK_BUTTON(ui->apply_button);
   widgets->transaction.clear_pending_button = GTK_BUTTON(ui->clear_pending_button);
   widgets->transaction.pending_list = GTK_LIST_BOX(ui->pending_list);
+  widgets->transaction.preview_impact_label = GTK_LABEL(ui->pending_impact_label);
 
   widgets->query_state.package_list_cancellable = nullptr;
   widgets->query_state.next_package_list_request_id = 1;
@@ -559,6 +704,8 @@ initialize_ui_state(SearchWidgets *widgets)
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->transaction.apply_button), FALSE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->transaction.clear_pending_button), FALSE);
 
+  package_query_cache_set_byte_budget(config_load_search_cache_bytes());
+
   ui_helpers_set_status(widgets->query.status_label, _("Ready."), "gray");
   package_table_fill_package_view(widgets, {});
 }
@@ -596,8 +743,21 @@ connect_signals(const AppWidgets *ui, SearchWidgets *widgets)
   g_signal_connect(ui->search_button, "clicked", G_CALLBACK(package_query_on_search_button_clicked), widgets);
 
   g_signal_connect(ui->entry, "activate", G_CALLBACK(package_query_on_search_button_clicked), widgets);
+  g_signal_connect(ui->entry, "changed", G_CALLBACK(package_query_on_search_entry_changed), widgets);
   g_signal_connect(ui->history_list, "row-selected", G_CALLBACK(package_query_on_history_row_selected), widgets);
 
+  g_signal_connect(ui->text_filter, "search-changed", G_CALLBACK(package_table_on_filter_text_changed), widgets);
+  g_signal_connect(
+      ui->status_filter, "notify::selected", G_CALLBACK(package_table_on_filter_choice_changed), widgets);
+  g_signal_connect(ui->repo_filter, "notify::selected", G_CALLBACK(package_table_on_filter_choice_changed), widgets);
+  g_signal_connect(ui->arch_filter, "notify::selected", G_CALLBACK(package_table_on_filter_choice_changed), widgets);
+
+  g_signal_connect(ui->notebook, "switch-page", G_CALLBACK(package_info_on_details_page_switched), widgets);
+  g_signal_connect(ui->files_filter, "search-changed", G_CALLBACK(package_info_on_files_filter_changed), widgets);
+  g_signal_connect(ui->files_copy_button, "clicked", G_CALLBACK(package_info_on_files_copy_clicked), widgets);
+  g_signal_connect(
+      ui->changelog_scroller, "edge-reached", G_CALLBACK(package_info_on_changelog_edge_reached), widgets);
+
   g_signal_connect(ui->apply_button, "clicked", G_CALLBACK(pending_transaction_on_apply_button_clicked), widgets);
   g_signal_connect(
       ui->clear_pending_button, "clicked", G_CALLBACK(pending_transaction_on_clear_pending_button_clicked), widgets);
@@ -766,11 +926,21 @@ connect_cleanup(GtkWidget *window, std::shared_ptr<SearchWidgets> widgets, GCanc
                        return;
                      }
                      widgets->window_state.destroyed = true;
+                     // Save before the cancels below, which would make the
+                     // running query look finished.
+                     package_query_save_view_snapshot(widgets);
                      if (widgets->window_state.backend_warmup_cancellable) {
                        g_cancellable_cancel(widgets->window_state.backend_warmup_cancellable);
                        g_object_unref(widgets->window_state.backend_warmup_cancellable);
                        widgets->window_state.backend_warmup_cancellable = nullptr;
                      }
+                     if (widgets->query_state.live_search_source_id) {
+                       g_source_remove(widgets->query_state.live_search_source_id);
+                       widgets->query_state.live_search_source_id = 0;
+                     }
+                     search_prewarm_cancel(widgets);
+                     package_info_cancel_details_loads(widgets);
+                     pending_transaction_cancel_background_preview(widgets);
                      if (widgets->query_state.package_list_cancellable) {
                        g_cancellable_cancel(widgets->query_state.package_list_cancellable);
                        g_object_unref(widgets->query_state.package_list_cancellable);
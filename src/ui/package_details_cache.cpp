@@ -0,0 +1,187 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_details_cache.cpp
+// Package details text cache
+// A recency list with a key index. Worker threads store loaded text and the
+// GTK thread looks it up, so every access takes the cache lock.
+// -----------------------------------------------------------------------------
+#include "package_details_cache.hpp"
+
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// Enough for a few hundred packages with long file lists and changelogs.
+static constexpr size_t kDefaultDetailsCacheBytes = 16 * 1024 * 1024;
+
+// One cached tab. The key joins the NEVRA and the tab, so the four tabs of a
+// package share the budget but are evicted on their own.
+struct CachedPackageDetails {
+  std::string key;
+  uint64_t generation;
+  std::string text;
+};
+
+static std::list<CachedPackageDetails> g_details_lru; // Most recently used first
+static std::unordered_map<std::string, std::list<CachedPackageDetails>::iterator> g_details_index;
+static size_t g_details_bytes = 0;
+static size_t g_details_budget = kDefaultDetailsCacheBytes;
+// Newest generation seen. Generations only grow, so older entries can never hit again.
+static uint64_t g_details_generation = 0;
+static std::mutex g_details_mutex; // Protects the cache state above
+
+// -----------------------------------------------------------------------------
+// Build the key of one tab of one package.
+// -----------------------------------------------------------------------------
+static std::string
+details_key_for(const std::string &nevra, PackageDetailsTab tab)
+{
+  std::string key = nevra;
+  key += '\n';
+  key += static_cast<char>('0' + static_cast<unsigned>(tab));
+  return key;
+}
+
+// -----------------------------------------------------------------------------
+// Return the bytes one entry counts against the budget.
+// -----------------------------------------------------------------------------
+static size_t
+entry_bytes(const CachedPackageDetails &entry)
+{
+  return entry.key.size() + entry.text.size();
+}
+
+// -----------------------------------------------------------------------------
+// Drop every entry. The caller holds the cache lock.
+// -----------------------------------------------------------------------------
+static void
+clear_locked()
+{
+  g_details_lru.clear();
+  g_details_index.clear();
+  g_details_bytes = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Drop one entry. The caller holds the cache lock.
+// -----------------------------------------------------------------------------
+static void
+erase_locked(std::list<CachedPackageDetails>::iterator it)
+{
+  g_details_bytes -= entry_bytes(*it);
+  g_details_index.erase(it->key);
+  g_details_lru.erase(it);
+}
+
+// -----------------------------------------------------------------------------
+// Drop the whole cache once a newer generation shows up. The caller holds the
+// cache lock.
+// -----------------------------------------------------------------------------
+static void
+observe_generation_locked(uint64_t generation)
+{
+  if (generation > g_details_generation) {
+    clear_locked();
+    g_details_generation = generation;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Clear cached package details.
+// Used together with the search cache by the Clear Cache button and refreshes.
+// -----------------------------------------------------------------------------
+void
+package_details_cache_clear()
+{
+  std::lock_guard<std::mutex> lock(g_details_mutex);
+  clear_locked();
+}
+
+// -----------------------------------------------------------------------------
+// Look up cached details text before starting a backend query.
+// -----------------------------------------------------------------------------
+bool
+package_details_cache_lookup(const std::string &nevra,
+                             PackageDetailsTab tab,
+                             uint64_t generation,
+                             std::string &out_text)
+{
+  std::lock_guard<std::mutex> lock(g_details_mutex);
+  observe_generation_locked(generation);
+  auto it = g_details_index.find(details_key_for(nevra, tab));
+  if (it == g_details_index.end()) {
+    return false;
+  }
+
+  if (it->second->generation != generation) {
+    erase_locked(it->second);
+    return false;
+  }
+
+  g_details_lru.splice(g_details_lru.begin(), g_details_lru, it->second);
+  out_text = it->second->text;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Save details text so the next visit in the same generation skips the backend.
+// Text larger than the whole budget is not cached.
+// -----------------------------------------------------------------------------
+void
+package_details_cache_store(const std::string &nevra, PackageDetailsTab tab, uint64_t generation, std::string text)
+{
+  std::lock_guard<std::mutex> lock(g_details_mutex);
+  observe_generation_locked(generation);
+  if (generation != g_details_generation) {
+    return;
+  }
+
+  std::string key = details_key_for(nevra, tab);
+  auto it = g_details_index.find(key);
+  if (it != g_details_index.end()) {
+    erase_locked(it->second);
+  }
+
+  CachedPackageDetails entry { std::move(key), generation, std::move(text) };
+  size_t bytes = entry_bytes(entry);
+  if (bytes > g_details_budget) {
+    return;
+  }
+
+  while (!g_details_lru.empty() && g_details_bytes + bytes > g_details_budget) {
+    erase_locked(std::prev(g_details_lru.end()));
+  }
+
+  g_details_lru.push_front(std::move(entry));
+  g_details_index.emplace(g_details_lru.front().key, g_details_lru.begin());
+  g_details_bytes += bytes;
+}
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Replace the byte budget and drop every entry for test setup.
+// -----------------------------------------------------------------------------
+void
+package_details_cache_reset_for_tests(size_t byte_budget)
+{
+  std::lock_guard<std::mutex> lock(g_details_mutex);
+  clear_locked();
+  g_details_budget = byte_budget;
+  g_details_generation = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Return the bytes held by the cached entries.
+// -----------------------------------------------------------------------------
+size_t
+package_details_cache_bytes_for_tests()
+{
+  std::lock_guard<std::mutex> lock(g_details_mutex);
+  return g_details_bytes;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,60 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_details_cache.hpp
+// Package details text cache
+//
+// Keeps the formatted text of recently shown details tabs, so revisiting a
+// package shows its details without another backend query. Entries are tied to
+// the BaseManager generation that produced them and share one byte budget.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Details notebook tabs, in notebook page order.
+// -----------------------------------------------------------------------------
+enum class PackageDetailsTab : unsigned {
+  INFO = 0,
+  FILES,
+  DEPS,
+  CHANGELOG,
+  COUNT,
+};
+
+// -----------------------------------------------------------------------------
+// Clear all cached package details.
+// -----------------------------------------------------------------------------
+void package_details_cache_clear();
+// -----------------------------------------------------------------------------
+// Look up the cached text of one tab for one package and generation. A hit
+// makes the entry the most recently used one.
+// -----------------------------------------------------------------------------
+bool package_details_cache_lookup(const std::string &nevra,
+                                  PackageDetailsTab tab,
+                                  uint64_t generation,
+                                  std::string &out_text);
+// -----------------------------------------------------------------------------
+// Store the text of one tab, evicting the least recently used entries that no
+// longer fit the byte budget.
+// -----------------------------------------------------------------------------
+void package_details_cache_store(const std::string &nevra,
+                                 PackageDetailsTab tab,
+                                 uint64_t generation,
+                                 std::string text);
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Replace the byte budget and drop every entry for test setup.
+// -----------------------------------------------------------------------------
+void package_details_cache_reset_for_tests(size_t byte_budget);
+// -----------------------------------------------------------------------------
+// Return the bytes held by the cached entries.
+// -----------------------------------------------------------------------------
+size_t package_details_cache_bytes_for_tests();
+#endif
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
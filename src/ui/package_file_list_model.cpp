@@ -0,0 +1,306 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_file_list_model.cpp
+// Package file list model
+// The visible paths are either the whole list or a vector of path indices
+// that pass the filter. Filtering matches an ASCII-lowered copy of the buffer,
+// which keeps the byte offsets of the original paths.
+// -----------------------------------------------------------------------------
+#include "package_file_list_model.hpp"
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct PackageFileListModelState {
+  std::shared_ptr<const PackageFileList> files;
+  // ASCII-lowered copy of files->text, built by the first filter that needs it.
+  std::string folded;
+  // ASCII-lowered filter text, empty when every path is visible.
+  std::string filter;
+  // Indices of the visible paths while a filter is set.
+  std::vector<guint> visible;
+};
+
+struct _DnfuiPackageFileListModel {
+  GObject parent_instance;
+  PackageFileListModelState *state;
+};
+
+// -----------------------------------------------------------------------------
+// Return the number of visible paths.
+// -----------------------------------------------------------------------------
+static guint
+visible_count(const PackageFileListModelState &state)
+{
+  if (!state.files) {
+    return 0;
+  }
+
+  return static_cast<guint>(state.filter.empty() ? state.files->size() : state.visible.size());
+}
+
+// -----------------------------------------------------------------------------
+// Return the item type GTK sees for every position.
+// -----------------------------------------------------------------------------
+static GType
+package_file_list_model_get_item_type(GListModel *)
+{
+  return GTK_TYPE_STRING_OBJECT;
+}
+
+// -----------------------------------------------------------------------------
+// Return the number of visible paths.
+// -----------------------------------------------------------------------------
+static guint
+package_file_list_model_get_n_items(GListModel *list)
+{
+  return visible_count(*DNFUI_PACKAGE_FILE_LIST_MODEL(list)->state);
+}
+
+// -----------------------------------------------------------------------------
+// Return a string object for one visible path.
+// -----------------------------------------------------------------------------
+static gpointer
+package_file_list_model_get_item(GListModel *list, guint position)
+{
+  const PackageFileListModelState &state = *DNFUI_PACKAGE_FILE_LIST_MODEL(list)->state;
+  if (position >= visible_count(state)) {
+    return nullptr;
+  }
+
+  const guint index = state.filter.empty() ? position : state.visible[position];
+  return gtk_string_object_new(std::string(state.files->path(index)).c_str());
+}
+
+// -----------------------------------------------------------------------------
+// Wire the GListModel interface.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_file_list_model_list_model_init(GListModelInterface *iface)
+{
+  iface->get_item_type = package_file_list_model_get_item_type;
+  iface->get_n_items = package_file_list_model_get_n_items;
+  iface->get_item = package_file_list_model_get_item;
+}
+
+G_DEFINE_TYPE_WITH_CODE(DnfuiPackageFileListModel,
+                        dnfui_package_file_list_model,
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL, dnfui_package_file_list_model_list_model_init))
+
+// -----------------------------------------------------------------------------
+// Free the model state.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_file_list_model_finalize(GObject *object)
+{
+  delete DNFUI_PACKAGE_FILE_LIST_MODEL(object)->state;
+  G_OBJECT_CLASS(dnfui_package_file_list_model_parent_class)->finalize(object);
+}
+
+// -----------------------------------------------------------------------------
+// Install the model finalizer.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_file_list_model_class_init(DnfuiPackageFileListModelClass *klass)
+{
+  G_OBJECT_CLASS(klass)->finalize = dnfui_package_file_list_model_finalize;
+}
+
+// -----------------------------------------------------------------------------
+// Allocate the model state.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_file_list_model_init(DnfuiPackageFileListModel *self)
+{
+  self->state = new PackageFileListModelState;
+}
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Return an ASCII-lowered copy of text with the same byte length.
+// -----------------------------------------------------------------------------
+std::string
+ascii_lower_copy(std::string_view text)
+{
+  std::string lowered(text);
+  for (char &c : lowered) {
+    c = g_ascii_tolower(c);
+  }
+  return lowered;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when the path at index contains the filter.
+// -----------------------------------------------------------------------------
+bool
+path_matches(const PackageFileListModelState &state, guint index)
+{
+  const std::string_view path = state.files->path(index);
+  const std::string_view folded = std::string_view(state.folded).substr(state.files->offsets[index], path.size());
+  return folded.find(state.filter) != std::string_view::npos;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuild the visible indices from every path.
+// -----------------------------------------------------------------------------
+void
+filter_all_paths(PackageFileListModelState &state)
+{
+  state.visible.clear();
+  if (!state.files || state.filter.empty()) {
+    return;
+  }
+
+  if (state.folded.empty()) {
+    state.folded = ascii_lower_copy(state.files->text);
+  }
+
+  for (guint i = 0; i < state.files->size(); ++i) {
+    if (path_matches(state, i)) {
+      state.visible.push_back(i);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Keep the visible paths that still match a filter that only got longer.
+// -----------------------------------------------------------------------------
+void
+filter_visible_paths(PackageFileListModelState &state)
+{
+  std::vector<guint> kept;
+  for (guint index : state.visible) {
+    if (path_matches(state, index)) {
+      kept.push_back(index);
+    }
+  }
+  state.visible = std::move(kept);
+}
+
+// -----------------------------------------------------------------------------
+// Release the file list reference held by unfiltered bytes.
+// -----------------------------------------------------------------------------
+void
+release_held_files(gpointer p)
+{
+  delete static_cast<std::shared_ptr<const PackageFileList> *>(p);
+}
+
+// -----------------------------------------------------------------------------
+// Release the text built for filtered bytes.
+// -----------------------------------------------------------------------------
+void
+release_text(gpointer p)
+{
+  delete static_cast<std::string *>(p);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Create an empty model.
+// -----------------------------------------------------------------------------
+DnfuiPackageFileListModel *
+package_file_list_model_new()
+{
+  return DNFUI_PACKAGE_FILE_LIST_MODEL(g_object_new(DNFUI_TYPE_PACKAGE_FILE_LIST_MODEL, nullptr));
+}
+
+// -----------------------------------------------------------------------------
+// Replace the list and announce every position as changed.
+// -----------------------------------------------------------------------------
+void
+package_file_list_model_set_files(DnfuiPackageFileListModel *model, std::shared_ptr<const PackageFileList> files)
+{
+  PackageFileListModelState &state = *model->state;
+  const guint removed = visible_count(state);
+  state.files = std::move(files);
+  state.folded.clear();
+  filter_all_paths(state);
+
+  g_list_model_items_changed(G_LIST_MODEL(model), 0, removed, visible_count(state));
+}
+
+// -----------------------------------------------------------------------------
+// A filter that contains the previous one only checks the visible paths.
+// -----------------------------------------------------------------------------
+void
+package_file_list_model_set_filter(DnfuiPackageFileListModel *model, const std::string &text)
+{
+  PackageFileListModelState &state = *model->state;
+  std::string filter = ascii_lower_copy(text);
+  if (filter == state.filter) {
+    return;
+  }
+
+  const guint removed = visible_count(state);
+  const bool narrows = !state.filter.empty() && filter.find(state.filter) != std::string::npos;
+  state.filter = std::move(filter);
+  if (narrows) {
+    filter_visible_paths(state);
+  } else {
+    filter_all_paths(state);
+  }
+
+  g_list_model_items_changed(G_LIST_MODEL(model), 0, removed, visible_count(state));
+}
+
+// -----------------------------------------------------------------------------
+// Return the number of paths in the list.
+// -----------------------------------------------------------------------------
+guint
+package_file_list_model_get_total(DnfuiPackageFileListModel *model)
+{
+  const PackageFileListModelState &state = *model->state;
+  return state.files ? static_cast<guint>(state.files->size()) : 0;
+}
+
+// -----------------------------------------------------------------------------
+// The unfiltered bytes keep the shared list alive instead of copying it.
+// -----------------------------------------------------------------------------
+GBytes *
+package_file_list_model_get_visible_bytes(DnfuiPackageFileListModel *model)
+{
+  const PackageFileListModelState &state = *model->state;
+  if (!state.files) {
+    return g_bytes_new(nullptr, 0);
+  }
+
+  if (state.filter.empty()) {
+    auto *held = new std::shared_ptr<const PackageFileList>(state.files);
+    return g_bytes_new_with_free_func((*held)->text.data(), (*held)->text.size(), release_held_files, held);
+  }
+
+  auto *text = new std::string;
+  for (guint index : state.visible) {
+    *text += state.files->path(index);
+    *text += '\n';
+  }
+  return g_bytes_new_with_free_func(text->data(), text->size(), release_text, text);
+}
+
+// -----------------------------------------------------------------------------
+// Every path in text ends with a newline, so each one starts after the last.
+// -----------------------------------------------------------------------------
+PackageFileList
+package_file_list_from_text(std::string text)
+{
+  PackageFileList files;
+  files.installed = true;
+  files.text = std::move(text);
+  for (size_t start = 0; start < files.text.size();) {
+    files.offsets.push_back(start);
+    const size_t end = files.text.find('\n', start);
+    start = end == std::string::npos ? files.text.size() : end + 1;
+  }
+  if (!files.text.empty() && files.text.back() != '\n') {
+    files.text += '\n';
+  }
+  return files;
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,53 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_file_list_model.hpp
+// Package file list model
+//
+// Shows one installed file list to a GtkListView. The paths stay in the shared
+// backend buffer, and GTK gets a string object only for the positions it asks
+// for, so a list with a hundred thousand paths costs the same to show as a
+// short one. A text filter narrows the visible paths.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <memory>
+#include <string>
+
+#include <gtk/gtk.h>
+
+#define DNFUI_TYPE_PACKAGE_FILE_LIST_MODEL (dnfui_package_file_list_model_get_type())
+G_DECLARE_FINAL_TYPE(
+    DnfuiPackageFileListModel, dnfui_package_file_list_model, DNFUI, PACKAGE_FILE_LIST_MODEL, GObject)
+
+// -----------------------------------------------------------------------------
+// Create an empty model.
+// -----------------------------------------------------------------------------
+DnfuiPackageFileListModel *package_file_list_model_new();
+// -----------------------------------------------------------------------------
+// Show another file list, or none when files is null. The current filter
+// stays applied.
+// -----------------------------------------------------------------------------
+void package_file_list_model_set_files(DnfuiPackageFileListModel *model, std::shared_ptr<const PackageFileList> files);
+// -----------------------------------------------------------------------------
+// Show only the paths that contain text, ignoring ASCII case. An empty text
+// shows every path.
+// -----------------------------------------------------------------------------
+void package_file_list_model_set_filter(DnfuiPackageFileListModel *model, const std::string &text);
+// -----------------------------------------------------------------------------
+// Return the number of paths in the list, visible or filtered out.
+// -----------------------------------------------------------------------------
+guint package_file_list_model_get_total(DnfuiPackageFileListModel *model);
+// -----------------------------------------------------------------------------
+// Return the visible paths as newline-separated text. An unfiltered list
+// shares the backend buffer instead of copying it.
+// -----------------------------------------------------------------------------
+GBytes *package_file_list_model_get_visible_bytes(DnfuiPackageFileListModel *model);
+// -----------------------------------------------------------------------------
+// Rebuild an installed file list from its newline-separated text.
+// -----------------------------------------------------------------------------
+PackageFileList package_file_list_from_text(std::string text);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -2,35 +2,93 @@
 // src/ui/package_info_controller.cpp
 // Package selection and details notebook controller
 // Handles package selection state, action-button sensitivity, and the async
-// package info load that updates the details notebook.
+// package info loads that update the details notebook. The visible tab loads
+// first, and the hidden tabs fill in later at low priority or when opened.
 // -----------------------------------------------------------------------------
 #include "package_info_controller.hpp"
 
 #include "base_manager.hpp"
 #include "debug_trace.hpp"
 #include "i18n.hpp"
+#include "package_details_cache.hpp"
+#include "package_table_view.hpp"
+#include "task_executor.hpp"
 #include "ui_helpers.hpp"
 #include "widgets.hpp"
 #include "widgets_internal.hpp"
 
-#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
-// Task data for package-info operation.
+// Wait before loading the hidden tabs, so arrowing through the list does not
+// queue reverse-dependency and changelog queries for every row it passes.
+constexpr guint kDetailsFillDelayMs = 300;
+
+// Wait for the selection to settle before loading details, so holding an arrow
+// key does not start and cancel a details load for every row it passes.
+constexpr guint kSelectionSettleMs = 80;
+
+// Rows on each side of the selection whose visible tab is prefetched into the
+// details cache.
+constexpr guint kPrefetchRows = 3;
+
+// Changelog entries formatted per page. rpmdb packages can carry thousands.
+constexpr size_t kChangelogPageEntries = 50;
+
+// Marks the start of the "more entries" note at the end of the changelog text.
+constexpr const char *kChangelogMoreMark = "changelog-more";
+
+// Task data for one details tab load.
 // Snapshot generation at dispatch time so outdated results can be dropped after
 // a Base rebuild.
 struct InfoTaskData {
   char *nevra;
   uint64_t generation;
+  PackageDetailsTab tab;
+  // Set for the first tab of a selection, which reports the load in the status bar.
+  bool report_status;
+  // First changelog entry to load. Nonzero for a "load more" page.
+  size_t first_entry;
 };
 
-// Text payload returned by the background package-info task.
+// Result of one details tab load. The Files tab returns a file list and the
+// other tabs return text. Files tab errors come back as text with no list.
 struct InfoTaskResult {
-  char *info;
-  char *files;
-  char *deps;
-  char *changelog;
+  std::string text;
+  std::shared_ptr<const PackageFileList> files;
+  // Changelog paging state after this page.
+  size_t next_entry = 0;
+  size_t total_entries = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Free the result of one package-info task.
+// -----------------------------------------------------------------------------
+static void
+info_task_result_free(gpointer p)
+{
+  delete static_cast<InfoTaskResult *>(p);
+}
+
+// Task data for one neighbour prefetch. The NEVRAs load one after another into
+// the details cache, nearest first.
+struct PrefetchTaskData {
+  std::vector<std::string> nevras;
+  uint64_t generation;
+  PackageDetailsTab tab;
 };
 
+// -----------------------------------------------------------------------------
+// Free data owned by one prefetch task.
+// -----------------------------------------------------------------------------
+static void
+prefetch_task_data_free(gpointer p)
+{
+  delete static_cast<PrefetchTaskData *>(p);
+}
+
 // -----------------------------------------------------------------------------
 // Free data owned by one package-info task.
 // -----------------------------------------------------------------------------
@@ -46,21 +104,69 @@ info_task_data_free(gpointer p)
 }
 
 // -----------------------------------------------------------------------------
-// Release the text payload returned by the background package-info task.
+// Return the requested-tab bit of one details tab.
 // -----------------------------------------------------------------------------
-static void
-info_task_result_free(gpointer p)
+static unsigned
+details_tab_bit(PackageDetailsTab tab)
 {
-  InfoTaskResult *r = static_cast<InfoTaskResult *>(p);
-  if (!r) {
-    return;
+  return 1u << static_cast<guint>(tab);
+}
+
+// -----------------------------------------------------------------------------
+// Return the tab name used in debug traces.
+// -----------------------------------------------------------------------------
+static const char *
+details_tab_trace_name(PackageDetailsTab tab)
+{
+  switch (tab) {
+  case PackageDetailsTab::INFO:
+    return "details";
+  case PackageDetailsTab::FILES:
+    return "files";
+  case PackageDetailsTab::DEPS:
+    return "dependencies";
+  case PackageDetailsTab::CHANGELOG:
+    return "changelog";
+  case PackageDetailsTab::COUNT:
+    break;
   }
+  return "";
+}
 
-  g_free(r->info);
-  g_free(r->files);
-  g_free(r->deps);
-  g_free(r->changelog);
-  g_free(r);
+// -----------------------------------------------------------------------------
+// Return the text buffer shown by one details tab. The Files tab has a list
+// view instead and returns null.
+// -----------------------------------------------------------------------------
+static GtkTextBuffer *
+details_tab_buffer(SearchWidgets *widgets, PackageDetailsTab tab)
+{
+  switch (tab) {
+  case PackageDetailsTab::INFO:
+    return widgets->results.details_buffer;
+  case PackageDetailsTab::FILES:
+    return nullptr;
+  case PackageDetailsTab::DEPS:
+    return widgets->results.deps_buffer;
+  case PackageDetailsTab::CHANGELOG:
+    return widgets->results.changelog_buffer;
+  case PackageDetailsTab::COUNT:
+    break;
+  }
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Return the details tab the notebook shows. The details tabs come first in the
+// notebook, and the Pending page after them counts as the Info tab.
+// -----------------------------------------------------------------------------
+static PackageDetailsTab
+visible_details_tab(SearchWidgets *widgets)
+{
+  int page = widgets->results.details_notebook ? gtk_notebook_get_current_page(widgets->results.details_notebook) : -1;
+  if (page >= 0 && page < static_cast<int>(PackageDetailsTab::COUNT)) {
+    return static_cast<PackageDetailsTab>(page);
+  }
+  return PackageDetailsTab::INFO;
 }
 
 // -----------------------------------------------------------------------------
@@ -85,6 +191,152 @@ set_notebook_text(GtkTextBuffer *buffer, const char *text)
   gtk_text_buffer_set_text(buffer, text ? text : "", -1);
 }
 
+// -----------------------------------------------------------------------------
+// Show a message in place of the file list.
+// -----------------------------------------------------------------------------
+static void
+show_files_message(SearchWidgets *widgets, const char *text)
+{
+  PackageResultsWidgets &results = widgets->results;
+  if (!results.files_model) {
+    return;
+  }
+
+  package_file_list_model_set_files(results.files_model, nullptr);
+  gtk_label_set_text(results.files_message_label, text ? text : "");
+  gtk_stack_set_visible_child_name(results.files_stack, "message");
+  gtk_label_set_text(results.files_count_label, "");
+  gtk_widget_set_sensitive(GTK_WIDGET(results.files_copy_button), FALSE);
+}
+
+// -----------------------------------------------------------------------------
+// Show how many paths the file list filter keeps.
+// -----------------------------------------------------------------------------
+static void
+update_files_count_label(SearchWidgets *widgets)
+{
+  PackageResultsWidgets &results = widgets->results;
+  guint shown = g_list_model_get_n_items(G_LIST_MODEL(results.files_model));
+  guint total = package_file_list_model_get_total(results.files_model);
+
+  std::string text = shown == total ? dnfui_i18n_format_count(total, "%zu file", "%zu files")
+                                    : dnfui_i18n_format(_("%u of %u files"), shown, total);
+  gtk_label_set_text(results.files_count_label, text.c_str());
+  gtk_widget_set_sensitive(GTK_WIDGET(results.files_copy_button), shown > 0);
+}
+
+// -----------------------------------------------------------------------------
+// Show a loaded file list, or the reason there is none.
+// -----------------------------------------------------------------------------
+static void
+show_file_list(SearchWidgets *widgets, std::shared_ptr<const PackageFileList> files)
+{
+  if (!widgets->results.files_model) {
+    return;
+  }
+  if (!files->installed) {
+    show_files_message(widgets, _("File list available only for installed packages."));
+    return;
+  }
+  if (files->size() == 0) {
+    show_files_message(widgets, _("No files recorded for this installed package."));
+    return;
+  }
+
+  package_file_list_model_set_files(widgets->results.files_model, std::move(files));
+  gtk_stack_set_visible_child_name(widgets->results.files_stack, "list");
+  update_files_count_label(widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Show a placeholder or error text in one details tab.
+// -----------------------------------------------------------------------------
+static void
+show_details_tab_text(SearchWidgets *widgets, PackageDetailsTab tab, const char *text)
+{
+  if (tab == PackageDetailsTab::FILES) {
+    show_files_message(widgets, text);
+    return;
+  }
+
+  set_notebook_text(details_tab_buffer(widgets, tab), text);
+}
+
+// -----------------------------------------------------------------------------
+// Show one loaded changelog page. The first page replaces the text, and later
+// pages replace the "more entries" note at the end.
+// -----------------------------------------------------------------------------
+static void
+show_changelog_page(SearchWidgets *widgets, const InfoTaskResult &result, size_t first_entry)
+{
+  PackageResultsWidgets &results = widgets->results;
+  GtkTextBuffer *buffer = results.changelog_buffer;
+  if (!buffer) {
+    return;
+  }
+
+  GtkTextMark *more_mark = gtk_text_buffer_get_mark(buffer, kChangelogMoreMark);
+  GtkTextIter end;
+  if (first_entry == 0) {
+    gtk_text_buffer_set_text(buffer, result.text.c_str(), -1);
+  } else {
+    if (more_mark) {
+      GtkTextIter start;
+      gtk_text_buffer_get_iter_at_mark(buffer, &start, more_mark);
+      gtk_text_buffer_get_end_iter(buffer, &end);
+      gtk_text_buffer_delete(buffer, &start, &end);
+    }
+    gtk_text_buffer_get_end_iter(buffer, &end);
+    gtk_text_buffer_insert(buffer, &end, result.text.c_str(), -1);
+  }
+
+  results.changelog_next_entry = result.next_entry;
+  results.changelog_total_entries = result.total_entries;
+  if (result.next_entry >= result.total_entries) {
+    return;
+  }
+
+  gtk_text_buffer_get_end_iter(buffer, &end);
+  if (more_mark) {
+    gtk_text_buffer_move_mark(buffer, more_mark, &end);
+  } else {
+    gtk_text_buffer_create_mark(buffer, kChangelogMoreMark, &end, TRUE);
+  }
+  std::string note = dnfui_i18n_format(
+      _("Showing %zu of %zu entries. Scroll down to load older entries."), result.next_entry, result.total_entries);
+  gtk_text_buffer_insert(buffer, &end, note.c_str(), -1);
+}
+
+// -----------------------------------------------------------------------------
+// Drop the queued tab fill and cancel the tab loads of the previous selection.
+// -----------------------------------------------------------------------------
+void
+package_info_cancel_details_loads(SearchWidgets *widgets)
+{
+  if (!widgets) {
+    return;
+  }
+
+  if (widgets->results.details_fill_source_id) {
+    g_source_remove(widgets->results.details_fill_source_id);
+    widgets->results.details_fill_source_id = 0;
+  }
+  if (widgets->results.details_settle_source_id) {
+    g_source_remove(widgets->results.details_settle_source_id);
+    widgets->results.details_settle_source_id = 0;
+  }
+  if (widgets->results.details_cancellable) {
+    g_cancellable_cancel(widgets->results.details_cancellable);
+    g_object_unref(widgets->results.details_cancellable);
+    widgets->results.details_cancellable = nullptr;
+  }
+  widgets->results.details_tabs_requested = 0;
+  widgets->results.details_prefetch_started = false;
+  widgets->results.changelog_next_entry = 0;
+  widgets->results.changelog_total_entries = 0;
+  widgets->results.changelog_loading_more = false;
+}
+
 // -----------------------------------------------------------------------------
 // Reset the details notebook after repopulating the main package view.
 // -----------------------------------------------------------------------------
@@ -95,8 +347,9 @@ package_info_reset_details_view(SearchWidgets *widgets)
     return;
   }
 
+  package_info_cancel_details_loads(widgets);
   set_notebook_text(widgets->results.details_buffer, _("Select a package for details."));
-  set_notebook_text(widgets->results.files_buffer, _("Select an installed package to view its file list."));
+  show_files_message(widgets, _("Select an installed package to view its file list."));
   set_notebook_text(widgets->results.deps_buffer, _("Select a package to view dependencies."));
   set_notebook_text(widgets->results.changelog_buffer, _("Select a package to view its changelog."));
 }
@@ -111,6 +364,7 @@ package_info_clear_selected_package_state(SearchWidgets *widgets)
     return;
   }
 
+  package_info_cancel_details_loads(widgets);
   widgets->results.selected_nevra.clear();
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->transaction.install_button), FALSE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->transaction.remove_button), FALSE);
@@ -124,6 +378,15 @@ package_info_clear_selected_package_state(SearchWidgets *widgets)
 static void
 update_selected_package_actions(SearchWidgets *widgets, const PackageRow &selected)
 {
+  // The last-session snapshot is read-only until the live Base replaces it.
+  if (widgets->query_state.showing_view_snapshot) {
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->transaction.install_button), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->transaction.remove_button), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->transaction.reinstall_button), FALSE);
+    ui_helpers_update_action_button_labels(widgets, selected.nevra);
+    return;
+  }
+
   // Install stays available for repo candidates. Remove remains tied to the
   // exact installed row, and reinstall is only enabled when the same NEVRA is
   // still available from a repository.
@@ -142,7 +405,30 @@ update_selected_package_actions(SearchWidgets *widgets, const PackageRow &select
 }
 
 // -----------------------------------------------------------------------------
-// Load package notebook text on a worker thread.
+// Run the backend query behind one details tab.
+// -----------------------------------------------------------------------------
+static std::string
+load_details_tab_text(PackageDetailsTab tab, const char *nevra)
+{
+  switch (tab) {
+  case PackageDetailsTab::INFO:
+    return dnf_backend_get_package_info(nevra);
+  case PackageDetailsTab::FILES:
+    // The Files tab loads a file list instead, see on_package_info_task.
+    break;
+  case PackageDetailsTab::DEPS:
+    return dnf_backend_get_package_deps(nevra);
+  case PackageDetailsTab::CHANGELOG:
+    // The Changelog tab loads pages instead, see on_package_info_task.
+    break;
+  case PackageDetailsTab::COUNT:
+    break;
+  }
+  return {};
+}
+
+// -----------------------------------------------------------------------------
+// Load the text or file list of one details tab on a worker thread.
 // -----------------------------------------------------------------------------
 static void
 on_package_info_task(GTask *task, gpointer, gpointer task_data, GCancellable *cancellable)
@@ -153,77 +439,193 @@ on_package_info_task(GTask *task, gpointer, gpointer task_data, GCancellable *ca
   }
 
   InfoTaskData *td = static_cast<InfoTaskData *>(task_data);
+  const char *tab_name = details_tab_trace_name(td->tab);
   try {
-    DNFUI_TRACE("Package info task start nevra=%s", td ? td->nevra : "");
-    InfoTaskResult *result = static_cast<InfoTaskResult *>(g_malloc0(sizeof *result));
-
-    result->info = g_strdup(dnf_backend_get_package_info(td->nevra).c_str());
-    DNFUI_TRACE("Package info details loaded nevra=%s bytes=%zu",
-                td ? td->nevra : "",
-                result->info ? std::strlen(result->info) : 0);
-
-    if (cancellable && g_cancellable_is_cancelled(cancellable)) {
-      info_task_result_free(result);
-      return_package_info_task_cancelled(task);
+    DNFUI_TRACE("Package info %s load start nevra=%s", tab_name, td->nevra);
+    auto *result = new InfoTaskResult;
+    // Error text is not cached, so a later visit tries the query again.
+    if (td->tab == PackageDetailsTab::FILES) {
+      auto files = std::make_shared<const PackageFileList>(dnf_backend_get_installed_package_file_list(td->nevra));
+      DNFUI_TRACE("Package info %s loaded nevra=%s bytes=%zu", tab_name, td->nevra, files->text.size());
+      // Only installed lists are cached. The text alone rebuilds the list, and
+      // a miss for another package reports "not installed" again cheaply.
+      if (files->installed) {
+        package_details_cache_store(td->nevra, td->tab, td->generation, files->text);
+      }
+      result->files = std::move(files);
+    } else if (td->tab == PackageDetailsTab::CHANGELOG) {
+      // Pages are not put in the details cache. The backend keeps the
+      // formatted entries of the last package, so a revisit does not format
+      // them again.
+      PackageChangelogPage page =
+          dnf_backend_get_package_changelog_page(td->nevra, td->first_entry, kChangelogPageEntries);
+      DNFUI_TRACE("Package info %s loaded nevra=%s first=%zu next=%zu total=%zu",
+                  tab_name,
+                  td->nevra,
+                  td->first_entry,
+                  page.next_entry,
+                  page.total_entries);
+      result->text = std::move(page.text);
+      result->next_entry = page.next_entry;
+      result->total_entries = page.total_entries;
+    } else {
+      result->text = load_details_tab_text(td->tab, td->nevra);
+      DNFUI_TRACE("Package info %s loaded nevra=%s bytes=%zu", tab_name, td->nevra, result->text.size());
+      package_details_cache_store(td->nevra, td->tab, td->generation, result->text);
+    }
+    g_task_return_pointer(task, result, info_task_result_free);
+  } catch (const std::exception &e) {
+    DNFUI_TRACE("Package info %s failed nevra=%s error=%s", tab_name, td->nevra, e.what());
+    // A details failure goes to the status bar. The other tabs show their
+    // error text in place, so the details that did load stay usable.
+    if (td->tab == PackageDetailsTab::INFO) {
+      g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, e.what()));
       return;
     }
+    g_task_return_pointer(task, new InfoTaskResult { e.what(), nullptr }, info_task_result_free);
+  }
+}
 
-    try {
-      DNFUI_TRACE("Package info files load start nevra=%s", td ? td->nevra : "");
-      // Limit displayed files so very large file lists can still be copied.
-      result->files = g_strdup(dnf_backend_get_installed_package_files(td->nevra, 1500).c_str());
-      DNFUI_TRACE("Package info files loaded nevra=%s bytes=%zu",
-                  td ? td->nevra : "",
-                  result->files ? std::strlen(result->files) : 0);
-    } catch (const std::exception &e) {
-      result->files = g_strdup(e.what());
-      DNFUI_TRACE("Package info files failed nevra=%s error=%s", td ? td->nevra : "", e.what());
+// -----------------------------------------------------------------------------
+// Load the cacheable text of one details tab. Returns false when there is
+// nothing to cache, such as the file list of a package that is not installed.
+// -----------------------------------------------------------------------------
+static bool
+load_cacheable_tab_text(PackageDetailsTab tab, const char *nevra, std::string &text)
+{
+  if (tab == PackageDetailsTab::FILES) {
+    PackageFileList files = dnf_backend_get_installed_package_file_list(nevra);
+    if (!files.installed) {
+      return false;
     }
+    text = std::move(files.text);
+    return true;
+  }
 
+  text = load_details_tab_text(tab, nevra);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Load one tab of the neighbouring rows into the details cache on a worker
+// thread. Rows that are already cached are skipped.
+// -----------------------------------------------------------------------------
+static void
+on_details_prefetch_task(GTask *task, gpointer, gpointer task_data, GCancellable *cancellable)
+{
+  PrefetchTaskData *td = static_cast<PrefetchTaskData *>(task_data);
+  const char *tab_name = details_tab_trace_name(td->tab);
+  size_t loaded = 0;
+
+  for (const std::string &nevra : td->nevras) {
     if (cancellable && g_cancellable_is_cancelled(cancellable)) {
-      info_task_result_free(result);
-      return_package_info_task_cancelled(task);
-      return;
+      break;
     }
 
+    std::string text;
+    if (package_details_cache_lookup(nevra, td->tab, td->generation, text)) {
+      continue;
+    }
     try {
-      DNFUI_TRACE("Package info dependencies load start nevra=%s", td ? td->nevra : "");
-      result->deps = g_strdup(dnf_backend_get_package_deps(td->nevra).c_str());
-      DNFUI_TRACE("Package info dependencies loaded nevra=%s bytes=%zu",
-                  td ? td->nevra : "",
-                  result->deps ? std::strlen(result->deps) : 0);
+      if (load_cacheable_tab_text(td->tab, nevra.c_str(), text)) {
+        package_details_cache_store(nevra, td->tab, td->generation, std::move(text));
+        ++loaded;
+      }
     } catch (const std::exception &e) {
-      result->deps = g_strdup(e.what());
-      DNFUI_TRACE("Package info dependencies failed nevra=%s error=%s", td ? td->nevra : "", e.what());
+      // The row shows its own error text if the user selects it.
+      DNFUI_TRACE("Package info %s prefetch failed nevra=%s error=%s", tab_name, nevra.c_str(), e.what());
     }
+  }
 
-    if (cancellable && g_cancellable_is_cancelled(cancellable)) {
-      info_task_result_free(result);
-      return_package_info_task_cancelled(task);
-      return;
-    }
+  DNFUI_TRACE("Package info %s prefetch loaded=%zu rows=%zu", tab_name, loaded, td->nevras.size());
+  g_task_return_boolean(task, TRUE);
+}
 
-    try {
-      DNFUI_TRACE("Package info changelog load start nevra=%s", td ? td->nevra : "");
-      result->changelog = g_strdup(dnf_backend_get_package_changelog(td->nevra).c_str());
-      DNFUI_TRACE("Package info changelog loaded nevra=%s bytes=%zu",
-                  td ? td->nevra : "",
-                  result->changelog ? std::strlen(result->changelog) : 0);
-    } catch (const std::exception &e) {
-      result->changelog = g_strdup(e.what());
-      DNFUI_TRACE("Package info changelog failed nevra=%s error=%s", td ? td->nevra : "", e.what());
+// -----------------------------------------------------------------------------
+// Prefetch the visible tab of the rows around the selection. The Changelog tab
+// and the Pending page prefetch the Info tab instead, since changelog pages are
+// not kept in the details cache.
+// -----------------------------------------------------------------------------
+static void
+start_neighbor_prefetch(SearchWidgets *widgets)
+{
+  widgets->results.details_prefetch_started = true;
+  std::vector<std::string> nevras = package_table_get_neighbor_nevras(widgets, kPrefetchRows);
+  if (nevras.empty()) {
+    return;
+  }
+
+  PackageDetailsTab tab = visible_details_tab(widgets);
+  if (tab == PackageDetailsTab::CHANGELOG) {
+    tab = PackageDetailsTab::INFO;
+  }
+
+  if (!widgets->results.details_cancellable) {
+    widgets->results.details_cancellable = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
+  }
+
+  // Nothing waits for the prefetch, so the task has no completion callback.
+  GTask *task = g_task_new(nullptr, widgets->results.details_cancellable, nullptr, nullptr);
+  auto *td = new PrefetchTaskData { std::move(nevras), BaseManager::instance().current_generation(), tab };
+  g_task_set_task_data(task, td, prefetch_task_data_free);
+  ui_task_run_in_thread(task, on_details_prefetch_task, UiTaskClass::PREFETCH);
+  g_object_unref(task);
+}
+
+// -----------------------------------------------------------------------------
+// Forward declarations, since a finished tab load queues the next one.
+// -----------------------------------------------------------------------------
+static void start_details_tab_load(SearchWidgets *widgets, PackageDetailsTab tab, bool report_status);
+static void start_info_task(SearchWidgets *widgets, PackageDetailsTab tab, bool report_status, size_t first_entry);
+
+// -----------------------------------------------------------------------------
+// Load the first hidden details tab that has not been requested yet.
+// -----------------------------------------------------------------------------
+static gboolean
+on_details_fill_timeout(gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  widgets->results.details_fill_source_id = 0;
+  if (widgets->window_state.destroyed || widgets->results.selected_nevra.empty()) {
+    return G_SOURCE_REMOVE;
+  }
+
+  // The first fill after a selection also warms the cache for the rows next
+  // to it, so arrowing on shows their details at once.
+  if (!widgets->results.details_prefetch_started) {
+    start_neighbor_prefetch(widgets);
+  }
+
+  for (guint i = 0; i < static_cast<guint>(PackageDetailsTab::COUNT); ++i) {
+    PackageDetailsTab tab = static_cast<PackageDetailsTab>(i);
+    if (!(widgets->results.details_tabs_requested & details_tab_bit(tab))) {
+      start_details_tab_load(widgets, tab, false);
+      break;
     }
+  }
 
-    DNFUI_TRACE("Package info task done nevra=%s", td ? td->nevra : "");
-    g_task_return_pointer(task, result, info_task_result_free);
-  } catch (const std::exception &e) {
-    DNFUI_TRACE("Package info task failed nevra=%s error=%s", td ? td->nevra : "", e.what());
-    g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, e.what()));
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Queue the low-priority load of the next hidden tab, one tab at a time, and
+// the neighbour prefetch if it has not started yet.
+// -----------------------------------------------------------------------------
+static void
+schedule_details_fill(SearchWidgets *widgets)
+{
+  unsigned all_tabs = details_tab_bit(PackageDetailsTab::COUNT) - 1;
+  if (widgets->results.details_fill_source_id ||
+      (widgets->results.details_tabs_requested == all_tabs && widgets->results.details_prefetch_started)) {
+    return;
   }
+
+  widgets->results.details_fill_source_id =
+      g_timeout_add_full(G_PRIORITY_LOW, kDetailsFillDelayMs, on_details_fill_timeout, widgets, nullptr);
 }
 
 // -----------------------------------------------------------------------------
-// Update the details notebook after package text has loaded.
+// Update one details tab after its text or file list has loaded.
 // -----------------------------------------------------------------------------
 static void
 on_package_info_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
@@ -236,22 +638,22 @@ on_package_info_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
 
   const InfoTaskData *td = static_cast<const InfoTaskData *>(g_task_get_task_data(task));
   GError *error = nullptr;
-  InfoTaskResult *result = static_cast<InfoTaskResult *>(g_task_propagate_pointer(task, &error));
+  std::unique_ptr<InfoTaskResult> result(static_cast<InfoTaskResult *>(g_task_propagate_pointer(task, &error)));
 
-  if (!td) {
-    if (result) {
-      info_task_result_free(result);
-    }
+  if (!td || widgets->results.selected_nevra != td->nevra) {
     if (error) {
       g_error_free(error);
     }
     return;
   }
 
-  if (td->generation != BaseManager::instance().current_generation() || widgets->results.selected_nevra != td->nevra) {
-    if (result) {
-      info_task_result_free(result);
-    }
+  if (td->first_entry > 0) {
+    widgets->results.changelog_loading_more = false;
+  }
+
+  if (td->generation != BaseManager::instance().current_generation()) {
+    // Let a later tab switch load this tab again from the rebuilt Base.
+    widgets->results.details_tabs_requested &= ~details_tab_bit(td->tab);
     if (error) {
       g_error_free(error);
     }
@@ -266,23 +668,107 @@ on_package_info_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
     return;
   }
 
-  // Display general package information
-  set_notebook_text(widgets->results.details_buffer, result->info ? result->info : _("No details found."));
+  if (td->tab == PackageDetailsTab::CHANGELOG) {
+    show_changelog_page(widgets, *result, td->first_entry);
+  } else if (result->files) {
+    show_file_list(widgets, std::move(result->files));
+  } else {
+    show_details_tab_text(widgets, td->tab, result->text.c_str());
+  }
 
-  // Display the file list fetched by the background task.
-  set_notebook_text(widgets->results.files_buffer,
-                    result->files ? result->files : _("Select an installed package to view its file list."));
+  if (td->report_status) {
+    ui_helpers_set_status(widgets->query.status_label, _("Package info loaded."), "green");
+  }
+  schedule_details_fill(widgets);
+}
 
-  // Display dependencies fetched by the background task.
-  set_notebook_text(widgets->results.deps_buffer,
-                    result->deps ? result->deps : _("Select a package to view dependencies."));
+// -----------------------------------------------------------------------------
+// Show one tab from the details cache. Returns false when it is not cached for
+// the selected package in the current generation.
+// -----------------------------------------------------------------------------
+static bool
+show_cached_details_tab(SearchWidgets *widgets, PackageDetailsTab tab)
+{
+  std::string text;
+  if (!package_details_cache_lookup(
+          widgets->results.selected_nevra, tab, BaseManager::instance().current_generation(), text)) {
+    return false;
+  }
 
-  // Display changelog fetched by the background task.
-  set_notebook_text(widgets->results.changelog_buffer,
-                    result->changelog ? result->changelog : _("Select a package to view its changelog."));
+  widgets->results.details_tabs_requested |= details_tab_bit(tab);
+  if (tab == PackageDetailsTab::FILES) {
+    show_file_list(widgets, std::make_shared<const PackageFileList>(package_file_list_from_text(std::move(text))));
+  } else {
+    set_notebook_text(details_tab_buffer(widgets, tab), text.c_str());
+  }
+  return true;
+}
 
-  ui_helpers_set_status(widgets->query.status_label, _("Package info loaded."), "green");
-  info_task_result_free(result);
+// -----------------------------------------------------------------------------
+// Start the async load of one details tab for the selected package.
+// -----------------------------------------------------------------------------
+static void
+start_details_tab_load(SearchWidgets *widgets, PackageDetailsTab tab, bool report_status)
+{
+  if (show_cached_details_tab(widgets, tab)) {
+    if (report_status) {
+      ui_helpers_set_status(widgets->query.status_label, _("Package info loaded."), "green");
+    }
+    schedule_details_fill(widgets);
+    return;
+  }
+
+  widgets->results.details_tabs_requested |= details_tab_bit(tab);
+  start_info_task(widgets, tab, report_status, 0);
+}
+
+// -----------------------------------------------------------------------------
+// Start a worker task for one details tab of the selected package.
+// -----------------------------------------------------------------------------
+static void
+start_info_task(SearchWidgets *widgets, PackageDetailsTab tab, bool report_status, size_t first_entry)
+{
+  if (!widgets->results.details_cancellable) {
+    widgets->results.details_cancellable = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
+  }
+
+  GTask *task =
+      widgets_task_new_for_search_widgets(widgets, widgets->results.details_cancellable, on_package_info_task_finished);
+
+  // Pass package NEVRA to background task
+  InfoTaskData *td = static_cast<InfoTaskData *>(g_malloc0(sizeof *td));
+  td->nevra = g_strdup(widgets->results.selected_nevra.c_str());
+  td->generation = BaseManager::instance().current_generation();
+  td->tab = tab;
+  td->report_status = report_status;
+  td->first_entry = first_entry;
+  g_task_set_task_data(task, td, info_task_data_free);
+
+  // Run background task to fetch metadata using dnf_backend
+  ui_task_run_in_thread(task, on_package_info_task, UiTaskClass::DETAILS);
+
+  g_object_unref(task);
+}
+
+// -----------------------------------------------------------------------------
+// Load the visible tab once the selection has stayed on one row for the settle
+// delay.
+// -----------------------------------------------------------------------------
+static gboolean
+on_selection_settle_timeout(gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  widgets->results.details_settle_source_id = 0;
+  if (widgets->window_state.destroyed || widgets->results.selected_nevra.empty()) {
+    return G_SOURCE_REMOVE;
+  }
+
+  // A tab switch during the delay may already have started the visible tab.
+  PackageDetailsTab tab = visible_details_tab(widgets);
+  if (!(widgets->results.details_tabs_requested & details_tab_bit(tab))) {
+    start_details_tab_load(widgets, tab, true);
+  }
+  return G_SOURCE_REMOVE;
 }
 
 // -----------------------------------------------------------------------------
@@ -295,24 +781,107 @@ package_info_load_selected_package_info(SearchWidgets *widgets, const PackageRow
     return;
   }
 
+  package_info_cancel_details_loads(widgets);
   widgets->results.selected_nevra = selected.nevra;
   ui_helpers_set_status(widgets->query.status_label, _("Fetching package info..."), "blue");
   update_selected_package_actions(widgets, selected);
 
-  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
-  GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_package_info_task_finished);
+  // Cached tabs show at once. The others keep this text until they load, so
+  // they never show the previous package.
+  for (guint i = 0; i < static_cast<guint>(PackageDetailsTab::COUNT); ++i) {
+    PackageDetailsTab tab = static_cast<PackageDetailsTab>(i);
+    if (!show_cached_details_tab(widgets, tab)) {
+      show_details_tab_text(widgets, tab, _("Loading..."));
+    }
+  }
 
-  // Pass package NEVRA to background task
-  InfoTaskData *td = static_cast<InfoTaskData *>(g_malloc0(sizeof *td));
-  td->nevra = g_strdup(selected.nevra.c_str());
-  td->generation = BaseManager::instance().current_generation();
-  g_task_set_task_data(task, td, info_task_data_free);
+  // A cached visible tab needs no backend query, so it does not wait for the
+  // selection to settle.
+  if (widgets->results.details_tabs_requested & details_tab_bit(visible_details_tab(widgets))) {
+    ui_helpers_set_status(widgets->query.status_label, _("Package info loaded."), "green");
+    schedule_details_fill(widgets);
+    return;
+  }
 
-  // Run background task to fetch metadata using dnf_backend
-  g_task_run_in_thread(task, on_package_info_task);
+  widgets->results.details_settle_source_id = g_timeout_add(kSelectionSettleMs, on_selection_settle_timeout, widgets);
+}
 
-  g_object_unref(task);
-  g_object_unref(c);
+// -----------------------------------------------------------------------------
+// Load a details tab on demand when the user switches to it.
+// -----------------------------------------------------------------------------
+void
+package_info_on_details_page_switched(GtkNotebook *, GtkWidget *, guint page_num, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  if (!widgets || widgets->results.selected_nevra.empty() || page_num >= static_cast<guint>(PackageDetailsTab::COUNT)) {
+    return;
+  }
+
+  PackageDetailsTab tab = static_cast<PackageDetailsTab>(page_num);
+  if (!(widgets->results.details_tabs_requested & details_tab_bit(tab))) {
+    start_details_tab_load(widgets, tab, false);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Load the next changelog page once the view reaches the last loaded entry.
+// -----------------------------------------------------------------------------
+void
+package_info_on_changelog_edge_reached(GtkScrolledWindow *, GtkPositionType pos, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  if (!widgets || pos != GTK_POS_BOTTOM || widgets->results.selected_nevra.empty()) {
+    return;
+  }
+
+  PackageResultsWidgets &results = widgets->results;
+  if (results.changelog_loading_more || results.changelog_next_entry >= results.changelog_total_entries) {
+    return;
+  }
+
+  results.changelog_loading_more = true;
+  start_info_task(widgets, PackageDetailsTab::CHANGELOG, false, results.changelog_next_entry);
+}
+
+// -----------------------------------------------------------------------------
+// Narrow the file list to the paths that contain the filter text.
+// -----------------------------------------------------------------------------
+void
+package_info_on_files_filter_changed(GtkSearchEntry *entry, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  if (!widgets || !widgets->results.files_model) {
+    return;
+  }
+
+  package_file_list_model_set_filter(widgets->results.files_model, gtk_editable_get_text(GTK_EDITABLE(entry)));
+  if (package_file_list_model_get_total(widgets->results.files_model) > 0) {
+    update_files_count_label(widgets);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Copy the shown file paths to the clipboard.
+// -----------------------------------------------------------------------------
+void
+package_info_on_files_copy_clicked(GtkButton *button, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  if (!widgets || !widgets->results.files_model) {
+    return;
+  }
+
+  guint shown = g_list_model_get_n_items(G_LIST_MODEL(widgets->results.files_model));
+  GBytes *bytes = package_file_list_model_get_visible_bytes(widgets->results.files_model);
+  // The clipboard hands the bytes to the pasting app when it asks for them, so
+  // a long list is not converted to another string first.
+  GdkContentProvider *provider = gdk_content_provider_new_for_bytes("text/plain;charset=utf-8", bytes);
+  gdk_clipboard_set_content(gtk_widget_get_clipboard(GTK_WIDGET(button)), provider);
+  g_object_unref(provider);
+  g_bytes_unref(bytes);
+
+  std::string status = dnfui_i18n_format_count(shown, "Copied %zu file path.", "Copied %zu file paths.");
+  ui_helpers_set_status(widgets->query.status_label, status.c_str(), "green");
 }
 
 // -----------------------------------------------------------------------------
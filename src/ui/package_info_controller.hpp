@@ -8,6 +8,8 @@
 
 #include "dnf_backend/dnf_backend.hpp"
 
+#include <gtk/gtk.h>
+
 struct SearchWidgets;
 
 // -----------------------------------------------------------------------------
@@ -19,6 +21,27 @@ void package_info_clear_selected_package_state(SearchWidgets *widgets);
 // -----------------------------------------------------------------------------
 void package_info_load_selected_package_info(SearchWidgets *widgets, const PackageRow &selected);
 // -----------------------------------------------------------------------------
+// Load a details tab that has not loaded yet when the user switches to it.
+// -----------------------------------------------------------------------------
+void package_info_on_details_page_switched(GtkNotebook *notebook, GtkWidget *page, guint page_num, gpointer user_data);
+// -----------------------------------------------------------------------------
+// Apply the Files tab filter entry to the file list.
+// -----------------------------------------------------------------------------
+void package_info_on_files_filter_changed(GtkSearchEntry *entry, gpointer user_data);
+// -----------------------------------------------------------------------------
+// Copy the file paths shown in the Files tab to the clipboard.
+// -----------------------------------------------------------------------------
+void package_info_on_files_copy_clicked(GtkButton *button, gpointer user_data);
+// -----------------------------------------------------------------------------
+// Load the next page of older changelog entries when the changelog view is
+// scrolled to the bottom.
+// -----------------------------------------------------------------------------
+void package_info_on_changelog_edge_reached(GtkScrolledWindow *scroller, GtkPositionType pos, gpointer user_data);
+// -----------------------------------------------------------------------------
+// Cancel the details loads that are still running for the selected package.
+// -----------------------------------------------------------------------------
+void package_info_cancel_details_loads(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
 // Reset the package details notebook to its empty state.
 // -----------------------------------------------------------------------------
 void package_info_reset_details_view(SearchWidgets *widgets);
@@ -0,0 +1,751 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_list_model.cpp
+// Vector-backed package list model
+// Rows live in one vector of slots. The visible order is a permutation of the
+// slot indices the filter accepts, and each slot remembers the item object GTK
+// currently holds for it, if any, without keeping it alive.
+// -----------------------------------------------------------------------------
+#include "package_list_model.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+constexpr guint kNoSlot = G_MAXUINT;
+// Sorted inserts binary-search each position once the visible order is this
+// many times longer than the inserted rows, and merge linearly otherwise.
+constexpr size_t kGallopRatio = 16;
+
+// One stored row. The id changes whenever the visible row changes, so order
+// diffs can tell kept rows from replaced ones.
+struct PackageSlot {
+  PackageItem item;
+  DnfuiPackageRow *object = nullptr;
+  uint64_t id = 0;
+  // Cleared by begin_merge and set again for every row the merge appends.
+  bool seen = true;
+  // True while the slot is part of the visible order.
+  bool visible = false;
+};
+
+} // namespace
+
+struct PackageListModelState {
+  std::vector<PackageSlot> slots;
+  // Visible position to slot index.
+  std::vector<guint> order;
+  PackageItemCompare compare;
+  PackageItemFilter filter;
+  PackageListCounts counts;
+  uint64_t next_id = 1;
+  bool merging = false;
+  // Slots of each NEVRA, so merges and status refreshes find rows directly.
+  std::unordered_multimap<std::string, guint> slots_by_nevra;
+  // New values for merged rows whose visible data changed.
+  std::unordered_map<guint, PackageItem> updates;
+};
+
+struct _DnfuiPackageListModel {
+  GObject parent_instance;
+  PackageListModelState *state;
+};
+
+struct _DnfuiPackageRow {
+  GObject parent_instance;
+  // Strong reference, so the slot storage outlives every handed out item.
+  DnfuiPackageListModel *model;
+  guint slot;
+};
+
+G_DEFINE_TYPE(DnfuiPackageRow, dnfui_package_row, G_TYPE_OBJECT)
+
+// -----------------------------------------------------------------------------
+// Forget the row object in its slot and release the model.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_row_finalize(GObject *object)
+{
+  DnfuiPackageRow *self = DNFUI_PACKAGE_ROW(object);
+  if (self->model) {
+    auto &slots = self->model->state->slots;
+    if (self->slot < slots.size() && slots[self->slot].object == self) {
+      slots[self->slot].object = nullptr;
+    }
+    g_object_unref(self->model);
+  }
+
+  G_OBJECT_CLASS(dnfui_package_row_parent_class)->finalize(object);
+}
+
+// -----------------------------------------------------------------------------
+// Install the row finalizer.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_row_class_init(DnfuiPackageRowClass *klass)
+{
+  G_OBJECT_CLASS(klass)->finalize = dnfui_package_row_finalize;
+}
+
+// -----------------------------------------------------------------------------
+// Start detached from any model.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_row_init(DnfuiPackageRow *self)
+{
+  self->model = nullptr;
+  self->slot = kNoSlot;
+}
+
+// -----------------------------------------------------------------------------
+// Return the item type GTK sees for every position.
+// -----------------------------------------------------------------------------
+static GType
+package_list_model_get_item_type(GListModel *)
+{
+  return DNFUI_TYPE_PACKAGE_ROW;
+}
+
+// -----------------------------------------------------------------------------
+// Return the number of visible rows.
+// -----------------------------------------------------------------------------
+static guint
+package_list_model_get_n_items(GListModel *list)
+{
+  return static_cast<guint>(DNFUI_PACKAGE_LIST_MODEL(list)->state->order.size());
+}
+
+// -----------------------------------------------------------------------------
+// Return the item object for one position, creating it when none is alive.
+// -----------------------------------------------------------------------------
+static gpointer
+package_list_model_get_item(GListModel *list, guint position)
+{
+  DnfuiPackageListModel *self = DNFUI_PACKAGE_LIST_MODEL(list);
+  PackageListModelState &state = *self->state;
+  if (position >= state.order.size()) {
+    return nullptr;
+  }
+
+  const guint slot_index = state.order[position];
+  PackageSlot &slot = state.slots[slot_index];
+  if (slot.object) {
+    return g_object_ref(slot.object);
+  }
+
+  DnfuiPackageRow *row = DNFUI_PACKAGE_ROW(g_object_new(DNFUI_TYPE_PACKAGE_ROW, nullptr));
+  row->model = DNFUI_PACKAGE_LIST_MODEL(g_object_ref(self));
+  row->slot = slot_index;
+  slot.object = row;
+  return row;
+}
+
+// -----------------------------------------------------------------------------
+// Wire the GListModel interface.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_list_model_list_model_init(GListModelInterface *iface)
+{
+  iface->get_item_type = package_list_model_get_item_type;
+  iface->get_n_items = package_list_model_get_n_items;
+  iface->get_item = package_list_model_get_item;
+}
+
+G_DEFINE_TYPE_WITH_CODE(DnfuiPackageListModel,
+                        dnfui_package_list_model,
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL, dnfui_package_list_model_list_model_init))
+
+// -----------------------------------------------------------------------------
+// Free the row storage. Row objects hold the model, so none are alive here.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_list_model_finalize(GObject *object)
+{
+  delete DNFUI_PACKAGE_LIST_MODEL(object)->state;
+  G_OBJECT_CLASS(dnfui_package_list_model_parent_class)->finalize(object);
+}
+
+// -----------------------------------------------------------------------------
+// Install the model finalizer.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_list_model_class_init(DnfuiPackageListModelClass *klass)
+{
+  G_OBJECT_CLASS(klass)->finalize = dnfui_package_list_model_finalize;
+}
+
+// -----------------------------------------------------------------------------
+// Allocate the row storage.
+// -----------------------------------------------------------------------------
+static void
+dnfui_package_list_model_init(DnfuiPackageListModel *self)
+{
+  self->state = new PackageListModelState;
+}
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Return true when two package items render the same row.
+// -----------------------------------------------------------------------------
+bool
+package_items_equal(const PackageItem &lhs, const PackageItem &rhs)
+{
+  const PackageRow &a = lhs.row;
+  const PackageRow &b = rhs.row;
+  return a.nevra == b.nevra && a.name == b.name && a.epoch == b.epoch && a.version == b.version &&
+      a.release == b.release && a.arch == b.arch && a.repo == b.repo && a.summary == b.summary &&
+      a.install_reason == b.install_reason && a.repo_candidate_relation == b.repo_candidate_relation &&
+      lhs.status_text == rhs.status_text && lhs.status_rank == rhs.status_rank &&
+      lhs.classification.state == rhs.classification.state &&
+      lhs.classification.installed_exact == rhs.classification.installed_exact &&
+      lhs.classification.self_protected == rhs.classification.self_protected;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when the current filter shows one row.
+// -----------------------------------------------------------------------------
+bool
+passes_filter(const PackageListModelState &state, const PackageItem &item)
+{
+  return !state.filter || state.filter(item);
+}
+
+// -----------------------------------------------------------------------------
+// Add delta to one count and drop the key once it reaches zero.
+// -----------------------------------------------------------------------------
+template <typename Key>
+void
+adjust_count(std::map<Key, guint> &counts, const Key &key, int delta)
+{
+  guint &count = counts[key];
+  count = static_cast<guint>(static_cast<int>(count) + delta);
+  if (count == 0) {
+    counts.erase(key);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Add one row to the stored row counts, or remove it when delta is -1.
+// -----------------------------------------------------------------------------
+void
+count_item(PackageListCounts &counts, const PackageItem &item, int delta)
+{
+  counts.total = static_cast<guint>(static_cast<int>(counts.total) + delta);
+  adjust_count(counts.by_repo, item.row.repo, delta);
+  adjust_count(counts.by_arch, item.row.arch, delta);
+  adjust_count(counts.by_status_rank, item.status_rank, delta);
+}
+
+// -----------------------------------------------------------------------------
+// Return the row ids in visible order.
+// -----------------------------------------------------------------------------
+std::vector<uint64_t>
+visible_ids(const PackageListModelState &state)
+{
+  std::vector<uint64_t> ids;
+  ids.reserve(state.order.size());
+  for (guint slot : state.order) {
+    ids.push_back(state.slots[slot].id);
+  }
+  return ids;
+}
+
+// -----------------------------------------------------------------------------
+// Merge slot indices into the visible order at their sorted positions. Without
+// a compare, slots are stored in insertion order, so the slot index is the
+// position key.
+// -----------------------------------------------------------------------------
+void
+insert_sorted(PackageListModelState &state, std::vector<guint> added)
+{
+  if (added.empty()) {
+    return;
+  }
+
+  for (guint slot_index : added) {
+    state.slots[slot_index].visible = true;
+  }
+
+  std::vector<guint> merged;
+  merged.reserve(state.order.size() + added.size());
+  if (!state.compare) {
+    std::sort(added.begin(), added.end());
+    std::merge(state.order.begin(), state.order.end(), added.begin(), added.end(), std::back_inserter(merged));
+    state.order = std::move(merged);
+    return;
+  }
+
+  auto less = [&state](guint lhs, guint rhs) {
+    return state.compare(state.slots[lhs].item, state.slots[rhs].item) < 0;
+  };
+  // Streamed batches usually arrive pre-sorted by the worker thread.
+  if (!std::is_sorted(added.begin(), added.end(), less)) {
+    std::stable_sort(added.begin(), added.end(), less);
+  }
+
+  if (added.size() * kGallopRatio >= state.order.size()) {
+    std::merge(state.order.begin(), state.order.end(), added.begin(), added.end(), std::back_inserter(merged), less);
+    state.order = std::move(merged);
+    return;
+  }
+
+  // A small batch into a long order searches each insertion point from the
+  // previous one, so compares grow with the batch instead of the whole order.
+  // Equal rows land after the existing ones, as with std::merge.
+  auto cursor = state.order.begin();
+  for (guint slot_index : added) {
+    auto position = std::upper_bound(cursor, state.order.end(), slot_index, less);
+    merged.insert(merged.end(), cursor, position);
+    merged.push_back(slot_index);
+    cursor = position;
+  }
+  merged.insert(merged.end(), cursor, state.order.end());
+  state.order = std::move(merged);
+}
+
+// -----------------------------------------------------------------------------
+// Place slots whose item changed in place again. Rows the filter rejects now
+// are hidden, and rows that no longer sort between their neighbours are taken
+// out until every remaining pair is in order. Those rows and hidden rows the
+// filter accepts now are merged back at their sorted positions, so rows whose
+// sort key did not change keep their place among equal rows.
+// -----------------------------------------------------------------------------
+void
+replace_changed_slots(PackageListModelState &state, const std::vector<guint> &changed)
+{
+  std::vector<bool> is_changed(state.slots.size(), false);
+  for (guint slot_index : changed) {
+    is_changed[slot_index] = true;
+  }
+
+  std::vector<guint> order;
+  order.reserve(state.order.size());
+  for (guint slot_index : state.order) {
+    if (is_changed[slot_index] && !passes_filter(state, state.slots[slot_index].item)) {
+      state.slots[slot_index].visible = false;
+    } else {
+      order.push_back(slot_index);
+    }
+  }
+
+  if (state.compare) {
+    auto less = [&state](guint lhs, guint rhs) {
+      return state.compare(state.slots[lhs].item, state.slots[rhs].item) < 0;
+    };
+    bool removed = true;
+    while (removed) {
+      removed = false;
+      std::vector<guint> kept;
+      kept.reserve(order.size());
+      for (size_t i = 0; i < order.size(); ++i) {
+        const guint slot_index = order[i];
+        if (is_changed[slot_index] && ((!kept.empty() && less(slot_index, kept.back())) ||
+                                       (i + 1 < order.size() && less(order[i + 1], slot_index)))) {
+          state.slots[slot_index].visible = false;
+          removed = true;
+          continue;
+        }
+        kept.push_back(slot_index);
+      }
+      order = std::move(kept);
+    }
+  }
+  state.order = std::move(order);
+
+  std::vector<guint> moved;
+  for (guint slot_index : changed) {
+    if (!state.slots[slot_index].visible && passes_filter(state, state.slots[slot_index].item)) {
+      moved.push_back(slot_index);
+    }
+  }
+  insert_sorted(state, std::move(moved));
+}
+
+// -----------------------------------------------------------------------------
+// Announce the difference between the ids shown before a change and the
+// current order as one items-changed span. Rows outside the span keep their
+// cells, and item objects inside it are handed out again when still alive.
+// -----------------------------------------------------------------------------
+void
+notify_order_change(DnfuiPackageListModel *model, const std::vector<uint64_t> &before)
+{
+  const PackageListModelState &state = *model->state;
+  const size_t old_n = before.size();
+  const size_t new_n = state.order.size();
+
+  size_t prefix = 0;
+  while (prefix < old_n && prefix < new_n && before[prefix] == state.slots[state.order[prefix]].id) {
+    ++prefix;
+  }
+  if (prefix == old_n && prefix == new_n) {
+    return;
+  }
+
+  size_t suffix = 0;
+  while (suffix < old_n - prefix && suffix < new_n - prefix &&
+         before[old_n - 1 - suffix] == state.slots[state.order[new_n - 1 - suffix]].id) {
+    ++suffix;
+  }
+
+  g_list_model_items_changed(G_LIST_MODEL(model),
+                             static_cast<guint>(prefix),
+                             static_cast<guint>(old_n - prefix - suffix),
+                             static_cast<guint>(new_n - prefix - suffix));
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Create an empty model in insertion order.
+// -----------------------------------------------------------------------------
+DnfuiPackageListModel *
+package_list_model_new()
+{
+  return DNFUI_PACKAGE_LIST_MODEL(g_object_new(DNFUI_TYPE_PACKAGE_LIST_MODEL, nullptr));
+}
+
+// -----------------------------------------------------------------------------
+// Read the row straight from the slot the item object points at.
+// -----------------------------------------------------------------------------
+const PackageItem *
+package_list_model_item_from_object(GObject *obj)
+{
+  if (!obj || !DNFUI_IS_PACKAGE_ROW(obj)) {
+    return nullptr;
+  }
+
+  const DnfuiPackageRow *row = DNFUI_PACKAGE_ROW(obj);
+  if (!row->model || row->slot == kNoSlot) {
+    return nullptr;
+  }
+
+  return &row->model->state->slots[row->slot].item;
+}
+
+// -----------------------------------------------------------------------------
+// Detach every live item object and drop all rows.
+// -----------------------------------------------------------------------------
+void
+package_list_model_clear(DnfuiPackageListModel *model)
+{
+  PackageListModelState &state = *model->state;
+  const guint n_items = static_cast<guint>(state.order.size());
+  for (auto &slot : state.slots) {
+    if (slot.object) {
+      slot.object->slot = kNoSlot;
+    }
+  }
+
+  state.slots.clear();
+  state.order.clear();
+  state.slots_by_nevra.clear();
+  state.updates.clear();
+  state.counts = {};
+  state.merging = false;
+
+  if (n_items > 0) {
+    g_list_model_items_changed(G_LIST_MODEL(model), 0, n_items, 0);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Store new rows, record changes for merged ones, and announce the new rows.
+// -----------------------------------------------------------------------------
+void
+package_list_model_append(DnfuiPackageListModel *model, std::vector<PackageItem> items)
+{
+  PackageListModelState &state = *model->state;
+  const std::vector<uint64_t> before = visible_ids(state);
+
+  std::vector<guint> added;
+  added.reserve(items.size());
+  for (auto &item : items) {
+    if (state.merging) {
+      guint existing = kNoSlot;
+      auto [first, last] = state.slots_by_nevra.equal_range(item.row.nevra.str());
+      for (auto it = first; it != last; ++it) {
+        if (!state.slots[it->second].seen) {
+          existing = it->second;
+          break;
+        }
+      }
+
+      if (existing != kNoSlot) {
+        PackageSlot &slot = state.slots[existing];
+        slot.seen = true;
+        if (!package_items_equal(slot.item, item)) {
+          state.updates.insert_or_assign(existing, std::move(item));
+        }
+        continue;
+      }
+    }
+
+    const guint slot_index = static_cast<guint>(state.slots.size());
+    state.slots_by_nevra.emplace(item.row.nevra.str(), slot_index);
+    count_item(state.counts, item, 1);
+    if (passes_filter(state, item)) {
+      added.push_back(slot_index);
+    }
+    state.slots.push_back(PackageSlot { std::move(item), nullptr, state.next_id++, true, false });
+  }
+
+  if (added.empty()) {
+    return;
+  }
+
+  insert_sorted(state, std::move(added));
+  notify_order_change(model, before);
+}
+
+// -----------------------------------------------------------------------------
+// Mark the current rows as not seen yet.
+// -----------------------------------------------------------------------------
+void
+package_list_model_begin_merge(DnfuiPackageListModel *model)
+{
+  PackageListModelState &state = *model->state;
+  state.merging = true;
+  state.updates.clear();
+  for (auto &slot : state.slots) {
+    slot.seen = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Apply the recorded changes, compact the slots, and place changed rows at
+// their new sorted positions or hide them when the filter rejects them now.
+// -----------------------------------------------------------------------------
+void
+package_list_model_finish_merge(DnfuiPackageListModel *model)
+{
+  PackageListModelState &state = *model->state;
+  if (!state.merging) {
+    return;
+  }
+
+  const std::vector<uint64_t> before = visible_ids(state);
+  std::vector<bool> changed(state.slots.size(), false);
+  for (auto &[slot_index, item] : state.updates) {
+    PackageSlot &slot = state.slots[slot_index];
+    count_item(state.counts, slot.item, -1);
+    count_item(state.counts, item, 1);
+    slot.item = std::move(item);
+    slot.id = state.next_id++;
+    changed[slot_index] = true;
+  }
+
+  // Drop rows the merge did not append again. Live item objects follow their
+  // slot, and objects of dropped rows stop resolving to a row.
+  std::vector<guint> remap(state.slots.size(), kNoSlot);
+  std::vector<PackageSlot> kept;
+  kept.reserve(state.slots.size());
+  for (guint i = 0; i < state.slots.size(); ++i) {
+    PackageSlot &slot = state.slots[i];
+    if (!slot.seen) {
+      count_item(state.counts, slot.item, -1);
+      if (slot.object) {
+        slot.object->slot = kNoSlot;
+      }
+      continue;
+    }
+
+    remap[i] = static_cast<guint>(kept.size());
+    if (slot.object) {
+      slot.object->slot = remap[i];
+    }
+    kept.push_back(std::move(slot));
+  }
+
+  std::vector<guint> order;
+  std::vector<guint> moved;
+  order.reserve(kept.size());
+  for (guint slot_index : state.order) {
+    if (remap[slot_index] == kNoSlot) {
+      continue;
+    }
+    // Changed rows may sort elsewhere or fail the filter now, so they are
+    // placed again below.
+    if (changed[slot_index] && (state.compare || state.filter)) {
+      kept[remap[slot_index]].visible = false;
+    } else {
+      order.push_back(remap[slot_index]);
+    }
+  }
+  for (guint i = 0; i < changed.size(); ++i) {
+    if (changed[i] && remap[i] != kNoSlot && !kept[remap[i]].visible && passes_filter(state, kept[remap[i]].item)) {
+      moved.push_back(remap[i]);
+    }
+  }
+
+  state.slots = std::move(kept);
+  state.order = std::move(order);
+  state.merging = false;
+  state.updates.clear();
+  state.slots_by_nevra.clear();
+  state.slots_by_nevra.reserve(state.slots.size());
+  for (guint i = 0; i < state.slots.size(); ++i) {
+    state.slots_by_nevra.emplace(state.slots[i].item.row.nevra.str(), i);
+  }
+
+  insert_sorted(state, std::move(moved));
+  notify_order_change(model, before);
+}
+
+// -----------------------------------------------------------------------------
+// Return true between begin_merge and finish_merge.
+// -----------------------------------------------------------------------------
+bool
+package_list_model_is_merging(DnfuiPackageListModel *model)
+{
+  return model->state->merging;
+}
+
+// -----------------------------------------------------------------------------
+// Sort the index permutation and announce one full reorder.
+// -----------------------------------------------------------------------------
+void
+package_list_model_set_compare(DnfuiPackageListModel *model, PackageItemCompare compare)
+{
+  PackageListModelState &state = *model->state;
+  state.compare = std::move(compare);
+
+  const std::vector<uint64_t> before = visible_ids(state);
+  if (state.compare) {
+    std::stable_sort(state.order.begin(), state.order.end(), [&state](guint lhs, guint rhs) {
+      return state.compare(state.slots[lhs].item, state.slots[rhs].item) < 0;
+    });
+  } else {
+    // Slots are stored in insertion order.
+    std::sort(state.order.begin(), state.order.end());
+  }
+  notify_order_change(model, before);
+}
+
+// -----------------------------------------------------------------------------
+// Drop visible rows the filter rejects and, unless the filter only narrows,
+// merge in hidden rows it accepts now. Rows that stay visible keep their
+// relative order, so GTK sees one items-changed span.
+// -----------------------------------------------------------------------------
+void
+package_list_model_set_filter(DnfuiPackageListModel *model, PackageItemFilter filter, bool narrows)
+{
+  PackageListModelState &state = *model->state;
+  state.filter = std::move(filter);
+
+  const std::vector<uint64_t> before = visible_ids(state);
+  std::vector<guint> order;
+  order.reserve(state.order.size());
+  for (guint slot_index : state.order) {
+    PackageSlot &slot = state.slots[slot_index];
+    if (passes_filter(state, slot.item)) {
+      order.push_back(slot_index);
+    } else {
+      slot.visible = false;
+    }
+  }
+  state.order = std::move(order);
+
+  if (!narrows) {
+    std::vector<guint> added;
+    for (guint i = 0; i < state.slots.size(); ++i) {
+      if (!state.slots[i].visible && passes_filter(state, state.slots[i].item)) {
+        added.push_back(i);
+      }
+    }
+    insert_sorted(state, std::move(added));
+  }
+  notify_order_change(model, before);
+}
+
+// -----------------------------------------------------------------------------
+// Return the counts kept up to date by append, merge, and row updates.
+// -----------------------------------------------------------------------------
+const PackageListCounts &
+package_list_model_get_counts(DnfuiPackageListModel *model)
+{
+  return model->state->counts;
+}
+
+// -----------------------------------------------------------------------------
+// Copy the rows out of the slots. Row fields share their text buffers, so this
+// costs one vector and a reference per field.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+package_list_model_get_rows(DnfuiPackageListModel *model)
+{
+  const PackageListModelState &state = *model->state;
+  std::vector<PackageRow> rows;
+  rows.reserve(state.slots.size());
+  for (const auto &slot : state.slots) {
+    rows.push_back(slot.item.row);
+  }
+  return rows;
+}
+
+// -----------------------------------------------------------------------------
+// Update the rows of one NEVRA in place, then place them again when the sort
+// or the filter depends on their values. Insertion order never does.
+// -----------------------------------------------------------------------------
+bool
+package_list_model_update_rows(DnfuiPackageListModel *model,
+                               const std::string &nevra,
+                               const std::function<void(PackageItem &)> &update)
+{
+  PackageListModelState &state = *model->state;
+  auto [first, last] = state.slots_by_nevra.equal_range(nevra);
+  if (first == last) {
+    return false;
+  }
+
+  const std::vector<uint64_t> before = visible_ids(state);
+  std::vector<guint> changed;
+  for (auto it = first; it != last; ++it) {
+    PackageItem &item = state.slots[it->second].item;
+    count_item(state.counts, item, -1);
+    update(item);
+    count_item(state.counts, item, 1);
+    changed.push_back(it->second);
+  }
+
+  if (state.compare || state.filter) {
+    replace_changed_slots(state, changed);
+    notify_order_change(model, before);
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Look up the slots of one NEVRA and return the first visible position that
+// holds one of them, without creating item objects.
+// -----------------------------------------------------------------------------
+bool
+package_list_model_find(DnfuiPackageListModel *model, const std::string &nevra, guint &position)
+{
+  const PackageListModelState &state = *model->state;
+  auto [first, last] = state.slots_by_nevra.equal_range(nevra);
+  if (first == last) {
+    return false;
+  }
+
+  std::vector<bool> wanted(state.slots.size(), false);
+  for (auto it = first; it != last; ++it) {
+    wanted[it->second] = true;
+  }
+  for (guint i = 0; i < state.order.size(); ++i) {
+    if (wanted[state.order[i]]) {
+      position = i;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,128 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_list_model.hpp
+// Vector-backed package list model
+//
+// Keeps the package table rows in one contiguous vector and shows them to GTK
+// through a GListModel. Sorting and filtering reorder an index permutation
+// instead of the rows, and item objects are created only for positions GTK asks
+// for. An item object stays the same for a row while anything holds it, so
+// selection and realized cells keep their row across refreshes.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gio/gio.h>
+
+// -----------------------------------------------------------------------------
+// One package table row with its snapshotted status text and sort rank.
+// -----------------------------------------------------------------------------
+struct PackageItem {
+  PackageRow row;
+  std::string status_text;
+  int status_rank = 0;
+  // Install state the status text and rank were derived from.
+  PackageRowClassification classification;
+  // Collation keys cached by the table comparators, one slot per sort column.
+  // Slots stay empty until their column is sorted, and replacing the item
+  // drops them together with the old values.
+  mutable std::vector<std::string> collation_keys;
+  // Casefolded name and summary cached by the table filter on first use.
+  mutable std::string filter_text;
+};
+
+// Three-way comparison used to order the visible rows.
+using PackageItemCompare = std::function<int(const PackageItem &lhs, const PackageItem &rhs)>;
+// Predicate that decides which stored rows are visible.
+using PackageItemFilter = std::function<bool(const PackageItem &item)>;
+
+// -----------------------------------------------------------------------------
+// Row counts over every stored row, visible or filtered out.
+// -----------------------------------------------------------------------------
+struct PackageListCounts {
+  guint total = 0;
+  std::map<std::string, guint> by_repo;
+  std::map<std::string, guint> by_arch;
+  std::map<int, guint> by_status_rank;
+};
+
+#define DNFUI_TYPE_PACKAGE_LIST_MODEL (dnfui_package_list_model_get_type())
+G_DECLARE_FINAL_TYPE(DnfuiPackageListModel, dnfui_package_list_model, DNFUI, PACKAGE_LIST_MODEL, GObject)
+
+#define DNFUI_TYPE_PACKAGE_ROW (dnfui_package_row_get_type())
+G_DECLARE_FINAL_TYPE(DnfuiPackageRow, dnfui_package_row, DNFUI, PACKAGE_ROW, GObject)
+
+// -----------------------------------------------------------------------------
+// Create an empty model in insertion order.
+// -----------------------------------------------------------------------------
+DnfuiPackageListModel *package_list_model_new();
+// -----------------------------------------------------------------------------
+// Return the row behind one item object, or nullptr when obj is not a package
+// row or its row was removed from the model.
+// -----------------------------------------------------------------------------
+const PackageItem *package_list_model_item_from_object(GObject *obj);
+// -----------------------------------------------------------------------------
+// Remove every row.
+// -----------------------------------------------------------------------------
+void package_list_model_clear(DnfuiPackageListModel *model);
+// -----------------------------------------------------------------------------
+// Add rows at their sorted positions. Rows the filter rejects are stored but
+// not shown. During a merge, rows whose NEVRA is already stored reuse the
+// existing row and only record changed values.
+// -----------------------------------------------------------------------------
+void package_list_model_append(DnfuiPackageListModel *model, std::vector<PackageItem> items);
+// -----------------------------------------------------------------------------
+// Start a merge. The current rows stay visible until finish_merge drops the
+// ones that were not appended again.
+// -----------------------------------------------------------------------------
+void package_list_model_begin_merge(DnfuiPackageListModel *model);
+// -----------------------------------------------------------------------------
+// Apply recorded changes, drop rows missing from the merge, and announce the
+// result as one items-changed span.
+// -----------------------------------------------------------------------------
+void package_list_model_finish_merge(DnfuiPackageListModel *model);
+// -----------------------------------------------------------------------------
+// Return true between begin_merge and finish_merge.
+// -----------------------------------------------------------------------------
+bool package_list_model_is_merging(DnfuiPackageListModel *model);
+// -----------------------------------------------------------------------------
+// Reorder the visible rows. An empty compare restores insertion order.
+// -----------------------------------------------------------------------------
+void package_list_model_set_compare(DnfuiPackageListModel *model, PackageItemCompare compare);
+// -----------------------------------------------------------------------------
+// Show only the rows the filter accepts. An empty filter shows every row. When
+// narrows is true the new filter accepts no row the old one rejected, so only
+// the visible rows are checked again.
+// -----------------------------------------------------------------------------
+void package_list_model_set_filter(DnfuiPackageListModel *model, PackageItemFilter filter, bool narrows = false);
+// -----------------------------------------------------------------------------
+// Return the row counts over every stored row.
+// -----------------------------------------------------------------------------
+const PackageListCounts &package_list_model_get_counts(DnfuiPackageListModel *model);
+// -----------------------------------------------------------------------------
+// Return a copy of every stored row in insertion order, visible or filtered
+// out. During a merge the rows are the ones from before it started.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow> package_list_model_get_rows(DnfuiPackageListModel *model);
+// -----------------------------------------------------------------------------
+// Update the rows of one NEVRA in place. Updated rows are checked against the
+// filter again and moved when they no longer sort between their neighbours,
+// and GTK only hears about the rows that moved, appeared, or were hidden.
+// Returns false when no row has that NEVRA.
+// -----------------------------------------------------------------------------
+bool package_list_model_update_rows(DnfuiPackageListModel *model,
+                                    const std::string &nevra,
+                                    const std::function<void(PackageItem &)> &update);
+// -----------------------------------------------------------------------------
+// Find the visible position of one NEVRA.
+// -----------------------------------------------------------------------------
+bool package_list_model_find(DnfuiPackageListModel *model, const std::string &nevra, guint &position);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -2,32 +2,210 @@
 // src/ui/package_query_cache.cpp
 // Package query result cache
 // Keeps cached search result storage and invalidation rules separate from the
-// package query controller.
+// package query controller. Results stay in a key-ordered map, so refinement
+// can scan one key prefix, and a recency list of keys picks what to evict once
+// the byte budget is exceeded. Entries hold shared result sets, so lookups and
+// stores only pass references around. A carry over moves the entries across a
+// rebuild and patches the rows of the packages the rebuild changed.
 // -----------------------------------------------------------------------------
 #include "package_query_cache.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <list>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <sstream>
+
+#include <glib.h>
+
+// Enough for a few dozen broad searches over a full Fedora repo set.
+static constexpr size_t kDefaultSearchCacheBytes = 64 * 1024 * 1024;
 
 // Cache one visible result set per search term and search option combination.
 // Entries are tied to the BaseManager generation that produced them so a Base
 // rebuild cannot serve outdated package metadata back into the UI.
 struct CachedSearchResults {
   uint64_t generation;
-  std::vector<PackageRow> packages;
+  SharedPackageRows packages;
+  // Estimated bytes this entry counts against the budget.
+  size_t bytes = 0;
+  // Position of the key in g_search_lru.
+  std::list<std::string>::iterator lru;
 };
 
 static std::map<std::string, CachedSearchResults> g_search_cache;
-static std::mutex g_cache_mutex; // Protects g_search_cache
+static std::list<std::string> g_search_lru; // Keys, most recently used first
+static size_t g_search_bytes = 0;
+static size_t g_search_budget = kDefaultSearchCacheBytes;
+// Newest generation seen. Generations only grow, so older entries can never hit again.
+static uint64_t g_search_generation = 0;
+static PackageQueryCacheStats g_search_stats;
+static std::mutex g_cache_mutex; // Protects the cache state above
+
+// Key prefix of the only search mode whose results can be refined in memory.
+// Description searches match text that package rows do not carry, and exact
+// searches for different terms never share rows.
+static constexpr const char *kRefinableKeyPrefix = "name:contains:";
 
 // -----------------------------------------------------------------------------
-// Build a unique cache key from search options and the search term.
+// Estimate the bytes one cached result set keeps alive: the row structs, the
+// text of every row field, and the key in both the map and the recency list.
+// Rows may share field buffers with the package index, so this is an upper
+// bound while the index is current and exact once it has been replaced.
+// -----------------------------------------------------------------------------
+static size_t
+search_results_bytes(const std::string &key, const std::vector<PackageRow> &packages)
+{
+  size_t bytes = sizeof(CachedSearchResults) + 2 * key.size();
+  for (const auto &row : packages) {
+    bytes += sizeof(PackageRow) + row.nevra.size() + row.name.size() + row.epoch.size() + row.version.size() +
+             row.release.size() + row.arch.size() + row.repo.size() + row.summary.size();
+  }
+  return bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Drop one entry. The caller holds the cache lock.
+// -----------------------------------------------------------------------------
+static void
+erase_locked(std::map<std::string, CachedSearchResults>::iterator it)
+{
+  g_search_bytes -= it->second.bytes;
+  g_search_lru.erase(it->second.lru);
+  g_search_cache.erase(it);
+}
+
+// -----------------------------------------------------------------------------
+// Drop every entry. The caller holds the cache lock.
+// -----------------------------------------------------------------------------
+static void
+clear_locked()
+{
+  g_search_cache.clear();
+  g_search_lru.clear();
+  g_search_bytes = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Evict the least recently used entries until extra_bytes more fit the budget.
+// The caller holds the cache lock.
+// -----------------------------------------------------------------------------
+static void
+evict_to_fit_locked(size_t extra_bytes)
+{
+  while (!g_search_lru.empty() && g_search_bytes + extra_bytes > g_search_budget) {
+    erase_locked(g_search_cache.find(g_search_lru.back()));
+    g_search_stats.evictions++;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Purge every entry once a newer generation shows up, instead of waiting for
+// each stale key to be looked up again. The caller holds the cache lock.
+// -----------------------------------------------------------------------------
+static void
+observe_generation_locked(uint64_t generation)
+{
+  if (generation > g_search_generation) {
+    g_search_stats.stale_purged += g_search_cache.size();
+    clear_locked();
+    g_search_generation = generation;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Split a cache key back into the search flags and the term it was built from.
+// -----------------------------------------------------------------------------
+static bool
+parse_cache_key(const std::string &key, DnfBackendSearchOptions &options, std::string &term)
+{
+  const size_t scope_end = key.find(':');
+  const size_t mode_end = scope_end == std::string::npos ? std::string::npos : key.find(':', scope_end + 1);
+  if (mode_end == std::string::npos) {
+    return false;
+  }
+
+  const std::string scope = key.substr(0, scope_end);
+  const std::string mode = key.substr(scope_end + 1, mode_end - scope_end - 1);
+  if ((scope != "desc" && scope != "name" && scope != "file") || (mode != "exact" && mode != "contains")) {
+    return false;
+  }
+
+  options.search_in_description = scope == "desc";
+  options.search_in_files = scope == "file";
+  options.exact_match = mode == "exact";
+  term = key.substr(mode_end + 1);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Order of the merged search view: package name, then architecture.
+// -----------------------------------------------------------------------------
+static bool
+search_row_less(const PackageRow &a, const PackageRow &b)
+{
+  int cmp = a.name.compare(b.name);
+  return cmp != 0 ? cmp < 0 : a.arch < b.arch;
+}
+
+// -----------------------------------------------------------------------------
+// Replace the rows of changed names with requeried ones. Returns rows itself
+// when neither side holds a changed name, so untouched entries stay shared.
+// -----------------------------------------------------------------------------
+static SharedPackageRows
+patch_rows(const SharedPackageRows &rows,
+           const std::set<std::string> &changed_names,
+           const std::vector<PackageRow> &requeried)
+{
+  auto is_changed = [&changed_names](const PackageRow &row) { return changed_names.count(row.name.str()) > 0; };
+  if (requeried.empty() && std::none_of(rows->begin(), rows->end(), is_changed)) {
+    return rows;
+  }
+
+  std::vector<PackageRow> kept;
+  kept.reserve(rows->size());
+  std::copy_if(rows->begin(), rows->end(), std::back_inserter(kept), [&is_changed](const PackageRow &row) {
+    return !is_changed(row);
+  });
+
+  auto patched = std::make_shared<std::vector<PackageRow>>();
+  patched->reserve(kept.size() + requeried.size());
+  std::merge(
+      kept.begin(), kept.end(), requeried.begin(), requeried.end(), std::back_inserter(*patched), search_row_less);
+  return patched;
+}
+
+// -----------------------------------------------------------------------------
+// Return the casefolded copy of text used by backend name matching.
+// -----------------------------------------------------------------------------
+static std::string
+casefold_copy(const std::string &text)
+{
+  char *folded = g_utf8_casefold(text.c_str(), -1);
+  std::string result = folded ? folded : "";
+  g_free(folded);
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Build the key with the published search options.
 // -----------------------------------------------------------------------------
 std::string
 package_query_cache_key_for(const std::string &term)
 {
-  const DnfBackendSearchOptions options = dnf_backend_get_search_options();
-  std::string key = (options.search_in_description ? "desc:" : "name:");
+  return package_query_cache_key_for(term, dnf_backend_get_search_options());
+}
+
+// -----------------------------------------------------------------------------
+// Build a unique cache key from search options and the search term.
+// -----------------------------------------------------------------------------
+std::string
+package_query_cache_key_for(const std::string &term, const DnfBackendSearchOptions &options)
+{
+  // File and provides searches ignore the description flag.
+  std::string key = options.search_in_files ? "file:" : (options.search_in_description ? "desc:" : "name:");
   key += (options.exact_match ? "exact:" : "contains:");
   key += term;
 
@@ -42,7 +220,7 @@ void
 package_query_cache_clear()
 {
   std::lock_guard<std::mutex> lock(g_cache_mutex);
-  g_search_cache.clear();
+  clear_locked();
 }
 
 // -----------------------------------------------------------------------------
@@ -51,34 +229,273 @@ package_query_cache_clear()
 // and transaction rebuilds cannot surface outdated package metadata.
 // -----------------------------------------------------------------------------
 bool
-package_query_cache_lookup(const std::string &key, uint64_t generation, std::vector<PackageRow> &out_packages)
+package_query_cache_lookup(const std::string &key, uint64_t generation, SharedPackageRows &out_packages)
 {
   std::lock_guard<std::mutex> lock(g_cache_mutex);
+  observe_generation_locked(generation);
   auto it = g_search_cache.find(key);
-  if (it == g_search_cache.end()) {
+  if (it == g_search_cache.end() || it->second.generation != generation) {
+    g_search_stats.misses++;
     return false;
   }
 
-  if (it->second.generation != generation) {
-    g_search_cache.erase(it);
+  g_search_lru.splice(g_search_lru.begin(), g_search_lru, it->second.lru);
+  g_search_stats.hits++;
+  out_packages = it->second.packages;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Check for cached rows without touching the counters or the LRU order, so
+// background work can skip searches that are already cached.
+// -----------------------------------------------------------------------------
+bool
+package_query_cache_contains(const std::string &key, uint64_t generation)
+{
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  observe_generation_locked(generation);
+  auto it = g_search_cache.find(key);
+  return it != g_search_cache.end() && it->second.generation == generation;
+}
+
+// -----------------------------------------------------------------------------
+// Build rows for a name substring search by filtering a cached broader search.
+// Every row whose name contains term also contains any substring of term, so
+// the rows cached for the narrowest such substring are a superset of the
+// result. Filtering keeps their order, which matches the backend result order.
+// -----------------------------------------------------------------------------
+bool
+package_query_cache_refine(const std::string &term, uint64_t generation, SharedPackageRows &out_packages)
+{
+  const DnfBackendSearchOptions options = dnf_backend_get_search_options();
+  if (options.search_in_description || options.exact_match || options.search_in_files || term.empty()) {
     return false;
   }
 
-  out_packages = it->second.packages;
+  const std::string prefix = kRefinableKeyPrefix;
+  const std::string term_folded = casefold_copy(term);
+
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  observe_generation_locked(generation);
+  CachedSearchResults *superset = nullptr;
+  for (auto it = g_search_cache.lower_bound(prefix);
+       it != g_search_cache.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+       ++it) {
+    if (it->second.generation != generation) {
+      continue;
+    }
+
+    const std::string cached_term = it->first.substr(prefix.size());
+    if (cached_term == term || term_folded.find(casefold_copy(cached_term)) == std::string::npos) {
+      continue;
+    }
+
+    if (!superset || it->second.packages->size() < superset->packages->size()) {
+      superset = &it->second;
+    }
+  }
+
+  if (!superset) {
+    return false;
+  }
+
+  g_search_lru.splice(g_search_lru.begin(), g_search_lru, superset->lru);
+  g_search_stats.refines++;
+  auto refined = std::make_shared<std::vector<PackageRow>>();
+  for (const auto &row : *superset->packages) {
+    if (casefold_copy(row.name).find(term_folded) != std::string::npos) {
+      refined->push_back(row);
+    }
+  }
+
+  out_packages = std::move(refined);
   return true;
 }
 
 // -----------------------------------------------------------------------------
 // Save rows so the same search can be shown faster next time.
 // Search results are only reusable while the backend Base generation stays
-// the same, otherwise repo state may have changed underneath the cache.
+// the same, otherwise repo state may have changed underneath the cache. Rows
+// larger than the whole budget are not cached.
+// -----------------------------------------------------------------------------
+void
+package_query_cache_store(const std::string &key, uint64_t generation, SharedPackageRows packages)
+{
+  if (!packages) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  observe_generation_locked(generation);
+  if (generation != g_search_generation) {
+    return;
+  }
+
+  auto existing = g_search_cache.find(key);
+  if (existing != g_search_cache.end()) {
+    erase_locked(existing);
+  }
+
+  const size_t bytes = search_results_bytes(key, *packages);
+  if (bytes > g_search_budget) {
+    g_search_stats.oversized++;
+    return;
+  }
+
+  evict_to_fit_locked(bytes);
+  g_search_lru.push_front(key);
+  g_search_cache.emplace(key, CachedSearchResults { generation, std::move(packages), bytes, g_search_lru.begin() });
+  g_search_bytes += bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Move the entries of the generation being rebuilt out of the cache. Rows of
+// the old Base are not served while the rebuild runs, as before, but they are
+// kept for the carry over.
+// -----------------------------------------------------------------------------
+PackageQueryCacheCarryOver
+package_query_cache_begin_carry_over(uint64_t generation)
+{
+  PackageQueryCacheCarryOver carry;
+  carry.generation = generation;
+
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  observe_generation_locked(generation);
+  for (const auto &key : g_search_lru) {
+    const CachedSearchResults &entry = g_search_cache.at(key);
+    if (entry.generation == generation) {
+      carry.entries.emplace_back(key, entry.packages);
+    }
+  }
+  clear_locked();
+  return carry;
+}
+
+// -----------------------------------------------------------------------------
+// Patch the carried entries first, without the lock, since requery runs
+// backend searches. Carried entries are older than anything stored since, so
+// they go to the least recently used end and never evict newer entries.
+// -----------------------------------------------------------------------------
+size_t
+package_query_cache_finish_carry_over(const PackageQueryCacheCarryOver &carry,
+                                      uint64_t generation,
+                                      const std::set<std::string> &changed_names,
+                                      const PackageQueryCacheRequery &requery)
+{
+  struct CarriedEntry {
+    const std::string *key;
+    SharedPackageRows packages;
+    bool patched;
+  };
+
+  std::vector<CarriedEntry> carried;
+  carried.reserve(carry.entries.size());
+  for (const auto &[key, packages] : carry.entries) {
+    if (!packages) {
+      continue;
+    }
+    if (changed_names.empty()) {
+      carried.push_back({ &key, packages, false });
+      continue;
+    }
+
+    DnfBackendSearchOptions options;
+    std::string term;
+    std::vector<PackageRow> requeried;
+    if (!parse_cache_key(key, options, term) || !requery(term, options, changed_names, requeried)) {
+      continue;
+    }
+
+    SharedPackageRows patched = patch_rows(packages, changed_names, requeried);
+    const bool was_patched = patched != packages;
+    carried.push_back({ &key, std::move(patched), was_patched });
+  }
+
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  observe_generation_locked(generation);
+  if (generation != g_search_generation) {
+    return 0;
+  }
+
+  size_t stored = 0;
+  for (auto &entry : carried) {
+    if (g_search_cache.count(*entry.key) > 0) {
+      continue;
+    }
+
+    const size_t bytes = search_results_bytes(*entry.key, *entry.packages);
+    if (g_search_bytes + bytes > g_search_budget) {
+      break;
+    }
+
+    g_search_lru.push_back(*entry.key);
+    auto lru = std::prev(g_search_lru.end());
+    g_search_cache.emplace(*entry.key, CachedSearchResults { generation, std::move(entry.packages), bytes, lru });
+    g_search_bytes += bytes;
+    (entry.patched ? g_search_stats.patched : g_search_stats.carried)++;
+    stored++;
+  }
+
+  return stored;
+}
+
+// -----------------------------------------------------------------------------
+// Replace the byte budget and evict down to it right away.
+// -----------------------------------------------------------------------------
+void
+package_query_cache_set_byte_budget(size_t byte_budget)
+{
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  g_search_budget = byte_budget;
+  evict_to_fit_locked(0);
+}
+
+// -----------------------------------------------------------------------------
+// Return the counters together with the current size of the cache.
+// -----------------------------------------------------------------------------
+PackageQueryCacheStats
+package_query_cache_stats()
+{
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  PackageQueryCacheStats stats = g_search_stats;
+  stats.entries = g_search_cache.size();
+  stats.bytes = g_search_bytes;
+  stats.byte_budget = g_search_budget;
+  return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Format the cache counters for the backend diagnostics window.
+// -----------------------------------------------------------------------------
+std::string
+package_query_cache_stats_report()
+{
+  const PackageQueryCacheStats stats = package_query_cache_stats();
+
+  std::ostringstream out;
+  out << "Search cache\n";
+  out << "  entries: " << stats.entries << ", bytes: " << stats.bytes << " of " << stats.byte_budget << "\n";
+  out << "  hits: " << stats.hits << ", refined: " << stats.refines << ", misses: " << stats.misses << "\n";
+  out << "  evicted: " << stats.evictions << ", stale purged: " << stats.stale_purged
+      << ", too large: " << stats.oversized << "\n";
+  out << "  carried over: " << stats.carried << ", patched: " << stats.patched << "\n";
+  return out.str();
+}
+
+#ifdef DNFUI_BUILD_TESTS
+// -----------------------------------------------------------------------------
+// Restore the default budget and drop every entry and counter for test setup.
 // -----------------------------------------------------------------------------
 void
-package_query_cache_store(const std::string &key, uint64_t generation, const std::vector<PackageRow> &packages)
+package_query_cache_reset_for_tests()
 {
   std::lock_guard<std::mutex> lock(g_cache_mutex);
-  g_search_cache[key] = CachedSearchResults { generation, packages };
+  clear_locked();
+  g_search_budget = kDefaultSearchCacheBytes;
+  g_search_generation = 0;
+  g_search_stats = {};
 }
+#endif
 
 // -----------------------------------------------------------------------------
 // EOF
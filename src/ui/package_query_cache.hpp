@@ -3,32 +3,139 @@
 // Package query result cache
 //
 // Owns cached search result storage so the package query controller does not
-// need to manage cache keys, generations, or locking directly.
+// need to manage cache keys, generations, or locking directly. Entries share
+// one byte budget and the least recently used ones are evicted first. Result
+// sets are immutable and shared, so a hit hands out the cached rows without
+// copying them. A rebuild that leaves the repositories unchanged can carry the
+// entries into the next generation, re-querying only the changed packages.
 // -----------------------------------------------------------------------------
 #pragma once
 
 #include "dnf_backend/dnf_backend.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+// One immutable search result set, shared by the cache and everyone showing it.
+using SharedPackageRows = std::shared_ptr<const std::vector<PackageRow>>;
+
+// -----------------------------------------------------------------------------
+// Search cache counters since startup, plus the current size of the cache.
+// -----------------------------------------------------------------------------
+struct PackageQueryCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // Searches answered by filtering a cached broader search.
+  uint64_t refines = 0;
+  // Entries evicted to stay within the byte budget.
+  uint64_t evictions = 0;
+  // Entries dropped because a newer generation showed up.
+  uint64_t stale_purged = 0;
+  // Result sets not stored because they alone exceed the budget.
+  uint64_t oversized = 0;
+  // Entries carried into a newer generation unchanged, or with the rows of
+  // changed packages queried again.
+  uint64_t carried = 0;
+  uint64_t patched = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+  size_t byte_budget = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Entries taken out of the cache before a Base rebuild, so they can be carried
+// into the generation the rebuild produces.
+// -----------------------------------------------------------------------------
+struct PackageQueryCacheCarryOver {
+  uint64_t generation = 0;
+  // Keys with their rows, most recently used first.
+  std::vector<std::pair<std::string, SharedPackageRows>> entries;
+};
+
+// Search term with the flags of one cached key, limited to names. Returns false
+// when the rows could not be queried, and the entry is dropped.
+using PackageQueryCacheRequery = std::function<bool(const std::string &term,
+                                                    const DnfBackendSearchOptions &options,
+                                                    const std::set<std::string> &names,
+                                                    std::vector<PackageRow> &out_rows)>;
+
 // -----------------------------------------------------------------------------
 // Build the cache key from the current search options and search term.
 // -----------------------------------------------------------------------------
 std::string package_query_cache_key_for(const std::string &term);
 // -----------------------------------------------------------------------------
+// Build the cache key from the given search options and search term.
+// -----------------------------------------------------------------------------
+std::string package_query_cache_key_for(const std::string &term, const DnfBackendSearchOptions &options);
+// -----------------------------------------------------------------------------
 // Clear all cached package query results.
 // -----------------------------------------------------------------------------
 void package_query_cache_clear();
 // -----------------------------------------------------------------------------
-// Look up cached package rows for one key and generation.
+// Look up cached package rows for one key and generation. A hit makes the
+// entry the most recently used one, and a newer generation purges every older
+// entry. out_packages shares the cached rows.
+// -----------------------------------------------------------------------------
+bool package_query_cache_lookup(const std::string &key, uint64_t generation, SharedPackageRows &out_packages);
+// -----------------------------------------------------------------------------
+// Return true when rows for one key and generation are cached, without
+// counting a lookup or changing the least recently used order.
+// -----------------------------------------------------------------------------
+bool package_query_cache_contains(const std::string &key, uint64_t generation);
+// -----------------------------------------------------------------------------
+// Filter cached rows of a broader name search for the same generation whose
+// term is contained in term into a new result set. Returns false when no
+// cached search qualifies.
 // -----------------------------------------------------------------------------
-bool package_query_cache_lookup(const std::string &key, uint64_t generation, std::vector<PackageRow> &out_packages);
+bool package_query_cache_refine(const std::string &term, uint64_t generation, SharedPackageRows &out_packages);
+// -----------------------------------------------------------------------------
+// Store package rows for one key and generation, evicting the least recently
+// used entries that no longer fit the byte budget. The cache keeps a reference
+// to packages instead of a copy.
+// -----------------------------------------------------------------------------
+void package_query_cache_store(const std::string &key, uint64_t generation, SharedPackageRows packages);
+// -----------------------------------------------------------------------------
+// Take every entry of generation out of the cache before a rebuild. Entries of
+// other generations are dropped.
+// -----------------------------------------------------------------------------
+PackageQueryCacheCarryOver package_query_cache_begin_carry_over(uint64_t generation);
+// -----------------------------------------------------------------------------
+// Store carried entries for generation, the one produced by the rebuild.
+// changed_names must list every package whose installed or available rows
+// changed since carry.generation. Rows of those names are
+// queried again through requery and merged in; other rows are kept. Entries
+// stored since the carry over began win. Returns the number of entries stored.
+// -----------------------------------------------------------------------------
+size_t package_query_cache_finish_carry_over(const PackageQueryCacheCarryOver &carry,
+                                             uint64_t generation,
+                                             const std::set<std::string> &changed_names,
+                                             const PackageQueryCacheRequery &requery);
+// -----------------------------------------------------------------------------
+// Set the byte budget, estimated from the row string sizes, and evict down to
+// it.
+// -----------------------------------------------------------------------------
+void package_query_cache_set_byte_budget(size_t byte_budget);
+// -----------------------------------------------------------------------------
+// Return the cache counters and current size.
+// -----------------------------------------------------------------------------
+PackageQueryCacheStats package_query_cache_stats();
+// -----------------------------------------------------------------------------
+// Format the cache counters as diagnostics report lines.
+// -----------------------------------------------------------------------------
+std::string package_query_cache_stats_report();
+
+#ifdef DNFUI_BUILD_TESTS
 // -----------------------------------------------------------------------------
-// Store package rows for one key and generation.
+// Restore the default budget and drop every entry and counter for test setup.
 // -----------------------------------------------------------------------------
-void package_query_cache_store(const std::string &key, uint64_t generation, const std::vector<PackageRow> &packages);
+void package_query_cache_reset_for_tests();
+#endif
 
 // -----------------------------------------------------------------------------
 // EOF
@@ -7,24 +7,286 @@
 #include "widgets.hpp"
 
 #include "base_manager.hpp"
+#include "base_state_fingerprint.hpp"
 #include "debug_trace.hpp"
 #include "dnf_backend/dnf_backend.hpp"
 #include "i18n.hpp"
+#include "package_details_cache.hpp"
 #include "package_info_controller.hpp"
 #include "package_query_cache.hpp"
 #include "package_query_controller.hpp"
 #include "package_table_view.hpp"
+#include "package_view_snapshot.hpp"
+#include "search_history.hpp"
+#include "search_prewarm.hpp"
+#include "task_executor.hpp"
 #include "ui_helpers.hpp"
 #include "widgets_internal.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
 // -----------------------------------------------------------------------------
-// Clear cached search results.
-// Used by the Clear Cache button, repository refresh, and transaction refresh.
+// Clear cached search results and package details.
+// Used by the Clear Cache button and repository refresh.
 // -----------------------------------------------------------------------------
 void
 package_query_clear_search_cache()
 {
   package_query_cache_clear();
+  package_details_cache_clear();
+}
+
+// -----------------------------------------------------------------------------
+// Return the names whose rows differ between two row sets, including names
+// that appear in only one of them.
+// -----------------------------------------------------------------------------
+static std::set<std::string>
+changed_row_names(const std::vector<PackageRow> &before, const std::vector<PackageRow> &after)
+{
+  // Everything a row carries that a transaction or repo refresh can change.
+  auto rows_by_name = [](const std::vector<PackageRow> &rows) {
+    std::map<std::string, std::vector<std::string>> by_name;
+    for (const auto &row : rows) {
+      by_name[row.name.str()].push_back(row.nevra.str() + "\n" + row.repo.str() + "\n" + row.summary.str() + "\n" +
+                                        std::to_string(static_cast<int>(row.install_reason)) + "\n" +
+                                        std::to_string(static_cast<int>(row.repo_candidate_relation)));
+    }
+    for (auto &[name, signatures] : by_name) {
+      std::sort(signatures.begin(), signatures.end());
+    }
+    return by_name;
+  };
+
+  const auto old_rows = rows_by_name(before);
+  const auto new_rows = rows_by_name(after);
+  std::set<std::string> changed;
+  for (const auto &[name, signatures] : old_rows) {
+    auto it = new_rows.find(name);
+    if (it == new_rows.end() || it->second != signatures) {
+      changed.insert(name);
+    }
+  }
+  for (const auto &[name, signatures] : new_rows) {
+    if (old_rows.count(name) == 0) {
+      changed.insert(name);
+    }
+  }
+  return changed;
+}
+
+// -----------------------------------------------------------------------------
+// Store the carried search entries for generation, querying the rows of
+// changed_names again from the new Base.
+// -----------------------------------------------------------------------------
+static void
+carry_over_search_cache(const PackageQueryCacheCarryOver &carry,
+                        uint64_t generation,
+                        const std::set<std::string> &changed_names,
+                        GCancellable *cancellable)
+{
+  const size_t stored = package_query_cache_finish_carry_over(
+      carry,
+      generation,
+      changed_names,
+      [cancellable](const std::string &term,
+                    const DnfBackendSearchOptions &options,
+                    const std::set<std::string> &names,
+                    std::vector<PackageRow> &out_rows) {
+        try {
+          out_rows = dnf_backend_search_package_rows_for_names(term, options, names, cancellable);
+        } catch (const std::exception &) {
+          return false;
+        }
+        return !(cancellable && g_cancellable_is_cancelled(cancellable));
+      });
+  DNFUI_TRACE("Search cache carried over entries=%zu of %zu changed_names=%zu",
+              stored,
+              carry.entries.size(),
+              changed_names.size());
+}
+
+// -----------------------------------------------------------------------------
+// Rebuild the Base after a transaction and carry the search cache into the new
+// generation. Cached rows only depend on the repositories and the installed
+// packages, so when the repository inputs are unchanged, only the rows of
+// packages whose installed rows changed are queried again. Any other rebuild,
+// or one whose old installed rows were never indexed, leaves the cache empty.
+// -----------------------------------------------------------------------------
+void
+package_query_on_rebuild_after_transaction_task(GTask *task, gpointer, gpointer, GCancellable *cancellable)
+{
+  try {
+    BaseManager &manager = BaseManager::instance();
+    package_details_cache_clear();
+
+    uint64_t generation_before = 0;
+    std::vector<PackageRow> installed_before;
+    const bool installed_known =
+        dnf_backend_get_indexed_installed_rows(false, nullptr, generation_before, installed_before);
+    BaseStateFingerprint repos_before;
+    uint64_t repos_generation_before = 0;
+    const bool repo_backed_before = manager.published_repo_inputs(repos_before, repos_generation_before);
+    // Rows of the old Base are not served while the rebuild runs.
+    const PackageQueryCacheCarryOver carry = package_query_cache_begin_carry_over(generation_before);
+
+    manager.rebuild(BaseRebuildPolicy::IF_CHANGED);
+
+    const uint64_t generation_after = manager.current_generation();
+    BaseStateFingerprint repos_after;
+    uint64_t repos_generation_after = 0;
+    const bool repo_backed_after = manager.published_repo_inputs(repos_after, repos_generation_after);
+    const bool repos_unchanged =
+        repo_backed_before == repo_backed_after &&
+        (!repo_backed_after ||
+         (repos_before.repo_entries == repos_after.repo_entries && repos_generation_before == generation_before &&
+          repos_generation_after == generation_after));
+
+    std::vector<PackageRow> installed_after;
+    uint64_t installed_generation_after = 0;
+    if (installed_known && repos_unchanged && !carry.entries.empty() &&
+        dnf_backend_get_indexed_installed_rows(true, cancellable, installed_generation_after, installed_after) &&
+        installed_generation_after == generation_after) {
+      carry_over_search_cache(
+          carry, generation_after, changed_row_names(installed_before, installed_after), cancellable);
+    }
+
+    g_task_return_boolean(task, TRUE);
+  } catch (const std::exception &e) {
+    g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, e.what()));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Refresh the repository named by the task data and carry the search cache
+// into the new generation. When the refresh loaded live metadata and left every
+// other input unchanged, only the names whose available or installed rows
+// differ between the two package indexes are queried again. Otherwise, or when
+// the old index was never built, the cache is left empty. Returns the repo
+// state through task like the full rebuild task.
+// -----------------------------------------------------------------------------
+void
+package_query_on_refresh_repo_task(GTask *task, gpointer, gpointer task_data, GCancellable *cancellable)
+{
+  try {
+    const std::string &repo_id = *static_cast<const std::string *>(task_data);
+    BaseManager &manager = BaseManager::instance();
+    package_details_cache_clear();
+
+    uint64_t generation_before = 0;
+    uint64_t installed_generation_before = 0;
+    std::vector<PackageRow> available_before;
+    std::vector<PackageRow> installed_before;
+    const bool rows_known =
+        dnf_backend_get_indexed_available_rows(false, nullptr, generation_before, available_before) &&
+        dnf_backend_get_indexed_installed_rows(false, nullptr, installed_generation_before, installed_before) &&
+        installed_generation_before == generation_before;
+    BaseStateFingerprint repos_before;
+    uint64_t repos_generation_before = 0;
+    const bool repo_backed_before = manager.published_repo_inputs(repos_before, repos_generation_before);
+    const PackageQueryCacheCarryOver carry = package_query_cache_begin_carry_over(generation_before);
+
+    const BaseRepoState state = manager.refresh_repo(repo_id);
+
+    const uint64_t generation_after = manager.current_generation();
+    BaseStateFingerprint repos_after;
+    uint64_t repos_generation_after = 0;
+    const bool others_unchanged = repo_backed_before && state == BaseRepoState::LIVE_METADATA &&
+                                  manager.published_repo_inputs(repos_after, repos_generation_after) &&
+                                  repos_generation_before == generation_before &&
+                                  repos_generation_after == generation_after &&
+                                  repos_before.same_inputs_except_repo(repos_after, repo_id);
+
+    uint64_t available_generation_after = 0;
+    uint64_t installed_generation_after = 0;
+    std::vector<PackageRow> available_after;
+    std::vector<PackageRow> installed_after;
+    if (rows_known && others_unchanged && !carry.entries.empty() &&
+        dnf_backend_get_indexed_available_rows(true, cancellable, available_generation_after, available_after) &&
+        dnf_backend_get_indexed_installed_rows(true, cancellable, installed_generation_after, installed_after) &&
+        available_generation_after == generation_after && installed_generation_after == generation_after) {
+      std::set<std::string> changed_names = changed_row_names(available_before, available_after);
+      changed_names.merge(changed_row_names(installed_before, installed_after));
+      carry_over_search_cache(carry, generation_after, changed_names, cancellable);
+    }
+
+    g_task_return_pointer(task, new BaseRepoState(state), [](gpointer p) { delete static_cast<BaseRepoState *>(p); });
+  } catch (const std::exception &e) {
+    g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, e.what()));
+  }
+}
+
+// At most one installed-change rebuild runs at a time. A request that comes in
+// meanwhile is remembered and checked again once the running one finishes.
+static bool g_installed_change_rebuild_running = false;
+static bool g_installed_change_rebuild_requested = false;
+
+// -----------------------------------------------------------------------------
+// Finish the installed-change rebuild on the GTK thread.
+// -----------------------------------------------------------------------------
+static void
+on_installed_change_rebuild_finished(GObject *, GAsyncResult *res, gpointer user_data)
+{
+  GTask *task = G_TASK(res);
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  g_installed_change_rebuild_running = false;
+  const bool requested_again = g_installed_change_rebuild_requested;
+  g_installed_change_rebuild_requested = false;
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    return;
+  }
+
+  GError *error = nullptr;
+  gboolean ok = g_task_propagate_boolean(task, &error);
+
+  if (!ok && error) {
+    ui_helpers_set_status(widgets->query.status_label, error->message, "red");
+    g_error_free(error);
+    return;
+  }
+
+  // The rebuild task already carried the search cache into the new Base
+  // generation, dropping or patching rows the change touched.
+
+  // Refresh installed state, then repopulate the currently visible package
+  // view so rows removed by the change disappear without a manual reload.
+  dnf_backend_refresh_installed_nevras();
+  package_query_reload_current_view(widgets);
+
+  // The rpmdb changed again while the Base was rebuilt.
+  if (requested_again && BaseManager::instance().published_installed_state_changed()) {
+    package_query_rebuild_after_installed_change(widgets);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Rebuild the Base on a worker after the installed packages changed.
+// -----------------------------------------------------------------------------
+void
+package_query_rebuild_after_installed_change(SearchWidgets *widgets)
+{
+  if (g_installed_change_rebuild_running) {
+    g_installed_change_rebuild_requested = true;
+    return;
+  }
+
+  g_installed_change_rebuild_running = true;
+  // The task stops serving cached search results from the old Base generation
+  // before it rebuilds, and carries them over afterwards.
+  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
+  GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_installed_change_rebuild_finished);
+  ui_task_run_in_thread(task, package_query_on_rebuild_after_transaction_task, UiTaskClass::REFRESH);
+  g_object_unref(task);
+  g_object_unref(c);
 }
 
 // -----------------------------------------------------------------------------
@@ -39,6 +301,10 @@ struct SearchTaskData {
   uint64_t generation;
   bool search_in_description;
   bool exact_match;
+  bool search_in_files;
+  // Started by search-as-you-type; keystroke_us is the keystroke it answers.
+  bool live_search;
+  int64_t keystroke_us;
 };
 
 // -----------------------------------------------------------------------------
@@ -77,6 +343,21 @@ set_displayed_query_kind(SearchWidgets *widgets, DisplayedPackageQueryKind kind)
 // rebuild the visible search results even if the user changes the checkboxes
 // while the background work is still running.
 // -----------------------------------------------------------------------------
+static DisplayedPackageQueryState
+displayed_search_query_for(const SearchTaskData &task_data)
+{
+  DisplayedPackageQueryState displayed;
+  displayed.kind = DisplayedPackageQueryKind::SEARCH;
+  displayed.search_term = task_data.term ? task_data.term : "";
+  displayed.search_in_description = task_data.search_in_description;
+  displayed.exact_match = task_data.exact_match;
+  displayed.search_in_files = task_data.search_in_files;
+  return displayed;
+}
+
+// -----------------------------------------------------------------------------
+// Record the search described by task_data as the displayed table query.
+// -----------------------------------------------------------------------------
 static void
 set_displayed_search_query(SearchWidgets *widgets, const SearchTaskData &task_data)
 {
@@ -84,11 +365,7 @@ set_displayed_search_query(SearchWidgets *widgets, const SearchTaskData &task_da
     return;
   }
 
-  widgets->query_state.displayed_query = DisplayedPackageQueryState();
-  widgets->query_state.displayed_query.kind = DisplayedPackageQueryKind::SEARCH;
-  widgets->query_state.displayed_query.search_term = task_data.term ? task_data.term : "";
-  widgets->query_state.displayed_query.search_in_description = task_data.search_in_description;
-  widgets->query_state.displayed_query.exact_match = task_data.exact_match;
+  widgets->query_state.displayed_query = displayed_search_query_for(task_data);
 }
 
 // -----------------------------------------------------------------------------
@@ -103,10 +380,17 @@ finish_results_refresh(SearchWidgets *widgets)
     return;
   }
 
+  bool leaving_snapshot = widgets->query_state.showing_view_snapshot;
+  widgets->query_state.showing_view_snapshot = false;
+
   if (widgets->query_state.preserve_selection_on_reload) {
     PackageRow selected;
     if (!package_table_get_selected_package_row(widgets, selected)) {
       package_info_reset_details_view(widgets);
+    } else if (leaving_snapshot) {
+      // The merge kept the selected row, so enable its actions now that the
+      // rows come from the live Base.
+      package_info_load_selected_package_info(widgets, selected);
     }
   } else {
     package_info_reset_details_view(widgets);
@@ -152,6 +436,7 @@ package_list_stop_button(SearchWidgets *widgets, PackageListRequestKind kind)
   case PackageListRequestKind::LIST_UPGRADEABLE:
     return widgets->query.list_upgradeable_button;
   case PackageListRequestKind::SEARCH:
+  case PackageListRequestKind::RELOAD_NEVRA:
   case PackageListRequestKind::NONE:
   default:
     return widgets->query.search_button;
@@ -173,6 +458,8 @@ package_list_cancelled_status(PackageListRequestKind kind)
     return _("Listing packages cancelled.");
   case PackageListRequestKind::LIST_UPGRADEABLE:
     return _("Listing upgradable packages cancelled.");
+  case PackageListRequestKind::RELOAD_NEVRA:
+    return _("Reloading package cancelled.");
   case PackageListRequestKind::NONE:
   default:
     return _("Operation cancelled.");
@@ -180,10 +467,15 @@ package_list_cancelled_status(PackageListRequestKind kind)
 }
 
 // -----------------------------------------------------------------------------
-// Record the active package list task and switch its button to Stop.
+// Record the active package list task and switch its button to Stop. A live
+// search keeps the entry editable so the next keystroke can supersede it.
 // -----------------------------------------------------------------------------
 static void
-begin_package_list_request(SearchWidgets *widgets, GCancellable *c, uint64_t request_id, PackageListRequestKind kind)
+begin_package_list_request(SearchWidgets *widgets,
+                           GCancellable *c,
+                           uint64_t request_id,
+                           PackageListRequestKind kind,
+                           bool live_search = false)
 {
   if (!widgets || !c) {
     return;
@@ -196,6 +488,8 @@ begin_package_list_request(SearchWidgets *widgets, GCancellable *c, uint64_t req
   widgets->query_state.package_list_cancellable = G_CANCELLABLE(g_object_ref(c));
   widgets->query_state.current_package_list_request_id = request_id;
   widgets->query_state.current_package_list_request_kind = kind;
+  widgets->query_state.streaming_request_id = request_id;
+  widgets->query_state.live_search_running = live_search;
   GtkButton *stop_button = package_list_stop_button(widgets, kind);
 
   ui_helpers_set_icon_button(widgets->query.search_button, "system-search-symbolic", _("Search"));
@@ -203,9 +497,10 @@ begin_package_list_request(SearchWidgets *widgets, GCancellable *c, uint64_t req
   ui_helpers_set_icon_button(widgets->query.list_available_button, "view-list-symbolic", _("List Packages"));
   ui_helpers_set_icon_button(widgets->query.list_upgradeable_button, "view-list-symbolic", _("List Upgradable"));
   ui_helpers_set_icon_button(stop_button, "process-stop-symbolic", _("Stop"));
-  gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.entry), FALSE);
+  gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.entry), live_search);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.desc_checkbox), FALSE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.exact_checkbox), FALSE);
+  gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.files_checkbox), FALSE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.history_list), FALSE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.search_button), FALSE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.list_button), FALSE);
@@ -231,6 +526,7 @@ restore_package_list_controls(SearchWidgets *widgets)
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.entry), TRUE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.desc_checkbox), TRUE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.exact_checkbox), TRUE);
+  gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.files_checkbox), TRUE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.history_list), TRUE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.list_button), TRUE);
   gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.list_available_button), TRUE);
@@ -255,6 +551,7 @@ end_package_list_request(SearchWidgets *widgets, uint64_t request_id, PackageLis
   }
   widgets->query_state.current_package_list_request_id = 0;
   widgets->query_state.current_package_list_request_kind = PackageListRequestKind::NONE;
+  widgets->query_state.live_search_running = false;
   restore_package_list_controls(widgets);
 }
 
@@ -285,6 +582,250 @@ cancel_active_package_list_request(SearchWidgets *widgets)
   ui_helpers_set_status(widgets->query.status_label, package_list_cancelled_status(kind), "gray");
 }
 
+// -----------------------------------------------------------------------------
+// Streamed package rows
+// Worker tasks queue result batches while the query is still running. Each
+// batch is classified against the installed snapshot, sorted in the table's
+// sort order, and gets its collation keys on the worker. The GTK thread appends
+// one batch per main loop dispatch, so the first rows show up early and a large
+// result never blocks input or redraws for the whole fill.
+// -----------------------------------------------------------------------------
+constexpr const char *kTaskPackageRowStreamKey = "dnfui-task-package-row-stream";
+
+struct PackageRowStream {
+  // Keeps SearchWidgets alive while queued batches still reference it.
+  std::shared_ptr<SearchWidgets> widgets;
+  GCancellable *cancellable = nullptr;
+  uint64_t request_id = 0;
+  uint64_t generation = 0;
+  // Refresh the installed snapshot before the first batch is classified,
+  // matching the views that classify rows against it.
+  bool refresh_installed_snapshot = false;
+  // Set by the thread that ran that refresh: the worker before its first
+  // batch, or the GTK thread when the query streamed no rows.
+  std::atomic<bool> installed_refreshed { false };
+  // Merge the rows into the visible table instead of starting from an empty
+  // one. Set for reloads of the current view.
+  bool merge_into_current_view = false;
+  // Table sort when the query started. Batches are prepared in this order; a
+  // sort change in the meantime only costs the model a batch sort.
+  PackageTableSort sort;
+
+  // Batches queued by the worker and not yet appended to the table.
+  std::mutex mutex;
+  std::deque<PackageItemBatch> pending;
+  bool dispatch_queued = false;
+
+  // GTK thread only.
+  bool view_started = false;
+  std::function<void()> on_drained;
+
+  ~PackageRowStream()
+  {
+    if (cancellable) {
+      g_object_unref(cancellable);
+    }
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Attach a new row stream to a package query task before it starts.
+// -----------------------------------------------------------------------------
+static void
+attach_package_row_stream(
+    GTask *task, SearchWidgets *widgets, uint64_t request_id, uint64_t generation, bool refresh_installed_snapshot)
+{
+  auto stream = std::make_shared<PackageRowStream>();
+  stream->widgets = widgets->shared_from_this();
+  stream->cancellable = G_CANCELLABLE(g_object_ref(g_task_get_cancellable(task)));
+  stream->request_id = request_id;
+  stream->generation = generation;
+  stream->refresh_installed_snapshot = refresh_installed_snapshot;
+  stream->merge_into_current_view = widgets->query_state.reloading_current_view;
+  stream->sort = package_table_get_sort(widgets);
+  widgets->query_state.reloading_current_view = false;
+
+  g_object_set_data_full(G_OBJECT(task),
+                         kTaskPackageRowStreamKey,
+                         new std::shared_ptr<PackageRowStream>(std::move(stream)),
+                         [](gpointer p) { delete static_cast<std::shared_ptr<PackageRowStream> *>(p); });
+}
+
+// -----------------------------------------------------------------------------
+// Return the row stream attached to a package query task.
+// -----------------------------------------------------------------------------
+static std::shared_ptr<PackageRowStream>
+package_row_stream_for_task(GTask *task)
+{
+  auto *stream = static_cast<std::shared_ptr<PackageRowStream> *>(
+      g_object_get_data(G_OBJECT(task), kTaskPackageRowStreamKey));
+  return stream ? *stream : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Return true while streamed rows may still update the package table: the
+// window is alive, the request was not cancelled or superseded, and the Base
+// generation did not change.
+// -----------------------------------------------------------------------------
+static bool
+package_row_stream_is_current(const PackageRowStream &stream)
+{
+  const SearchWidgets *widgets = stream.widgets.get();
+  return widgets && !widgets->window_state.destroyed && !g_cancellable_is_cancelled(stream.cancellable) &&
+      widgets->query_state.streaming_request_id == stream.request_id &&
+      stream.generation == BaseManager::instance().current_generation();
+}
+
+// -----------------------------------------------------------------------------
+// Refresh the installed snapshot once per stream when the view asked for it.
+// Callable from the worker and the GTK thread.
+// -----------------------------------------------------------------------------
+static void
+refresh_stream_installed_snapshot(PackageRowStream &stream)
+{
+  if (stream.refresh_installed_snapshot && !stream.installed_refreshed.exchange(true)) {
+    dnf_backend_refresh_installed_nevras();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Replace the package table with the empty streamed view on the first batch.
+// -----------------------------------------------------------------------------
+static void
+start_streamed_package_view(PackageRowStream &stream)
+{
+  if (stream.view_started) {
+    return;
+  }
+
+  SearchWidgets *widgets = stream.widgets.get();
+  refresh_stream_installed_snapshot(stream);
+
+  if (widgets->query_state.preserve_selection_on_reload) {
+    widgets->results.selected_nevra = widgets->query_state.reload_selected_nevra;
+  } else {
+    widgets->results.selected_nevra.clear();
+  }
+  package_table_begin_package_view(widgets, stream.merge_into_current_view);
+  stream.view_started = true;
+}
+
+// -----------------------------------------------------------------------------
+// Append the oldest queued batch on the GTK thread. Runs the drained callback
+// once the queue is empty. Returns true while more batches are queued.
+// -----------------------------------------------------------------------------
+static bool
+deliver_package_row_batch(const std::shared_ptr<PackageRowStream> &stream)
+{
+  PackageItemBatch batch;
+  bool more = false;
+  {
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    if (!stream->pending.empty()) {
+      batch = std::move(stream->pending.front());
+      stream->pending.pop_front();
+    }
+    more = !stream->pending.empty();
+    if (!more) {
+      stream->dispatch_queued = false;
+    }
+  }
+
+  if (!batch.items.empty() && package_row_stream_is_current(*stream)) {
+    start_streamed_package_view(*stream);
+    package_table_append_package_items(stream->widgets.get(), std::move(batch));
+  }
+
+  if (!more && stream->on_drained) {
+    std::function<void()> on_drained = std::move(stream->on_drained);
+    stream->on_drained = nullptr;
+    on_drained();
+  }
+
+  return more;
+}
+
+// -----------------------------------------------------------------------------
+// Prepare one batch on the worker thread and schedule a GTK dispatch when none
+// is pending. Dispatches run at idle priority so redraws and input stay ahead
+// of table appends. The dispatch is scheduled after the stream mutex is
+// released, so the GTK thread never waits on the worker while it dispatches.
+// -----------------------------------------------------------------------------
+static void
+queue_package_row_batch(const std::shared_ptr<PackageRowStream> &stream, std::vector<PackageRow> batch)
+{
+  if (batch.empty()) {
+    return;
+  }
+
+  // Classify on the worker so the GTK thread only fills in status text.
+  refresh_stream_installed_snapshot(*stream);
+  PackageItemBatch items =
+      package_table_prepare_items(std::move(batch), stream->sort, dnf_backend_get_installed_snapshot());
+  {
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    stream->pending.push_back(std::move(items));
+    if (stream->dispatch_queued) {
+      return;
+    }
+    stream->dispatch_queued = true;
+  }
+
+  g_main_context_invoke_full(
+      nullptr,
+      G_PRIORITY_DEFAULT_IDLE,
+      +[](gpointer user_data) -> gboolean {
+        auto *stream = static_cast<std::shared_ptr<PackageRowStream> *>(user_data);
+        return deliver_package_row_batch(*stream) ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+      },
+      new std::shared_ptr<PackageRowStream>(stream),
+      [](gpointer p) { delete static_cast<std::shared_ptr<PackageRowStream> *>(p); });
+}
+
+// -----------------------------------------------------------------------------
+// Return the backend batch callback that feeds one row stream.
+// -----------------------------------------------------------------------------
+static PackageRowBatchCallback
+package_row_stream_callback(const std::shared_ptr<PackageRowStream> &stream)
+{
+  if (!stream) {
+    return nullptr;
+  }
+
+  return [stream](std::vector<PackageRow> batch) { queue_package_row_batch(stream, std::move(batch)); };
+}
+
+// -----------------------------------------------------------------------------
+// Finish a completed row stream on the GTK thread. finalize runs after every
+// queued batch has been appended, or right away when nothing is queued, and is
+// skipped when the stream was cancelled or superseded in the meantime.
+// -----------------------------------------------------------------------------
+static void
+finish_package_row_stream(const std::shared_ptr<PackageRowStream> &stream, std::function<void()> finalize)
+{
+  auto run_finalize = [stream, finalize = std::move(finalize)]() {
+    if (!package_row_stream_is_current(*stream)) {
+      return;
+    }
+    start_streamed_package_view(*stream);
+    package_table_finish_package_view(stream->widgets.get());
+    stream->widgets->query_state.streaming_request_id = 0;
+    finalize();
+  };
+
+  bool drained = false;
+  {
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    drained = stream->pending.empty() && !stream->dispatch_queued;
+  }
+
+  if (drained) {
+    run_finalize();
+  } else {
+    stream->on_drained = std::move(run_finalize);
+  }
+}
+
 // -----------------------------------------------------------------------------
 // Background package query tasks
 // GTK runs the window on the main thread. GTask lets package queries run on a
@@ -298,10 +839,10 @@ static void
 on_list_task(GTask *task, gpointer, gpointer, GCancellable *cancellable)
 {
   try {
-    // Query all installed packages.
-    auto *results = new std::vector<PackageRow>(dnf_backend_get_installed_package_rows_interruptible(cancellable));
-    // Let GTask free results if completion is skipped or cancelled.
-    g_task_return_pointer(task, results, [](gpointer p) { delete static_cast<std::vector<PackageRow> *>(p); });
+    // Query all installed packages and stream them to the table.
+    size_t count = dnf_backend_get_installed_package_rows_streaming(
+        cancellable, package_row_stream_callback(package_row_stream_for_task(task)));
+    g_task_return_int(task, static_cast<gssize>(count));
   } catch (const std::exception &e) {
     g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, e.what()));
   }
@@ -337,7 +878,7 @@ on_list_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
   }
 
   GError *error = nullptr;
-  std::vector<PackageRow> *packages = static_cast<std::vector<PackageRow> *>(g_task_propagate_pointer(task, &error));
+  const gssize result = g_task_propagate_int(task, &error);
 
   // Release this task's spinner slot.
   widgets_spinner_release(widgets->query.spinner);
@@ -346,22 +887,19 @@ on_list_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
     end_package_list_request(widgets, td->request_id, PackageListRequestKind::LIST_INSTALLED);
   }
 
-  if (packages) {
-    set_displayed_query_kind(widgets, DisplayedPackageQueryKind::LIST_INSTALLED);
-
-    // Fill the package table and update status.
-    if (widgets->query_state.preserve_selection_on_reload) {
-      widgets->results.selected_nevra = widgets->query_state.reload_selected_nevra;
-    } else {
-      widgets->results.selected_nevra.clear();
-    }
-    package_table_fill_package_view(widgets, *packages);
-    std::string msg =
-        dnfui_i18n_format_count(packages->size(), "Found %zu installed package.", "Found %zu installed packages.");
-    ui_helpers_set_status(widgets->query.status_label, msg, "green");
-    finish_results_refresh(widgets);
-    delete packages;
+  if (!error) {
+    // Streamed batches already fill the table; update the status once the last
+    // queued batch has been appended.
+    const size_t count = static_cast<size_t>(result);
+    finish_package_row_stream(package_row_stream_for_task(task), [widgets, count]() {
+      set_displayed_query_kind(widgets, DisplayedPackageQueryKind::LIST_INSTALLED);
+      std::string msg =
+          dnfui_i18n_format_count(count, "Found %zu installed package.", "Found %zu installed packages.");
+      ui_helpers_set_status(widgets->query.status_label, msg, "green");
+      finish_results_refresh(widgets);
+    });
   } else {
+    widgets->query_state.streaming_request_id = 0;
     widgets->query_state.preserve_selection_on_reload = false;
     widgets->query_state.reload_selected_nevra.clear();
     ui_helpers_set_status(widgets->query.status_label, error ? error->message : _("Error listing packages."), "red");
@@ -379,8 +917,9 @@ static void
 on_list_available_task(GTask *task, gpointer, gpointer, GCancellable *cancellable)
 {
   try {
-    auto *results = new std::vector<PackageRow>(dnf_backend_get_browse_package_rows_interruptible(cancellable));
-    g_task_return_pointer(task, results, [](gpointer p) { delete static_cast<std::vector<PackageRow> *>(p); });
+    size_t count = dnf_backend_get_browse_package_rows_streaming(
+        cancellable, package_row_stream_callback(package_row_stream_for_task(task)));
+    g_task_return_int(task, static_cast<gssize>(count));
   } catch (const std::exception &e) {
     g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, e.what()));
   }
@@ -415,7 +954,7 @@ on_list_available_task_finished(GObject *, GAsyncResult *res, gpointer user_data
   }
 
   GError *error = nullptr;
-  std::vector<PackageRow> *packages = static_cast<std::vector<PackageRow> *>(g_task_propagate_pointer(task, &error));
+  const gssize result = g_task_propagate_int(task, &error);
 
   // Release this task's spinner slot.
   widgets_spinner_release(widgets->query.spinner);
@@ -424,22 +963,16 @@ on_list_available_task_finished(GObject *, GAsyncResult *res, gpointer user_data
     end_package_list_request(widgets, td->request_id, PackageListRequestKind::LIST_AVAILABLE);
   }
 
-  if (packages) {
-    set_displayed_query_kind(widgets, DisplayedPackageQueryKind::LIST_AVAILABLE);
-
-    dnf_backend_refresh_installed_nevras();
-
-    if (widgets->query_state.preserve_selection_on_reload) {
-      widgets->results.selected_nevra = widgets->query_state.reload_selected_nevra;
-    } else {
-      widgets->results.selected_nevra.clear();
-    }
-    package_table_fill_package_view(widgets, *packages);
-    std::string msg = dnfui_i18n_format_count(packages->size(), "Found %zu package.", "Found %zu packages.");
-    ui_helpers_set_status(widgets->query.status_label, msg, "green");
-    finish_results_refresh(widgets);
-    delete packages;
+  if (!error) {
+    const size_t count = static_cast<size_t>(result);
+    finish_package_row_stream(package_row_stream_for_task(task), [widgets, count]() {
+      set_displayed_query_kind(widgets, DisplayedPackageQueryKind::LIST_AVAILABLE);
+      std::string msg = dnfui_i18n_format_count(count, "Found %zu package.", "Found %zu packages.");
+      ui_helpers_set_status(widgets->query.status_label, msg, "green");
+      finish_results_refresh(widgets);
+    });
   } else {
+    widgets->query_state.streaming_request_id = 0;
     widgets->query_state.preserve_selection_on_reload = false;
     widgets->query_state.reload_selected_nevra.clear();
     ui_helpers_set_status(widgets->query.status_label, error ? error->message : _("Error listing packages."), "red");
@@ -456,8 +989,9 @@ static void
 on_list_upgradeable_task(GTask *task, gpointer, gpointer, GCancellable *cancellable)
 {
   try {
-    auto *results = new std::vector<PackageRow>(dnf_backend_get_upgradeable_package_rows_interruptible(cancellable));
-    g_task_return_pointer(task, results, [](gpointer p) { delete static_cast<std::vector<PackageRow> *>(p); });
+    size_t count = dnf_backend_get_upgradeable_package_rows_streaming(
+        cancellable, package_row_stream_callback(package_row_stream_for_task(task)));
+    g_task_return_int(task, static_cast<gssize>(count));
   } catch (const std::exception &e) {
     g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, e.what()));
   }
@@ -492,7 +1026,7 @@ on_list_upgradeable_task_finished(GObject *, GAsyncResult *res, gpointer user_da
   }
 
   GError *error = nullptr;
-  std::vector<PackageRow> *packages = static_cast<std::vector<PackageRow> *>(g_task_propagate_pointer(task, &error));
+  const gssize result = g_task_propagate_int(task, &error);
 
   // Release this task's spinner slot.
   widgets_spinner_release(widgets->query.spinner);
@@ -501,23 +1035,17 @@ on_list_upgradeable_task_finished(GObject *, GAsyncResult *res, gpointer user_da
     end_package_list_request(widgets, td->request_id, PackageListRequestKind::LIST_UPGRADEABLE);
   }
 
-  if (packages) {
-    set_displayed_query_kind(widgets, DisplayedPackageQueryKind::LIST_UPGRADEABLE);
-
-    dnf_backend_refresh_installed_nevras();
-
-    if (widgets->query_state.preserve_selection_on_reload) {
-      widgets->results.selected_nevra = widgets->query_state.reload_selected_nevra;
-    } else {
-      widgets->results.selected_nevra.clear();
-    }
-    package_table_fill_package_view(widgets, *packages);
-    std::string msg =
-        dnfui_i18n_format_count(packages->size(), "Found %zu upgradable package.", "Found %zu upgradable packages.");
-    ui_helpers_set_status(widgets->query.status_label, msg, packages->empty() ? "gray" : "green");
-    finish_results_refresh(widgets);
-    delete packages;
+  if (!error) {
+    const size_t count = static_cast<size_t>(result);
+    finish_package_row_stream(package_row_stream_for_task(task), [widgets, count]() {
+      set_displayed_query_kind(widgets, DisplayedPackageQueryKind::LIST_UPGRADEABLE);
+      std::string msg =
+          dnfui_i18n_format_count(count, "Found %zu upgradable package.", "Found %zu upgradable packages.");
+      ui_helpers_set_status(widgets->query.status_label, msg, count == 0 ? "gray" : "green");
+      finish_results_refresh(widgets);
+    });
   } else {
+    widgets->query_state.streaming_request_id = 0;
     widgets->query_state.preserve_selection_on_reload = false;
     widgets->query_state.reload_selected_nevra.clear();
     ui_helpers_set_status(
@@ -528,6 +1056,108 @@ on_list_upgradeable_task_finished(GObject *, GAsyncResult *res, gpointer user_da
   }
 }
 
+// -----------------------------------------------------------------------------
+// Search-as-you-type
+// Each keystroke restarts one debounce timeout and cancels a live search that
+// is still running, so at most one timeout and one live worker exist at a time.
+// -----------------------------------------------------------------------------
+
+// Quiet period after the last keystroke before a live search starts. Set
+// DNFUI_LIVE_SEARCH_DELAY_MS to tune it against the latency counters.
+constexpr guint kDefaultLiveSearchDelayMs = 250;
+
+// Shorter terms match most of the package set, so they wait for Enter.
+constexpr glong kLiveSearchMinChars = 2;
+
+// -----------------------------------------------------------------------------
+// Return the live search debounce window in milliseconds.
+// -----------------------------------------------------------------------------
+static guint
+live_search_delay_ms()
+{
+  static const guint delay = []() {
+    const char *text = g_getenv("DNFUI_LIVE_SEARCH_DELAY_MS");
+    if (!text || !*text) {
+      return kDefaultLiveSearchDelayMs;
+    }
+    return static_cast<guint>(g_ascii_strtoull(text, nullptr, 10));
+  }();
+  return delay;
+}
+
+// -----------------------------------------------------------------------------
+// Count one finished live search and trace its keystroke-to-results latency.
+// -----------------------------------------------------------------------------
+static void
+record_live_search_latency(SearchWidgets *widgets, int64_t keystroke_us, bool cache_hit)
+{
+  LiveSearchStats &stats = widgets->query_state.live_search_stats;
+  const int64_t latency_us = g_get_monotonic_time() - keystroke_us;
+  stats.completed++;
+  if (cache_hit) {
+    stats.cache_hits++;
+  }
+  stats.total_latency_us += latency_us;
+  stats.max_latency_us = std::max(stats.max_latency_us, latency_us);
+
+  DNFUI_TRACE("Live search latency=%lldms avg=%lldms max=%lldms completed=%llu cached=%llu "
+              "superseded=%llu started=%llu delay=%ums",
+              static_cast<long long>(latency_us / 1000),
+              static_cast<long long>(stats.total_latency_us / static_cast<int64_t>(stats.completed) / 1000),
+              static_cast<long long>(stats.max_latency_us / 1000),
+              static_cast<unsigned long long>(stats.completed),
+              static_cast<unsigned long long>(stats.cache_hits),
+              static_cast<unsigned long long>(stats.superseded),
+              static_cast<unsigned long long>(stats.started),
+              live_search_delay_ms());
+}
+
+// -----------------------------------------------------------------------------
+// Drop the queued live search timeout, if any.
+// -----------------------------------------------------------------------------
+static void
+cancel_live_search_timeout(SearchWidgets *widgets)
+{
+  if (widgets->query_state.live_search_source_id) {
+    g_source_remove(widgets->query_state.live_search_source_id);
+    widgets->query_state.live_search_source_id = 0;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Cancel a live search worker that newer input has made outdated.
+// -----------------------------------------------------------------------------
+static void
+supersede_live_search(SearchWidgets *widgets)
+{
+  if (!widgets->query_state.live_search_running || !has_active_package_list_request(widgets)) {
+    return;
+  }
+
+  widgets->query_state.live_search_stats.superseded++;
+  cancel_active_package_list_request(widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Return the search entry text when it is long enough for a live search.
+// -----------------------------------------------------------------------------
+static std::string
+live_search_term(SearchWidgets *widgets)
+{
+  const char *txt = gtk_editable_get_text(GTK_EDITABLE(widgets->query.entry));
+  if (!txt || g_utf8_strlen(txt, -1) < kLiveSearchMinChars) {
+    return "";
+  }
+  return txt;
+}
+
+// Result of one streamed search. The streamed batches move into the table, so
+// only a cached search keeps its own copy of the rows.
+struct StreamedSearchResult {
+  size_t count = 0;
+  std::vector<PackageRow> cached_rows;
+};
+
 // -----------------------------------------------------------------------------
 // Search the merged package list on a worker thread.
 // -----------------------------------------------------------------------------
@@ -539,12 +1169,23 @@ on_search_task(GTask *task, gpointer, gpointer task_data, GCancellable *cancella
   try {
     DNFUI_TRACE(
         "Search task start request=%llu pattern=%s", td ? static_cast<unsigned long long>(td->request_id) : 0, pattern);
-    auto *results = new std::vector<PackageRow>(dnf_backend_search_package_rows_interruptible(pattern, cancellable));
+    auto *results = new StreamedSearchResult();
+    const bool keep_rows = td && td->cache_key;
+    PackageRowBatchCallback stream_batch = package_row_stream_callback(package_row_stream_for_task(task));
+    results->count =
+        dnf_backend_search_package_rows_streaming(pattern, cancellable, [&](std::vector<PackageRow> batch) {
+          if (keep_rows) {
+            results->cached_rows.insert(results->cached_rows.end(), batch.begin(), batch.end());
+          }
+          if (stream_batch) {
+            stream_batch(std::move(batch));
+          }
+        });
     DNFUI_TRACE("Search task done request=%llu results=%zu",
                 td ? static_cast<unsigned long long>(td->request_id) : 0,
-                results->size());
+                results->count);
     // Let GTask free results if completion is skipped or cancelled.
-    g_task_return_pointer(task, results, [](gpointer p) { delete static_cast<std::vector<PackageRow> *>(p); });
+    g_task_return_pointer(task, results, [](gpointer p) { delete static_cast<StreamedSearchResult *>(p); });
   } catch (const std::exception &e) {
     DNFUI_TRACE(
         "Search task failed request=%llu error=%s", td ? static_cast<unsigned long long>(td->request_id) : 0, e.what());
@@ -577,7 +1218,7 @@ on_search_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
   }
 
   GError *error = nullptr;
-  std::vector<PackageRow> *packages = static_cast<std::vector<PackageRow> *>(g_task_propagate_pointer(task, &error));
+  auto *results = static_cast<StreamedSearchResult *>(g_task_propagate_pointer(task, &error));
 
   // Release this task's spinner slot.
   widgets_spinner_release(widgets->query.spinner);
@@ -586,32 +1227,38 @@ on_search_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
     end_package_list_request(widgets, td->request_id, PackageListRequestKind::SEARCH);
   }
 
-  if (packages) {
+  if (results) {
+    // Display the result count once the last streamed batch is in the table.
+    const size_t count = results->count;
+
     // Save rows so the same search can be shown faster next time.
     // Search results are only reusable while the backend Base generation stays
     // the same, otherwise repo state may have changed underneath the cache.
+    // The rows move into the shared result set instead of being copied.
     if (td && td->cache_key) {
-      package_query_cache_store(td->cache_key, td->generation, *packages);
-    }
-
-    if (td) {
-      set_displayed_search_query(widgets, *td);
+      package_query_cache_store(td->cache_key,
+                                td->generation,
+                                std::make_shared<const std::vector<PackageRow>>(std::move(results->cached_rows)));
     }
-
-    dnf_backend_refresh_installed_nevras();
-
-    // Fill the package table and display the result count.
-    if (widgets->query_state.preserve_selection_on_reload) {
-      widgets->results.selected_nevra = widgets->query_state.reload_selected_nevra;
-    } else {
-      widgets->results.selected_nevra.clear();
-    }
-    package_table_fill_package_view(widgets, *packages);
-    std::string msg = dnfui_i18n_format_count(packages->size(), "Found %zu package.", "Found %zu packages.");
-    ui_helpers_set_status(widgets->query.status_label, msg, "green");
-    finish_results_refresh(widgets);
-    delete packages;
+    delete results;
+    // The task data is freed with the task, so keep a copy of the query state.
+    const bool have_query = td != nullptr;
+    const DisplayedPackageQueryState displayed = td ? displayed_search_query_for(*td) : DisplayedPackageQueryState();
+    const int64_t live_keystroke_us = td && td->live_search ? td->keystroke_us : 0;
+    finish_package_row_stream(
+        package_row_stream_for_task(task), [widgets, have_query, displayed, count, live_keystroke_us]() {
+          if (have_query) {
+            widgets->query_state.displayed_query = displayed;
+          }
+          std::string msg = dnfui_i18n_format_count(count, "Found %zu package.", "Found %zu packages.");
+          ui_helpers_set_status(widgets->query.status_label, msg, "green");
+          finish_results_refresh(widgets);
+          if (live_keystroke_us) {
+            record_live_search_latency(widgets, live_keystroke_us, false);
+          }
+        });
   } else {
+    widgets->query_state.streaming_request_id = 0;
     widgets->query_state.preserve_selection_on_reload = false;
     widgets->query_state.reload_selected_nevra.clear();
     ui_helpers_set_status(widgets->query.status_label, error ? error->message : _("Error or no results."), "red");
@@ -622,7 +1269,35 @@ on_search_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
 }
 
 // -----------------------------------------------------------------------------
-// Add a new search term to history if it is not already present.
+// Return the search flags selected in the search controls.
+// -----------------------------------------------------------------------------
+static DnfBackendSearchOptions
+search_options_from_controls(SearchWidgets *widgets)
+{
+  return {
+    .search_in_description =
+        static_cast<bool>(gtk_check_button_get_active(GTK_CHECK_BUTTON(widgets->query.desc_checkbox))),
+    .exact_match = static_cast<bool>(gtk_check_button_get_active(GTK_CHECK_BUTTON(widgets->query.exact_checkbox))),
+    .search_in_files =
+        static_cast<bool>(gtk_check_button_get_active(GTK_CHECK_BUTTON(widgets->query.files_checkbox))),
+  };
+}
+
+// -----------------------------------------------------------------------------
+// Append one term to the visible history list.
+// -----------------------------------------------------------------------------
+static void
+append_history_row(SearchWidgets *widgets, const std::string &term)
+{
+  GtkWidget *row = gtk_label_new(term.c_str());
+  gtk_label_set_xalign(GTK_LABEL(row), 0.0);
+  gtk_list_box_append(widgets->query.history_list, row);
+}
+
+// -----------------------------------------------------------------------------
+// Count one use of a search term with the current flags. A new term is also
+// added to the visible history list. The history is saved right away, so the
+// use counts survive a crash.
 // -----------------------------------------------------------------------------
 static void
 add_to_history(SearchWidgets *widgets, const std::string &term)
@@ -631,39 +1306,69 @@ add_to_history(SearchWidgets *widgets, const std::string &term)
     return;
   }
 
-  // Prevent duplicate history entries.
-  for (const auto &s : widgets->query_state.history) {
-    if (s == term) {
-      return;
-    }
+  if (search_history_record_use(widgets->query_state.history, term, search_options_from_controls(widgets))) {
+    append_history_row(widgets, term);
   }
+  search_history_save(widgets->query_state.history);
+}
 
-  // Append the new term to internal state and the visible history list.
-  widgets->query_state.history.push_back(term);
-  GtkWidget *row = gtk_label_new(term.c_str());
-  gtk_label_set_xalign(GTK_LABEL(row), 0.0);
-  gtk_list_box_append(widgets->query.history_list, row);
+// -----------------------------------------------------------------------------
+// Answer a browse or search from the package index file saved by the last
+// launch while the first Base is still loading. The rows are shown read-only
+// like the last session's view, and the warm up reruns the query once the Base
+// is ready. Returns false when no index file is mapped or the query needs
+// package descriptions or file lists.
+// -----------------------------------------------------------------------------
+static bool
+show_package_index_file_rows(SearchWidgets *widgets, const DisplayedPackageQueryState &query)
+{
+  std::vector<PackageRow> rows;
+  std::vector<PackageInstallState> states;
+  const DnfBackendSearchOptions search_options {
+    query.search_in_description,
+    query.exact_match,
+    query.search_in_files,
+  };
+  if (!dnf_backend_query_package_index_file(query.search_term, search_options, rows, states)) {
+    return false;
+  }
+
+  widgets->query_state.displayed_query = query;
+  widgets->query_state.showing_view_snapshot = true;
+  widgets->results.selected_nevra.clear();
+  package_info_reset_details_view(widgets);
+  package_table_show_restored_rows(widgets, rows, states);
+  std::string msg = dnfui_i18n_format_count(rows.size(),
+                                            "Showing %zu saved package. Loading package data...",
+                                            "Showing %zu saved packages. Loading package data...");
+  ui_helpers_set_status(widgets->query.status_label, msg, "blue");
+  DNFUI_TRACE("Package index file query rows=%zu", rows.size());
+  return true;
 }
 
 // -----------------------------------------------------------------------------
-// Run a search from cache or start a background search task.
+// Run a search from cache or start a background search task. Live searches
+// come from typing and keep the entry editable while they run.
 // -----------------------------------------------------------------------------
 static void
-perform_search(SearchWidgets *widgets, const std::string &term)
+perform_search(SearchWidgets *widgets, const std::string &term, bool live = false)
 {
   if (term.empty()) {
     return;
   }
 
+  // Any search started here answers the latest input, so a queued live
+  // search would only repeat it.
+  cancel_live_search_timeout(widgets);
+  const int64_t keystroke_us = widgets->query_state.live_search_keystroke_us;
+
   // Include the current checkboxes in the cache key even for history searches.
-  dnf_backend_set_search_options({
-      .search_in_description =
-          static_cast<bool>(gtk_check_button_get_active(GTK_CHECK_BUTTON(widgets->query.desc_checkbox))),
-      .exact_match = static_cast<bool>(gtk_check_button_get_active(GTK_CHECK_BUTTON(widgets->query.exact_checkbox))),
-  });
+  dnf_backend_set_search_options(search_options_from_controls(widgets));
   const DnfBackendSearchOptions search_options = dnf_backend_get_search_options();
 
+  widgets->query_state.suppress_live_search = true;
   gtk_editable_set_text(GTK_EDITABLE(widgets->query.entry), term.c_str());
+  widgets->query_state.suppress_live_search = false;
   std::string searching_message = dnfui_i18n_format(_("Searching for '%s'..."), term.c_str());
   ui_helpers_set_status(widgets->query.status_label, searching_message, "blue");
   if (!widgets->query_state.preserve_selection_on_reload) {
@@ -675,22 +1380,50 @@ perform_search(SearchWidgets *widgets, const std::string &term)
   // and transaction rebuilds cannot surface outdated package metadata.
   const std::string key = package_query_cache_key_for(term);
   const uint64_t generation = BaseManager::instance().current_generation();
-  std::vector<PackageRow> cached_packages;
-  if (package_query_cache_lookup(key, generation, cached_packages)) {
+  // Hits share the cached rows, so showing them again copies nothing up front.
+  SharedPackageRows cached_packages;
+  const bool cache_hit = package_query_cache_lookup(key, generation, cached_packages);
+  // A broader cached name search from the same generation holds every row of
+  // this narrower one, so filter it instead of scanning the backend again.
+  const bool refined = !cache_hit && package_query_cache_refine(term, generation, cached_packages);
+  if (cache_hit || refined) {
+    if (refined) {
+      package_query_cache_store(key, generation, cached_packages);
+    }
+
     // Show saved rows and skip the worker thread.
     SearchTaskData cached_td {};
     cached_td.term = const_cast<char *>(term.c_str());
     cached_td.search_in_description = search_options.search_in_description;
     cached_td.exact_match = search_options.exact_match;
+    cached_td.search_in_files = search_options.search_in_files;
     set_displayed_search_query(widgets, cached_td);
 
-    package_table_fill_package_view(widgets, cached_packages);
+    package_table_fill_package_view(widgets, *cached_packages);
 
     std::string msg =
-        dnfui_i18n_format_count(cached_packages.size(), "Loaded %zu cached result.", "Loaded %zu cached results.");
+        refined ? dnfui_i18n_format_count(
+                      cached_packages->size(), "Filtered %zu cached result.", "Filtered %zu cached results.")
+                : dnfui_i18n_format_count(
+                      cached_packages->size(), "Loaded %zu cached result.", "Loaded %zu cached results.");
     ui_helpers_set_status(widgets->query.status_label, msg, "gray");
     finish_results_refresh(widgets);
+    if (live) {
+      record_live_search_latency(widgets, keystroke_us, true);
+    }
+
+    return;
+  }
 
+  // Before the first Base is ready, the saved package index can answer name
+  // searches without waiting for the repositories to load.
+  DisplayedPackageQueryState file_query;
+  file_query.kind = DisplayedPackageQueryKind::SEARCH;
+  file_query.search_term = term;
+  file_query.search_in_description = search_options.search_in_description;
+  file_query.exact_match = search_options.exact_match;
+  file_query.search_in_files = search_options.search_in_files;
+  if (show_package_index_file_rows(widgets, file_query)) {
     return;
   }
 
@@ -704,13 +1437,17 @@ perform_search(SearchWidgets *widgets, const std::string &term)
   td->generation = generation;
   td->search_in_description = search_options.search_in_description;
   td->exact_match = search_options.exact_match;
+  td->search_in_files = search_options.search_in_files;
+  td->live_search = live;
+  td->keystroke_us = keystroke_us;
 
   GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
   // Disable the search controls and make the Search button stop this task.
-  begin_package_list_request(widgets, c, td->request_id, PackageListRequestKind::SEARCH);
+  begin_package_list_request(widgets, c, td->request_id, PackageListRequestKind::SEARCH, live);
   GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_search_task_finished);
+  attach_package_row_stream(task, widgets, td->request_id, td->generation, true);
   g_task_set_task_data(task, td, search_task_data_free);
-  g_task_run_in_thread(task, on_search_task);
+  ui_task_run_in_thread(task, on_search_task, UiTaskClass::QUERY);
   g_object_unref(task);
   g_object_unref(c);
 }
@@ -745,9 +1482,10 @@ package_query_on_list_button_clicked(GtkButton *, gpointer user_data)
   // Disable the query controls and make List Installed stop this task.
   begin_package_list_request(widgets, c, td->request_id, PackageListRequestKind::LIST_INSTALLED);
   GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_list_task_finished);
+  attach_package_row_stream(task, widgets, td->request_id, td->generation, false);
   g_task_set_task_data(task, td, [](gpointer p) { delete static_cast<PackageListTaskData *>(p); });
 
-  g_task_run_in_thread(task, on_list_task);
+  ui_task_run_in_thread(task, on_list_task, UiTaskClass::QUERY);
   g_object_unref(task);
   g_object_unref(c);
 }
@@ -768,6 +1506,12 @@ package_query_on_list_available_button_clicked(GtkButton *, gpointer user_data)
     return;
   }
 
+  DisplayedPackageQueryState browse_query;
+  browse_query.kind = DisplayedPackageQueryKind::LIST_AVAILABLE;
+  if (show_package_index_file_rows(widgets, browse_query)) {
+    return;
+  }
+
   ui_helpers_set_status(widgets->query.status_label, _("Listing packages..."), "blue");
 
   // Show the spinner for this task.
@@ -781,9 +1525,10 @@ package_query_on_list_available_button_clicked(GtkButton *, gpointer user_data)
   // Disable the query controls and make List Packages stop this task.
   begin_package_list_request(widgets, c, td->request_id, PackageListRequestKind::LIST_AVAILABLE);
   GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_list_available_task_finished);
+  attach_package_row_stream(task, widgets, td->request_id, td->generation, true);
   g_task_set_task_data(task, td, [](gpointer p) { delete static_cast<PackageListTaskData *>(p); });
 
-  g_task_run_in_thread(task, on_list_available_task);
+  ui_task_run_in_thread(task, on_list_available_task, UiTaskClass::QUERY);
   g_object_unref(task);
   g_object_unref(c);
 }
@@ -817,9 +1562,10 @@ package_query_on_list_upgradeable_button_clicked(GtkButton *, gpointer user_data
   // Disable the query controls and make List Upgradable stop this task.
   begin_package_list_request(widgets, c, td->request_id, PackageListRequestKind::LIST_UPGRADEABLE);
   GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_list_upgradeable_task_finished);
+  attach_package_row_stream(task, widgets, td->request_id, td->generation, true);
   g_task_set_task_data(task, td, [](gpointer p) { delete static_cast<PackageListTaskData *>(p); });
 
-  g_task_run_in_thread(task, on_list_upgradeable_task);
+  ui_task_run_in_thread(task, on_list_upgradeable_task, UiTaskClass::QUERY);
   g_object_unref(task);
   g_object_unref(c);
 }
@@ -830,9 +1576,14 @@ package_query_on_list_upgradeable_button_clicked(GtkButton *, gpointer user_data
 // The same button acts as Stop while a search worker task is running.
 // -----------------------------------------------------------------------------
 void
-package_query_on_search_button_clicked(GtkButton *, gpointer user_data)
+package_query_on_search_button_clicked(GtkButton *button, gpointer user_data)
 {
   SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  // Enter during a live search confirms the typed term instead of stopping.
+  const bool from_entry = button != widgets->query.search_button;
+  if (from_entry) {
+    supersede_live_search(widgets);
+  }
   if (has_active_package_list_request(widgets)) {
     if (widgets->query_state.current_package_list_request_kind == PackageListRequestKind::SEARCH) {
       cancel_active_package_list_request(widgets);
@@ -852,6 +1603,60 @@ package_query_on_search_button_clicked(GtkButton *, gpointer user_data)
   perform_search(widgets, pattern);
 }
 
+// -----------------------------------------------------------------------------
+// Start the debounced live search once typing has paused.
+// -----------------------------------------------------------------------------
+static gboolean
+on_live_search_timeout(gpointer user_data)
+{
+  auto *held = static_cast<std::weak_ptr<SearchWidgets> *>(user_data);
+  std::shared_ptr<SearchWidgets> widgets = held->lock();
+  if (!widgets || widgets->window_state.destroyed) {
+    return G_SOURCE_REMOVE;
+  }
+  widgets->query_state.live_search_source_id = 0;
+
+  // A list task or an explicit search owns the controls, so let it finish.
+  if (has_active_package_list_request(widgets.get())) {
+    return G_SOURCE_REMOVE;
+  }
+
+  const std::string term = live_search_term(widgets.get());
+  if (!term.empty()) {
+    widgets->query_state.live_search_stats.started++;
+    perform_search(widgets.get(), term, true);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Handle edits in the search field.
+// Each edit cancels the outdated live search and restarts the debounce window.
+// History is only recorded for searches confirmed with Enter or the button.
+// -----------------------------------------------------------------------------
+void
+package_query_on_search_entry_changed(GtkEditable *, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  if (!widgets || widgets->window_state.destroyed || widgets->query_state.suppress_live_search) {
+    return;
+  }
+
+  cancel_live_search_timeout(widgets);
+  supersede_live_search(widgets);
+  if (has_active_package_list_request(widgets) || live_search_term(widgets).empty()) {
+    return;
+  }
+
+  widgets->query_state.live_search_keystroke_us = g_get_monotonic_time();
+  widgets->query_state.live_search_source_id =
+      g_timeout_add_full(G_PRIORITY_DEFAULT,
+                         live_search_delay_ms(),
+                         on_live_search_timeout,
+                         new std::weak_ptr<SearchWidgets>(widgets->weak_from_this()),
+                         [](gpointer p) { delete static_cast<std::weak_ptr<SearchWidgets> *>(p); });
+}
+
 // -----------------------------------------------------------------------------
 // Handle selecting a search term from the history list.
 // -----------------------------------------------------------------------------
@@ -864,10 +1669,28 @@ package_query_on_history_row_selected(GtkListBox *, GtkListBoxRow *row, gpointer
 
   SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
   GtkWidget *child = gtk_list_box_row_get_child(row);
-  const char *term = gtk_label_get_text(GTK_LABEL(child));
+  const std::string term = gtk_label_get_text(GTK_LABEL(child));
+  add_to_history(widgets, term);
   perform_search(widgets, term);
 }
 
+// -----------------------------------------------------------------------------
+// Fill the history list from the saved history. A missing or damaged file
+// leaves the history empty.
+// -----------------------------------------------------------------------------
+void
+package_query_load_history(SearchWidgets *widgets)
+{
+  if (!search_history_load(widgets->query_state.history)) {
+    return;
+  }
+
+  for (const auto &entry : widgets->query_state.history) {
+    append_history_row(widgets, entry.term);
+  }
+  DNFUI_TRACE("Search history loaded entries=%zu", widgets->query_state.history.size());
+}
+
 // -----------------------------------------------------------------------------
 // Handle the Clear List button.
 // Clears displayed package rows and resets the details panel.
@@ -882,7 +1705,7 @@ package_query_on_clear_button_clicked(GtkButton *, gpointer user_data)
   widgets->query_state.displayed_query = DisplayedPackageQueryState();
   widgets->query_state.preserve_selection_on_reload = false;
   widgets->query_state.reload_selected_nevra.clear();
-  widgets->results.current_packages.clear();
+  widgets->query_state.showing_view_snapshot = false;
   widgets->results.selected_nevra.clear();
   package_table_fill_package_view(widgets, {});
 
@@ -892,15 +1715,153 @@ package_query_on_clear_button_clicked(GtkButton *, gpointer user_data)
   ui_helpers_update_action_button_labels(widgets, "");
 }
 
+// Data passed to one background reload of an exact-NEVRA view.
+struct NevraReloadTaskData {
+  uint64_t request_id;
+  uint64_t generation;
+  // Selected NEVRA when the reload started.
+  std::string nevra;
+  // Every NEVRA listed in the view, looked up together.
+  std::vector<std::string> nevras;
+};
+
+// -----------------------------------------------------------------------------
+// Look up the reloaded NEVRAs on a worker thread with one batched installed
+// query and one batched available query for the NEVRAs that are not
+// installed. Installed rows win, so a package that was just installed shows
+// its installed state.
+// -----------------------------------------------------------------------------
+static void
+on_reload_nevra_task(GTask *task, gpointer, gpointer task_data, GCancellable *cancellable)
+{
+  const NevraReloadTaskData *td = static_cast<const NevraReloadTaskData *>(task_data);
+
+  try {
+    auto *rows = new std::vector<PackageRow>(dnf_backend_get_installed_package_rows_by_nevras(td->nevras));
+    std::set<std::string> installed_nevras;
+    for (const auto &row : *rows) {
+      installed_nevras.insert(row.nevra.str());
+    }
+
+    std::vector<std::string> missing;
+    for (const auto &nevra : td->nevras) {
+      if (installed_nevras.count(nevra) == 0) {
+        missing.push_back(nevra);
+      }
+    }
+    if (!missing.empty() && !g_cancellable_is_cancelled(cancellable)) {
+      std::vector<PackageRow> available = dnf_backend_get_available_package_rows_by_nevras(missing);
+      std::move(available.begin(), available.end(), std::back_inserter(*rows));
+    }
+    g_task_return_pointer(task, rows, [](gpointer p) { delete static_cast<std::vector<PackageRow> *>(p); });
+  } catch (const std::exception &e) {
+    g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, e.what()));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Show the reloaded exact-NEVRA view on the GTK thread. A row disappears when
+// its NEVRA is neither installed nor available anymore.
+// -----------------------------------------------------------------------------
+static void
+on_reload_nevra_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
+{
+  GTask *task = G_TASK(res);
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  const NevraReloadTaskData *td = static_cast<const NevraReloadTaskData *>(g_task_get_task_data(task));
+
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    if (widgets && !widgets->window_state.destroyed) {
+      if (GCancellable *c = g_task_get_cancellable(task)) {
+        if (g_cancellable_is_cancelled(c) && td) {
+          end_package_list_request(widgets, td->request_id, PackageListRequestKind::RELOAD_NEVRA);
+          widgets->query_state.preserve_selection_on_reload = false;
+          widgets->query_state.reload_selected_nevra.clear();
+        }
+      }
+    }
+    return;
+  }
+
+  widgets_spinner_release(widgets->query.spinner);
+  end_package_list_request(widgets, td->request_id, PackageListRequestKind::RELOAD_NEVRA);
+
+  // A newer Base or another view replaced what this task was reloading.
+  if (td->generation != BaseManager::instance().current_generation() ||
+      widgets->results.selected_nevra != td->nevra) {
+    widgets->query_state.preserve_selection_on_reload = false;
+    widgets->query_state.reload_selected_nevra.clear();
+    return;
+  }
+
+  GError *error = nullptr;
+  std::vector<PackageRow> *rows = static_cast<std::vector<PackageRow> *>(g_task_propagate_pointer(task, &error));
+  if (!rows) {
+    widgets->query_state.preserve_selection_on_reload = false;
+    widgets->query_state.reload_selected_nevra.clear();
+    ui_helpers_set_status(widgets->query.status_label, error ? error->message : _("Error reloading package."), "red");
+    if (error) {
+      g_error_free(error);
+    }
+    return;
+  }
+
+  const std::string &reload_selected = widgets->query_state.reload_selected_nevra;
+  const bool selected_found = std::any_of(
+      rows->begin(), rows->end(), [&reload_selected](const PackageRow &row) { return row.nevra == reload_selected; });
+  widgets->results.selected_nevra = selected_found ? reload_selected : "";
+  package_table_fill_package_view(widgets, *rows);
+  delete rows;
+  finish_results_refresh(widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Refresh the exact-NEVRA view around the selected NEVRA in the background,
+// so the GTK thread never waits on the Base lock after a transaction.
+// -----------------------------------------------------------------------------
+static void
+reload_selected_nevra_view(SearchWidgets *widgets)
+{
+  widgets_spinner_acquire(widgets->query.spinner);
+
+  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
+  NevraReloadTaskData *td = new NevraReloadTaskData;
+  td->request_id = widgets->query_state.next_package_list_request_id++;
+  td->generation = BaseManager::instance().current_generation();
+  td->nevra = widgets->results.selected_nevra;
+  for (const auto &row : package_table_get_package_rows(widgets)) {
+    td->nevras.push_back(row.nevra.str());
+  }
+  if (std::find(td->nevras.begin(), td->nevras.end(), td->nevra) == td->nevras.end()) {
+    td->nevras.push_back(td->nevra);
+  }
+
+  begin_package_list_request(widgets, c, td->request_id, PackageListRequestKind::RELOAD_NEVRA);
+  GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_reload_nevra_task_finished);
+  g_task_set_task_data(task, td, [](gpointer p) { delete static_cast<NevraReloadTaskData *>(p); });
+
+  ui_task_run_in_thread(task, on_reload_nevra_task, UiTaskClass::QUERY);
+  g_object_unref(task);
+  g_object_unref(c);
+}
+
 // -----------------------------------------------------------------------------
 // Rebuild the currently displayed package table after a transaction or repo
 // refresh. Query-backed views are replayed through their normal async entry
-// points, exact one-package views are refreshed from the selected NEVRA.
+// points, exact one-package views are refreshed from the selected NEVRA on a
+// worker task as well.
 // -----------------------------------------------------------------------------
 void
 package_query_reload_current_view(SearchWidgets *widgets)
 {
-  if (!widgets || has_active_package_list_request(widgets)) {
+  if (!widgets) {
+    return;
+  }
+
+  // Every rebuild ends up here, so compute the frequent searches for the new
+  // Base once the reload is out of the way.
+  search_prewarm_schedule(widgets);
+  if (has_active_package_list_request(widgets)) {
     return;
   }
 
@@ -909,6 +1870,16 @@ package_query_reload_current_view(SearchWidgets *widgets)
 
   const DisplayedPackageQueryState view_state = widgets->query_state.displayed_query;
 
+  // The query started below merges its rows into the table already on screen.
+  struct ReloadFlagReset {
+    SearchWidgets *widgets;
+    ~ReloadFlagReset()
+    {
+      widgets->query_state.reloading_current_view = false;
+    }
+  } reload_flag_reset { widgets };
+  widgets->query_state.reloading_current_view = true;
+
   switch (view_state.kind) {
   case DisplayedPackageQueryKind::SEARCH:
     if (view_state.search_term.empty()) {
@@ -919,6 +1890,7 @@ package_query_reload_current_view(SearchWidgets *widgets)
 
     gtk_check_button_set_active(GTK_CHECK_BUTTON(widgets->query.desc_checkbox), view_state.search_in_description);
     gtk_check_button_set_active(GTK_CHECK_BUTTON(widgets->query.exact_checkbox), view_state.exact_match);
+    gtk_check_button_set_active(GTK_CHECK_BUTTON(widgets->query.files_checkbox), view_state.search_in_files);
     perform_search(widgets, view_state.search_term);
     return;
   case DisplayedPackageQueryKind::LIST_INSTALLED:
@@ -935,24 +1907,87 @@ package_query_reload_current_view(SearchWidgets *widgets)
     break;
   }
 
-  // Exact one-package views are not part of the main query state. When the
-  // user is reviewing one package from the pending-actions sidebar, refresh the
-  // selected NEVRA directly so removed rows disappear without carrying extra
-  // global view bookkeeping.
+  // Exact-NEVRA views are not part of the main query state. When the user is
+  // reviewing a package from the pending-actions sidebar, refresh the listed
+  // NEVRAs directly so removed rows disappear without carrying extra global
+  // view bookkeeping.
   if (widgets->results.selected_nevra.empty()) {
     widgets->query_state.preserve_selection_on_reload = false;
     widgets->query_state.reload_selected_nevra.clear();
     return;
   }
 
-  std::vector<PackageRow> rows = dnf_backend_get_installed_package_rows_by_nevra(widgets->results.selected_nevra);
-  if (rows.empty()) {
-    rows = dnf_backend_get_available_package_rows_by_nevra(widgets->results.selected_nevra);
+  reload_selected_nevra_view(widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Show the last session's view when its stamps still match the rpmdb and the
+// dnf configuration, so the saved install states are still the real ones.
+// -----------------------------------------------------------------------------
+bool
+package_query_show_view_snapshot(SearchWidgets *widgets)
+{
+  if (!widgets) {
+    return false;
   }
 
-  widgets->results.selected_nevra = rows.empty() ? "" : widgets->query_state.reload_selected_nevra;
-  package_table_fill_package_view(widgets, rows);
-  finish_results_refresh(widgets);
+  PackageViewSnapshot snapshot;
+  if (!package_view_snapshot_load(snapshot) || snapshot.query.kind == DisplayedPackageQueryKind::NONE) {
+    return false;
+  }
+  if (snapshot.stamps != base_state_fingerprint_startup_stamps()) {
+    DNFUI_TRACE("View snapshot skipped: system state changed");
+    return false;
+  }
+
+  widgets->query_state.displayed_query = snapshot.query;
+  widgets->query_state.showing_view_snapshot = true;
+  if (snapshot.query.kind == DisplayedPackageQueryKind::SEARCH) {
+    widgets->query_state.suppress_live_search = true;
+    gtk_editable_set_text(GTK_EDITABLE(widgets->query.entry), snapshot.query.search_term.c_str());
+    widgets->query_state.suppress_live_search = false;
+    gtk_check_button_set_active(GTK_CHECK_BUTTON(widgets->query.desc_checkbox), snapshot.query.search_in_description);
+    gtk_check_button_set_active(GTK_CHECK_BUTTON(widgets->query.exact_checkbox), snapshot.query.exact_match);
+    gtk_check_button_set_active(GTK_CHECK_BUTTON(widgets->query.files_checkbox), snapshot.query.search_in_files);
+  }
+
+  package_table_show_restored_rows(widgets, snapshot.rows, snapshot.states);
+  std::string msg = dnfui_i18n_format_count(snapshot.rows.size(),
+                                            "Showing %zu package from the last session. Loading package data...",
+                                            "Showing %zu packages from the last session. Loading package data...");
+  ui_helpers_set_status(widgets->query.status_label, msg, "blue");
+  DNFUI_TRACE("View snapshot shown rows=%zu", snapshot.rows.size());
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Save the displayed query and its rows for the next launch. A view that is
+// still streaming, or the unchanged snapshot itself, is not saved.
+// -----------------------------------------------------------------------------
+void
+package_query_save_view_snapshot(SearchWidgets *widgets)
+{
+  if (!widgets || widgets->query_state.showing_view_snapshot || has_active_package_list_request(widgets)) {
+    return;
+  }
+
+  const DisplayedPackageQueryState &query = widgets->query_state.displayed_query;
+  if (query.kind == DisplayedPackageQueryKind::NONE) {
+    package_view_snapshot_remove();
+    return;
+  }
+
+  PackageViewSnapshot snapshot;
+  snapshot.query = query;
+  snapshot.stamps = base_state_fingerprint_startup_stamps();
+  snapshot.rows = package_table_get_package_rows(widgets);
+  snapshot.states.reserve(snapshot.rows.size());
+  const InstalledPackageSnapshotPtr installed = dnf_backend_get_installed_snapshot();
+  for (const auto &row : snapshot.rows) {
+    snapshot.states.push_back(dnf_backend_get_package_install_state(*installed, row));
+  }
+  package_view_snapshot_save(snapshot);
+  DNFUI_TRACE("View snapshot saved rows=%zu", snapshot.rows.size());
 }
 
 // -----------------------------------------------------------------------------
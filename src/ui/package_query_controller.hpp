@@ -3,7 +3,7 @@
 // Public package query controller entry points
 //
 // Owns the GTK callbacks and refresh hooks for search, package listing,
-// query history, and package-query cache invalidation.
+// query history, and package-query cache invalidation and carry over.
 // -----------------------------------------------------------------------------
 #pragma once
 
@@ -28,21 +28,55 @@ void package_query_on_list_upgradeable_button_clicked(GtkButton *, gpointer user
 // -----------------------------------------------------------------------------
 void package_query_on_search_button_clicked(GtkButton *, gpointer user_data);
 // -----------------------------------------------------------------------------
+// Handle edits in the search field and schedule a debounced live search.
+// -----------------------------------------------------------------------------
+void package_query_on_search_entry_changed(GtkEditable *, gpointer user_data);
+// -----------------------------------------------------------------------------
 // Restore and run a search from a selected history row.
 // -----------------------------------------------------------------------------
 void package_query_on_history_row_selected(GtkListBox *, GtkListBoxRow *row, gpointer user_data);
 // -----------------------------------------------------------------------------
+// Load the search history saved by earlier sessions into the history list.
+// -----------------------------------------------------------------------------
+void package_query_load_history(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
 // Clear the current package list and search status.
 // -----------------------------------------------------------------------------
 void package_query_on_clear_button_clicked(GtkButton *, gpointer user_data);
 // -----------------------------------------------------------------------------
-// Clear cached package query results.
+// Clear cached package query results and package details.
 // -----------------------------------------------------------------------------
 void package_query_clear_search_cache();
 // -----------------------------------------------------------------------------
+// Worker task that rebuilds the Base after a transaction and keeps the cached
+// searches whose inputs did not change. Returns a boolean through task.
+// -----------------------------------------------------------------------------
+void package_query_on_rebuild_after_transaction_task(GTask *task, gpointer, gpointer, GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Worker task that refreshes the repository whose id is the task data, a
+// std::string, and keeps the cached searches it did not change. Returns a
+// heap BaseRepoState through task.
+// -----------------------------------------------------------------------------
+void package_query_on_refresh_repo_task(GTask *task, gpointer, gpointer task_data, GCancellable *cancellable);
+// -----------------------------------------------------------------------------
+// Rebuild the Base after the installed packages changed, by a transaction of
+// this app or outside it, then refresh installed state and reload the current
+// view. A call while a rebuild runs is checked again after it finishes.
+// -----------------------------------------------------------------------------
+void package_query_rebuild_after_installed_change(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
 // Reload the currently displayed package query view.
 // -----------------------------------------------------------------------------
 void package_query_reload_current_view(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Show the package view saved by the last session, read-only, until the live
+// Base is ready. Returns false when there is no usable snapshot.
+// -----------------------------------------------------------------------------
+bool package_query_show_view_snapshot(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Save the displayed package view for the next launch.
+// -----------------------------------------------------------------------------
+void package_query_save_view_snapshot(SearchWidgets *widgets);
 
 // -----------------------------------------------------------------------------
 // EOF
@@ -7,6 +7,8 @@
 // -----------------------------------------------------------------------------
 #pragma once
 
+#include "ui/search_history.hpp"
+
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -16,7 +18,7 @@
 // -----------------------------------------------------------------------------
 // Active background request using the package-list action buttons
 // -----------------------------------------------------------------------------
-enum class PackageListRequestKind { NONE, SEARCH, LIST_INSTALLED, LIST_AVAILABLE, LIST_UPGRADEABLE };
+enum class PackageListRequestKind { NONE, SEARCH, LIST_INSTALLED, LIST_AVAILABLE, LIST_UPGRADEABLE, RELOAD_NEVRA };
 
 // -----------------------------------------------------------------------------
 // Last query-backed package view shown in the main table.
@@ -32,6 +34,20 @@ struct DisplayedPackageQueryState {
   std::string search_term;
   bool search_in_description = false;
   bool exact_match = false;
+  bool search_in_files = false;
+};
+
+// -----------------------------------------------------------------------------
+// Search-as-you-type counters used to tune the debounce window. Latency runs
+// from the last keystroke of a burst until its results are in the table.
+// -----------------------------------------------------------------------------
+struct LiveSearchStats {
+  uint64_t started = 0;
+  uint64_t superseded = 0;
+  uint64_t completed = 0;
+  uint64_t cache_hits = 0;
+  int64_t total_latency_us = 0;
+  int64_t max_latency_us = 0;
 };
 
 // -----------------------------------------------------------------------------
@@ -46,6 +62,20 @@ struct PackageQueryState {
   uint64_t current_package_list_request_id = 0;
   // Identifies which query button owns the active Stop state.
   PackageListRequestKind current_package_list_request_kind = PackageListRequestKind::NONE;
+  // Request id whose streamed rows may still be appended to the package table.
+  // Starting another query or clearing the table drops the remaining batches.
+  uint64_t streaming_request_id = 0;
+  // Pending debounced search-as-you-type timeout, or 0 when none is queued.
+  guint live_search_source_id = 0;
+  // True while the active SEARCH request was started by typing. The entry
+  // stays editable and the next keystroke cancels the request.
+  bool live_search_running = false;
+  // Set while the controller itself writes the entry text, so that write does
+  // not schedule another live search.
+  bool suppress_live_search = false;
+  // Monotonic time of the last keystroke that scheduled a live search.
+  int64_t live_search_keystroke_us = 0;
+  LiveSearchStats live_search_stats;
   // Remembers the last query-backed result view so rebuilds can repopulate the
   // visible table instead of leaving outdated rows on screen after a transaction.
   DisplayedPackageQueryState displayed_query;
@@ -54,7 +84,19 @@ struct PackageQueryState {
   // and details panel when the package is still present.
   bool preserve_selection_on_reload = false;
   std::string reload_selected_nevra;
-  std::vector<std::string> history;
+  // Set while package_query_reload_current_view starts its query, so the row
+  // stream it creates merges into the visible table instead of emptying it.
+  bool reloading_current_view = false;
+  // Set while the table shows the read-only snapshot of the last session. The
+  // first completed refresh replaces it.
+  bool showing_view_snapshot = false;
+  // Confirmed search terms in first-use order, with their use counts. Saved
+  // after every change and loaded when the window is built.
+  std::vector<SearchHistoryEntry> history;
+  // Queued pre-warm of the frequent history searches, or 0 when none is queued.
+  guint prewarm_source_id = 0;
+  // Cancels the running pre-warm task, or nullptr when none runs.
+  GCancellable *prewarm_cancellable = nullptr;
 };
 
 // -----------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 #include "package_table_context_menu.hpp"
 
 #include "i18n.hpp"
+#include "package_table_view.hpp"
 #include "pending_transaction_controller.hpp"
 #include "ui/pending_transaction_state.hpp"
 #include "ui/widgets.hpp"
@@ -16,20 +17,19 @@
 static bool
 get_context_menu_pending_action(SearchWidgets *widgets, const std::string &nevra, PendingAction::Type &out_type)
 {
-  for (const auto &action : widgets->transaction.actions) {
-    if (action.nevra == nevra) {
-      out_type = action.type;
-      return true;
-    }
+  const PendingAction *action = widgets->transaction.find_action(nevra);
+  if (!action) {
+    return false;
   }
 
-  return false;
+  out_type = action->type;
+  return true;
 }
 
 // -----------------------------------------------------------------------------
-// Add one transaction action to the package context menu.
+// Add one action to the package context menu and return its button.
 // -----------------------------------------------------------------------------
-static void
+static GtkWidget *
 append_context_menu_action(GtkBox *box,
                            const char *label,
                            gboolean sensitive,
@@ -41,42 +41,39 @@ append_context_menu_action(GtkBox *box,
   gtk_widget_set_sensitive(button, sensitive);
   g_signal_connect(button, "clicked", callback, widgets);
   gtk_box_append(box, button);
+  return button;
 }
 
 // -----------------------------------------------------------------------------
-// Show right-click actions for one package table row.
+// Add one action that marks every selected row for type.
 // -----------------------------------------------------------------------------
-void
-package_table_show_context_menu(GtkWidget *anchor,
-                                SearchWidgets *widgets,
-                                const PackageRow &row,
-                                double x,
-                                double y,
-                                const std::function<bool(const std::string &)> &select_row)
+static void
+append_bulk_mark_action(
+    GtkBox *box, const char *label, gboolean sensitive, PendingAction::Type type, SearchWidgets *widgets)
 {
-  if (!anchor || !widgets) {
-    return;
-  }
-
-  GtkWidget *view = gtk_widget_get_ancestor(anchor, GTK_TYPE_COLUMN_VIEW);
-  if (!view || !GTK_IS_COLUMN_VIEW(view)) {
-    return;
-  }
-
-  if (!select_row(row.nevra)) {
-    return;
-  }
-
-  GtkWidget *popover = gtk_popover_new();
-  gtk_widget_set_parent(popover, anchor);
-  gtk_popover_set_has_arrow(GTK_POPOVER(popover), FALSE);
-
-  GdkRectangle rect = { static_cast<int>(x), static_cast<int>(y), 1, 1 };
-  gtk_popover_set_pointing_to(GTK_POPOVER(popover), &rect);
-
-  GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
-  gtk_popover_set_child(GTK_POPOVER(popover), box);
+  GtkWidget *button =
+      append_context_menu_action(box,
+                                 label,
+                                 sensitive,
+                                 G_CALLBACK(+[](GtkButton *button, gpointer user_data) {
+                                   auto type = static_cast<PendingAction::Type>(
+                                       GPOINTER_TO_INT(g_object_get_data(G_OBJECT(button), "dnfui-mark-type")));
+                                   if (GtkWidget *popover =
+                                           gtk_widget_get_ancestor(GTK_WIDGET(button), GTK_TYPE_POPOVER)) {
+                                     gtk_popover_popdown(GTK_POPOVER(popover));
+                                   }
+                                   pending_transaction_mark_selected(static_cast<SearchWidgets *>(user_data), type);
+                                 }),
+                                 widgets);
+  g_object_set_data(G_OBJECT(button), "dnfui-mark-type", GINT_TO_POINTER(static_cast<int>(type)));
+}
 
+// -----------------------------------------------------------------------------
+// Add the mark and unmark actions for the one selected row.
+// -----------------------------------------------------------------------------
+static void
+append_single_mark_actions(GtkBox *box, SearchWidgets *widgets, const PackageRow &row, bool writable)
+{
   // Match the main action buttons: remove and reinstall are only valid for the
   // exact installed NEVRA represented by this row.
   bool installed_exact = dnf_backend_is_package_installed_exact(row);
@@ -96,9 +93,9 @@ package_table_show_context_menu(GtkWidget *anchor,
   const char *reinstall_label =
       has_pending && pending_type == PendingAction::REINSTALL ? _("Unmark Reinstall") : _("Mark for Reinstall");
 
-  append_context_menu_action(GTK_BOX(box),
+  append_context_menu_action(box,
                              install_label,
-                             !installed_exact,
+                             writable && !installed_exact,
                              G_CALLBACK(+[](GtkButton *button, gpointer user_data) {
                                if (GtkWidget *popover = gtk_widget_get_ancestor(GTK_WIDGET(button), GTK_TYPE_POPOVER)) {
                                  gtk_popover_popdown(GTK_POPOVER(popover));
@@ -107,9 +104,9 @@ package_table_show_context_menu(GtkWidget *anchor,
                              }),
                              widgets);
 
-  append_context_menu_action(GTK_BOX(box),
+  append_context_menu_action(box,
                              remove_label,
-                             installed_exact && !self_protected,
+                             writable && installed_exact && !self_protected,
                              G_CALLBACK(+[](GtkButton *button, gpointer user_data) {
                                if (GtkWidget *popover = gtk_widget_get_ancestor(GTK_WIDGET(button), GTK_TYPE_POPOVER)) {
                                  gtk_popover_popdown(GTK_POPOVER(popover));
@@ -118,9 +115,9 @@ package_table_show_context_menu(GtkWidget *anchor,
                              }),
                              widgets);
 
-  append_context_menu_action(GTK_BOX(box),
+  append_context_menu_action(box,
                              reinstall_label,
-                             can_reinstall,
+                             writable && can_reinstall,
                              G_CALLBACK(+[](GtkButton *button, gpointer user_data) {
                                if (GtkWidget *popover = gtk_widget_get_ancestor(GTK_WIDGET(button), GTK_TYPE_POPOVER)) {
                                  gtk_popover_popdown(GTK_POPOVER(popover));
@@ -128,6 +125,84 @@ package_table_show_context_menu(GtkWidget *anchor,
                                pending_transaction_on_reinstall_button_clicked(button, user_data);
                              }),
                              widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Show right-click actions for one package table row.
+// -----------------------------------------------------------------------------
+void
+package_table_show_context_menu(GtkWidget *anchor,
+                                SearchWidgets *widgets,
+                                const PackageRow &row,
+                                double x,
+                                double y,
+                                const std::function<bool(const std::string &)> &select_row)
+{
+  if (!anchor || !widgets) {
+    return;
+  }
+
+  GtkWidget *view = gtk_widget_get_ancestor(anchor, GTK_TYPE_COLUMN_VIEW);
+  if (!view || !GTK_IS_COLUMN_VIEW(view)) {
+    return;
+  }
+
+  if (!select_row(row.nevra)) {
+    return;
+  }
+
+  GtkWidget *popover = gtk_popover_new();
+  gtk_widget_set_parent(popover, anchor);
+  gtk_popover_set_has_arrow(GTK_POPOVER(popover), FALSE);
+
+  GdkRectangle rect = { static_cast<int>(x), static_cast<int>(y), 1, 1 };
+  gtk_popover_set_pointing_to(GTK_POPOVER(popover), &rect);
+
+  GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
+  gtk_popover_set_child(GTK_POPOVER(popover), box);
+
+  // The last-session snapshot is read-only until the live Base replaces it.
+  bool writable = !widgets->query_state.showing_view_snapshot;
+
+  // A right-click inside a larger selection offers the bulk actions instead.
+  // Each one checks every selected row when it runs.
+  const size_t selected_count = package_table_get_selected_count(widgets);
+  if (selected_count > 1) {
+    // The menu only shows these for two or more rows, but languages with
+    // several plural forms still need the count to pick the right one.
+    const std::string install_label = dnfui_i18n_format_count(
+        selected_count, "Mark %zu Selected for Install", "Mark %zu Selected for Install");
+    const std::string remove_label = dnfui_i18n_format_count(
+        selected_count, "Mark %zu Selected for Removal", "Mark %zu Selected for Removal");
+    const std::string reinstall_label = dnfui_i18n_format_count(
+        selected_count, "Mark %zu Selected for Reinstall", "Mark %zu Selected for Reinstall");
+    append_bulk_mark_action(GTK_BOX(box), install_label.c_str(), writable, PendingAction::INSTALL, widgets);
+    append_bulk_mark_action(GTK_BOX(box), remove_label.c_str(), writable, PendingAction::REMOVE, widgets);
+    append_bulk_mark_action(GTK_BOX(box), reinstall_label.c_str(), writable, PendingAction::REINSTALL, widgets);
+  } else {
+    append_single_mark_actions(GTK_BOX(box), widgets, row, writable);
+  }
+
+  // Installed-only rows and local packages name a pseudo repo starting with @,
+  // which has no metadata to download.
+  const std::string &repo_id = row.repo;
+  const bool refreshable = writable && !repo_id.empty() && repo_id.front() != '@';
+  GtkWidget *refresh_button =
+      append_context_menu_action(GTK_BOX(box),
+                                 _("Refresh Repository"),
+                                 refreshable,
+                                 G_CALLBACK(+[](GtkButton *button, gpointer user_data) {
+                                   const char *id =
+                                       static_cast<const char *>(g_object_get_data(G_OBJECT(button), "dnfui-repo-id"));
+                                   const std::string repo = id ? id : "";
+                                   if (GtkWidget *popover =
+                                           gtk_widget_get_ancestor(GTK_WIDGET(button), GTK_TYPE_POPOVER)) {
+                                     gtk_popover_popdown(GTK_POPOVER(popover));
+                                   }
+                                   widgets_refresh_repository(static_cast<SearchWidgets *>(user_data), repo);
+                                 }),
+                                 widgets);
+  g_object_set_data_full(G_OBJECT(refresh_button), "dnfui-repo-id", g_strdup(repo_id.c_str()), g_free);
 
   g_signal_connect(popover,
                    "closed",
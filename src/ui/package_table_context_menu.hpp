@@ -1,7 +1,8 @@
 // -----------------------------------------------------------------------------
 // Package table context menu helpers
 //
-// Owns the right-click transaction menu shown for one package table row.
+// Owns the right-click transaction menu shown for one package table row, or
+// the bulk marking menu when the row is part of a larger selection.
 // -----------------------------------------------------------------------------
 #pragma once
 
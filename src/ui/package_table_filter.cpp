@@ -0,0 +1,121 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_table_filter.cpp
+// Client-side package table filter
+// Text matching runs on a casefolded copy of the name and summary that each
+// item caches the first time a text filter looks at it.
+// -----------------------------------------------------------------------------
+#include "package_table_filter.hpp"
+
+#include <glib.h>
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Return the casefolded copy of text.
+// -----------------------------------------------------------------------------
+std::string
+casefold_copy(const std::string &text)
+{
+  char *folded = g_utf8_casefold(text.c_str(), -1);
+  std::string result = folded ? folded : "";
+  g_free(folded);
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Return the cached casefolded name and summary of one item. The separator
+// keeps computed text non-empty and stops matches across the two fields.
+// -----------------------------------------------------------------------------
+const std::string &
+filter_text(const PackageItem &item)
+{
+  if (item.filter_text.empty()) {
+    item.filter_text = casefold_copy(item.row.name) + "\n" + casefold_copy(item.row.summary);
+  }
+
+  return item.filter_text;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when next keeps prev or restricts a field prev left open.
+// -----------------------------------------------------------------------------
+bool
+field_narrows(const std::string &next, const std::string &prev)
+{
+  return prev.empty() || next == prev;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Build filter criteria from the filter bar values.
+// -----------------------------------------------------------------------------
+PackageTableFilter
+package_table_filter_make(int status_rank, const std::string &repo, const std::string &arch, const std::string &text)
+{
+  PackageTableFilter filter;
+  filter.status_rank = status_rank;
+  filter.repo = repo;
+  filter.arch = arch;
+  filter.text = casefold_copy(text);
+  return filter;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when no field restricts the rows.
+// -----------------------------------------------------------------------------
+bool
+package_table_filter_is_empty(const PackageTableFilter &filter)
+{
+  return filter.status_rank < 0 && filter.repo.empty() && filter.arch.empty() && filter.text.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Check the cheap exact fields first and the text last.
+// -----------------------------------------------------------------------------
+bool
+package_table_filter_matches(const PackageTableFilter &filter, const PackageItem &item)
+{
+  if (filter.status_rank >= 0 && item.status_rank != filter.status_rank) {
+    return false;
+  }
+  if (!filter.repo.empty() && item.row.repo != filter.repo) {
+    return false;
+  }
+  if (!filter.arch.empty() && item.row.arch != filter.arch) {
+    return false;
+  }
+
+  return filter.text.empty() || filter_text(item).find(filter.text) != std::string::npos;
+}
+
+// -----------------------------------------------------------------------------
+// A longer text that contains the previous one can only match fewer rows.
+// -----------------------------------------------------------------------------
+bool
+package_table_filter_narrows(const PackageTableFilter &next, const PackageTableFilter &prev)
+{
+  if (prev.status_rank >= 0 && next.status_rank != prev.status_rank) {
+    return false;
+  }
+
+  return field_narrows(next.repo, prev.repo) && field_narrows(next.arch, prev.arch) &&
+      next.text.find(prev.text) != std::string::npos;
+}
+
+// -----------------------------------------------------------------------------
+// Capture the criteria by value, so the model owns its own copy.
+// -----------------------------------------------------------------------------
+PackageItemFilter
+package_table_filter_predicate(const PackageTableFilter &filter)
+{
+  if (package_table_filter_is_empty(filter)) {
+    return {};
+  }
+
+  return [filter](const PackageItem &item) { return package_table_filter_matches(filter, item); };
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
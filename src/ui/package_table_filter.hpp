@@ -0,0 +1,52 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_table_filter.hpp
+// Client-side package table filter
+//
+// Narrows the rows already loaded into the package table by status, repo, arch,
+// and text without another backend query. The criteria turn into a predicate
+// for the package list model, which keeps the filtered rows stored.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "ui/package_list_model.hpp"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Filter criteria for the package table. Empty fields match every row.
+// -----------------------------------------------------------------------------
+struct PackageTableFilter {
+  // Install state sort rank to keep, or -1 for every status.
+  int status_rank = -1;
+  std::string repo;
+  std::string arch;
+  // Casefolded text matched against package names and summaries.
+  std::string text;
+};
+
+// -----------------------------------------------------------------------------
+// Build filter criteria from the filter bar values. The text is casefolded.
+// -----------------------------------------------------------------------------
+PackageTableFilter
+package_table_filter_make(int status_rank, const std::string &repo, const std::string &arch, const std::string &text);
+// -----------------------------------------------------------------------------
+// Return true when the filter matches every row.
+// -----------------------------------------------------------------------------
+bool package_table_filter_is_empty(const PackageTableFilter &filter);
+// -----------------------------------------------------------------------------
+// Return true when one package item passes the filter.
+// -----------------------------------------------------------------------------
+bool package_table_filter_matches(const PackageTableFilter &filter, const PackageItem &item);
+// -----------------------------------------------------------------------------
+// Return true when next can only hide rows that prev shows, so the model only
+// needs to check its visible rows again.
+// -----------------------------------------------------------------------------
+bool package_table_filter_narrows(const PackageTableFilter &next, const PackageTableFilter &prev);
+// -----------------------------------------------------------------------------
+// Return the model predicate for one filter, or an empty one for no filter.
+// -----------------------------------------------------------------------------
+PackageItemFilter package_table_filter_predicate(const PackageTableFilter &filter);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
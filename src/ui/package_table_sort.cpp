@@ -0,0 +1,101 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_table_sort.cpp
+// Package table column sorting
+// -----------------------------------------------------------------------------
+#include "package_table_sort.hpp"
+
+#include <cstring>
+
+#include <glib.h>
+
+// -----------------------------------------------------------------------------
+// Return the visible text for one package table cell.
+// -----------------------------------------------------------------------------
+std::string
+package_table_column_text(const PackageItem &item, PackageColumnKind kind)
+{
+  switch (kind) {
+  case PackageColumnKind::STATUS:
+    return item.status_text;
+  case PackageColumnKind::PACKAGE:
+    return item.row.name;
+  case PackageColumnKind::VERSION:
+    return item.row.display_version();
+  case PackageColumnKind::ARCH:
+    return item.row.arch;
+  case PackageColumnKind::REPO:
+    return item.row.repo;
+  case PackageColumnKind::SUMMARY:
+    return item.row.summary;
+  }
+
+  return {};
+}
+
+// -----------------------------------------------------------------------------
+// Return the cached collation key for one text column, computing it on first
+// use. Keys are built from the casefolded text, so strcmp on two keys matches
+// a case-insensitive g_utf8_collate of the cell texts.
+// -----------------------------------------------------------------------------
+const std::string &
+package_table_collation_key(const PackageItem &item, PackageColumnKind kind)
+{
+  constexpr size_t kColumnCount = static_cast<size_t>(PackageColumnKind::SUMMARY) + 1;
+  if (item.collation_keys.size() < kColumnCount) {
+    item.collation_keys.resize(kColumnCount);
+  }
+
+  std::string &key = item.collation_keys[static_cast<size_t>(kind)];
+  if (key.empty()) {
+    const std::string text = package_table_column_text(item, kind);
+    char *folded = g_utf8_casefold(text.c_str(), -1);
+    char *collated = g_utf8_collate_key(folded, -1);
+    // The leading byte keeps computed keys non-empty, even for empty text.
+    key = std::string(1, '\x01') + collated;
+    g_free(collated);
+    g_free(folded);
+  }
+
+  return key;
+}
+
+// -----------------------------------------------------------------------------
+// Compare two package items by the cached collation keys of one text column.
+// -----------------------------------------------------------------------------
+static int
+compare_collated(const PackageItem &lhs, const PackageItem &rhs, PackageColumnKind kind)
+{
+  return std::strcmp(package_table_collation_key(lhs, kind).c_str(), package_table_collation_key(rhs, kind).c_str());
+}
+
+// -----------------------------------------------------------------------------
+// Compare two package items for the active package table column. Ties fall
+// back to the package name and then the NEVRA, so the order is stable.
+// -----------------------------------------------------------------------------
+int
+package_table_compare_items(const PackageItem &lhs, const PackageItem &rhs, PackageColumnKind kind)
+{
+  int result = 0;
+  if (kind == PackageColumnKind::STATUS) {
+    result = lhs.status_rank - rhs.status_rank;
+  } else {
+    result = compare_collated(lhs, rhs, kind);
+  }
+
+  if (result != 0) {
+    return result;
+  }
+
+  if (kind != PackageColumnKind::PACKAGE) {
+    result = compare_collated(lhs, rhs, PackageColumnKind::PACKAGE);
+    if (result != 0) {
+      return result;
+    }
+  }
+
+  return lhs.row.nevra.compare(rhs.row.nevra);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_table_sort.hpp
+// Package table column sorting
+//
+// Column text and the comparator behind every package table sort. Text columns
+// compare cached casefolded collation keys, so sorting touches GLib only once
+// per item and column. Nothing here needs GTK, so workers can sort batches and
+// the comparator can be measured on its own.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "ui/package_list_model.hpp"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Package table columns in display order. The values are the column indexes
+// stored in PackageTableSort.
+// -----------------------------------------------------------------------------
+enum class PackageColumnKind {
+  STATUS,
+  PACKAGE,
+  VERSION,
+  ARCH,
+  REPO,
+  SUMMARY,
+};
+
+// -----------------------------------------------------------------------------
+// Return the visible text for one package table cell.
+// -----------------------------------------------------------------------------
+std::string package_table_column_text(const PackageItem &item, PackageColumnKind kind);
+// -----------------------------------------------------------------------------
+// Return the cached collation key for one text column, computing it on first
+// use.
+// -----------------------------------------------------------------------------
+const std::string &package_table_collation_key(const PackageItem &item, PackageColumnKind kind);
+// -----------------------------------------------------------------------------
+// Compare two package items for one column. Ties fall back to the package name
+// and then the NEVRA, so the order is stable.
+// -----------------------------------------------------------------------------
+int package_table_compare_items(const PackageItem &lhs, const PackageItem &rhs, PackageColumnKind kind);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -45,9 +45,8 @@ package_table_status_rank(PackageInstallState state)
 // Build the hover text for one Status cell.
 // -----------------------------------------------------------------------------
 static std::string
-package_table_status_tooltip_text(const PackageRow &row)
+package_table_status_tooltip_text(const PackageRow &row, PackageInstallState state)
 {
-  PackageInstallState state = dnf_backend_get_package_install_state(row);
   if (state == PackageInstallState::AVAILABLE) {
     return {};
   }
@@ -68,17 +67,18 @@ package_table_status_tooltip_text(const PackageRow &row)
 static const char *
 pending_css_class(SearchWidgets *widgets, const std::string &nevra)
 {
-  for (const auto &a : widgets->transaction.actions) {
-    if (a.nevra == nevra) {
-      switch (a.type) {
-      case PendingAction::INSTALL:
-        return "package-status-pending-install";
-      case PendingAction::REINSTALL:
-        return "package-status-pending-reinstall";
-      case PendingAction::REMOVE:
-        return "package-status-pending-remove";
-      }
-    }
+  const PendingAction *a = widgets->transaction.find_action(nevra);
+  if (!a) {
+    return nullptr;
+  }
+
+  switch (a->type) {
+  case PendingAction::INSTALL:
+    return "package-status-pending-install";
+  case PendingAction::REINSTALL:
+    return "package-status-pending-reinstall";
+  case PendingAction::REMOVE:
+    return "package-status-pending-remove";
   }
   return nullptr;
 }
@@ -100,27 +100,26 @@ package_table_clear_status_css(GtkWidget *label)
 }
 
 // -----------------------------------------------------------------------------
-// Apply text, CSS, and tooltip for one Status cell.
+// Apply text, CSS, and tooltip for one Status cell. The state comes from the
+// row's classification, so binding a cell does no backend lookup.
 // -----------------------------------------------------------------------------
 void
-package_table_update_status_label(GtkWidget *label, SearchWidgets *widgets, const PackageRow &row)
+package_table_update_status_label(GtkWidget *label,
+                                  SearchWidgets *widgets,
+                                  const PackageRow &row,
+                                  PackageInstallState install_state)
 {
-  PackageInstallState install_state = dnf_backend_get_package_install_state(row);
-
   const char *text = package_table_status_text(install_state);
-  for (const auto &a : widgets->transaction.actions) {
-    if (a.nevra == row.nevra) {
-      switch (a.type) {
-      case PendingAction::INSTALL:
-        text = _("Pending Install");
-        break;
-      case PendingAction::REINSTALL:
-        text = _("Pending Reinstall");
-        break;
-      case PendingAction::REMOVE:
-        text = _("Pending Removal");
-        break;
-      }
+  if (const PendingAction *a = widgets->transaction.find_action(row.nevra)) {
+    switch (a->type) {
+    case PendingAction::INSTALL:
+      text = _("Pending Install");
+      break;
+    case PendingAction::REINSTALL:
+      text = _("Pending Reinstall");
+      break;
+    case PendingAction::REMOVE:
+      text = _("Pending Removal");
       break;
     }
   }
@@ -144,7 +143,7 @@ package_table_update_status_label(GtkWidget *label, SearchWidgets *widgets, cons
     }
   }
 
-  std::string tooltip = package_table_status_tooltip_text(row);
+  std::string tooltip = package_table_status_tooltip_text(row, install_state);
   gtk_widget_set_tooltip_text(label, tooltip.empty() ? nullptr : tooltip.c_str());
 }
 
@@ -26,9 +26,12 @@ int package_table_status_rank(PackageInstallState state);
 // -----------------------------------------------------------------------------
 void package_table_clear_status_css(GtkWidget *label);
 // -----------------------------------------------------------------------------
-// Update one package status label for the current row state.
+// Update one package status label for a row the caller already classified.
 // -----------------------------------------------------------------------------
-void package_table_update_status_label(GtkWidget *label, SearchWidgets *widgets, const PackageRow &row);
+void package_table_update_status_label(GtkWidget *label,
+                                       SearchWidgets *widgets,
+                                       const PackageRow &row,
+                                       PackageInstallState install_state);
 
 // -----------------------------------------------------------------------------
 // EOF
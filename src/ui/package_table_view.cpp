@@ -1,124 +1,64 @@
 // -----------------------------------------------------------------------------
 // src/ui/package_table_view.cpp
 // Package table view
-// Builds the GTK4 ColumnView, maintains sortable package-row wrappers, and
-// keeps package selection wired into the details notebook controller.
+// Builds the GTK4 ColumnView over the vector-backed package model and keeps
+// package selection wired into the details notebook controller.
 // -----------------------------------------------------------------------------
 #include "ui_helpers.hpp"
 
 #include "i18n.hpp"
 #include "package_info_controller.hpp"
+#include "package_list_model.hpp"
 #include "package_table_context_menu.hpp"
+#include "package_table_filter.hpp"
+#include "package_table_sort.hpp"
 #include "package_table_status.hpp"
 #include "package_table_view.hpp"
 #include "pending_transaction_controller.hpp"
 #include "widgets.hpp"
 
+#include <algorithm>
+#include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 // -----------------------------------------------------------------------------
-// Column model helpers
-// -----------------------------------------------------------------------------
-enum class PackageColumnKind {
-  STATUS,
-  PACKAGE,
-  VERSION,
-  ARCH,
-  REPO,
-  SUMMARY,
-};
-
-// -----------------------------------------------------------------------------
-// Return the private key used to store package rows on GTK objects.
-// -----------------------------------------------------------------------------
-static GQuark
-package_row_quark()
-{
-  static GQuark q = 0;
-  if (G_UNLIKELY(q == 0)) {
-    q = g_quark_from_static_string("package-table-row");
-  }
-
-  return q;
-}
-
-// Package row wrapper used by the sortable GTK model.
-struct PackageItem {
-  PackageRow row;
-  std::string status_text;
-  int status_rank;
-};
-
-// -----------------------------------------------------------------------------
-// Snapshot the visible status text and its sort order for one package row.
+// Store the classification of one package row and the sort rank it implies.
+// Does not touch GTK, so batches prepared on a worker are classified there.
 // -----------------------------------------------------------------------------
 static void
-fill_package_item_status(SearchWidgets *widgets, PackageItem &item)
+set_package_item_classification(PackageItem &item, const PackageRowClassification &classification)
 {
   // Keep Status sorting tied to the stable package state so marking a pending
   // action does not move the row away from the user in the current view.
-  PackageInstallState install_state = dnf_backend_get_package_install_state(item.row);
-  item.status_rank = package_table_status_rank(install_state);
-
-  for (const auto &a : widgets->transaction.actions) {
-    if (a.nevra == item.row.nevra) {
-      switch (a.type) {
-      case PendingAction::INSTALL:
-        item.status_text = _("Pending Install");
-        break;
-      case PendingAction::REINSTALL:
-        item.status_text = _("Pending Reinstall");
-        break;
-      case PendingAction::REMOVE:
-        item.status_text = _("Pending Removal");
-        break;
-      }
-      return;
-    }
-  }
-
-  item.status_text = package_table_status_text(install_state);
-}
-
-// -----------------------------------------------------------------------------
-// Package row object helpers
-// -----------------------------------------------------------------------------
-// Wrap one package row in a GObject so GTK list models can sort and select it.
-// -----------------------------------------------------------------------------
-static GObject *
-make_package_object(SearchWidgets *widgets, const PackageRow &row)
-{
-  GObject *obj = G_OBJECT(g_object_new(G_TYPE_OBJECT, nullptr));
-  auto *item = new PackageItem { row, {}, 0 };
-  fill_package_item_status(widgets, *item);
-  g_object_set_qdata_full(obj, package_row_quark(), item, +[](gpointer p) { delete static_cast<PackageItem *>(p); });
-  return obj;
+  item.classification = classification;
+  item.status_rank = package_table_status_rank(classification.state);
 }
 
 // -----------------------------------------------------------------------------
-// Read the sortable package wrapper stored on a GTK list item.
+// Snapshot the visible status text of one classified package row.
 // -----------------------------------------------------------------------------
-static const PackageItem *
-package_item_from_object(GObject *obj)
-{
-  if (!obj) {
-    return nullptr;
-  }
-
-  return static_cast<const PackageItem *>(g_object_get_qdata(obj, package_row_quark()));
-}
-
-// -----------------------------------------------------------------------------
-// Read the mutable package wrapper stored on a GTK list item.
-// -----------------------------------------------------------------------------
-static PackageItem *
-mutable_package_item_from_object(GObject *obj)
+static void
+fill_package_item_status(SearchWidgets *widgets, PackageItem &item)
 {
-  if (!obj) {
-    return nullptr;
+  if (const PendingAction *a = widgets->transaction.find_action(item.row.nevra)) {
+    switch (a->type) {
+    case PendingAction::INSTALL:
+      item.status_text = _("Pending Install");
+      break;
+    case PendingAction::REINSTALL:
+      item.status_text = _("Pending Reinstall");
+      break;
+    case PendingAction::REMOVE:
+      item.status_text = _("Pending Removal");
+      break;
+    }
+    return;
   }
 
-  return static_cast<PackageItem *>(g_object_get_qdata(obj, package_row_quark()));
+  item.status_text = package_table_status_text(item.classification.state);
 }
 
 // -----------------------------------------------------------------------------
@@ -127,7 +67,7 @@ mutable_package_item_from_object(GObject *obj)
 static const PackageRow *
 package_row_from_object(GObject *obj)
 {
-  const PackageItem *item = package_item_from_object(obj);
+  const PackageItem *item = package_list_model_item_from_object(obj);
   if (!item) {
     return nullptr;
   }
@@ -136,154 +76,90 @@ package_row_from_object(GObject *obj)
 }
 
 // -----------------------------------------------------------------------------
-// Column sorter helpers
-// -----------------------------------------------------------------------------
-// Return the visible text for one package table cell.
-// -----------------------------------------------------------------------------
-static std::string
-column_text(const PackageItem &item, PackageColumnKind kind)
-{
-  switch (kind) {
-  case PackageColumnKind::STATUS:
-    return item.status_text;
-  case PackageColumnKind::PACKAGE:
-    return item.row.name;
-  case PackageColumnKind::VERSION:
-    return item.row.display_version();
-  case PackageColumnKind::ARCH:
-    return item.row.arch;
-  case PackageColumnKind::REPO:
-    return item.row.repo;
-  case PackageColumnKind::SUMMARY:
-    return item.row.summary;
-  }
-
-  return {};
-}
-
-// Per-column data carried by the custom GTK sorter.
-struct ColumnSorterData {
-  PackageColumnKind kind;
-};
-
-// -----------------------------------------------------------------------------
-// Free data owned by one package table column sorter.
-// -----------------------------------------------------------------------------
-static void
-column_sorter_data_free(gpointer p)
-{
-  delete static_cast<ColumnSorterData *>(p);
-}
-
-// -----------------------------------------------------------------------------
-// Compare two strings case-insensitively while keeping a stable fallback order.
+// Return the model compare for one sort, or an empty one while unsorted.
 // -----------------------------------------------------------------------------
-static int
-compare_text(const std::string &lhs, const std::string &rhs)
+static PackageItemCompare
+package_sort_compare(const PackageTableSort &sort)
 {
-  char *lhs_folded = g_utf8_casefold(lhs.c_str(), -1);
-  char *rhs_folded = g_utf8_casefold(rhs.c_str(), -1);
-
-  int result = g_utf8_collate(lhs_folded, rhs_folded);
-  if (result == 0) {
-    result = g_utf8_collate(lhs.c_str(), rhs.c_str());
+  if (sort.column < 0) {
+    return {};
   }
 
-  g_free(lhs_folded);
-  g_free(rhs_folded);
-  return result;
+  PackageColumnKind kind = static_cast<PackageColumnKind>(sort.column);
+  bool descending = sort.descending;
+  return [kind, descending](const PackageItem &lhs, const PackageItem &rhs) {
+    int result = package_table_compare_items(lhs, rhs, kind);
+    return descending ? -result : result;
+  };
 }
 
 // -----------------------------------------------------------------------------
-// Compare two package items for the active package table column.
+// Read the primary sort column and order of the column view sorter.
 // -----------------------------------------------------------------------------
-static int
-compare_package_items(const PackageItem &lhs, const PackageItem &rhs, PackageColumnKind kind)
+static PackageTableSort
+read_view_sort(GtkColumnViewSorter *view_sorter)
 {
-  int result = 0;
-
-  switch (kind) {
-  case PackageColumnKind::STATUS:
-    result = lhs.status_rank - rhs.status_rank;
-    break;
-  case PackageColumnKind::PACKAGE:
-    result = compare_text(lhs.row.name, rhs.row.name);
-    break;
-  case PackageColumnKind::VERSION:
-    result = compare_text(lhs.row.display_version(), rhs.row.display_version());
-    break;
-  case PackageColumnKind::ARCH:
-    result = compare_text(lhs.row.arch, rhs.row.arch);
-    break;
-  case PackageColumnKind::REPO:
-    result = compare_text(lhs.row.repo, rhs.row.repo);
-    break;
-  case PackageColumnKind::SUMMARY:
-    result = compare_text(lhs.row.summary, rhs.row.summary);
-    break;
-  }
-
-  if (result != 0) {
-    return result;
-  }
-
-  result = compare_text(lhs.row.name, rhs.row.name);
-  if (result != 0) {
-    return result;
+  PackageTableSort sort;
+  GtkColumnViewColumn *column = gtk_column_view_sorter_get_primary_sort_column(view_sorter);
+  if (!column) {
+    return sort;
   }
 
-  return compare_text(lhs.row.nevra, rhs.row.nevra);
+  sort.column = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(column), "package-column-kind"));
+  sort.descending = gtk_column_view_sorter_get_primary_sort_order(view_sorter) == GTK_SORT_DESCENDING;
+  return sort;
 }
 
 // -----------------------------------------------------------------------------
-// Adapter from GTK's custom sorter callback to the package item comparator.
+// Sort the package model by the primary column of the column view sorter. The
+// column sorters only mark headers as sortable; the model compares the rows
+// itself, so sorting never needs item objects.
 // -----------------------------------------------------------------------------
-static int
-column_sorter_compare(gconstpointer item1, gconstpointer item2, gpointer user_data)
+static void
+on_package_view_sorter_changed(GtkSorter *sorter, GtkSorterChange, gpointer user_data)
 {
-  const auto *data = static_cast<const ColumnSorterData *>(user_data);
-  const PackageItem *lhs = package_item_from_object(G_OBJECT(const_cast<gpointer>(item1)));
-  const PackageItem *rhs = package_item_from_object(G_OBJECT(const_cast<gpointer>(item2)));
-  if (!data || !lhs || !rhs) {
-    return 0;
-  }
-
-  return compare_package_items(*lhs, *rhs, data->kind);
+  DnfuiPackageListModel *model = DNFUI_PACKAGE_LIST_MODEL(user_data);
+  package_list_model_set_compare(model, package_sort_compare(read_view_sort(GTK_COLUMN_VIEW_SORTER(sorter))));
 }
 
 // -----------------------------------------------------------------------------
-// Refresh stored package status values without changing the GTK model.
+// Refresh the stored status values of the given rows. The model moves rows
+// whose new status changes their sorted position or filter result.
 // -----------------------------------------------------------------------------
 static void
-refresh_model_status_values(GtkColumnView *view, SearchWidgets *widgets)
+refresh_model_status_values(GtkColumnView *view,
+                            SearchWidgets *widgets,
+                            const InstalledPackageSnapshot &installed,
+                            const std::vector<std::string> &nevras)
 {
   GtkSelectionModel *model = gtk_column_view_get_model(view);
-  if (!model || !GTK_IS_SINGLE_SELECTION(model)) {
+  if (!model || !GTK_IS_MULTI_SELECTION(model)) {
     return;
   }
 
-  GtkSingleSelection *selection = GTK_SINGLE_SELECTION(model);
-  GListModel *items_model = gtk_single_selection_get_model(selection);
-  if (!items_model) {
+  GListModel *items_model = gtk_multi_selection_get_model(GTK_MULTI_SELECTION(model));
+  if (!items_model || !DNFUI_IS_PACKAGE_LIST_MODEL(items_model)) {
     return;
   }
 
-  guint n_items = g_list_model_get_n_items(items_model);
-  for (guint i = 0; i < n_items; ++i) {
-    GObject *obj = G_OBJECT(g_list_model_get_item(items_model, i));
-    PackageItem *item = mutable_package_item_from_object(obj);
-    if (item) {
-      fill_package_item_status(widgets, *item);
-    }
-    g_object_unref(obj);
+  for (const auto &nevra : nevras) {
+    package_list_model_update_rows(
+        DNFUI_PACKAGE_LIST_MODEL(items_model), nevra, [widgets, &installed](PackageItem &item) {
+          set_package_item_classification(item, dnf_backend_classify_package_row(installed, item.row));
+          fill_package_item_status(widgets, item);
+        });
   }
 }
 
 // -----------------------------------------------------------------------------
-// Refresh the status cells that are currently realized by the virtualized view.
+// Refresh the realized status cells of the given rows. Only rows in the
+// viewport have cells, so this never walks the whole model.
 // -----------------------------------------------------------------------------
 static void
-refresh_visible_status_labels(GtkWidget *widget, SearchWidgets *widgets)
+refresh_visible_status_labels(GtkWidget *widget,
+                              SearchWidgets *widgets,
+                              const InstalledPackageSnapshot &installed,
+                              const std::unordered_set<std::string> &nevras)
 {
   if (!widget) {
     return;
@@ -291,18 +167,33 @@ refresh_visible_status_labels(GtkWidget *widget, SearchWidgets *widgets)
 
   if (GTK_IS_LABEL(widget) && g_object_get_data(G_OBJECT(widget), "package-status-cell")) {
     PackageRow *row = static_cast<PackageRow *>(g_object_get_data(G_OBJECT(widget), "package-context-row"));
-    if (row) {
-      package_table_update_status_label(widget, widgets, *row);
+    if (row && nevras.contains(row->nevra.str())) {
+      package_table_update_status_label(
+          widget, widgets, *row, dnf_backend_get_package_install_state(installed, *row));
     }
   }
 
   for (GtkWidget *child = gtk_widget_get_first_child(widget); child; child = gtk_widget_get_next_sibling(child)) {
-    refresh_visible_status_labels(child, widgets);
+    refresh_visible_status_labels(child, widgets, installed, nevras);
   }
 }
 
 // -----------------------------------------------------------------------------
-// Select the package row that owns the context menu action.
+// Return the lowest selected position, or GTK_INVALID_LIST_POSITION when no row
+// is selected. The details pane and the single-row actions follow this row.
+// -----------------------------------------------------------------------------
+static guint
+first_selected_position(GtkSelectionModel *model)
+{
+  GtkBitset *selected = gtk_selection_model_get_selection(model);
+  guint position = gtk_bitset_is_empty(selected) ? GTK_INVALID_LIST_POSITION : gtk_bitset_get_minimum(selected);
+  gtk_bitset_unref(selected);
+  return position;
+}
+
+// -----------------------------------------------------------------------------
+// Select the package row that owns the context menu action. A row that is part
+// of a larger selection keeps it, so the menu can act on every selected row.
 // -----------------------------------------------------------------------------
 static bool
 select_package_table_row(GtkColumnView *view, const std::string &nevra)
@@ -312,30 +203,24 @@ select_package_table_row(GtkColumnView *view, const std::string &nevra)
   }
 
   GtkSelectionModel *model = gtk_column_view_get_model(view);
-  if (!model || !GTK_IS_SINGLE_SELECTION(model)) {
+  if (!model || !GTK_IS_MULTI_SELECTION(model)) {
     return false;
   }
 
-  GtkSingleSelection *selection = GTK_SINGLE_SELECTION(model);
-  GListModel *items_model = gtk_single_selection_get_model(selection);
-  if (!items_model) {
+  GListModel *items_model = gtk_multi_selection_get_model(GTK_MULTI_SELECTION(model));
+  if (!items_model || !DNFUI_IS_PACKAGE_LIST_MODEL(items_model)) {
     return false;
   }
 
-  guint n_items = g_list_model_get_n_items(items_model);
-  for (guint i = 0; i < n_items; ++i) {
-    GObject *obj = G_OBJECT(g_list_model_get_item(items_model, i));
-    const PackageRow *row = package_row_from_object(obj);
-    bool match = row && row->nevra == nevra;
-    g_object_unref(obj);
-
-    if (match) {
-      gtk_single_selection_set_selected(selection, i);
-      return true;
-    }
+  guint position = 0;
+  if (!package_list_model_find(DNFUI_PACKAGE_LIST_MODEL(items_model), nevra, position)) {
+    return false;
   }
 
-  return false;
+  if (!gtk_selection_model_is_selected(model, position)) {
+    gtk_selection_model_select_item(model, position, TRUE);
+  }
+  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -416,7 +301,7 @@ create_text_column(SearchWidgets *widgets, const char *title, PackageColumnKind
 
                      GtkWidget *label = gtk_list_item_get_child(item);
                      GObject *obj = G_OBJECT(gtk_list_item_get_item(item));
-                     const PackageItem *package_item = package_item_from_object(obj);
+                     const PackageItem *package_item = package_list_model_item_from_object(obj);
 
                      if (!package_item) {
                        gtk_label_set_text(GTK_LABEL(label), "");
@@ -433,9 +318,10 @@ create_text_column(SearchWidgets *widgets, const char *title, PackageColumnKind
                          });
 
                      if (kind == PackageColumnKind::STATUS) {
-                       package_table_update_status_label(label, widgets, package_item->row);
+                       package_table_update_status_label(
+                           label, widgets, package_item->row, package_item->classification.state);
                      } else {
-                       std::string text = column_text(*package_item, kind);
+                       std::string text = package_table_column_text(*package_item, kind);
                        gtk_label_set_text(GTK_LABEL(label), text.c_str());
                      }
                    }),
@@ -449,8 +335,9 @@ create_text_column(SearchWidgets *widgets, const char *title, PackageColumnKind
   gtk_column_view_column_set_resizable(column, TRUE);
   gtk_column_view_column_set_expand(column, expand);
 
-  GtkSorter *sorter =
-      GTK_SORTER(gtk_custom_sorter_new(column_sorter_compare, new ColumnSorterData { kind }, column_sorter_data_free));
+  // The package model sorts itself from the column view sorter, so this sorter
+  // only makes the header clickable.
+  GtkSorter *sorter = GTK_SORTER(gtk_custom_sorter_new(nullptr, nullptr, nullptr));
   gtk_column_view_column_set_sorter(column, sorter);
   g_object_unref(sorter);
 
@@ -471,10 +358,10 @@ append_package_column(GtkColumnView *view, GtkColumnViewColumn *column)
 }
 
 // -----------------------------------------------------------------------------
-// Read the current primary package table sort before rebuilding the GTK view.
+// Return the first selected package row from the current package table.
 // -----------------------------------------------------------------------------
-static bool
-get_package_view_sort_state(SearchWidgets *widgets, PackageColumnKind &out_kind, GtkSortType &out_order)
+bool
+package_table_get_selected_package_row(SearchWidgets *widgets, PackageRow &out_pkg)
 {
   if (!widgets || !widgets->results.list_scroller) {
     return false;
@@ -485,97 +372,164 @@ get_package_view_sort_state(SearchWidgets *widgets, PackageColumnKind &out_kind,
     return false;
   }
 
-  GtkSorter *sorter = gtk_column_view_get_sorter(GTK_COLUMN_VIEW(child));
-  if (!sorter || !GTK_IS_COLUMN_VIEW_SORTER(sorter)) {
+  GtkSelectionModel *model = gtk_column_view_get_model(GTK_COLUMN_VIEW(child));
+  if (!model || !GTK_IS_MULTI_SELECTION(model)) {
+    return false;
+  }
+
+  guint index = first_selected_position(model);
+  if (index == GTK_INVALID_LIST_POSITION) {
     return false;
   }
 
-  GtkColumnViewColumn *column = gtk_column_view_sorter_get_primary_sort_column(GTK_COLUMN_VIEW_SORTER(sorter));
-  if (!column) {
+  GObject *obj = G_OBJECT(g_list_model_get_item(gtk_multi_selection_get_model(GTK_MULTI_SELECTION(model)), index));
+  if (!obj) {
     return false;
   }
 
-  out_kind =
-      static_cast<PackageColumnKind>(GPOINTER_TO_INT(g_object_get_data(G_OBJECT(column), "package-column-kind")));
-  out_order = gtk_column_view_sorter_get_primary_sort_order(GTK_COLUMN_VIEW_SORTER(sorter));
-  return true;
+  const PackageRow *row = package_row_from_object(obj);
+  bool ok = row != nullptr;
+  if (ok) {
+    out_pkg = *row;
+  }
+
+  g_object_unref(obj);
+  return ok;
 }
 
 // -----------------------------------------------------------------------------
-// Reapply the primary package table sort after rebuilding the GTK view.
+// Return the selection model of the current package table, if any.
 // -----------------------------------------------------------------------------
-static void
-restore_package_view_sort_state(GtkColumnView *view, PackageColumnKind kind, GtkSortType order)
+static GtkMultiSelection *
+current_package_selection(SearchWidgets *widgets)
 {
-  if (!view) {
-    return;
+  if (!widgets || !widgets->results.list_scroller) {
+    return nullptr;
+  }
+
+  GtkWidget *child = gtk_scrolled_window_get_child(widgets->results.list_scroller);
+  if (!child || !GTK_IS_COLUMN_VIEW(child)) {
+    return nullptr;
   }
 
-  GListModel *columns = gtk_column_view_get_columns(view);
-  guint n_columns = g_list_model_get_n_items(columns);
+  GtkSelectionModel *model = gtk_column_view_get_model(GTK_COLUMN_VIEW(child));
+  if (!model || !GTK_IS_MULTI_SELECTION(model)) {
+    return nullptr;
+  }
 
-  for (guint i = 0; i < n_columns; ++i) {
-    GObject *obj = G_OBJECT(g_list_model_get_item(columns, i));
-    GtkColumnViewColumn *column = GTK_COLUMN_VIEW_COLUMN(obj);
-    PackageColumnKind column_kind =
-        static_cast<PackageColumnKind>(GPOINTER_TO_INT(g_object_get_data(G_OBJECT(column), "package-column-kind")));
+  return GTK_MULTI_SELECTION(model);
+}
 
-    if (column_kind == kind) {
-      gtk_column_view_sort_by_column(view, column, order);
-      g_object_unref(obj);
-      return;
-    }
+// -----------------------------------------------------------------------------
+// Copy the selected rows out of the table model in one walk over the selection
+// bitset, in visible order.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+package_table_get_selected_package_rows(SearchWidgets *widgets)
+{
+  std::vector<PackageRow> rows;
+  GtkMultiSelection *sel = current_package_selection(widgets);
+  if (!sel) {
+    return rows;
+  }
 
+  GListModel *items = gtk_multi_selection_get_model(sel);
+  GtkBitset *selected = gtk_selection_model_get_selection(GTK_SELECTION_MODEL(sel));
+  rows.reserve(gtk_bitset_get_size(selected));
+
+  GtkBitsetIter iter;
+  guint position = 0;
+  for (bool valid = gtk_bitset_iter_init_first(&iter, selected, &position); valid;
+       valid = gtk_bitset_iter_next(&iter, &position)) {
+    GObject *obj = G_OBJECT(g_list_model_get_item(items, position));
+    if (!obj) {
+      continue;
+    }
+    if (const PackageRow *row = package_row_from_object(obj)) {
+      rows.push_back(*row);
+    }
     g_object_unref(obj);
   }
+
+  gtk_bitset_unref(selected);
+  return rows;
 }
 
 // -----------------------------------------------------------------------------
-// Return the selected package row from the current package table.
+// Count the selected rows without copying them.
 // -----------------------------------------------------------------------------
-bool
-package_table_get_selected_package_row(SearchWidgets *widgets, PackageRow &out_pkg)
+size_t
+package_table_get_selected_count(SearchWidgets *widgets)
+{
+  GtkMultiSelection *sel = current_package_selection(widgets);
+  if (!sel) {
+    return 0;
+  }
+
+  GtkBitset *selected = gtk_selection_model_get_selection(GTK_SELECTION_MODEL(sel));
+  size_t count = static_cast<size_t>(gtk_bitset_get_size(selected));
+  gtk_bitset_unref(selected);
+  return count;
+}
+
+// -----------------------------------------------------------------------------
+// Walk outwards from the selected row, taking the row below before the row
+// above at each distance.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+package_table_get_neighbor_nevras(SearchWidgets *widgets, guint radius)
 {
+  std::vector<std::string> nevras;
   if (!widgets || !widgets->results.list_scroller) {
-    return false;
+    return nevras;
   }
 
   GtkWidget *child = gtk_scrolled_window_get_child(widgets->results.list_scroller);
   if (!child || !GTK_IS_COLUMN_VIEW(child)) {
-    return false;
+    return nevras;
   }
 
   GtkSelectionModel *model = gtk_column_view_get_model(GTK_COLUMN_VIEW(child));
-  if (!model || !GTK_IS_SINGLE_SELECTION(model)) {
-    return false;
+  if (!model || !GTK_IS_MULTI_SELECTION(model)) {
+    return nevras;
   }
 
-  GtkSingleSelection *sel = GTK_SINGLE_SELECTION(model);
-  guint index = gtk_single_selection_get_selected(sel);
+  guint index = first_selected_position(model);
   if (index == GTK_INVALID_LIST_POSITION) {
-    return false;
+    return nevras;
   }
 
-  GObject *obj = G_OBJECT(g_list_model_get_item(gtk_single_selection_get_model(sel), index));
-  if (!obj) {
-    return false;
-  }
+  GListModel *items = gtk_multi_selection_get_model(GTK_MULTI_SELECTION(model));
+  guint n_items = g_list_model_get_n_items(items);
+  auto add_row = [&](guint position) {
+    GObject *obj = G_OBJECT(g_list_model_get_item(items, position));
+    if (!obj) {
+      return;
+    }
+    if (const PackageRow *row = package_row_from_object(obj)) {
+      nevras.push_back(row->nevra);
+    }
+    g_object_unref(obj);
+  };
 
-  const PackageRow *row = package_row_from_object(obj);
-  bool ok = row != nullptr;
-  if (ok) {
-    out_pkg = *row;
+  for (guint distance = 1; distance <= radius; ++distance) {
+    if (distance < n_items - index) {
+      add_row(index + distance);
+    }
+    if (distance <= index) {
+      add_row(index - distance);
+    }
   }
 
-  g_object_unref(obj);
-  return ok;
+  return nevras;
 }
 
 // -----------------------------------------------------------------------------
-// Refresh package status text and colors without rebuilding the package table.
+// Refresh package status text and colors of the given rows without rebuilding
+// the package table.
 // -----------------------------------------------------------------------------
 void
-package_table_refresh_statuses(SearchWidgets *widgets)
+package_table_refresh_statuses(SearchWidgets *widgets, const std::vector<std::string> &nevras)
 {
   if (!widgets || !widgets->results.list_scroller) {
     return;
@@ -586,31 +540,57 @@ package_table_refresh_statuses(SearchWidgets *widgets)
     return;
   }
 
-  refresh_model_status_values(GTK_COLUMN_VIEW(child), widgets);
-  refresh_visible_status_labels(child, widgets);
+  const InstalledPackageSnapshotPtr installed = dnf_backend_get_installed_snapshot();
+  refresh_model_status_values(GTK_COLUMN_VIEW(child), widgets, *installed, nevras);
+  refresh_visible_status_labels(
+      child, widgets, *installed, std::unordered_set<std::string>(nevras.begin(), nevras.end()));
 }
 
 // -----------------------------------------------------------------------------
-// Package table population
-// Builds a virtualized GTK4 ColumnView with structured package metadata while
-// preserving the selected NEVRA across list refreshes when possible.
+// Package table model state
+// The ColumnView, its columns, the package model, and the selection model are
+// created once. Refreshes update the package model in place, so sort, scroll
+// position, and selection survive a reload.
 // -----------------------------------------------------------------------------
-void
-package_table_fill_package_view(SearchWidgets *widgets, const std::vector<PackageRow> &items)
+constexpr const char *kPackageTableModelKey = "package-table-model";
+
+struct PackageTableModel {
+  // Borrowed from the selection model, which keeps it alive with the view.
+  DnfuiPackageListModel *list = nullptr;
+  gulong selection_handler = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Return the model state of the current package table, if any.
+// -----------------------------------------------------------------------------
+static PackageTableModel *
+current_package_model(SearchWidgets *widgets)
 {
-  widgets->results.current_packages = items;
+  if (!widgets || !widgets->results.list_scroller) {
+    return nullptr;
+  }
 
-  PackageColumnKind sort_kind = PackageColumnKind::STATUS;
-  GtkSortType sort_order = GTK_SORT_ASCENDING;
-  bool have_sort_state = get_package_view_sort_state(widgets, sort_kind, sort_order);
+  GtkWidget *child = gtk_scrolled_window_get_child(widgets->results.list_scroller);
+  if (!child || !GTK_IS_COLUMN_VIEW(child)) {
+    return nullptr;
+  }
 
-  GListStore *store = g_list_store_new(G_TYPE_OBJECT);
-  for (const auto &row : items) {
-    GObject *obj = make_package_object(widgets, row);
-    g_list_store_append(store, obj);
-    g_object_unref(obj);
+  return static_cast<PackageTableModel *>(g_object_get_data(G_OBJECT(child), kPackageTableModelKey));
+}
+
+// -----------------------------------------------------------------------------
+// Build the virtualized GTK4 ColumnView with structured package metadata on
+// first use and return its model state. Later calls reuse the same view.
+// -----------------------------------------------------------------------------
+static PackageTableModel *
+ensure_package_view(SearchWidgets *widgets)
+{
+  if (PackageTableModel *model = current_package_model(widgets)) {
+    return model;
   }
 
+  DnfuiPackageListModel *list = package_list_model_new();
+
   GtkColumnView *view = GTK_COLUMN_VIEW(gtk_column_view_new(nullptr));
   gtk_widget_set_hexpand(GTK_WIDGET(view), TRUE);
   gtk_widget_set_vexpand(GTK_WIDGET(view), TRUE);
@@ -625,60 +605,63 @@ package_table_fill_package_view(SearchWidgets *widgets, const std::vector<Packag
   append_package_column(view, create_text_column(widgets, _("Repo"), PackageColumnKind::REPO, 130, FALSE));
   append_package_column(view, create_text_column(widgets, _("Summary"), PackageColumnKind::SUMMARY, 0, TRUE));
 
-  // Wrap the package list in a GTK sort model so column header clicks reorder it.
-  GtkSortListModel *sort_model = gtk_sort_list_model_new(nullptr, nullptr);
-  gtk_sort_list_model_set_model(sort_model, G_LIST_MODEL(store));
-  gtk_sort_list_model_set_sorter(sort_model, gtk_column_view_get_sorter(view));
-  g_object_unref(store);
-
-  GtkSingleSelection *sel = gtk_single_selection_new(nullptr);
-  gtk_single_selection_set_autoselect(sel, FALSE);
-  gtk_single_selection_set_can_unselect(sel, TRUE);
-  gtk_single_selection_set_model(sel, G_LIST_MODEL(sort_model));
-  gtk_single_selection_set_selected(sel, GTK_INVALID_LIST_POSITION);
-
-  g_signal_connect(sel,
-                   "selection-changed",
-                   G_CALLBACK(+[](GtkSingleSelection *self, guint, guint, gpointer user_data) {
-                     SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
-                     guint index = gtk_single_selection_get_selected(self);
-
-                     if (index == GTK_INVALID_LIST_POSITION) {
-                       package_info_clear_selected_package_state(widgets);
-                       return;
-                     }
+  // Column header clicks reorder the package model's index permutation.
+  g_signal_connect_object(gtk_column_view_get_sorter(view),
+                          "changed",
+                          G_CALLBACK(on_package_view_sorter_changed),
+                          list,
+                          static_cast<GConnectFlags>(0));
+
+  // Ctrl and Shift clicks extend the selection so bulk marking can act on many
+  // rows at once. The details pane shows the first selected row.
+  GtkMultiSelection *sel = gtk_multi_selection_new(nullptr);
+  gtk_multi_selection_set_model(sel, G_LIST_MODEL(list));
+
+  auto *model = new PackageTableModel;
+  model->list = list;
+  model->selection_handler = g_signal_connect(
+      sel,
+      "selection-changed",
+      G_CALLBACK(+[](GtkSelectionModel *self, guint, guint, gpointer user_data) {
+        SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+        guint index = first_selected_position(self);
+
+        if (index == GTK_INVALID_LIST_POSITION) {
+          package_info_clear_selected_package_state(widgets);
+          return;
+        }
 
-                     GObject *obj = G_OBJECT(g_list_model_get_item(gtk_single_selection_get_model(self), index));
-                     const PackageRow *row = package_row_from_object(obj);
-                     if (!row) {
-                       g_object_unref(obj);
-                       package_info_clear_selected_package_state(widgets);
-                       return;
-                     }
+        GObject *obj = G_OBJECT(g_list_model_get_item(gtk_multi_selection_get_model(GTK_MULTI_SELECTION(self)), index));
+        const PackageRow *row = package_row_from_object(obj);
+        if (!row) {
+          g_object_unref(obj);
+          package_info_clear_selected_package_state(widgets);
+          return;
+        }
 
-                     PackageRow selected = *row;
-                     g_object_unref(obj);
-                     package_info_load_selected_package_info(widgets, selected);
-                   }),
-                   widgets);
+        // Growing the selection below the first row keeps the details pane.
+        PackageRow selected = *row;
+        g_object_unref(obj);
+        if (selected.nevra == widgets->results.selected_nevra) {
+          return;
+        }
+        package_info_load_selected_package_info(widgets, selected);
+      }),
+      widgets);
 
   gtk_column_view_set_model(view, GTK_SELECTION_MODEL(sel));
-
-  if (have_sort_state) {
-    restore_package_view_sort_state(view, sort_kind, sort_order);
-  }
+  g_object_unref(list);
 
   g_signal_connect(view,
                    "activate",
                    G_CALLBACK(+[](GtkColumnView *self, guint position, gpointer user_data) {
                      SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
                      GtkSelectionModel *model = gtk_column_view_get_model(self);
-                     if (!model || !GTK_IS_SINGLE_SELECTION(model)) {
+                     if (!model || !GTK_IS_MULTI_SELECTION(model)) {
                        return;
                      }
 
-                     GtkSingleSelection *sel = GTK_SINGLE_SELECTION(model);
-                     GListModel *items_model = gtk_single_selection_get_model(sel);
+                     GListModel *items_model = gtk_multi_selection_get_model(GTK_MULTI_SELECTION(model));
                      if (!items_model) {
                        return;
                      }
@@ -688,16 +671,16 @@ package_table_fill_package_view(SearchWidgets *widgets, const std::vector<Packag
                        return;
                      }
 
-                     const PackageRow *row = package_row_from_object(obj);
-                     if (!row) {
+                     const PackageItem *item = package_list_model_item_from_object(obj);
+                     if (!item) {
                        g_object_unref(obj);
                        return;
                      }
 
                      // Double-click toggles install vs remove based on whether
-                     // this exact row already exists in the installed snapshot.
-                     bool installed_exact = dnf_backend_is_package_installed_exact(*row);
-                     gtk_single_selection_set_selected(sel, position);
+                     // this exact row was installed when the row was classified.
+                     bool installed_exact = item->classification.installed_exact;
+                     gtk_selection_model_select_item(model, position, TRUE);
                      g_object_unref(obj);
 
                      if (installed_exact) {
@@ -708,39 +691,496 @@ package_table_fill_package_view(SearchWidgets *widgets, const std::vector<Packag
                    }),
                    widgets);
 
+  g_object_set_data_full(G_OBJECT(view), kPackageTableModelKey, model, +[](gpointer p) {
+    delete static_cast<PackageTableModel *>(p);
+  });
+
   gtk_scrolled_window_set_child(widgets->results.list_scroller, GTK_WIDGET(view));
   widgets->results.listbox = nullptr;
 
-  // Update count label
-  std::string count_msg = dnfui_i18n_format_count(items.size(), "Item: %zu", "Items: %zu");
+  g_object_unref(sel);
+  return model;
+}
+
+// -----------------------------------------------------------------------------
+// Update the item count label from the package model. A filtered table shows
+// the visible rows next to the loaded ones.
+// -----------------------------------------------------------------------------
+static void
+update_package_count_label(SearchWidgets *widgets)
+{
+  PackageTableModel *model = current_package_model(widgets);
+  if (!model) {
+    return;
+  }
+
+  const guint total = package_list_model_get_counts(model->list).total;
+  const guint shown = g_list_model_get_n_items(G_LIST_MODEL(model->list));
+  std::string count_msg = package_table_filter_is_empty(widgets->results.active_filter)
+      ? dnfui_i18n_format_count(total, "Item: %zu", "Items: %zu")
+      : dnfui_i18n_format(_("Items: %u of %u"), shown, total);
   gtk_label_set_text(widgets->results.count_label, count_msg.c_str());
+}
+
+// -----------------------------------------------------------------------------
+// Package table filter bar
+// The filter narrows the rows already in the package model, so changing it
+// never starts a backend query. Choices show the row counts of the loaded
+// result and are rebuilt after each refresh.
+// -----------------------------------------------------------------------------
+// Status filter choices after "All statuses", in Status column sort order.
+static const PackageInstallState kStatusFilterStates[] = {
+  PackageInstallState::INSTALLED,
+  PackageInstallState::INSTALLED_NEWER_THAN_REPO,
+  PackageInstallState::LOCAL_ONLY,
+  PackageInstallState::UPGRADEABLE,
+  PackageInstallState::AVAILABLE,
+};
 
-  // Restore selection when the same package is still present after a refresh.
-  bool restored = false;
-  if (!widgets->results.selected_nevra.empty()) {
-    GListModel *selected_model = gtk_single_selection_get_model(sel);
-    guint n_items = g_list_model_get_n_items(selected_model);
+// -----------------------------------------------------------------------------
+// Return "label (count)" for one filter choice.
+// -----------------------------------------------------------------------------
+static std::string
+filter_choice_label(const std::string &label, guint count)
+{
+  return dnfui_i18n_format(_("%s (%u)"), label.c_str(), count);
+}
 
-    for (guint i = 0; i < n_items; ++i) {
-      GObject *obj = G_OBJECT(g_list_model_get_item(selected_model, i));
-      const PackageRow *row = package_row_from_object(obj);
-      bool match = row && row->nevra == widgets->results.selected_nevra;
-      g_object_unref(obj);
+// -----------------------------------------------------------------------------
+// Return the count stored for key, or zero when no row has it.
+// -----------------------------------------------------------------------------
+template <typename Key>
+static guint
+count_for(const std::map<Key, guint> &counts, const Key &key)
+{
+  auto it = counts.find(key);
+  return it == counts.end() ? 0 : it->second;
+}
+
+// -----------------------------------------------------------------------------
+// Replace the choices of one filter drop-down and select one of them.
+// -----------------------------------------------------------------------------
+static void
+set_filter_choices(GtkDropDown *dropdown, const std::vector<std::string> &labels, guint selected)
+{
+  std::vector<const char *> strings;
+  strings.reserve(labels.size() + 1);
+  for (const auto &label : labels) {
+    strings.push_back(label.c_str());
+  }
+  strings.push_back(nullptr);
+
+  GListModel *choices = gtk_drop_down_get_model(dropdown);
+  gtk_string_list_splice(GTK_STRING_LIST(choices), 0, g_list_model_get_n_items(choices), strings.data());
+  gtk_drop_down_set_selected(dropdown, selected);
+}
+
+// -----------------------------------------------------------------------------
+// Rebuild the value choices of the repo or arch filter from the row counts.
+// The active value stays listed, even when the loaded rows no longer have it.
+// -----------------------------------------------------------------------------
+static void
+update_value_filter_choices(GtkDropDown *dropdown,
+                            std::vector<std::string> &values,
+                            const std::map<std::string, guint> &counts,
+                            const std::string &active,
+                            const char *all_label,
+                            guint total)
+{
+  values.assign(1, std::string());
+  std::vector<std::string> labels { filter_choice_label(all_label, total) };
+  guint selected = 0;
+  if (!active.empty() && !counts.contains(active)) {
+    selected = static_cast<guint>(values.size());
+    values.push_back(active);
+    labels.push_back(filter_choice_label(active, 0));
+  }
+
+  for (const auto &[value, count] : counts) {
+    if (value == active) {
+      selected = static_cast<guint>(values.size());
+    }
+    values.push_back(value);
+    labels.push_back(filter_choice_label(value, count));
+  }
+
+  set_filter_choices(dropdown, labels, selected);
+}
+
+// -----------------------------------------------------------------------------
+// Rebuild every filter choice from the row counts of the package model.
+// -----------------------------------------------------------------------------
+static void
+update_filter_choices(SearchWidgets *widgets, DnfuiPackageListModel *list)
+{
+  PackageResultsWidgets &results = widgets->results;
+  if (!results.status_filter || !results.repo_filter || !results.arch_filter) {
+    return;
+  }
+
+  const PackageListCounts &counts = package_list_model_get_counts(list);
+  const PackageTableFilter &active = results.active_filter;
+  results.updating_filter_choices = true;
 
-      if (match) {
-        gtk_single_selection_set_selected(sel, i);
-        restored = true;
-        break;
-      }
+  std::vector<std::string> status_labels { filter_choice_label(_("All statuses"), counts.total) };
+  guint status_selected = 0;
+  for (PackageInstallState state : kStatusFilterStates) {
+    const int rank = package_table_status_rank(state);
+    if (rank == active.status_rank) {
+      status_selected = static_cast<guint>(status_labels.size());
     }
+    guint count = count_for(counts.by_status_rank, rank);
+    status_labels.push_back(filter_choice_label(package_table_status_text(state), count));
+  }
+  set_filter_choices(results.status_filter, status_labels, status_selected);
+
+  update_value_filter_choices(results.repo_filter,
+                              results.repo_filter_values,
+                              counts.by_repo,
+                              active.repo,
+                              _("All repositories"),
+                              counts.total);
+  update_value_filter_choices(results.arch_filter,
+                              results.arch_filter_values,
+                              counts.by_arch,
+                              active.arch,
+                              _("All architectures"),
+                              counts.total);
+
+  results.updating_filter_choices = false;
+}
+
+// -----------------------------------------------------------------------------
+// Return the value behind the selected repo or arch choice.
+// -----------------------------------------------------------------------------
+static std::string
+selected_filter_value(GtkDropDown *dropdown, const std::vector<std::string> &values)
+{
+  guint selected = gtk_drop_down_get_selected(dropdown);
+  return selected < values.size() ? values[selected] : std::string();
+}
+
+// -----------------------------------------------------------------------------
+// Read the filter criteria from the filter bar.
+// -----------------------------------------------------------------------------
+static PackageTableFilter
+read_filter_bar(SearchWidgets *widgets)
+{
+  const PackageResultsWidgets &results = widgets->results;
+  guint status_index = gtk_drop_down_get_selected(results.status_filter);
+  int status_rank = -1;
+  if (status_index > 0 && status_index <= G_N_ELEMENTS(kStatusFilterStates)) {
+    status_rank = package_table_status_rank(kStatusFilterStates[status_index - 1]);
+  }
+
+  return package_table_filter_make(status_rank,
+                                   selected_filter_value(results.repo_filter, results.repo_filter_values),
+                                   selected_filter_value(results.arch_filter, results.arch_filter_values),
+                                   gtk_editable_get_text(GTK_EDITABLE(results.text_filter)));
+}
+
+// -----------------------------------------------------------------------------
+// Apply the filter bar to the package model. A filter that only narrows the
+// previous one checks the visible rows alone.
+// -----------------------------------------------------------------------------
+static void
+apply_filter_bar(SearchWidgets *widgets)
+{
+  if (!widgets || widgets->results.updating_filter_choices || !widgets->results.status_filter ||
+      !widgets->results.repo_filter || !widgets->results.arch_filter || !widgets->results.text_filter) {
+    return;
   }
 
-  if (!restored) {
+  PackageTableModel *model = current_package_model(widgets);
+  if (!model) {
+    return;
+  }
+
+  PackageTableFilter next = read_filter_bar(widgets);
+  bool narrows = package_table_filter_narrows(next, widgets->results.active_filter);
+  widgets->results.active_filter = next;
+  package_list_model_set_filter(model->list, package_table_filter_predicate(next), narrows);
+  update_package_count_label(widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Apply the filter after a status, repo, or arch choice changed.
+// -----------------------------------------------------------------------------
+void
+package_table_on_filter_choice_changed(GObject *, GParamSpec *, gpointer user_data)
+{
+  apply_filter_bar(static_cast<SearchWidgets *>(user_data));
+}
+
+// -----------------------------------------------------------------------------
+// Apply the filter after the filter text changed.
+// -----------------------------------------------------------------------------
+void
+package_table_on_filter_text_changed(GtkSearchEntry *, gpointer user_data)
+{
+  apply_filter_bar(static_cast<SearchWidgets *>(user_data));
+}
+
+// -----------------------------------------------------------------------------
+// Package table population
+// Starts one refresh of the package table. Rows are appended in batches, so
+// streamed query results can show up before the whole result has arrived.
+// A plain refresh empties the model right away. A merge keeps the current rows
+// on screen and diffs them against the new result by NEVRA when it finishes.
+// -----------------------------------------------------------------------------
+void
+package_table_begin_package_view(SearchWidgets *widgets, bool merge_existing)
+{
+  PackageTableModel *model = ensure_package_view(widgets);
+  if (merge_existing) {
+    package_list_model_begin_merge(model->list);
+    return;
+  }
+
+  // The finish step restores the selected NEVRA, so emptying the model must
+  // not clear the details pane in between.
+  GtkMultiSelection *sel = current_package_selection(widgets);
+  g_signal_handler_block(sel, model->selection_handler);
+  gtk_selection_model_unselect_all(GTK_SELECTION_MODEL(sel));
+  package_list_model_clear(model->list);
+  g_signal_handler_unblock(sel, model->selection_handler);
+
+  update_package_count_label(widgets);
+  update_filter_choices(widgets, model->list);
+}
+
+// -----------------------------------------------------------------------------
+// Return the active sort of the current package table.
+// -----------------------------------------------------------------------------
+PackageTableSort
+package_table_get_sort(SearchWidgets *widgets)
+{
+  if (!widgets || !widgets->results.list_scroller) {
+    return {};
+  }
+
+  GtkWidget *child = gtk_scrolled_window_get_child(widgets->results.list_scroller);
+  if (!child || !GTK_IS_COLUMN_VIEW(child)) {
+    return {};
+  }
+
+  return read_view_sort(GTK_COLUMN_VIEW_SORTER(gtk_column_view_get_sorter(GTK_COLUMN_VIEW(child))));
+}
+
+// -----------------------------------------------------------------------------
+// Build the package items for one batch without touching GTK or UI state. The
+// whole batch is classified against installed in one call, and the collation
+// keys of the sort column and the package name tie-break are computed here, so
+// the GTK thread only compares cached keys. Status text depends on pending
+// actions and is filled in on the GTK thread. Without a snapshot the rows have
+// no rank yet, so a Status sort leaves the batch in query order.
+// -----------------------------------------------------------------------------
+PackageItemBatch
+package_table_prepare_items(std::vector<PackageRow> rows,
+                            const PackageTableSort &sort,
+                            InstalledPackageSnapshotPtr installed)
+{
+  PackageItemBatch batch;
+  batch.items.reserve(rows.size());
+  if (installed) {
+    std::vector<PackageRowClassification> classifications = dnf_backend_classify_package_rows(*installed, rows);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      PackageItem item { std::move(rows[i]), {}, 0 };
+      set_package_item_classification(item, classifications[i]);
+      batch.items.push_back(std::move(item));
+    }
+  } else {
+    for (auto &row : rows) {
+      batch.items.push_back(PackageItem { std::move(row), {}, 0 });
+    }
+  }
+  batch.installed = std::move(installed);
+
+  PackageColumnKind kind = static_cast<PackageColumnKind>(sort.column);
+  if (sort.column < 0 || (kind == PackageColumnKind::STATUS && !batch.installed)) {
+    return batch;
+  }
+
+  for (const auto &item : batch.items) {
+    // The Status column compares ranks, not text keys.
+    if (kind != PackageColumnKind::STATUS) {
+      package_table_collation_key(item, kind);
+    }
+    package_table_collation_key(item, PackageColumnKind::PACKAGE);
+  }
+
+  PackageItemCompare compare = package_sort_compare(sort);
+  std::stable_sort(
+      batch.items.begin(), batch.items.end(), [&compare](const PackageItem &lhs, const PackageItem &rhs) {
+        return compare(lhs, rhs) < 0;
+      });
+  return batch;
+}
+
+// -----------------------------------------------------------------------------
+// Append rows to the package table started by package_table_begin_package_view.
+// The rows are prepared right here in the active sort order.
+// -----------------------------------------------------------------------------
+void
+package_table_append_package_rows(SearchWidgets *widgets, const std::vector<PackageRow> &rows)
+{
+  PackageTableSort sort = package_table_get_sort(widgets);
+  package_table_append_package_items(widgets,
+                                     package_table_prepare_items(rows, sort, dnf_backend_get_installed_snapshot()));
+}
+
+// -----------------------------------------------------------------------------
+// Fill in the status text of prepared items and hand the batch to the model at
+// once, so GTK sees one change per batch instead of one per row. A batch the
+// worker classified against the published snapshot is not classified again.
+// -----------------------------------------------------------------------------
+void
+package_table_append_package_items(SearchWidgets *widgets, PackageItemBatch batch)
+{
+  PackageTableModel *model = current_package_model(widgets);
+  if (!model || batch.items.empty()) {
+    return;
+  }
+
+  const InstalledPackageSnapshotPtr installed = dnf_backend_get_installed_snapshot();
+  const bool reclassify = batch.installed != installed;
+  for (auto &item : batch.items) {
+    if (reclassify) {
+      set_package_item_classification(item, dnf_backend_classify_package_row(*installed, item.row));
+    }
+    fill_package_item_status(widgets, item);
+  }
+  package_list_model_append(model->list, std::move(batch.items));
+
+  // A merge still shows the old rows, so the count follows once it finishes.
+  if (!package_list_model_is_merging(model->list)) {
+    update_package_count_label(widgets);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Finish the package table after the last batch was appended. Applies a
+// pending merge and restores the selected NEVRA when the package is still
+// present.
+// -----------------------------------------------------------------------------
+void
+package_table_finish_package_view(SearchWidgets *widgets)
+{
+  PackageTableModel *model = current_package_model(widgets);
+  GtkMultiSelection *sel = current_package_selection(widgets);
+  if (!model || !sel) {
+    return;
+  }
+
+  std::string selected_nevra = widgets->results.selected_nevra;
+  if (package_list_model_is_merging(model->list)) {
+    // Removing the selected row must not clear the details pane before the
+    // selection is checked below.
+    g_signal_handler_block(sel, model->selection_handler);
+    package_list_model_finish_merge(model->list);
+    g_signal_handler_unblock(sel, model->selection_handler);
+    update_package_count_label(widgets);
+  }
+  update_filter_choices(widgets, model->list);
+
+  if (selected_nevra.empty()) {
     package_info_clear_selected_package_state(widgets);
+    return;
   }
 
-  g_object_unref(sort_model);
-  g_object_unref(sel);
+  // A merge keeps the selected row object, so the lookup below only runs
+  // after a plain refresh or when the selected row moved or was replaced.
+  guint current = first_selected_position(GTK_SELECTION_MODEL(sel));
+  if (current != GTK_INVALID_LIST_POSITION) {
+    GObject *obj = G_OBJECT(g_list_model_get_item(G_LIST_MODEL(model->list), current));
+    const PackageRow *current_row = obj ? package_row_from_object(obj) : nullptr;
+    const bool unchanged = current_row && current_row->nevra == selected_nevra;
+    if (obj) {
+      g_object_unref(obj);
+    }
+    if (unchanged) {
+      widgets->results.selected_nevra = selected_nevra;
+      return;
+    }
+  }
+
+  // Restore the selected package when it is still present after a refresh. A
+  // refresh keeps only that row of a larger selection. The selection handler
+  // skips the row the details pane already shows, so the stored NEVRA is
+  // cleared first and the details load again for the refreshed row.
+  guint position = 0;
+  if (package_list_model_find(model->list, selected_nevra, position)) {
+    widgets->results.selected_nevra.clear();
+    gtk_selection_model_select_item(GTK_SELECTION_MODEL(sel), position, TRUE);
+    return;
+  }
+
+  package_info_clear_selected_package_state(widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Copy the rows out of the table model. Only the view snapshot needs them, so
+// the table keeps no second copy of every row it shows.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+package_table_get_package_rows(SearchWidgets *widgets)
+{
+  PackageTableModel *model = current_package_model(widgets);
+  if (!model) {
+    return {};
+  }
+
+  return package_list_model_get_rows(model->list);
+}
+
+// -----------------------------------------------------------------------------
+// Replace the package table contents with the provided rows in one step. The
+// rows are merged into the current view, so only rows that differ reach GTK.
+// Rows still queued by an earlier streamed query are dropped instead of being
+// appended to this view.
+// -----------------------------------------------------------------------------
+void
+package_table_fill_package_view(SearchWidgets *widgets, const std::vector<PackageRow> &items)
+{
+  widgets->query_state.streaming_request_id = 0;
+  package_table_begin_package_view(widgets, true);
+  package_table_append_package_rows(widgets, items);
+  package_table_finish_package_view(widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Show rows restored from the last session. The install states come from the
+// snapshot, since the backend installed-package snapshot is not loaded yet at
+// startup. The first live refresh merges over these rows.
+// -----------------------------------------------------------------------------
+void
+package_table_show_restored_rows(SearchWidgets *widgets,
+                                 const std::vector<PackageRow> &rows,
+                                 const std::vector<PackageInstallState> &states)
+{
+  widgets->query_state.streaming_request_id = 0;
+  package_table_begin_package_view(widgets, false);
+  PackageTableModel *model = current_package_model(widgets);
+  if (!model) {
+    return;
+  }
+
+  std::unordered_map<std::string, PackageInstallState> state_by_nevra;
+  for (size_t i = 0; i < rows.size() && i < states.size(); ++i) {
+    state_by_nevra.emplace(rows[i].nevra.str(), states[i]);
+  }
+
+  std::vector<PackageItem> items = package_table_prepare_items(rows, package_table_get_sort(widgets), nullptr).items;
+  for (auto &item : items) {
+    auto it = state_by_nevra.find(item.row.nevra.str());
+    PackageRowClassification classification;
+    classification.state = it == state_by_nevra.end() ? PackageInstallState::AVAILABLE : it->second;
+    set_package_item_classification(item, classification);
+    item.status_text = package_table_status_text(classification.state);
+  }
+  package_list_model_append(model->list, std::move(items));
+  update_package_count_label(widgets);
+  package_table_finish_package_view(widgets);
 }
 
 // -----------------------------------------------------------------------------
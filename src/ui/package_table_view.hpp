@@ -2,29 +2,121 @@
 // src/ui/package_table_view.hpp
 // Public package table view entry points
 //
-// Owns the package table population, current row selection lookup, and visible
-// status refresh used after pending transaction changes.
+// Owns the package table population, including batched appends for streamed
+// query results, NEVRA-keyed merges for reloads, multi-row selection lookup,
+// the client-side filter bar, and visible status refresh used after pending
+// transaction changes.
 // -----------------------------------------------------------------------------
 #pragma once
 
 #include "dnf_backend/dnf_backend.hpp"
+#include "ui/package_list_model.hpp"
 
+#include <cstddef>
+#include <string>
 #include <vector>
 
+#include <gtk/gtk.h>
+
 struct SearchWidgets;
 
 // -----------------------------------------------------------------------------
-// Return the currently selected package row.
+// Primary sort of the package table, captured on the GTK thread so a worker
+// can prepare rows in the same order.
+// -----------------------------------------------------------------------------
+struct PackageTableSort {
+  // Sorted column index, or -1 while the table is unsorted.
+  int column = -1;
+  bool descending = false;
+};
+
+// -----------------------------------------------------------------------------
+// One batch of prepared package items and the installed snapshot they were
+// classified against. installed is nullptr when the items carry no state yet.
+// -----------------------------------------------------------------------------
+struct PackageItemBatch {
+  std::vector<PackageItem> items;
+  InstalledPackageSnapshotPtr installed;
+};
+
+// -----------------------------------------------------------------------------
+// Return the first selected package row, the one the details pane shows.
 // -----------------------------------------------------------------------------
 bool package_table_get_selected_package_row(SearchWidgets *widgets, PackageRow &out_pkg);
 // -----------------------------------------------------------------------------
-// Replace the package table contents with the provided rows.
+// Return every selected package row in the visible order.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow> package_table_get_selected_package_rows(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Return the number of selected package rows.
+// -----------------------------------------------------------------------------
+size_t package_table_get_selected_count(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Return the NEVRAs of up to radius rows on each side of the selected row in
+// the visible order, nearest first.
+// -----------------------------------------------------------------------------
+std::vector<std::string> package_table_get_neighbor_nevras(SearchWidgets *widgets, guint radius);
+// -----------------------------------------------------------------------------
+// Replace the package table contents with the provided rows as one merge.
 // -----------------------------------------------------------------------------
 void package_table_fill_package_view(SearchWidgets *widgets, const std::vector<PackageRow> &items);
 // -----------------------------------------------------------------------------
-// Refresh status values for all visible package rows.
+// Start refreshing the package table. The view, sort, and scroll position are
+// kept. merge_existing leaves the current rows on screen until the finish step
+// diffs them against the appended rows by NEVRA; otherwise the table empties.
+// -----------------------------------------------------------------------------
+void package_table_begin_package_view(SearchWidgets *widgets, bool merge_existing = false);
+// -----------------------------------------------------------------------------
+// Return the active sort of the package table.
+// -----------------------------------------------------------------------------
+PackageTableSort package_table_get_sort(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Build package items for one batch, classified against installed when it is
+// set and pre-sorted by sort with their collation keys cached. The rows move
+// into the items. Does not touch GTK, so worker threads can call it.
+// -----------------------------------------------------------------------------
+PackageItemBatch package_table_prepare_items(std::vector<PackageRow> rows,
+                                             const PackageTableSort &sort,
+                                             InstalledPackageSnapshotPtr installed);
+// -----------------------------------------------------------------------------
+// Append one batch of rows to the package table.
+// -----------------------------------------------------------------------------
+void package_table_append_package_rows(SearchWidgets *widgets, const std::vector<PackageRow> &rows);
+// -----------------------------------------------------------------------------
+// Append one batch built by package_table_prepare_items. Items classified
+// against an older snapshot than the published one are classified again.
+// -----------------------------------------------------------------------------
+void package_table_append_package_items(SearchWidgets *widgets, PackageItemBatch batch);
+// -----------------------------------------------------------------------------
+// Apply a pending merge and restore the selected package after the last batch
+// has been appended.
+// -----------------------------------------------------------------------------
+void package_table_finish_package_view(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Return every row loaded into the package table, including rows the filter bar
+// hides, in the order they were added.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow> package_table_get_package_rows(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Show rows restored from the last-session snapshot with their saved install
+// states instead of the backend ones.
+// -----------------------------------------------------------------------------
+void package_table_show_restored_rows(SearchWidgets *widgets,
+                                      const std::vector<PackageRow> &rows,
+                                      const std::vector<PackageInstallState> &states);
+// -----------------------------------------------------------------------------
+// Refresh status values for the rows of the given NEVRAs, usually the ones
+// whose pending action just changed.
+// -----------------------------------------------------------------------------
+void package_table_refresh_statuses(SearchWidgets *widgets, const std::vector<std::string> &nevras);
+// -----------------------------------------------------------------------------
+// Filter the loaded rows after a status, repo, or arch filter choice changed.
+// -----------------------------------------------------------------------------
+void package_table_on_filter_choice_changed(GObject *, GParamSpec *, gpointer user_data);
+// -----------------------------------------------------------------------------
+// Filter the loaded rows after the filter text changed.
 // -----------------------------------------------------------------------------
-void package_table_refresh_statuses(SearchWidgets *widgets);
+void package_table_on_filter_text_changed(GtkSearchEntry *, gpointer user_data);
 
 // -----------------------------------------------------------------------------
 // EOF
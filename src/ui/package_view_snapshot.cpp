@@ -0,0 +1,317 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_view_snapshot.cpp
+// Last-session package view snapshot
+// The file holds a magic header, the query, the stamps, and one record per row.
+// Integers are little-endian and strings are length-prefixed, so decoding is
+// one pass over the file without any parsing of text fields.
+// -----------------------------------------------------------------------------
+#include "package_view_snapshot.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include <glib.h>
+
+namespace {
+
+// Changing the record layout needs a new magic, so old files are ignored.
+constexpr char kSnapshotMagic[8] = { 'D', 'N', 'F', 'U', 'I', 'V', 'S', '1' };
+
+// -----------------------------------------------------------------------------
+// Return the snapshot file path in the user config directory.
+// -----------------------------------------------------------------------------
+std::filesystem::path
+snapshot_file_path()
+{
+  const char *config_dir = g_get_user_config_dir();
+  if (!config_dir || !*config_dir) {
+    return {};
+  }
+
+  return std::filesystem::path(config_dir) / "dnfui-last-view.bin";
+}
+
+// -----------------------------------------------------------------------------
+// Append one little-endian 32-bit value.
+// -----------------------------------------------------------------------------
+void
+put_u32(std::string &out, uint32_t value)
+{
+  for (int shift = 0; shift < 32; shift += 8) {
+    out.push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Append one length-prefixed string.
+// -----------------------------------------------------------------------------
+void
+put_string(std::string &out, const std::string &value)
+{
+  put_u32(out, static_cast<uint32_t>(value.size()));
+  out += value;
+}
+
+// -----------------------------------------------------------------------------
+// Bounds-checked reader over the encoded snapshot. Every read fails once the
+// data runs out, so a truncated file decodes to an error instead of garbage.
+// -----------------------------------------------------------------------------
+struct SnapshotReader {
+  const std::string &data;
+  size_t pos = 0;
+
+  // -----------------------------------------------------------------------------
+  // Read one little-endian 32-bit value.
+  // -----------------------------------------------------------------------------
+  bool u32(uint32_t &value)
+  {
+    if (data.size() - pos < 4) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+      value |= static_cast<uint32_t>(static_cast<unsigned char>(data[pos + i])) << (8 * i);
+    }
+    pos += 4;
+    return true;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Read one value below limit.
+  // -----------------------------------------------------------------------------
+  bool bounded(uint32_t &value, uint32_t limit)
+  {
+    return u32(value) && value < limit;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Read one length-prefixed string.
+  // -----------------------------------------------------------------------------
+  bool string(std::string &value)
+  {
+    uint32_t size = 0;
+    if (!u32(size) || data.size() - pos < size) {
+      return false;
+    }
+    value.assign(data, pos, size);
+    pos += size;
+    return true;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Read one length-prefixed package string. Fields with few distinct values
+  // share the interned buffers the backend uses for them.
+  // -----------------------------------------------------------------------------
+  bool package_string(PackageString &value, bool intern)
+  {
+    std::string text;
+    if (!string(text)) {
+      return false;
+    }
+    value = intern ? PackageString::interned(text) : PackageString(std::move(text));
+    return true;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Decode one row record.
+// -----------------------------------------------------------------------------
+bool
+read_row(SnapshotReader &reader, PackageRow &row, PackageInstallState &state)
+{
+  uint32_t reason = 0;
+  uint32_t relation = 0;
+  uint32_t install_state = 0;
+  bool ok = reader.package_string(row.nevra, false) && reader.package_string(row.name, false) &&
+      reader.package_string(row.epoch, true) && reader.package_string(row.version, false) &&
+      reader.package_string(row.release, false) && reader.package_string(row.arch, true) &&
+      reader.package_string(row.repo, true) && reader.package_string(row.summary, false) &&
+      reader.bounded(reason, static_cast<uint32_t>(PackageInstallReason::EXTERNAL) + 1) &&
+      reader.bounded(relation, static_cast<uint32_t>(PackageRepoCandidateRelation::OLDER) + 1) &&
+      reader.bounded(install_state, static_cast<uint32_t>(PackageInstallState::INSTALLED_NEWER_THAN_REPO) + 1);
+  if (!ok) {
+    return false;
+  }
+
+  row.install_reason = static_cast<PackageInstallReason>(reason);
+  row.repo_candidate_relation = static_cast<PackageRepoCandidateRelation>(relation);
+  state = static_cast<PackageInstallState>(install_state);
+  return true;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Lay out the header, query, stamps, and rows in that order.
+// -----------------------------------------------------------------------------
+std::string
+package_view_snapshot_encode(const PackageViewSnapshot &snapshot)
+{
+  std::string out(kSnapshotMagic, sizeof kSnapshotMagic);
+
+  const DisplayedPackageQueryState &query = snapshot.query;
+  put_u32(out, static_cast<uint32_t>(query.kind));
+  put_string(out, query.search_term);
+  put_u32(out,
+          (query.search_in_description ? 1u : 0u) | (query.exact_match ? 2u : 0u) | (query.search_in_files ? 4u : 0u));
+
+  put_u32(out, static_cast<uint32_t>(snapshot.stamps.size()));
+  for (const auto &stamp : snapshot.stamps) {
+    put_string(out, stamp);
+  }
+
+  put_u32(out, static_cast<uint32_t>(snapshot.rows.size()));
+  for (size_t i = 0; i < snapshot.rows.size(); ++i) {
+    const PackageRow &row = snapshot.rows[i];
+    put_string(out, row.nevra);
+    put_string(out, row.name);
+    put_string(out, row.epoch);
+    put_string(out, row.version);
+    put_string(out, row.release);
+    put_string(out, row.arch);
+    put_string(out, row.repo);
+    put_string(out, row.summary);
+    put_u32(out, static_cast<uint32_t>(row.install_reason));
+    put_u32(out, static_cast<uint32_t>(row.repo_candidate_relation));
+    PackageInstallState state = i < snapshot.states.size() ? snapshot.states[i] : PackageInstallState::AVAILABLE;
+    put_u32(out, static_cast<uint32_t>(state));
+  }
+
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+// Decode into a local snapshot, so a damaged file leaves out untouched.
+// -----------------------------------------------------------------------------
+bool
+package_view_snapshot_decode(const std::string &data, PackageViewSnapshot &out)
+{
+  if (data.compare(0, sizeof kSnapshotMagic, kSnapshotMagic, sizeof kSnapshotMagic) != 0) {
+    return false;
+  }
+
+  SnapshotReader reader { data, sizeof kSnapshotMagic };
+  PackageViewSnapshot snapshot;
+
+  uint32_t kind = 0;
+  uint32_t flags = 0;
+  if (!reader.bounded(kind, static_cast<uint32_t>(DisplayedPackageQueryKind::LIST_UPGRADEABLE) + 1) ||
+      !reader.string(snapshot.query.search_term) || !reader.u32(flags)) {
+    return false;
+  }
+  snapshot.query.kind = static_cast<DisplayedPackageQueryKind>(kind);
+  snapshot.query.search_in_description = flags & 1u;
+  snapshot.query.exact_match = flags & 2u;
+  snapshot.query.search_in_files = flags & 4u;
+
+  // Each count is checked against the bytes left, so a damaged count cannot
+  // reserve more memory than the file could hold.
+  uint32_t stamp_count = 0;
+  if (!reader.u32(stamp_count) || stamp_count > (data.size() - reader.pos) / 4) {
+    return false;
+  }
+  snapshot.stamps.resize(stamp_count);
+  for (auto &stamp : snapshot.stamps) {
+    if (!reader.string(stamp)) {
+      return false;
+    }
+  }
+
+  uint32_t row_count = 0;
+  if (!reader.u32(row_count) || row_count > (data.size() - reader.pos) / 44) {
+    return false;
+  }
+  snapshot.rows.resize(row_count);
+  snapshot.states.resize(row_count);
+  for (uint32_t i = 0; i < row_count; ++i) {
+    if (!read_row(reader, snapshot.rows[i], snapshot.states[i])) {
+      return false;
+    }
+  }
+
+  if (reader.pos != data.size()) {
+    return false;
+  }
+
+  out = std::move(snapshot);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Read the whole file at once and decode it.
+// -----------------------------------------------------------------------------
+bool
+package_view_snapshot_load(PackageViewSnapshot &out)
+{
+  std::filesystem::path path = snapshot_file_path();
+  if (path.empty()) {
+    return false;
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file.good()) {
+    return false;
+  }
+
+  std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return package_view_snapshot_decode(data, out);
+}
+
+// -----------------------------------------------------------------------------
+// Write a temporary file and rename it over the old one, so a crash while
+// saving never leaves a half-written snapshot behind.
+// -----------------------------------------------------------------------------
+void
+package_view_snapshot_save(const PackageViewSnapshot &snapshot)
+{
+  std::filesystem::path path = snapshot_file_path();
+  if (path.empty()) {
+    return;
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+  std::filesystem::path tmp_path = path;
+  tmp_path += ".tmp";
+
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file.good()) {
+      return;
+    }
+    const std::string data = package_view_snapshot_encode(snapshot);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file.good()) {
+      file.close();
+      std::filesystem::remove(tmp_path, ec);
+      return;
+    }
+  }
+
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_path, ec);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Remove the snapshot file if there is one.
+// -----------------------------------------------------------------------------
+void
+package_view_snapshot_remove()
+{
+  std::filesystem::path path = snapshot_file_path();
+  if (path.empty()) {
+    return;
+  }
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,53 @@
+// -----------------------------------------------------------------------------
+// src/ui/package_view_snapshot.hpp
+// Last-session package view snapshot
+//
+// Saves the query-backed package view shown when the window closed, with its
+// rows and install states, in a compact binary file next to dnfui.conf. The
+// next launch shows it read-only before the Base is loaded, and the live query
+// replaces it once the Base is ready. The stamps tag the system state the rows
+// were valid for.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+#include "ui/package_query_state.hpp"
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// One saved package view. states holds the install state of each row.
+// -----------------------------------------------------------------------------
+struct PackageViewSnapshot {
+  DisplayedPackageQueryState query;
+  std::vector<std::string> stamps;
+  std::vector<PackageRow> rows;
+  std::vector<PackageInstallState> states;
+};
+
+// -----------------------------------------------------------------------------
+// Encode one snapshot into its binary file format.
+// -----------------------------------------------------------------------------
+std::string package_view_snapshot_encode(const PackageViewSnapshot &snapshot);
+// -----------------------------------------------------------------------------
+// Decode one snapshot. Returns false for data of another format version and
+// for truncated or damaged data.
+// -----------------------------------------------------------------------------
+bool package_view_snapshot_decode(const std::string &data, PackageViewSnapshot &out);
+// -----------------------------------------------------------------------------
+// Read the saved snapshot. Returns false when there is none or it is unusable.
+// -----------------------------------------------------------------------------
+bool package_view_snapshot_load(PackageViewSnapshot &out);
+// -----------------------------------------------------------------------------
+// Replace the saved snapshot.
+// -----------------------------------------------------------------------------
+void package_view_snapshot_save(const PackageViewSnapshot &snapshot);
+// -----------------------------------------------------------------------------
+// Remove the saved snapshot, so the next launch starts with an empty table.
+// -----------------------------------------------------------------------------
+void package_view_snapshot_remove();
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
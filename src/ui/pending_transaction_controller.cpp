@@ -6,6 +6,7 @@
 // -----------------------------------------------------------------------------
 #include "widgets.hpp"
 
+#include "base_manager.hpp"
 #include "dnf_backend/dnf_backend.hpp"
 #include "i18n.hpp"
 #include "package_info_controller.hpp"
@@ -13,22 +14,32 @@
 #include "package_table_view.hpp"
 #include "pending_transaction_controller.hpp"
 #include "pending_transaction_request.hpp"
+#include "trace_spans.hpp"
 #include "transaction_progress.hpp"
 #include "transaction_service_client.hpp"
 #include "ui_helpers.hpp"
 #include "widgets_internal.hpp"
 
-// Data passed to the transaction apply worker.
+#include <memory>
+#include <set>
+
+// The background preview starts once the marked actions did not change for
+// this long, so marking several packages in a row resolves only once.
+constexpr guint kSpeculativePreviewDelayMs = 800;
+
+// Data passed to the transaction apply completion.
 struct ApplyTaskData {
   std::string transaction_path;
   TransactionProgressWindow *progress_window;
 };
 
-// Data passed to the transaction preview worker.
+// Data passed to the transaction preview completion.
 struct PreviewTaskData {
   TransactionRequest request;
   TransactionPreview preview;
   std::string transaction_path;
+  // Base generation the preview was started on.
+  uint64_t generation = 0;
 };
 
 // Button payload used to jump from one pending action back to its package row.
@@ -38,6 +49,8 @@ struct PendingJumpButtonData {
 };
 
 static void update_apply_button(SearchWidgets *widgets);
+static void start_apply_transaction(SearchWidgets *widgets);
+static void start_preview_request(SearchWidgets *widgets, TransactionRequest request);
 
 // -----------------------------------------------------------------------------
 // Free data owned by one apply task.
@@ -75,6 +88,67 @@ pending_jump_button_data_free(gpointer p)
   delete d;
 }
 
+// -----------------------------------------------------------------------------
+// Show one line about the dependency impact above the pending actions. Empty
+// text hides the line.
+// -----------------------------------------------------------------------------
+static void
+set_preview_impact_text(SearchWidgets *widgets, const std::string &text)
+{
+  GtkLabel *label = widgets->transaction.preview_impact_label;
+  if (!label) {
+    return;
+  }
+
+  gtk_label_set_text(label, text.c_str());
+  gtk_widget_set_visible(GTK_WIDGET(label), !text.empty());
+}
+
+// -----------------------------------------------------------------------------
+// Describe what a resolved preview changes beyond the marked actions.
+// -----------------------------------------------------------------------------
+static std::string
+preview_impact_text(const PendingTransactionImpact &impact)
+{
+  if (impact.empty()) {
+    return _("No other packages change.");
+  }
+
+  std::string text;
+  if (impact.extra_installs > 0) {
+    text = dnfui_i18n_format_count(impact.extra_installs,
+                                   "Also installs or updates %zu package.",
+                                   "Also installs or updates %zu packages.");
+  }
+  if (impact.extra_removals > 0) {
+    if (!text.empty()) {
+      text += "\n";
+    }
+    text += dnfui_i18n_format_count(impact.extra_removals, "Also removes %zu package.", "Also removes %zu packages.");
+  }
+  return text;
+}
+
+// -----------------------------------------------------------------------------
+// Stop the background preview, whether it still waits for its delay or
+// already runs in the service.
+// -----------------------------------------------------------------------------
+static void
+cancel_speculative_preview(SearchWidgets *widgets)
+{
+  PendingTransactionWidgets &transaction = widgets->transaction;
+  if (transaction.speculative_preview_source_id != 0) {
+    g_source_remove(transaction.speculative_preview_source_id);
+    transaction.speculative_preview_source_id = 0;
+  }
+  if (transaction.speculative_preview_cancellable) {
+    g_cancellable_cancel(transaction.speculative_preview_cancellable);
+    g_object_unref(transaction.speculative_preview_cancellable);
+    transaction.speculative_preview_cancellable = nullptr;
+  }
+  transaction.speculative_preview_awaited = false;
+}
+
 // -----------------------------------------------------------------------------
 // Release any prepared service preview because the pending actions changed.
 // -----------------------------------------------------------------------------
@@ -85,6 +159,7 @@ invalidate_service_preview(SearchWidgets *widgets)
     return;
   }
 
+  cancel_speculative_preview(widgets);
   if (!widgets->transaction.preview_transaction_path.empty()) {
     // Drop the prepared service request when the pending transaction changes or is dismissed.
     transaction_service_client_release_request(widgets->transaction.preview_transaction_path);
@@ -92,6 +167,22 @@ invalidate_service_preview(SearchWidgets *widgets)
 
   widgets->transaction.preview_transaction_path.clear();
   widgets->transaction.preview_upgrade_all = false;
+  widgets->transaction.prepared_preview.reset();
+  widgets->transaction.prepared_preview_generation = 0;
+  set_preview_impact_text(widgets, "");
+}
+
+// -----------------------------------------------------------------------------
+// Keep a prepared preview of the marked actions when the summary is closed
+// without applying, so Review opens it again at once. An upgrade-all preview
+// is not tied to the marked actions and is released.
+// -----------------------------------------------------------------------------
+static void
+on_summary_dismissed(SearchWidgets *widgets)
+{
+  if (widgets && widgets->transaction.preview_upgrade_all) {
+    invalidate_service_preview(widgets);
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -151,6 +242,214 @@ set_preview_request_busy_state(SearchWidgets *widgets, bool busy)
   update_apply_button(widgets);
 }
 
+// -----------------------------------------------------------------------------
+// Show a preview failure in the status bar and in a copyable dialog.
+// -----------------------------------------------------------------------------
+static void
+show_preview_failure(SearchWidgets *widgets, const std::string &message)
+{
+  widgets->transaction.preview_upgrade_all = false;
+  ui_helpers_set_status(widgets->query.status_label, message, "red");
+  transaction_progress_show_error_dialog(widgets,
+                                         _("Transaction Preview Failed"),
+                                         _("The transaction could not be prepared. Review the details below."),
+                                         message);
+}
+
+// -----------------------------------------------------------------------------
+// Open the summary of the prepared preview, or report that nothing changes.
+// -----------------------------------------------------------------------------
+static void
+show_prepared_preview(SearchWidgets *widgets)
+{
+  std::shared_ptr<const TransactionPreview> preview = widgets->transaction.prepared_preview;
+  if (!preview || preview->empty()) {
+    invalidate_service_preview(widgets);
+    ui_helpers_set_status(widgets->query.status_label, _("All packages are already up to date."), "green");
+    return;
+  }
+
+  transaction_progress_show_summary_dialog(widgets, preview, start_apply_transaction, on_summary_dismissed);
+}
+
+// -----------------------------------------------------------------------------
+// Keep the resolved preview of one finished preview task for Review.
+// -----------------------------------------------------------------------------
+static void
+store_prepared_preview(SearchWidgets *widgets, PreviewTaskData &td)
+{
+  widgets->transaction.preview_transaction_path = td.transaction_path;
+  widgets->transaction.preview_upgrade_all = td.request.upgrade_all;
+  widgets->transaction.prepared_preview = std::make_shared<const TransactionPreview>(std::move(td.preview));
+  widgets->transaction.prepared_preview_generation = td.generation;
+}
+
+// -----------------------------------------------------------------------------
+// Return the client callback that completes one preview task. A preview that
+// resolved right before its task was cancelled is released here, since no
+// completion will use it.
+// -----------------------------------------------------------------------------
+static TransactionServicePreviewCallback
+preview_task_done_callback(GTask *task, PreviewTaskData *td, const char *span_name)
+{
+  const uint64_t trace_start_us = trace_spans_now_us();
+  return [task, td, span_name, trace_start_us](bool ok,
+                                               const TransactionPreview &preview,
+                                               const std::string &transaction_path,
+                                               const std::string &error) {
+    trace_spans_record("transaction", span_name, trace_start_us);
+    GCancellable *c = g_task_get_cancellable(task);
+    if (ok && c && g_cancellable_is_cancelled(c)) {
+      transaction_service_client_release_request(transaction_path);
+      g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_CANCELLED, _("Preview cancelled.")));
+    } else if (!ok) {
+      g_task_return_new_error(task,
+                              G_IO_ERROR,
+                              G_IO_ERROR_FAILED,
+                              "%s",
+                              error.empty() ? _("Unable to prepare transaction preview.") : error.c_str());
+    } else {
+      td->preview = preview;
+      td->transaction_path = transaction_path;
+      g_task_return_boolean(task, TRUE);
+    }
+    g_object_unref(task);
+  };
+}
+
+static void schedule_speculative_preview(SearchWidgets *widgets);
+
+// -----------------------------------------------------------------------------
+// Finish the background preview on the GTK thread. Its dependency impact goes
+// to the sidebar, and a Review click that waited for it opens the summary.
+// -----------------------------------------------------------------------------
+static void
+on_speculative_preview_finished(GObject *, GAsyncResult *res, gpointer user_data)
+{
+  GTask *task = G_TASK(res);
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  PreviewTaskData *td = static_cast<PreviewTaskData *>(g_task_get_task_data(task));
+
+  // A change to the marked actions cancelled this preview and started over.
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    return;
+  }
+
+  PendingTransactionWidgets &transaction = widgets->transaction;
+  if (transaction.speculative_preview_cancellable) {
+    g_object_unref(transaction.speculative_preview_cancellable);
+    transaction.speculative_preview_cancellable = nullptr;
+  }
+  const bool awaited = transaction.speculative_preview_awaited;
+  transaction.speculative_preview_awaited = false;
+  if (awaited) {
+    widgets_spinner_release(widgets->query.spinner);
+    set_preview_request_busy_state(widgets, false);
+  }
+
+  GError *error = nullptr;
+  if (!g_task_propagate_boolean(task, &error)) {
+    std::string message = error && error->message ? error->message : _("Unable to prepare transaction preview.");
+    g_clear_error(&error);
+    if (awaited) {
+      show_preview_failure(widgets, message);
+    } else {
+      // Review resolves again and shows the details.
+      set_preview_impact_text(widgets, _("The pending actions could not be resolved."));
+    }
+    return;
+  }
+
+  // A rebuild published new package state meanwhile, so resolve again.
+  if (td->generation != BaseManager::instance().current_generation()) {
+    transaction_service_client_release_request(td->transaction_path);
+    if (awaited) {
+      start_preview_request(widgets, std::move(td->request));
+    } else {
+      schedule_speculative_preview(widgets);
+    }
+    return;
+  }
+
+  store_prepared_preview(widgets, *td);
+  const PendingTransactionImpact impact =
+      pending_transaction_preview_impact(transaction.actions, *transaction.prepared_preview);
+  set_preview_impact_text(widgets, preview_impact_text(impact));
+  if (awaited) {
+    show_prepared_preview(widgets);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Resolve the marked actions in the service while the user keeps working.
+// -----------------------------------------------------------------------------
+static void
+start_speculative_preview(SearchWidgets *widgets)
+{
+  TransactionRequest request;
+  std::string error;
+  pending_transaction_build_request(widgets->transaction.actions, request);
+  if (!pending_transaction_validate_request(request, error)) {
+    // Review reports the error.
+    return;
+  }
+
+  set_preview_impact_text(widgets, _("Resolving dependencies..."));
+
+  PreviewTaskData *td = new PreviewTaskData();
+  td->request = std::move(request);
+  td->generation = BaseManager::instance().current_generation();
+
+  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
+  widgets->transaction.speculative_preview_cancellable = G_CANCELLABLE(g_object_ref(c));
+  GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_speculative_preview_finished);
+  g_task_set_task_data(task, td, preview_task_data_free);
+
+  // The callback owns the task reference. The cancellable also stops the
+  // preview in the service.
+  transaction_service_client_preview_request_async(
+      td->request, preview_task_done_callback(task, td, "speculative preview request"), c);
+
+  g_object_unref(c);
+}
+
+// -----------------------------------------------------------------------------
+// Start the background preview once its delay passed.
+// -----------------------------------------------------------------------------
+static gboolean
+on_speculative_preview_timeout(gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  widgets->transaction.speculative_preview_source_id = 0;
+  start_speculative_preview(widgets);
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Restart the background preview delay for the current marked actions.
+// -----------------------------------------------------------------------------
+static void
+schedule_speculative_preview(SearchWidgets *widgets)
+{
+  cancel_speculative_preview(widgets);
+  if (widgets->transaction.actions.empty() || widgets->transaction.apply_in_progress) {
+    return;
+  }
+
+  widgets->transaction.speculative_preview_source_id =
+      g_timeout_add(kSpeculativePreviewDelayMs, on_speculative_preview_timeout, widgets);
+}
+
+// -----------------------------------------------------------------------------
+// Drop the preview of the old marked actions and resolve the new ones.
+// -----------------------------------------------------------------------------
+static void
+on_pending_actions_changed(SearchWidgets *widgets)
+{
+  invalidate_service_preview(widgets);
+  schedule_speculative_preview(widgets);
+}
+
 // -----------------------------------------------------------------------------
 // Show the selected pending action in the main package list.
 // -----------------------------------------------------------------------------
@@ -271,13 +570,7 @@ refresh_pending_tab(SearchWidgets *widgets)
 static bool
 remove_pending_action(SearchWidgets *widgets, const std::string &nevra)
 {
-  for (size_t i = 0; i < widgets->transaction.actions.size(); ++i) {
-    if (widgets->transaction.actions[i].nevra == nevra) {
-      widgets->transaction.actions.erase(widgets->transaction.actions.begin() + i);
-      return true;
-    }
-  }
-  return false;
+  return widgets->transaction.remove_action(nevra);
 }
 
 // -----------------------------------------------------------------------------
@@ -286,61 +579,13 @@ remove_pending_action(SearchWidgets *widgets, const std::string &nevra)
 static bool
 get_pending_action_type(SearchWidgets *widgets, const std::string &nevra, PendingAction::Type &out_type)
 {
-  for (const auto &a : widgets->transaction.actions) {
-    if (a.nevra == nevra) {
-      out_type = a.type;
-      return true;
-    }
+  const PendingAction *action = widgets->transaction.find_action(nevra);
+  if (!action) {
+    return false;
   }
-  return false;
-}
 
-// -----------------------------------------------------------------------------
-// Finish the post-transaction repository rebuild.
-// -----------------------------------------------------------------------------
-static void
-rebuild_after_tx_finished(GObject *, GAsyncResult *res, gpointer user_data)
-{
-  GTask *task = G_TASK(res);
-  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
-  if (widgets_task_should_skip_completion(task, widgets)) {
-    return;
-  }
-
-  GError *error = nullptr;
-  gboolean ok = g_task_propagate_boolean(task, &error);
-
-  if (!ok && error) {
-    ui_helpers_set_status(widgets->query.status_label, error->message, "red");
-    g_error_free(error);
-    return;
-  }
-
-  // Transaction follow-up rebuilds produce a new Base generation, so any
-  // cached search result rows must be discarded before the next search.
-  package_query_clear_search_cache();
-
-  // Refresh installed state, then repopulate the currently visible package
-  // view so rows removed by the transaction disappear without a manual reload.
-  dnf_backend_refresh_installed_nevras();
-  package_query_reload_current_view(widgets);
-}
-
-// -----------------------------------------------------------------------------
-// Rebuild repository data after a transaction completes.
-// -----------------------------------------------------------------------------
-static void
-rebuild_after_tx_async(SearchWidgets *widgets)
-{
-  // Once the post-transaction rebuild begins, stop serving cached search
-  // results from the pre-transaction Base generation.
-  package_query_clear_search_cache();
-
-  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
-  GTask *task = widgets_task_new_for_search_widgets(widgets, c, rebuild_after_tx_finished);
-  g_task_run_in_thread(task, widgets_on_rebuild_task);
-  g_object_unref(task);
-  g_object_unref(c);
+  out_type = action->type;
+  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -371,6 +616,7 @@ start_apply_transaction(SearchWidgets *widgets)
       : _("Applying pending changes. See transaction window for details.");
   ui_helpers_set_status(widgets->query.status_label, status_message, "blue");
   widgets_spinner_acquire(widgets->query.spinner);
+  widgets->transaction.apply_in_progress = true;
 
   GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
   GTask *task = widgets_task_new_for_search_widgets(
@@ -378,6 +624,9 @@ start_apply_transaction(SearchWidgets *widgets)
         GTask *task = G_TASK(res);
         ApplyTaskData *td = static_cast<ApplyTaskData *>(g_task_get_task_data(task));
         SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+        if (widgets) {
+          widgets->transaction.apply_in_progress = false;
+        }
         if (widgets_task_should_skip_completion(task, widgets)) {
           return;
         }
@@ -393,15 +642,17 @@ start_apply_transaction(SearchWidgets *widgets)
         if (success) {
           invalidate_service_preview(widgets);
           // Clear pending actions and refresh the tab.
-          widgets->transaction.actions.clear();
+          widgets->transaction.clear_actions();
           refresh_pending_tab(widgets);
 
           ui_helpers_set_status(widgets->query.status_label, _("Transaction successful."), "green");
 
           // Rebuild repository data and refresh package state in the background.
-          rebuild_after_tx_async(widgets);
+          package_query_rebuild_after_installed_change(widgets);
         } else {
-          invalidate_service_preview(widgets);
+          // The failed request is used up. The actions are still marked, so
+          // resolve them again in the background.
+          on_pending_actions_changed(widgets);
           std::string details = error ? error->message : _("Transaction failed.");
           ui_helpers_set_status(widgets->query.status_label, details.c_str(), "red");
           // Show the full backend error in a copyable dialog instead of only in the status bar.
@@ -417,22 +668,22 @@ start_apply_transaction(SearchWidgets *widgets)
 
   g_task_set_task_data(task, td, apply_task_data_free);
 
-  g_task_run_in_thread(
-      task, +[](GTask *t, gpointer, gpointer task_data, GCancellable *) {
-        ApplyTaskData *td = static_cast<ApplyTaskData *>(task_data);
-        std::string err;
-        bool ok = transaction_service_client_apply_started_request(
-            td->transaction_path,
-            [td](const std::string &message) { transaction_progress_append(td->progress_window, message); },
-            err);
+  // The client drives the apply from D-Bus replies on this main context, so no
+  // worker thread waits for the service. The callback owns the task reference.
+  const uint64_t trace_start_us = trace_spans_now_us();
+  transaction_service_client_apply_started_request_async(
+      td->transaction_path,
+      [td](const std::string &message) { transaction_progress_append(td->progress_window, message); },
+      [task, trace_start_us](bool ok, const std::string &error) {
+        trace_spans_record("transaction", "apply request", trace_start_us);
         if (ok) {
-          g_task_return_boolean(t, TRUE);
+          g_task_return_boolean(task, TRUE);
         } else {
-          g_task_return_error(t, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, err.c_str()));
+          g_task_return_error(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, error.c_str()));
         }
+        g_object_unref(task);
       });
 
-  g_object_unref(task);
   g_object_unref(c);
 }
 
@@ -461,20 +712,19 @@ pending_transaction_on_install_button_clicked(GtkButton *, gpointer user_data)
   if (has_existing && existing_type == PendingAction::INSTALL) {
     remove_pending_action(widgets, pkg.nevra);
     refresh_pending_tab(widgets);
-    ui_helpers_set_status(widgets->query.status_label, (std::string(_("Unmarked: ")) + pkg.name).c_str(), "gray");
+    ui_helpers_set_status(widgets->query.status_label, (std::string(_("Unmarked: ")) + pkg.name.str()).c_str(), "gray");
   } else {
     // Replace any other pending action with install.
-    remove_pending_action(widgets, pkg.nevra);
-    widgets->transaction.actions.push_back({ PendingAction::INSTALL, pkg.nevra });
+    widgets->transaction.set_action(PendingAction::INSTALL, pkg.nevra);
     refresh_pending_tab(widgets);
     ui_helpers_set_status(
-        widgets->query.status_label, (std::string(_("Marked for install: ")) + pkg.name).c_str(), "blue");
+        widgets->query.status_label, (std::string(_("Marked for install: ")) + pkg.name.str()).c_str(), "blue");
   }
   ui_helpers_update_action_button_labels(widgets, pkg.nevra);
-  invalidate_service_preview(widgets);
+  on_pending_actions_changed(widgets);
 
-  // Refresh status badges without rebuilding the package table.
-  package_table_refresh_statuses(widgets);
+  // Refresh the status badge of this row without rebuilding the package table.
+  package_table_refresh_statuses(widgets, { pkg.nevra });
 }
 
 // -----------------------------------------------------------------------------
@@ -509,20 +759,19 @@ pending_transaction_on_remove_button_clicked(GtkButton *, gpointer user_data)
   if (has_existing && existing_type == PendingAction::REMOVE) {
     remove_pending_action(widgets, pkg.nevra);
     refresh_pending_tab(widgets);
-    ui_helpers_set_status(widgets->query.status_label, (std::string(_("Unmarked: ")) + pkg.name).c_str(), "gray");
+    ui_helpers_set_status(widgets->query.status_label, (std::string(_("Unmarked: ")) + pkg.name.str()).c_str(), "gray");
   } else {
     // Replace any other pending action with remove.
-    remove_pending_action(widgets, pkg.nevra);
-    widgets->transaction.actions.push_back({ PendingAction::REMOVE, pkg.nevra });
+    widgets->transaction.set_action(PendingAction::REMOVE, pkg.nevra);
     refresh_pending_tab(widgets);
     ui_helpers_set_status(
-        widgets->query.status_label, (std::string(_("Marked for removal: ")) + pkg.name).c_str(), "blue");
+        widgets->query.status_label, (std::string(_("Marked for removal: ")) + pkg.name.str()).c_str(), "blue");
   }
   ui_helpers_update_action_button_labels(widgets, pkg.nevra);
-  invalidate_service_preview(widgets);
+  on_pending_actions_changed(widgets);
 
-  // Refresh status badges without rebuilding the package table.
-  package_table_refresh_statuses(widgets);
+  // Refresh the status badge of this row without rebuilding the package table.
+  package_table_refresh_statuses(widgets, { pkg.nevra });
 }
 
 // -----------------------------------------------------------------------------
@@ -555,18 +804,95 @@ pending_transaction_on_reinstall_button_clicked(GtkButton *, gpointer user_data)
   if (has_existing && existing_type == PendingAction::REINSTALL) {
     remove_pending_action(widgets, pkg.nevra);
     refresh_pending_tab(widgets);
-    ui_helpers_set_status(widgets->query.status_label, (std::string(_("Unmarked: ")) + pkg.name).c_str(), "gray");
+    ui_helpers_set_status(widgets->query.status_label, (std::string(_("Unmarked: ")) + pkg.name.str()).c_str(), "gray");
   } else {
-    remove_pending_action(widgets, pkg.nevra);
-    widgets->transaction.actions.push_back({ PendingAction::REINSTALL, pkg.nevra });
+    widgets->transaction.set_action(PendingAction::REINSTALL, pkg.nevra);
     refresh_pending_tab(widgets);
     ui_helpers_set_status(
-        widgets->query.status_label, (std::string(_("Marked for reinstall: ")) + pkg.name).c_str(), "blue");
+        widgets->query.status_label, (std::string(_("Marked for reinstall: ")) + pkg.name.str()).c_str(), "blue");
   }
   ui_helpers_update_action_button_labels(widgets, pkg.nevra);
-  invalidate_service_preview(widgets);
+  on_pending_actions_changed(widgets);
 
-  package_table_refresh_statuses(widgets);
+  package_table_refresh_statuses(widgets, { pkg.nevra });
+}
+
+// -----------------------------------------------------------------------------
+// Return the status text for one bulk marking result.
+// -----------------------------------------------------------------------------
+static std::string
+bulk_mark_status_message(PendingAction::Type type, const PendingBulkMarkResult &result)
+{
+  const size_t marked = result.changed.size();
+  std::string msg;
+  if (marked == 0) {
+    msg = result.unchanged > 0 ? _("The selected packages are already marked.")
+                               : _("The action does not apply to any selected package.");
+  } else {
+    switch (type) {
+    case PendingAction::INSTALL:
+      msg = dnfui_i18n_format_count(marked, "Marked %zu package for install.", "Marked %zu packages for install.");
+      break;
+    case PendingAction::REMOVE:
+      msg = dnfui_i18n_format_count(marked, "Marked %zu package for removal.", "Marked %zu packages for removal.");
+      break;
+    case PendingAction::REINSTALL:
+      msg =
+          dnfui_i18n_format_count(marked, "Marked %zu package for reinstall.", "Marked %zu packages for reinstall.");
+      break;
+    }
+  }
+
+  if (result.skipped > 0) {
+    msg += " " + dnfui_i18n_format_count(result.skipped,
+                                         "Skipped %zu package the action does not apply to.",
+                                         "Skipped %zu packages the action does not apply to.");
+  }
+  if (result.self_protected > 0) {
+    msg += " " + dnfui_i18n_format_count(result.self_protected,
+                                         "Skipped %zu package that owns the running application.",
+                                         "Skipped %zu packages that own the running application.");
+  }
+  return msg;
+}
+
+// -----------------------------------------------------------------------------
+// Mark every selected package for one action. The rows are classified against
+// one installed snapshot, reinstall candidates are looked up in one query, and
+// the pending list and row statuses are refreshed once for the whole batch.
+// -----------------------------------------------------------------------------
+void
+pending_transaction_mark_selected(SearchWidgets *widgets, PendingAction::Type type)
+{
+  if (pending_transaction_preview_is_busy(widgets)) {
+    ui_helpers_set_status(widgets->query.status_label, pending_transaction_preview_busy_message(), "blue");
+    return;
+  }
+
+  std::vector<PackageRow> rows = package_table_get_selected_package_rows(widgets);
+  if (rows.empty()) {
+    ui_helpers_set_status(widgets->query.status_label, _("No package selected."), "gray");
+    return;
+  }
+
+  const InstalledPackageSnapshotPtr installed = dnf_backend_get_installed_snapshot();
+  const std::vector<PackageRowClassification> classifications = dnf_backend_classify_package_rows(*installed, rows);
+  std::set<std::string> reinstallable;
+  if (type == PendingAction::REINSTALL) {
+    reinstallable = dnf_backend_get_reinstallable_nevras(*installed, rows);
+  }
+
+  PendingBulkMarkResult result =
+      pending_transaction_mark_rows(widgets->transaction, type, rows, classifications, reinstallable);
+  if (!result.changed.empty()) {
+    refresh_pending_tab(widgets);
+    ui_helpers_update_action_button_labels(widgets, widgets->results.selected_nevra);
+    on_pending_actions_changed(widgets);
+    package_table_refresh_statuses(widgets, result.changed);
+  }
+
+  ui_helpers_set_status(
+      widgets->query.status_label, bulk_mark_status_message(type, result), result.changed.empty() ? "gray" : "blue");
 }
 
 // -----------------------------------------------------------------------------
@@ -587,12 +913,17 @@ pending_transaction_on_clear_pending_button_clicked(GtkButton *, gpointer user_d
   }
 
   size_t count = widgets->transaction.actions.size();
-  widgets->transaction.actions.clear();
-  invalidate_service_preview(widgets);
+  std::vector<std::string> unmarked;
+  unmarked.reserve(count);
+  for (const auto &action : widgets->transaction.actions) {
+    unmarked.push_back(action.nevra);
+  }
+  widgets->transaction.clear_actions();
+  on_pending_actions_changed(widgets);
   refresh_pending_tab(widgets);
 
-  // Refresh status badges without rebuilding the package table.
-  package_table_refresh_statuses(widgets);
+  // Refresh the unmarked rows without rebuilding the package table.
+  package_table_refresh_statuses(widgets, unmarked);
 
   std::string msg = dnfui_i18n_format_count(count, "Cleared %zu pending action.", "Cleared %zu pending actions.");
   ui_helpers_set_status(widgets->query.status_label, msg, "green");
@@ -612,6 +943,7 @@ start_preview_request(SearchWidgets *widgets, TransactionRequest request)
 
   PreviewTaskData *td = new PreviewTaskData();
   td->request = std::move(request);
+  td->generation = BaseManager::instance().current_generation();
 
   GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
   GTask *task = widgets_task_new_for_search_widgets(
@@ -630,61 +962,36 @@ start_preview_request(SearchWidgets *widgets, TransactionRequest request)
         GError *error = nullptr;
         gboolean success = g_task_propagate_boolean(task, &error);
         if (!success || !td) {
-          const char *status_message =
-              error && error->message ? error->message : _("Unable to prepare transaction preview.");
-          widgets->transaction.preview_upgrade_all = false;
-          ui_helpers_set_status(widgets->query.status_label, status_message, "red");
-          transaction_progress_show_error_dialog(widgets,
-                                                 _("Transaction Preview Failed"),
-                                                 _("The transaction could not be prepared. Review the details below."),
-                                                 status_message);
+          show_preview_failure(widgets,
+                               error && error->message ? error->message : _("Unable to prepare transaction preview."));
           if (error) {
             g_error_free(error);
           }
           return;
         }
 
-        if (td->preview.empty()) {
-          if (!td->transaction_path.empty()) {
-            transaction_service_client_release_request(td->transaction_path);
-          }
-          widgets->transaction.preview_transaction_path.clear();
-          widgets->transaction.preview_upgrade_all = false;
-          ui_helpers_set_status(widgets->query.status_label, _("All packages are already up to date."), "green");
-          return;
+        store_prepared_preview(widgets, *td);
+        if (!td->request.upgrade_all) {
+          set_preview_impact_text(
+              widgets,
+              preview_impact_text(pending_transaction_preview_impact(widgets->transaction.actions,
+                                                                     *widgets->transaction.prepared_preview)));
         }
-
-        widgets->transaction.preview_transaction_path = td->transaction_path;
-        widgets->transaction.preview_upgrade_all = td->request.upgrade_all;
-        transaction_progress_show_summary_dialog(
-            widgets, td->preview, start_apply_transaction, invalidate_service_preview);
+        show_prepared_preview(widgets);
       });
 
   g_task_set_task_data(task, td, preview_task_data_free);
-  g_task_run_in_thread(
-      task, +[](GTask *task, gpointer, gpointer task_data, GCancellable *) {
-        PreviewTaskData *td = static_cast<PreviewTaskData *>(task_data);
-        std::string error;
-        bool ok = false;
-        if (td && td->request.upgrade_all) {
-          ok = transaction_service_client_preview_upgrade_all_request(td->preview, td->transaction_path, error);
-        } else if (td) {
-          ok = transaction_service_client_preview_request(td->request, td->preview, td->transaction_path, error);
-        }
 
-        if (!ok) {
-          g_task_return_new_error(task,
-                                  G_IO_ERROR,
-                                  G_IO_ERROR_FAILED,
-                                  "%s",
-                                  error.empty() ? _("Unable to prepare transaction preview.") : error.c_str());
-          return;
-        }
-
-        g_task_return_boolean(task, TRUE);
-      });
+  // The preview completes from D-Bus replies on this main context. The
+  // callback owns the task reference and fills the task data before returning.
+  if (td->request.upgrade_all) {
+    transaction_service_client_preview_upgrade_all_request_async(
+        preview_task_done_callback(task, td, "preview request"));
+  } else {
+    transaction_service_client_preview_request_async(td->request,
+                                                     preview_task_done_callback(task, td, "preview request"));
+  }
 
-  g_object_unref(task);
   g_object_unref(c);
 }
 
@@ -744,9 +1051,41 @@ pending_transaction_on_apply_button_clicked(GtkButton *, gpointer user_data)
     return;
   }
 
+  // Every change to the marked actions drops the prepared preview, so one that
+  // is still here was resolved for exactly these actions.
+  const PendingTransactionWidgets &transaction = widgets->transaction;
+  if (transaction.prepared_preview && !transaction.preview_upgrade_all &&
+      transaction.prepared_preview_generation == BaseManager::instance().current_generation()) {
+    show_prepared_preview(widgets);
+    return;
+  }
+
+  // Wait for the background preview of these actions instead of resolving
+  // them a second time.
+  if (transaction.speculative_preview_cancellable) {
+    widgets->transaction.speculative_preview_awaited = true;
+    ui_helpers_set_status(widgets->query.status_label, _("Preparing transaction preview..."), "blue");
+    widgets_spinner_acquire(widgets->query.spinner);
+    set_preview_request_busy_state(widgets, true);
+    return;
+  }
+
   start_preview_request(widgets, std::move(request));
 }
 
+// -----------------------------------------------------------------------------
+// Stop the background preview when the window goes away.
+// -----------------------------------------------------------------------------
+void
+pending_transaction_cancel_background_preview(SearchWidgets *widgets)
+{
+  if (!widgets) {
+    return;
+  }
+
+  cancel_speculative_preview(widgets);
+}
+
 // -----------------------------------------------------------------------------
 // EOF
 // -----------------------------------------------------------------------------
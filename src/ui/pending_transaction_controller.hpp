@@ -3,12 +3,17 @@
 // Public pending transaction controller entry points
 //
 // Owns the GTK callbacks for marking packages, clearing pending actions, and
-// applying the prepared transaction through the transaction service.
+// applying the prepared transaction through the transaction service. Marked
+// actions are previewed in the background, so Review usually opens at once.
 // -----------------------------------------------------------------------------
 #pragma once
 
+#include "ui/pending_transaction_state.hpp"
+
 #include <gtk/gtk.h>
 
+struct SearchWidgets;
+
 // -----------------------------------------------------------------------------
 // Mark the selected package for install.
 // -----------------------------------------------------------------------------
@@ -22,6 +27,10 @@ void pending_transaction_on_remove_button_clicked(GtkButton *, gpointer user_dat
 // -----------------------------------------------------------------------------
 void pending_transaction_on_reinstall_button_clicked(GtkButton *, gpointer user_data);
 // -----------------------------------------------------------------------------
+// Mark every selected package the action applies to and skip the others.
+// -----------------------------------------------------------------------------
+void pending_transaction_mark_selected(SearchWidgets *widgets, PendingAction::Type type);
+// -----------------------------------------------------------------------------
 // Start previewing and applying all available package upgrades.
 // -----------------------------------------------------------------------------
 void pending_transaction_on_upgrade_all_button_clicked(GtkButton *, gpointer user_data);
@@ -33,6 +42,11 @@ void pending_transaction_on_apply_button_clicked(GtkButton *, gpointer user_data
 // Clear all pending package actions.
 // -----------------------------------------------------------------------------
 void pending_transaction_on_clear_pending_button_clicked(GtkButton *, gpointer user_data);
+// -----------------------------------------------------------------------------
+// Cancel the background preview of the marked actions. Called when the window
+// is destroyed.
+// -----------------------------------------------------------------------------
+void pending_transaction_cancel_background_preview(SearchWidgets *widgets);
 
 // -----------------------------------------------------------------------------
 // EOF
@@ -9,6 +9,8 @@
 #include "dnf_backend/dnf_backend.hpp"
 #include "i18n.hpp"
 
+#include <unordered_set>
+
 // -----------------------------------------------------------------------------
 // Split the pending queue into install, remove, and reinstall transaction specs.
 // -----------------------------------------------------------------------------
@@ -77,6 +79,88 @@ pending_transaction_validate_request(const TransactionRequest &request, std::str
   return true;
 }
 
+// -----------------------------------------------------------------------------
+// Return true when one classified row may be marked for type. Install stays on
+// repo candidates, remove and reinstall on the exact installed NEVRA.
+// -----------------------------------------------------------------------------
+static bool
+bulk_mark_applies(PendingAction::Type type,
+                  const PackageRow &row,
+                  const PackageRowClassification &classification,
+                  const std::set<std::string> &reinstallable)
+{
+  switch (type) {
+  case PendingAction::INSTALL:
+    return !classification.installed_exact;
+  case PendingAction::REMOVE:
+    return classification.installed_exact;
+  case PendingAction::REINSTALL:
+    return classification.installed_exact && reinstallable.count(row.nevra) > 0;
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Mark the applicable rows in one pass. Rows already marked for type keep their
+// place in the pending list instead of moving to its end.
+// -----------------------------------------------------------------------------
+PendingBulkMarkResult
+pending_transaction_mark_rows(PendingTransactionWidgets &transaction,
+                              PendingAction::Type type,
+                              const std::vector<PackageRow> &rows,
+                              const std::vector<PackageRowClassification> &classifications,
+                              const std::set<std::string> &reinstallable)
+{
+  PendingBulkMarkResult result;
+  for (size_t i = 0; i < rows.size() && i < classifications.size(); ++i) {
+    const PackageRow &row = rows[i];
+    const PackageRowClassification &classification = classifications[i];
+    if (type != PendingAction::INSTALL && classification.installed_exact && classification.self_protected) {
+      result.self_protected++;
+      continue;
+    }
+    if (!bulk_mark_applies(type, row, classification, reinstallable)) {
+      result.skipped++;
+      continue;
+    }
+
+    const PendingAction *existing = transaction.find_action(row.nevra);
+    if (existing && existing->type == type) {
+      result.unchanged++;
+      continue;
+    }
+    transaction.set_action(type, row.nevra);
+    result.changed.push_back(row.nevra);
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Count the dependency changes the solver added to the marked actions.
+// -----------------------------------------------------------------------------
+PendingTransactionImpact
+pending_transaction_preview_impact(const std::vector<PendingAction> &actions, const TransactionPreview &preview)
+{
+  std::unordered_set<std::string> marked;
+  marked.reserve(actions.size());
+  for (const auto &action : actions) {
+    marked.insert(action.nevra);
+  }
+
+  PendingTransactionImpact impact;
+  for (const auto &item : preview.items) {
+    if (marked.contains(item.nevra)) {
+      continue;
+    }
+    if (item.action == TransactionPreviewAction::REMOVE) {
+      impact.extra_removals++;
+    } else {
+      impact.extra_installs++;
+    }
+  }
+  return impact;
+}
+
 // -----------------------------------------------------------------------------
 // EOF
 // -----------------------------------------------------------------------------
@@ -7,12 +7,59 @@
 // -----------------------------------------------------------------------------
 #pragma once
 
+#include "dnf_backend/dnf_backend.hpp"
 #include "pending_transaction_state.hpp"
 #include "transaction_request.hpp"
 
+#include <cstddef>
+#include <set>
 #include <string>
 #include <vector>
 
+struct TransactionPreview;
+
+// -----------------------------------------------------------------------------
+// Packages a resolved preview changes beyond the marked actions.
+// -----------------------------------------------------------------------------
+struct PendingTransactionImpact {
+  // Dependencies installed, upgraded, or downgraded along with the marked actions.
+  size_t extra_installs = 0;
+  // Packages removed along with the marked actions.
+  size_t extra_removals = 0;
+
+  // -----------------------------------------------------------------------------
+  // Return true when the preview changes only the marked packages.
+  // -----------------------------------------------------------------------------
+  bool empty() const
+  {
+    return extra_installs == 0 && extra_removals == 0;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Outcome of marking several package rows for one action at once.
+// -----------------------------------------------------------------------------
+struct PendingBulkMarkResult {
+  // NEVRAs whose pending action changed, in row order.
+  std::vector<std::string> changed;
+  // Rows already marked for this action.
+  size_t unchanged = 0;
+  // Rows the action does not apply to, such as installing an installed NEVRA.
+  size_t skipped = 0;
+  // Installed rows that own the running GUI executable.
+  size_t self_protected = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Mark every row the action applies to, with the same gating as the single-row
+// buttons. classifications holds one entry per row, read from one installed
+// snapshot, and reinstallable the NEVRAs a reinstall may target.
+// -----------------------------------------------------------------------------
+PendingBulkMarkResult pending_transaction_mark_rows(PendingTransactionWidgets &transaction,
+                                                    PendingAction::Type type,
+                                                    const std::vector<PackageRow> &rows,
+                                                    const std::vector<PackageRowClassification> &classifications,
+                                                    const std::set<std::string> &reinstallable);
 // -----------------------------------------------------------------------------
 // Convert pending UI actions into a transaction request.
 // -----------------------------------------------------------------------------
@@ -21,6 +68,11 @@ void pending_transaction_build_request(const std::vector<PendingAction> &actions
 // Reject self-protected remove and reinstall requests before preview.
 // -----------------------------------------------------------------------------
 bool pending_transaction_validate_request(const TransactionRequest &request, std::string &error_out);
+// -----------------------------------------------------------------------------
+// Count the preview items whose NEVRA is not one of the marked actions.
+// -----------------------------------------------------------------------------
+PendingTransactionImpact pending_transaction_preview_impact(const std::vector<PendingAction> &actions,
+                                                            const TransactionPreview &preview);
 
 // -----------------------------------------------------------------------------
 // EOF
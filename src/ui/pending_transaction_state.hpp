@@ -7,11 +7,17 @@
 // -----------------------------------------------------------------------------
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <gtk/gtk.h>
 
+struct TransactionPreview;
+
 // -----------------------------------------------------------------------------
 // Pending actions for mark --> review --> apply workflow
 // -----------------------------------------------------------------------------
@@ -31,10 +37,77 @@ struct PendingTransactionWidgets {
   GtkButton *apply_button = nullptr;
   GtkButton *clear_pending_button = nullptr;
   GtkListBox *pending_list = nullptr;
+  // Dependency impact of the marked actions, shown above pending_list.
+  GtkLabel *preview_impact_label = nullptr;
   bool preview_request_in_progress = false;
+  // Set while the service applies a transaction. The rpmdb changes meanwhile,
+  // and the rebuild after the apply picks up the final state.
+  bool apply_in_progress = false;
   bool preview_upgrade_all = false;
+  // Marked actions in the order the user added them. Change them only through
+  // the helpers below, so action_index stays in sync.
   std::vector<PendingAction> actions;
+  // Position of each marked NEVRA in actions.
+  std::unordered_map<std::string, size_t> action_index;
   std::string preview_transaction_path;
+  // Resolved preview behind preview_transaction_path for the marked actions,
+  // and the Base generation it was resolved on. Review shows it at once.
+  std::shared_ptr<const TransactionPreview> prepared_preview;
+  uint64_t prepared_preview_generation = 0;
+  // Background preview of the marked actions. It starts once they did not
+  // change for a moment, and the next change cancels it.
+  guint speculative_preview_source_id = 0;
+  GCancellable *speculative_preview_cancellable = nullptr;
+  // Set when Review was clicked while the background preview still ran, so
+  // its result opens the summary.
+  bool speculative_preview_awaited = false;
+
+  // -----------------------------------------------------------------------------
+  // Return the pending action for one NEVRA, or nullptr when it is not marked.
+  // -----------------------------------------------------------------------------
+  const PendingAction *find_action(const std::string &nevra) const
+  {
+    auto it = action_index.find(nevra);
+    return it == action_index.end() ? nullptr : &actions[it->second];
+  }
+
+  // -----------------------------------------------------------------------------
+  // Mark one NEVRA, replacing any action it already had.
+  // -----------------------------------------------------------------------------
+  void set_action(PendingAction::Type type, const std::string &nevra)
+  {
+    remove_action(nevra);
+    action_index.emplace(nevra, actions.size());
+    actions.push_back({ type, nevra });
+  }
+
+  // -----------------------------------------------------------------------------
+  // Unmark one NEVRA. Returns false when it had no pending action.
+  // -----------------------------------------------------------------------------
+  bool remove_action(const std::string &nevra)
+  {
+    auto it = action_index.find(nevra);
+    if (it == action_index.end()) {
+      return false;
+    }
+
+    const size_t position = it->second;
+    action_index.erase(it);
+    actions.erase(actions.begin() + static_cast<std::ptrdiff_t>(position));
+    for (size_t i = position; i < actions.size(); ++i) {
+      action_index[actions[i].nevra] = i;
+    }
+    return true;
+  }
+
+  // -----------------------------------------------------------------------------
+  // Unmark every package.
+  // -----------------------------------------------------------------------------
+  void clear_actions()
+  {
+    actions.clear();
+    action_index.clear();
+  }
 };
 
 // -----------------------------------------------------------------------------
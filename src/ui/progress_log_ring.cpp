@@ -0,0 +1,87 @@
+// -----------------------------------------------------------------------------
+// src/ui/progress_log_ring.cpp
+// Bounded ring of progress log lines
+// Slots are reused in place, so a full ring moves strings instead of shifting
+// the stored lines.
+// -----------------------------------------------------------------------------
+#include "progress_log_ring.hpp"
+
+#include <algorithm>
+#include <utility>
+
+// -----------------------------------------------------------------------------
+// Reserve the slots up front.
+// -----------------------------------------------------------------------------
+ProgressLogRing::ProgressLogRing(size_t capacity)
+    : slots(std::max<size_t>(capacity, 1))
+{
+}
+
+// -----------------------------------------------------------------------------
+// Overwrite the oldest slot once every slot is in use.
+// -----------------------------------------------------------------------------
+void
+ProgressLogRing::push(std::string line)
+{
+  slots[head] = std::move(line);
+  head = (head + 1) % slots.size();
+  if (count < slots.size()) {
+    ++count;
+  } else {
+    ++dropped_count;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Return the number of stored lines.
+// -----------------------------------------------------------------------------
+size_t
+ProgressLogRing::size() const
+{
+  return count;
+}
+
+// -----------------------------------------------------------------------------
+// Return the number of lines dropped because the ring was full.
+// -----------------------------------------------------------------------------
+size_t
+ProgressLogRing::dropped() const
+{
+  return dropped_count;
+}
+
+// -----------------------------------------------------------------------------
+// Walk back from the head to the first requested line and copy forward.
+// -----------------------------------------------------------------------------
+std::string
+ProgressLogRing::join_newest(size_t wanted) const
+{
+  wanted = std::min(wanted, count);
+  size_t index = (head + slots.size() - wanted) % slots.size();
+
+  size_t bytes = 0;
+  for (size_t i = 0, at = index; i < wanted; ++i, at = (at + 1) % slots.size()) {
+    bytes += slots[at].size() + 1;
+  }
+
+  std::string text;
+  text.reserve(bytes);
+  for (size_t i = 0; i < wanted; ++i, index = (index + 1) % slots.size()) {
+    text += slots[index];
+    text += '\n';
+  }
+  return text;
+}
+
+// -----------------------------------------------------------------------------
+// Return every stored line, oldest first.
+// -----------------------------------------------------------------------------
+std::string
+ProgressLogRing::join_all() const
+{
+  return join_newest(count);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
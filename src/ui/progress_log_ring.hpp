@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------
+// src/ui/progress_log_ring.hpp
+// Bounded ring of progress log lines
+//
+// Keeps the newest lines of a transaction log in a fixed number of slots, so a
+// long apply cannot grow the log without limit. The oldest lines are dropped
+// once the ring is full, and the drop count is kept for the saved log header.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Newest-lines ring. Not thread safe; the progress window uses it on the GTK
+// thread only.
+// -----------------------------------------------------------------------------
+class ProgressLogRing {
+  public:
+  // -----------------------------------------------------------------------------
+  // Keep at most capacity lines. A zero capacity keeps one line.
+  // -----------------------------------------------------------------------------
+  explicit ProgressLogRing(size_t capacity);
+
+  // -----------------------------------------------------------------------------
+  // Add one line, dropping the oldest one when the ring is full.
+  // -----------------------------------------------------------------------------
+  void push(std::string line);
+  // -----------------------------------------------------------------------------
+  // Return the number of stored lines.
+  // -----------------------------------------------------------------------------
+  size_t size() const;
+  // -----------------------------------------------------------------------------
+  // Return the number of lines dropped because the ring was full.
+  // -----------------------------------------------------------------------------
+  size_t dropped() const;
+  // -----------------------------------------------------------------------------
+  // Return the newest count lines, oldest first, each followed by a newline.
+  // -----------------------------------------------------------------------------
+  std::string join_newest(size_t count) const;
+  // -----------------------------------------------------------------------------
+  // Return every stored line, oldest first, each followed by a newline.
+  // -----------------------------------------------------------------------------
+  std::string join_all() const;
+
+  private:
+  std::vector<std::string> slots;
+  // Slot the next line is written to.
+  size_t head = 0;
+  size_t count = 0;
+  size_t dropped_count = 0;
+};
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,224 @@
+// -----------------------------------------------------------------------------
+// src/ui/search_history.cpp
+// Persisted search history
+// The file starts with a version line, then holds one line per term:
+//   <uses> TAB <flag bits> TAB <term>
+// Terms with tabs or line breaks are never recorded, so no escaping is needed.
+// -----------------------------------------------------------------------------
+#include "search_history.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+
+#include <glib.h>
+
+namespace {
+
+constexpr const char *kHistoryHeader = "dnfui-search-history 1";
+
+constexpr uint32_t kDescriptionFlag = 1u;
+constexpr uint32_t kExactFlag = 2u;
+constexpr uint32_t kFilesFlag = 4u;
+
+// -----------------------------------------------------------------------------
+// Return the history file path in the user config directory.
+// -----------------------------------------------------------------------------
+std::filesystem::path
+history_file_path()
+{
+  const char *config_dir = g_get_user_config_dir();
+  if (!config_dir || !*config_dir) {
+    return {};
+  }
+
+  return std::filesystem::path(config_dir) / "dnfui-search-history";
+}
+
+// -----------------------------------------------------------------------------
+// Parse one unsigned decimal field that must fill text completely.
+// -----------------------------------------------------------------------------
+bool
+parse_u32(std::string_view text, uint32_t &value)
+{
+  auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc() && end == text.data() + text.size() && !text.empty();
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Bump an existing term or append a new one with one use.
+// -----------------------------------------------------------------------------
+bool
+search_history_record_use(std::vector<SearchHistoryEntry> &history,
+                          const std::string &term,
+                          const DnfBackendSearchOptions &options)
+{
+  if (term.empty() || term.find_first_of("\t\r\n") != std::string::npos) {
+    return false;
+  }
+
+  for (auto &entry : history) {
+    if (entry.term == term) {
+      entry.options = options;
+      if (entry.uses < UINT32_MAX) {
+        entry.uses++;
+      }
+      return false;
+    }
+  }
+
+  history.push_back({ term, options, 1 });
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Stable-sort a copy by use count and cut it to count entries.
+// -----------------------------------------------------------------------------
+std::vector<SearchHistoryEntry>
+search_history_most_frequent(const std::vector<SearchHistoryEntry> &history, size_t count)
+{
+  std::vector<SearchHistoryEntry> frequent = history;
+  std::stable_sort(frequent.begin(), frequent.end(), [](const SearchHistoryEntry &a, const SearchHistoryEntry &b) {
+    return a.uses > b.uses;
+  });
+  if (frequent.size() > count) {
+    frequent.resize(count);
+  }
+  return frequent;
+}
+
+// -----------------------------------------------------------------------------
+// Write the header and one line per entry.
+// -----------------------------------------------------------------------------
+std::string
+search_history_encode(const std::vector<SearchHistoryEntry> &history)
+{
+  std::string out = kHistoryHeader;
+  out += '\n';
+  for (const auto &entry : history) {
+    const uint32_t flags = (entry.options.search_in_description ? kDescriptionFlag : 0u) |
+        (entry.options.exact_match ? kExactFlag : 0u) | (entry.options.search_in_files ? kFilesFlag : 0u);
+    out += std::to_string(entry.uses);
+    out += '\t';
+    out += std::to_string(flags);
+    out += '\t';
+    out += entry.term;
+    out += '\n';
+  }
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+// Decode into a local list, so a damaged file leaves out untouched.
+// -----------------------------------------------------------------------------
+bool
+search_history_decode(const std::string &data, std::vector<SearchHistoryEntry> &out)
+{
+  std::string_view rest(data);
+  auto next_line = [&rest]() {
+    const size_t end = rest.find('\n');
+    std::string_view line = rest.substr(0, end);
+    rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+    return line;
+  };
+
+  if (next_line() != kHistoryHeader) {
+    return false;
+  }
+
+  std::vector<SearchHistoryEntry> history;
+  while (!rest.empty()) {
+    const std::string_view line = next_line();
+    const size_t uses_end = line.find('\t');
+    const size_t flags_end = uses_end == std::string_view::npos ? uses_end : line.find('\t', uses_end + 1);
+    if (flags_end == std::string_view::npos) {
+      return false;
+    }
+
+    SearchHistoryEntry entry;
+    uint32_t flags = 0;
+    if (!parse_u32(line.substr(0, uses_end), entry.uses) ||
+        !parse_u32(line.substr(uses_end + 1, flags_end - uses_end - 1), flags) ||
+        flags > (kDescriptionFlag | kExactFlag | kFilesFlag)) {
+      return false;
+    }
+    entry.term = std::string(line.substr(flags_end + 1));
+    if (entry.term.empty()) {
+      return false;
+    }
+    entry.options.search_in_description = flags & kDescriptionFlag;
+    entry.options.exact_match = flags & kExactFlag;
+    entry.options.search_in_files = flags & kFilesFlag;
+    history.push_back(std::move(entry));
+  }
+
+  out = std::move(history);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Read the whole file at once and decode it.
+// -----------------------------------------------------------------------------
+bool
+search_history_load(std::vector<SearchHistoryEntry> &out)
+{
+  std::filesystem::path path = history_file_path();
+  if (path.empty()) {
+    return false;
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file.good()) {
+    return false;
+  }
+
+  std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return search_history_decode(data, out);
+}
+
+// -----------------------------------------------------------------------------
+// Write a temporary file and rename it over the old one, so a crash while
+// saving never leaves a half-written history behind.
+// -----------------------------------------------------------------------------
+void
+search_history_save(const std::vector<SearchHistoryEntry> &history)
+{
+  std::filesystem::path path = history_file_path();
+  if (path.empty()) {
+    return;
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+  std::filesystem::path tmp_path = path;
+  tmp_path += ".tmp";
+
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file.good()) {
+      return;
+    }
+    const std::string data = search_history_encode(history);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file.good()) {
+      file.close();
+      std::filesystem::remove(tmp_path, ec);
+      return;
+    }
+  }
+
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_path, ec);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+// -----------------------------------------------------------------------------
+// src/ui/search_history.hpp
+// Persisted search history
+//
+// Keeps every confirmed search term with the search flags of its latest use
+// and how often it was run, in a small text file next to dnfui.conf. The
+// history panel lists the terms, and the use counts pick the searches that
+// are computed ahead of time after each Base rebuild.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// One history term. options are the flags the term was last searched with.
+// -----------------------------------------------------------------------------
+struct SearchHistoryEntry {
+  std::string term;
+  DnfBackendSearchOptions options;
+  uint32_t uses = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Count one use of term with options. Returns true when term is new to the
+// history and was appended; an existing term keeps its position. Terms holding
+// a tab or a line break are not recorded.
+// -----------------------------------------------------------------------------
+bool search_history_record_use(std::vector<SearchHistoryEntry> &history,
+                               const std::string &term,
+                               const DnfBackendSearchOptions &options);
+// -----------------------------------------------------------------------------
+// Return up to count entries with the most uses, most used first. Entries with
+// the same count keep their history order.
+// -----------------------------------------------------------------------------
+std::vector<SearchHistoryEntry> search_history_most_frequent(const std::vector<SearchHistoryEntry> &history,
+                                                             size_t count);
+// -----------------------------------------------------------------------------
+// Encode the history into its text file format.
+// -----------------------------------------------------------------------------
+std::string search_history_encode(const std::vector<SearchHistoryEntry> &history);
+// -----------------------------------------------------------------------------
+// Decode a history file. Returns false for another format version and for
+// damaged lines, leaving out untouched.
+// -----------------------------------------------------------------------------
+bool search_history_decode(const std::string &data, std::vector<SearchHistoryEntry> &out);
+// -----------------------------------------------------------------------------
+// Read the saved history. Returns false when there is none or it is unusable.
+// -----------------------------------------------------------------------------
+bool search_history_load(std::vector<SearchHistoryEntry> &out);
+// -----------------------------------------------------------------------------
+// Replace the saved history.
+// -----------------------------------------------------------------------------
+void search_history_save(const std::vector<SearchHistoryEntry> &history);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
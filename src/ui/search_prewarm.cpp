@@ -0,0 +1,209 @@
+// -----------------------------------------------------------------------------
+// src/ui/search_prewarm.cpp
+// Frequent search pre-warming
+// Picks the most used history searches on the GTK thread and runs them one at
+// a time on a worker thread, storing each result for the generation the
+// pre-warm was queued for.
+// -----------------------------------------------------------------------------
+#include "search_prewarm.hpp"
+
+#include "base_manager.hpp"
+#include "config.hpp"
+#include "debug_trace.hpp"
+#include "dnf_backend/dnf_backend.hpp"
+#include "package_query_cache.hpp"
+#include "search_history.hpp"
+#include "task_executor.hpp"
+#include "widgets.hpp"
+#include "widgets_internal.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Let the reload that follows a rebuild go first. The pre-warm checks again
+// after this long while a package query still runs.
+constexpr guint kPrewarmDelaySeconds = 3;
+
+// -----------------------------------------------------------------------------
+// One search to compute, with its cache key built on the GTK thread.
+// -----------------------------------------------------------------------------
+struct PrewarmSearch {
+  std::string term;
+  DnfBackendSearchOptions options;
+  std::string key;
+};
+
+// -----------------------------------------------------------------------------
+// Data passed to one background pre-warm task.
+// -----------------------------------------------------------------------------
+struct PrewarmTaskData {
+  uint64_t generation = 0;
+  std::vector<PrewarmSearch> searches;
+};
+
+// -----------------------------------------------------------------------------
+// Return true while the Base generation the task was queued for is current.
+// -----------------------------------------------------------------------------
+bool
+prewarm_still_current(const PrewarmTaskData &td, GCancellable *cancellable)
+{
+  return !g_cancellable_is_cancelled(cancellable) && BaseManager::instance().current_generation() == td.generation;
+}
+
+// -----------------------------------------------------------------------------
+// Run the searches that are not cached yet and store their rows. Returns the
+// number of stored searches through task.
+// -----------------------------------------------------------------------------
+void
+on_prewarm_task(GTask *task, gpointer, gpointer task_data, GCancellable *cancellable)
+{
+  const PrewarmTaskData *td = static_cast<const PrewarmTaskData *>(task_data);
+  gssize stored = 0;
+  try {
+    for (const auto &search : td->searches) {
+      if (!prewarm_still_current(*td, cancellable)) {
+        break;
+      }
+      if (package_query_cache_contains(search.key, td->generation)) {
+        continue;
+      }
+
+      std::vector<PackageRow> rows =
+          dnf_backend_search_package_rows_interruptible(search.term, search.options, cancellable);
+      // A rebuild during the search may have answered it from the new Base.
+      if (!prewarm_still_current(*td, cancellable)) {
+        break;
+      }
+      package_query_cache_store(
+          search.key, td->generation, std::make_shared<const std::vector<PackageRow>>(std::move(rows)));
+      stored++;
+    }
+  } catch (const std::exception &e) {
+    // The next interactive search reports the same error.
+    DNFUI_TRACE("Search pre-warm stopped: %s", e.what());
+  }
+  g_task_return_int(task, stored);
+}
+
+// -----------------------------------------------------------------------------
+// Forget the finished task.
+// -----------------------------------------------------------------------------
+void
+on_prewarm_task_finished(GObject *, GAsyncResult *result, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  GTask *task = G_TASK(result);
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    return;
+  }
+
+  const gssize stored = g_task_propagate_int(task, nullptr);
+
+  if (widgets->query_state.prewarm_cancellable == g_task_get_cancellable(task)) {
+    g_clear_object(&widgets->query_state.prewarm_cancellable);
+  }
+  DNFUI_TRACE("Search pre-warm done stored=%zd", stored);
+}
+
+// -----------------------------------------------------------------------------
+// Start the task with the most used history searches.
+// -----------------------------------------------------------------------------
+void
+start_prewarm_task(SearchWidgets *widgets)
+{
+  const unsigned count = config_load_prewarm_search_count();
+  auto *td = new PrewarmTaskData();
+  td->generation = BaseManager::instance().current_generation();
+  for (const auto &entry : search_history_most_frequent(widgets->query_state.history, count)) {
+    td->searches.push_back({ entry.term, entry.options, package_query_cache_key_for(entry.term, entry.options) });
+  }
+  if (td->searches.empty()) {
+    delete td;
+    return;
+  }
+
+  DNFUI_TRACE("Search pre-warm start generation=%llu searches=%zu",
+              static_cast<unsigned long long>(td->generation),
+              td->searches.size());
+  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
+  widgets->query_state.prewarm_cancellable = G_CANCELLABLE(g_object_ref(c));
+  GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_prewarm_task_finished);
+  g_task_set_task_data(task, td, [](gpointer p) { delete static_cast<PrewarmTaskData *>(p); });
+  ui_task_run_in_thread(task, on_prewarm_task, UiTaskClass::PREFETCH);
+  g_object_unref(task);
+  g_object_unref(c);
+}
+
+// -----------------------------------------------------------------------------
+// Start the pre-warm once no package query holds the controls.
+// -----------------------------------------------------------------------------
+gboolean
+on_prewarm_timeout(gpointer user_data)
+{
+  auto *held = static_cast<std::weak_ptr<SearchWidgets> *>(user_data);
+  std::shared_ptr<SearchWidgets> widgets = held->lock();
+  if (!widgets || widgets->window_state.destroyed) {
+    return G_SOURCE_REMOVE;
+  }
+
+  if (widgets->query_state.current_package_list_request_kind != PackageListRequestKind::NONE) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  widgets->query_state.prewarm_source_id = 0;
+  start_prewarm_task(widgets.get());
+  return G_SOURCE_REMOVE;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Replace any earlier pre-warm, which belongs to an older generation, and
+// queue a new one at low priority.
+// -----------------------------------------------------------------------------
+void
+search_prewarm_schedule(SearchWidgets *widgets)
+{
+  if (!widgets || widgets->window_state.destroyed) {
+    return;
+  }
+
+  search_prewarm_cancel(widgets);
+  if (config_load_prewarm_search_count() == 0 || widgets->query_state.history.empty()) {
+    return;
+  }
+
+  widgets->query_state.prewarm_source_id =
+      g_timeout_add_seconds_full(G_PRIORITY_LOW,
+                                 kPrewarmDelaySeconds,
+                                 on_prewarm_timeout,
+                                 new std::weak_ptr<SearchWidgets>(widgets->weak_from_this()),
+                                 [](gpointer p) { delete static_cast<std::weak_ptr<SearchWidgets> *>(p); });
+}
+
+// -----------------------------------------------------------------------------
+// Remove the queued timeout and cancel the running task.
+// -----------------------------------------------------------------------------
+void
+search_prewarm_cancel(SearchWidgets *widgets)
+{
+  if (!widgets) {
+    return;
+  }
+
+  if (widgets->query_state.prewarm_source_id) {
+    g_source_remove(widgets->query_state.prewarm_source_id);
+    widgets->query_state.prewarm_source_id = 0;
+  }
+  if (widgets->query_state.prewarm_cancellable) {
+    g_cancellable_cancel(widgets->query_state.prewarm_cancellable);
+    g_clear_object(&widgets->query_state.prewarm_cancellable);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,27 @@
+// -----------------------------------------------------------------------------
+// src/ui/search_prewarm.hpp
+// Frequent search pre-warming
+//
+// After the startup warm up and after each Base rebuild, runs the most used
+// history searches in one background task and stores their rows in the search
+// cache, so the searches people repeat are cache hits. The task waits until no
+// package query runs and stops as soon as the Base generation moves on.
+// -----------------------------------------------------------------------------
+#pragma once
+
+struct SearchWidgets;
+
+// -----------------------------------------------------------------------------
+// Queue a pre-warm for the current Base generation. A queued or running
+// pre-warm is replaced. Does nothing when prewarm_searches is 0 in the config
+// file.
+// -----------------------------------------------------------------------------
+void search_prewarm_schedule(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Drop the queued pre-warm and cancel a running one.
+// -----------------------------------------------------------------------------
+void search_prewarm_cancel(SearchWidgets *widgets);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,308 @@
+// -----------------------------------------------------------------------------
+// src/ui/task_executor.cpp
+// Prioritized worker threads for UI background tasks
+// Each class has its own FIFO queue. A free worker takes the oldest task of the
+// highest class whose slot limit still has room, and the limits only shrink
+// toward the lower classes, so a waiting task never lets a lower one pass it.
+// -----------------------------------------------------------------------------
+#include "task_executor.hpp"
+
+#include "debug_trace.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// Enough for a details load, a query, and two tasks nobody waits on, without
+// competing with the backend scan threads for every core.
+constexpr size_t kUiWorkerCount = 4;
+
+// -----------------------------------------------------------------------------
+// Workers each class leaves free for the classes above it.
+// -----------------------------------------------------------------------------
+size_t
+reserved_workers_for(UiTaskClass task_class)
+{
+  switch (task_class) {
+  case UiTaskClass::DETAILS:
+    return 0;
+  case UiTaskClass::QUERY:
+    return 1;
+  case UiTaskClass::PREFETCH:
+  case UiTaskClass::REFRESH:
+    return 2;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Only prefetch results are safe to drop halfway. A cancelled query or refresh
+// would leave the view or the Base behind.
+// -----------------------------------------------------------------------------
+bool
+is_preemptible(UiTaskClass task_class)
+{
+  return task_class == UiTaskClass::PREFETCH;
+}
+
+// -----------------------------------------------------------------------------
+// Forward a cancellation of the task's cancellable to its preemption token.
+// -----------------------------------------------------------------------------
+void
+forward_cancel(GCancellable *, gpointer target)
+{
+  g_cancellable_cancel(G_CANCELLABLE(target));
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Leave the reserve of task_class free, but always allow one worker.
+// -----------------------------------------------------------------------------
+size_t
+ui_task_class_slot_limit(UiTaskClass task_class, size_t worker_count)
+{
+  const size_t reserved = reserved_workers_for(task_class);
+  return worker_count > reserved ? worker_count - reserved : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Map the class to its name.
+// -----------------------------------------------------------------------------
+const char *
+ui_task_class_name(UiTaskClass task_class)
+{
+  switch (task_class) {
+  case UiTaskClass::DETAILS:
+    return "details";
+  case UiTaskClass::QUERY:
+    return "query";
+  case UiTaskClass::PREFETCH:
+    return "prefetch";
+  case UiTaskClass::REFRESH:
+    return "refresh";
+  }
+  return "unknown";
+}
+
+// -----------------------------------------------------------------------------
+// Start the workers right away so the first task does not pay for it.
+// -----------------------------------------------------------------------------
+UiTaskExecutor::UiTaskExecutor(size_t count)
+    : worker_count(std::max<size_t>(count, 1))
+{
+  workers.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers.emplace_back([this]() { worker_main(); });
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Let the workers drain the queues before joining them.
+// -----------------------------------------------------------------------------
+UiTaskExecutor::~UiTaskExecutor()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Never destroyed, so no worker is joined while a task still runs at exit.
+// -----------------------------------------------------------------------------
+UiTaskExecutor &
+UiTaskExecutor::instance()
+{
+  static UiTaskExecutor *executor = new UiTaskExecutor(kUiWorkerCount);
+  return *executor;
+}
+
+// -----------------------------------------------------------------------------
+// Queue the task and preempt a prefetch when it cannot start on its own.
+// -----------------------------------------------------------------------------
+void
+UiTaskExecutor::run(GTask *task, GTaskThreadFunc func, UiTaskClass task_class)
+{
+  GCancellable *victim = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const size_t index = static_cast<size_t>(task_class);
+    queues[index].push_back({ G_TASK(g_object_ref(task)), func, std::chrono::steady_clock::now() });
+    class_stats[index].waiting++;
+    if (running.size() >= ui_task_class_slot_limit(task_class, worker_count)) {
+      victim = take_preemption_victim_locked(task_class);
+    }
+  }
+  wake.notify_one();
+
+  // Cancelled outside the lock, since the task may have handlers connected.
+  if (victim) {
+    g_cancellable_cancel(victim);
+    g_object_unref(victim);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Copy the counters under the lock.
+// -----------------------------------------------------------------------------
+UiTaskExecutorStats
+UiTaskExecutor::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  UiTaskExecutorStats stats;
+  stats.workers = worker_count;
+  stats.busy = running.size();
+  stats.classes = class_stats;
+  return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Take the oldest task of the highest class that may start now.
+// -----------------------------------------------------------------------------
+bool
+UiTaskExecutor::pop_next_locked(QueuedTask &out, UiTaskClass &out_class)
+{
+  for (size_t index = 0; index < kUiTaskClassCount; ++index) {
+    if (queues[index].empty()) {
+      continue;
+    }
+    const UiTaskClass task_class = static_cast<UiTaskClass>(index);
+    if (running.size() >= ui_task_class_slot_limit(task_class, worker_count)) {
+      // Lower classes have smaller limits and cannot start either.
+      return false;
+    }
+    out = queues[index].front();
+    queues[index].pop_front();
+    out_class = task_class;
+    return true;
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Pick a running preemptible task below task_class that was not preempted yet
+// and return a reference on its preemption token.
+// -----------------------------------------------------------------------------
+GCancellable *
+UiTaskExecutor::take_preemption_victim_locked(UiTaskClass task_class)
+{
+  for (RunningTask *candidate : running) {
+    if (candidate->preempted || !is_preemptible(candidate->task_class) || candidate->task_class <= task_class) {
+      continue;
+    }
+    candidate->preempted = true;
+    class_stats[static_cast<size_t>(candidate->task_class)].preempted++;
+    DNFUI_TRACE("UI task preempt class=%s for=%s",
+                ui_task_class_name(candidate->task_class),
+                ui_task_class_name(task_class));
+    return G_CANCELLABLE(g_object_ref(candidate->preempt_cancellable));
+  }
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Run tasks until the executor stops and the queues are empty.
+// -----------------------------------------------------------------------------
+void
+UiTaskExecutor::worker_main()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    QueuedTask next;
+    UiTaskClass task_class = UiTaskClass::REFRESH;
+    while (!pop_next_locked(next, task_class)) {
+      if (stopping && std::all_of(queues.begin(), queues.end(), [](const auto &q) { return q.empty(); })) {
+        return;
+      }
+      wake.wait(lock);
+    }
+
+    const auto waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                              next.queued_at);
+    const uint64_t wait_us = static_cast<uint64_t>(std::max<int64_t>(waited.count(), 0));
+    UiTaskClassStats &stats = class_stats[static_cast<size_t>(task_class)];
+    stats.waiting--;
+    stats.started++;
+    stats.total_wait_us += wait_us;
+    stats.max_wait_us = std::max(stats.max_wait_us, wait_us);
+
+    RunningTask entry;
+    entry.task_class = task_class;
+    if (is_preemptible(task_class)) {
+      entry.preempt_cancellable = g_cancellable_new();
+    }
+    running.push_back(&entry);
+    DNFUI_TRACE("UI task start class=%s wait_us=%llu busy=%zu",
+                ui_task_class_name(task_class),
+                static_cast<unsigned long long>(wait_us),
+                running.size());
+    lock.unlock();
+
+    GCancellable *task_cancellable = g_task_get_cancellable(next.task);
+    GCancellable *func_cancellable = task_cancellable;
+    gulong forward_id = 0;
+    if (entry.preempt_cancellable) {
+      func_cancellable = entry.preempt_cancellable;
+      if (task_cancellable) {
+        forward_id =
+            g_cancellable_connect(task_cancellable, G_CALLBACK(forward_cancel), entry.preempt_cancellable, nullptr);
+      }
+    }
+
+    next.func(next.task, g_task_get_source_object(next.task), g_task_get_task_data(next.task), func_cancellable);
+
+    if (forward_id) {
+      g_cancellable_disconnect(task_cancellable, forward_id);
+    }
+
+    lock.lock();
+    running.erase(std::find(running.begin(), running.end(), &entry));
+    lock.unlock();
+    // Another worker may now fit a task that did not fit before.
+    wake.notify_all();
+    // Dropping the task may run its data destroy notify, so do it unlocked.
+    g_clear_object(&entry.preempt_cancellable);
+    g_object_unref(next.task);
+    lock.lock();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Forward to the process-wide executor.
+// -----------------------------------------------------------------------------
+void
+ui_task_run_in_thread(GTask *task, GTaskThreadFunc func, UiTaskClass task_class)
+{
+  UiTaskExecutor::instance().run(task, func, task_class);
+}
+
+// -----------------------------------------------------------------------------
+// One line per class with its start count, queue wait, and preemptions.
+// -----------------------------------------------------------------------------
+std::string
+ui_task_executor_stats_report()
+{
+  const UiTaskExecutorStats stats = UiTaskExecutor::instance().stats();
+
+  std::ostringstream out;
+  out << "Background tasks\n";
+  out << "  workers: " << stats.workers << ", busy: " << stats.busy << "\n";
+  for (size_t index = 0; index < kUiTaskClassCount; ++index) {
+    const UiTaskClassStats &cls = stats.classes[index];
+    const uint64_t avg_wait_us = cls.started ? cls.total_wait_us / cls.started : 0;
+    out << "  " << ui_task_class_name(static_cast<UiTaskClass>(index)) << ": started " << cls.started
+        << ", waiting " << cls.waiting << ", wait avg " << avg_wait_us << " us, max " << cls.max_wait_us
+        << " us, preempted " << cls.preempted << "\n";
+  }
+  return out.str();
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,146 @@
+// -----------------------------------------------------------------------------
+// src/ui/task_executor.hpp
+// Prioritized worker threads for UI background tasks
+//
+// Runs the GTask thread functions of the window on a small fixed set of worker
+// threads instead of the shared GLib pool. Every task names a priority class,
+// and a waiting task always starts before any task of a lower class. The lower
+// classes may only fill part of the workers, so a details load or a query never
+// waits behind a long refresh. A details load or query that still finds every
+// slot it may use taken cancels a running speculative prefetch to get one.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include <gio/gio.h>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Priority classes, highest first.
+// -----------------------------------------------------------------------------
+enum class UiTaskClass {
+  // Package details the user selected and waits for.
+  DETAILS,
+  // Searches and package lists the user asked for.
+  QUERY,
+  // Work done ahead of time in case the user needs it. Can be preempted.
+  PREFETCH,
+  // Base rebuilds and warm-ups nobody waits on directly.
+  REFRESH,
+};
+
+inline constexpr size_t kUiTaskClassCount = 4;
+
+// -----------------------------------------------------------------------------
+// Counters for one priority class since startup.
+// -----------------------------------------------------------------------------
+struct UiTaskClassStats {
+  uint64_t started = 0;
+  // Running tasks cancelled to free a worker for a higher class.
+  uint64_t preempted = 0;
+  // Time between queueing and starting, over all started tasks.
+  uint64_t total_wait_us = 0;
+  uint64_t max_wait_us = 0;
+  // Tasks queued right now.
+  size_t waiting = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Executor counters, indexed by UiTaskClass.
+// -----------------------------------------------------------------------------
+struct UiTaskExecutorStats {
+  size_t workers = 0;
+  size_t busy = 0;
+  std::array<UiTaskClassStats, kUiTaskClassCount> classes;
+};
+
+class UiTaskExecutor {
+  public:
+  // -----------------------------------------------------------------------------
+  // Start count worker threads, at least one.
+  // -----------------------------------------------------------------------------
+  explicit UiTaskExecutor(size_t count);
+  // -----------------------------------------------------------------------------
+  // Run the queued tasks, then stop and join the workers.
+  // -----------------------------------------------------------------------------
+  ~UiTaskExecutor();
+
+  UiTaskExecutor(const UiTaskExecutor &) = delete;
+  UiTaskExecutor &operator=(const UiTaskExecutor &) = delete;
+
+  // -----------------------------------------------------------------------------
+  // Return the process-wide executor used by the window.
+  // -----------------------------------------------------------------------------
+  static UiTaskExecutor &instance();
+
+  // -----------------------------------------------------------------------------
+  // Queue func to run for task on a worker thread, like g_task_run_in_thread.
+  // The executor holds a reference on task until func returns. A preempted
+  // PREFETCH function sees its cancellable cancelled while the task's own
+  // cancellable stays untouched, so nothing it shares with other tasks is
+  // cancelled.
+  // -----------------------------------------------------------------------------
+  void run(GTask *task, GTaskThreadFunc func, UiTaskClass task_class);
+  // -----------------------------------------------------------------------------
+  // Return a copy of the counters.
+  // -----------------------------------------------------------------------------
+  UiTaskExecutorStats stats() const;
+
+  private:
+  struct QueuedTask {
+    GTask *task = nullptr;
+    GTaskThreadFunc func = nullptr;
+    std::chrono::steady_clock::time_point queued_at;
+  };
+
+  struct RunningTask {
+    UiTaskClass task_class = UiTaskClass::REFRESH;
+    // Cancelled on preemption. Null for classes that are never preempted.
+    GCancellable *preempt_cancellable = nullptr;
+    bool preempted = false;
+  };
+
+  void worker_main();
+  bool pop_next_locked(QueuedTask &out, UiTaskClass &out_class);
+  GCancellable *take_preemption_victim_locked(UiTaskClass task_class);
+
+  size_t worker_count;
+  mutable std::mutex mutex;
+  std::condition_variable wake;
+  std::array<std::deque<QueuedTask>, kUiTaskClassCount> queues;
+  std::vector<RunningTask *> running;
+  std::array<UiTaskClassStats, kUiTaskClassCount> class_stats;
+  bool stopping = false;
+  std::vector<std::thread> workers;
+};
+
+// -----------------------------------------------------------------------------
+// Return how many workers tasks of task_class may occupy at once, counting the
+// tasks of every class. The higher classes may use more of them.
+// -----------------------------------------------------------------------------
+size_t ui_task_class_slot_limit(UiTaskClass task_class, size_t worker_count);
+// -----------------------------------------------------------------------------
+// Return the lowercase class name used in traces and the diagnostics.
+// -----------------------------------------------------------------------------
+const char *ui_task_class_name(UiTaskClass task_class);
+// -----------------------------------------------------------------------------
+// Run func for task on the process-wide executor.
+// -----------------------------------------------------------------------------
+void ui_task_run_in_thread(GTask *task, GTaskThreadFunc func, UiTaskClass task_class);
+// -----------------------------------------------------------------------------
+// Format the process-wide executor counters for the backend diagnostics.
+// -----------------------------------------------------------------------------
+std::string ui_task_executor_stats_report();
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
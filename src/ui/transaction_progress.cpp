@@ -6,10 +6,19 @@
 #include "transaction_progress.hpp"
 
 #include "i18n.hpp"
+#include "progress_log_ring.hpp"
+#include "transaction_summary_model.hpp"
 #include "widgets.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 // -----------------------------------------------------------------------------
 // Transaction progress popup state
@@ -21,11 +30,34 @@
 //   - The newly created progress window starts with one reference for the live window.
 //   - The apply task keeps one reference while background work may still report progress.
 //   - Each queued main-loop progress callback keeps one temporary reference until it runs.
+//   - The frame tick callback that flushes the log keeps one reference until it is removed.
 //
 // Any new queued callback or long-lived background handoff of this pointer must
 // retain it before the handoff and release it after that work is done so delayed
 // callbacks never read freed state.
 // -----------------------------------------------------------------------------
+// Lines kept for Save Log, including the ones trimmed from the text view.
+constexpr size_t kProgressLogRingLines = 50000;
+// Default number of lines shown in the progress text view.
+constexpr size_t kDefaultProgressViewLines = 2000;
+
+// -----------------------------------------------------------------------------
+// Return the number of lines the progress text view keeps. Set
+// DNFUI_PROGRESS_LOG_LINES to change it.
+// -----------------------------------------------------------------------------
+static size_t
+progress_view_max_lines()
+{
+  static const size_t lines = []() {
+    const char *text = g_getenv("DNFUI_PROGRESS_LOG_LINES");
+    if (!text || !*text) {
+      return kDefaultProgressViewLines;
+    }
+    return std::max<size_t>(static_cast<size_t>(g_ascii_strtoull(text, nullptr, 10)), 1);
+  }();
+  return lines;
+}
+
 struct TransactionProgressWindow {
   std::atomic<unsigned> ref_count { 1 };
   GtkWindow *window = nullptr;
@@ -34,30 +66,26 @@ struct TransactionProgressWindow {
   GtkTextBuffer *buffer = nullptr;
   GtkTextView *view = nullptr;
   GtkSpinner *spinner = nullptr;
+  GtkButton *save_button = nullptr;
   GtkButton *close_button = nullptr;
   bool finished = false;
-};
 
-struct ProgressAppendData {
-  TransactionProgressWindow *progress = nullptr;
-  char *message;
+  // Lines queued by any thread and not yet collected on the GTK thread.
+  std::mutex queue_mutex;
+  std::vector<std::string> queued_lines;
+  bool collect_scheduled = false;
+
+  // GTK thread only.
+  ProgressLogRing log { kProgressLogRingLines };
+  // Newest log lines not yet in the text view.
+  size_t unshown_lines = 0;
+  std::string newest_line;
+  size_t view_lines = 0;
+  guint tick_id = 0;
+  // Right-gravity mark that stays at the end of the buffer for autoscroll.
+  GtkTextMark *end_mark = nullptr;
 };
 
-// -----------------------------------------------------------------------------
-// Free data owned by one queued progress message.
-// -----------------------------------------------------------------------------
-static void
-progress_append_data_free(ProgressAppendData *data)
-{
-  if (!data) {
-    return;
-  }
-
-  transaction_progress_release(data->progress);
-  g_free(data->message);
-  delete data;
-}
-
 // -----------------------------------------------------------------------------
 // Retain one reference to the progress window state so queued main loop work
 // can safely keep using it after the caller returns.
@@ -89,6 +117,185 @@ transaction_progress_release(TransactionProgressWindow *progress)
   }
 }
 
+// -----------------------------------------------------------------------------
+// Release the progress reference owned by a GLib callback.
+// -----------------------------------------------------------------------------
+static void
+transaction_progress_release_notify(gpointer p)
+{
+  transaction_progress_release(static_cast<TransactionProgressWindow *>(p));
+}
+
+// -----------------------------------------------------------------------------
+// Frame-batched progress log
+// Lines are queued from any thread and collected into the log ring on the GTK
+// thread. One frame clock tick then adds the newest lines to the text view in
+// a single insert, trims the view to its line limit, and scrolls once, so a
+// burst of output costs one buffer update per frame instead of one per line.
+// -----------------------------------------------------------------------------
+// Add the lines collected since the last frame to the text view.
+// -----------------------------------------------------------------------------
+static gboolean
+flush_transaction_progress_log(GtkWidget *, GdkFrameClock *, gpointer user_data)
+{
+  auto *progress = static_cast<TransactionProgressWindow *>(user_data);
+  progress->tick_id = 0;
+  if (!progress->buffer || !progress->view) {
+    return G_SOURCE_REMOVE;
+  }
+
+  const size_t max_lines = progress_view_max_lines();
+  const size_t count = std::min({ progress->unshown_lines, max_lines, progress->log.size() });
+  progress->unshown_lines = 0;
+  if (count == 0) {
+    return G_SOURCE_REMOVE;
+  }
+
+  std::string text = progress->log.join_newest(count);
+  GtkTextIter end;
+  gtk_text_buffer_get_end_iter(progress->buffer, &end);
+  gtk_text_buffer_insert(progress->buffer, &end, text.c_str(), static_cast<int>(text.size()));
+  progress->view_lines += count;
+
+  // Lines trimmed here stay in the log ring for Save Log.
+  if (progress->view_lines > max_lines) {
+    GtkTextIter start;
+    GtkTextIter cut;
+    gtk_text_buffer_get_start_iter(progress->buffer, &start);
+    gtk_text_buffer_get_iter_at_line(progress->buffer, &cut, static_cast<int>(progress->view_lines - max_lines));
+    gtk_text_buffer_delete(progress->buffer, &start, &cut);
+    progress->view_lines = max_lines;
+  }
+
+  // The finish step owns the stage label once the transaction is done.
+  if (!progress->finished && progress->stage_label) {
+    gtk_label_set_text(progress->stage_label, progress->newest_line.c_str());
+  }
+
+  gtk_text_view_scroll_mark_onscreen(progress->view, progress->end_mark);
+  return G_SOURCE_REMOVE;
+}
+
+// -----------------------------------------------------------------------------
+// Move queued lines into the log ring and make sure the next frame flushes
+// them. Runs on the GTK thread.
+// -----------------------------------------------------------------------------
+static void
+collect_transaction_progress_lines(TransactionProgressWindow *progress)
+{
+  std::vector<std::string> lines;
+  {
+    std::lock_guard<std::mutex> lock(progress->queue_mutex);
+    lines.swap(progress->queued_lines);
+    progress->collect_scheduled = false;
+  }
+
+  // The window is gone, so nobody can see or save these lines.
+  if (!progress->view || lines.empty()) {
+    return;
+  }
+
+  progress->newest_line = lines.back();
+  progress->unshown_lines += lines.size();
+  for (auto &line : lines) {
+    progress->log.push(std::move(line));
+  }
+
+  if (progress->tick_id == 0) {
+    progress->tick_id = gtk_widget_add_tick_callback(GTK_WIDGET(progress->view),
+                                                     flush_transaction_progress_log,
+                                                     transaction_progress_retain(progress),
+                                                     transaction_progress_release_notify);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Queue transaction log lines from any thread. Only the first batch queued
+// since the last collect schedules a main loop callback.
+// -----------------------------------------------------------------------------
+static void
+queue_transaction_progress_lines(TransactionProgressWindow *progress, std::vector<std::string> lines)
+{
+  if (!progress || lines.empty()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(progress->queue_mutex);
+    std::move(lines.begin(), lines.end(), std::back_inserter(progress->queued_lines));
+    if (progress->collect_scheduled) {
+      return;
+    }
+    progress->collect_scheduled = true;
+  }
+
+  g_main_context_invoke_full(
+      nullptr,
+      G_PRIORITY_DEFAULT,
+      +[](gpointer user_data) -> gboolean {
+        collect_transaction_progress_lines(static_cast<TransactionProgressWindow *>(user_data));
+        return G_SOURCE_REMOVE;
+      },
+      transaction_progress_retain(progress),
+      transaction_progress_release_notify);
+}
+
+// -----------------------------------------------------------------------------
+// Write the kept log lines to the file picked in the save dialog.
+// -----------------------------------------------------------------------------
+static void
+on_transaction_progress_log_save_finished(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  auto *progress = static_cast<TransactionProgressWindow *>(user_data);
+  GError *error = nullptr;
+  GFile *file = gtk_file_dialog_save_finish(GTK_FILE_DIALOG(source), result, &error);
+
+  if (file) {
+    std::string text;
+    if (progress->log.dropped() > 0) {
+      text = dnfui_i18n_format_count(progress->log.dropped(),
+                                     "(%zu earlier line was not kept)\n",
+                                     "(%zu earlier lines were not kept)\n");
+    }
+    text += progress->log.join_all();
+    g_file_replace_contents(
+        file, text.data(), text.size(), nullptr, FALSE, G_FILE_CREATE_REPLACE_DESTINATION, nullptr, nullptr, &error);
+    g_object_unref(file);
+  }
+
+  bool dismissed = g_error_matches(error, GTK_DIALOG_ERROR, GTK_DIALOG_ERROR_DISMISSED) ||
+      g_error_matches(error, GTK_DIALOG_ERROR, GTK_DIALOG_ERROR_CANCELLED);
+  if (error && !dismissed) {
+    queue_transaction_progress_lines(progress, { dnfui_i18n_format(_("Could not save the log: %s"), error->message) });
+  }
+  if (error) {
+    g_error_free(error);
+  }
+
+  transaction_progress_release(progress);
+}
+
+// -----------------------------------------------------------------------------
+// Ask for a file name and save the kept transaction log lines.
+// -----------------------------------------------------------------------------
+static void
+save_transaction_progress_log(TransactionProgressWindow *progress)
+{
+  if (!progress || !progress->window) {
+    return;
+  }
+
+  GtkFileDialog *dialog = gtk_file_dialog_new();
+  gtk_file_dialog_set_title(dialog, _("Save Transaction Log"));
+  gtk_file_dialog_set_initial_name(dialog, "dnfui-transaction.log");
+  gtk_file_dialog_save(dialog,
+                       progress->window,
+                       nullptr,
+                       on_transaction_progress_log_save_finished,
+                       transaction_progress_retain(progress));
+  g_object_unref(dialog);
+}
+
 // -----------------------------------------------------------------------------
 // Build the transaction popup used for streaming package install output
 // -----------------------------------------------------------------------------
@@ -161,10 +368,23 @@ transaction_progress_create_window(SearchWidgets *widgets, size_t pending_count)
   gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scroller), GTK_WIDGET(progress->view));
   progress->buffer = gtk_text_view_get_buffer(progress->view);
 
+  GtkTextIter end;
+  gtk_text_buffer_get_end_iter(progress->buffer, &end);
+  progress->end_mark = gtk_text_buffer_create_mark(progress->buffer, nullptr, &end, FALSE);
+
   GtkWidget *button_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
   gtk_widget_set_halign(button_box, GTK_ALIGN_END);
   gtk_box_append(GTK_BOX(outer), button_box);
 
+  progress->save_button = GTK_BUTTON(gtk_button_new_with_label(_("Save Log...")));
+  gtk_box_append(GTK_BOX(button_box), GTK_WIDGET(progress->save_button));
+  g_signal_connect(progress->save_button,
+                   "clicked",
+                   G_CALLBACK(+[](GtkButton *, gpointer user_data) {
+                     save_transaction_progress_log(static_cast<TransactionProgressWindow *>(user_data));
+                   }),
+                   progress);
+
   progress->close_button = GTK_BUTTON(gtk_button_new_with_label(_("Close")));
   gtk_widget_set_sensitive(GTK_WIDGET(progress->close_button), FALSE);
   gtk_box_append(GTK_BOX(button_box), GTK_WIDGET(progress->close_button));
@@ -199,7 +419,10 @@ transaction_progress_create_window(SearchWidgets *widgets, size_t pending_count)
                      progress->buffer = nullptr;
                      progress->view = nullptr;
                      progress->spinner = nullptr;
+                     progress->save_button = nullptr;
                      progress->close_button = nullptr;
+                     progress->end_mark = nullptr;
+                     progress->tick_id = 0;
                      transaction_progress_release(progress);
                    }),
                    progress);
@@ -210,50 +433,7 @@ transaction_progress_create_window(SearchWidgets *widgets, size_t pending_count)
 }
 
 // -----------------------------------------------------------------------------
-// Queue one transaction log line onto the GTK main loop
-// -----------------------------------------------------------------------------
-static void
-append_transaction_progress_line(TransactionProgressWindow *progress, const std::string &message)
-{
-  if (!progress || message.empty()) {
-    return;
-  }
-
-  auto *data = new ProgressAppendData();
-  data->progress = transaction_progress_retain(progress);
-  data->message = g_strdup(message.c_str());
-
-  g_main_context_invoke(
-      nullptr,
-      +[](gpointer user_data) -> gboolean {
-        auto *data = static_cast<ProgressAppendData *>(user_data);
-        TransactionProgressWindow *progress = data ? data->progress : nullptr;
-
-        if (!progress || !progress->stage_label || !progress->buffer || !progress->view) {
-          progress_append_data_free(data);
-          return G_SOURCE_REMOVE;
-        }
-
-        gtk_label_set_text(progress->stage_label, data->message);
-
-        GtkTextIter end;
-        gtk_text_buffer_get_end_iter(progress->buffer, &end);
-        gtk_text_buffer_insert(progress->buffer, &end, data->message, -1);
-        gtk_text_buffer_insert(progress->buffer, &end, "\n", 1);
-
-        gtk_text_buffer_get_end_iter(progress->buffer, &end);
-        GtkTextMark *mark = gtk_text_buffer_create_mark(progress->buffer, nullptr, &end, FALSE);
-        gtk_text_view_scroll_mark_onscreen(progress->view, mark);
-        gtk_text_buffer_delete_mark(progress->buffer, mark);
-
-        progress_append_data_free(data);
-        return G_SOURCE_REMOVE;
-      },
-      data);
-}
-
-// -----------------------------------------------------------------------------
-// Queue one or more transaction log lines onto the GTK main loop
+// Queue the non-empty lines of one message for the next frame.
 // -----------------------------------------------------------------------------
 void
 transaction_progress_append(TransactionProgressWindow *progress, const std::string &message)
@@ -264,12 +444,15 @@ transaction_progress_append(TransactionProgressWindow *progress, const std::stri
 
   std::istringstream stream(message);
   std::string line;
+  std::vector<std::string> lines;
 
   while (std::getline(stream, line)) {
     if (!line.empty()) {
-      append_transaction_progress_line(progress, line);
+      lines.push_back(std::move(line));
     }
   }
+
+  queue_transaction_progress_lines(progress, std::move(lines));
 }
 
 // -----------------------------------------------------------------------------
@@ -346,33 +529,132 @@ format_transaction_space_change(long long delta_bytes)
 }
 
 // -----------------------------------------------------------------------------
-// Append one resolved transaction section to the confirmation dialog.
+// Format the total package download size for the transaction summary dialog.
 // -----------------------------------------------------------------------------
-static void
-append_transaction_summary_section(GtkBox *parent, const char *title, const std::vector<std::string> &items)
+static std::string
+format_transaction_download_size(uint64_t download_bytes)
 {
-  if (!parent || !title || items.empty()) {
-    return;
+  char *formatted = g_format_size(download_bytes);
+  std::string line = dnfui_i18n_format(_("Up to %s will be downloaded."), formatted);
+  g_free(formatted);
+  return line;
+}
+
+// -----------------------------------------------------------------------------
+// Return the heading of one resolved transaction section.
+// -----------------------------------------------------------------------------
+static const char *
+transaction_summary_section_title(TransactionPreviewAction action)
+{
+  switch (action) {
+  case TransactionPreviewAction::INSTALL:
+    return _("To be installed");
+  case TransactionPreviewAction::UPGRADE:
+    return _("To be upgraded");
+  case TransactionPreviewAction::DOWNGRADE:
+    return _("To be downgraded");
+  case TransactionPreviewAction::REINSTALL:
+    return _("To be reinstalled");
+  case TransactionPreviewAction::REMOVE:
+    return _("To be removed");
   }
+  return "";
+}
 
-  GtkWidget *section = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
-  gtk_box_append(parent, section);
+// -----------------------------------------------------------------------------
+// Format the package count and sizes shown next to a section heading.
+// -----------------------------------------------------------------------------
+static std::string
+format_transaction_summary_section_totals(const TransactionSummarySection &section)
+{
+  std::string line = dnfui_i18n_format_count(section.count, "%zu package", "%zu packages");
+  auto append_size = [&line](uint64_t bytes, const char *format) {
+    if (bytes == 0) {
+      return;
+    }
+    char *formatted = g_format_size(bytes);
+    line += ", " + dnfui_i18n_format(format, formatted);
+    g_free(formatted);
+  };
+  append_size(section.download_size, _("%s download"));
+  append_size(section.install_size, _("%s installed size"));
+  return line;
+}
 
-  GtkWidget *heading = gtk_label_new(nullptr);
-  gchar *markup = g_markup_printf_escaped("<b>%s</b>", title);
-  gtk_label_set_markup(GTK_LABEL(heading), markup);
-  g_free(markup);
-  gtk_label_set_xalign(GTK_LABEL(heading), 0.0f);
-  gtk_box_append(GTK_BOX(section), heading);
+// -----------------------------------------------------------------------------
+// Create the widgets of one summary row. Rows are recycled between headers and
+// packages, so bind sets every property that differs between the two.
+// -----------------------------------------------------------------------------
+static void
+on_summary_row_setup(GtkSignalListItemFactory *, GtkListItem *item, gpointer user_data)
+{
+  GtkWidget *row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+  GtkWidget *expander = gtk_image_new();
+  gtk_box_append(GTK_BOX(row), expander);
+
+  GtkWidget *label = gtk_label_new(nullptr);
+  gtk_label_set_xalign(GTK_LABEL(label), 0.0f);
+  gtk_label_set_ellipsize(GTK_LABEL(label), PANGO_ELLIPSIZE_END);
+  gtk_widget_set_hexpand(label, TRUE);
+  gtk_box_append(GTK_BOX(row), label);
+
+  GtkWidget *totals = gtk_label_new(nullptr);
+  gtk_widget_add_css_class(totals, "dim-label");
+  gtk_box_append(GTK_BOX(row), totals);
+
+  // A click on a header row collapses or expands its section.
+  GtkGesture *click = gtk_gesture_click_new();
+  g_object_set_data(G_OBJECT(click), "summary-list-item", item);
+  g_signal_connect(click,
+                   "released",
+                   G_CALLBACK(+[](GtkGestureClick *gesture, int, double, double, gpointer model) {
+                     auto *list_item =
+                         static_cast<GtkListItem *>(g_object_get_data(G_OBJECT(gesture), "summary-list-item"));
+                     transaction_summary_model_toggle_header(DNFUI_TRANSACTION_SUMMARY_MODEL(model),
+                                                             gtk_list_item_get_position(list_item));
+                   }),
+                   user_data);
+  gtk_widget_add_controller(row, GTK_EVENT_CONTROLLER(click));
 
-  for (const auto &item : items) {
-    GtkWidget *label = gtk_label_new(item.c_str());
-    gtk_label_set_xalign(GTK_LABEL(label), 0.0f);
-    gtk_label_set_wrap(GTK_LABEL(label), TRUE);
-    gtk_label_set_selectable(GTK_LABEL(label), TRUE);
-    gtk_widget_set_focusable(label, FALSE);
-    gtk_box_append(GTK_BOX(section), label);
+  gtk_list_item_set_child(item, row);
+}
+
+// -----------------------------------------------------------------------------
+// Show a section heading with its totals, or one indented package label.
+// -----------------------------------------------------------------------------
+static void
+on_summary_row_bind(GtkSignalListItemFactory *, GtkListItem *item, gpointer user_data)
+{
+  auto *model = DNFUI_TRANSACTION_SUMMARY_MODEL(user_data);
+  GtkWidget *row = gtk_list_item_get_child(item);
+  GtkWidget *expander = gtk_widget_get_first_child(row);
+  GtkWidget *label = gtk_widget_get_next_sibling(expander);
+  GtkWidget *totals = gtk_widget_get_next_sibling(label);
+
+  TransactionSummaryRow summary_row;
+  if (!transaction_summary_model_get_row(model, gtk_list_item_get_position(item), summary_row)) {
+    return;
+  }
+
+  gtk_widget_set_visible(expander, summary_row.header);
+  gtk_widget_set_visible(totals, summary_row.header);
+  if (summary_row.header) {
+    const TransactionSummarySection &section = transaction_summary_model_get_section(model, summary_row.section);
+    gtk_image_set_from_icon_name(GTK_IMAGE(expander), section.expanded ? "pan-down-symbolic" : "pan-end-symbolic");
+    gchar *markup = g_markup_printf_escaped("<b>%s</b>", transaction_summary_section_title(section.action));
+    gtk_label_set_markup(GTK_LABEL(label), markup);
+    g_free(markup);
+    gtk_widget_set_margin_start(label, 0);
+    gtk_label_set_text(GTK_LABEL(totals), format_transaction_summary_section_totals(section).c_str());
+    gtk_widget_set_margin_top(row, summary_row.section == 0 ? 0 : 8);
+  } else {
+    GtkStringObject *text = GTK_STRING_OBJECT(gtk_list_item_get_item(item));
+    gtk_label_set_text(GTK_LABEL(label), text ? gtk_string_object_get_string(text) : "");
+    // Line the package labels up under the heading text, past the expander.
+    gtk_widget_set_margin_start(label, 22);
+    gtk_widget_set_margin_top(row, 0);
   }
+  gtk_list_item_set_activatable(item, summary_row.header);
 }
 
 // -----------------------------------------------------------------------------
@@ -380,7 +662,7 @@ append_transaction_summary_section(GtkBox *parent, const char *title, const std:
 // -----------------------------------------------------------------------------
 void
 transaction_progress_show_summary_dialog(SearchWidgets *widgets,
-                                         const TransactionPreview &preview,
+                                         std::shared_ptr<const TransactionPreview> preview,
                                          TransactionApplyCallback on_apply,
                                          TransactionApplyCallback on_cancel)
 {
@@ -427,19 +709,27 @@ transaction_progress_show_summary_dialog(SearchWidgets *widgets,
   gtk_widget_set_vexpand(scroller, TRUE);
   gtk_box_append(GTK_BOX(outer), scroller);
 
-  GtkWidget *contents = gtk_box_new(GTK_ORIENTATION_VERTICAL, 12);
-  gtk_widget_set_margin_start(contents, 6);
-  gtk_widget_set_margin_end(contents, 6);
-  gtk_widget_set_margin_top(contents, 6);
-  gtk_widget_set_margin_bottom(contents, 6);
-  gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scroller), contents);
-
-  // Show the resolved backend changes, not only the packages the user marked manually.
-  append_transaction_summary_section(GTK_BOX(contents), _("To be installed"), preview.install);
-  append_transaction_summary_section(GTK_BOX(contents), _("To be upgraded"), preview.upgrade);
-  append_transaction_summary_section(GTK_BOX(contents), _("To be downgraded"), preview.downgrade);
-  append_transaction_summary_section(GTK_BOX(contents), _("To be reinstalled"), preview.reinstall);
-  append_transaction_summary_section(GTK_BOX(contents), _("To be removed"), preview.remove);
+  // Show the resolved backend changes, not only the packages the user marked
+  // manually. The list view only creates widgets for the visible rows, so an
+  // upgrade of thousands of packages opens as fast as a single install.
+  DnfuiTransactionSummaryModel *summary_model = transaction_summary_model_new(preview);
+  GtkListItemFactory *summary_factory = gtk_signal_list_item_factory_new();
+  g_signal_connect(summary_factory, "setup", G_CALLBACK(on_summary_row_setup), summary_model);
+  g_signal_connect(summary_factory, "bind", G_CALLBACK(on_summary_row_bind), summary_model);
+
+  // The list view owns the selection model, which owns the summary model.
+  GtkWidget *summary_view =
+      gtk_list_view_new(GTK_SELECTION_MODEL(gtk_no_selection_new(G_LIST_MODEL(summary_model))), summary_factory);
+  gtk_widget_set_margin_start(summary_view, 6);
+  gtk_widget_set_margin_end(summary_view, 6);
+  // Enter on a focused heading toggles its section like a click does.
+  g_signal_connect(summary_view,
+                   "activate",
+                   G_CALLBACK(+[](GtkListView *, guint position, gpointer model) {
+                     transaction_summary_model_toggle_header(DNFUI_TRANSACTION_SUMMARY_MODEL(model), position);
+                   }),
+                   summary_model);
+  gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scroller), summary_view);
 
   GtkWidget *summary_heading = gtk_label_new(nullptr);
   gchar *summary_markup = g_markup_printf_escaped("<b>%s</b>", _("Summary"));
@@ -466,12 +756,17 @@ transaction_progress_show_summary_dialog(SearchWidgets *widgets,
     append_summary_line(dnfui_i18n_format_count(count, singular, plural));
   };
 
-  append_count_line(preview.install.size(), "%zu package will be installed.", "%zu packages will be installed.");
-  append_count_line(preview.upgrade.size(), "%zu package will be upgraded.", "%zu packages will be upgraded.");
-  append_count_line(preview.downgrade.size(), "%zu package will be downgraded.", "%zu packages will be downgraded.");
-  append_count_line(preview.reinstall.size(), "%zu package will be reinstalled.", "%zu packages will be reinstalled.");
-  append_count_line(preview.remove.size(), "%zu package will be removed.", "%zu packages will be removed.");
-  append_summary_line(format_transaction_space_change(preview.disk_space_delta));
+  append_count_line(preview->install.size(), "%zu package will be installed.", "%zu packages will be installed.");
+  append_count_line(preview->upgrade.size(), "%zu package will be upgraded.", "%zu packages will be upgraded.");
+  append_count_line(preview->downgrade.size(), "%zu package will be downgraded.", "%zu packages will be downgraded.");
+  append_count_line(preview->reinstall.size(), "%zu package will be reinstalled.", "%zu packages will be reinstalled.");
+  append_count_line(preview->remove.size(), "%zu package will be removed.", "%zu packages will be removed.");
+  // Previews read through the array fallback carry no items, so no size.
+  const uint64_t download_bytes = preview->download_size_total();
+  if (download_bytes > 0) {
+    append_summary_line(format_transaction_download_size(download_bytes));
+  }
+  append_summary_line(format_transaction_space_change(preview->disk_space_delta));
 
   GtkWidget *button_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
   gtk_widget_set_halign(button_box, GTK_ALIGN_END);
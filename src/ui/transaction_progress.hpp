@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <string>
 
 struct SearchWidgets;
@@ -47,7 +48,7 @@ void transaction_progress_show_error_dialog(SearchWidgets *widgets,
 // Show the resolved transaction summary before apply.
 // -----------------------------------------------------------------------------
 void transaction_progress_show_summary_dialog(SearchWidgets *widgets,
-                                              const TransactionPreview &preview,
+                                              std::shared_ptr<const TransactionPreview> preview,
                                               TransactionApplyCallback on_apply,
                                               TransactionApplyCallback on_cancel);
 
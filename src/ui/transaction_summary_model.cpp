@@ -0,0 +1,279 @@
+// -----------------------------------------------------------------------------
+// src/ui/transaction_summary_model.cpp
+// Transaction summary list model
+// A transaction has at most one section per action, so positions are mapped
+// by walking the few sections instead of keeping a row per package.
+// -----------------------------------------------------------------------------
+#include "transaction_summary_model.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+struct TransactionSummaryModelState {
+  std::shared_ptr<const TransactionPreview> preview;
+  std::vector<TransactionSummarySection> sections;
+  // Label list of each section, pointing into preview.
+  std::vector<const std::vector<std::string> *> labels;
+};
+
+struct _DnfuiTransactionSummaryModel {
+  GObject parent_instance;
+  TransactionSummaryModelState *state;
+};
+
+namespace {
+
+// Number of TransactionPreviewAction values.
+constexpr size_t kPreviewActionCount = 5;
+
+// -----------------------------------------------------------------------------
+// Return the number of rows one section shows.
+// -----------------------------------------------------------------------------
+guint
+section_rows(const TransactionSummarySection &section)
+{
+  return 1 + (section.expanded ? static_cast<guint>(section.count) : 0);
+}
+
+// -----------------------------------------------------------------------------
+// Return the number of visible rows.
+// -----------------------------------------------------------------------------
+guint
+visible_count(const TransactionSummaryModelState &state)
+{
+  guint count = 0;
+  for (const auto &section : state.sections) {
+    count += section_rows(section);
+  }
+  return count;
+}
+
+// -----------------------------------------------------------------------------
+// Map one visible position to its section and item.
+// -----------------------------------------------------------------------------
+bool
+locate_row(const TransactionSummaryModelState &state, guint position, TransactionSummaryRow &row_out)
+{
+  for (size_t index = 0; index < state.sections.size(); ++index) {
+    const guint rows = section_rows(state.sections[index]);
+    if (position < rows) {
+      row_out.header = position == 0;
+      row_out.section = index;
+      row_out.item = position == 0 ? 0 : position - 1;
+      return true;
+    }
+    position -= rows;
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Return the label list of one action.
+// -----------------------------------------------------------------------------
+const std::vector<std::string> &
+labels_for(const TransactionPreview &preview, TransactionPreviewAction action)
+{
+  switch (action) {
+  case TransactionPreviewAction::INSTALL:
+    return preview.install;
+  case TransactionPreviewAction::UPGRADE:
+    return preview.upgrade;
+  case TransactionPreviewAction::DOWNGRADE:
+    return preview.downgrade;
+  case TransactionPreviewAction::REINSTALL:
+    return preview.reinstall;
+  case TransactionPreviewAction::REMOVE:
+    return preview.remove;
+  }
+  return preview.install;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Return the item type GTK sees for every position.
+// -----------------------------------------------------------------------------
+static GType
+transaction_summary_model_get_item_type(GListModel *)
+{
+  return GTK_TYPE_STRING_OBJECT;
+}
+
+// -----------------------------------------------------------------------------
+// Return the number of visible rows.
+// -----------------------------------------------------------------------------
+static guint
+transaction_summary_model_get_n_items(GListModel *list)
+{
+  return visible_count(*DNFUI_TRANSACTION_SUMMARY_MODEL(list)->state);
+}
+
+// -----------------------------------------------------------------------------
+// Return a string object with the package label, or an empty one for a header.
+// The list item factory formats headers from the section totals.
+// -----------------------------------------------------------------------------
+static gpointer
+transaction_summary_model_get_item(GListModel *list, guint position)
+{
+  const TransactionSummaryModelState &state = *DNFUI_TRANSACTION_SUMMARY_MODEL(list)->state;
+  TransactionSummaryRow row;
+  if (!locate_row(state, position, row)) {
+    return nullptr;
+  }
+
+  return gtk_string_object_new(row.header ? "" : (*state.labels[row.section])[row.item].c_str());
+}
+
+// -----------------------------------------------------------------------------
+// Wire the GListModel interface.
+// -----------------------------------------------------------------------------
+static void
+dnfui_transaction_summary_model_list_model_init(GListModelInterface *iface)
+{
+  iface->get_item_type = transaction_summary_model_get_item_type;
+  iface->get_n_items = transaction_summary_model_get_n_items;
+  iface->get_item = transaction_summary_model_get_item;
+}
+
+G_DEFINE_TYPE_WITH_CODE(DnfuiTransactionSummaryModel,
+                        dnfui_transaction_summary_model,
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL, dnfui_transaction_summary_model_list_model_init))
+
+// -----------------------------------------------------------------------------
+// Free the model state.
+// -----------------------------------------------------------------------------
+static void
+dnfui_transaction_summary_model_finalize(GObject *object)
+{
+  delete DNFUI_TRANSACTION_SUMMARY_MODEL(object)->state;
+  G_OBJECT_CLASS(dnfui_transaction_summary_model_parent_class)->finalize(object);
+}
+
+// -----------------------------------------------------------------------------
+// Install the model finalizer.
+// -----------------------------------------------------------------------------
+static void
+dnfui_transaction_summary_model_class_init(DnfuiTransactionSummaryModelClass *klass)
+{
+  G_OBJECT_CLASS(klass)->finalize = dnfui_transaction_summary_model_finalize;
+}
+
+// -----------------------------------------------------------------------------
+// Allocate the model state.
+// -----------------------------------------------------------------------------
+static void
+dnfui_transaction_summary_model_init(DnfuiTransactionSummaryModel *self)
+{
+  self->state = new TransactionSummaryModelState;
+}
+
+// -----------------------------------------------------------------------------
+// Build the sections and add up their sizes in one pass over the items.
+// -----------------------------------------------------------------------------
+DnfuiTransactionSummaryModel *
+transaction_summary_model_new(std::shared_ptr<const TransactionPreview> preview)
+{
+  auto *model = DNFUI_TRANSACTION_SUMMARY_MODEL(g_object_new(DNFUI_TYPE_TRANSACTION_SUMMARY_MODEL, nullptr));
+  TransactionSummaryModelState &state = *model->state;
+  state.preview = std::move(preview);
+  if (!state.preview) {
+    return model;
+  }
+
+  uint64_t download_sizes[kPreviewActionCount] = {};
+  uint64_t install_sizes[kPreviewActionCount] = {};
+  for (const auto &item : state.preview->items) {
+    download_sizes[static_cast<size_t>(item.action)] += item.download_size;
+    install_sizes[static_cast<size_t>(item.action)] += item.install_size;
+  }
+
+  for (TransactionPreviewAction action : { TransactionPreviewAction::INSTALL,
+                                           TransactionPreviewAction::UPGRADE,
+                                           TransactionPreviewAction::DOWNGRADE,
+                                           TransactionPreviewAction::REINSTALL,
+                                           TransactionPreviewAction::REMOVE }) {
+    const std::vector<std::string> &labels = labels_for(*state.preview, action);
+    if (labels.empty()) {
+      continue;
+    }
+    TransactionSummarySection section;
+    section.action = action;
+    section.count = labels.size();
+    section.download_size = download_sizes[static_cast<size_t>(action)];
+    section.install_size = install_sizes[static_cast<size_t>(action)];
+    state.sections.push_back(section);
+    state.labels.push_back(&labels);
+  }
+  return model;
+}
+
+// -----------------------------------------------------------------------------
+// Return the number of sections.
+// -----------------------------------------------------------------------------
+size_t
+transaction_summary_model_get_section_count(DnfuiTransactionSummaryModel *model)
+{
+  return model->state->sections.size();
+}
+
+// -----------------------------------------------------------------------------
+// Return one section.
+// -----------------------------------------------------------------------------
+const TransactionSummarySection &
+transaction_summary_model_get_section(DnfuiTransactionSummaryModel *model, size_t index)
+{
+  return model->state->sections.at(index);
+}
+
+// -----------------------------------------------------------------------------
+// Map one visible position.
+// -----------------------------------------------------------------------------
+bool
+transaction_summary_model_get_row(DnfuiTransactionSummaryModel *model, guint position, TransactionSummaryRow &row_out)
+{
+  return locate_row(*model->state, position, row_out);
+}
+
+// -----------------------------------------------------------------------------
+// Announce the package rows below the header as added or removed, and the
+// header itself as changed so its expander state is bound again.
+// -----------------------------------------------------------------------------
+void
+transaction_summary_model_set_expanded(DnfuiTransactionSummaryModel *model, size_t index, bool expanded)
+{
+  TransactionSummaryModelState &state = *model->state;
+  if (index >= state.sections.size() || state.sections[index].expanded == expanded) {
+    return;
+  }
+
+  guint header = 0;
+  for (size_t i = 0; i < index; ++i) {
+    header += section_rows(state.sections[i]);
+  }
+
+  TransactionSummarySection &section = state.sections[index];
+  section.expanded = expanded;
+  const guint rows = static_cast<guint>(section.count);
+  g_list_model_items_changed(G_LIST_MODEL(model), header, 1 + (expanded ? 0 : rows), 1 + (expanded ? rows : 0));
+}
+
+// -----------------------------------------------------------------------------
+// Flip the section of a header row.
+// -----------------------------------------------------------------------------
+bool
+transaction_summary_model_toggle_header(DnfuiTransactionSummaryModel *model, guint position)
+{
+  TransactionSummaryRow row;
+  if (!locate_row(*model->state, position, row) || !row.header) {
+    return false;
+  }
+
+  transaction_summary_model_set_expanded(model, row.section, !model->state->sections[row.section].expanded);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
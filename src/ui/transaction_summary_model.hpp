@@ -0,0 +1,78 @@
+// -----------------------------------------------------------------------------
+// src/ui/transaction_summary_model.hpp
+// Transaction summary list model
+//
+// Shows the sections of one resolved transaction preview to a GtkListView.
+// Every section is a header row followed by its package rows, and a collapsed
+// section keeps only the header. The model shares the preview instead of
+// copying it and creates a string object only for the positions GTK asks for,
+// so a summary of thousands of packages costs the same to open as a short one.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <gtk/gtk.h>
+
+#define DNFUI_TYPE_TRANSACTION_SUMMARY_MODEL (dnfui_transaction_summary_model_get_type())
+G_DECLARE_FINAL_TYPE(
+    DnfuiTransactionSummaryModel, dnfui_transaction_summary_model, DNFUI, TRANSACTION_SUMMARY_MODEL, GObject)
+
+// -----------------------------------------------------------------------------
+// Totals of one non-empty action section. Sizes stay zero for previews read
+// through the array fallback, which carry labels but no items.
+// -----------------------------------------------------------------------------
+struct TransactionSummarySection {
+  TransactionPreviewAction action = TransactionPreviewAction::INSTALL;
+  size_t count = 0;
+  uint64_t download_size = 0;
+  uint64_t install_size = 0;
+  bool expanded = true;
+};
+
+// -----------------------------------------------------------------------------
+// What one visible position shows. item indexes the label list of the section
+// and is unused for headers.
+// -----------------------------------------------------------------------------
+struct TransactionSummaryRow {
+  bool header = false;
+  size_t section = 0;
+  size_t item = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Create a model over the non-empty sections of preview, in the order install,
+// upgrade, downgrade, reinstall, remove, with every section expanded.
+// -----------------------------------------------------------------------------
+DnfuiTransactionSummaryModel *transaction_summary_model_new(std::shared_ptr<const TransactionPreview> preview);
+// -----------------------------------------------------------------------------
+// Return the number of sections.
+// -----------------------------------------------------------------------------
+size_t transaction_summary_model_get_section_count(DnfuiTransactionSummaryModel *model);
+// -----------------------------------------------------------------------------
+// Return one section. index must be below the section count.
+// -----------------------------------------------------------------------------
+const TransactionSummarySection &transaction_summary_model_get_section(DnfuiTransactionSummaryModel *model,
+                                                                       size_t index);
+// -----------------------------------------------------------------------------
+// Describe the row at one visible position. Returns false past the end.
+// -----------------------------------------------------------------------------
+bool transaction_summary_model_get_row(DnfuiTransactionSummaryModel *model,
+                                       guint position,
+                                       TransactionSummaryRow &row_out);
+// -----------------------------------------------------------------------------
+// Show or hide the package rows of one section.
+// -----------------------------------------------------------------------------
+void transaction_summary_model_set_expanded(DnfuiTransactionSummaryModel *model, size_t index, bool expanded);
+// -----------------------------------------------------------------------------
+// Toggle the section when position is a header. Returns false otherwise.
+// -----------------------------------------------------------------------------
+bool transaction_summary_model_toggle_header(DnfuiTransactionSummaryModel *model, guint position);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
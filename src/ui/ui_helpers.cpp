@@ -100,13 +100,10 @@ ui_helpers_update_action_button_labels(SearchWidgets *widgets, const std::string
   bool pending_remove = false;
   bool pending_reinstall = false;
 
-  for (const auto &a : widgets->transaction.actions) {
-    if (a.nevra == pkg) {
-      pending_install = (a.type == PendingAction::INSTALL);
-      pending_remove = (a.type == PendingAction::REMOVE);
-      pending_reinstall = (a.type == PendingAction::REINSTALL);
-      break;
-    }
+  if (const PendingAction *a = widgets->transaction.find_action(pkg)) {
+    pending_install = (a->type == PendingAction::INSTALL);
+    pending_remove = (a->type == PendingAction::REMOVE);
+    pending_reinstall = (a->type == PendingAction::REINSTALL);
   }
 
   if (pending_install) {
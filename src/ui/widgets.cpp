@@ -8,10 +8,13 @@
 #include "base_manager.hpp"
 #include "i18n.hpp"
 #include "package_query_controller.hpp"
+#include "task_executor.hpp"
 #include "ui_helpers.hpp"
 #include "widgets_internal.hpp"
 
 #include <atomic>
+#include <cstdint>
+#include <string>
 
 namespace {
 
@@ -136,13 +139,13 @@ widgets_spinner_release(GtkSpinner *spinner)
 }
 
 // -----------------------------------------------------------------------------
-// Refresh repositories on a worker thread so the window stays responsive.
+// Run one Base rebuild and return its repo state through the task.
 // -----------------------------------------------------------------------------
-void
-widgets_on_rebuild_task(GTask *task, gpointer, gpointer, GCancellable *)
+static void
+run_rebuild_task(GTask *task, BaseRebuildPolicy policy)
 {
   try {
-    BaseRepoState refresh_state = BaseManager::instance().rebuild();
+    BaseRepoState refresh_state = BaseManager::instance().rebuild(policy);
     // GTask completion transfers this heap value back to the GTK thread where
     // widgets_on_rebuild_task_finished() deletes it after reading the result.
     g_task_return_pointer(
@@ -153,21 +156,41 @@ widgets_on_rebuild_task(GTask *task, gpointer, gpointer, GCancellable *)
 }
 
 // -----------------------------------------------------------------------------
-// Finish repository refresh on the GTK thread.
+// Refresh repositories on a worker thread so the window stays responsive.
+// The Base is kept when nothing it was built from has changed.
 // -----------------------------------------------------------------------------
 void
-widgets_on_rebuild_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
+widgets_on_rebuild_task(GTask *task, gpointer, gpointer, GCancellable *)
 {
-  GTask *task = G_TASK(res);
-  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
-  if (widgets_task_should_skip_completion(task, widgets)) {
-    repository_refresh_running = false;
-    return;
-  }
+  run_rebuild_task(task, BaseRebuildPolicy::IF_CHANGED);
+}
+
+// -----------------------------------------------------------------------------
+// Reload all repository metadata on a worker thread, even when nothing
+// appears to have changed.
+// -----------------------------------------------------------------------------
+void
+widgets_on_forced_rebuild_task(GTask *task, gpointer, gpointer, GCancellable *)
+{
+  run_rebuild_task(task, BaseRebuildPolicy::FORCE);
+}
 
+// -----------------------------------------------------------------------------
+// Apply the result of a finished refresh task. live_status is shown when live
+// metadata loaded. clear_search_cache drops the cached searches, which a
+// targeted refresh carried over instead, and reload_view shows the current
+// view again from the new Base.
+// -----------------------------------------------------------------------------
+static void
+apply_repository_refresh_result(GTask *task,
+                                SearchWidgets *widgets,
+                                const char *live_status,
+                                bool clear_search_cache,
+                                bool reload_view)
+{
   GError *error = nullptr;
-  // When rebuild succeeds, this returns the heap value from widgets_on_rebuild_task().
-  // This handler receives that pointer and deletes it after use.
+  // When the task succeeds, this returns the heap value from run_rebuild_task()
+  // or package_query_on_refresh_repo_task(), and it is deleted after use.
   BaseRepoState *refresh_state = static_cast<BaseRepoState *>(g_task_propagate_pointer(task, &error));
 
   // Refresh temporarily disables the main Search button while the rebuild runs.
@@ -179,9 +202,11 @@ widgets_on_rebuild_task_finished(GObject *, GAsyncResult *res, gpointer user_dat
   if (refresh_state) {
     // Search caches are bound to the old Base generation and must be dropped
     // before the user can query against freshly refreshed repositories.
-    package_query_clear_search_cache();
+    if (clear_search_cache) {
+      package_query_clear_search_cache();
+    }
     if (*refresh_state == BaseRepoState::LIVE_METADATA) {
-      ui_helpers_set_status(widgets->query.status_label, _("Repositories refreshed."), "green");
+      ui_helpers_set_status(widgets->query.status_label, live_status, "green");
     } else if (*refresh_state == BaseRepoState::CACHED_METADATA) {
       ui_helpers_set_status(
           widgets->query.status_label, _("Live repo refresh failed. Using cached repository metadata."), "blue");
@@ -189,7 +214,9 @@ widgets_on_rebuild_task_finished(GObject *, GAsyncResult *res, gpointer user_dat
       ui_helpers_set_status(
           widgets->query.status_label, _("Live repo refresh failed. Showing installed packages only."), "blue");
     }
-    package_query_reload_current_view(widgets);
+    if (reload_view) {
+      package_query_reload_current_view(widgets);
+    }
     delete refresh_state;
   } else {
     ui_helpers_set_status(widgets->query.status_label, error ? error->message : _("Repo refresh failed."), "red");
@@ -200,32 +227,146 @@ widgets_on_rebuild_task_finished(GObject *, GAsyncResult *res, gpointer user_dat
 }
 
 // -----------------------------------------------------------------------------
-// Handle the Refresh Repositories button.
-// Starts a Base rebuild through the shared widget controller layer.
+// Finish repository refresh on the GTK thread.
 // -----------------------------------------------------------------------------
 void
-widgets_on_refresh_button_clicked(GtkButton *, gpointer user_data)
+widgets_on_rebuild_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
 {
+  GTask *task = G_TASK(res);
   SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
-  if (!widgets) {
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    repository_refresh_running = false;
     return;
   }
 
+  apply_repository_refresh_result(task, widgets, _("Repositories refreshed."), true, true);
+}
+
+// -----------------------------------------------------------------------------
+// Finish an expired-only refresh. The task data holds the generation seen when
+// it started, so a refresh that kept the Base leaves the cache and view alone.
+// -----------------------------------------------------------------------------
+static void
+on_refresh_expired_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
+{
+  GTask *task = G_TASK(res);
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    repository_refresh_running = false;
+    return;
+  }
+
+  const uint64_t generation_before = *static_cast<const uint64_t *>(g_task_get_task_data(task));
+  const bool replaced = BaseManager::instance().current_generation() != generation_before;
+  const char *live_status = replaced ? _("Repositories refreshed.") : _("No repository metadata has expired.");
+  apply_repository_refresh_result(task, widgets, live_status, replaced, replaced);
+}
+
+// -----------------------------------------------------------------------------
+// Finish a refresh of one repository. The task already carried the search
+// cache into the new generation.
+// -----------------------------------------------------------------------------
+static void
+on_refresh_repo_task_finished(GObject *, GAsyncResult *res, gpointer user_data)
+{
+  GTask *task = G_TASK(res);
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  if (widgets_task_should_skip_completion(task, widgets)) {
+    repository_refresh_running = false;
+    return;
+  }
+
+  const std::string &repo_id = *static_cast<const std::string *>(g_task_get_task_data(task));
+  char *status = g_strdup_printf(_("Repository %s refreshed."), repo_id.c_str());
+  apply_repository_refresh_result(task, widgets, status, false, true);
+  g_free(status);
+}
+
+// -----------------------------------------------------------------------------
+// Claim the single refresh slot and lock the Search button for its duration.
+// Returns false and reports it when a refresh is already running.
+// -----------------------------------------------------------------------------
+static bool
+begin_repository_refresh(SearchWidgets *widgets, const char *status)
+{
   bool expected = false;
   if (!repository_refresh_running.compare_exchange_strong(expected, true)) {
     ui_helpers_set_status(widgets->query.status_label, _("Repository refresh is already running."), "gray");
+    return false;
+  }
+
+  ui_helpers_set_status(widgets->query.status_label, status, "blue");
+  gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.search_button), FALSE);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Handle the Refresh Repositories button.
+// Starts a Base rebuild through the shared widget controller layer.
+// -----------------------------------------------------------------------------
+void
+widgets_on_refresh_button_clicked(GtkButton *, gpointer user_data)
+{
+  SearchWidgets *widgets = static_cast<SearchWidgets *>(user_data);
+  if (!widgets || !begin_repository_refresh(widgets, _("Refreshing repositories..."))) {
     return;
   }
 
   // Once a rebuild starts, stop serving cached search results so the UI does
   // not reuse rows from repository state that is changing.
   package_query_clear_search_cache();
-  ui_helpers_set_status(widgets->query.status_label, _("Refreshing repositories..."), "blue");
-  gtk_widget_set_sensitive(GTK_WIDGET(widgets->query.search_button), FALSE);
 
   GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
   GTask *task = widgets_task_new_for_search_widgets(widgets, c, widgets_on_rebuild_task_finished);
-  g_task_run_in_thread(task, widgets_on_rebuild_task);
+  // An explicit refresh always reloads metadata so the user gets fresh repos.
+  ui_task_run_in_thread(task, widgets_on_forced_rebuild_task, UiTaskClass::REFRESH);
+  g_object_unref(task);
+  g_object_unref(c);
+}
+
+// -----------------------------------------------------------------------------
+// Rebuild only when some repository metadata expired or an input changed.
+// The cached searches stay valid when the Base is kept, so they are only
+// dropped once a new Base is published.
+// -----------------------------------------------------------------------------
+void
+widgets_refresh_expired_repositories(SearchWidgets *widgets)
+{
+  if (!widgets || !begin_repository_refresh(widgets, _("Refreshing expired repositories..."))) {
+    return;
+  }
+
+  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
+  GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_refresh_expired_task_finished);
+  g_task_set_task_data(task, new uint64_t(BaseManager::instance().current_generation()), [](gpointer p) {
+    delete static_cast<uint64_t *>(p);
+  });
+  ui_task_run_in_thread(task, widgets_on_rebuild_task, UiTaskClass::REFRESH);
+  g_object_unref(task);
+  g_object_unref(c);
+}
+
+// -----------------------------------------------------------------------------
+// Download the metadata of one repository again and keep the cached searches
+// it did not touch.
+// -----------------------------------------------------------------------------
+void
+widgets_refresh_repository(SearchWidgets *widgets, const std::string &repo_id)
+{
+  if (!widgets || repo_id.empty()) {
+    return;
+  }
+  char *status = g_strdup_printf(_("Refreshing repository %s..."), repo_id.c_str());
+  const bool started = begin_repository_refresh(widgets, status);
+  g_free(status);
+  if (!started) {
+    return;
+  }
+
+  GCancellable *c = widgets_make_task_cancellable_for(GTK_WIDGET(widgets->query.entry));
+  GTask *task = widgets_task_new_for_search_widgets(widgets, c, on_refresh_repo_task_finished);
+  g_task_set_task_data(task, new std::string(repo_id), [](gpointer p) { delete static_cast<std::string *>(p); });
+  ui_task_run_in_thread(task, package_query_on_refresh_repo_task, UiTaskClass::REFRESH);
   g_object_unref(task);
   g_object_unref(c);
 }
@@ -14,7 +14,9 @@
 #include <gtk/gtk.h>
 
 #include "dnf_backend/dnf_backend.hpp"
+#include "ui/package_file_list_model.hpp"
 #include "ui/package_query_state.hpp"
+#include "ui/package_table_filter.hpp"
 #include "ui/pending_transaction_state.hpp"
 
 // -----------------------------------------------------------------------------
@@ -31,6 +33,7 @@ struct PackageQueryWidgets {
   GtkLabel *status_label = nullptr;
   GtkCheckButton *desc_checkbox = nullptr;
   GtkCheckButton *exact_checkbox = nullptr;
+  GtkCheckButton *files_checkbox = nullptr;
 };
 
 // -----------------------------------------------------------------------------
@@ -42,11 +45,46 @@ struct PackageResultsWidgets {
   GtkPaned *inner_paned = nullptr;
   // Text buffers owned by the details notebook text views.
   GtkTextBuffer *details_buffer = nullptr;
-  GtkTextBuffer *files_buffer = nullptr;
+  // The Files tab shows a list view over this model instead of a text buffer.
+  // The list view owns the model.
+  DnfuiPackageFileListModel *files_model = nullptr;
+  GtkSearchEntry *files_filter = nullptr;
+  GtkLabel *files_count_label = nullptr;
+  GtkButton *files_copy_button = nullptr;
+  // Switches between the file list and files_message_label.
+  GtkStack *files_stack = nullptr;
+  GtkLabel *files_message_label = nullptr;
   GtkTextBuffer *deps_buffer = nullptr;
   GtkTextBuffer *changelog_buffer = nullptr;
+  GtkNotebook *details_notebook = nullptr;
+  // Details tabs already loaded or loading for selected_nevra, one bit per tab.
+  unsigned details_tabs_requested = 0;
+  // Shared by the tab loads of the selected package and cancelled on the next selection.
+  GCancellable *details_cancellable = nullptr;
+  // Pending low-priority timeout that loads the next hidden tab, or 0 when none is queued.
+  guint details_fill_source_id = 0;
+  // Pending timeout that starts the loads of a new selection once arrowing
+  // through the list settles, or 0 when none is queued.
+  guint details_settle_source_id = 0;
+  // Set once the neighbouring rows of the selection were queued for prefetch.
+  bool details_prefetch_started = false;
+  // Changelog entries shown so far and in total. Older entries load in pages
+  // when the changelog view is scrolled to the bottom.
+  size_t changelog_next_entry = 0;
+  size_t changelog_total_entries = 0;
+  bool changelog_loading_more = false;
   GtkLabel *count_label = nullptr;
-  std::vector<PackageRow> current_packages;
+  // Filter bar over the rows already in the package table.
+  GtkDropDown *status_filter = nullptr;
+  GtkDropDown *repo_filter = nullptr;
+  GtkDropDown *arch_filter = nullptr;
+  GtkSearchEntry *text_filter = nullptr;
+  // Values behind the repo and arch choices. Index 0 is the "all" choice.
+  std::vector<std::string> repo_filter_values;
+  std::vector<std::string> arch_filter_values;
+  PackageTableFilter active_filter;
+  // Set while the filter choices are rebuilt, so selection changes are ignored.
+  bool updating_filter_choices = false;
   std::string selected_nevra;
 };
 
@@ -81,6 +119,16 @@ struct SearchWidgets : std::enable_shared_from_this<SearchWidgets> {
 // Handle the refresh repositories button click.
 // -----------------------------------------------------------------------------
 void widgets_on_refresh_button_clicked(GtkButton *, gpointer user_data);
+// -----------------------------------------------------------------------------
+// Refresh only the repositories whose metadata expired, keeping the Base when
+// none did.
+// -----------------------------------------------------------------------------
+void widgets_refresh_expired_repositories(SearchWidgets *widgets);
+// -----------------------------------------------------------------------------
+// Download the metadata of one enabled repository again while the other
+// repositories load from their caches.
+// -----------------------------------------------------------------------------
+void widgets_refresh_repository(SearchWidgets *widgets, const std::string &repo_id);
 
 // -----------------------------------------------------------------------------
 // EOF
@@ -31,10 +31,14 @@ void widgets_spinner_acquire(GtkSpinner *spinner);
 // -----------------------------------------------------------------------------
 void widgets_spinner_release(GtkSpinner *spinner);
 // -----------------------------------------------------------------------------
-// Rebuild repositories on a background task thread.
+// Rebuild repositories on a background task thread when their inputs changed.
 // -----------------------------------------------------------------------------
 void widgets_on_rebuild_task(GTask *task, gpointer, gpointer, GCancellable *);
 // -----------------------------------------------------------------------------
+// Rebuild repositories on a background task thread unconditionally.
+// -----------------------------------------------------------------------------
+void widgets_on_forced_rebuild_task(GTask *task, gpointer, gpointer, GCancellable *);
+// -----------------------------------------------------------------------------
 // Finish repository rebuild handling on the GTK thread.
 // -----------------------------------------------------------------------------
 void widgets_on_rebuild_task_finished(GObject *, GAsyncResult *res, gpointer user_data);
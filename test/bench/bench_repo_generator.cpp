@@ -0,0 +1,363 @@
+// -----------------------------------------------------------------------------
+// test/bench/bench_repo_generator.cpp
+// Synthetic repository generator for the benchmark
+// Package names and descriptions are drawn from one word list with a fixed
+// seed. The metadata carries only what libdnf5 reads from primary.xml.
+// -----------------------------------------------------------------------------
+#include "bench_repo_generator.hpp"
+
+#include <glib.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+namespace {
+
+constexpr std::array<const char *, 96> kWords = {
+  "archive",  "audio",    "backup",   "binary",   "bridge",   "buffer",   "cache",    "calendar", "checksum",
+  "client",   "codec",    "color",    "compiler", "config",   "console",  "crypto",   "daemon",   "database",
+  "debug",    "desktop",  "device",   "dialog",   "display",  "document", "driver",   "editor",   "engine",
+  "event",    "export",   "filter",   "firmware", "font",     "format",   "frame",    "gateway",  "graphics",
+  "handler",  "image",    "import",   "index",    "input",    "kernel",   "keyboard", "layout",   "lexer",
+  "library",  "locale",   "logging",  "mail",     "manager",  "media",    "memory",   "message",  "metadata",
+  "monitor",  "network",  "notify",   "object",   "output",   "package",  "parser",   "password", "plugin",
+  "policy",   "power",    "printer",  "profile",  "protocol", "proxy",    "python",   "query",    "queue",
+  "render",   "resolver", "runtime",  "sandbox",  "scanner",  "schema",   "script",   "security", "sensor",
+  "server",   "session",  "shell",    "socket",   "sound",    "storage",  "stream",   "sync",     "system",
+  "terminal", "theme",    "thread",   "timer",    "toolkit",  "widget",
+};
+
+constexpr const char *kDistTag = ".fc40";
+
+// -----------------------------------------------------------------------------
+// Return one word picked by rng.
+// -----------------------------------------------------------------------------
+const char *
+random_word(std::mt19937_64 &rng)
+{
+  return kWords[rng() % kWords.size()];
+}
+
+// -----------------------------------------------------------------------------
+// Return a description of two to five sentences of eight to sixteen words.
+// -----------------------------------------------------------------------------
+std::string
+random_description(std::mt19937_64 &rng, const std::string &stem)
+{
+  std::string text = "The " + stem + " project provides";
+  const int sentences = 2 + static_cast<int>(rng() % 4);
+  for (int s = 0; s < sentences; ++s) {
+    const int words = 8 + static_cast<int>(rng() % 9);
+    for (int w = 0; w < words; ++w) {
+      std::string word = random_word(rng);
+      if (w == 0 && s > 0) {
+        word[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(word[0])));
+      }
+      text += ' ';
+      text += word;
+    }
+    text += '.';
+  }
+  return text;
+}
+
+// One source package and the binary packages it was built into.
+struct BenchSource {
+  std::string stem;
+  std::string version;
+  int release = 1;
+  std::vector<size_t> package_ids;
+};
+
+// -----------------------------------------------------------------------------
+// Add the binary packages of one new source to repo.
+// -----------------------------------------------------------------------------
+BenchSource
+add_source(std::mt19937_64 &rng, BenchRepo &repo, const std::string &stem)
+{
+  BenchSource source;
+  source.stem = stem;
+  source.version = std::to_string(1 + rng() % 9) + "." + std::to_string(rng() % 20) + "." + std::to_string(rng() % 10);
+  source.release = 1 + static_cast<int>(rng() % 5);
+  const std::string release = std::to_string(source.release) + kDistTag;
+  const bool noarch = rng() % 4 == 0;
+  const bool has_libs = !noarch && rng() % 10 < 7;
+
+  std::string title = stem;
+  for (char &c : title) {
+    if (c == '-') {
+      c = ' ';
+    }
+  }
+  title[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(title[0])));
+
+  auto add = [&](const std::string &name, const std::string &arch, const std::string &summary) -> BenchPackage & {
+    source.package_ids.push_back(repo.packages.size());
+    BenchPackage &package = repo.packages.emplace_back();
+    package.name = name;
+    package.source_name = stem;
+    package.version = source.version;
+    package.release = release;
+    package.arch = arch;
+    package.summary = summary;
+    package.description = random_description(rng, stem);
+    return package;
+  };
+
+  BenchPackage &main = add(stem, noarch ? "noarch" : "x86_64", title + " " + random_word(rng) + " tools");
+  if (has_libs) {
+    main.requires_names.push_back(stem + "-libs");
+    add(stem + "-libs", "x86_64", "Runtime libraries for " + stem);
+    if (rng() % 10 < 3) {
+      add(stem + "-libs", "i686", "Runtime libraries for " + stem);
+    }
+    if (rng() % 10 < 4) {
+      add(stem + "-devel", "x86_64", "Development files for " + stem).requires_names.push_back(stem + "-libs");
+    }
+  }
+  if (rng() % 10 < 2) {
+    add(stem + "-doc", "noarch", "Documentation for " + stem);
+  }
+  return source;
+}
+
+// -----------------------------------------------------------------------------
+// Add new sources named prefix-word-word-N to repo until it holds target
+// packages.
+// -----------------------------------------------------------------------------
+std::vector<BenchSource>
+fill_repo(std::mt19937_64 &rng, BenchRepo &repo, const std::string &prefix, size_t target)
+{
+  std::vector<BenchSource> sources;
+  while (repo.packages.size() < target) {
+    const std::string stem = prefix + random_word(rng) + "-" + random_word(rng) + "-" + std::to_string(sources.size());
+    sources.push_back(add_source(rng, repo, stem));
+  }
+  return sources;
+}
+
+// -----------------------------------------------------------------------------
+// Escape text for XML character data and attribute values.
+// -----------------------------------------------------------------------------
+void
+append_xml_escaped(std::string &out, const std::string &text)
+{
+  for (char c : text) {
+    switch (c) {
+    case '&':
+      out += "&amp;";
+      break;
+    case '<':
+      out += "&lt;";
+      break;
+    case '>':
+      out += "&gt;";
+      break;
+    case '"':
+      out += "&quot;";
+      break;
+    default:
+      out += c;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Return the SHA-256 of data as lowercase hex.
+// -----------------------------------------------------------------------------
+std::string
+sha256_hex(const std::string &data)
+{
+  gchar *digest = g_compute_checksum_for_data(
+      G_CHECKSUM_SHA256, reinterpret_cast<const guchar *>(data.data()), data.size());
+  std::string hex = digest ? digest : "";
+  g_free(digest);
+  return hex;
+}
+
+// -----------------------------------------------------------------------------
+// Append one package entry of primary.xml.
+// -----------------------------------------------------------------------------
+void
+append_primary_package(std::string &out, const BenchPackage &package)
+{
+  const std::string nevra = package.name + "-" + package.version + "-" + package.release + "." + package.arch;
+  const std::string evr_attributes = "epoch=\"" + package.epoch + "\" ver=\"" + package.version + "\" rel=\"" +
+      package.release + "\"";
+  const size_t size = 20000 + package.description.size() * 40;
+
+  out += "<package type=\"rpm\">\n  <name>";
+  append_xml_escaped(out, package.name);
+  out += "</name>\n  <arch>" + package.arch + "</arch>\n  <version " + evr_attributes + "/>\n";
+  out += "  <checksum type=\"sha256\" pkgid=\"YES\">" + sha256_hex(nevra) + "</checksum>\n  <summary>";
+  append_xml_escaped(out, package.summary);
+  out += "</summary>\n  <description>";
+  append_xml_escaped(out, package.description);
+  out += "</description>\n  <packager>dnfui-bench</packager>\n  <url>https://example.invalid/";
+  append_xml_escaped(out, package.name);
+  out += "</url>\n  <time file=\"1700000000\" build=\"1700000000\"/>\n";
+  out += "  <size package=\"" + std::to_string(size) + "\" installed=\"" + std::to_string(size * 3) + "\" archive=\"" +
+         std::to_string(size * 3) + "\"/>\n  <location href=\"Packages/";
+  append_xml_escaped(out, nevra);
+  out += ".rpm\"/>\n  <format>\n    <rpm:license>MIT</rpm:license>\n    <rpm:vendor>dnfui-bench</rpm:vendor>\n";
+  out += "    <rpm:group>Unspecified</rpm:group>\n    <rpm:buildhost>bench.invalid</rpm:buildhost>\n";
+  out += "    <rpm:sourcerpm>";
+  append_xml_escaped(out, package.source_name + "-" + package.version + "-" + package.release);
+  out += ".src.rpm</rpm:sourcerpm>\n    <rpm:header-range start=\"4504\" end=\"24504\"/>\n";
+  out += "    <rpm:provides>\n      <rpm:entry name=\"";
+  append_xml_escaped(out, package.name);
+  out += "\" flags=\"EQ\" " + evr_attributes + "/>\n    </rpm:provides>\n";
+  if (!package.requires_names.empty()) {
+    out += "    <rpm:requires>\n";
+    for (const auto &name : package.requires_names) {
+      out += "      <rpm:entry name=\"";
+      append_xml_escaped(out, name);
+      out += "\"/>\n";
+    }
+    out += "    </rpm:requires>\n";
+  }
+  out += "  </format>\n</package>\n";
+}
+
+// -----------------------------------------------------------------------------
+// Write data to path. Returns false with error_out set on failure.
+// -----------------------------------------------------------------------------
+bool
+write_text_file(const std::filesystem::path &path, const std::string &data, std::string &error_out)
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(data.data(), static_cast<std::streamsize>(data.size()));
+  if (!file.good()) {
+    error_out = "Could not write " + path.string();
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// The base repo gets 60% of the packages, updates 25%, and extras the rest.
+// -----------------------------------------------------------------------------
+std::vector<BenchRepo>
+bench_generate_repos(size_t package_count, const std::vector<PackageRow> &installed)
+{
+  std::mt19937_64 rng(0x646e667569); // "dnfui"
+  std::vector<BenchRepo> repos(3);
+  BenchRepo &base = repos[0];
+  BenchRepo &updates = repos[1];
+  BenchRepo &extras = repos[2];
+  base.id = "dnfui-bench-base";
+  updates.id = "dnfui-bench-updates";
+  extras.id = "dnfui-bench-extras";
+
+  const size_t base_target = package_count * 60 / 100;
+  const size_t updates_target = package_count * 25 / 100;
+  std::vector<BenchSource> sources = fill_repo(rng, base, "", base_target);
+
+  for (size_t i = 0; i < installed.size() && updates.packages.size() < updates_target; i += 5) {
+    const PackageRow &row = installed[i];
+    if (row.arch.str().empty() || row.arch == "(none)" || row.name == "gpg-pubkey") {
+      continue;
+    }
+    BenchPackage &package = updates.packages.emplace_back();
+    package.name = row.name.str();
+    package.source_name = package.name;
+    package.epoch = row.epoch.str().empty() ? "0" : row.epoch.str();
+    package.version = row.version.str();
+    package.release = row.release.str() + ".1";
+    package.arch = row.arch.str();
+    package.summary = row.summary.str();
+    package.description = "Synthetic update of " + row.name.str() + " for the benchmark.";
+  }
+
+  // Rebuild random base sources with a higher release until updates is full.
+  std::shuffle(sources.begin(), sources.end(), rng);
+  for (const BenchSource &source : sources) {
+    if (updates.packages.size() >= updates_target) {
+      break;
+    }
+    for (size_t id : source.package_ids) {
+      BenchPackage package = base.packages[id];
+      package.release = std::to_string(source.release + 1) + kDistTag;
+      updates.packages.push_back(std::move(package));
+    }
+  }
+
+  fill_repo(rng, extras, "extra-", package_count - std::min(package_count, base_target + updates.packages.size()));
+  return repos;
+}
+
+// -----------------------------------------------------------------------------
+// repomd.xml lists only primary, which is all libdnf5 needs to load a repo.
+// -----------------------------------------------------------------------------
+bool
+bench_write_repo(const std::filesystem::path &root, const BenchRepo &repo, std::string &error_out)
+{
+  const std::filesystem::path repodata = root / repo.id / "repodata";
+  std::error_code ec;
+  std::filesystem::create_directories(repodata, ec);
+  if (ec) {
+    error_out = "Could not create " + repodata.string() + ": " + ec.message();
+    return false;
+  }
+
+  std::string primary = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                        "<metadata xmlns=\"http://linux.duke.edu/metadata/common\" "
+                        "xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\" packages=\"" +
+      std::to_string(repo.packages.size()) + "\">\n";
+  primary.reserve(repo.packages.size() * 1600);
+  for (const auto &package : repo.packages) {
+    append_primary_package(primary, package);
+  }
+  primary += "</metadata>\n";
+
+  const std::string checksum = sha256_hex(primary);
+  const std::string size = std::to_string(primary.size());
+  const std::string repomd = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                             "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\" "
+                             "xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\">\n"
+                             "  <revision>1700000000</revision>\n"
+                             "  <data type=\"primary\">\n"
+                             "    <checksum type=\"sha256\">" +
+      checksum + "</checksum>\n    <open-checksum type=\"sha256\">" + checksum +
+      "</open-checksum>\n    <location href=\"repodata/primary.xml\"/>\n"
+      "    <timestamp>1700000000</timestamp>\n    <size>" +
+      size + "</size>\n    <open-size>" + size + "</open-size>\n  </data>\n</repomd>\n";
+
+  return write_text_file(repodata / "primary.xml", primary, error_out) &&
+         write_text_file(repodata / "repomd.xml", repomd, error_out);
+}
+
+// -----------------------------------------------------------------------------
+// The metadata never expires, so a warm load always reuses the cache.
+// -----------------------------------------------------------------------------
+bool
+bench_write_repo_config(const std::filesystem::path &reposdir,
+                        const std::filesystem::path &root,
+                        const std::vector<BenchRepo> &repos,
+                        std::string &error_out)
+{
+  std::error_code ec;
+  std::filesystem::create_directories(reposdir, ec);
+  if (ec) {
+    error_out = "Could not create " + reposdir.string() + ": " + ec.message();
+    return false;
+  }
+
+  std::string config;
+  for (const auto &repo : repos) {
+    config += "[" + repo.id + "]\nname=dnfui benchmark " + repo.id + "\nbaseurl=file://" +
+              std::filesystem::absolute(root / repo.id).string() +
+              "\nenabled=1\ngpgcheck=0\nrepo_gpgcheck=0\nmetadata_expire=-1\n\n";
+  }
+  return write_text_file(reposdir / "dnfui-bench.repo", config, error_out);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+// -----------------------------------------------------------------------------
+// test/bench/bench_repo_generator.hpp
+// Synthetic repository generator for the benchmark
+//
+// Builds a deterministic set of repositories that look like a distribution:
+// source groups split into main, -libs, -devel, and -doc packages, several
+// arches with i686 copies of libraries, multi-sentence descriptions, and an
+// updates repo that carries newer builds of some packages and of part of the
+// installed set. Each repo is written as plain repomd.xml and primary.xml, so
+// libdnf5 loads it from a file:// baseurl without createrepo_c.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// One package of a synthetic repository.
+struct BenchPackage {
+  std::string name;
+  std::string source_name;
+  std::string epoch = "0";
+  std::string version;
+  std::string release;
+  std::string arch;
+  std::string summary;
+  std::string description;
+  std::vector<std::string> requires_names;
+};
+
+// One synthetic repository and its packages.
+struct BenchRepo {
+  std::string id;
+  std::vector<BenchPackage> packages;
+};
+
+// -----------------------------------------------------------------------------
+// Generate about package_count packages spread over a base, an updates, and an
+// extras repository. installed adds newer builds of every fifth installed
+// package to the updates repo, so the upgradeable list is not empty. The same
+// arguments always give the same repositories.
+// -----------------------------------------------------------------------------
+std::vector<BenchRepo> bench_generate_repos(size_t package_count, const std::vector<PackageRow> &installed);
+// -----------------------------------------------------------------------------
+// Write repo under root/<id>/repodata. Returns false with error_out set when a
+// file could not be written.
+// -----------------------------------------------------------------------------
+bool bench_write_repo(const std::filesystem::path &root, const BenchRepo &repo, std::string &error_out);
+// -----------------------------------------------------------------------------
+// Write one .repo file into reposdir that enables every repo under root.
+// -----------------------------------------------------------------------------
+bool bench_write_repo_config(const std::filesystem::path &reposdir,
+                             const std::filesystem::path &root,
+                             const std::vector<BenchRepo> &repos,
+                             std::string &error_out);
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
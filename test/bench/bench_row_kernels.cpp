@@ -0,0 +1,332 @@
+// -----------------------------------------------------------------------------
+// test/bench/bench_row_kernels.cpp
+// Microbenchmarks for the row merge, annotation, search, and sort kernels
+//
+// Drives the inner loops of the package views with synthetic rows instead of a
+// libdnf5 Base, so each kernel can be timed on its own. Row sets vary in size
+// and in how many installed tuples overlap the repo rows; overlapping tuples are
+// split evenly between older, same, and newer installed builds.
+// -----------------------------------------------------------------------------
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "dnf_backend/dnf_internal.hpp"
+#include "ui/package_table_sort.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace dnf_backend_internal;
+
+namespace {
+
+// Installed rows per repo row, close to a desktop install against Fedora.
+constexpr size_t kInstalledDivisor = 4;
+
+const char *const kStems[] = {
+  "python3", "perl", "rust", "golang", "texlive", "ghc", "nodejs", "kernel", "gnome", "kf6",
+};
+const char *const kWords[] = {
+  "parser", "resolver", "toolkit", "bindings", "daemon", "library", "plugin", "codec", "fonts", "utility",
+};
+
+// Synthetic rows for one size and overlap. available is in index order, with
+// one row per tuple, and descriptions holds one description per available row.
+struct RowKernelSet {
+  std::vector<PackageRow> available;
+  std::vector<std::string> descriptions;
+  std::vector<PackageRow> installed;
+};
+
+// -----------------------------------------------------------------------------
+// Return one synthetic package row.
+// -----------------------------------------------------------------------------
+PackageRow
+kernel_row(const std::string &name, const char *arch, const std::string &version, const char *repo)
+{
+  PackageRow row;
+  row.name = name;
+  row.epoch = "0";
+  row.version = version;
+  row.release = "1.fc42";
+  row.arch = PackageString::interned(arch);
+  row.repo = PackageString::interned(repo);
+  row.summary = name + " " + kWords[name.size() % std::size(kWords)] + " for the desktop";
+  row.nevra = name + "-" + version + "-1.fc42." + arch;
+  return row;
+}
+
+// -----------------------------------------------------------------------------
+// Build count repo rows and count / kInstalledDivisor installed rows. overlap
+// is the percentage of installed tuples that also have a repo row; the rest
+// are installed-only.
+// -----------------------------------------------------------------------------
+RowKernelSet
+make_row_kernel_set(size_t count, size_t overlap)
+{
+  RowKernelSet set;
+  set.available.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const std::string name =
+        std::string(kStems[i % std::size(kStems)]) + "-" + kWords[(i / 7) % std::size(kWords)] + std::to_string(i);
+    const char *arch = i % 5 == 0 ? "noarch" : (i % 11 == 0 ? "i686" : "x86_64");
+    set.available.push_back(kernel_row(name, arch, "2." + std::to_string(i % 13), i % 3 == 0 ? "updates" : "fedora"));
+    set.descriptions.push_back("The " + name + " package provides a " + kWords[i % std::size(kWords)] +
+                               ". It is built from the " + kStems[i % std::size(kStems)] + " sources.");
+  }
+
+  const size_t installed_count = count / kInstalledDivisor;
+  const size_t overlapping = installed_count * overlap / 100;
+  for (size_t i = 0; i < installed_count; ++i) {
+    if (i < overlapping) {
+      // Spread the overlapping tuples over the whole repo set.
+      PackageRow row = set.available[(i * kInstalledDivisor) % count];
+      const char *versions[] = { "1.0", nullptr, "9.0" };
+      if (const char *version = versions[i % 3]) {
+        row = kernel_row(row.name, row.arch.c_str(), version, "@System");
+      } else {
+        row.repo = PackageString::interned("@System");
+      }
+      set.installed.push_back(row);
+    } else {
+      set.installed.push_back(kernel_row("local-" + std::to_string(i), "x86_64", "1.0", "@System"));
+    }
+  }
+
+  auto name_arch_order = [](const PackageRow &a, const PackageRow &b) {
+    int cmp = a.name.compare(b.name);
+    return cmp != 0 ? cmp < 0 : a.arch < b.arch;
+  };
+  std::vector<size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return name_arch_order(set.available[a], set.available[b]);
+  });
+  RowKernelSet sorted;
+  for (size_t i : order) {
+    sorted.available.push_back(set.available[i]);
+    sorted.descriptions.push_back(set.descriptions[i]);
+  }
+  sorted.installed = std::move(set.installed);
+  return sorted;
+}
+
+// -----------------------------------------------------------------------------
+// Build index entries for rows with interned tuple keys, the way the package
+// index stores them.
+// -----------------------------------------------------------------------------
+std::vector<PackageIndexEntry>
+make_index_entries(const std::vector<PackageRow> &rows, NameArchInterner &interner)
+{
+  std::vector<PackageIndexEntry> entries;
+  entries.reserve(rows.size());
+  for (const auto &row : rows) {
+    entries.push_back({ row, utf8_casefold_copy(row.name), {}, interner.key_for(row.name, row.arch) });
+  }
+  return entries;
+}
+
+// -----------------------------------------------------------------------------
+// Return pointers to every entry, in order.
+// -----------------------------------------------------------------------------
+std::vector<const PackageIndexEntry *>
+entry_pointers(const std::vector<PackageIndexEntry> &entries)
+{
+  std::vector<const PackageIndexEntry *> pointers;
+  pointers.reserve(entries.size());
+  for (const auto &entry : entries) {
+    pointers.push_back(&entry);
+  }
+  return pointers;
+}
+
+// -----------------------------------------------------------------------------
+// Return the benchmark name for one kernel, size, and overlap.
+// -----------------------------------------------------------------------------
+std::string
+kernel_name(const char *kernel, size_t count, size_t overlap)
+{
+  return std::string(kernel) + " " + std::to_string(count) + " rows, " + std::to_string(overlap) + "% overlap";
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Time the browse and search merge of repo and installed entries, with and
+// without copying the visible rows.
+// -----------------------------------------------------------------------------
+TEST_CASE("Merge visible rows", "[benchmark]")
+{
+  const size_t count = GENERATE(1000, 10000, 100000);
+  const size_t overlap = GENERATE(10, 50, 90);
+  const RowKernelSet set = make_row_kernel_set(count, overlap);
+  NameArchInterner interner;
+  const std::vector<PackageIndexEntry> available = make_index_entries(set.available, interner);
+  const std::vector<PackageIndexEntry> installed = make_index_entries(set.installed, interner);
+  const std::vector<const PackageIndexEntry *> available_matches = entry_pointers(available);
+  const std::vector<const PackageIndexEntry *> installed_matches = entry_pointers(installed);
+
+  REQUIRE(visible_entries_from_index_matches(available_matches, installed_matches).size() >= count);
+
+  BENCHMARK(kernel_name("visible entries", count, overlap))
+  {
+    return visible_entries_from_index_matches(available_matches, installed_matches);
+  };
+  BENCHMARK(kernel_name("visible rows", count, overlap))
+  {
+    return visible_rows_from_index_matches(available_matches, installed_matches);
+  };
+}
+
+// -----------------------------------------------------------------------------
+// Time the repo-candidate annotation of every installed row.
+// -----------------------------------------------------------------------------
+TEST_CASE("Annotate installed rows", "[benchmark]")
+{
+  const size_t count = GENERATE(1000, 10000, 100000);
+  const size_t overlap = GENERATE(10, 50, 90);
+  const RowKernelSet set = make_row_kernel_set(count, overlap);
+  std::map<std::string, PackageRow> available_rows;
+  for (const auto &row : set.available) {
+    available_rows.emplace(row.name_arch_key(), row);
+  }
+  std::vector<PackageRow> installed = set.installed;
+
+  BENCHMARK(kernel_name("annotate installed", count, overlap))
+  {
+    for (auto &row : installed) {
+      annotate_installed_row_with_repo_candidate(row, available_rows);
+    }
+    return installed.back().repo_candidate_relation;
+  };
+}
+
+// -----------------------------------------------------------------------------
+// Time the newest-row deduplication over a scan that sees every third tuple
+// twice, once with an older build.
+// -----------------------------------------------------------------------------
+TEST_CASE("Remember newest rows", "[benchmark]")
+{
+  const size_t count = GENERATE(1000, 10000, 100000);
+  const RowKernelSet set = make_row_kernel_set(count, 0);
+  std::vector<PackageRow> scanned;
+  for (size_t i = 0; i < set.available.size(); ++i) {
+    if (i % 3 == 0) {
+      PackageRow older = set.available[i];
+      older.version = "0.1";
+      scanned.push_back(older);
+    }
+    scanned.push_back(set.available[i]);
+  }
+
+  BENCHMARK(kernel_name("remember newest", count, 0))
+  {
+    std::map<std::string, PackageRow> rows_by_name_arch;
+    for (const auto &row : scanned) {
+      remember_newest_row(rows_by_name_arch, row);
+    }
+    return rows_by_name_arch.size();
+  };
+}
+
+// -----------------------------------------------------------------------------
+// Time the package search predicate over names and descriptions.
+// -----------------------------------------------------------------------------
+TEST_CASE("Match package search", "[benchmark]")
+{
+  const size_t count = GENERATE(1000, 10000, 100000);
+  const RowKernelSet set = make_row_kernel_set(count, 0);
+  struct SearchCase {
+    const char *label;
+    std::string pattern;
+    DnfBackendSearchOptions options;
+  };
+  const SearchCase cases[] = {
+    { "search name", utf8_casefold_copy("Parser"), { false, false } },
+    { "search exact", utf8_casefold_copy("perl-parser1"), { false, true } },
+    { "search description", utf8_casefold_copy("Resolver"), { true, false } },
+    { "search description utf-8", utf8_casefold_copy("Résolveur"), { true, false } },
+  };
+
+  for (const auto &search : cases) {
+    BENCHMARK(kernel_name(search.label, count, 0))
+    {
+      size_t matches = 0;
+      for (size_t i = 0; i < set.available.size(); ++i) {
+        const std::string &description = set.descriptions[i];
+        if (package_text_matches_search(
+                set.available[i].name, [&description]() { return description; }, search.pattern, search.options)) {
+          ++matches;
+        }
+      }
+      return matches;
+    };
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Time the package table comparator: building the items and collation keys of
+// one batch, then sorting a shuffled permutation with the keys cached, the way
+// the list model sorts.
+// -----------------------------------------------------------------------------
+TEST_CASE("Compare package items", "[benchmark]")
+{
+  const size_t count = GENERATE(1000, 10000, 100000);
+  const RowKernelSet set = make_row_kernel_set(count, 0);
+  const PackageColumnKind kinds[] = { PackageColumnKind::PACKAGE, PackageColumnKind::SUMMARY };
+
+  for (PackageColumnKind kind : kinds) {
+    const char *column = kind == PackageColumnKind::PACKAGE ? "package" : "summary";
+
+    BENCHMARK(kernel_name((std::string("collation keys ") + column).c_str(), count, 0))
+    {
+      std::vector<PackageItem> items;
+      items.reserve(set.available.size());
+      for (const auto &row : set.available) {
+        items.push_back(PackageItem { row, {}, 0 });
+        package_table_collation_key(items.back(), kind);
+      }
+      return items.size();
+    };
+
+    std::vector<PackageItem> items;
+    for (const auto &row : set.available) {
+      items.push_back(PackageItem { row, {}, 0 });
+    }
+    std::vector<uint32_t> shuffled(items.size());
+    std::iota(shuffled.begin(), shuffled.end(), 0);
+    uint32_t state = 2463534242u;
+    for (size_t i = shuffled.size(); i > 1; --i) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      std::swap(shuffled[i - 1], shuffled[state % i]);
+    }
+    auto less = [&items, kind](uint32_t a, uint32_t b) {
+      return package_table_compare_items(items[a], items[b], kind) < 0;
+    };
+    std::vector<uint32_t> warm = shuffled;
+    std::stable_sort(warm.begin(), warm.end(), less);
+
+    BENCHMARK_ADVANCED(kernel_name((std::string("sort ") + column).c_str(), count, 0))
+    (Catch::Benchmark::Chronometer meter)
+    {
+      std::vector<std::vector<uint32_t>> runs(static_cast<size_t>(meter.runs()), shuffled);
+      meter.measure([&runs, &less](int run) {
+        std::vector<uint32_t> &order = runs[static_cast<size_t>(run)];
+        std::stable_sort(order.begin(), order.end(), less);
+        return order.front();
+      });
+    };
+  }
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
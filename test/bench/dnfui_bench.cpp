@@ -0,0 +1,391 @@
+// -----------------------------------------------------------------------------
+// test/bench/dnfui_bench.cpp
+// Backend benchmark on synthetic repositories
+// Generates repositories of each requested size, points BaseManager at them,
+// and times cold and warm Base loads, the package lists, searches, and a
+// preview resolve through the public backend API. Results are written as JSON
+// so runs from different releases can be compared.
+// -----------------------------------------------------------------------------
+#include "base_manager.hpp"
+#include "bench_repo_generator.hpp"
+#include "debug_trace.hpp"
+#include "dnf_backend/dnf_backend.hpp"
+#include "trace_spans.hpp"
+
+#include <glib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef DNFUI_VERSION
+#define DNFUI_VERSION "unknown"
+#endif
+
+namespace {
+
+constexpr size_t kPreviewInstallCount = 20;
+
+struct BenchOptions {
+  std::vector<size_t> sizes = { 10000, 50000, 100000 };
+  int repeat = 3;
+  std::string output;
+  std::string work_dir;
+  bool keep_work_dir = false;
+};
+
+// Timings of one measured step, in milliseconds, and the rows it returned.
+struct BenchMetric {
+  std::string name;
+  std::vector<double> samples_ms;
+  size_t rows = 0;
+};
+
+struct BenchDataset {
+  size_t packages = 0;
+  std::vector<std::pair<std::string, size_t>> repos;
+  std::vector<BenchMetric> metrics;
+};
+
+// -----------------------------------------------------------------------------
+// Run step once and add its time to the metric called name.
+// -----------------------------------------------------------------------------
+void
+measure(BenchDataset &dataset, const char *name, const std::function<size_t()> &step)
+{
+  auto it = std::find_if(
+      dataset.metrics.begin(), dataset.metrics.end(), [&](const BenchMetric &metric) { return metric.name == name; });
+  if (it == dataset.metrics.end()) {
+    dataset.metrics.push_back({ name, {}, 0 });
+    it = dataset.metrics.end() - 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const size_t rows = step();
+  const double elapsed_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  it->samples_ms.push_back(elapsed_ms);
+  it->rows = rows;
+  std::fprintf(stderr, "dnfui-bench: %zu packages: %s %.1f ms, %zu rows\n", dataset.packages, name, elapsed_ms, rows);
+}
+
+// -----------------------------------------------------------------------------
+// Rebuild the Base and fail when the synthetic repositories did not load.
+// -----------------------------------------------------------------------------
+size_t
+load_base()
+{
+  if (BaseManager::instance().rebuild(BaseRebuildPolicy::FORCE) != BaseRepoState::LIVE_METADATA) {
+    throw std::runtime_error("The synthetic repositories did not load.");
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Return the installed packages, read with an empty repository directory.
+// -----------------------------------------------------------------------------
+std::vector<PackageRow>
+load_installed_rows(const std::filesystem::path &work_dir)
+{
+  const std::filesystem::path reposdir = work_dir / "empty-repos";
+  std::filesystem::create_directories(reposdir);
+  BaseManager::instance().set_repo_config_override({ reposdir.string(), (work_dir / "empty-cache").string() });
+  BaseManager::instance().rebuild(BaseRebuildPolicy::FORCE);
+  return dnf_backend_get_installed_package_rows_interruptible(nullptr);
+}
+
+// -----------------------------------------------------------------------------
+// Generate one dataset and time every step repeat times.
+// -----------------------------------------------------------------------------
+BenchDataset
+run_dataset(size_t package_count,
+            const std::vector<PackageRow> &installed,
+            const std::filesystem::path &work_dir,
+            int repeat)
+{
+  BenchDataset dataset;
+  dataset.packages = package_count;
+
+  const std::filesystem::path root = work_dir / std::to_string(package_count);
+  const std::filesystem::path repos_root = root / "repos";
+  const std::filesystem::path reposdir = root / "yum.repos.d";
+  const std::filesystem::path cachedir = root / "cache";
+
+  std::string error;
+  const std::vector<BenchRepo> repos = bench_generate_repos(package_count, installed);
+  for (const auto &repo : repos) {
+    if (!bench_write_repo(repos_root, repo, error)) {
+      throw std::runtime_error(error);
+    }
+    dataset.repos.emplace_back(repo.id, repo.packages.size());
+  }
+  if (!bench_write_repo_config(reposdir, repos_root, repos, error)) {
+    throw std::runtime_error(error);
+  }
+  BaseManager::instance().set_repo_config_override({ reposdir.string(), cachedir.string() });
+
+  std::vector<std::string> preview_nevras;
+  for (int run = 0; run < repeat; ++run) {
+    measure(dataset, "cold_base_load", [&]() {
+      std::filesystem::remove_all(cachedir);
+      return load_base();
+    });
+    measure(dataset, "warm_base_load", load_base);
+
+    // The first list after a load also builds the package index.
+    measure(dataset, "first_browse", []() {
+      return dnf_backend_get_browse_package_rows_interruptible(nullptr).size();
+    });
+    std::vector<PackageRow> browse_rows;
+    measure(dataset, "browse", [&]() {
+      browse_rows = dnf_backend_get_browse_package_rows_interruptible(nullptr);
+      return browse_rows.size();
+    });
+    measure(dataset, "installed_list", []() {
+      return dnf_backend_get_installed_package_rows_interruptible(nullptr).size();
+    });
+    measure(dataset, "upgradeable_list", []() {
+      return dnf_backend_get_upgradeable_package_rows_interruptible(nullptr).size();
+    });
+
+    dnf_backend_set_search_options({ .search_in_description = false, .exact_match = false });
+    measure(dataset, "name_search", []() {
+      return dnf_backend_search_package_rows_interruptible("parser", nullptr).size();
+    });
+    dnf_backend_set_search_options({ .search_in_description = true, .exact_match = false });
+    measure(dataset, "description_search", []() {
+      return dnf_backend_search_package_rows_interruptible("resolver", nullptr).size();
+    });
+    dnf_backend_set_search_options({});
+
+    if (preview_nevras.empty()) {
+      for (const auto &row : browse_rows) {
+        if (row.repo == "dnfui-bench-base" && row.name.str().ends_with("-devel")) {
+          preview_nevras.push_back(row.nevra.str());
+          if (preview_nevras.size() == kPreviewInstallCount) {
+            break;
+          }
+        }
+      }
+    }
+    if (preview_nevras.empty()) {
+      throw std::runtime_error("No -devel packages to preview were generated.");
+    }
+    measure(dataset, "preview_resolve", [&]() {
+      TransactionPreview preview;
+      std::string preview_error;
+      if (!dnf_backend_preview_transaction(preview_nevras, {}, {}, preview, preview_error)) {
+        throw std::runtime_error("Preview failed: " + preview_error);
+      }
+      return preview.items.size();
+    });
+  }
+
+  return dataset;
+}
+
+// -----------------------------------------------------------------------------
+// Append text as a JSON string literal.
+// -----------------------------------------------------------------------------
+void
+append_json_string(std::string &out, const std::string &text)
+{
+  out += '"';
+  for (unsigned char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += static_cast<char>(c);
+    } else if (c < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof escaped, "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += static_cast<char>(c);
+    }
+  }
+  out += '"';
+}
+
+// -----------------------------------------------------------------------------
+// Return value with three decimals.
+// -----------------------------------------------------------------------------
+std::string
+json_number(double value)
+{
+  char text[32];
+  std::snprintf(text, sizeof text, "%.3f", value);
+  return text;
+}
+
+// -----------------------------------------------------------------------------
+// Lay out the results as one JSON document. Every metric keeps its samples
+// next to min, median, and max, so later tooling can pick its own statistic.
+// -----------------------------------------------------------------------------
+std::string
+format_results_json(const BenchOptions &options, size_t installed_count, const std::vector<BenchDataset> &datasets)
+{
+  std::string out = "{\n  \"benchmark\": \"dnfui-bench\",\n  \"version\": ";
+  append_json_string(out, DNFUI_VERSION);
+  out += ",\n  \"repeat\": " + std::to_string(options.repeat);
+  out += ",\n  \"installed_packages\": " + std::to_string(installed_count) + ",\n  \"datasets\": [";
+
+  for (size_t d = 0; d < datasets.size(); ++d) {
+    const BenchDataset &dataset = datasets[d];
+    out += d == 0 ? "\n" : ",\n";
+    out += "    {\n      \"packages\": " + std::to_string(dataset.packages) + ",\n      \"repos\": {";
+    for (size_t r = 0; r < dataset.repos.size(); ++r) {
+      out += r == 0 ? " " : ", ";
+      append_json_string(out, dataset.repos[r].first);
+      out += ": " + std::to_string(dataset.repos[r].second);
+    }
+    out += " },\n      \"metrics\": {";
+
+    for (size_t m = 0; m < dataset.metrics.size(); ++m) {
+      const BenchMetric &metric = dataset.metrics[m];
+      std::vector<double> sorted = metric.samples_ms;
+      std::sort(sorted.begin(), sorted.end());
+      out += m == 0 ? "\n        " : ",\n        ";
+      append_json_string(out, metric.name);
+      out += ": { \"unit\": \"ms\", \"min\": " + json_number(sorted.front()) +
+             ", \"median\": " + json_number(sorted[sorted.size() / 2]) + ", \"max\": " + json_number(sorted.back()) +
+             ", \"rows\": " + std::to_string(metric.rows) + ", \"samples\": [";
+      for (size_t s = 0; s < metric.samples_ms.size(); ++s) {
+        out += (s == 0 ? "" : ", ") + json_number(metric.samples_ms[s]);
+      }
+      out += "] }";
+    }
+    out += "\n      }\n    }";
+  }
+
+  out += "\n  ]\n}\n";
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+// Parse a comma-separated list of package counts. Returns false when an entry
+// is not a positive number.
+// -----------------------------------------------------------------------------
+bool
+parse_sizes(const char *text, std::vector<size_t> &sizes)
+{
+  sizes.clear();
+  gchar **parts = g_strsplit(text, ",", -1);
+  bool ok = parts && parts[0];
+  for (gchar **part = parts; ok && *part; ++part) {
+    gchar *end = nullptr;
+    const guint64 value = g_ascii_strtoull(*part, &end, 10);
+    ok = value > 0 && end && *end == '\0';
+    sizes.push_back(static_cast<size_t>(value));
+  }
+  g_strfreev(parts);
+  return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Parse the command line. Returns an exit status when the program should stop,
+// or -1 to run.
+// -----------------------------------------------------------------------------
+int
+parse_options(int argc, char **argv, BenchOptions &options)
+{
+  for (int i = 1; i < argc; ++i) {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--sizes") == 0 && has_value) {
+      if (!parse_sizes(argv[++i], options.sizes)) {
+        std::fprintf(stderr, "Invalid package counts: %s\n", argv[i]);
+        return 1;
+      }
+    } else if (std::strcmp(argv[i], "--repeat") == 0 && has_value) {
+      options.repeat = std::atoi(argv[++i]);
+      if (options.repeat < 1) {
+        std::fprintf(stderr, "Invalid repeat count: %s\n", argv[i]);
+        return 1;
+      }
+    } else if (std::strcmp(argv[i], "--output") == 0 && has_value) {
+      options.output = argv[++i];
+    } else if (std::strcmp(argv[i], "--work-dir") == 0 && has_value) {
+      options.work_dir = argv[++i];
+      options.keep_work_dir = true;
+    } else if (std::strcmp(argv[i], "--help") == 0) {
+      std::puts("Usage: dnfui-bench [--sizes N,N,...] [--repeat N] [--output FILE] [--work-dir DIR]");
+      return 0;
+    } else {
+      std::fprintf(stderr, "Unknown option: %s\n", argv[i]);
+      return 1;
+    }
+  }
+  return -1;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Benchmark main entrypoint. Progress goes to stderr, and the JSON to --output
+// or stdout.
+// -----------------------------------------------------------------------------
+int
+main(int argc, char **argv)
+{
+  BenchOptions options;
+  const int status = parse_options(argc, argv, options);
+  if (status >= 0) {
+    return status;
+  }
+
+  debug_trace_init();
+  trace_spans_init("dnfui-bench");
+
+  if (options.work_dir.empty()) {
+    gchar *tmp = g_dir_make_tmp("dnfui-bench-XXXXXX", nullptr);
+    if (!tmp) {
+      std::fputs("Could not create a work directory.\n", stderr);
+      return 1;
+    }
+    options.work_dir = tmp;
+    g_free(tmp);
+  }
+  const std::filesystem::path work_dir(options.work_dir);
+
+  int exit_status = 0;
+  try {
+    const std::vector<PackageRow> installed = load_installed_rows(work_dir);
+    std::vector<BenchDataset> datasets;
+    for (size_t size : options.sizes) {
+      datasets.push_back(run_dataset(size, installed, work_dir, options.repeat));
+    }
+
+    const std::string json = format_results_json(options, installed.size(), datasets);
+    if (options.output.empty()) {
+      std::fputs(json.c_str(), stdout);
+    } else {
+      std::ofstream file(options.output, std::ios::binary | std::ios::trunc);
+      file.write(json.data(), static_cast<std::streamsize>(json.size()));
+      if (!file.good()) {
+        std::fprintf(stderr, "Could not write %s\n", options.output.c_str());
+        exit_status = 1;
+      }
+    }
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "dnfui-bench: %s\n", e.what());
+    exit_status = 1;
+  }
+
+  if (!options.keep_work_dir) {
+    std::error_code ec;
+    std::filesystem::remove_all(work_dir, ec);
+  }
+  trace_spans_write();
+  return exit_status;
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,567 @@
+// -----------------------------------------------------------------------------
+// test/bench/dnfui_service_load.cpp
+// Multi-client load generator for the transaction service
+// Starts the service on a private session bus and opens one private bus
+// connection per simulated client. Every client sends bursts of StartTransaction
+// calls, then cancels part of the requests, waits for the other previews, and
+// releases them all. The tool reports throughput, latency percentiles per call,
+// how often the service limits rejected a request, and the service memory.
+// -----------------------------------------------------------------------------
+#include "test_service_bus.hpp"
+
+#include <gio/gio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef DNFUI_TEST_SERVICE_BIN
+#define DNFUI_TEST_SERVICE_BIN ""
+#endif
+
+#ifndef DNFUI_VERSION
+#define DNFUI_VERSION "unknown"
+#endif
+
+namespace {
+
+constexpr int kResultPollMs = 10;
+constexpr int kMemorySampleMs = 100;
+
+struct LoadOptions {
+  int clients = 32;
+  int bursts = 5;
+  int burst_size = 4;
+  // Cancel every Nth accepted request instead of waiting for its preview.
+  int cancel_every = 3;
+  int preview_delay_ms = 0;
+  int request_timeout_ms = 120000;
+  std::string install = "bash";
+  std::string service = DNFUI_TEST_SERVICE_BIN;
+  std::string output;
+};
+
+// Latency samples of one D-Bus call or request phase, in milliseconds.
+struct LoadMetric {
+  const char *name = "";
+  std::vector<double> samples_ms;
+};
+
+// Counters and samples of one client, merged after every client finished.
+struct ClientResult {
+  LoadMetric start { "start_transaction" };
+  LoadMetric preview { "preview" };
+  LoadMetric cancel { "cancel" };
+  LoadMetric release { "release" };
+  size_t started = 0;
+  size_t previews_ready = 0;
+  size_t previews_failed = 0;
+  size_t cancelled = 0;
+  size_t timed_out = 0;
+  size_t rejected_service_limit = 0;
+  size_t rejected_client_limit = 0;
+  size_t errors = 0;
+  std::string first_error;
+};
+
+// Resident set size of the service process, read from /proc.
+struct MemorySamples {
+  std::atomic<bool> stop { false };
+  uint64_t start_kib = 0;
+  uint64_t peak_kib = 0;
+  uint64_t end_kib = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Return the milliseconds elapsed since start.
+// -----------------------------------------------------------------------------
+double
+elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// -----------------------------------------------------------------------------
+// Return the VmRSS of one process in KiB, or 0 when it cannot be read.
+// -----------------------------------------------------------------------------
+uint64_t
+process_rss_kib(const std::string &pid)
+{
+  std::ifstream status("/proc/" + pid + "/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      return std::strtoull(line.c_str() + 6, nullptr, 10);
+    }
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Count one failed call, by the limit that rejected it for StartTransaction.
+// -----------------------------------------------------------------------------
+void
+record_call_error(ClientResult &result, const std::string &error)
+{
+  if (error.find("This client has too many active transaction requests.") != std::string::npos) {
+    ++result.rejected_client_limit;
+  } else if (error.find("The transaction service has too many active requests.") != std::string::npos) {
+    ++result.rejected_service_limit;
+  } else {
+    ++result.errors;
+    if (result.first_error.empty()) {
+      result.first_error = error;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Poll one request until its preview finished or the timeout passed. Returns
+// the stage name, or an empty string on timeout.
+// -----------------------------------------------------------------------------
+std::string
+wait_for_preview(GDBusConnection *connection, const std::string &transaction_path, int timeout_ms)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  while (std::chrono::steady_clock::now() < deadline) {
+    std::string stage;
+    bool finished = false;
+    if (call_get_result(connection, transaction_path, stage, finished) && finished) {
+      return stage;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(kResultPollMs));
+  }
+  return {};
+}
+
+// -----------------------------------------------------------------------------
+// Run every burst of one client on its own private bus connection.
+// -----------------------------------------------------------------------------
+void
+run_client(const LoadOptions &options, const char *bus_address, std::latch &ready, ClientResult &result)
+{
+  GError *error = nullptr;
+  GDBusConnection *connection = connect_to_test_bus(bus_address, &error);
+  ready.arrive_and_wait();
+  if (!connection) {
+    result.errors++;
+    result.first_error = error && error->message ? error->message : "Could not connect to the test bus.";
+    g_clear_error(&error);
+    return;
+  }
+
+  for (int burst = 0; burst < options.bursts; ++burst) {
+    struct Started {
+      std::string path;
+      std::chrono::steady_clock::time_point at;
+    };
+    std::vector<Started> started;
+
+    for (int i = 0; i < options.burst_size; ++i) {
+      Started request { {}, std::chrono::steady_clock::now() };
+      std::string start_error;
+      const bool ok = call_start_transaction(connection, options.install.c_str(), request.path, start_error);
+      result.start.samples_ms.push_back(elapsed_ms(request.at));
+      if (ok) {
+        ++result.started;
+        started.push_back(request);
+      } else {
+        record_call_error(result, start_error);
+      }
+    }
+
+    for (size_t i = 0; i < started.size(); ++i) {
+      std::string call_error;
+      if (options.cancel_every > 0 && (i + 1) % static_cast<size_t>(options.cancel_every) == 0) {
+        const auto cancel_at = std::chrono::steady_clock::now();
+        if (call_request_method(connection, started[i].path, "Cancel", call_error)) {
+          result.cancel.samples_ms.push_back(elapsed_ms(cancel_at));
+          ++result.cancelled;
+        } else {
+          record_call_error(result, call_error);
+        }
+        continue;
+      }
+
+      const std::string stage = wait_for_preview(connection, started[i].path, options.request_timeout_ms);
+      if (stage.empty()) {
+        ++result.timed_out;
+      } else {
+        result.preview.samples_ms.push_back(elapsed_ms(started[i].at));
+        if (stage == "preview-ready") {
+          ++result.previews_ready;
+        } else {
+          ++result.previews_failed;
+        }
+      }
+    }
+
+    for (const auto &request : started) {
+      std::string call_error;
+      const auto release_at = std::chrono::steady_clock::now();
+      if (call_request_method(connection, request.path, "Release", call_error)) {
+        result.release.samples_ms.push_back(elapsed_ms(release_at));
+      } else {
+        record_call_error(result, call_error);
+      }
+    }
+  }
+
+  g_object_unref(connection);
+}
+
+// -----------------------------------------------------------------------------
+// Return the service GetStatistics reply, or nullptr when the call failed.
+// -----------------------------------------------------------------------------
+GVariant *
+call_get_statistics(GDBusConnection *connection)
+{
+  GVariant *reply = g_dbus_connection_call_sync(connection,
+                                                kTransactionServiceName,
+                                                kTransactionServiceManagerPath,
+                                                kTransactionServiceManagerInterface,
+                                                "GetStatistics",
+                                                nullptr,
+                                                G_VARIANT_TYPE("(a{sv})"),
+                                                G_DBUS_CALL_FLAGS_NONE,
+                                                -1,
+                                                nullptr,
+                                                nullptr);
+  if (!reply) {
+    return nullptr;
+  }
+
+  GVariant *statistics = g_variant_get_child_value(reply, 0);
+  g_variant_unref(reply);
+  return statistics;
+}
+
+// -----------------------------------------------------------------------------
+// Return value with three decimals.
+// -----------------------------------------------------------------------------
+std::string
+json_number(double value)
+{
+  char text[32];
+  std::snprintf(text, sizeof text, "%.3f", value);
+  return text;
+}
+
+// -----------------------------------------------------------------------------
+// Return the nearest-rank percentile of sorted samples.
+// -----------------------------------------------------------------------------
+double
+percentile(const std::vector<double> &sorted, double fraction)
+{
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const size_t rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size()) + 0.999999);
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+// -----------------------------------------------------------------------------
+// Lay out one metric as a JSON object and print its summary to stderr.
+// -----------------------------------------------------------------------------
+std::string
+format_metric_json(const LoadMetric &metric)
+{
+  std::vector<double> sorted = metric.samples_ms;
+  std::sort(sorted.begin(), sorted.end());
+  const double max = sorted.empty() ? 0.0 : sorted.back();
+  std::fprintf(stderr,
+               "dnfui-service-load: %-17s n=%-6zu p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+               metric.name,
+               sorted.size(),
+               percentile(sorted, 0.50),
+               percentile(sorted, 0.90),
+               percentile(sorted, 0.99),
+               max);
+  return std::string("\"") + metric.name + "\": { \"unit\": \"ms\", \"count\": " + std::to_string(sorted.size()) +
+         ", \"p50\": " + json_number(percentile(sorted, 0.50)) + ", \"p90\": " + json_number(percentile(sorted, 0.90)) +
+         ", \"p99\": " + json_number(percentile(sorted, 0.99)) + ", \"max\": " + json_number(max) + " }";
+}
+
+// -----------------------------------------------------------------------------
+// Lay out the merged client results and the service memory as one JSON
+// document.
+// -----------------------------------------------------------------------------
+std::string
+format_results_json(const LoadOptions &options,
+                    const ClientResult &total,
+                    double wall_ms,
+                    const MemorySamples &memory,
+                    uint64_t service_peak_rss_kib)
+{
+  const size_t attempts = total.start.samples_ms.size();
+  const size_t rejected = total.rejected_client_limit + total.rejected_service_limit;
+  const size_t completed = total.previews_ready + total.previews_failed + total.cancelled;
+  const double seconds = wall_ms / 1000.0;
+
+  std::string out = "{\n  \"benchmark\": \"dnfui-service-load\",\n  \"version\": \"" DNFUI_VERSION "\"";
+  out += ",\n  \"clients\": " + std::to_string(options.clients);
+  out += ",\n  \"bursts\": " + std::to_string(options.bursts);
+  out += ",\n  \"burst_size\": " + std::to_string(options.burst_size);
+  out += ",\n  \"cancel_every\": " + std::to_string(options.cancel_every);
+  out += ",\n  \"preview_delay_ms\": " + std::to_string(options.preview_delay_ms);
+  out += ",\n  \"wall_ms\": " + json_number(wall_ms);
+  out += ",\n  \"requests\": { \"attempted\": " + std::to_string(attempts) +
+         ", \"started\": " + std::to_string(total.started) +
+         ", \"previews_ready\": " + std::to_string(total.previews_ready) +
+         ", \"previews_failed\": " + std::to_string(total.previews_failed) +
+         ", \"cancelled\": " + std::to_string(total.cancelled) +
+         ", \"timed_out\": " + std::to_string(total.timed_out) + ", \"errors\": " + std::to_string(total.errors) +
+         " }";
+  out += ",\n  \"throughput_per_second\": { \"start_transaction\": " +
+         json_number(seconds > 0 ? static_cast<double>(attempts) / seconds : 0.0) +
+         ", \"completed\": " + json_number(seconds > 0 ? static_cast<double>(completed) / seconds : 0.0) + " }";
+  out += ",\n  \"rejections\": { \"client_limit\": " + std::to_string(total.rejected_client_limit) +
+         ", \"service_limit\": " + std::to_string(total.rejected_service_limit) + ", \"rate\": " +
+         json_number(attempts > 0 ? static_cast<double>(rejected) / static_cast<double>(attempts) : 0.0) + " }";
+  out += ",\n  \"service_rss_kib\": { \"start\": " + std::to_string(memory.start_kib) +
+         ", \"peak\": " + std::to_string(memory.peak_kib) + ", \"end\": " + std::to_string(memory.end_kib) +
+         ", \"peak_reported\": " + std::to_string(service_peak_rss_kib) + " }";
+  out += ",\n  \"latency\": {";
+  const LoadMetric *metrics[] = { &total.start, &total.preview, &total.cancel, &total.release };
+  for (size_t m = 0; m < std::size(metrics); ++m) {
+    out += (m == 0 ? "\n    " : ",\n    ") + format_metric_json(*metrics[m]);
+  }
+  out += "\n  }\n}\n";
+
+  std::fprintf(stderr,
+               "dnfui-service-load: %zu requests in %.1f s, %.1f completed/s, %zu rejected (%.1f%%), "
+               "peak RSS %llu KiB\n",
+               attempts,
+               seconds,
+               seconds > 0 ? static_cast<double>(completed) / seconds : 0.0,
+               rejected,
+               attempts > 0 ? 100.0 * static_cast<double>(rejected) / static_cast<double>(attempts) : 0.0,
+               static_cast<unsigned long long>(memory.peak_kib));
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+// Append the samples and counters of one client to the total.
+// -----------------------------------------------------------------------------
+void
+merge_client_result(ClientResult &total, const ClientResult &client)
+{
+  auto append = [](LoadMetric &to, const LoadMetric &from) {
+    to.samples_ms.insert(to.samples_ms.end(), from.samples_ms.begin(), from.samples_ms.end());
+  };
+  append(total.start, client.start);
+  append(total.preview, client.preview);
+  append(total.cancel, client.cancel);
+  append(total.release, client.release);
+  total.started += client.started;
+  total.previews_ready += client.previews_ready;
+  total.previews_failed += client.previews_failed;
+  total.cancelled += client.cancelled;
+  total.timed_out += client.timed_out;
+  total.rejected_service_limit += client.rejected_service_limit;
+  total.rejected_client_limit += client.rejected_client_limit;
+  total.errors += client.errors;
+  if (total.first_error.empty()) {
+    total.first_error = client.first_error;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Parse one positive, or with allow_zero non-negative, integer option value.
+// -----------------------------------------------------------------------------
+bool
+parse_count(const char *text, int &value_out, bool allow_zero = false)
+{
+  gchar *end = nullptr;
+  const gint64 value = g_ascii_strtoll(text, &end, 10);
+  if (!end || *end != '\0' || value < (allow_zero ? 0 : 1) || value > 1000000) {
+    return false;
+  }
+  value_out = static_cast<int>(value);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Parse the command line. Returns an exit status when the program should stop,
+// or -1 to run.
+// -----------------------------------------------------------------------------
+int
+parse_options(int argc, char **argv, LoadOptions &options)
+{
+  for (int i = 1; i < argc; ++i) {
+    const bool has_value = i + 1 < argc;
+    bool ok = true;
+    if (std::strcmp(argv[i], "--clients") == 0 && has_value) {
+      ok = parse_count(argv[++i], options.clients);
+    } else if (std::strcmp(argv[i], "--bursts") == 0 && has_value) {
+      ok = parse_count(argv[++i], options.bursts);
+    } else if (std::strcmp(argv[i], "--burst-size") == 0 && has_value) {
+      ok = parse_count(argv[++i], options.burst_size);
+    } else if (std::strcmp(argv[i], "--cancel-every") == 0 && has_value) {
+      ok = parse_count(argv[++i], options.cancel_every, true);
+    } else if (std::strcmp(argv[i], "--preview-delay-ms") == 0 && has_value) {
+      ok = parse_count(argv[++i], options.preview_delay_ms, true);
+    } else if (std::strcmp(argv[i], "--timeout-ms") == 0 && has_value) {
+      ok = parse_count(argv[++i], options.request_timeout_ms);
+    } else if (std::strcmp(argv[i], "--install") == 0 && has_value) {
+      options.install = argv[++i];
+    } else if (std::strcmp(argv[i], "--service") == 0 && has_value) {
+      options.service = argv[++i];
+    } else if (std::strcmp(argv[i], "--output") == 0 && has_value) {
+      options.output = argv[++i];
+    } else if (std::strcmp(argv[i], "--help") == 0) {
+      std::puts("Usage: dnfui-service-load [--clients N] [--bursts N] [--burst-size N] [--cancel-every N]\n"
+                "                          [--preview-delay-ms MS] [--timeout-ms MS] [--install SPEC]\n"
+                "                          [--service PATH] [--output FILE]");
+      return 0;
+    } else {
+      std::fprintf(stderr, "Unknown option: %s\n", argv[i]);
+      return 1;
+    }
+
+    if (!ok) {
+      std::fprintf(stderr, "Invalid value for %s: %s\n", argv[i - 1], argv[i]);
+      return 1;
+    }
+  }
+
+  if (options.service.empty()) {
+    std::fputs("No service binary; pass --service PATH.\n", stderr);
+    return 1;
+  }
+  return -1;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Load generator main entrypoint. Progress goes to stderr, and the JSON to
+// --output or stdout.
+// -----------------------------------------------------------------------------
+int
+main(int argc, char **argv)
+{
+  LoadOptions options;
+  const int status = parse_options(argc, argv, options);
+  if (status >= 0) {
+    return status;
+  }
+
+  GTestDBus *test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  g_test_dbus_up(test_bus);
+  const char *bus_address = g_test_dbus_get_bus_address(test_bus);
+
+  GError *error = nullptr;
+  GSubprocessLauncher *launcher = g_subprocess_launcher_new(G_SUBPROCESS_FLAGS_STDOUT_SILENCE);
+  g_subprocess_launcher_setenv(launcher, "DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE);
+  if (options.preview_delay_ms > 0) {
+    g_subprocess_launcher_setenv(
+        launcher, "DNFUI_TEST_PREVIEW_DELAY_MS", std::to_string(options.preview_delay_ms).c_str(), TRUE);
+  }
+  const char *service_argv[] = {
+    options.service.c_str(),
+    "--session",
+    nullptr,
+  };
+  GSubprocess *service = g_subprocess_launcher_spawnv(launcher, service_argv, &error);
+  g_object_unref(launcher);
+  if (!service) {
+    std::fprintf(stderr, "dnfui-service-load: %s\n", error && error->message ? error->message : "spawn failed");
+    g_clear_error(&error);
+    g_test_dbus_down(test_bus);
+    g_object_unref(test_bus);
+    return 1;
+  }
+
+  int exit_status = 0;
+  GDBusConnection *control = connect_to_test_bus(bus_address, &error);
+  g_clear_error(&error);
+  if (!control || !wait_for_bus_name_owner(control, kTransactionServiceName, 10000)) {
+    std::fputs("dnfui-service-load: The transaction service did not start.\n", stderr);
+    exit_status = 1;
+  }
+
+  if (exit_status == 0) {
+    const std::string pid = g_subprocess_get_identifier(service) ? g_subprocess_get_identifier(service) : "";
+    MemorySamples memory;
+    memory.start_kib = process_rss_kib(pid);
+    memory.peak_kib = memory.start_kib;
+    std::thread sampler([&memory, &pid]() {
+      while (!memory.stop.load()) {
+        memory.peak_kib = std::max(memory.peak_kib, process_rss_kib(pid));
+        std::this_thread::sleep_for(std::chrono::milliseconds(kMemorySampleMs));
+      }
+    });
+
+    // Every client connects before the first burst, so the bursts overlap.
+    std::vector<ClientResult> results(static_cast<size_t>(options.clients));
+    std::latch ready(options.clients + 1);
+    std::vector<std::thread> clients;
+    for (auto &result : results) {
+      clients.emplace_back(
+          [&options, bus_address, &ready, &result]() { run_client(options, bus_address, ready, result); });
+    }
+    ready.arrive_and_wait();
+    const auto start = std::chrono::steady_clock::now();
+    for (auto &client : clients) {
+      client.join();
+    }
+    const double wall_ms = elapsed_ms(start);
+
+    memory.stop.store(true);
+    sampler.join();
+    memory.end_kib = process_rss_kib(pid);
+
+    uint64_t service_peak_rss_kib = 0;
+    if (GVariant *statistics = call_get_statistics(control)) {
+      guint64 peak = 0;
+      if (g_variant_lookup(statistics, "peak-rss-kib", "t", &peak)) {
+        service_peak_rss_kib = peak;
+      }
+      g_variant_unref(statistics);
+    }
+
+    ClientResult total;
+    for (const auto &result : results) {
+      merge_client_result(total, result);
+    }
+    if (!total.first_error.empty()) {
+      std::fprintf(stderr, "dnfui-service-load: first error: %s\n", total.first_error.c_str());
+    }
+
+    const std::string json = format_results_json(options, total, wall_ms, memory, service_peak_rss_kib);
+    if (options.output.empty()) {
+      std::fputs(json.c_str(), stdout);
+    } else {
+      std::ofstream file(options.output, std::ios::binary | std::ios::trunc);
+      file.write(json.data(), static_cast<std::streamsize>(json.size()));
+      if (!file.good()) {
+        std::fprintf(stderr, "Could not write %s\n", options.output.c_str());
+        exit_status = 1;
+      }
+    }
+  }
+
+  if (control) {
+    g_object_unref(control);
+  }
+  g_subprocess_force_exit(service);
+  g_subprocess_wait(service, nullptr, nullptr);
+  g_object_unref(service);
+  g_test_dbus_down(test_bus);
+  g_object_unref(test_bus);
+  return exit_status;
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
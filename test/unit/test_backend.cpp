@@ -4,9 +4,16 @@
 #include "base_manager.hpp"
 #include "test_utils.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iterator>
 #include <map>
 #include <set>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 // -----------------------------------------------------------------------------
 // BaseManager safety & generation tests
@@ -21,7 +28,7 @@ TEST_CASE("BaseManager generation increments on rebuild")
 
   auto before = mgr.current_generation();
 
-  mgr.rebuild(); // metadata reload only, no system modification
+  mgr.rebuild(BaseRebuildPolicy::FORCE); // metadata reload only, no system modification
 
   auto after = mgr.current_generation();
 
@@ -41,6 +48,332 @@ TEST_CASE("acquire_read returns current generation snapshot")
   REQUIRE(read.generation == expected);
 }
 
+// -----------------------------------------------------------------------------
+// Verify that a rebuild publishes a new Base while a reader still holds the
+// previous one.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager rebuild does not wait for in-flight readers")
+{
+  auto &mgr = BaseManager::instance();
+
+  // Declared before the read so a failed check releases the read first.
+  std::future<BaseRepoState> rebuild;
+  {
+    auto read = mgr.acquire_read();
+    rebuild = std::async(std::launch::async, [&mgr]() { return mgr.rebuild(BaseRebuildPolicy::FORCE); });
+    REQUIRE(rebuild.wait_for(std::chrono::minutes(5)) == std::future_status::ready);
+    REQUIRE_NOTHROW(rebuild.get());
+
+    REQUIRE(mgr.current_generation() > read.generation);
+    auto fresh = mgr.acquire_read();
+    REQUIRE(fresh.generation == mgr.current_generation());
+    REQUIRE(&fresh.base != &read.base);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that read, write, and rebuild activity shows up in the counters and
+// that the write holder is reported only while the lock is held.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager records lock wait, hold, and rebuild counters")
+{
+  auto &mgr = BaseManager::instance();
+  mgr.reset_for_tests();
+
+  {
+    auto read = mgr.acquire_read();
+    REQUIRE(mgr.stats().read_wait.count == 1);
+    REQUIRE(mgr.stats().read_hold.count == 0);
+  }
+  BaseManagerStats after_read = mgr.stats();
+  REQUIRE(after_read.read_hold.count == 1);
+  // The first read after reset builds the Base through at least one load mode.
+  const uint64_t rebuilds = after_read.rebuild_full.count + after_read.rebuild_cache_only.count +
+                            after_read.rebuild_system_only.count;
+  REQUIRE(rebuilds >= 1);
+
+  {
+    auto [base, guard] = mgr.acquire_write("test_backend");
+    BaseManagerStats holding = mgr.stats();
+    REQUIRE(holding.write_wait.count == 1);
+    REQUIRE(holding.write_holder == "test_backend");
+  }
+  BaseManagerStats after_write = mgr.stats();
+  REQUIRE(after_write.write_holder.empty());
+  REQUIRE(after_write.write_hold.count == 1);
+  REQUIRE(after_write.write_hold_by_holder.count("test_backend") == 1);
+
+  const std::string report = mgr.diagnostics_report();
+  REQUIRE(report.find("write by test_backend") != std::string::npos);
+  REQUIRE(report.find("write holder: none") != std::string::npos);
+
+  mgr.reset_for_tests();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a repo-backed rebuild keeps one timing entry per enabled repo.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager records per-repository load timing")
+{
+  auto &mgr = BaseManager::instance();
+  REQUIRE_NOTHROW(mgr.rebuild(BaseRebuildPolicy::FORCE));
+  if (mgr.current_repo_state() == BaseRepoState::INSTALLED_ONLY) {
+    SKIP("No repository metadata is available.");
+  }
+
+  const BaseRepoLoadReport report = mgr.stats().last_repo_load;
+  REQUIRE(report.succeeded);
+  REQUIRE_FALSE(report.mode.empty());
+  for (const auto &timing : report.repos) {
+    REQUIRE_FALSE(timing.repo_id.empty());
+  }
+  REQUIRE(mgr.diagnostics_report().find("Repository load (") != std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// Verify the histogram bucket bounds used for the approximate percentiles.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseTimingHistogram reports bucket upper bounds as percentiles")
+{
+  BaseTimingHistogram histogram;
+  REQUIRE(histogram.approximate_percentile_us(0.5) == 0);
+
+  for (uint64_t us : { 0, 3, 3, 3, 900 }) {
+    histogram.record(us);
+  }
+
+  REQUIRE(histogram.count == 5);
+  REQUIRE(histogram.total_us == 909);
+  REQUIRE(histogram.max_us == 900);
+  REQUIRE(histogram.approximate_percentile_us(0.0) == 0);
+  REQUIRE(histogram.approximate_percentile_us(0.5) == 3);
+  REQUIRE(histogram.approximate_percentile_us(1.0) == 900);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a cancelled rebuild throws and keeps the published Base.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager cancelled rebuilds keep the current Base")
+{
+  reset_backend_globals();
+
+  auto &mgr = BaseManager::instance();
+  mgr.reset_for_tests();
+  REQUIRE_NOTHROW(mgr.rebuild_system_only(BaseRebuildPolicy::FORCE));
+  const auto built = mgr.current_generation();
+
+  std::atomic<bool> cancel { true };
+  REQUIRE_THROWS(mgr.rebuild(BaseRebuildPolicy::FORCE, &cancel));
+  REQUIRE_THROWS(mgr.rebuild_system_only(BaseRebuildPolicy::FORCE, &cancel));
+  REQUIRE(mgr.current_generation() == built);
+  REQUIRE(mgr.current_repo_state() == BaseRepoState::INSTALLED_ONLY);
+  mgr.reset_for_tests();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that an unchanged system-only rebuild keeps the current Base and that
+// a forced rebuild still replaces it.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager skips system-only rebuilds when the rpmdb is unchanged")
+{
+  reset_backend_globals();
+
+  auto &mgr = BaseManager::instance();
+  mgr.reset_for_tests();
+  REQUIRE_NOTHROW(mgr.rebuild_system_only(BaseRebuildPolicy::FORCE));
+  const auto built = mgr.current_generation();
+
+  REQUIRE_NOTHROW(mgr.rebuild_system_only());
+  REQUIRE(mgr.current_generation() == built);
+  REQUIRE(mgr.stats().rebuilds_skipped == 1);
+
+  REQUIRE_NOTHROW(mgr.rebuild_system_only(BaseRebuildPolicy::FORCE));
+  REQUIRE(mgr.current_generation() > built);
+  mgr.reset_for_tests();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that an idle release drops the published Base under a new generation
+// while a reader that still pins it keeps using it.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager releases the idle Base without invalidating readers")
+{
+  reset_backend_globals();
+
+  auto &mgr = BaseManager::instance();
+  mgr.reset_for_tests();
+  REQUIRE_FALSE(mgr.release_idle());
+  REQUIRE_NOTHROW(mgr.rebuild_system_only(BaseRebuildPolicy::FORCE));
+  const auto built = mgr.current_generation();
+
+  {
+    auto read = mgr.acquire_read();
+    REQUIRE(mgr.release_idle());
+    REQUIRE(mgr.current_generation() > built);
+    REQUIRE(read.generation == built);
+  }
+
+  // Nothing is published until the next acquire builds a Base.
+  REQUIRE_FALSE(mgr.release_idle());
+  REQUIRE(mgr.stats().idle_releases == 1);
+  mgr.reset_for_tests();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that previews get separate forks that leave the published Base free,
+// and that a fork stops matching once another lease or a rebuild moved on.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager leases separate forks of the published Base")
+{
+  reset_backend_globals();
+
+  auto &mgr = BaseManager::instance();
+  mgr.reset_for_tests();
+  REQUIRE_NOTHROW(mgr.rebuild_system_only(BaseRebuildPolicy::FORCE));
+
+  BaseForkLease first = mgr.acquire_fork();
+  BaseForkLease second = mgr.acquire_fork();
+  REQUIRE(first);
+  REQUIRE(second);
+  REQUIRE(&first.base() != &second.base());
+  REQUIRE(first.snapshot_generation() == mgr.current_generation());
+  {
+    auto read = mgr.acquire_read();
+    REQUIRE(&read.base != &first.base());
+  }
+
+  // Both forks are busy and the per-snapshot limit is reached.
+  REQUIRE_FALSE(mgr.acquire_fork());
+
+  const auto handle = first.handle();
+  const auto serial = first.serial();
+  first = BaseForkLease();
+  REQUIRE(mgr.fork_is_current(handle, serial));
+
+  BaseForkLease reclaimed = mgr.reclaim_fork(handle, serial);
+  REQUIRE(reclaimed);
+  reclaimed = BaseForkLease();
+  REQUIRE_FALSE(mgr.fork_is_current(handle, serial));
+
+  const auto again = mgr.acquire_fork();
+  REQUIRE(again);
+  REQUIRE(again.handle() == handle);
+
+  const auto stats = mgr.stats();
+  REQUIRE(stats.forks_built == 2);
+  REQUIRE(stats.fork_leases == 3);
+  REQUIRE(stats.fork_unavailable == 1);
+  mgr.reset_for_tests();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a fork is dropped together with the snapshot it was loaded for.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager forks do not outlive a rebuild")
+{
+  reset_backend_globals();
+
+  auto &mgr = BaseManager::instance();
+  mgr.reset_for_tests();
+  REQUIRE_NOTHROW(mgr.rebuild_system_only(BaseRebuildPolicy::FORCE));
+
+  std::shared_ptr<BaseFork> handle;
+  uint64_t serial = 0;
+  {
+    BaseForkLease lease = mgr.acquire_fork();
+    REQUIRE(lease);
+    handle = lease.handle();
+    serial = lease.serial();
+  }
+  REQUIRE(mgr.fork_is_current(handle, serial));
+
+  REQUIRE_NOTHROW(mgr.rebuild_system_only(BaseRebuildPolicy::FORCE));
+  REQUIRE_FALSE(mgr.fork_is_current(handle, serial));
+  REQUIRE_FALSE(mgr.reclaim_fork(handle, serial));
+  mgr.reset_for_tests();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that an unchanged repo-backed rebuild keeps the current Base. Degraded
+// Bases always rebuild, so this needs live repository metadata.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager skips repo rebuilds when nothing changed")
+{
+  auto &mgr = BaseManager::instance();
+  REQUIRE_NOTHROW(mgr.rebuild(BaseRebuildPolicy::FORCE));
+  if (mgr.current_repo_state() != BaseRepoState::LIVE_METADATA) {
+    SKIP("Live repository metadata is not available.");
+  }
+
+  const auto built = mgr.current_generation();
+  REQUIRE(mgr.rebuild() == BaseRepoState::LIVE_METADATA);
+  REQUIRE(mgr.current_generation() == built);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that refreshing one enabled repo publishes a new generation without
+// changing the inputs of the other repos, and that an unknown id is rejected
+// with the published Base left in place.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager refreshes one repository and rejects unknown ids")
+{
+  auto &mgr = BaseManager::instance();
+  REQUIRE_NOTHROW(mgr.rebuild(BaseRebuildPolicy::FORCE));
+  BaseStateFingerprint before;
+  uint64_t generation_before = 0;
+  if (mgr.current_repo_state() != BaseRepoState::LIVE_METADATA ||
+      !mgr.published_repo_inputs(before, generation_before) || before.repo_entries.empty() ||
+      before.repo_entries.front().starts_with("/")) {
+    SKIP("Live repository metadata is not available.");
+  }
+
+  REQUIRE_THROWS_AS(mgr.refresh_repo("dnfui-test-no-such-repo"), std::invalid_argument);
+  REQUIRE(mgr.current_generation() == generation_before);
+
+  const std::string &first = before.repo_entries.front();
+  const std::string repo_id = first.substr(0, first.find(' '));
+  REQUIRE(mgr.refresh_repo(repo_id) == BaseRepoState::LIVE_METADATA);
+
+  BaseStateFingerprint after;
+  uint64_t generation_after = 0;
+  REQUIRE(mgr.published_repo_inputs(after, generation_after));
+  REQUIRE(generation_after > generation_before);
+  REQUIRE(before.same_inputs_except_repo(after, repo_id));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a cached-first startup publishes cached metadata first and that
+// live revalidation swaps in a new generation, or keeps the cached Base when
+// the live load fails.
+// -----------------------------------------------------------------------------
+TEST_CASE("BaseManager cached-first startup revalidates from live metadata")
+{
+  reset_backend_globals();
+
+  auto &mgr = BaseManager::instance();
+  mgr.reset_for_tests();
+  mgr.set_startup_mode(BaseStartupMode::CACHED_FIRST);
+  REQUIRE_NOTHROW(mgr.acquire_read());
+  if (!mgr.live_revalidation_pending()) {
+    mgr.reset_for_tests();
+    SKIP("No cached repository metadata is available.");
+  }
+  REQUIRE(mgr.current_repo_state() == BaseRepoState::CACHED_METADATA);
+
+  const auto cached = mgr.current_generation();
+  {
+    ScopedEnvVar force_failure("DNFUI_TEST_FORCE_FULL_REPO_LOAD_FAILURE", "1");
+    REQUIRE(mgr.revalidate_live_metadata() == BaseRepoState::CACHED_METADATA);
+  }
+  REQUIRE(mgr.current_generation() == cached);
+  REQUIRE_FALSE(mgr.live_revalidation_pending());
+
+  if (mgr.revalidate_live_metadata() == BaseRepoState::LIVE_METADATA) {
+    REQUIRE(mgr.current_generation() > cached);
+  }
+  mgr.reset_for_tests();
+}
+
 // -----------------------------------------------------------------------------
 // Verify that startup still exposes installed packages when repo loading fails.
 // -----------------------------------------------------------------------------
@@ -74,7 +407,7 @@ TEST_CASE("BaseManager rebuild keeps the app usable when repo-backed refresh fai
   {
     ScopedEnvVar force_failure("DNFUI_TEST_FORCE_FULL_REPO_LOAD_FAILURE", "1");
     ScopedEnvVar force_cache_failure("DNFUI_TEST_FORCE_CACHEONLY_REPO_LOAD_FAILURE", "1");
-    REQUIRE_NOTHROW(mgr.rebuild());
+    REQUIRE_NOTHROW(mgr.rebuild(BaseRebuildPolicy::FORCE));
   }
 
   REQUIRE(mgr.current_generation() > before);
@@ -193,6 +526,273 @@ TEST_CASE("Cancelled search returns no results")
   g_object_unref(cancellable);
 }
 
+// -----------------------------------------------------------------------------
+// Package index tests (read-only)
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// Verify that one query publishes the index and a rebuild invalidates it.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package index is reused until the Base generation changes")
+{
+  reset_backend_globals();
+
+  auto first = dnf_backend_get_browse_package_rows_interruptible(nullptr);
+  REQUIRE(dnf_backend_testonly_package_index_is_current());
+
+  auto second = dnf_backend_get_browse_package_rows_interruptible(nullptr);
+  REQUIRE(package_row_nevras(first) == package_row_nevras(second));
+
+  BaseManager::instance().rebuild(BaseRebuildPolicy::FORCE);
+  REQUIRE_FALSE(dnf_backend_testonly_package_index_is_current());
+
+  dnf_backend_warm_package_index(nullptr);
+  REQUIRE(dnf_backend_testonly_package_index_is_current());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a cancelled index build does not publish a partial index.
+// -----------------------------------------------------------------------------
+TEST_CASE("Cancelled package index build publishes nothing")
+{
+  reset_backend_globals();
+
+  BaseManager::instance().rebuild(BaseRebuildPolicy::FORCE);
+
+  GCancellable *cancellable = g_cancellable_new();
+  g_cancellable_cancel(cancellable);
+
+  auto results = dnf_backend_get_browse_package_rows_interruptible(cancellable);
+
+  REQUIRE(results.empty());
+  REQUIRE_FALSE(dnf_backend_testonly_package_index_is_current());
+  g_object_unref(cancellable);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a sharded cold scan produces the same rows as the serial scan.
+// -----------------------------------------------------------------------------
+TEST_CASE("Sharded package scan matches the single-threaded scan")
+{
+  reset_backend_globals();
+
+  dnf_backend_set_scan_worker_count(0);
+  BaseManager::instance().rebuild(BaseRebuildPolicy::FORCE);
+  auto serial_browse = dnf_backend_get_browse_package_rows_interruptible(nullptr);
+  auto serial_installed = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+
+  dnf_backend_set_scan_worker_count(4);
+  BaseManager::instance().rebuild(BaseRebuildPolicy::FORCE);
+  auto sharded_browse = dnf_backend_get_browse_package_rows_interruptible(nullptr);
+  auto sharded_installed = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+  dnf_backend_set_scan_worker_count(0);
+
+  REQUIRE(package_row_nevras(serial_browse) == package_row_nevras(sharded_browse));
+  REQUIRE(package_row_nevras(serial_installed) == package_row_nevras(sharded_installed));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that indexed search results are drawn from the indexed browse view.
+// -----------------------------------------------------------------------------
+TEST_CASE("Indexed search results are a subset of the browse view")
+{
+  reset_backend_globals();
+
+  set_backend_search_options(false, false);
+
+  auto browse_nevras = package_row_nevras(dnf_backend_get_browse_package_rows_interruptible(nullptr));
+  auto results = dnf_backend_search_package_rows_interruptible("bash", nullptr);
+  REQUIRE(!results.empty());
+
+  for (const auto &row : results) {
+    INFO(row.nevra);
+    REQUIRE(browse_nevras.count(row.nevra) == 1);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that installed refresh and exact-NEVRA lookups agree with the index.
+// -----------------------------------------------------------------------------
+TEST_CASE("Installed refresh and exact lookups reuse the package index")
+{
+  reset_backend_globals();
+
+  auto installed = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+  REQUIRE(dnf_backend_testonly_package_index_is_current());
+  REQUIRE(!installed.empty());
+
+  dnf_backend_testonly_clear_installed_snapshot();
+  dnf_backend_refresh_installed_nevras();
+  REQUIRE(dnf_backend_installed_snapshot_size() == package_row_nevras(installed).size());
+
+  const PackageRow &row = installed.front();
+  auto exact = dnf_backend_get_installed_package_rows_by_nevra(row.nevra);
+  REQUIRE(exact.size() == 1);
+  REQUIRE(exact.front().repo_candidate_relation == row.repo_candidate_relation);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that batched exact-NEVRA lookups match the per-NEVRA results in
+// request order.
+// -----------------------------------------------------------------------------
+TEST_CASE("Batched exact lookups match per-NEVRA lookups")
+{
+  reset_backend_globals();
+
+  auto installed = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+  REQUIRE(!installed.empty());
+
+  std::vector<std::string> nevras;
+  for (size_t i = 0; i < installed.size() && nevras.size() < 8; i += 3) {
+    nevras.push_back(installed[i].nevra);
+  }
+  std::reverse(nevras.begin(), nevras.end());
+  nevras.push_back("dnfui-missing-package-0:1.0-1.noarch");
+
+  auto batched = dnf_backend_get_installed_package_rows_by_nevras(nevras);
+  std::vector<PackageRow> expected;
+  for (const auto &nevra : nevras) {
+    auto rows = dnf_backend_get_installed_package_rows_by_nevra(nevra);
+    expected.insert(expected.end(), rows.begin(), rows.end());
+  }
+
+  REQUIRE(batched.size() == expected.size());
+  for (size_t i = 0; i < batched.size(); ++i) {
+    INFO(batched[i].nevra);
+    REQUIRE(batched[i].nevra == expected[i].nevra);
+    REQUIRE(batched[i].repo_candidate_relation == expected[i].repo_candidate_relation);
+  }
+
+  REQUIRE(dnf_backend_get_installed_package_rows_by_nevras({}).empty());
+  REQUIRE(dnf_backend_get_available_package_rows_by_nevras({}).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that batched lookups keep request order when the requested NEVRAs
+// spell out the zero epoch that libdnf5 leaves out.
+// -----------------------------------------------------------------------------
+TEST_CASE("Batched exact-NEVRA lookup orders rows with an explicit zero epoch")
+{
+  reset_backend_globals();
+
+  auto installed = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+  std::vector<std::string> nevras;
+  std::vector<std::string> expected;
+  for (const auto &row : installed) {
+    if (nevras.size() == 6) {
+      break;
+    }
+    if (row.epoch.str() != "0" && !row.epoch.str().empty()) {
+      continue;
+    }
+    nevras.push_back(row.name.str() + "-0:" + row.version.str() + "-" + row.release.str() + "." + row.arch.str());
+    expected.push_back(row.nevra);
+  }
+  REQUIRE(nevras.size() >= 2);
+  std::reverse(nevras.begin(), nevras.end());
+  std::reverse(expected.begin(), expected.end());
+
+  auto batched = dnf_backend_get_installed_package_rows_by_nevras(nevras);
+  REQUIRE(batched.size() == expected.size());
+  for (size_t i = 0; i < batched.size(); ++i) {
+    REQUIRE(batched[i].nevra == expected[i]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the batched reinstall lookup agrees with the per-row check and
+// leaves out rows that are not installed.
+// -----------------------------------------------------------------------------
+TEST_CASE("Batched reinstall lookup matches per-row reinstall checks")
+{
+  reset_backend_globals();
+
+  auto installed = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+  REQUIRE(!installed.empty());
+
+  std::vector<PackageRow> rows;
+  for (size_t i = 0; i < installed.size() && rows.size() < 8; i += 3) {
+    rows.push_back(installed[i]);
+  }
+  PackageRow missing;
+  missing.nevra = "dnfui-missing-package-0:1.0-1.noarch";
+  missing.name = "dnfui-missing-package";
+  rows.push_back(missing);
+
+  dnf_backend_refresh_installed_nevras();
+  const InstalledPackageSnapshotPtr snapshot = dnf_backend_get_installed_snapshot();
+  std::set<std::string> reinstallable = dnf_backend_get_reinstallable_nevras(*snapshot, rows);
+  for (const auto &row : rows) {
+    INFO(row.nevra);
+    REQUIRE((reinstallable.count(row.nevra) > 0) == dnf_backend_can_reinstall_package(row));
+  }
+  REQUIRE(reinstallable.count(missing.nevra) == 0);
+  REQUIRE(dnf_backend_get_reinstallable_nevras(*snapshot, {}).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that streamed batches concatenate to the complete ordered result.
+// -----------------------------------------------------------------------------
+TEST_CASE("Streamed package batches match the complete browse result")
+{
+  reset_backend_globals();
+
+  std::vector<PackageRow> streamed;
+  size_t batches = 0;
+  size_t count = dnf_backend_get_browse_package_rows_streaming(nullptr, [&](std::vector<PackageRow> batch) {
+    REQUIRE(!batch.empty());
+    ++batches;
+    std::move(batch.begin(), batch.end(), std::back_inserter(streamed));
+  });
+
+  auto results = dnf_backend_get_browse_package_rows_interruptible(nullptr);
+  REQUIRE(count == streamed.size());
+  REQUIRE((streamed.empty() ? batches == 0 : batches > 0));
+  REQUIRE(results.size() == streamed.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    REQUIRE(results[i].nevra == streamed[i].nevra);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that streamed search batches match the complete search result.
+// -----------------------------------------------------------------------------
+TEST_CASE("Streamed package batches match the complete search result")
+{
+  reset_backend_globals();
+
+  std::vector<PackageRow> streamed;
+  size_t count = dnf_backend_search_package_rows_streaming("bash", nullptr, [&](std::vector<PackageRow> batch) {
+    std::move(batch.begin(), batch.end(), std::back_inserter(streamed));
+  });
+
+  auto results = dnf_backend_search_package_rows_interruptible("bash", nullptr);
+  REQUIRE(count == streamed.size());
+  REQUIRE(results.size() == streamed.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    REQUIRE(results[i].nevra == streamed[i].nevra);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a cancelled streaming query delivers no batches.
+// -----------------------------------------------------------------------------
+TEST_CASE("Cancelled streaming search delivers no batches")
+{
+  reset_backend_globals();
+
+  GCancellable *cancellable = g_cancellable_new();
+  g_cancellable_cancel(cancellable);
+
+  size_t batches = 0;
+  size_t count = dnf_backend_search_package_rows_streaming(
+      "bash", cancellable, [&](std::vector<PackageRow>) { ++batches; });
+
+  REQUIRE(count == 0);
+  REQUIRE(batches == 0);
+  g_object_unref(cancellable);
+}
+
 // -----------------------------------------------------------------------------
 // Package info tests (read-only)
 // -----------------------------------------------------------------------------
@@ -348,7 +948,39 @@ TEST_CASE("Dependency info contains expected section headers")
 }
 
 // -----------------------------------------------------------------------------
-// Verify that file list lookup returns either content or a friendly state.
+// Verify that the reverse-dependency index is built for one generation only and
+// that its "Required By" list comes from installed packages.
+// -----------------------------------------------------------------------------
+TEST_CASE("Installed reverse-dependency index follows the Base generation")
+{
+  reset_backend_globals();
+
+  BaseManager::instance().rebuild(BaseRebuildPolicy::FORCE);
+  REQUIRE_FALSE(dnf_backend_testonly_reverse_deps_is_current());
+
+  dnf_backend_warm_installed_reverse_deps(nullptr);
+  REQUIRE(dnf_backend_testonly_reverse_deps_is_current());
+
+  auto results = dnf_backend_search_package_rows_interruptible("bash", nullptr);
+  REQUIRE(!results.empty());
+  auto installed = dnf_backend_get_installed_package_rows_by_nevra(results.front().nevra);
+  if (!installed.empty()) {
+    auto deps = dnf_backend_get_package_deps(installed.front().nevra);
+    REQUIRE(deps.find("(installed packages only)") == std::string::npos);
+  }
+
+  BaseManager::instance().rebuild(BaseRebuildPolicy::FORCE);
+  REQUIRE_FALSE(dnf_backend_testonly_reverse_deps_is_current());
+
+  // A Dependencies lookup of an installed package rebuilds it lazily.
+  if (!installed.empty()) {
+    dnf_backend_get_package_deps(installed.front().nevra);
+    REQUIRE(dnf_backend_testonly_reverse_deps_is_current());
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that file list lookup returns either content or the not-installed state.
 // -----------------------------------------------------------------------------
 TEST_CASE("File list query is safe and returns valid state")
 {
@@ -357,16 +989,64 @@ TEST_CASE("File list query is safe and returns valid state")
   auto results = dnf_backend_search_package_rows_interruptible("bash", nullptr);
   REQUIRE(!results.empty());
 
-  auto files = dnf_backend_get_installed_package_files(results.front().nevra);
+  auto files = dnf_backend_get_installed_package_file_list(results.front().nevra);
+
+  // A package that is not installed has no file list.
+  if (!files.installed) {
+    REQUIRE(files.size() == 0);
+    REQUIRE(files.text.empty());
+    return;
+  }
+
+  // Every path is complete and the buffer is the newline-separated list.
+  REQUIRE(files.size() > 0);
+  size_t bytes = 0;
+  for (size_t i = 0; i < files.size(); ++i) {
+    REQUIRE(files.path(i).find('\n') == std::string_view::npos);
+    REQUIRE(files.text[files.offsets[i] + files.path(i).size()] == '\n');
+    bytes += files.path(i).size() + 1;
+  }
+  REQUIRE(bytes == files.text.size());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that changelog pages cover every entry once, newest first, and that a
+// repeated page comes back unchanged from the formatted-entry cache.
+// -----------------------------------------------------------------------------
+TEST_CASE("Changelog pages split the entries without gaps")
+{
+  reset_backend_globals();
 
-  // Either it is installed (returns file list)
-  // or not installed (returns friendly message).
-  bool is_not_installed_msg = files.find("File list available only for installed packages.") != std::string::npos;
+  auto results = dnf_backend_search_package_rows_interruptible("bash", nullptr);
+  REQUIRE(!results.empty());
+  const std::string &nevra = results.front().nevra;
 
-  bool has_content = !files.empty();
-  if (!is_not_installed_msg) {
-    REQUIRE(has_content);
+  auto first = dnf_backend_get_package_changelog_page(nevra, 0, 2);
+  REQUIRE(!first.text.empty());
+  if (first.total_entries == 0) {
+    REQUIRE(first.next_entry == 0);
+    return;
+  }
+  REQUIRE(first.next_entry == std::min<size_t>(2, first.total_entries));
+
+  std::string paged = first.text;
+  for (size_t next = first.next_entry; next < first.total_entries;) {
+    auto page = dnf_backend_get_package_changelog_page(nevra, next, 2);
+    REQUIRE(page.total_entries == first.total_entries);
+    REQUIRE(page.next_entry > next);
+    paged += page.text;
+    next = page.next_entry;
   }
+
+  auto all = dnf_backend_get_package_changelog_page(nevra, 0, first.total_entries);
+  REQUIRE(all.next_entry == all.total_entries);
+  REQUIRE(all.text == paged);
+  REQUIRE(dnf_backend_get_package_changelog_page(nevra, 0, 2).text == first.text);
+
+  // A page past the end is empty.
+  auto past = dnf_backend_get_package_changelog_page(nevra, first.total_entries, 2);
+  REQUIRE(past.text.empty());
+  REQUIRE(past.next_entry == first.total_entries);
 }
 
 // -----------------------------------------------------------------------------
@@ -433,6 +1113,70 @@ TEST_CASE("Exact installed checks use the cached installed NEVRA snapshot")
   REQUIRE_FALSE(dnf_backend_is_package_installed_exact(different_row));
 }
 
+// -----------------------------------------------------------------------------
+// Verify that a loaded installed snapshot keeps its view after a new one is
+// published, while later loads see the new state.
+// -----------------------------------------------------------------------------
+TEST_CASE("Loaded installed snapshots stay unchanged across refreshes")
+{
+  reset_backend_globals();
+
+  PackageRow row;
+  row.nevra = "demo-1.0-1.x86_64";
+  row.name = "demo";
+  row.arch = "x86_64";
+
+  dnf_backend_testonly_replace_installed_snapshot({ row.nevra });
+  const InstalledPackageSnapshotPtr before = dnf_backend_get_installed_snapshot();
+  REQUIRE(before);
+
+  dnf_backend_testonly_clear_installed_snapshot();
+  const InstalledPackageSnapshotPtr after = dnf_backend_get_installed_snapshot();
+  REQUIRE(after);
+  REQUIRE(after != before);
+
+  REQUIRE(dnf_backend_get_package_install_state(*before, row) == PackageInstallState::INSTALLED);
+  REQUIRE(dnf_backend_get_package_install_state(*after, row) == PackageInstallState::AVAILABLE);
+  REQUIRE(dnf_backend_get_package_install_state(row) == PackageInstallState::AVAILABLE);
+  REQUIRE(dnf_backend_installed_snapshot_size() == 0);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that batch classification matches the one-row lookups, in row order.
+// -----------------------------------------------------------------------------
+TEST_CASE("Batch classification matches per-row install state lookups")
+{
+  reset_backend_globals();
+
+  PackageRow local_row;
+  local_row.nevra = "demo-1.0-1.x86_64";
+  local_row.name = "demo";
+  local_row.arch = "x86_64";
+  local_row.repo_candidate_relation = PackageRepoCandidateRelation::NONE;
+
+  PackageRow available_row = local_row;
+  available_row.nevra = "demo-2.0-1.x86_64";
+  available_row.repo_candidate_relation = PackageRepoCandidateRelation::UNKNOWN;
+
+  dnf_backend_testonly_replace_installed_snapshot({ local_row.nevra });
+  const InstalledPackageSnapshotPtr installed = dnf_backend_get_installed_snapshot();
+
+  std::vector<PackageRow> rows { available_row, local_row };
+  std::vector<PackageRowClassification> classes = dnf_backend_classify_package_rows(*installed, rows);
+  REQUIRE(classes.size() == 2);
+  REQUIRE(classes[0].state == PackageInstallState::AVAILABLE);
+  REQUIRE_FALSE(classes[0].installed_exact);
+  REQUIRE(classes[1].state == PackageInstallState::LOCAL_ONLY);
+  REQUIRE(classes[1].installed_exact);
+  REQUIRE_FALSE(classes[1].self_protected);
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    REQUIRE(classes[i].state == dnf_backend_get_package_install_state(rows[i]));
+    REQUIRE(classes[i].installed_exact == dnf_backend_is_package_installed_exact(rows[i]));
+  }
+  REQUIRE(dnf_backend_classify_package_rows(*installed, {}).empty());
+}
+
 // -----------------------------------------------------------------------------
 // Verify that failed repo annotation does not make installed rows unusable.
 // -----------------------------------------------------------------------------
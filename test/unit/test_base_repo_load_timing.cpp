@@ -0,0 +1,46 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "base_repo_load_timing.hpp"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Verify that the report names the mode and describes each repository state.
+// -----------------------------------------------------------------------------
+TEST_CASE("Repository load report describes downloads and solv cache reuse")
+{
+  BaseRepoLoadReport report;
+  report.mode = "full";
+  report.total_us = 4500000;
+  report.succeeded = true;
+
+  BaseRepoLoadTiming downloaded;
+  downloaded.repo_id = "fedora";
+  downloaded.download_us = 3200000;
+  downloaded.metadata_downloaded = true;
+  report.repos.push_back(downloaded);
+
+  BaseRepoLoadTiming cached;
+  cached.repo_id = "updates";
+  cached.solv_cache_hit = true;
+  report.repos.push_back(cached);
+
+  BaseRepoLoadTiming failed;
+  failed.repo_id = "copr";
+  failed.download_us = 1000;
+  failed.download_failed = true;
+  report.repos.push_back(failed);
+
+  const std::string text = base_repo_load_report_format(report);
+  REQUIRE(text.find("Repository load (full): 4500 ms, ok\n") == 0);
+  REQUIRE(text.find("  fedora: downloaded in 3200 ms, solv cache miss\n") != std::string::npos);
+  REQUIRE(text.find("  updates: cached metadata, solv cache hit\n") != std::string::npos);
+  REQUIRE(text.find("  copr: download failed after 1 ms, solv cache miss\n") != std::string::npos);
+
+  report.succeeded = false;
+  REQUIRE(base_repo_load_report_format(report).find("4500 ms, failed\n") != std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,155 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "base_state_fingerprint.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+// -----------------------------------------------------------------------------
+// Write text to one file, replacing any previous content.
+// -----------------------------------------------------------------------------
+static void
+write_file(const std::filesystem::path &path, const std::string &text)
+{
+  std::ofstream out(path, std::ios::trunc);
+  out << text;
+}
+
+// -----------------------------------------------------------------------------
+// Verify that file stamps are sorted, skip missing directories, and change
+// when a file is rewritten with a different size.
+// -----------------------------------------------------------------------------
+TEST_CASE("Base state file stamps track directory contents")
+{
+  gchar *tmp = g_dir_make_tmp("dnfui-fingerprint-XXXXXX", nullptr);
+  REQUIRE(tmp != nullptr);
+  const std::filesystem::path dir(tmp);
+  g_free(tmp);
+
+  write_file(dir / "b.repo", "[b]\n");
+  write_file(dir / "a.repo", "[a]\n");
+  std::filesystem::create_directory(dir / "subdir");
+
+  const std::vector<std::string> directories = { dir.string(), (dir / "missing").string() };
+  const auto before = base_state_fingerprint_file_stamps(directories);
+  REQUIRE(before.size() == 2);
+  REQUIRE(before[0].find("a.repo") != std::string::npos);
+  REQUIRE(before[1].find("b.repo") != std::string::npos);
+  REQUIRE(base_state_fingerprint_file_stamps(directories) == before);
+
+  write_file(dir / "a.repo", "[a]\nenabled=0\n");
+  REQUIRE(base_state_fingerprint_file_stamps(directories) != before);
+
+  std::filesystem::remove_all(dir);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that installed-state stamps cover the rpmdb and the libdnf5 system
+// state, and leave out SQLite shared-memory files.
+// -----------------------------------------------------------------------------
+TEST_CASE("Installed state stamps track the rpmdb and libdnf5 system state")
+{
+  gchar *tmp = g_dir_make_tmp("dnfui-installroot-XXXXXX", nullptr);
+  REQUIRE(tmp != nullptr);
+  const std::filesystem::path root(tmp);
+  g_free(tmp);
+
+  const std::filesystem::path rpmdb = root / "usr/lib/sysimage/rpm";
+  const std::filesystem::path state = root / "usr/lib/sysimage/libdnf5";
+  std::filesystem::create_directories(rpmdb);
+  std::filesystem::create_directories(state);
+  write_file(rpmdb / "rpmdb.sqlite", "db");
+  write_file(rpmdb / "rpmdb.sqlite-shm", "shm");
+  write_file(state / "packages.toml", "reason = \"user\"\n");
+
+  REQUIRE(base_state_fingerprint_installed_state_directories(root.string()).size() == 3);
+  REQUIRE_FALSE(base_state_fingerprint_tracks_file((rpmdb / "rpmdb.sqlite-shm").string()));
+  REQUIRE(base_state_fingerprint_tracks_file((rpmdb / "rpmdb.sqlite-wal").string()));
+
+  const auto before = base_state_fingerprint_installed_state_stamps(root.string());
+  REQUIRE(before.size() == 2);
+  REQUIRE(before[0].find("libdnf5/packages.toml") != std::string::npos);
+  REQUIRE(before[1].find("rpm/rpmdb.sqlite ") != std::string::npos);
+
+  write_file(rpmdb / "rpmdb.sqlite-shm", "shared memory rewritten by a reader");
+  REQUIRE(base_state_fingerprint_installed_state_stamps(root.string()) == before);
+
+  write_file(state / "packages.toml", "reason = \"dependency\"\n");
+  REQUIRE(base_state_fingerprint_installed_state_stamps(root.string()) != before);
+
+  std::filesystem::remove_all(root);
+}
+
+// -----------------------------------------------------------------------------
+// Verify the input comparison and the metadata expiry window.
+// -----------------------------------------------------------------------------
+TEST_CASE("Base state fingerprint compares inputs and metadata expiry")
+{
+  BaseStateFingerprint first;
+  first.includes_repos = true;
+  first.rpmdb_files = { "/usr/lib/sysimage/rpm/rpmdb.sqlite 10 1" };
+  first.repo_entries = { "fedora /var/cache/repomd.xml 5 1" };
+  first.metadata_expire_seconds = 60;
+  first.captured_at = std::chrono::steady_clock::now();
+
+  BaseStateFingerprint second = first;
+  second.captured_at = first.captured_at + std::chrono::seconds(5);
+  REQUIRE(first.same_inputs(second));
+
+  second.rpmdb_files = { "/usr/lib/sysimage/rpm/rpmdb.sqlite 12 2" };
+  REQUIRE_FALSE(first.same_inputs(second));
+
+  REQUIRE_FALSE(first.metadata_may_be_expired(first.captured_at + std::chrono::seconds(59)));
+  REQUIRE(first.metadata_may_be_expired(first.captured_at + std::chrono::seconds(60)));
+
+  first.metadata_expire_seconds = -1;
+  REQUIRE_FALSE(first.metadata_may_be_expired(first.captured_at + std::chrono::hours(24)));
+
+  first.metadata_expire_seconds = 0;
+  first.includes_repos = false;
+  REQUIRE_FALSE(first.metadata_may_be_expired(first.captured_at + std::chrono::hours(24)));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that only the entry of the named repo is ignored, and that enabling
+// or disabling that repo, or any other change, still counts.
+// -----------------------------------------------------------------------------
+TEST_CASE("Base state fingerprint ignores the entry of one refreshed repo")
+{
+  BaseStateFingerprint before;
+  before.includes_repos = true;
+  before.rpmdb_files = { "/usr/lib/sysimage/rpm/rpmdb.sqlite 10 1" };
+  before.repo_entries = { "fedora /var/cache/fedora/repodata/repomd.xml 5 1",
+                          "updates /var/cache/updates/repodata/repomd.xml 7 1",
+                          "/etc/yum.repos.d/fedora.repo 100 1" };
+
+  BaseStateFingerprint after = before;
+  after.repo_entries[1] = "updates /var/cache/updates/repodata/repomd.xml 9 2";
+  REQUIRE_FALSE(before.same_inputs(after));
+  REQUIRE(before.same_inputs_except_repo(after, "updates"));
+  REQUIRE_FALSE(before.same_inputs_except_repo(after, "fedora"));
+  REQUIRE_FALSE(before.same_inputs_except_repo(after, "update"));
+
+  after.repo_entries[1] = "updates no-cache";
+  REQUIRE(before.same_inputs_except_repo(after, "updates"));
+
+  after.repo_entries.erase(after.repo_entries.begin() + 1);
+  REQUIRE_FALSE(before.same_inputs_except_repo(after, "updates"));
+
+  after = before;
+  after.repo_entries[2] = "/etc/yum.repos.d/fedora.repo 120 2";
+  REQUIRE_FALSE(before.same_inputs_except_repo(after, "updates"));
+
+  after = before;
+  after.rpmdb_files = { "/usr/lib/sysimage/rpm/rpmdb.sqlite 12 2" };
+  REQUIRE_FALSE(before.same_inputs_except_repo(after, "updates"));
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
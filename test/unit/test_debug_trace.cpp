@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------------
+// Debug trace tests
+// Covers the runtime gate, per-thread rings, cut lines, and dropped lines.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "debug_trace.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Return true when line ends with suffix.
+// -----------------------------------------------------------------------------
+static bool
+trace_line_ends_with(const std::string &line, const std::string &suffix)
+{
+  return line.size() >= suffix.size() && line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a disabled trace point records nothing and skips its arguments.
+// -----------------------------------------------------------------------------
+TEST_CASE("Debug trace records nothing while disabled")
+{
+  debug_trace_testonly_set_enabled(false);
+  int evaluated = 0;
+  DNFUI_TRACE("skipped %d", ++evaluated);
+
+  REQUIRE(evaluated == 0);
+  REQUIRE(debug_trace_testonly_drain().empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that lines from several threads are drained with their thread ids in
+// time order.
+// -----------------------------------------------------------------------------
+TEST_CASE("Debug trace drains lines from every thread")
+{
+  debug_trace_testonly_set_enabled(true);
+  DNFUI_TRACE("main first");
+  std::thread worker([]() { DNFUI_TRACE("worker line=%d", 7); });
+  worker.join();
+  DNFUI_TRACE("main last");
+
+  const std::vector<std::string> lines = debug_trace_testonly_drain();
+  debug_trace_testonly_set_enabled(false);
+  REQUIRE(lines.size() == 3);
+  REQUIRE(lines[0].rfind("[trace] ", 0) == 0);
+  REQUIRE(trace_line_ends_with(lines[0], " main first"));
+  REQUIRE(trace_line_ends_with(lines[1], " worker line=7"));
+  REQUIRE(trace_line_ends_with(lines[2], " main last"));
+
+  const std::string main_thread = lines[0].substr(lines[0].find(" t"), lines[0].find(" main") - lines[0].find(" t"));
+  REQUIRE(lines[2].find(main_thread + " ") != std::string::npos);
+  REQUIRE(lines[1].find(main_thread + " ") == std::string::npos);
+  REQUIRE(debug_trace_testonly_drain().empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a long line is cut and marked, and that a full ring counts the
+// lines it could not keep instead of blocking.
+// -----------------------------------------------------------------------------
+TEST_CASE("Debug trace cuts long lines and counts dropped ones")
+{
+  debug_trace_testonly_set_enabled(true);
+  const std::string long_text(1000, 'x');
+  DNFUI_TRACE("%s", long_text.c_str());
+  std::vector<std::string> lines = debug_trace_testonly_drain();
+  REQUIRE(lines.size() == 1);
+  REQUIRE(lines[0].size() < 300);
+  REQUIRE(trace_line_ends_with(lines[0], "xxx..."));
+
+  for (int i = 0; i < 5000; ++i) {
+    DNFUI_TRACE("line %d", i);
+  }
+  lines = debug_trace_testonly_drain();
+  debug_trace_testonly_set_enabled(false);
+  REQUIRE(lines.size() < 5000);
+  REQUIRE(trace_line_ends_with(lines.front(), " line 0"));
+
+  bool saw_dropped = false;
+  for (const auto &line : lines) {
+    if (line.find("dropped " + std::to_string(5000 - (lines.size() - 1)) + " trace lines") != std::string::npos) {
+      saw_dropped = true;
+    }
+  }
+  REQUIRE(saw_dropped);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
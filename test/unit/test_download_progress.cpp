@@ -0,0 +1,88 @@
+// -----------------------------------------------------------------------------
+// test/unit/test_download_progress.cpp
+// Aggregate download progress tests
+// Covers how parallel package downloads are summed into one byte count, how
+// the transfer rate is sampled, and when an aggregate event is due.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "dnf_backend/dnf_download_progress.hpp"
+
+#include <chrono>
+#include <string>
+
+using namespace std::chrono_literals;
+
+// -----------------------------------------------------------------------------
+// Verify that parallel downloads add up and events follow the interval.
+// -----------------------------------------------------------------------------
+TEST_CASE("Download progress sums parallel downloads at a bounded rate")
+{
+  const auto t0 = DownloadProgressAggregator::Clock::time_point();
+  DownloadProgressAggregator totals(250ms);
+
+  const size_t a = totals.start(1000, t0);
+  const size_t b = totals.start(3000, t0);
+  REQUIRE(totals.current().bytes_total == 4000);
+  REQUIRE(totals.current().active_downloads == 2);
+
+  REQUIRE_FALSE(totals.update(a, 1000, 500, t0 + 100ms));
+  REQUIRE(totals.update(b, 3000, 1500, t0 + 500ms));
+
+  TransactionDownloadProgress progress = totals.current();
+  REQUIRE(progress.bytes_done == 2000);
+  REQUIRE(progress.bytes_per_second == 4000);
+
+  // The next event waits for the interval again.
+  REQUIRE_FALSE(totals.update(a, 1000, 1000, t0 + 600ms));
+  REQUIRE_FALSE(totals.finish(a, DownloadOutcome::DOWNLOADED, t0 + 650ms));
+  REQUIRE(totals.current().active_downloads == 1);
+
+  // The last download to end always publishes.
+  REQUIRE(totals.finish(b, DownloadOutcome::DOWNLOADED, t0 + 700ms));
+  progress = totals.current();
+  REQUIRE(progress.bytes_done == 4000);
+  REQUIRE(progress.bytes_total == 4000);
+  REQUIRE(progress.active_downloads == 0);
+  REQUIRE(totals.transferred_bytes() == 2500);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that present files count as done and failed downloads leave the totals.
+// -----------------------------------------------------------------------------
+TEST_CASE("Download progress settles present and failed downloads")
+{
+  const auto t0 = DownloadProgressAggregator::Clock::time_point();
+  DownloadProgressAggregator totals(250ms);
+
+  const size_t present = totals.start(1000, t0);
+  const size_t failed = totals.start(2000, t0);
+  const size_t unknown = totals.start(0, t0);
+
+  totals.update(failed, 2000, 800, t0 + 10ms);
+  totals.update(unknown, 500, 100, t0 + 20ms);
+  REQUIRE(totals.current().bytes_total == 3500);
+
+  totals.finish(present, DownloadOutcome::ALREADY_PRESENT, t0 + 30ms);
+  totals.finish(failed, DownloadOutcome::FAILED, t0 + 40ms);
+
+  TransactionDownloadProgress progress = totals.current();
+  REQUIRE(progress.bytes_total == 1500);
+  REQUIRE(progress.bytes_done == 1100);
+  REQUIRE(progress.active_downloads == 1);
+  // Present files were never transferred, and failed bytes stay transferred.
+  REQUIRE(totals.transferred_bytes() == 900);
+
+  // Ending a slot twice changes nothing.
+  REQUIRE_FALSE(totals.finish(failed, DownloadOutcome::DOWNLOADED, t0 + 50ms));
+  REQUIRE(totals.current().bytes_total == 1500);
+}
+
+// -----------------------------------------------------------------------------
+// Verify the download summary line format.
+// -----------------------------------------------------------------------------
+TEST_CASE("Download progress summary reports size, time, and rate")
+{
+  REQUIRE(download_progress_format_summary(8 * 1024 * 1024, 4s) == "Downloaded 8.0 MiB in 4.0 s (2.0 MiB/s).");
+  REQUIRE(download_progress_format_summary(1024 * 1024, 0s) == "Downloaded 1.0 MiB in 0.0 s (0.0 MiB/s).");
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "dnf_backend/dnf_name_arch_map.hpp"
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Verify that interned keys are stable and distinguish name and arch fields.
+// -----------------------------------------------------------------------------
+TEST_CASE("Name and arch interner returns stable distinct keys")
+{
+  NameArchInterner interner;
+
+  const uint64_t bash_x86 = interner.key_for("bash", "x86_64");
+  const uint64_t bash_noarch = interner.key_for("bash", "noarch");
+  const uint64_t zsh_x86 = interner.key_for("zsh", "x86_64");
+
+  REQUIRE(interner.key_for("bash", "x86_64") == bash_x86);
+  REQUIRE(bash_x86 != bash_noarch);
+  REQUIRE(bash_x86 != zsh_x86);
+  REQUIRE(bash_noarch != zsh_x86);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the slot map keeps the first slot for a key and reports misses.
+// -----------------------------------------------------------------------------
+TEST_CASE("Name and arch slot map keeps first inserted slot")
+{
+  NameArchInterner interner;
+  NameArchSlotMap slots(4);
+
+  const uint64_t key = interner.key_for("bash", "x86_64");
+  auto [first_slot, first_inserted] = slots.try_emplace(key, 3);
+  auto [second_slot, second_inserted] = slots.try_emplace(key, 7);
+
+  REQUIRE(first_inserted);
+  REQUIRE(first_slot == 3);
+  REQUIRE_FALSE(second_inserted);
+  REQUIRE(second_slot == 3);
+  REQUIRE(slots.find(key) == 3);
+  REQUIRE(slots.find(interner.key_for("zsh", "x86_64")) == NameArchSlotMap::kNoSlot);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a slot map sized for many keys finds every inserted key.
+// -----------------------------------------------------------------------------
+TEST_CASE("Name and arch slot map finds every key at full expected size")
+{
+  NameArchInterner interner;
+  constexpr uint32_t kKeyCount = 5000;
+  NameArchSlotMap slots(kKeyCount);
+
+  std::set<uint64_t> keys;
+  for (uint32_t i = 0; i < kKeyCount; ++i) {
+    uint64_t key = interner.key_for("pkg-" + std::to_string(i), i % 2 ? "x86_64" : "noarch");
+    keys.insert(key);
+    REQUIRE(slots.try_emplace(key, i).second);
+  }
+
+  REQUIRE(keys.size() == kKeyCount);
+  for (uint32_t i = 0; i < kKeyCount; ++i) {
+    INFO(i);
+    REQUIRE(slots.find(interner.key_for("pkg-" + std::to_string(i), i % 2 ? "x86_64" : "noarch")) == i);
+  }
+}
@@ -57,43 +57,6 @@ struct ScopedEnvironmentOverride {
   std::string value;
 };
 
-// -----------------------------------------------------------------------------
-// Return true when the private test bus reports that the service name is owned.
-// -----------------------------------------------------------------------------
-static bool
-wait_for_bus_name_owner(GDBusConnection *connection, const char *service_name, int timeout_ms)
-{
-  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
-
-  while (std::chrono::steady_clock::now() < deadline) {
-    GError *error = nullptr;
-    GVariant *reply = g_dbus_connection_call_sync(connection,
-                                                  "org.freedesktop.DBus",
-                                                  "/org/freedesktop/DBus",
-                                                  "org.freedesktop.DBus",
-                                                  "NameHasOwner",
-                                                  g_variant_new("(s)", service_name),
-                                                  G_VARIANT_TYPE("(b)"),
-                                                  G_DBUS_CALL_FLAGS_NONE,
-                                                  -1,
-                                                  nullptr,
-                                                  &error);
-    if (reply) {
-      gboolean has_owner = FALSE;
-      g_variant_get(reply, "(b)", &has_owner);
-      g_variant_unref(reply);
-      if (has_owner) {
-        return true;
-      }
-    }
-
-    g_clear_error(&error);
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-  }
-
-  return false;
-}
-
 } // namespace
 
 // -----------------------------------------------------------------------------
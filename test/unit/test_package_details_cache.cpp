@@ -0,0 +1,97 @@
+// -----------------------------------------------------------------------------
+// Package details cache tests
+// Covers generation checks, recency order, and the shared byte budget.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/package_details_cache.hpp"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Verify that cached text is returned per tab for the same generation only.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package details cache returns text for matching tab and generation")
+{
+  package_details_cache_reset_for_tests(1024);
+
+  package_details_cache_store("demo-1-1.x86_64", PackageDetailsTab::INFO, 7, "info");
+  package_details_cache_store("demo-1-1.x86_64", PackageDetailsTab::DEPS, 7, "deps");
+
+  std::string text;
+  REQUIRE(package_details_cache_lookup("demo-1-1.x86_64", PackageDetailsTab::INFO, 7, text));
+  REQUIRE(text == "info");
+  REQUIRE(package_details_cache_lookup("demo-1-1.x86_64", PackageDetailsTab::DEPS, 7, text));
+  REQUIRE(text == "deps");
+  REQUIRE_FALSE(package_details_cache_lookup("demo-1-1.x86_64", PackageDetailsTab::FILES, 7, text));
+  REQUIRE_FALSE(package_details_cache_lookup("other-1-1.x86_64", PackageDetailsTab::INFO, 7, text));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a newer generation drops every older entry.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package details cache drops entries from older generations")
+{
+  package_details_cache_reset_for_tests(1024);
+
+  package_details_cache_store("demo-1-1.x86_64", PackageDetailsTab::INFO, 7, "info");
+
+  std::string text;
+  REQUIRE_FALSE(package_details_cache_lookup("demo-1-1.x86_64", PackageDetailsTab::INFO, 8, text));
+  REQUIRE(package_details_cache_bytes_for_tests() == 0);
+
+  // A late store from the old generation is ignored.
+  package_details_cache_store("demo-1-1.x86_64", PackageDetailsTab::INFO, 7, "info");
+  REQUIRE_FALSE(package_details_cache_lookup("demo-1-1.x86_64", PackageDetailsTab::INFO, 7, text));
+  REQUIRE(package_details_cache_bytes_for_tests() == 0);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the least recently used entries are evicted to fit the budget.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package details cache evicts least recently used entries")
+{
+  // Each entry is a 3-byte NEVRA, the 2-byte tab suffix, and 10 bytes of text.
+  package_details_cache_reset_for_tests(45);
+  const std::string text10(10, 'x');
+
+  package_details_cache_store("aaa", PackageDetailsTab::INFO, 1, text10);
+  package_details_cache_store("bbb", PackageDetailsTab::INFO, 1, text10);
+  package_details_cache_store("ccc", PackageDetailsTab::INFO, 1, text10);
+  REQUIRE(package_details_cache_bytes_for_tests() == 45);
+
+  // Touch the oldest entry so the next store evicts "bbb" instead.
+  std::string text;
+  REQUIRE(package_details_cache_lookup("aaa", PackageDetailsTab::INFO, 1, text));
+  package_details_cache_store("ddd", PackageDetailsTab::INFO, 1, text10);
+
+  REQUIRE(package_details_cache_bytes_for_tests() == 45);
+  REQUIRE(package_details_cache_lookup("aaa", PackageDetailsTab::INFO, 1, text));
+  REQUIRE_FALSE(package_details_cache_lookup("bbb", PackageDetailsTab::INFO, 1, text));
+  REQUIRE(package_details_cache_lookup("ccc", PackageDetailsTab::INFO, 1, text));
+  REQUIRE(package_details_cache_lookup("ddd", PackageDetailsTab::INFO, 1, text));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that replacing an entry updates the byte count and that text larger
+// than the whole budget is not cached.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package details cache replaces entries and skips oversized text")
+{
+  package_details_cache_reset_for_tests(45);
+
+  package_details_cache_store("aaa", PackageDetailsTab::FILES, 1, std::string(10, 'x'));
+  package_details_cache_store("aaa", PackageDetailsTab::FILES, 1, "short");
+  REQUIRE(package_details_cache_bytes_for_tests() == 10);
+
+  std::string text;
+  REQUIRE(package_details_cache_lookup("aaa", PackageDetailsTab::FILES, 1, text));
+  REQUIRE(text == "short");
+
+  package_details_cache_store("bbb", PackageDetailsTab::FILES, 1, std::string(100, 'x'));
+  REQUIRE_FALSE(package_details_cache_lookup("bbb", PackageDetailsTab::FILES, 1, text));
+  REQUIRE(package_details_cache_bytes_for_tests() == 10);
+
+  package_details_cache_clear();
+  REQUIRE(package_details_cache_bytes_for_tests() == 0);
+}
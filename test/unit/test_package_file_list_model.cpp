@@ -0,0 +1,117 @@
+// -----------------------------------------------------------------------------
+// Package file list model tests
+// Covers path offsets, ASCII case-insensitive filtering, and the copied text.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/package_file_list_model.hpp"
+
+#include <memory>
+#include <string>
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Return the string of the visible path at one position.
+// -----------------------------------------------------------------------------
+std::string
+path_at(DnfuiPackageFileListModel *model, guint position)
+{
+  GtkStringObject *item = GTK_STRING_OBJECT(g_list_model_get_item(G_LIST_MODEL(model), position));
+  std::string path = gtk_string_object_get_string(item);
+  g_object_unref(item);
+  return path;
+}
+
+// -----------------------------------------------------------------------------
+// Return the visible bytes of the model as a string.
+// -----------------------------------------------------------------------------
+std::string
+visible_text(DnfuiPackageFileListModel *model)
+{
+  GBytes *bytes = package_file_list_model_get_visible_bytes(model);
+  gsize size = 0;
+  const char *data = static_cast<const char *>(g_bytes_get_data(bytes, &size));
+  std::string text(data ? data : "", size);
+  g_bytes_unref(bytes);
+  return text;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Verify that text round-trips into offsets and paths.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package file list is rebuilt from newline-separated text")
+{
+  PackageFileList files = package_file_list_from_text("/usr/bin/bash\n/usr/share/doc/bash/README\n");
+
+  REQUIRE(files.installed);
+  REQUIRE(files.size() == 2);
+  REQUIRE(files.path(0) == "/usr/bin/bash");
+  REQUIRE(files.path(1) == "/usr/share/doc/bash/README");
+
+  REQUIRE(package_file_list_from_text("").size() == 0);
+  REQUIRE(package_file_list_from_text("/etc/motd").path(0) == "/etc/motd");
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the filter ignores ASCII case and narrows the visible paths.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package file list model filters paths")
+{
+  DnfuiPackageFileListModel *model = package_file_list_model_new();
+  package_file_list_model_set_files(model,
+                                    std::make_shared<const PackageFileList>(package_file_list_from_text(
+                                        "/usr/bin/bash\n/usr/share/doc/bash/README\n/usr/share/man/man1/bash.1.gz\n")));
+
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 3);
+  REQUIRE(package_file_list_model_get_total(model) == 3);
+
+  package_file_list_model_set_filter(model, "SHARE");
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 2);
+  REQUIRE(path_at(model, 0) == "/usr/share/doc/bash/README");
+
+  // A longer filter narrows, and a different one checks every path again.
+  package_file_list_model_set_filter(model, "share/man");
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 1);
+  REQUIRE(path_at(model, 0) == "/usr/share/man/man1/bash.1.gz");
+
+  package_file_list_model_set_filter(model, "bin");
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 1);
+  REQUIRE(path_at(model, 0) == "/usr/bin/bash");
+
+  package_file_list_model_set_filter(model, "");
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 3);
+  REQUIRE(package_file_list_model_get_total(model) == 3);
+
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the copied text matches the visible paths and that the filter
+// stays applied to the next list.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package file list model copies the visible paths")
+{
+  DnfuiPackageFileListModel *model = package_file_list_model_new();
+  REQUIRE(visible_text(model).empty());
+
+  package_file_list_model_set_files(
+      model, std::make_shared<const PackageFileList>(package_file_list_from_text("/a/one\n/b/two\n/a/three\n")));
+  REQUIRE(visible_text(model) == "/a/one\n/b/two\n/a/three\n");
+
+  package_file_list_model_set_filter(model, "/a/");
+  REQUIRE(visible_text(model) == "/a/one\n/a/three\n");
+
+  package_file_list_model_set_files(
+      model, std::make_shared<const PackageFileList>(package_file_list_from_text("/b/four\n/a/five\n")));
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 1);
+  REQUIRE(visible_text(model) == "/a/five\n");
+
+  package_file_list_model_set_files(model, nullptr);
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 0);
+  REQUIRE(package_file_list_model_get_total(model) == 0);
+
+  g_object_unref(model);
+}
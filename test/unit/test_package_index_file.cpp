@@ -0,0 +1,157 @@
+// -----------------------------------------------------------------------------
+// Package index file tests
+// Covers the mapped round trip, name matching, and the rejection of outdated
+// or damaged files.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "dnf_backend/dnf_index_file.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+// -----------------------------------------------------------------------------
+// Return one encoder row.
+// -----------------------------------------------------------------------------
+static PackageIndexFileRow
+make_index_file_row(const std::string &name,
+                    const std::string &arch,
+                    const std::string &repo,
+                    PackageInstallState state)
+{
+  PackageIndexFileRow row;
+  row.row.nevra = name + "-1.0-1.fc40." + arch;
+  row.row.name = name;
+  row.row.epoch = "0";
+  row.row.version = "1.0";
+  row.row.release = "1.fc40";
+  row.row.arch = arch;
+  row.row.repo = repo;
+  row.row.summary = "Summary of " + name;
+  row.state = state;
+  for (char c : name) {
+    row.name_folded.push_back(g_ascii_tolower(c));
+  }
+  return row;
+}
+
+// -----------------------------------------------------------------------------
+// Return a small index with an installed, an upgradeable, and an available row.
+// -----------------------------------------------------------------------------
+static std::vector<PackageIndexFileRow>
+make_index_file_rows()
+{
+  std::vector<PackageIndexFileRow> rows = {
+    make_index_file_row("bash", "x86_64", "@System", PackageInstallState::INSTALLED),
+    make_index_file_row("Demo", "noarch", "fedora", PackageInstallState::UPGRADEABLE),
+    make_index_file_row("demo-doc", "noarch", "fedora", PackageInstallState::AVAILABLE),
+  };
+  rows[0].row.install_reason = PackageInstallReason::USER;
+  rows[0].row.repo_candidate_relation = PackageRepoCandidateRelation::SAME;
+  return rows;
+}
+
+// -----------------------------------------------------------------------------
+// Scratch directory removed at the end of a test.
+// -----------------------------------------------------------------------------
+struct ScratchDir {
+  std::filesystem::path path;
+
+  ScratchDir()
+  {
+    gchar *tmp = g_dir_make_tmp("dnfui-index-file-XXXXXX", nullptr);
+    path = tmp ? tmp : "";
+    g_free(tmp);
+  }
+
+  ~ScratchDir()
+  {
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Verify that a written file maps back to the same rows and states.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package index file maps back the written rows")
+{
+  ScratchDir dir;
+  REQUIRE_FALSE(dir.path.empty());
+  const std::string path = (dir.path / "index.bin").string();
+  const std::vector<std::string> key = { "/var/lib/rpm/rpmdb.sqlite 4096 1", "fedora repomd.xml 512 2" };
+  const std::vector<PackageIndexFileRow> rows = make_index_file_rows();
+
+  REQUIRE(package_index_file_write(path, package_index_file_encode(key, rows)));
+  auto file = PackageIndexFile::map(path, key);
+  REQUIRE(file);
+  REQUIRE(file->size() == rows.size());
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    PackageRow row = file->row(i);
+    REQUIRE(row.nevra == rows[i].row.nevra);
+    REQUIRE(row.name == rows[i].row.name);
+    REQUIRE(row.epoch == rows[i].row.epoch);
+    REQUIRE(row.version == rows[i].row.version);
+    REQUIRE(row.release == rows[i].row.release);
+    REQUIRE(row.arch == rows[i].row.arch);
+    REQUIRE(row.repo == rows[i].row.repo);
+    REQUIRE(row.summary == rows[i].row.summary);
+    REQUIRE(row.install_reason == rows[i].row.install_reason);
+    REQUIRE(row.repo_candidate_relation == rows[i].row.repo_candidate_relation);
+    REQUIRE(file->state(i) == rows[i].state);
+  }
+
+  REQUIRE(file->field(1, PackageIndexFileField::NAME_FOLDED) == "demo");
+  const std::vector<uint32_t> substring_ids = { 1, 2 };
+  const std::vector<uint32_t> exact_ids = { 1 };
+  REQUIRE(file->match_name("demo", false) == substring_ids);
+  REQUIRE(file->match_name("demo", true) == exact_ids);
+  REQUIRE(file->match_name("zsh", false).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a changed key, a truncated file, or another format version is
+// rejected.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package index file rejects outdated and damaged files")
+{
+  ScratchDir dir;
+  REQUIRE_FALSE(dir.path.empty());
+  const std::string path = (dir.path / "index.bin").string();
+  const std::vector<std::string> key = { "/var/lib/rpm/rpmdb.sqlite 4096 1" };
+  const std::string data = package_index_file_encode(key, make_index_file_rows());
+
+  REQUIRE_FALSE(PackageIndexFile::map(path, key));
+
+  REQUIRE(package_index_file_write(path, data));
+  REQUIRE(PackageIndexFile::map(path, key));
+  REQUIRE_FALSE(PackageIndexFile::map(path, { "/var/lib/rpm/rpmdb.sqlite 4096 2" }));
+
+  for (size_t size : { size_t { 1 }, size_t { 39 }, data.size() / 2, data.size() - 1 }) {
+    REQUIRE(package_index_file_write(path, data.substr(0, size)));
+    REQUIRE_FALSE(PackageIndexFile::map(path, key));
+  }
+
+  std::string other_version = data;
+  other_version[8] = 2;
+  REQUIRE(package_index_file_write(path, other_version));
+  REQUIRE_FALSE(PackageIndexFile::map(path, key));
+
+  // A string offset past the string table is damage, not a longer row.
+  std::string bad_offset = data;
+  size_t records_offset = 0;
+  for (int i = 0; i < 4; ++i) {
+    records_offset |= static_cast<size_t>(static_cast<unsigned char>(data[28 + i])) << (8 * i);
+  }
+  bad_offset[records_offset + 3] = 0x7f;
+  REQUIRE(package_index_file_write(path, bad_offset));
+  REQUIRE_FALSE(PackageIndexFile::map(path, key));
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,391 @@
+// -----------------------------------------------------------------------------
+// Package list model tests
+// Covers sorted appends, NEVRA merges, in-place updates, item object reuse,
+// stored row access, and the items-changed spans the model announces.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/package_list_model.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+// One recorded items-changed emission.
+struct ItemsChanged {
+  guint position;
+  guint removed;
+  guint added;
+};
+
+// -----------------------------------------------------------------------------
+// Build one package item with the given NEVRA, name, and summary.
+// -----------------------------------------------------------------------------
+PackageItem
+make_item(const std::string &nevra, const std::string &name, const std::string &summary = {})
+{
+  PackageItem item;
+  item.row.nevra = nevra;
+  item.row.name = name;
+  item.row.summary = summary;
+  return item;
+}
+
+// -----------------------------------------------------------------------------
+// Return the visible NEVRAs in model order.
+// -----------------------------------------------------------------------------
+std::vector<std::string>
+visible_nevras(DnfuiPackageListModel *model)
+{
+  std::vector<std::string> nevras;
+  guint n_items = g_list_model_get_n_items(G_LIST_MODEL(model));
+  for (guint i = 0; i < n_items; ++i) {
+    GObject *obj = G_OBJECT(g_list_model_get_item(G_LIST_MODEL(model), i));
+    nevras.push_back(package_list_model_item_from_object(obj)->row.nevra);
+    g_object_unref(obj);
+  }
+  return nevras;
+}
+
+// -----------------------------------------------------------------------------
+// Record every items-changed emission of one model.
+// -----------------------------------------------------------------------------
+void
+record_items_changed(DnfuiPackageListModel *model, std::vector<ItemsChanged> &changes)
+{
+  g_signal_connect(model,
+                   "items-changed",
+                   G_CALLBACK(+[](GListModel *, guint position, guint removed, guint added, gpointer user_data) {
+                     static_cast<std::vector<ItemsChanged> *>(user_data)->push_back({ position, removed, added });
+                   }),
+                   &changes);
+}
+
+// -----------------------------------------------------------------------------
+// Order rows by package name.
+// -----------------------------------------------------------------------------
+int
+compare_by_name(const PackageItem &lhs, const PackageItem &rhs)
+{
+  return lhs.row.name.compare(rhs.row.name);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Verify that appends keep insertion order until a compare is set, and that
+// sorted appends land at their sorted positions.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package list model sorts through its index permutation")
+{
+  DnfuiPackageListModel *model = package_list_model_new();
+  package_list_model_append(model, { make_item("c-1-1.x86_64", "c"), make_item("a-1-1.x86_64", "a") });
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "c-1-1.x86_64", "a-1-1.x86_64" });
+
+  package_list_model_set_compare(model, compare_by_name);
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "a-1-1.x86_64", "c-1-1.x86_64" });
+
+  std::vector<ItemsChanged> changes;
+  record_items_changed(model, changes);
+  package_list_model_append(model, { make_item("b-1-1.x86_64", "b") });
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "a-1-1.x86_64", "b-1-1.x86_64", "c-1-1.x86_64" });
+  REQUIRE(changes.size() == 1);
+  REQUIRE(changes[0].position == 1);
+  REQUIRE(changes[0].removed == 0);
+  REQUIRE(changes[0].added == 1);
+
+  guint position = 0;
+  REQUIRE(package_list_model_find(model, "c-1-1.x86_64", position));
+  REQUIRE(position == 2);
+  REQUIRE_FALSE(package_list_model_find(model, "d-1-1.x86_64", position));
+
+  package_list_model_set_compare(model, nullptr);
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "c-1-1.x86_64", "a-1-1.x86_64", "b-1-1.x86_64" });
+
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a merge keeps unchanged rows and their item objects, applies
+// changed values, and drops rows that were not appended again.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package list model merges refreshed rows by NEVRA")
+{
+  DnfuiPackageListModel *model = package_list_model_new();
+  package_list_model_append(model,
+                            { make_item("a-1-1.x86_64", "a", "old"),
+                              make_item("b-1-1.x86_64", "b"),
+                              make_item("c-1-1.x86_64", "c") });
+
+  GObject *first = G_OBJECT(g_list_model_get_item(G_LIST_MODEL(model), 0));
+  GObject *second = G_OBJECT(g_list_model_get_item(G_LIST_MODEL(model), 1));
+
+  std::vector<ItemsChanged> changes;
+  record_items_changed(model, changes);
+
+  package_list_model_begin_merge(model);
+  REQUIRE(package_list_model_is_merging(model));
+  package_list_model_append(model,
+                            { make_item("a-1-1.x86_64", "a", "new"),
+                              make_item("c-1-1.x86_64", "c"),
+                              make_item("d-1-1.x86_64", "d") });
+
+  // Existing rows stay untouched until the merge finishes.
+  REQUIRE(visible_nevras(model) ==
+          std::vector<std::string> { "a-1-1.x86_64", "b-1-1.x86_64", "c-1-1.x86_64", "d-1-1.x86_64" });
+  REQUIRE(package_list_model_item_from_object(first)->row.summary == std::string("old"));
+
+  package_list_model_finish_merge(model);
+  REQUIRE_FALSE(package_list_model_is_merging(model));
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "a-1-1.x86_64", "c-1-1.x86_64", "d-1-1.x86_64" });
+
+  // The changed row keeps its item object, the dropped one stops resolving.
+  GObject *again = G_OBJECT(g_list_model_get_item(G_LIST_MODEL(model), 0));
+  REQUIRE(again == first);
+  REQUIRE(package_list_model_item_from_object(first)->row.summary == std::string("new"));
+  REQUIRE(package_list_model_item_from_object(second) == nullptr);
+  g_object_unref(again);
+
+  // One append for d, then one span from the changed a row through the
+  // dropped b row.
+  REQUIRE(changes.size() == 2);
+  REQUIRE(changes[0].position == 3);
+  REQUIRE(changes[0].added == 1);
+  REQUIRE(changes[1].position == 0);
+  REQUIRE(changes[1].removed == 2);
+  REQUIRE(changes[1].added == 1);
+
+  g_object_unref(first);
+  g_object_unref(second);
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that clearing detaches live item objects and announces the removal.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package list model clear detaches live rows")
+{
+  DnfuiPackageListModel *model = package_list_model_new();
+  package_list_model_append(model, { make_item("a-1-1.x86_64", "a"), make_item("b-1-1.x86_64", "b") });
+  GObject *held = G_OBJECT(g_list_model_get_item(G_LIST_MODEL(model), 1));
+
+  std::vector<ItemsChanged> changes;
+  record_items_changed(model, changes);
+  package_list_model_clear(model);
+
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 0);
+  REQUIRE(package_list_model_item_from_object(held) == nullptr);
+  REQUIRE(changes.size() == 1);
+  REQUIRE(changes[0].removed == 2);
+
+  g_object_unref(held);
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that per-NEVRA updates reach every row of that NEVRA and keep the
+// lookup index across merges.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package list model updates rows by NEVRA")
+{
+  DnfuiPackageListModel *model = package_list_model_new();
+  package_list_model_append(model, { make_item("a-1-1.x86_64", "a"), make_item("b-1-1.x86_64", "b") });
+
+  auto mark = [](PackageItem &item) { item.status_text = "Pending Install"; };
+  REQUIRE(package_list_model_update_rows(model, "b-1-1.x86_64", mark));
+  REQUIRE_FALSE(package_list_model_update_rows(model, "c-1-1.x86_64", mark));
+
+  GObject *obj = G_OBJECT(g_list_model_get_item(G_LIST_MODEL(model), 1));
+  REQUIRE(package_list_model_item_from_object(obj)->status_text == "Pending Install");
+  g_object_unref(obj);
+
+  package_list_model_begin_merge(model);
+  package_list_model_append(model, { make_item("b-1-1.x86_64", "b") });
+  package_list_model_finish_merge(model);
+
+  guint position = 1;
+  REQUIRE(package_list_model_find(model, "b-1-1.x86_64", position));
+  REQUIRE(position == 0);
+  REQUIRE_FALSE(package_list_model_update_rows(model, "a-1-1.x86_64", mark));
+
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a row updated in place moves to its new sorted position, leaves
+// or enters the filtered view, and keeps its place among equal rows when its
+// sort key did not change.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package list model places updated rows by the sort and filter")
+{
+  DnfuiPackageListModel *model = package_list_model_new();
+  std::vector<ItemsChanged> changes;
+  record_items_changed(model, changes);
+
+  package_list_model_set_compare(
+      model, [](const PackageItem &lhs, const PackageItem &rhs) { return lhs.status_text.compare(rhs.status_text); });
+  std::vector<PackageItem> items;
+  for (const std::string name : { "a", "b", "c", "d" }) {
+    PackageItem item = make_item(name + "-1-1.x86_64", name);
+    item.status_text = "Available";
+    items.push_back(item);
+  }
+  package_list_model_append(model, items);
+  changes.clear();
+
+  // Same sort key: the row keeps its place among equal rows.
+  REQUIRE(package_list_model_update_rows(
+      model, "b-1-1.x86_64", [](PackageItem &item) { item.row.summary = "changed"; }));
+  REQUIRE(changes.empty());
+  REQUIRE(visible_nevras(model) ==
+          std::vector<std::string> { "a-1-1.x86_64", "b-1-1.x86_64", "c-1-1.x86_64", "d-1-1.x86_64" });
+
+  // A new status sorts the row after the others.
+  auto mark_installed = [](PackageItem &item) { item.status_text = "Installed"; };
+  REQUIRE(package_list_model_update_rows(model, "a-1-1.x86_64", mark_installed));
+  REQUIRE(visible_nevras(model) ==
+          std::vector<std::string> { "b-1-1.x86_64", "c-1-1.x86_64", "d-1-1.x86_64", "a-1-1.x86_64" });
+  REQUIRE_FALSE(changes.empty());
+
+  // The filter is applied to updated rows again, hiding and showing them.
+  package_list_model_set_filter(model, [](const PackageItem &item) { return item.status_text == "Available"; });
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "b-1-1.x86_64", "c-1-1.x86_64", "d-1-1.x86_64" });
+  REQUIRE(package_list_model_update_rows(model, "c-1-1.x86_64", mark_installed));
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "b-1-1.x86_64", "d-1-1.x86_64" });
+  REQUIRE(package_list_model_update_rows(
+      model, "a-1-1.x86_64", [](PackageItem &item) { item.status_text = "Available"; }));
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "b-1-1.x86_64", "d-1-1.x86_64", "a-1-1.x86_64" });
+  REQUIRE(package_list_model_get_counts(model).total == 4);
+
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that filtering hides stored rows without dropping them, that widening
+// the filter restores the sorted order, and that counts cover hidden rows.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package list model filters rows and keeps counts")
+{
+  DnfuiPackageListModel *model = package_list_model_new();
+  PackageItem a = make_item("a-1-1.x86_64", "a");
+  a.row.repo = "fedora";
+  a.row.arch = "x86_64";
+  PackageItem b = make_item("b-1-1.noarch", "b");
+  b.row.repo = "updates";
+  b.row.arch = "noarch";
+  PackageItem c = make_item("c-1-1.x86_64", "c");
+  c.row.repo = "fedora";
+  c.row.arch = "x86_64";
+  package_list_model_set_compare(model, compare_by_name);
+  package_list_model_append(model, { c, b, a });
+
+  auto fedora_only = [](const PackageItem &item) { return item.row.repo == "fedora"; };
+  package_list_model_set_filter(model, fedora_only);
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "a-1-1.x86_64", "c-1-1.x86_64" });
+
+  const PackageListCounts &counts = package_list_model_get_counts(model);
+  REQUIRE(counts.total == 3);
+  REQUIRE(counts.by_repo.at("fedora") == 2);
+  REQUIRE(counts.by_repo.at("updates") == 1);
+  REQUIRE(counts.by_arch.at("x86_64") == 2);
+
+  // Narrowing only checks the visible rows.
+  package_list_model_set_filter(
+      model, [](const PackageItem &item) { return item.row.repo == "fedora" && item.row.name == "c"; }, true);
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "c-1-1.x86_64" });
+
+  // Rows appended while filtered are counted but stay hidden.
+  PackageItem d = make_item("d-1-1.x86_64", "d");
+  d.row.repo = "updates";
+  package_list_model_append(model, { d });
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "c-1-1.x86_64" });
+  REQUIRE(package_list_model_get_counts(model).by_repo.at("updates") == 2);
+
+  // Merged rows are checked against the filter again, and dropped rows leave
+  // the counts.
+  package_list_model_begin_merge(model);
+  PackageItem b_moved = b;
+  b_moved.row.repo = "fedora";
+  PackageItem c_changed = c;
+  c_changed.row.summary = "changed";
+  package_list_model_append(model, { a, b_moved, c_changed });
+  package_list_model_finish_merge(model);
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "c-1-1.x86_64" });
+  package_list_model_set_filter(model, fedora_only);
+  REQUIRE(visible_nevras(model) == std::vector<std::string> { "a-1-1.x86_64", "b-1-1.noarch", "c-1-1.x86_64" });
+  REQUIRE(package_list_model_get_counts(model).total == 3);
+  REQUIRE(package_list_model_get_counts(model).by_repo.at("fedora") == 3);
+  REQUIRE_FALSE(package_list_model_get_counts(model).by_repo.contains("updates"));
+
+  package_list_model_set_filter(model, nullptr);
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 3);
+
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that small batches appended to a long sorted order land at the same
+// positions a full sort would give them.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package list model places small batches into a long sorted order")
+{
+  DnfuiPackageListModel *model = package_list_model_new();
+  package_list_model_set_compare(model, compare_by_name);
+
+  std::vector<PackageItem> first;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 200; i += 2) {
+    std::string name = "pkg" + std::to_string(1000 + i);
+    first.push_back(make_item(name + "-1-1.x86_64", name));
+    expected.push_back(name + "-1-1.x86_64");
+  }
+  package_list_model_append(model, first);
+
+  // Odd names fall between the existing rows, the duplicate lands after its
+  // equal row, and each batch is checked against the expected full sort.
+  for (int i = 199; i > 0; i -= 40) {
+    std::string name = "pkg" + std::to_string(1000 + i);
+    std::string twin = "pkg" + std::to_string(1000 + i - 1);
+    package_list_model_append(model, { make_item(name + "-1-1.x86_64", name), make_item(twin + "-2-1.x86_64", twin) });
+    expected.push_back(name + "-1-1.x86_64");
+    expected.push_back(twin + "-2-1.x86_64");
+  }
+  std::stable_sort(expected.begin(), expected.end(), [](const std::string &lhs, const std::string &rhs) {
+    return lhs.substr(0, 7) < rhs.substr(0, 7);
+  });
+
+  REQUIRE(visible_nevras(model) == expected);
+
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the stored rows come back in insertion order, hidden rows
+// included, and with merged changes applied.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package list model returns every stored row")
+{
+  DnfuiPackageListModel *model = package_list_model_new();
+  package_list_model_set_compare(model, compare_by_name);
+  package_list_model_append(model, { make_item("c-1-1.x86_64", "c"), make_item("a-1-1.x86_64", "a") });
+  package_list_model_set_filter(model, [](const PackageItem &item) { return item.row.name == "a"; });
+
+  std::vector<PackageRow> rows = package_list_model_get_rows(model);
+  REQUIRE(rows.size() == 2);
+  REQUIRE(rows[0].nevra == "c-1-1.x86_64");
+  REQUIRE(rows[1].nevra == "a-1-1.x86_64");
+
+  package_list_model_begin_merge(model);
+  package_list_model_append(model, { make_item("c-1-1.x86_64", "c", "changed"), make_item("b-1-1.x86_64", "b") });
+  package_list_model_finish_merge(model);
+
+  rows = package_list_model_get_rows(model);
+  REQUIRE(rows.size() == 2);
+  REQUIRE(rows[0].nevra == "c-1-1.x86_64");
+  REQUIRE(rows[0].summary == "changed");
+  REQUIRE(rows[1].nevra == "b-1-1.x86_64");
+
+  g_object_unref(model);
+}
@@ -1,12 +1,15 @@
 // -----------------------------------------------------------------------------
 // Package query cache tests
-// Covers cache keys, generation checks, and cache invalidation.
+// Covers cache keys, generation checks, cache invalidation, shared hits, the
+// byte budget, and carrying entries across a rebuild.
 // -----------------------------------------------------------------------------
 #include <catch2/catch_test_macros.hpp>
 
 #include "test_utils.hpp"
 #include "ui/package_query_cache.hpp"
 
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -25,6 +28,15 @@ make_cache_row(const std::string &nevra, const std::string &name)
   return row;
 }
 
+// -----------------------------------------------------------------------------
+// Wrap rows in the shared result set the cache stores.
+// -----------------------------------------------------------------------------
+SharedPackageRows
+make_cache_rows(std::vector<PackageRow> rows)
+{
+  return std::make_shared<const std::vector<PackageRow>>(std::move(rows));
+}
+
 } // namespace
 
 // -----------------------------------------------------------------------------
@@ -47,26 +59,87 @@ TEST_CASE("Package query cache key includes search options")
   REQUIRE(package_query_cache_key_for("bash") == "desc:exact:bash");
 }
 
+// -----------------------------------------------------------------------------
+// Verify that explicit options build the same keys as the published ones, and
+// that file searches get their own scope.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache key accepts explicit search options")
+{
+  reset_backend_globals();
+
+  set_backend_search_options(true, false);
+  REQUIRE(package_query_cache_key_for("bash", { .search_in_description = true }) ==
+          package_query_cache_key_for("bash"));
+  REQUIRE(package_query_cache_key_for("bash", {}) == "name:contains:bash");
+  REQUIRE(package_query_cache_key_for("/usr/bin/bash", { .exact_match = true, .search_in_files = true }) ==
+          "file:exact:/usr/bin/bash");
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a presence check sees stored rows without counting a lookup.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache contains check leaves the counters alone")
+{
+  package_query_cache_reset_for_tests();
+
+  const std::string key = "name:contains:demo";
+  REQUIRE_FALSE(package_query_cache_contains(key, 3));
+  package_query_cache_store(key, 3, make_cache_rows({ make_cache_row("demo-1-1.x86_64", "demo") }));
+
+  REQUIRE(package_query_cache_contains(key, 3));
+  REQUIRE_FALSE(package_query_cache_contains("name:contains:other", 3));
+  const PackageQueryCacheStats stats = package_query_cache_stats();
+  REQUIRE(stats.hits == 0);
+  REQUIRE(stats.misses == 0);
+
+  REQUIRE_FALSE(package_query_cache_contains(key, 4));
+}
+
 // -----------------------------------------------------------------------------
 // Verify that cached rows are returned only for the same key and generation.
 // -----------------------------------------------------------------------------
 TEST_CASE("Package query cache returns rows for matching key and generation")
 {
-  package_query_cache_clear();
+  package_query_cache_reset_for_tests();
 
   const std::string key = "name:contains:demo";
-  std::vector<PackageRow> stored = {
-    make_cache_row("demo-1-1.x86_64", "demo"),
-    make_cache_row("demo-libs-1-1.x86_64", "demo-libs"),
-  };
-  std::vector<PackageRow> loaded;
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("demo-1-1.x86_64", "demo"),
+      make_cache_row("demo-libs-1-1.x86_64", "demo-libs"),
+  });
+  SharedPackageRows loaded;
 
   package_query_cache_store(key, 7, stored);
 
   REQUIRE(package_query_cache_lookup(key, 7, loaded));
-  REQUIRE(loaded.size() == 2);
-  REQUIRE(loaded[0].nevra == "demo-1-1.x86_64");
-  REQUIRE(loaded[1].nevra == "demo-libs-1-1.x86_64");
+  REQUIRE(loaded->size() == 2);
+  REQUIRE((*loaded)[0].nevra == "demo-1-1.x86_64");
+  REQUIRE((*loaded)[1].nevra == "demo-libs-1-1.x86_64");
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a hit shares the stored result set instead of copying it.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache hits share the stored rows")
+{
+  package_query_cache_reset_for_tests();
+
+  const std::string key = "name:contains:demo";
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("demo-1-1.x86_64", "demo"),
+  });
+  SharedPackageRows first;
+  SharedPackageRows second;
+
+  package_query_cache_store(key, 7, stored);
+
+  REQUIRE(package_query_cache_lookup(key, 7, first));
+  REQUIRE(package_query_cache_lookup(key, 7, second));
+  REQUIRE(first.get() == stored.get());
+  REQUIRE(second.get() == stored.get());
+
+  package_query_cache_clear();
+  REQUIRE(first->size() == 1);
 }
 
 // -----------------------------------------------------------------------------
@@ -74,13 +147,13 @@ TEST_CASE("Package query cache returns rows for matching key and generation")
 // -----------------------------------------------------------------------------
 TEST_CASE("Package query cache rejects and removes stale generations")
 {
-  package_query_cache_clear();
+  package_query_cache_reset_for_tests();
 
   const std::string key = "name:contains:demo";
-  std::vector<PackageRow> stored = {
-    make_cache_row("demo-1-1.x86_64", "demo"),
-  };
-  std::vector<PackageRow> loaded;
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("demo-1-1.x86_64", "demo"),
+  });
+  SharedPackageRows loaded;
 
   package_query_cache_store(key, 7, stored);
 
@@ -93,16 +166,256 @@ TEST_CASE("Package query cache rejects and removes stale generations")
 // -----------------------------------------------------------------------------
 TEST_CASE("Package query cache clear removes stored rows")
 {
-  package_query_cache_clear();
+  package_query_cache_reset_for_tests();
 
   const std::string key = "name:contains:demo";
-  std::vector<PackageRow> stored = {
-    make_cache_row("demo-1-1.x86_64", "demo"),
-  };
-  std::vector<PackageRow> loaded;
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("demo-1-1.x86_64", "demo"),
+  });
+  SharedPackageRows loaded;
 
   package_query_cache_store(key, 7, stored);
   package_query_cache_clear();
 
   REQUIRE_FALSE(package_query_cache_lookup(key, 7, loaded));
 }
+
+// -----------------------------------------------------------------------------
+// Verify that a narrower name search is filtered from a cached broader search.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache refines a cached broader name search")
+{
+  reset_backend_globals();
+  package_query_cache_reset_for_tests();
+  set_backend_search_options(false, false);
+
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("python3-3.12-1.x86_64", "python3"),
+      make_cache_row("pythia-1-1.x86_64", "pythia"),
+      make_cache_row("Python-docs-1-1.x86_64", "Python-docs"),
+  });
+  SharedPackageRows loaded;
+
+  package_query_cache_store(package_query_cache_key_for("pyth"), 7, stored);
+
+  REQUIRE(package_query_cache_refine("PYTHON", 7, loaded));
+  REQUIRE(loaded->size() == 2);
+  REQUIRE((*loaded)[0].nevra == "python3-3.12-1.x86_64");
+  REQUIRE((*loaded)[1].nevra == "Python-docs-1-1.x86_64");
+
+  REQUIRE_FALSE(package_query_cache_refine("python", 8, loaded));
+  REQUIRE_FALSE(package_query_cache_refine("perl", 7, loaded));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that description and exact searches are never refined in memory.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache does not refine description or exact searches")
+{
+  reset_backend_globals();
+  package_query_cache_reset_for_tests();
+
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("python3-3.12-1.x86_64", "python3"),
+  });
+  SharedPackageRows loaded;
+
+  set_backend_search_options(true, false);
+  package_query_cache_store(package_query_cache_key_for("pyth"), 7, stored);
+  REQUIRE_FALSE(package_query_cache_refine("python", 7, loaded));
+
+  set_backend_search_options(false, true);
+  package_query_cache_store(package_query_cache_key_for("pyth"), 7, stored);
+  REQUIRE_FALSE(package_query_cache_refine("python", 7, loaded));
+
+  reset_backend_globals();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the least recently used entry is evicted once the budget is
+// exceeded, and that a hit keeps an entry from being evicted.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache evicts the least recently used entry over budget")
+{
+  package_query_cache_reset_for_tests();
+
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("demo-1-1.x86_64", "demo"),
+  });
+  SharedPackageRows loaded;
+
+  package_query_cache_store("name:contains:a", 7, stored);
+  const size_t entry_bytes = package_query_cache_stats().bytes;
+  REQUIRE(entry_bytes > 0);
+  package_query_cache_set_byte_budget(entry_bytes * 2);
+
+  package_query_cache_store("name:contains:b", 7, stored);
+  REQUIRE(package_query_cache_lookup("name:contains:a", 7, loaded));
+  package_query_cache_store("name:contains:c", 7, stored);
+
+  REQUIRE(package_query_cache_lookup("name:contains:a", 7, loaded));
+  REQUIRE(package_query_cache_lookup("name:contains:c", 7, loaded));
+  REQUIRE_FALSE(package_query_cache_lookup("name:contains:b", 7, loaded));
+
+  PackageQueryCacheStats stats = package_query_cache_stats();
+  REQUIRE(stats.entries == 2);
+  REQUIRE(stats.bytes <= stats.byte_budget);
+  REQUIRE(stats.evictions == 1);
+  REQUIRE(stats.hits == 3);
+  REQUIRE(stats.misses == 1);
+
+  package_query_cache_set_byte_budget(entry_bytes);
+  stats = package_query_cache_stats();
+  REQUIRE(stats.entries == 1);
+  REQUIRE(stats.evictions == 2);
+  REQUIRE(package_query_cache_lookup("name:contains:c", 7, loaded));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a newer generation purges every older entry at once, and that
+// a result set larger than the budget is not stored.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache purges older generations and skips oversized results")
+{
+  package_query_cache_reset_for_tests();
+
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("demo-1-1.x86_64", "demo"),
+  });
+  SharedPackageRows loaded;
+
+  package_query_cache_store("name:contains:a", 7, stored);
+  package_query_cache_store("name:contains:b", 7, stored);
+  package_query_cache_store("name:contains:c", 8, stored);
+
+  PackageQueryCacheStats stats = package_query_cache_stats();
+  REQUIRE(stats.entries == 1);
+  REQUIRE(stats.stale_purged == 2);
+
+  package_query_cache_store("name:contains:d", 7, stored);
+  REQUIRE_FALSE(package_query_cache_lookup("name:contains:d", 7, loaded));
+  REQUIRE(package_query_cache_lookup("name:contains:c", 8, loaded));
+
+  package_query_cache_set_byte_budget(1);
+  package_query_cache_store("name:contains:e", 8, stored);
+  stats = package_query_cache_stats();
+  REQUIRE(stats.entries == 0);
+  REQUIRE(stats.bytes == 0);
+  REQUIRE(stats.oversized == 1);
+
+  package_query_cache_reset_for_tests();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that carried entries leave the cache during the rebuild and come back
+// shared for the next generation when no package changed.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache carries unchanged entries into the next generation")
+{
+  package_query_cache_reset_for_tests();
+
+  SharedPackageRows stored = make_cache_rows({
+      make_cache_row("demo-1-1.x86_64", "demo"),
+  });
+  SharedPackageRows loaded;
+  package_query_cache_store("name:contains:demo", 7, stored);
+  package_query_cache_store("name:contains:old", 6, stored);
+
+  const PackageQueryCacheCarryOver carry = package_query_cache_begin_carry_over(7);
+  REQUIRE(carry.entries.size() == 1);
+  REQUIRE_FALSE(package_query_cache_lookup("name:contains:demo", 7, loaded));
+
+  bool requeried = false;
+  auto requery = [&requeried](const std::string &,
+                              const DnfBackendSearchOptions &,
+                              const std::set<std::string> &,
+                              std::vector<PackageRow> &) {
+    requeried = true;
+    return true;
+  };
+  REQUIRE(package_query_cache_finish_carry_over(carry, 8, {}, requery) == 1);
+  REQUIRE_FALSE(requeried);
+  REQUIRE(package_query_cache_lookup("name:contains:demo", 8, loaded));
+  REQUIRE(loaded.get() == stored.get());
+  REQUIRE(package_query_cache_stats().carried == 1);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that rows of changed packages are replaced by requeried rows in name
+// order, and that entries whose requery fails are dropped.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache patches rows of changed packages")
+{
+  package_query_cache_reset_for_tests();
+
+  package_query_cache_store("desc:exact:py",
+                            7,
+                            make_cache_rows({
+                                make_cache_row("pya-1-1.x86_64", "pya"),
+                                make_cache_row("pyb-1-1.x86_64", "pyb"),
+                                make_cache_row("pyd-1-1.x86_64", "pyd"),
+                            }));
+  package_query_cache_store("name:contains:zz", 7, make_cache_rows({ make_cache_row("zz-1-1.x86_64", "zz") }));
+
+  const PackageQueryCacheCarryOver carry = package_query_cache_begin_carry_over(7);
+  std::vector<std::string> requested_terms;
+  auto requery = [&requested_terms](const std::string &term,
+                                    const DnfBackendSearchOptions &options,
+                                    const std::set<std::string> &names,
+                                    std::vector<PackageRow> &out_rows) {
+    requested_terms.push_back(term);
+    if (term == "zz") {
+      return false;
+    }
+    REQUIRE(options.search_in_description);
+    REQUIRE(options.exact_match);
+    REQUIRE(names.count("pyb") == 1);
+    out_rows = { make_cache_row("pyb-2-1.x86_64", "pyb"), make_cache_row("pyc-1-1.x86_64", "pyc") };
+    return true;
+  };
+
+  REQUIRE(package_query_cache_finish_carry_over(carry, 8, { "pyb", "pyc" }, requery) == 1);
+  REQUIRE(requested_terms.size() == 2);
+
+  SharedPackageRows loaded;
+  REQUIRE_FALSE(package_query_cache_lookup("name:contains:zz", 8, loaded));
+  REQUIRE(package_query_cache_lookup("desc:exact:py", 8, loaded));
+  REQUIRE(loaded->size() == 4);
+  REQUIRE((*loaded)[0].nevra == "pya-1-1.x86_64");
+  REQUIRE((*loaded)[1].nevra == "pyb-2-1.x86_64");
+  REQUIRE((*loaded)[2].nevra == "pyc-1-1.x86_64");
+  REQUIRE((*loaded)[3].nevra == "pyd-1-1.x86_64");
+  REQUIRE(package_query_cache_stats().patched == 1);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that entries stored since the carry over began win over carried ones,
+// and that a carry over into an outdated generation stores nothing.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package query cache carry over yields to newer stores and generations")
+{
+  package_query_cache_reset_for_tests();
+
+  SharedPackageRows carried_rows = make_cache_rows({ make_cache_row("demo-1-1.x86_64", "demo") });
+  SharedPackageRows fresh_rows = make_cache_rows({ make_cache_row("demo-2-1.x86_64", "demo") });
+  auto requery = [](const std::string &,
+                    const DnfBackendSearchOptions &,
+                    const std::set<std::string> &,
+                    std::vector<PackageRow> &) { return true; };
+  SharedPackageRows loaded;
+
+  package_query_cache_store("name:contains:demo", 7, carried_rows);
+  PackageQueryCacheCarryOver carry = package_query_cache_begin_carry_over(7);
+  package_query_cache_store("name:contains:demo", 8, fresh_rows);
+  REQUIRE(package_query_cache_finish_carry_over(carry, 8, {}, requery) == 0);
+  REQUIRE(package_query_cache_lookup("name:contains:demo", 8, loaded));
+  REQUIRE(loaded.get() == fresh_rows.get());
+
+  package_query_cache_store("name:contains:other", 8, carried_rows);
+  carry = package_query_cache_begin_carry_over(8);
+  package_query_cache_store("name:contains:newest", 10, fresh_rows);
+  REQUIRE(package_query_cache_finish_carry_over(carry, 9, {}, requery) == 0);
+  REQUIRE_FALSE(package_query_cache_lookup("name:contains:other", 9, loaded));
+
+  package_query_cache_reset_for_tests();
+}
@@ -0,0 +1,66 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "dnf_backend/dnf_backend.hpp"
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Verify that package strings compare like the std::string values they hold.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package string compares like std::string")
+{
+  PackageString bash = std::string("bash");
+  PackageString zsh = "zsh";
+
+  REQUIRE(bash == "bash");
+  REQUIRE(bash == std::string("bash"));
+  REQUIRE(std::string("bash") == bash);
+  REQUIRE(bash != zsh);
+  REQUIRE(bash < zsh);
+  REQUIRE(bash.str() == "bash");
+  REQUIRE(bash.size() == 4);
+  REQUIRE(PackageString().empty());
+  REQUIRE(PackageString("").empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that interned values share one buffer and copies share storage.
+// -----------------------------------------------------------------------------
+TEST_CASE("Interned package strings share storage")
+{
+  PackageString first = PackageString::interned("x86_64");
+  PackageString second = PackageString::interned(std::string("x86_") + "64");
+  PackageString owned = std::string("x86_64");
+
+  REQUIRE(first.shares_storage_with(second));
+  REQUIRE_FALSE(first.shares_storage_with(owned));
+  REQUIRE(first == owned);
+
+  PackageString copy = owned;
+  REQUIRE(copy.shares_storage_with(owned));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that copied package rows share field storage with the original row.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package row copies share string storage")
+{
+  PackageRow row;
+  row.nevra = "demo-1.0-1.x86_64";
+  row.name = "demo";
+  row.version = "1.0";
+  row.release = "1";
+  row.arch = PackageString::interned("x86_64");
+  row.summary = "Demo package";
+
+  std::vector<PackageRow> rows(3, row);
+  for (const auto &copy : rows) {
+    REQUIRE(copy.nevra.shares_storage_with(row.nevra));
+    REQUIRE(copy.summary.shares_storage_with(row.summary));
+    REQUIRE(copy.arch.shares_storage_with(row.arch));
+  }
+
+  REQUIRE(row.display_version() == "1.0-1");
+  REQUIRE(row.name_arch_key() == "demo\nx86_64");
+}
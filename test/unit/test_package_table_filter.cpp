@@ -0,0 +1,55 @@
+// -----------------------------------------------------------------------------
+// Package table filter tests
+// Covers status, repo, arch, and casefolded text matching and the narrowing
+// check that lets the model skip hidden rows.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/package_table_filter.hpp"
+
+// -----------------------------------------------------------------------------
+// Verify that every field restricts the rows and that text matches the name
+// or summary without regard to case.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package table filter matches status, repo, arch, and text")
+{
+  PackageItem item;
+  item.row.name = "Firefox";
+  item.row.summary = "Mozilla web browser";
+  item.row.repo = "updates";
+  item.row.arch = "x86_64";
+  item.status_rank = 3;
+
+  REQUIRE(package_table_filter_is_empty(package_table_filter_make(-1, "", "", "")));
+  REQUIRE(package_table_filter_matches(package_table_filter_make(-1, "", "", ""), item));
+  REQUIRE(package_table_filter_matches(package_table_filter_make(3, "updates", "x86_64", "FIRE"), item));
+  REQUIRE(package_table_filter_matches(package_table_filter_make(-1, "", "", "Web Browser"), item));
+  REQUIRE_FALSE(package_table_filter_matches(package_table_filter_make(0, "", "", ""), item));
+  REQUIRE_FALSE(package_table_filter_matches(package_table_filter_make(-1, "fedora", "", ""), item));
+  REQUIRE_FALSE(package_table_filter_matches(package_table_filter_make(-1, "", "noarch", ""), item));
+  REQUIRE_FALSE(package_table_filter_matches(package_table_filter_make(-1, "", "", "firefox mozilla"), item));
+
+  REQUIRE_FALSE(package_table_filter_predicate(package_table_filter_make(-1, "", "", "")));
+  REQUIRE(package_table_filter_predicate(package_table_filter_make(-1, "updates", "", ""))(item));
+}
+
+// -----------------------------------------------------------------------------
+// Verify which filter changes only narrow the previous filter.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package table filter detects narrowing changes")
+{
+  PackageTableFilter none = package_table_filter_make(-1, "", "", "");
+  PackageTableFilter fire = package_table_filter_make(-1, "", "", "fire");
+  PackageTableFilter firefox = package_table_filter_make(-1, "", "", "Firefox");
+  PackageTableFilter fedora = package_table_filter_make(-1, "fedora", "", "fire");
+  PackageTableFilter updates = package_table_filter_make(-1, "updates", "", "fire");
+  PackageTableFilter installed = package_table_filter_make(0, "", "", "");
+
+  REQUIRE(package_table_filter_narrows(fire, none));
+  REQUIRE(package_table_filter_narrows(firefox, fire));
+  REQUIRE(package_table_filter_narrows(fedora, fire));
+  REQUIRE(package_table_filter_narrows(installed, none));
+  REQUIRE_FALSE(package_table_filter_narrows(fire, firefox));
+  REQUIRE_FALSE(package_table_filter_narrows(updates, fedora));
+  REQUIRE_FALSE(package_table_filter_narrows(none, installed));
+}
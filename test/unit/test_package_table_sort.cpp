@@ -0,0 +1,61 @@
+// -----------------------------------------------------------------------------
+// Package table sort tests
+// Covers the case-insensitive column order, the name and NEVRA tie-breaks, and
+// the cached collation keys.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/package_table_sort.hpp"
+
+// -----------------------------------------------------------------------------
+// Return one package item with the fields the comparator reads.
+// -----------------------------------------------------------------------------
+static PackageItem
+sort_item(const char *name, const char *nevra, const char *summary, int status_rank)
+{
+  PackageItem item;
+  item.row.name = name;
+  item.row.nevra = nevra;
+  item.row.summary = summary;
+  item.status_rank = status_rank;
+  return item;
+}
+
+// -----------------------------------------------------------------------------
+// Verify that text columns ignore case and that ties fall back to the name and
+// then the NEVRA.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package table sort compares columns with stable tie-breaks")
+{
+  const PackageItem bash = sort_item("bash", "bash-5.2-1.x86_64", "The GNU shell", 1);
+  const PackageItem zsh = sort_item("Zsh", "zsh-5.9-1.x86_64", "the Z shell", 1);
+  const PackageItem bash_i686 = sort_item("bash", "bash-5.2-1.i686", "The GNU shell", 0);
+
+  REQUIRE(package_table_compare_items(bash, zsh, PackageColumnKind::PACKAGE) < 0);
+  REQUIRE(package_table_compare_items(zsh, bash, PackageColumnKind::PACKAGE) > 0);
+  REQUIRE(package_table_compare_items(bash, zsh, PackageColumnKind::SUMMARY) < 0);
+  REQUIRE(package_table_compare_items(bash_i686, bash, PackageColumnKind::PACKAGE) < 0);
+  REQUIRE(package_table_compare_items(bash, bash, PackageColumnKind::PACKAGE) == 0);
+
+  REQUIRE(package_table_compare_items(bash_i686, bash, PackageColumnKind::STATUS) < 0);
+  REQUIRE(package_table_compare_items(bash, zsh, PackageColumnKind::STATUS) < 0);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that collation keys are cached per column and are never empty.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package table sort caches collation keys per column")
+{
+  const PackageItem item = sort_item("", "empty-1-1.noarch", "Summary", 0);
+
+  REQUIRE(item.collation_keys.empty());
+  const std::string &name_key = package_table_collation_key(item, PackageColumnKind::PACKAGE);
+  REQUIRE_FALSE(name_key.empty());
+  REQUIRE(&package_table_collation_key(item, PackageColumnKind::PACKAGE) == &name_key);
+  REQUIRE(item.collation_keys[static_cast<size_t>(PackageColumnKind::SUMMARY)].empty());
+  REQUIRE(package_table_column_text(item, PackageColumnKind::SUMMARY) == "Summary");
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
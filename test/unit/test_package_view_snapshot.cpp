@@ -0,0 +1,104 @@
+// -----------------------------------------------------------------------------
+// Package view snapshot tests
+// Covers the binary round trip and the rejection of damaged files.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/package_view_snapshot.hpp"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Return a small snapshot with one installed and one available row.
+// -----------------------------------------------------------------------------
+static PackageViewSnapshot
+make_test_snapshot()
+{
+  PackageViewSnapshot snapshot;
+  snapshot.query.kind = DisplayedPackageQueryKind::SEARCH;
+  snapshot.query.search_term = "demo";
+  snapshot.query.exact_match = true;
+  snapshot.stamps = { "/var/lib/rpm/rpmdb.sqlite 4096 1", "/etc/dnf/dnf.conf 10 2" };
+
+  PackageRow installed;
+  installed.nevra = "demo-1.0-1.fc40.x86_64";
+  installed.name = "demo";
+  installed.epoch = "0";
+  installed.version = "1.0";
+  installed.release = "1.fc40";
+  installed.arch = "x86_64";
+  installed.repo = "@System";
+  installed.summary = "Demo package";
+  installed.install_reason = PackageInstallReason::USER;
+  installed.repo_candidate_relation = PackageRepoCandidateRelation::NEWER;
+
+  PackageRow available = installed;
+  available.nevra = "demo-doc-1.0-1.fc40.noarch";
+  available.name = "demo-doc";
+  available.arch = "noarch";
+  available.repo = "fedora";
+  available.summary = "";
+  available.install_reason = PackageInstallReason::UNKNOWN;
+  available.repo_candidate_relation = PackageRepoCandidateRelation::UNKNOWN;
+
+  snapshot.rows = { installed, available };
+  snapshot.states = { PackageInstallState::UPGRADEABLE, PackageInstallState::AVAILABLE };
+  return snapshot;
+}
+
+// -----------------------------------------------------------------------------
+// Verify that every saved field comes back from the encoded form.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package view snapshot round-trips the query, stamps, and rows")
+{
+  const PackageViewSnapshot snapshot = make_test_snapshot();
+
+  PackageViewSnapshot decoded;
+  REQUIRE(package_view_snapshot_decode(package_view_snapshot_encode(snapshot), decoded));
+
+  REQUIRE(decoded.query.kind == DisplayedPackageQueryKind::SEARCH);
+  REQUIRE(decoded.query.search_term == "demo");
+  REQUIRE_FALSE(decoded.query.search_in_description);
+  REQUIRE(decoded.query.exact_match);
+  REQUIRE(decoded.stamps == snapshot.stamps);
+  REQUIRE(decoded.rows.size() == 2);
+  REQUIRE(decoded.states == snapshot.states);
+
+  for (size_t i = 0; i < decoded.rows.size(); ++i) {
+    REQUIRE(decoded.rows[i].nevra == snapshot.rows[i].nevra);
+    REQUIRE(decoded.rows[i].name == snapshot.rows[i].name);
+    REQUIRE(decoded.rows[i].arch == snapshot.rows[i].arch);
+    REQUIRE(decoded.rows[i].repo == snapshot.rows[i].repo);
+    REQUIRE(decoded.rows[i].summary == snapshot.rows[i].summary);
+    REQUIRE(decoded.rows[i].install_reason == snapshot.rows[i].install_reason);
+    REQUIRE(decoded.rows[i].repo_candidate_relation == snapshot.rows[i].repo_candidate_relation);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that truncated, extended, or foreign data is rejected without
+// touching the output.
+// -----------------------------------------------------------------------------
+TEST_CASE("Package view snapshot rejects damaged data")
+{
+  const std::string data = package_view_snapshot_encode(make_test_snapshot());
+
+  PackageViewSnapshot out;
+  out.query.search_term = "unchanged";
+
+  for (size_t size = 0; size < data.size(); ++size) {
+    REQUIRE_FALSE(package_view_snapshot_decode(data.substr(0, size), out));
+  }
+  REQUIRE_FALSE(package_view_snapshot_decode(data + "x", out));
+
+  std::string foreign = data;
+  foreign[7] = '0';
+  REQUIRE_FALSE(package_view_snapshot_decode(foreign, out));
+
+  // An install state past the last enum value is damage, not a new state.
+  std::string bad_state = data;
+  bad_state[bad_state.size() - 4] = 0x7f;
+  REQUIRE_FALSE(package_view_snapshot_decode(bad_state, out));
+
+  REQUIRE(out.query.search_term == "unchanged");
+}
@@ -4,9 +4,11 @@
 // -----------------------------------------------------------------------------
 #include <catch2/catch_test_macros.hpp>
 
+#include "dnf_backend/dnf_backend.hpp"
 #include "transaction_request.hpp"
 #include "ui/pending_transaction_request.hpp"
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -81,3 +83,111 @@ TEST_CASE("Pending transaction request validation accepts non protected requests
   REQUIRE(pending_transaction_validate_request(request, error));
   REQUIRE(error.empty());
 }
+
+// -----------------------------------------------------------------------------
+// Verify that the NEVRA index follows marking, replacing, and unmarking.
+// -----------------------------------------------------------------------------
+TEST_CASE("Pending transaction actions stay indexed by NEVRA")
+{
+  PendingTransactionWidgets transaction;
+  transaction.set_action(PendingAction::INSTALL, "demo-a-1-1.x86_64");
+  transaction.set_action(PendingAction::REMOVE, "demo-b-1-1.x86_64");
+  transaction.set_action(PendingAction::INSTALL, "demo-c-1-1.x86_64");
+
+  // Replacing an action moves it to the end, like unmarking and marking again.
+  transaction.set_action(PendingAction::REINSTALL, "demo-a-1-1.x86_64");
+  REQUIRE(transaction.actions.size() == 3);
+  REQUIRE(transaction.actions.back().nevra == "demo-a-1-1.x86_64");
+  REQUIRE(transaction.find_action("demo-a-1-1.x86_64")->type == PendingAction::REINSTALL);
+
+  REQUIRE(transaction.remove_action("demo-b-1-1.x86_64"));
+  REQUIRE_FALSE(transaction.remove_action("demo-b-1-1.x86_64"));
+  REQUIRE(transaction.find_action("demo-b-1-1.x86_64") == nullptr);
+  REQUIRE(transaction.find_action("demo-c-1-1.x86_64")->nevra == "demo-c-1-1.x86_64");
+  REQUIRE(transaction.find_action("demo-a-1-1.x86_64")->nevra == "demo-a-1-1.x86_64");
+
+  transaction.clear_actions();
+  REQUIRE(transaction.actions.empty());
+  REQUIRE(transaction.find_action("demo-c-1-1.x86_64") == nullptr);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that only solver-added packages count as dependency impact.
+// -----------------------------------------------------------------------------
+TEST_CASE("Pending transaction preview impact counts packages beyond the marked actions")
+{
+  std::vector<PendingAction> actions = {
+    { PendingAction::INSTALL, "demo-app-1-1.x86_64" },
+    { PendingAction::REMOVE, "demo-old-1-1.x86_64" },
+  };
+
+  TransactionPreview preview;
+  preview.add_item({ "demo-app-1-1.x86_64", TransactionPreviewAction::INSTALL });
+  preview.add_item({ "demo-app-libs-1-1.x86_64", TransactionPreviewAction::INSTALL });
+  preview.add_item({ "demo-common-2-1.noarch", TransactionPreviewAction::UPGRADE });
+  preview.add_item({ "demo-old-1-1.x86_64", TransactionPreviewAction::REMOVE });
+  preview.add_item({ "demo-old-plugin-1-1.x86_64", TransactionPreviewAction::REMOVE });
+
+  PendingTransactionImpact impact = pending_transaction_preview_impact(actions, preview);
+  REQUIRE(impact.extra_installs == 2);
+  REQUIRE(impact.extra_removals == 1);
+  REQUIRE_FALSE(impact.empty());
+
+  TransactionPreview marked_only;
+  marked_only.add_item({ "demo-app-1-1.x86_64", TransactionPreviewAction::INSTALL });
+  REQUIRE(pending_transaction_preview_impact(actions, marked_only).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that bulk marking applies the single-row gating to every row and
+// changes only the rows whose pending action differs.
+// -----------------------------------------------------------------------------
+TEST_CASE("Pending transaction bulk marking skips rows the action does not apply to")
+{
+  auto make_row = [](const std::string &nevra) {
+    PackageRow row;
+    row.nevra = nevra;
+    return row;
+  };
+  std::vector<PackageRow> rows = {
+    make_row("demo-available-1-1.x86_64"),
+    make_row("demo-installed-1-1.x86_64"),
+    make_row("demo-local-1-1.x86_64"),
+    make_row("dnf-ui-1-1.x86_64"),
+  };
+  std::vector<PackageRowClassification> classes(4);
+  classes[1].installed_exact = true;
+  classes[2].installed_exact = true;
+  classes[3].installed_exact = true;
+  classes[3].self_protected = true;
+  const std::set<std::string> reinstallable = { "demo-installed-1-1.x86_64" };
+
+  PendingTransactionWidgets transaction;
+  transaction.set_action(PendingAction::INSTALL, "demo-installed-1-1.x86_64");
+
+  PendingBulkMarkResult remove =
+      pending_transaction_mark_rows(transaction, PendingAction::REMOVE, rows, classes, reinstallable);
+  REQUIRE(remove.changed == std::vector<std::string> { "demo-installed-1-1.x86_64", "demo-local-1-1.x86_64" });
+  REQUIRE(remove.skipped == 1);
+  REQUIRE(remove.self_protected == 1);
+  REQUIRE(transaction.find_action("demo-installed-1-1.x86_64")->type == PendingAction::REMOVE);
+  REQUIRE(transaction.find_action("dnf-ui-1-1.x86_64") == nullptr);
+
+  PendingBulkMarkResult again =
+      pending_transaction_mark_rows(transaction, PendingAction::REMOVE, rows, classes, reinstallable);
+  REQUIRE(again.changed.empty());
+  REQUIRE(again.unchanged == 2);
+
+  PendingBulkMarkResult reinstall =
+      pending_transaction_mark_rows(transaction, PendingAction::REINSTALL, rows, classes, reinstallable);
+  REQUIRE(reinstall.changed == std::vector<std::string> { "demo-installed-1-1.x86_64" });
+  REQUIRE(reinstall.skipped == 2);
+  REQUIRE(reinstall.self_protected == 1);
+
+  PendingBulkMarkResult install =
+      pending_transaction_mark_rows(transaction, PendingAction::INSTALL, rows, classes, reinstallable);
+  REQUIRE(install.changed == std::vector<std::string> { "demo-available-1-1.x86_64" });
+  REQUIRE(install.skipped == 3);
+  REQUIRE(install.self_protected == 0);
+  REQUIRE(transaction.actions.size() == 3);
+}
@@ -0,0 +1,50 @@
+// -----------------------------------------------------------------------------
+// Progress log ring tests
+// Covers the newest-lines bound, the drop count, and joins across the ring
+// wrap point.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/progress_log_ring.hpp"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Verify that a full ring keeps the newest lines in order and counts drops.
+// -----------------------------------------------------------------------------
+TEST_CASE("Progress log ring keeps the newest lines")
+{
+  ProgressLogRing ring(3);
+  REQUIRE(ring.size() == 0);
+  REQUIRE(ring.join_all().empty());
+
+  ring.push("one");
+  ring.push("two");
+  REQUIRE(ring.join_all() == "one\ntwo\n");
+  REQUIRE(ring.dropped() == 0);
+
+  ring.push("three");
+  ring.push("four");
+  ring.push("five");
+  REQUIRE(ring.size() == 3);
+  REQUIRE(ring.dropped() == 2);
+  REQUIRE(ring.join_all() == "three\nfour\nfive\n");
+
+  // Partial joins take the newest lines and stop at the stored count.
+  REQUIRE(ring.join_newest(2) == "four\nfive\n");
+  REQUIRE(ring.join_newest(10) == "three\nfour\nfive\n");
+  REQUIRE(ring.join_newest(0).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a zero capacity still keeps the latest line.
+// -----------------------------------------------------------------------------
+TEST_CASE("Progress log ring keeps one line at zero capacity")
+{
+  ProgressLogRing ring(0);
+  ring.push("first");
+  ring.push("second");
+  REQUIRE(ring.size() == 1);
+  REQUIRE(ring.dropped() == 1);
+  REQUIRE(ring.join_all() == "second\n");
+}
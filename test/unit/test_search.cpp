@@ -2,8 +2,15 @@
 
 #include "dnf_backend/dnf_backend.hpp"
 #include "test_utils.hpp"
+#include "ui/package_query_cache.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <set>
 #include <string>
+#include <vector>
+
+#include <glib.h>
 
 // -----------------------------------------------------------------------------
 // Verify that contains search can find a common repository package.
@@ -51,6 +58,26 @@ TEST_CASE("Search description mode expands or equals name-only results")
   }
 }
 
+// -----------------------------------------------------------------------------
+// Verify that descriptions skipped by the index build are loaded for the first
+// description search, and that a cancelled load is retried by the next one.
+// -----------------------------------------------------------------------------
+TEST_CASE("Description search loads descriptions after a browse built the index")
+{
+  reset_backend_globals();
+
+  REQUIRE(!dnf_backend_get_browse_package_rows_interruptible(nullptr).empty());
+
+  GCancellable *cancellable = g_cancellable_new();
+  g_cancellable_cancel(cancellable);
+  REQUIRE(dnf_backend_search_package_rows_interruptible("bourne", { .search_in_description = true }, cancellable)
+              .empty());
+  g_object_unref(cancellable);
+
+  auto rows = dnf_backend_search_package_rows_interruptible("bourne", { .search_in_description = true }, nullptr);
+  REQUIRE(std::any_of(rows.begin(), rows.end(), [](const PackageRow &row) { return row.name == "bash"; }));
+}
+
 // -----------------------------------------------------------------------------
 // Verify that an impossible package name produces an empty result.
 // -----------------------------------------------------------------------------
@@ -64,3 +91,312 @@ TEST_CASE("Search returns empty for impossible package name")
 
   REQUIRE(results.empty());
 }
+
+// -----------------------------------------------------------------------------
+// Verify that a longer trigram-indexed pattern only narrows a shorter one.
+// -----------------------------------------------------------------------------
+TEST_CASE("Search longer substring returns subset of shorter substring")
+{
+  reset_backend_globals();
+
+  set_backend_search_options(false, false);
+  auto shorter = package_row_nevras(dnf_backend_search_package_rows_interruptible("as", nullptr));
+  auto longer = dnf_backend_search_package_rows_interruptible("bash", nullptr);
+
+  REQUIRE(!longer.empty());
+  for (const auto &row : longer) {
+    INFO(row.nevra);
+    REQUIRE(shorter.count(row.nevra) == 1);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that indexed substring search matches inside package names.
+// -----------------------------------------------------------------------------
+TEST_CASE("Search contains mode matches the middle of a package name")
+{
+  reset_backend_globals();
+
+  set_backend_search_options(false, false);
+  auto results = dnf_backend_search_package_rows_interruptible("ash", nullptr);
+
+  bool found_bash = false;
+  for (const auto &row : results) {
+    if (row.name == "bash") {
+      found_bash = true;
+    }
+  }
+  REQUIRE(found_bash);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that indexed search is case-insensitive like the installed filter.
+// -----------------------------------------------------------------------------
+TEST_CASE("Search contains mode ignores pattern case")
+{
+  reset_backend_globals();
+
+  set_backend_search_options(true, false);
+  auto lower = package_row_nevras(dnf_backend_search_package_rows_interruptible("shell", nullptr));
+  auto upper = package_row_nevras(dnf_backend_search_package_rows_interruptible("SHELL", nullptr));
+
+  REQUIRE(lower == upper);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that refining a cached broader search matches a fresh backend search.
+// -----------------------------------------------------------------------------
+TEST_CASE("Refined cached search matches the backend search")
+{
+  reset_backend_globals();
+  package_query_cache_clear();
+
+  set_backend_search_options(false, false);
+  package_query_cache_store(package_query_cache_key_for("ba"),
+                            1,
+                            std::make_shared<const std::vector<PackageRow>>(
+                                dnf_backend_search_package_rows_interruptible("ba", nullptr)));
+
+  SharedPackageRows refined;
+  REQUIRE(package_query_cache_refine("bash", 1, refined));
+  auto backend = dnf_backend_search_package_rows_interruptible("bash", nullptr);
+
+  REQUIRE(refined->size() == backend.size());
+  for (size_t i = 0; i < backend.size(); ++i) {
+    REQUIRE((*refined)[i].nevra == backend[i].nevra);
+  }
+
+  package_query_cache_clear();
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a search limited to some names returns the full search rows of
+// exactly those names, in the same order.
+// -----------------------------------------------------------------------------
+TEST_CASE("Name-limited search matches the full search for those names")
+{
+  reset_backend_globals();
+
+  auto full = dnf_backend_search_package_rows_interruptible("ba", nullptr);
+  REQUIRE_FALSE(full.empty());
+
+  std::set<std::string> names;
+  for (size_t i = 0; i < full.size(); i += 2) {
+    names.insert(full[i].name.str());
+  }
+
+  std::vector<std::string> expected;
+  for (const auto &row : full) {
+    if (names.count(row.name.str()) > 0) {
+      expected.push_back(row.nevra.str());
+    }
+  }
+
+  auto limited = dnf_backend_search_package_rows_for_names("ba", dnf_backend_get_search_options(), names, nullptr);
+  REQUIRE(limited.size() == expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    REQUIRE(limited[i].nevra == expected[i]);
+  }
+  REQUIRE(dnf_backend_search_package_rows_for_names("ba", dnf_backend_get_search_options(), {}, nullptr).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a search with explicit flags ignores the published ones.
+// -----------------------------------------------------------------------------
+TEST_CASE("Search with explicit options matches the published-flag search")
+{
+  reset_backend_globals();
+
+  set_backend_search_options(false, true);
+  auto exact = dnf_backend_search_package_rows_interruptible("bash", nullptr);
+
+  set_backend_search_options(true, false);
+  auto explicit_exact = dnf_backend_search_package_rows_interruptible("bash", { .exact_match = true }, nullptr);
+  REQUIRE(package_row_nevras(explicit_exact) == package_row_nevras(exact));
+}
+
+// -----------------------------------------------------------------------------
+// Return the expected search rank of one ASCII package name.
+// -----------------------------------------------------------------------------
+static int
+expected_search_rank(const std::string &name, const std::string &pattern)
+{
+  if (name == pattern) {
+    return 0;
+  }
+  if (name.rfind(pattern, 0) == 0) {
+    return 1;
+  }
+  return name.find(pattern) != std::string::npos ? 2 : 3;
+}
+
+// -----------------------------------------------------------------------------
+// Verify that ranked search orders names by exact, prefix, and substring hits
+// and counts every match of the unranked search.
+// -----------------------------------------------------------------------------
+TEST_CASE("Ranked search orders exact and prefix name matches first")
+{
+  reset_backend_globals();
+
+  set_backend_search_options(false, false);
+  auto unranked = dnf_backend_search_package_rows_interruptible("bash", nullptr);
+  REQUIRE(!unranked.empty());
+
+  PackageSearchPage page = dnf_backend_search_package_rows_ranked("bash", 0, 10, nullptr);
+  REQUIRE(page.total_matches == unranked.size());
+  REQUIRE(page.rows.size() == std::min<size_t>(10, unranked.size()));
+  REQUIRE(page.more_available() == unranked.size() - page.rows.size());
+
+  for (size_t i = 1; i < page.rows.size(); ++i) {
+    INFO(page.rows[i].name);
+    REQUIRE(expected_search_rank(page.rows[i - 1].name, "bash") <= expected_search_rank(page.rows[i].name, "bash"));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Verify that paging through ranked search returns every unranked match once.
+// -----------------------------------------------------------------------------
+TEST_CASE("Ranked search pages cover the unranked result")
+{
+  reset_backend_globals();
+
+  set_backend_search_options(true, false);
+  auto unranked = dnf_backend_search_package_rows_interruptible("shell", nullptr);
+
+  std::vector<PackageRow> paged;
+  size_t offset = 0;
+  for (;;) {
+    PackageSearchPage page = dnf_backend_search_package_rows_ranked("shell", offset, 7, nullptr);
+    REQUIRE(page.total_matches == unranked.size());
+    paged.insert(paged.end(), page.rows.begin(), page.rows.end());
+    offset += page.rows.size();
+    if (page.more_available() == 0) {
+      break;
+    }
+    REQUIRE(!page.rows.empty());
+  }
+
+  REQUIRE(paged.size() == unranked.size());
+  REQUIRE(package_row_nevras(paged) == package_row_nevras(unranked));
+
+  PackageSearchPage everything = dnf_backend_search_package_rows_ranked("shell", 0, unranked.size(), nullptr);
+  REQUIRE(everything.rows.size() == paged.size());
+  for (size_t i = 0; i < paged.size(); ++i) {
+    REQUIRE(everything.rows[i].nevra == paged[i].nevra);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Return true when rows hold a row for the package name.
+// -----------------------------------------------------------------------------
+static bool
+rows_contain_name(const std::vector<PackageRow> &rows, const std::string &name)
+{
+  return std::any_of(rows.begin(), rows.end(), [&name](const PackageRow &row) { return row.name == name; });
+}
+
+// -----------------------------------------------------------------------------
+// Verify that file search finds the owner of an installed path by exact path,
+// path prefix, and glob, and that prefix results cover the exact ones.
+// -----------------------------------------------------------------------------
+TEST_CASE("File search finds the package owning an installed path")
+{
+  reset_backend_globals();
+
+  dnf_backend_set_search_options({ .exact_match = true, .search_in_files = true });
+  auto exact = dnf_backend_search_package_rows_interruptible("/usr/bin/bash", nullptr);
+  REQUIRE(rows_contain_name(exact, "bash"));
+
+  dnf_backend_set_search_options({ .search_in_files = true });
+  auto prefix = dnf_backend_search_package_rows_interruptible("/usr/bin/bas", nullptr);
+  REQUIRE(rows_contain_name(prefix, "bash"));
+  auto prefix_nevras = package_row_nevras(prefix);
+  for (const auto &nevra : package_row_nevras(exact)) {
+    REQUIRE(prefix_nevras.count(nevra) > 0);
+  }
+
+  auto glob = dnf_backend_search_package_rows_interruptible("/usr/*/ba?h", nullptr);
+  REQUIRE(rows_contain_name(glob, "bash"));
+
+  dnf_backend_set_search_options({ .exact_match = true, .search_in_files = true });
+  REQUIRE(dnf_backend_search_package_rows_interruptible("/usr/bin/bas", nullptr).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a file search pattern without a leading slash matches provides.
+// -----------------------------------------------------------------------------
+TEST_CASE("File search matches provides for non-path patterns")
+{
+  reset_backend_globals();
+
+  dnf_backend_set_search_options({ .search_in_files = true });
+  auto rows = dnf_backend_search_package_rows_interruptible("libc.so.6*", nullptr);
+  REQUIRE(rows_contain_name(rows, "glibc"));
+  REQUIRE(dnf_backend_search_package_rows_interruptible("dnfui-no-such-capability-xyz", nullptr).empty());
+
+  PackageSearchPage page = dnf_backend_search_package_rows_ranked("libc.so.6*", 0, rows.size(), nullptr);
+  REQUIRE(page.total_matches == rows.size());
+  REQUIRE(package_row_nevras(page.rows) == package_row_nevras(rows));
+}
+
+// -----------------------------------------------------------------------------
+// Return whether text matches pattern using a GLib casefolded copy of both,
+// which is the reference the fast matching kernel must agree with.
+// -----------------------------------------------------------------------------
+static bool
+reference_casefold_matches(const std::string &text, const std::string &pattern, bool exact_match)
+{
+  char *text_folded = g_utf8_casefold(text.c_str(), -1);
+  char *pattern_folded = g_utf8_casefold(pattern.c_str(), -1);
+  const std::string folded_text = text_folded;
+  const std::string folded_pattern = pattern_folded;
+  g_free(text_folded);
+  g_free(pattern_folded);
+
+  return exact_match ? folded_text == folded_pattern : folded_text.find(folded_pattern) != std::string::npos;
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the ASCII matching fast path ignores case like GLib casefolding.
+// -----------------------------------------------------------------------------
+TEST_CASE("Casefold matching handles ASCII text in place")
+{
+  REQUIRE(dnf_backend_testonly_casefold_matches("NetworkManager-Wifi", "manager-wifi", false));
+  REQUIRE(dnf_backend_testonly_casefold_matches("NetworkManager-Wifi", "NETWORK", false));
+  REQUIRE(dnf_backend_testonly_casefold_matches("bash", "BASH", true));
+  REQUIRE(dnf_backend_testonly_casefold_matches("bash", "", false));
+  REQUIRE_FALSE(dnf_backend_testonly_casefold_matches("bash", "bash-completion", false));
+  REQUIRE_FALSE(dnf_backend_testonly_casefold_matches("bash-completion", "bash", true));
+  REQUIRE_FALSE(dnf_backend_testonly_casefold_matches("libfoo", "libfoo_", false));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that ASCII and non-ASCII text match exactly like GLib casefolded
+// copies, including non-ASCII patterns that fold to ASCII.
+// -----------------------------------------------------------------------------
+TEST_CASE("Casefold matching agrees with GLib casefolding")
+{
+  const std::vector<std::string> texts = {
+    "python3-Requests",
+    "A library for CAFÉ ordering",
+    "Straße navigation tools",
+    "KELVIN scale converter",
+    "GNOME Shell extension for Ünïcode input",
+    "",
+  };
+  const std::vector<std::string> patterns = {
+    "requests", "café", "CAFÉ", "strasse", "straße", "\u212a" "elvin", "ÜNÏCODE", "shell", "x", "",
+  };
+
+  for (const auto &text : texts) {
+    for (const auto &pattern : patterns) {
+      for (bool exact_match : { false, true }) {
+        INFO(text);
+        INFO(pattern);
+        INFO(exact_match);
+        REQUIRE(dnf_backend_testonly_casefold_matches(text, pattern, exact_match) ==
+                reference_casefold_matches(text, pattern, exact_match));
+      }
+    }
+  }
+}
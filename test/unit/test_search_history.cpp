@@ -0,0 +1,97 @@
+// -----------------------------------------------------------------------------
+// Search history tests
+// Covers use counting, frequency order, and the text file round trip.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/search_history.hpp"
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Verify that repeated terms are counted once in place and keep their latest
+// flags, and that terms the file format cannot hold are skipped.
+// -----------------------------------------------------------------------------
+TEST_CASE("Search history counts repeated terms in place")
+{
+  std::vector<SearchHistoryEntry> history;
+  REQUIRE(search_history_record_use(history, "bash", {}));
+  REQUIRE(search_history_record_use(history, "python", {}));
+  REQUIRE_FALSE(search_history_record_use(history, "bash", { .exact_match = true }));
+  REQUIRE_FALSE(search_history_record_use(history, "", {}));
+  REQUIRE_FALSE(search_history_record_use(history, "two\tfields", {}));
+
+  REQUIRE(history.size() == 2);
+  REQUIRE(history[0].term == "bash");
+  REQUIRE(history[0].uses == 2);
+  REQUIRE(history[0].options.exact_match);
+  REQUIRE(history[1].term == "python");
+  REQUIRE(history[1].uses == 1);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the most frequent entries come first and ties keep history order.
+// -----------------------------------------------------------------------------
+TEST_CASE("Search history returns the most used terms first")
+{
+  std::vector<SearchHistoryEntry> history = {
+    { "a", {}, 1 },
+    { "b", {}, 5 },
+    { "c", {}, 3 },
+    { "d", {}, 5 },
+  };
+
+  auto frequent = search_history_most_frequent(history, 3);
+  REQUIRE(frequent.size() == 3);
+  REQUIRE(frequent[0].term == "b");
+  REQUIRE(frequent[1].term == "d");
+  REQUIRE(frequent[2].term == "c");
+  REQUIRE(search_history_most_frequent(history, 0).empty());
+  REQUIRE(search_history_most_frequent(history, 10).size() == history.size());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that terms, counts, and flags come back from the encoded form.
+// -----------------------------------------------------------------------------
+TEST_CASE("Search history round-trips terms, counts, and flags")
+{
+  std::vector<SearchHistoryEntry> history = {
+    { "gtk4", { .search_in_description = true }, 7 },
+    { "/usr/bin/python3", { .exact_match = true, .search_in_files = true }, 2 },
+    { "libc.so.6 with spaces", { .search_in_files = true }, 1 },
+  };
+
+  std::vector<SearchHistoryEntry> decoded;
+  REQUIRE(search_history_decode(search_history_encode(history), decoded));
+  REQUIRE(decoded.size() == history.size());
+  for (size_t i = 0; i < history.size(); ++i) {
+    REQUIRE(decoded[i].term == history[i].term);
+    REQUIRE(decoded[i].uses == history[i].uses);
+    REQUIRE(decoded[i].options.search_in_description == history[i].options.search_in_description);
+    REQUIRE(decoded[i].options.exact_match == history[i].options.exact_match);
+    REQUIRE(decoded[i].options.search_in_files == history[i].options.search_in_files);
+  }
+
+  REQUIRE(search_history_decode(search_history_encode({}), decoded));
+  REQUIRE(decoded.empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that other versions and damaged lines are rejected without touching
+// the output.
+// -----------------------------------------------------------------------------
+TEST_CASE("Search history rejects damaged files")
+{
+  std::vector<SearchHistoryEntry> decoded = { { "kept", {}, 1 } };
+
+  REQUIRE_FALSE(search_history_decode("", decoded));
+  REQUIRE_FALSE(search_history_decode("dnfui-search-history 2\n1\t0\tbash\n", decoded));
+  REQUIRE_FALSE(search_history_decode("dnfui-search-history 1\n1\tbash\n", decoded));
+  REQUIRE_FALSE(search_history_decode("dnfui-search-history 1\nx\t0\tbash\n", decoded));
+  REQUIRE_FALSE(search_history_decode("dnfui-search-history 1\n1\t8\tbash\n", decoded));
+  REQUIRE_FALSE(search_history_decode("dnfui-search-history 1\n1\t0\t\n", decoded));
+
+  REQUIRE(decoded.size() == 1);
+  REQUIRE(decoded[0].term == "kept");
+}
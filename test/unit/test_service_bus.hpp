@@ -0,0 +1,281 @@
+// -----------------------------------------------------------------------------
+// test/unit/test_service_bus.hpp
+// Private-bus helpers for transaction service tests and tools
+//
+// Connects to a private test bus and calls the transaction service directly,
+// without the GUI-side client, so request errors and stages can be inspected.
+// -----------------------------------------------------------------------------
+#pragma once
+
+#include "service/transaction_service_dbus.hpp"
+
+#include <gio/gio.h>
+#include <gio/gunixfdlist.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+// -----------------------------------------------------------------------------
+// Connect directly to a private test bus address.
+// -----------------------------------------------------------------------------
+inline GDBusConnection *
+connect_to_test_bus(const char *bus_address, GError **error)
+{
+  return g_dbus_connection_new_for_address_sync(
+      bus_address,
+      static_cast<GDBusConnectionFlags>(G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                        G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+      nullptr,
+      nullptr,
+      error);
+}
+
+// -----------------------------------------------------------------------------
+// Ask the private test bus whether a name is owned. Returns false when the bus
+// did not answer.
+// -----------------------------------------------------------------------------
+inline bool
+query_bus_name_has_owner(GDBusConnection *connection, const char *service_name, bool &has_owner_out)
+{
+  GError *error = nullptr;
+  GVariant *reply = g_dbus_connection_call_sync(connection,
+                                                "org.freedesktop.DBus",
+                                                "/org/freedesktop/DBus",
+                                                "org.freedesktop.DBus",
+                                                "NameHasOwner",
+                                                g_variant_new("(s)", service_name),
+                                                G_VARIANT_TYPE("(b)"),
+                                                G_DBUS_CALL_FLAGS_NONE,
+                                                -1,
+                                                nullptr,
+                                                &error);
+  if (!reply) {
+    g_clear_error(&error);
+    return false;
+  }
+
+  gboolean has_owner = FALSE;
+  g_variant_get(reply, "(b)", &has_owner);
+  g_variant_unref(reply);
+  has_owner_out = has_owner;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when the private test bus reports that the service name is owned.
+// -----------------------------------------------------------------------------
+inline bool
+wait_for_bus_name_owner(GDBusConnection *connection, const char *service_name, int timeout_ms)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+  while (std::chrono::steady_clock::now() < deadline) {
+    bool has_owner = false;
+    if (query_bus_name_has_owner(connection, service_name, has_owner) && has_owner) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Return true when the private test bus reports that the service name is no
+// longer owned.
+// -----------------------------------------------------------------------------
+inline bool
+wait_for_bus_name_released(GDBusConnection *connection, const char *service_name, int timeout_ms)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+  while (std::chrono::steady_clock::now() < deadline) {
+    bool has_owner = true;
+    if (query_bus_name_has_owner(connection, service_name, has_owner) && !has_owner) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// Call StartTransaction directly so service-side request errors can be inspected.
+// -----------------------------------------------------------------------------
+inline bool
+call_start_transaction(GDBusConnection *connection,
+                       const char *install_spec,
+                       std::string &transaction_path_out,
+                       std::string &error_out)
+{
+  transaction_path_out.clear();
+  error_out.clear();
+
+  GVariantBuilder install_builder;
+  GVariantBuilder remove_builder;
+  GVariantBuilder reinstall_builder;
+  g_variant_builder_init(&install_builder, G_VARIANT_TYPE("as"));
+  g_variant_builder_init(&remove_builder, G_VARIANT_TYPE("as"));
+  g_variant_builder_init(&reinstall_builder, G_VARIANT_TYPE("as"));
+
+  if (install_spec && *install_spec) {
+    g_variant_builder_add(&install_builder, "s", install_spec);
+  }
+
+  GError *error = nullptr;
+  GVariant *reply =
+      g_dbus_connection_call_sync(connection,
+                                  kTransactionServiceName,
+                                  kTransactionServiceManagerPath,
+                                  kTransactionServiceManagerInterface,
+                                  "StartTransaction",
+                                  g_variant_new("(asasas)", &install_builder, &remove_builder, &reinstall_builder),
+                                  G_VARIANT_TYPE("(o)"),
+                                  G_DBUS_CALL_FLAGS_NONE,
+                                  -1,
+                                  nullptr,
+                                  &error);
+  if (!reply) {
+    error_out = error && error->message ? error->message : "";
+    g_clear_error(&error);
+    return false;
+  }
+
+  const char *transaction_path = nullptr;
+  g_variant_get(reply, "(&o)", &transaction_path);
+  if (transaction_path) {
+    transaction_path_out = transaction_path;
+  }
+  g_variant_unref(reply);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Call StartTransactionFd with a dup of fd so bulk request errors can be
+// inspected. Does not close fd.
+// -----------------------------------------------------------------------------
+inline bool
+call_start_transaction_fd(GDBusConnection *connection,
+                          int fd,
+                          std::string &transaction_path_out,
+                          std::string &error_out)
+{
+  transaction_path_out.clear();
+  error_out.clear();
+
+  GError *error = nullptr;
+  GUnixFDList *fd_list = g_unix_fd_list_new();
+  if (g_unix_fd_list_append(fd_list, fd, &error) < 0) {
+    error_out = error && error->message ? error->message : "";
+    g_clear_error(&error);
+    g_object_unref(fd_list);
+    return false;
+  }
+
+  GVariant *reply = g_dbus_connection_call_with_unix_fd_list_sync(connection,
+                                                                  kTransactionServiceName,
+                                                                  kTransactionServiceManagerPath,
+                                                                  kTransactionServiceManagerInterface,
+                                                                  "StartTransactionFd",
+                                                                  g_variant_new("(h)", 0),
+                                                                  G_VARIANT_TYPE("(o)"),
+                                                                  G_DBUS_CALL_FLAGS_NONE,
+                                                                  -1,
+                                                                  fd_list,
+                                                                  nullptr,
+                                                                  nullptr,
+                                                                  &error);
+  g_object_unref(fd_list);
+  if (!reply) {
+    error_out = error && error->message ? error->message : "";
+    g_clear_error(&error);
+    return false;
+  }
+
+  const char *transaction_path = nullptr;
+  g_variant_get(reply, "(&o)", &transaction_path);
+  if (transaction_path) {
+    transaction_path_out = transaction_path;
+  }
+  g_variant_unref(reply);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Call one argument-free request method and return the D-Bus error text.
+// -----------------------------------------------------------------------------
+inline bool
+call_request_method(GDBusConnection *connection,
+                    const std::string &transaction_path,
+                    const char *method_name,
+                    std::string &error_out)
+{
+  error_out.clear();
+
+  GError *error = nullptr;
+  GVariant *reply = g_dbus_connection_call_sync(connection,
+                                                kTransactionServiceName,
+                                                transaction_path.c_str(),
+                                                kTransactionServiceRequestInterface,
+                                                method_name,
+                                                nullptr,
+                                                nullptr,
+                                                G_DBUS_CALL_FLAGS_NONE,
+                                                -1,
+                                                nullptr,
+                                                &error);
+  if (!reply) {
+    error_out = error && error->message ? error->message : "";
+    g_clear_error(&error);
+    return false;
+  }
+
+  g_variant_unref(reply);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Read the stage name and finished flag of one request object.
+// -----------------------------------------------------------------------------
+inline bool
+call_get_result(GDBusConnection *connection,
+                const std::string &transaction_path,
+                std::string &stage_out,
+                bool &finished_out)
+{
+  stage_out.clear();
+  finished_out = false;
+
+  GError *error = nullptr;
+  GVariant *reply = g_dbus_connection_call_sync(connection,
+                                                kTransactionServiceName,
+                                                transaction_path.c_str(),
+                                                kTransactionServiceRequestInterface,
+                                                "GetResult",
+                                                nullptr,
+                                                G_VARIANT_TYPE("(sbbs)"),
+                                                G_DBUS_CALL_FLAGS_NONE,
+                                                -1,
+                                                nullptr,
+                                                &error);
+  if (!reply) {
+    g_clear_error(&error);
+    return false;
+  }
+
+  const char *stage = nullptr;
+  gboolean finished = FALSE;
+  gboolean success = FALSE;
+  const char *details = nullptr;
+  g_variant_get(reply, "(&sbb&s)", &stage, &finished, &success, &details);
+  stage_out = stage ? stage : "";
+  finished_out = finished;
+  g_variant_unref(reply);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,227 @@
+// -----------------------------------------------------------------------------
+// UI task executor tests
+// Covers the slot limits, the start order of the priority classes, queue wait
+// counters, and preemption of prefetch tasks.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/task_executor.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Shared state the test functions report into.
+// -----------------------------------------------------------------------------
+struct Probe {
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool gate_running = false;
+  bool gate_open = false;
+  bool prefetch_running = false;
+  bool saw_cancel = false;
+  bool task_cancellable_cancelled = false;
+  std::vector<UiTaskClass> order;
+
+  // ---------------------------------------------------------------------------
+  // Wait until done returns true, or give up after a few seconds.
+  // ---------------------------------------------------------------------------
+  template <typename Pred>
+  bool
+  wait_for(Pred done)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    return changed.wait_for(lock, std::chrono::seconds(5), done);
+  }
+};
+
+struct ProbeTaskData {
+  Probe *probe = nullptr;
+  UiTaskClass task_class = UiTaskClass::REFRESH;
+};
+
+// -----------------------------------------------------------------------------
+// Queue func for a new task of task_class and drop the local reference.
+// -----------------------------------------------------------------------------
+void
+queue_probe_task(UiTaskExecutor &executor,
+                 Probe &probe,
+                 UiTaskClass task_class,
+                 GTaskThreadFunc func,
+                 GCancellable *cancellable = nullptr)
+{
+  GTask *task = g_task_new(nullptr, cancellable, nullptr, nullptr);
+  g_task_set_task_data(
+      task, new ProbeTaskData { &probe, task_class }, [](gpointer p) { delete static_cast<ProbeTaskData *>(p); });
+  executor.run(task, func, task_class);
+  g_object_unref(task);
+}
+
+// -----------------------------------------------------------------------------
+// Hold the worker until the test opens the gate.
+// -----------------------------------------------------------------------------
+void
+on_gate_task(GTask *task, gpointer, gpointer task_data, GCancellable *)
+{
+  Probe *probe = static_cast<ProbeTaskData *>(task_data)->probe;
+  std::unique_lock<std::mutex> lock(probe->mutex);
+  probe->gate_running = true;
+  probe->changed.notify_all();
+  probe->changed.wait(lock, [probe]() { return probe->gate_open; });
+  g_task_return_boolean(task, TRUE);
+}
+
+// -----------------------------------------------------------------------------
+// Record the class of the task.
+// -----------------------------------------------------------------------------
+void
+on_record_task(GTask *task, gpointer, gpointer task_data, GCancellable *)
+{
+  auto *td = static_cast<ProbeTaskData *>(task_data);
+  {
+    std::lock_guard<std::mutex> lock(td->probe->mutex);
+    td->probe->order.push_back(td->task_class);
+  }
+  td->probe->changed.notify_all();
+  g_task_return_boolean(task, TRUE);
+}
+
+// -----------------------------------------------------------------------------
+// Spin until the cancellable passed to the function is cancelled.
+// -----------------------------------------------------------------------------
+void
+on_cancellable_prefetch_task(GTask *task, gpointer, gpointer task_data, GCancellable *cancellable)
+{
+  Probe *probe = static_cast<ProbeTaskData *>(task_data)->probe;
+  {
+    std::lock_guard<std::mutex> lock(probe->mutex);
+    probe->prefetch_running = true;
+  }
+  probe->changed.notify_all();
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!g_cancellable_is_cancelled(cancellable) && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  GCancellable *task_cancellable = g_task_get_cancellable(task);
+  {
+    std::lock_guard<std::mutex> lock(probe->mutex);
+    probe->saw_cancel = g_cancellable_is_cancelled(cancellable);
+    probe->task_cancellable_cancelled = task_cancellable && g_cancellable_is_cancelled(task_cancellable);
+    probe->order.push_back(UiTaskClass::PREFETCH);
+  }
+  probe->changed.notify_all();
+  g_task_return_boolean(task, TRUE);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Verify that lower classes leave workers free and every class gets one.
+// -----------------------------------------------------------------------------
+TEST_CASE("UI task slot limits keep workers free for interactive classes")
+{
+  REQUIRE(ui_task_class_slot_limit(UiTaskClass::DETAILS, 4) == 4);
+  REQUIRE(ui_task_class_slot_limit(UiTaskClass::QUERY, 4) == 3);
+  REQUIRE(ui_task_class_slot_limit(UiTaskClass::PREFETCH, 4) == 2);
+  REQUIRE(ui_task_class_slot_limit(UiTaskClass::REFRESH, 4) == 2);
+
+  REQUIRE(ui_task_class_slot_limit(UiTaskClass::DETAILS, 1) == 1);
+  REQUIRE(ui_task_class_slot_limit(UiTaskClass::QUERY, 1) == 1);
+  REQUIRE(ui_task_class_slot_limit(UiTaskClass::REFRESH, 1) == 1);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that queued tasks start highest class first and that the queue
+// counters follow each class from waiting to started.
+// -----------------------------------------------------------------------------
+TEST_CASE("UI task executor starts queued tasks by priority class")
+{
+  Probe probe;
+  UiTaskExecutor executor(1);
+
+  queue_probe_task(executor, probe, UiTaskClass::REFRESH, on_gate_task);
+  REQUIRE(probe.wait_for([&probe]() { return probe.gate_running; }));
+  queue_probe_task(executor, probe, UiTaskClass::REFRESH, on_record_task);
+  queue_probe_task(executor, probe, UiTaskClass::PREFETCH, on_record_task);
+  queue_probe_task(executor, probe, UiTaskClass::QUERY, on_record_task);
+  queue_probe_task(executor, probe, UiTaskClass::DETAILS, on_record_task);
+
+  // run() queues synchronously, so all four wait behind the gate here.
+  UiTaskExecutorStats stats = executor.stats();
+  REQUIRE(stats.busy == 1);
+  for (UiTaskClass task_class :
+       { UiTaskClass::DETAILS, UiTaskClass::QUERY, UiTaskClass::PREFETCH, UiTaskClass::REFRESH }) {
+    REQUIRE(stats.classes[static_cast<size_t>(task_class)].waiting == 1);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(probe.mutex);
+    probe.gate_open = true;
+  }
+  probe.changed.notify_all();
+  REQUIRE(probe.wait_for([&probe]() { return probe.order.size() == 4; }));
+
+  REQUIRE(probe.order == std::vector<UiTaskClass> {
+                             UiTaskClass::DETAILS, UiTaskClass::QUERY, UiTaskClass::PREFETCH, UiTaskClass::REFRESH });
+
+  stats = executor.stats();
+  REQUIRE(stats.workers == 1);
+  REQUIRE(stats.classes[static_cast<size_t>(UiTaskClass::REFRESH)].started == 2);
+  const UiTaskClassStats &details = stats.classes[static_cast<size_t>(UiTaskClass::DETAILS)];
+  REQUIRE(details.started == 1);
+  REQUIRE(details.waiting == 0);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a details load without a free worker cancels a running prefetch
+// through its own token, leaving the cancellable the prefetch shares untouched.
+// -----------------------------------------------------------------------------
+TEST_CASE("UI task executor preempts a running prefetch for a details load")
+{
+  Probe probe;
+  UiTaskExecutor executor(1);
+  GCancellable *shared = g_cancellable_new();
+
+  queue_probe_task(executor, probe, UiTaskClass::PREFETCH, on_cancellable_prefetch_task, shared);
+  REQUIRE(probe.wait_for([&probe]() { return probe.prefetch_running; }));
+  queue_probe_task(executor, probe, UiTaskClass::DETAILS, on_record_task, shared);
+  REQUIRE(probe.wait_for([&probe]() { return probe.order.size() == 2; }));
+
+  REQUIRE(probe.saw_cancel);
+  REQUIRE_FALSE(probe.task_cancellable_cancelled);
+  REQUIRE_FALSE(g_cancellable_is_cancelled(shared));
+  REQUIRE(probe.order == std::vector<UiTaskClass> { UiTaskClass::PREFETCH, UiTaskClass::DETAILS });
+
+  const UiTaskExecutorStats stats = executor.stats();
+  REQUIRE(stats.classes[static_cast<size_t>(UiTaskClass::PREFETCH)].preempted == 1);
+  REQUIRE(stats.classes[static_cast<size_t>(UiTaskClass::DETAILS)].started == 1);
+  g_object_unref(shared);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that cancelling the task's own cancellable still reaches a prefetch
+// function, which runs with the preemption token instead.
+// -----------------------------------------------------------------------------
+TEST_CASE("UI task executor forwards task cancellation to prefetch functions")
+{
+  Probe probe;
+  UiTaskExecutor executor(2);
+  GCancellable *cancellable = g_cancellable_new();
+
+  queue_probe_task(executor, probe, UiTaskClass::PREFETCH, on_cancellable_prefetch_task, cancellable);
+  REQUIRE(probe.wait_for([&probe]() { return probe.prefetch_running; }));
+  g_cancellable_cancel(cancellable);
+  REQUIRE(probe.wait_for([&probe]() { return probe.order.size() == 1; }));
+
+  REQUIRE(probe.saw_cancel);
+  REQUIRE(probe.task_cancellable_cancelled);
+  REQUIRE(executor.stats().classes[static_cast<size_t>(UiTaskClass::PREFETCH)].preempted == 0);
+  g_object_unref(cancellable);
+}
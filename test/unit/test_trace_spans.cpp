@@ -0,0 +1,81 @@
+// -----------------------------------------------------------------------------
+// Trace span tests
+// Covers scoped and split spans, per-thread ids, and the Chrome trace JSON.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "trace_spans.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Verify that nested scoped spans record in end order and that the outer span
+// covers the inner one.
+// -----------------------------------------------------------------------------
+TEST_CASE("Trace spans record nested scopes with detail")
+{
+  trace_spans_testonly_enable("dnfui-tests");
+  {
+    DNFUI_TRACE_SPAN("query", "outer");
+    {
+      DNFUI_TRACE_SPAN("details", "inner", std::string("bash-5.2-1.fc40.x86_64"));
+    }
+  }
+
+  std::vector<TraceSpanEvent> events = trace_spans_testonly_events();
+  REQUIRE(events.size() == 2);
+  REQUIRE(std::string(events[0].name) == "inner");
+  REQUIRE(std::string(events[0].category) == "details");
+  REQUIRE(events[0].detail == "bash-5.2-1.fc40.x86_64");
+  REQUIRE(std::string(events[1].name) == "outer");
+  REQUIRE(events[1].detail.empty());
+  REQUIRE(events[1].start_us <= events[0].start_us);
+  REQUIRE(events[0].start_us + events[0].duration_us <= events[1].start_us + events[1].duration_us);
+  REQUIRE(events[0].thread_id == events[1].thread_id);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a split span ending on another thread keeps its start time and
+// carries the id of the thread that ended it.
+// -----------------------------------------------------------------------------
+TEST_CASE("Trace spans record split spans from other threads")
+{
+  trace_spans_testonly_enable("dnfui-tests");
+  const uint64_t start_us = trace_spans_now_us();
+  std::thread worker([start_us]() { trace_spans_record("transaction", "apply request", start_us); });
+  worker.join();
+  {
+    DNFUI_TRACE_SPAN("transaction", "local");
+  }
+
+  std::vector<TraceSpanEvent> events = trace_spans_testonly_events();
+  REQUIRE(events.size() == 2);
+  REQUIRE(events[0].start_us == start_us);
+  REQUIRE(events[0].thread_id != 0);
+  REQUIRE(events[0].thread_id != events[1].thread_id);
+}
+
+// -----------------------------------------------------------------------------
+// Verify the JSON layout and that names and details are escaped.
+// -----------------------------------------------------------------------------
+TEST_CASE("Trace spans export escaped Chrome trace JSON")
+{
+  trace_spans_testonly_enable("dnfui \"tests\"");
+  {
+    DNFUI_TRACE_SPAN("details", "info", std::string("a\\b\nc"));
+  }
+
+  const std::string json = trace_spans_json();
+  REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0);
+  REQUIRE(json.find("\"ph\":\"M\"") != std::string::npos);
+  REQUIRE(json.find("\"name\":\"dnfui \\\"tests\\\"\"") != std::string::npos);
+  REQUIRE(json.find("\"name\":\"info\",\"cat\":\"details\",\"ph\":\"X\"") != std::string::npos);
+  REQUIRE(json.find("\"args\":{\"detail\":\"a\\\\b\\u000ac\"}") != std::string::npos);
+  REQUIRE(json.find("\"dropped_spans\":\"0\"") != std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// EOF
+// -----------------------------------------------------------------------------
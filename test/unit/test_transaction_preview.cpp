@@ -6,11 +6,14 @@
 // -----------------------------------------------------------------------------
 #include <catch2/catch_test_macros.hpp>
 
+#include "base_manager.hpp"
 #include "dnf_backend/dnf_backend.hpp"
 #include "test_utils.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -123,6 +126,59 @@ TEST_CASE("Transaction preview rejects mixed upgrade-all requests")
   REQUIRE(preview.empty());
 }
 
+// -----------------------------------------------------------------------------
+// Verify that a cancelled preview stops before dependency resolution starts.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction preview stops once cancelled")
+{
+  reset_backend_globals();
+
+  TransactionPreview preview;
+  std::string error;
+  std::vector<std::string> progress_lines;
+  ResolvedTransactionPtr resolved;
+  std::atomic<bool> cancel { true };
+  auto progress_cb = [&](const std::string &line) { progress_lines.push_back(line); };
+
+  bool ok = dnf_backend_preview_transaction({}, {}, {}, preview, error, progress_cb, true, &resolved, &cancel);
+
+  REQUIRE_FALSE(ok);
+  REQUIRE(error == "Transaction was cancelled.");
+  REQUIRE_FALSE(resolved);
+  REQUIRE_FALSE(progress_contains(progress_lines, "Resolving dependency changes..."));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the idle-fork preview skips the run while every fork is leased
+// instead of loading a fork or taking the write lock.
+// -----------------------------------------------------------------------------
+TEST_CASE("Idle-fork upgrade-all preview skips when no fork is idle")
+{
+  reset_backend_globals();
+  ScopedEnvVar skip_upgrade_all_job("DNFUI_TEST_SKIP_UPGRADE_ALL_GOAL_JOB", "1");
+
+  // A regular preview loads a fork when none exists yet.
+  TransactionPreview preview;
+  std::string error;
+  REQUIRE(dnf_backend_preview_transaction({}, {}, {}, preview, error, {}, true));
+
+  std::vector<BaseForkLease> held;
+  while (BaseForkLease lease = BaseManager::instance().acquire_idle_fork()) {
+    held.push_back(std::move(lease));
+  }
+  REQUIRE_FALSE(held.empty());
+
+  ResolvedTransactionPtr resolved;
+  REQUIRE_FALSE(dnf_backend_preview_upgrade_all_on_idle_fork(preview, error, &resolved));
+  REQUIRE_FALSE(resolved);
+
+  held.clear();
+  REQUIRE(dnf_backend_preview_upgrade_all_on_idle_fork(preview, error, &resolved));
+  INFO(error);
+  REQUIRE(resolved);
+  REQUIRE(dnf_backend_resolved_transaction_is_current(resolved));
+}
+
 // -----------------------------------------------------------------------------
 // Verify that apply refuses an empty upgrade all transaction.
 // -----------------------------------------------------------------------------
@@ -178,4 +234,42 @@ TEST_CASE("Transaction preview resolves a reinstall request for an installed pac
   REQUIRE(std::any_of(preview.reinstall.begin(), preview.reinstall.end(), [&](const std::string &label) {
     return label.find(installed_row.name + "-") != std::string::npos;
   }));
+
+  // Structured items carry the same packages as the label lists.
+  REQUIRE(preview.items.size() == preview.install.size() + preview.upgrade.size() + preview.downgrade.size() +
+                                      preview.reinstall.size() + preview.remove.size());
+  REQUIRE(std::all_of(preview.items.begin(), preview.items.end(), [](const TransactionPreviewItem &item) {
+    return !item.nevra.empty() && !item.repo.empty();
+  }));
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a preview resolution stays reusable only until the Base changes.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction preview resolution is tied to the Base generation")
+{
+  reset_backend_globals();
+
+  auto installed_rows = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+  REQUIRE_FALSE(installed_rows.empty());
+
+  TransactionPreview preview;
+  std::string error;
+  ResolvedTransactionPtr resolved;
+
+  bool ok =
+      dnf_backend_preview_transaction({}, {}, { installed_rows.front().nevra }, preview, error, {}, false, &resolved);
+
+  INFO(error);
+  REQUIRE(ok);
+  REQUIRE(resolved);
+  REQUIRE(dnf_backend_resolved_transaction_is_current(resolved));
+
+  BaseManager::instance().rebuild_system_only(BaseRebuildPolicy::FORCE);
+  REQUIRE_FALSE(dnf_backend_resolved_transaction_is_current(resolved));
+
+  // A failed preview must not hand back an older resolution.
+  ok = dnf_backend_preview_transaction({}, {}, {}, preview, error, {}, false, &resolved);
+  REQUIRE_FALSE(ok);
+  REQUIRE_FALSE(resolved);
 }
@@ -110,6 +110,22 @@ TEST_CASE("Transaction request validation rejects too many package actions")
   REQUIRE(error == "Transaction request contains too many package actions.");
 }
 
+// -----------------------------------------------------------------------------
+// Verify that bulk validation raises the item limit but still bounds it.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction request validation enforces the bulk item limit")
+{
+  TransactionRequest request;
+  std::string error;
+
+  request.install.assign(kTransactionRequestMaxItems + 1, "example-install-spec");
+  REQUIRE(request.validate(error, kTransactionRequestMaxBulkItems));
+
+  request.install.assign(kTransactionRequestMaxBulkItems + 1, "example-install-spec");
+  REQUIRE_FALSE(request.validate(error, kTransactionRequestMaxBulkItems));
+  REQUIRE(error == "Transaction request contains too many package actions.");
+}
+
 // -----------------------------------------------------------------------------
 // Verify that upgrade all cannot be combined with explicit package actions.
 // -----------------------------------------------------------------------------
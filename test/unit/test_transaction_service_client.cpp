@@ -8,18 +8,24 @@
 
 #include "dnf_backend/dnf_backend.hpp"
 #include "service/transaction_service_dbus.hpp"
+#include "service/transaction_service_query.hpp"
+#include "service/transaction_service_request_payload.hpp"
+#include "test_service_bus.hpp"
 #include "test_utils.hpp"
 #include "transaction_request.hpp"
 #include "transaction_service_client.hpp"
 
 #include <gio/gio.h>
 #include <glib/gstdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include <chrono>
 #include <cstdio>
 #include <future>
 #include <string>
 #include <thread>
+#include <vector>
 
 #ifndef DNFUI_TEST_SERVICE_BIN
 #define DNFUI_TEST_SERVICE_BIN ""
@@ -68,43 +74,6 @@ struct ScopedEnvironmentOverride {
   std::string value;
 };
 
-// -----------------------------------------------------------------------------
-// Return true when the private test bus reports that the service name is owned.
-// -----------------------------------------------------------------------------
-static bool
-wait_for_bus_name_owner(GDBusConnection *connection, const char *service_name, int timeout_ms)
-{
-  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
-
-  while (std::chrono::steady_clock::now() < deadline) {
-    GError *error = nullptr;
-    GVariant *reply = g_dbus_connection_call_sync(connection,
-                                                  "org.freedesktop.DBus",
-                                                  "/org/freedesktop/DBus",
-                                                  "org.freedesktop.DBus",
-                                                  "NameHasOwner",
-                                                  g_variant_new("(s)", service_name),
-                                                  G_VARIANT_TYPE("(b)"),
-                                                  G_DBUS_CALL_FLAGS_NONE,
-                                                  -1,
-                                                  nullptr,
-                                                  &error);
-    if (reply) {
-      gboolean has_owner = FALSE;
-      g_variant_get(reply, "(b)", &has_owner);
-      g_variant_unref(reply);
-      if (has_owner) {
-        return true;
-      }
-    }
-
-    g_clear_error(&error);
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-  }
-
-  return false;
-}
-
 // -----------------------------------------------------------------------------
 // Return true when the preview worker writes its started marker file.
 // -----------------------------------------------------------------------------
@@ -123,85 +92,13 @@ wait_for_file(const std::string &path, int timeout_ms)
   return false;
 }
 
-// -----------------------------------------------------------------------------
-// Call StartTransaction directly so service-side request errors can be inspected.
-// -----------------------------------------------------------------------------
-static bool
-call_start_transaction(GDBusConnection *connection,
-                       const char *install_spec,
-                       std::string &transaction_path_out,
-                       std::string &error_out)
-{
-  transaction_path_out.clear();
-  error_out.clear();
-
-  GVariantBuilder install_builder;
-  GVariantBuilder remove_builder;
-  GVariantBuilder reinstall_builder;
-  g_variant_builder_init(&install_builder, G_VARIANT_TYPE("as"));
-  g_variant_builder_init(&remove_builder, G_VARIANT_TYPE("as"));
-  g_variant_builder_init(&reinstall_builder, G_VARIANT_TYPE("as"));
-
-  if (install_spec && *install_spec) {
-    g_variant_builder_add(&install_builder, "s", install_spec);
-  }
-
-  GError *error = nullptr;
-  GVariant *reply =
-      g_dbus_connection_call_sync(connection,
-                                  kTransactionServiceName,
-                                  kTransactionServiceManagerPath,
-                                  kTransactionServiceManagerInterface,
-                                  "StartTransaction",
-                                  g_variant_new("(asasas)", &install_builder, &remove_builder, &reinstall_builder),
-                                  G_VARIANT_TYPE("(o)"),
-                                  G_DBUS_CALL_FLAGS_NONE,
-                                  -1,
-                                  nullptr,
-                                  &error);
-  if (!reply) {
-    error_out = error && error->message ? error->message : "";
-    g_clear_error(&error);
-    return false;
-  }
-
-  const char *transaction_path = nullptr;
-  g_variant_get(reply, "(&o)", &transaction_path);
-  if (transaction_path) {
-    transaction_path_out = transaction_path;
-  }
-  g_variant_unref(reply);
-  return true;
-}
-
 // -----------------------------------------------------------------------------
 // Call Apply directly on a request object and return the D-Bus error text.
 // -----------------------------------------------------------------------------
 static bool
 call_apply_transaction(GDBusConnection *connection, const std::string &transaction_path, std::string &error_out)
 {
-  error_out.clear();
-
-  GError *error = nullptr;
-  GVariant *reply = g_dbus_connection_call_sync(connection,
-                                                kTransactionServiceName,
-                                                transaction_path.c_str(),
-                                                kTransactionServiceRequestInterface,
-                                                "Apply",
-                                                nullptr,
-                                                nullptr,
-                                                G_DBUS_CALL_FLAGS_NONE,
-                                                -1,
-                                                nullptr,
-                                                &error);
-  if (!reply) {
-    error_out = error && error->message ? error->message : "";
-    g_clear_error(&error);
-    return false;
-  }
-
-  g_variant_unref(reply);
-  return true;
+  return call_request_method(connection, transaction_path, "Apply", error_out);
 }
 
 } // namespace
@@ -360,6 +257,415 @@ TEST_CASE("Transaction service rejects too many active requests from one client"
   g_object_unref(test_bus);
 }
 
+// -----------------------------------------------------------------------------
+// Verify that an idle service stays up while a request object is left, and
+// releases its name and exits once the last one was released.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service exits after the idle timeout")
+{
+  REQUIRE(std::string(DNFUI_TEST_SERVICE_BIN).size() > 0);
+
+  GTestDBus *test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  REQUIRE(test_bus != nullptr);
+  g_test_dbus_up(test_bus);
+
+  const char *bus_address = g_test_dbus_get_bus_address(test_bus);
+  REQUIRE(bus_address != nullptr);
+
+  GError *error = nullptr;
+  gchar *temp_dir = g_dir_make_tmp("dnfui-service-idle-XXXXXX", &error);
+  std::string error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(temp_dir != nullptr);
+
+  // The test-only hook reports each idle check that a live request put off.
+  std::string deferred_file = std::string(temp_dir) + "/idle-exit-deferred";
+
+  GSubprocessLauncher *launcher = g_subprocess_launcher_new(
+      static_cast<GSubprocessFlags>(G_SUBPROCESS_FLAGS_STDOUT_SILENCE | G_SUBPROCESS_FLAGS_STDERR_SILENCE));
+  REQUIRE(launcher != nullptr);
+  g_subprocess_launcher_setenv(launcher, "DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE);
+  g_subprocess_launcher_setenv(launcher, "DNFUI_TEST_IDLE_EXIT_DEFERRED_FILE", deferred_file.c_str(), TRUE);
+
+  const char *service_argv[] = {
+    DNFUI_TEST_SERVICE_BIN,
+    "--session",
+    "--idle-exit=0.2",
+    nullptr,
+  };
+  GSubprocess *service = g_subprocess_launcher_spawnv(launcher, service_argv, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(service != nullptr);
+  g_object_unref(launcher);
+
+  GDBusConnection *connection = connect_to_test_bus(bus_address, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(connection != nullptr);
+  REQUIRE(wait_for_bus_name_owner(connection, kTransactionServiceName, 5000));
+
+  std::string transaction_path;
+  std::string start_error;
+  REQUIRE(call_start_transaction(connection, "bash", transaction_path, start_error));
+
+  // The request object is still there, so the idle check passes unused.
+  REQUIRE(wait_for_file(deferred_file, 5000));
+  bool has_owner = false;
+  REQUIRE(query_bus_name_has_owner(connection, kTransactionServiceName, has_owner));
+  REQUIRE(has_owner);
+
+  std::string release_error;
+  REQUIRE(call_request_method(connection, transaction_path, "Release", release_error));
+
+  // A running preview finishes before the release removes the request object.
+  REQUIRE(wait_for_bus_name_released(connection, kTransactionServiceName, 60000));
+  REQUIRE(g_subprocess_wait(service, nullptr, &error));
+  REQUIRE(g_subprocess_get_if_exited(service));
+  REQUIRE(g_subprocess_get_exit_status(service) == 0);
+
+  g_object_unref(connection);
+  g_object_unref(service);
+  g_remove(deferred_file.c_str());
+  g_rmdir(temp_dir);
+  g_free(temp_dir);
+  g_test_dbus_down(test_bus);
+  g_object_unref(test_bus);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the service accepts one sealed bulk request per client and
+// rejects unsealed fds.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service accepts bulk requests through a sealed fd")
+{
+  REQUIRE(std::string(DNFUI_TEST_SERVICE_BIN).size() > 0);
+
+  GTestDBus *test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  REQUIRE(test_bus != nullptr);
+  g_test_dbus_up(test_bus);
+
+  ScopedEnvironmentOverride session_bus_address_env("DBUS_SESSION_BUS_ADDRESS");
+  ScopedEnvironmentOverride transaction_bus_env("DNFUI_TRANSACTION_BUS");
+
+  const char *bus_address = g_test_dbus_get_bus_address(test_bus);
+  REQUIRE(bus_address != nullptr);
+  REQUIRE(g_setenv("DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE));
+  REQUIRE(g_setenv("DNFUI_TRANSACTION_BUS", "session", TRUE));
+
+  GError *error = nullptr;
+  GSubprocessLauncher *launcher = g_subprocess_launcher_new(
+      static_cast<GSubprocessFlags>(G_SUBPROCESS_FLAGS_STDOUT_SILENCE | G_SUBPROCESS_FLAGS_STDERR_SILENCE));
+  REQUIRE(launcher != nullptr);
+  g_subprocess_launcher_setenv(launcher, "DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE);
+  g_subprocess_launcher_setenv(launcher, "DNFUI_TEST_PREVIEW_DELAY_MS", "10000", TRUE);
+
+  const char *service_argv[] = {
+    DNFUI_TEST_SERVICE_BIN,
+    "--session",
+    nullptr,
+  };
+  GSubprocess *service = g_subprocess_launcher_spawnv(launcher, service_argv, &error);
+  std::string error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(service != nullptr);
+  g_object_unref(launcher);
+
+  GDBusConnection *connection = connect_to_test_bus(bus_address, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(connection != nullptr);
+  REQUIRE(wait_for_bus_name_owner(connection, kTransactionServiceName, 5000));
+
+  TransactionRequest request;
+  for (size_t i = 0; i < kTransactionRequestMaxItems + 44; i++) {
+    request.install.push_back("bulk-package-" + std::to_string(i));
+  }
+  const std::string payload = transaction_request_payload_encode(request);
+
+  const int unsealed = memfd_create("dnfui-request-test", MFD_CLOEXEC);
+  REQUIRE(unsealed >= 0);
+  REQUIRE(write(unsealed, payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+  REQUIRE(lseek(unsealed, 0, SEEK_SET) == 0);
+
+  std::string transaction_path;
+  std::string start_error;
+  REQUIRE_FALSE(call_start_transaction_fd(connection, unsealed, transaction_path, start_error));
+  REQUIRE(start_error.find("The transaction request payload is not sealed.") != std::string::npos);
+  close(unsealed);
+
+  const int sealed = transaction_request_payload_create_memfd(payload, start_error);
+  INFO(start_error);
+  REQUIRE(sealed >= 0);
+  REQUIRE(call_start_transaction_fd(connection, sealed, transaction_path, start_error));
+  REQUIRE_FALSE(transaction_path.empty());
+
+  // One live bulk request per client, while normal requests still fit.
+  std::string rejected_path;
+  REQUIRE_FALSE(call_start_transaction_fd(connection, sealed, rejected_path, start_error));
+  REQUIRE(start_error.find("This client already has an active bulk transaction request.") != std::string::npos);
+  REQUIRE(call_start_transaction(connection, "bash", rejected_path, start_error));
+  close(sealed);
+
+  // A small fd request still counts against the bulk limit.
+  TransactionRequest small_request;
+  small_request.install.push_back("bash");
+  const int small_sealed =
+      transaction_request_payload_create_memfd(transaction_request_payload_encode(small_request), start_error);
+  INFO(start_error);
+  REQUIRE(small_sealed >= 0);
+  REQUIRE_FALSE(call_start_transaction_fd(connection, small_sealed, rejected_path, start_error));
+  REQUIRE(start_error.find("This client already has an active bulk transaction request.") != std::string::npos);
+  close(small_sealed);
+
+  transaction_service_client_reset_for_tests();
+  g_object_unref(connection);
+  g_subprocess_force_exit(service);
+  g_object_unref(service);
+  g_test_dbus_down(test_bus);
+  g_object_unref(test_bus);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the read-only query methods reject bad arguments before they
+// touch the service package base.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service rejects malformed package queries")
+{
+  REQUIRE(std::string(DNFUI_TEST_SERVICE_BIN).size() > 0);
+
+  GTestDBus *test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  REQUIRE(test_bus != nullptr);
+  g_test_dbus_up(test_bus);
+
+  ScopedEnvironmentOverride session_bus_address_env("DBUS_SESSION_BUS_ADDRESS");
+  ScopedEnvironmentOverride transaction_bus_env("DNFUI_TRANSACTION_BUS");
+
+  const char *bus_address = g_test_dbus_get_bus_address(test_bus);
+  REQUIRE(bus_address != nullptr);
+  REQUIRE(g_setenv("DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE));
+  REQUIRE(g_setenv("DNFUI_TRANSACTION_BUS", "session", TRUE));
+
+  GError *error = nullptr;
+  GSubprocessLauncher *launcher = g_subprocess_launcher_new(
+      static_cast<GSubprocessFlags>(G_SUBPROCESS_FLAGS_STDOUT_SILENCE | G_SUBPROCESS_FLAGS_STDERR_SILENCE));
+  REQUIRE(launcher != nullptr);
+  g_subprocess_launcher_setenv(launcher, "DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE);
+
+  const char *service_argv[] = {
+    DNFUI_TEST_SERVICE_BIN,
+    "--session",
+    nullptr,
+  };
+  GSubprocess *service = g_subprocess_launcher_spawnv(launcher, service_argv, &error);
+  std::string error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(service != nullptr);
+  g_object_unref(launcher);
+
+  GDBusConnection *connection = connect_to_test_bus(bus_address, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(connection != nullptr);
+  REQUIRE(wait_for_bus_name_owner(connection, kTransactionServiceName, 5000));
+
+  TransactionServicePackagePage page;
+  std::string query_error;
+  REQUIRE_FALSE(transaction_service_client_search_packages("", DnfBackendSearchOptions(), 0, 50, page, query_error));
+  REQUIRE(query_error.find("The package query text is empty or too long.") != std::string::npos);
+
+  std::string details;
+  REQUIRE_FALSE(transaction_service_client_get_package_details(
+      std::string(kTransactionRequestMaxSpecLength + 1, 'x'), details, query_error));
+  REQUIRE(query_error.find("The package query text is empty or too long.") != std::string::npos);
+
+  GVariant *reply = g_dbus_connection_call_sync(connection,
+                                                kTransactionServiceName,
+                                                kTransactionServiceManagerPath,
+                                                kTransactionServiceManagerInterface,
+                                                "ListPackages",
+                                                g_variant_new("(suu)", "obsolete", 0u, 50u),
+                                                nullptr,
+                                                G_DBUS_CALL_FLAGS_NONE,
+                                                -1,
+                                                nullptr,
+                                                &error);
+  REQUIRE(reply == nullptr);
+  REQUIRE(error != nullptr);
+  REQUIRE(std::string(error->message).find("Unknown package view.") != std::string::npos);
+  g_clear_error(&error);
+
+  transaction_service_client_reset_for_tests();
+  g_object_unref(connection);
+  g_subprocess_force_exit(service);
+  g_object_unref(service);
+  g_test_dbus_down(test_bus);
+  g_object_unref(test_bus);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that previews beyond the worker limit wait in the queue instead of
+// failing, and that a queued preview can be cancelled.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service queues previews beyond the worker limit")
+{
+  REQUIRE(std::string(DNFUI_TEST_SERVICE_BIN).size() > 0);
+
+  GTestDBus *test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  REQUIRE(test_bus != nullptr);
+  g_test_dbus_up(test_bus);
+
+  ScopedEnvironmentOverride session_bus_address_env("DBUS_SESSION_BUS_ADDRESS");
+  ScopedEnvironmentOverride transaction_bus_env("DNFUI_TRANSACTION_BUS");
+
+  const char *bus_address = g_test_dbus_get_bus_address(test_bus);
+  REQUIRE(bus_address != nullptr);
+  REQUIRE(g_setenv("DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE));
+  REQUIRE(g_setenv("DNFUI_TRANSACTION_BUS", "session", TRUE));
+
+  GError *error = nullptr;
+  GSubprocessLauncher *launcher = g_subprocess_launcher_new(
+      static_cast<GSubprocessFlags>(G_SUBPROCESS_FLAGS_STDOUT_SILENCE | G_SUBPROCESS_FLAGS_STDERR_SILENCE));
+  REQUIRE(launcher != nullptr);
+  g_subprocess_launcher_setenv(launcher, "DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE);
+  g_subprocess_launcher_setenv(launcher, "DNFUI_TEST_PREVIEW_DELAY_MS", "10000", TRUE);
+
+  const char *service_argv[] = {
+    DNFUI_TEST_SERVICE_BIN,
+    "--session",
+    nullptr,
+  };
+  GSubprocess *service = g_subprocess_launcher_spawnv(launcher, service_argv, &error);
+  std::string error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(service != nullptr);
+  g_object_unref(launcher);
+
+  GDBusConnection *connection = connect_to_test_bus(bus_address, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(connection != nullptr);
+  REQUIRE(wait_for_bus_name_owner(connection, kTransactionServiceName, 5000));
+
+  // The service runs two previews at once, so the third one has to queue.
+  std::vector<std::string> transaction_paths;
+  for (int i = 0; i < 3; i++) {
+    std::string transaction_path;
+    std::string start_error;
+    REQUIRE(call_start_transaction(connection, "bash", transaction_path, start_error));
+    transaction_paths.push_back(transaction_path);
+  }
+
+  std::string cancel_error;
+  REQUIRE(call_request_method(connection, transaction_paths.back(), "Cancel", cancel_error));
+
+  std::string stage;
+  bool finished = false;
+  REQUIRE(call_get_result(connection, transaction_paths.back(), stage, finished));
+  REQUIRE(stage == "cancelled");
+  REQUIRE(finished);
+
+  for (size_t i = 0; i + 1 < transaction_paths.size(); i++) {
+    REQUIRE(call_get_result(connection, transaction_paths[i], stage, finished));
+    REQUIRE(stage == "preview-running");
+    REQUIRE_FALSE(finished);
+  }
+
+  transaction_service_client_reset_for_tests();
+  g_object_unref(connection);
+  g_subprocess_force_exit(service);
+  g_object_unref(service);
+  g_test_dbus_down(test_bus);
+  g_object_unref(test_bus);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that cancelling a ready preview also stops its package prefetch.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service cancel stops a running package prefetch")
+{
+  REQUIRE(std::string(DNFUI_TEST_SERVICE_BIN).size() > 0);
+
+  GTestDBus *test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  REQUIRE(test_bus != nullptr);
+  g_test_dbus_up(test_bus);
+
+  ScopedEnvironmentOverride session_bus_address_env("DBUS_SESSION_BUS_ADDRESS");
+  ScopedEnvironmentOverride transaction_bus_env("DNFUI_TRANSACTION_BUS");
+
+  const char *bus_address = g_test_dbus_get_bus_address(test_bus);
+  REQUIRE(bus_address != nullptr);
+  REQUIRE(g_setenv("DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE));
+  REQUIRE(g_setenv("DNFUI_TRANSACTION_BUS", "session", TRUE));
+
+  GError *error = nullptr;
+  gchar *temp_dir = g_dir_make_tmp("dnfui-service-prefetch-XXXXXX", &error);
+  std::string error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(temp_dir != nullptr);
+
+  // The test-only hook holds the prefetch until it sees the cancel flag.
+  std::string started_file = std::string(temp_dir) + "/prefetch-started";
+  std::string cancelled_file = std::string(temp_dir) + "/prefetch-cancelled";
+
+  GSubprocessLauncher *launcher = g_subprocess_launcher_new(
+      static_cast<GSubprocessFlags>(G_SUBPROCESS_FLAGS_STDOUT_SILENCE | G_SUBPROCESS_FLAGS_STDERR_SILENCE));
+  REQUIRE(launcher != nullptr);
+  g_subprocess_launcher_setenv(launcher, "DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE);
+  g_subprocess_launcher_setenv(launcher, "DNFUI_TEST_SKIP_UPGRADE_ALL_GOAL_JOB", "1", TRUE);
+  g_subprocess_launcher_setenv(launcher, "DNFUI_TEST_PREFETCH_STARTED_FILE", started_file.c_str(), TRUE);
+  g_subprocess_launcher_setenv(launcher, "DNFUI_TEST_PREFETCH_CANCELLED_FILE", cancelled_file.c_str(), TRUE);
+
+  const char *service_argv[] = {
+    DNFUI_TEST_SERVICE_BIN,
+    "--session",
+    "--prefetch-packages",
+    nullptr,
+  };
+  GSubprocess *service = g_subprocess_launcher_spawnv(launcher, service_argv, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(service != nullptr);
+  g_object_unref(launcher);
+
+  GDBusConnection *connection = connect_to_test_bus(bus_address, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(connection != nullptr);
+  REQUIRE(wait_for_bus_name_owner(connection, kTransactionServiceName, 5000));
+
+  TransactionPreview preview;
+  std::string transaction_path;
+  std::string preview_error;
+  REQUIRE(transaction_service_client_preview_upgrade_all_request(preview, transaction_path, preview_error));
+  INFO(preview_error);
+  REQUIRE_FALSE(transaction_path.empty());
+  REQUIRE(wait_for_file(started_file, 5000));
+  REQUIRE_FALSE(g_file_test(cancelled_file.c_str(), G_FILE_TEST_EXISTS));
+
+  std::string cancel_error;
+  REQUIRE(call_request_method(connection, transaction_path, "Cancel", cancel_error));
+  REQUIRE(wait_for_file(cancelled_file, 5000));
+
+  std::string stage;
+  bool finished = false;
+  REQUIRE(call_get_result(connection, transaction_path, stage, finished));
+  REQUIRE(stage == "cancelled");
+  REQUIRE(finished);
+
+  transaction_service_client_release_request(transaction_path);
+  transaction_service_client_reset_for_tests();
+  g_object_unref(connection);
+  g_subprocess_force_exit(service);
+  g_object_unref(service);
+  g_remove(started_file.c_str());
+  g_remove(cancelled_file.c_str());
+  g_rmdir(temp_dir);
+  g_free(temp_dir);
+  g_test_dbus_down(test_bus);
+  g_object_unref(test_bus);
+}
+
 // -----------------------------------------------------------------------------
 // Verify that package-list preview helper rejects upgrade-all requests.
 // -----------------------------------------------------------------------------
@@ -378,6 +684,29 @@ TEST_CASE("Transaction service client rejects upgrade-all through the package-li
   REQUIRE(preview.empty());
 }
 
+// -----------------------------------------------------------------------------
+// Verify that the client rejects a bulk request whose payload the service
+// would refuse, before it connects.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service client rejects oversized bulk request payloads")
+{
+  TransactionRequest request;
+  const size_t count = kTransactionRequestPayloadMaxBytes / kTransactionRequestMaxSpecLength + 1;
+  for (size_t i = 0; i < count; i++) {
+    request.install.push_back(std::to_string(i) + std::string(kTransactionRequestMaxSpecLength - 8, 'a'));
+  }
+  REQUIRE(request.item_count() > kTransactionRequestMaxItems);
+
+  TransactionPreview preview;
+  std::string transaction_path;
+  std::string error;
+
+  REQUIRE_FALSE(transaction_service_client_preview_request(request, preview, transaction_path, error));
+  REQUIRE(error == "The transaction request is too large. Mark fewer packages.");
+  REQUIRE(transaction_path.empty());
+  REQUIRE(preview.empty());
+}
+
 // -----------------------------------------------------------------------------
 // Verify that empty upgrade-all previews cannot be applied.
 // -----------------------------------------------------------------------------
@@ -441,3 +770,203 @@ TEST_CASE("Transaction service upgrade-all preview handles no available package
   g_test_dbus_down(test_bus);
   g_object_unref(test_bus);
 }
+
+// -----------------------------------------------------------------------------
+// Verify that asynchronous previews can share one connection and one thread.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service client pipelines asynchronous previews on one main context")
+{
+  REQUIRE(std::string(DNFUI_TEST_SERVICE_BIN).size() > 0);
+
+  GTestDBus *test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  REQUIRE(test_bus != nullptr);
+  g_test_dbus_up(test_bus);
+
+  ScopedEnvironmentOverride session_bus_address_env("DBUS_SESSION_BUS_ADDRESS");
+  ScopedEnvironmentOverride transaction_bus_env("DNFUI_TRANSACTION_BUS");
+
+  const char *bus_address = g_test_dbus_get_bus_address(test_bus);
+  REQUIRE(bus_address != nullptr);
+  REQUIRE(g_setenv("DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE));
+  REQUIRE(g_setenv("DNFUI_TRANSACTION_BUS", "session", TRUE));
+
+  GError *error = nullptr;
+  GSubprocessLauncher *launcher = g_subprocess_launcher_new(
+      static_cast<GSubprocessFlags>(G_SUBPROCESS_FLAGS_STDOUT_SILENCE | G_SUBPROCESS_FLAGS_STDERR_SILENCE));
+  REQUIRE(launcher != nullptr);
+  g_subprocess_launcher_setenv(launcher, "DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE);
+  g_subprocess_launcher_setenv(launcher, "DNFUI_TEST_FORCE_EMPTY_UPGRADE_ALL_PREVIEW", "1", TRUE);
+
+  const char *service_argv[] = {
+    DNFUI_TEST_SERVICE_BIN,
+    "--session",
+    nullptr,
+  };
+  GSubprocess *service = g_subprocess_launcher_spawnv(launcher, service_argv, &error);
+  std::string error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(service != nullptr);
+  g_object_unref(launcher);
+
+  GDBusConnection *connection = connect_to_test_bus(bus_address, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(connection != nullptr);
+  REQUIRE(wait_for_bus_name_owner(connection, kTransactionServiceName, 5000));
+
+  GMainContext *context = g_main_context_new();
+  g_main_context_push_thread_default(context);
+
+  // Both requests are started before either finishes, and neither callback may
+  // run from inside its start call.
+  std::vector<PreviewClientResult> results(2);
+  size_t completed = 0;
+  for (auto &result : results) {
+    transaction_service_client_preview_upgrade_all_request_async(
+        [&result, &completed](bool ok,
+                              const TransactionPreview &preview,
+                              const std::string &transaction_path,
+                              const std::string &preview_error) {
+          result.ok = ok;
+          result.preview = preview;
+          result.transaction_path = transaction_path;
+          result.error = preview_error;
+          ++completed;
+        });
+  }
+  REQUIRE(completed == 0);
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (completed < results.size() && std::chrono::steady_clock::now() < deadline) {
+    g_main_context_iteration(context, FALSE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  REQUIRE(completed == results.size());
+
+  for (const auto &result : results) {
+    INFO(result.error);
+    REQUIRE(result.ok);
+    REQUIRE(result.preview.empty());
+    REQUIRE_FALSE(result.transaction_path.empty());
+  }
+  REQUIRE(results[0].transaction_path != results[1].transaction_path);
+
+  for (const auto &result : results) {
+    transaction_service_client_release_request(result.transaction_path);
+  }
+
+  // Let late replies and subscription cleanup drain before the context goes.
+  for (int i = 0; i < 50 && g_main_context_pending(context); ++i) {
+    g_main_context_iteration(context, FALSE);
+  }
+  g_main_context_pop_thread_default(context);
+  g_main_context_unref(context);
+
+  transaction_service_client_reset_for_tests();
+  g_object_unref(connection);
+  g_subprocess_force_exit(service);
+  g_object_unref(service);
+  g_test_dbus_down(test_bus);
+  g_object_unref(test_bus);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a cancelled asynchronous preview reports one failure.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service client cancels asynchronous previews")
+{
+  REQUIRE(std::string(DNFUI_TEST_SERVICE_BIN).size() > 0);
+
+  GTestDBus *test_bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  REQUIRE(test_bus != nullptr);
+  g_test_dbus_up(test_bus);
+
+  ScopedEnvironmentOverride session_bus_address_env("DBUS_SESSION_BUS_ADDRESS");
+  ScopedEnvironmentOverride transaction_bus_env("DNFUI_TRANSACTION_BUS");
+
+  const char *bus_address = g_test_dbus_get_bus_address(test_bus);
+  REQUIRE(bus_address != nullptr);
+  REQUIRE(g_setenv("DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE));
+  REQUIRE(g_setenv("DNFUI_TRANSACTION_BUS", "session", TRUE));
+
+  GError *error = nullptr;
+  GSubprocessLauncher *launcher = g_subprocess_launcher_new(
+      static_cast<GSubprocessFlags>(G_SUBPROCESS_FLAGS_STDOUT_SILENCE | G_SUBPROCESS_FLAGS_STDERR_SILENCE));
+  REQUIRE(launcher != nullptr);
+  g_subprocess_launcher_setenv(launcher, "DBUS_SESSION_BUS_ADDRESS", bus_address, TRUE);
+  g_subprocess_launcher_setenv(launcher, "DNFUI_TEST_FORCE_EMPTY_UPGRADE_ALL_PREVIEW", "1", TRUE);
+
+  const char *service_argv[] = {
+    DNFUI_TEST_SERVICE_BIN,
+    "--session",
+    nullptr,
+  };
+  GSubprocess *service = g_subprocess_launcher_spawnv(launcher, service_argv, &error);
+  std::string error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(service != nullptr);
+  g_object_unref(launcher);
+
+  GDBusConnection *connection = connect_to_test_bus(bus_address, &error);
+  error_text = error && error->message ? error->message : "";
+  INFO(error_text);
+  REQUIRE(connection != nullptr);
+  REQUIRE(wait_for_bus_name_owner(connection, kTransactionServiceName, 5000));
+
+  GMainContext *context = g_main_context_new();
+  g_main_context_push_thread_default(context);
+
+  // The first preview is cancelled before it starts, the second one right
+  // after. Neither callback may run from inside the start or cancel call.
+  std::vector<PreviewClientResult> results(2);
+  std::vector<size_t> calls(results.size(), 0);
+  std::vector<GCancellable *> cancellables = { g_cancellable_new(), g_cancellable_new() };
+  g_cancellable_cancel(cancellables[0]);
+  for (size_t i = 0; i < results.size(); ++i) {
+    transaction_service_client_preview_upgrade_all_request_async(
+        [&results, &calls, i](bool ok,
+                              const TransactionPreview &preview,
+                              const std::string &transaction_path,
+                              const std::string &preview_error) {
+          results[i].ok = ok;
+          results[i].preview = preview;
+          results[i].transaction_path = transaction_path;
+          results[i].error = preview_error;
+          ++calls[i];
+        },
+        cancellables[i]);
+  }
+  g_cancellable_cancel(cancellables[1]);
+  REQUIRE(calls == std::vector<size_t> { 0, 0 });
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while ((calls[0] == 0 || calls[1] == 0) && std::chrono::steady_clock::now() < deadline) {
+    g_main_context_iteration(context, FALSE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  // Let the cancel and release calls drain before checking for extra calls.
+  for (int i = 0; i < 50 && g_main_context_pending(context); ++i) {
+    g_main_context_iteration(context, FALSE);
+  }
+  REQUIRE(calls == std::vector<size_t> { 1, 1 });
+  for (const auto &result : results) {
+    INFO(result.error);
+    REQUIRE_FALSE(result.ok);
+    REQUIRE(result.transaction_path.empty());
+    REQUIRE_FALSE(result.error.empty());
+  }
+
+  for (GCancellable *cancellable : cancellables) {
+    g_object_unref(cancellable);
+  }
+  g_main_context_pop_thread_default(context);
+  g_main_context_unref(context);
+
+  transaction_service_client_reset_for_tests();
+  g_object_unref(connection);
+  g_subprocess_force_exit(service);
+  g_object_unref(service);
+  g_test_dbus_down(test_bus);
+  g_object_unref(test_bus);
+}
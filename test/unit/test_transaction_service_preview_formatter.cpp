@@ -116,3 +116,24 @@ TEST_CASE("Transaction preview formatter describes positive and negative disk sp
   REQUIRE(install_summary.find("extra disk space will be used.") != std::string::npos);
   REQUIRE(remove_summary.find("of disk space will be freed.") != std::string::npos);
 }
+
+// -----------------------------------------------------------------------------
+// Verify that large previews send only counts with the ready state.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction preview result details drop package lists above the inline limit")
+{
+  TransactionPreview small_preview;
+  small_preview.install = { "demo-install-1-1.x86_64" };
+  REQUIRE(format_transaction_preview_result_details(small_preview) ==
+          format_transaction_preview_details(small_preview));
+
+  TransactionPreview large_preview;
+  for (size_t i = 0; i <= kTransactionPreviewInlineItemLimit; ++i) {
+    large_preview.upgrade.push_back("demo-upgrade-" + std::to_string(i) + "-1.x86_64");
+  }
+  const std::string details = format_transaction_preview_result_details(large_preview);
+  REQUIRE(details == format_transaction_preview_counts(large_preview));
+  REQUIRE(details.find("packages will be upgraded.") != std::string::npos);
+  REQUIRE(details.find("To be upgraded:") == std::string::npos);
+  REQUIRE(details.find("demo-upgrade-0-1.x86_64") == std::string::npos);
+}
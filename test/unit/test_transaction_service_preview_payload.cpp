@@ -0,0 +1,106 @@
+// -----------------------------------------------------------------------------
+// test/unit/test_transaction_service_preview_payload.cpp
+// Transaction preview bulk transfer tests
+// Covers the payload format and the sealed memfd the service hands to the
+// requesting client.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "dnf_backend/dnf_backend.hpp"
+#include "service/transaction_service_preview_payload.hpp"
+
+#include <cstdint>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+// Return one preview item with the given action and sizes.
+// -----------------------------------------------------------------------------
+static TransactionPreviewItem
+make_item(const std::string &nevra,
+          TransactionPreviewAction action,
+          uint64_t download_size = 0,
+          uint64_t install_size = 0,
+          PackageInstallReason reason = PackageInstallReason::USER)
+{
+  TransactionPreviewItem item;
+  item.nevra = nevra;
+  item.action = action;
+  item.repo = action == TransactionPreviewAction::REMOVE ? "@System" : "updates";
+  item.download_size = download_size;
+  item.install_size = install_size;
+  item.reason = reason;
+  return item;
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a sealed memfd round-trips every preview section.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction preview payload round-trips through a sealed memfd")
+{
+  TransactionPreview preview;
+  preview.add_item(make_item("demo-install-1-1.x86_64", TransactionPreviewAction::INSTALL, 1024, 4096));
+  preview.add_item(make_item("demo-upgrade-2-1.x86_64", TransactionPreviewAction::UPGRADE, 2048, 8192));
+  preview.add_item(make_item(
+      "demo-upgrade-lib-2-1.x86_64", TransactionPreviewAction::UPGRADE, 512, 1024, PackageInstallReason::DEPENDENCY));
+  preview.add_item(make_item("demo-remove-1-1.noarch", TransactionPreviewAction::REMOVE, 0, 16384));
+  preview.disk_space_delta = -8192;
+
+  std::string error;
+  const int fd = transaction_preview_payload_create_memfd(transaction_preview_payload_encode(preview), error);
+  INFO(error);
+  REQUIRE(fd >= 0);
+
+  // The seals keep writes out, so the reader sees exactly what was sent.
+  REQUIRE(write(fd, "x", 1) == -1);
+
+  TransactionPreview decoded;
+  REQUIRE(transaction_preview_payload_read_memfd(fd, decoded, error));
+  REQUIRE(decoded.install == preview.install);
+  REQUIRE(decoded.upgrade == preview.upgrade);
+  REQUIRE(decoded.downgrade.empty());
+  REQUIRE(decoded.reinstall.empty());
+  REQUIRE(decoded.remove == preview.remove);
+  REQUIRE(decoded.disk_space_delta == preview.disk_space_delta);
+  REQUIRE(decoded.items.size() == preview.items.size());
+  REQUIRE(decoded.download_size_total() == 3584);
+  REQUIRE(decoded.items[2].reason == PackageInstallReason::DEPENDENCY);
+  REQUIRE(decoded.items[2].install_size == 1024);
+  REQUIRE(decoded.items[3].action == TransactionPreviewAction::REMOVE);
+  REQUIRE(decoded.items[3].repo == "@System");
+  close(fd);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that unsealed fds and malformed payloads are rejected.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction preview payload rejects unsealed and malformed input")
+{
+  const std::string payload = transaction_preview_payload_encode(TransactionPreview());
+
+  const int fd = memfd_create("dnfui-preview-test", MFD_CLOEXEC);
+  REQUIRE(fd >= 0);
+  REQUIRE(write(fd, payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+
+  TransactionPreview decoded;
+  std::string error;
+  REQUIRE_FALSE(transaction_preview_payload_read_memfd(fd, decoded, error));
+  REQUIRE(error == "The preview payload is not sealed.");
+  close(fd);
+
+  REQUIRE(transaction_preview_payload_decode(payload.data(), payload.size(), decoded));
+  REQUIRE_FALSE(transaction_preview_payload_decode(payload.data(), payload.size() - 1, decoded));
+
+  const std::string overcount = "dnfui-preview 2\ndisk-space-delta 0\nitems 5\ninstall\tuser\t1\t1\tfedora\ta\n";
+  REQUIRE_FALSE(transaction_preview_payload_decode(overcount.data(), overcount.size(), decoded));
+  REQUIRE(decoded.empty());
+
+  const std::string unknown_action = "dnfui-preview 2\ndisk-space-delta 0\nitems 1\nobsolete\tuser\t1\t1\tfedora\ta\n";
+  REQUIRE_FALSE(transaction_preview_payload_decode(unknown_action.data(), unknown_action.size(), decoded));
+
+  const std::string older_format = "dnfui-preview 1\ndisk-space-delta 0\ninstall 0\n";
+  REQUIRE_FALSE(transaction_preview_payload_decode(older_format.data(), older_format.size(), decoded));
+  REQUIRE(decoded.empty());
+}
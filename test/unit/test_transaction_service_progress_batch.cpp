@@ -0,0 +1,58 @@
+// -----------------------------------------------------------------------------
+// test/unit/test_transaction_service_progress_batch.cpp
+// Transaction service progress batch tests
+// Covers how worker progress lines are collected and merged before the service
+// sends them to the GUI as one D-Bus signal.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "service/transaction_service_progress_batch.hpp"
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Verify that ordinary lines are kept in queue order and taken only once.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction progress batch keeps lines in queue order")
+{
+  TransactionProgressBatch batch;
+  REQUIRE(batch.empty());
+
+  batch.append("Loading package base...");
+  batch.append("Downloading: foo");
+  batch.append("Downloading: foo");
+
+  const std::vector<std::string> expected { "Loading package base...", "Downloading: foo", "Downloading: foo" };
+  REQUIRE(batch.take() == expected);
+  REQUIRE(batch.empty());
+  REQUIRE(batch.take().empty());
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a newer download percentage replaces the pending one in place.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction progress batch merges download percentages per package")
+{
+  TransactionProgressBatch batch;
+
+  batch.append("Downloading: foo");
+  batch.append("Download progress: foo (10%)");
+  batch.append("Downloading: bar (x86_64)");
+  batch.append("Download progress: bar (x86_64) (10%)");
+  batch.append("Download progress: foo (20%)");
+  batch.append("Download progress: bar (x86_64) (30%)");
+  batch.append("Download ready: foo");
+
+  REQUIRE(batch.take() == std::vector<std::string> {
+                              "Downloading: foo",
+                              "Download progress: foo (20%)",
+                              "Downloading: bar (x86_64)",
+                              "Download progress: bar (x86_64) (30%)",
+                              "Download ready: foo",
+                          });
+
+  // Lines after a take start a new batch instead of replacing sent ones.
+  batch.append("Download progress: foo (40%)");
+  REQUIRE(batch.take() == std::vector<std::string> { "Download progress: foo (40%)" });
+}
@@ -0,0 +1,99 @@
+// -----------------------------------------------------------------------------
+// test/unit/test_transaction_service_query.cpp
+// Transaction service package query tests
+// Covers the compact page format of the read-only query methods.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "dnf_backend/dnf_backend.hpp"
+#include "service/transaction_service_query.hpp"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Return one package row with the given name and repo.
+// -----------------------------------------------------------------------------
+static PackageRow
+make_row(const std::string &name, const std::string &repo)
+{
+  PackageRow row;
+  row.name = name;
+  row.epoch = "0";
+  row.version = "1.0";
+  row.release = "1.fc42";
+  row.arch = "x86_64";
+  row.repo = repo;
+  row.summary = name + " summary";
+  row.nevra = name + "-0:1.0-1.fc42.x86_64";
+  return row;
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a page round-trips its rows, states, total, and generation.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service package page round-trips through a variant")
+{
+  TransactionServicePackagePage page;
+  page.rows.push_back(make_row("demo-installed", "@System"));
+  page.rows.back().install_reason = PackageInstallReason::USER;
+  page.rows.back().repo_candidate_relation = PackageRepoCandidateRelation::NEWER;
+  page.rows.push_back(make_row("demo-available", "fedora"));
+  page.states = { PackageInstallState::UPGRADEABLE, PackageInstallState::AVAILABLE };
+  page.total = 40;
+  page.generation = 7;
+
+  GVariant *value = g_variant_ref_sink(transaction_service_package_page_to_variant(page));
+  TransactionServicePackagePage decoded;
+  REQUIRE(transaction_service_package_page_from_variant(value, decoded));
+  g_variant_unref(value);
+
+  REQUIRE(decoded.rows.size() == 2);
+  REQUIRE(decoded.rows[0].nevra == "demo-installed-0:1.0-1.fc42.x86_64");
+  REQUIRE(decoded.rows[0].repo == "@System");
+  REQUIRE(decoded.rows[0].summary == "demo-installed summary");
+  REQUIRE(decoded.rows[0].install_reason == PackageInstallReason::USER);
+  REQUIRE(decoded.rows[0].repo_candidate_relation == PackageRepoCandidateRelation::NEWER);
+  REQUIRE(decoded.rows[1].display_version() == "1.0-1.fc42");
+  REQUIRE(decoded.states == page.states);
+  REQUIRE(decoded.total == 40);
+  REQUIRE(decoded.generation == 7);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that unknown enum values and other value types are rejected.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service package page rejects unknown values")
+{
+  GVariantBuilder rows;
+  g_variant_builder_init(&rows, G_VARIANT_TYPE("a(ssssssssyyy)"));
+  g_variant_builder_add(&rows, "(ssssssssyyy)", "a-1-1.x86_64", "a", "0", "1", "1", "x86_64", "fedora", "", 0, 0, 99);
+  GVariant *value =
+      g_variant_ref_sink(g_variant_new(kTransactionServicePackagePageType, &rows, 1u, G_GUINT64_CONSTANT(1)));
+
+  TransactionServicePackagePage decoded;
+  REQUIRE_FALSE(transaction_service_package_page_from_variant(value, decoded));
+  REQUIRE(decoded.rows.empty());
+  g_variant_unref(value);
+
+  GVariant *other = g_variant_ref_sink(g_variant_new("(s)", "details"));
+  REQUIRE_FALSE(transaction_service_package_page_from_variant(other, decoded));
+  g_variant_unref(other);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that view names map both ways and unknown names are rejected.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service package views map to their D-Bus names")
+{
+  for (auto view : { TransactionServicePackageView::INSTALLED,
+                     TransactionServicePackageView::AVAILABLE,
+                     TransactionServicePackageView::UPGRADEABLE }) {
+    TransactionServicePackageView parsed = TransactionServicePackageView::INSTALLED;
+    REQUIRE(transaction_service_package_view_from_name(transaction_service_package_view_name(view), parsed));
+    REQUIRE(parsed == view);
+  }
+
+  TransactionServicePackageView parsed = TransactionServicePackageView::INSTALLED;
+  REQUIRE_FALSE(transaction_service_package_view_from_name("obsolete", parsed));
+  REQUIRE_FALSE(transaction_service_package_view_from_name(nullptr, parsed));
+}
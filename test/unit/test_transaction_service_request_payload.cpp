@@ -0,0 +1,110 @@
+// -----------------------------------------------------------------------------
+// test/unit/test_transaction_service_request_payload.cpp
+// Bulk transaction request transfer tests
+// Covers the request payload format and the sealed memfd the client passes to
+// StartTransactionFd.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "service/transaction_service_request_payload.hpp"
+#include "transaction_request.hpp"
+
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+// Verify that a sealed memfd round-trips a request beyond the D-Bus array limit.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction request payload round-trips a bulk request through a sealed memfd")
+{
+  // Enough specs that the payload spans several read chunks.
+  TransactionRequest request;
+  for (size_t i = 0; i < kTransactionRequestMaxItems * 16; i++) {
+    request.install.push_back("bulk-install-" + std::to_string(i));
+  }
+  request.remove.push_back("bulk-remove-1.0-1.x86_64");
+  request.reinstall.push_back("bulk-reinstall");
+
+  std::string error;
+  const int fd = transaction_request_payload_create_memfd(transaction_request_payload_encode(request), error);
+  INFO(error);
+  REQUIRE(fd >= 0);
+
+  // The seals keep writes out, so the service reads exactly what was sent.
+  REQUIRE(write(fd, "x", 1) == -1);
+
+  TransactionRequest decoded;
+  REQUIRE(transaction_request_payload_read_memfd(fd, decoded, error));
+  REQUIRE(decoded.install == request.install);
+  REQUIRE(decoded.remove == request.remove);
+  REQUIRE(decoded.reinstall == request.reinstall);
+  REQUIRE_FALSE(decoded.upgrade_all);
+  REQUIRE(decoded.validate(error, kTransactionRequestMaxBulkItems));
+  close(fd);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that unsealed fds and malformed payloads are rejected.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction request payload rejects unsealed and malformed input")
+{
+  TransactionRequest request;
+  request.install.push_back("bash");
+  const std::string payload = transaction_request_payload_encode(request);
+
+  const int fd = memfd_create("dnfui-request-test", MFD_CLOEXEC);
+  REQUIRE(fd >= 0);
+  REQUIRE(write(fd, payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+
+  TransactionRequest decoded;
+  std::string error;
+  REQUIRE_FALSE(transaction_request_payload_read_memfd(fd, decoded, error));
+  REQUIRE(error == "The transaction request payload is not sealed.");
+  close(fd);
+
+  REQUIRE(transaction_request_payload_decode(payload.data(), payload.size(), decoded, error));
+  REQUIRE(decoded.install == request.install);
+  REQUIRE_FALSE(transaction_request_payload_decode(payload.data(), payload.size() - 1, decoded, error));
+  REQUIRE(decoded.empty());
+
+  const std::string unknown_action = "dnfui-request 1\nupgrade\tbash\n";
+  REQUIRE_FALSE(transaction_request_payload_decode(unknown_action.data(), unknown_action.size(), decoded, error));
+  REQUIRE(error == "The transaction request payload contains an unknown action.");
+
+  const std::string empty_spec = "dnfui-request 1\ninstall\t\n";
+  REQUIRE_FALSE(transaction_request_payload_decode(empty_spec.data(), empty_spec.size(), decoded, error));
+
+  const std::string other_format = "dnfui-request 2\ninstall\tbash\n";
+  REQUIRE_FALSE(transaction_request_payload_decode(other_format.data(), other_format.size(), decoded, error));
+  REQUIRE(error == "The transaction request payload uses an unknown format.");
+}
+
+// -----------------------------------------------------------------------------
+// Verify that the item and spec limits stop the parser.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction request payload enforces the bulk limits")
+{
+  TransactionRequest request;
+  request.install.assign(kTransactionRequestMaxBulkItems + 1, "x");
+  std::string payload = transaction_request_payload_encode(request);
+
+  TransactionRequest decoded;
+  std::string error;
+  REQUIRE_FALSE(transaction_request_payload_decode(payload.data(), payload.size(), decoded, error));
+  REQUIRE(error == "Transaction request contains too many package actions.");
+  REQUIRE(decoded.empty());
+
+  request.install.assign(1, std::string(kTransactionRequestMaxSpecLength + 1, 'x'));
+  payload = transaction_request_payload_encode(request);
+  REQUIRE_FALSE(transaction_request_payload_decode(payload.data(), payload.size(), decoded, error));
+  REQUIRE(error == "Transaction request contains a package spec that is too long.");
+
+  // An unterminated line is rejected once it outgrows the longest spec,
+  // without buffering the rest of the payload.
+  const std::string unterminated =
+      "dnfui-request 1\ninstall\t" + std::string(kTransactionRequestMaxSpecLength * 2, 'x');
+  REQUIRE_FALSE(transaction_request_payload_decode(unterminated.data(), unterminated.size(), decoded, error));
+  REQUIRE(error == "Transaction request contains a package spec that is too long.");
+}
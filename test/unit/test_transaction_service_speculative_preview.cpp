@@ -0,0 +1,81 @@
+// -----------------------------------------------------------------------------
+// test/unit/test_transaction_service_speculative_preview.cpp
+// Background upgrade-all preview cache tests
+// Covers when an upgrade-all resolution prepared while the service was idle is
+// handed to a later request and when it is dropped.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "base_manager.hpp"
+#include "dnf_backend/dnf_backend.hpp"
+#include "service/transaction_service_speculative_preview.hpp"
+#include "test_utils.hpp"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Verify that a cached resolution is handed out once while its Base is current.
+// -----------------------------------------------------------------------------
+TEST_CASE("Speculative upgrade-all preview is handed out once")
+{
+  reset_backend_globals();
+
+  auto installed_rows = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+  REQUIRE_FALSE(installed_rows.empty());
+
+  TransactionPreview preview;
+  std::string error;
+  ResolvedTransactionPtr resolved;
+  bool ok =
+      dnf_backend_preview_transaction({}, {}, { installed_rows.front().nevra }, preview, error, {}, false, &resolved);
+  INFO(error);
+  REQUIRE(ok);
+  REQUIRE(resolved);
+
+  SpeculativeUpgradeAllPreview cache;
+  REQUIRE_FALSE(cache.has_current());
+  cache.store(preview, resolved);
+  REQUIRE(cache.has_current());
+
+  TransactionPreview cached_preview;
+  ResolvedTransactionPtr cached_resolved;
+  REQUIRE(cache.take_if_current(cached_preview, cached_resolved));
+  REQUIRE(cached_resolved == resolved);
+  REQUIRE(cached_preview.reinstall == preview.reinstall);
+
+  cached_resolved.reset();
+  REQUIRE_FALSE(cache.has_current());
+  REQUIRE_FALSE(cache.take_if_current(cached_preview, cached_resolved));
+  REQUIRE_FALSE(cached_resolved);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that a cached resolution is dropped once the Base was rebuilt.
+// -----------------------------------------------------------------------------
+TEST_CASE("Speculative upgrade-all preview is dropped after a Base rebuild")
+{
+  reset_backend_globals();
+
+  auto installed_rows = dnf_backend_get_installed_package_rows_interruptible(nullptr);
+  REQUIRE_FALSE(installed_rows.empty());
+
+  TransactionPreview preview;
+  std::string error;
+  ResolvedTransactionPtr resolved;
+  bool ok =
+      dnf_backend_preview_transaction({}, {}, { installed_rows.front().nevra }, preview, error, {}, false, &resolved);
+  INFO(error);
+  REQUIRE(ok);
+
+  SpeculativeUpgradeAllPreview cache;
+  cache.store(preview, resolved);
+  resolved.reset();
+
+  BaseManager::instance().rebuild_system_only(BaseRebuildPolicy::FORCE);
+  REQUIRE_FALSE(cache.has_current());
+
+  TransactionPreview cached_preview;
+  ResolvedTransactionPtr cached_resolved;
+  REQUIRE_FALSE(cache.take_if_current(cached_preview, cached_resolved));
+  REQUIRE_FALSE(cached_resolved);
+}
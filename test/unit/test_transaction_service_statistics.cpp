@@ -0,0 +1,56 @@
+// -----------------------------------------------------------------------------
+// test/unit/test_transaction_service_statistics.cpp
+// Transaction service statistics tests
+// Covers how stage latencies are bucketed and totalled for GetStatistics.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "service/transaction_service_statistics.hpp"
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+// -----------------------------------------------------------------------------
+// Verify that samples land in the first bucket whose bound is not below them.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction latency histogram buckets samples by upper bound")
+{
+  TransactionLatencyHistogram histogram;
+  histogram.record(10ms);
+  histogram.record(10001us);
+  histogram.record(2min);
+  histogram.record(-5us);
+
+  REQUIRE(histogram.count == 4);
+  REQUIRE(histogram.sum_us == 10000 + 10001 + 120000000);
+  REQUIRE(histogram.max_us == 120000000);
+  REQUIRE(histogram.buckets[0] == 2);
+  REQUIRE(histogram.buckets[1] == 1);
+  REQUIRE(histogram.buckets.back() == 1);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that named histograms are kept apart and copied by snapshot.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction service statistics keep one histogram per name")
+{
+  TransactionServiceStatistics statistics;
+  REQUIRE(statistics.snapshot().empty());
+
+  statistics.record("preview-ready", 300ms);
+  statistics.record("preview-ready", 700ms);
+  {
+    TransactionLatencyTimer timer(statistics, "rebuild");
+  }
+
+  const auto snapshot = statistics.snapshot();
+  REQUIRE(snapshot.size() == 2);
+  REQUIRE(snapshot.at("preview-ready").count == 2);
+  REQUIRE(snapshot.at("preview-ready").sum_us == 1000000);
+  REQUIRE(snapshot.at("rebuild").count == 1);
+
+  statistics.record("rebuild", 1s);
+  REQUIRE(snapshot.at("rebuild").count == 1);
+  REQUIRE(statistics.snapshot().at("rebuild").count == 2);
+}
@@ -0,0 +1,133 @@
+// -----------------------------------------------------------------------------
+// Transaction summary model tests
+// Covers section order and totals, position mapping, and collapsing sections.
+// -----------------------------------------------------------------------------
+#include <catch2/catch_test_macros.hpp>
+
+#include "ui/transaction_summary_model.hpp"
+
+#include <memory>
+#include <string>
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Return the string of the row at one position.
+// -----------------------------------------------------------------------------
+std::string
+text_at(DnfuiTransactionSummaryModel *model, guint position)
+{
+  GtkStringObject *item = GTK_STRING_OBJECT(g_list_model_get_item(G_LIST_MODEL(model), position));
+  std::string text = gtk_string_object_get_string(item);
+  g_object_unref(item);
+  return text;
+}
+
+// -----------------------------------------------------------------------------
+// Build a preview with two upgrades and one removal.
+// -----------------------------------------------------------------------------
+std::shared_ptr<const TransactionPreview>
+make_preview()
+{
+  auto preview = std::make_shared<TransactionPreview>();
+  preview->add_item({ "bash-5.2-1.x86_64", TransactionPreviewAction::UPGRADE, "fedora", 1000, 4000 });
+  preview->add_item({ "remove-me-1-1.noarch", TransactionPreviewAction::REMOVE, "@System", 0, 300 });
+  preview->add_item({ "zsh-5.9-1.x86_64", TransactionPreviewAction::UPGRADE, "updates", 500, 2000 });
+  return preview;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Verify that only non-empty sections appear, in action order, with totals
+// added up from the items.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction summary model builds sections with totals")
+{
+  DnfuiTransactionSummaryModel *model = transaction_summary_model_new(make_preview());
+
+  REQUIRE(transaction_summary_model_get_section_count(model) == 2);
+  const TransactionSummarySection &upgrade = transaction_summary_model_get_section(model, 0);
+  REQUIRE(upgrade.action == TransactionPreviewAction::UPGRADE);
+  REQUIRE(upgrade.count == 2);
+  REQUIRE(upgrade.download_size == 1500);
+  REQUIRE(upgrade.install_size == 6000);
+  const TransactionSummarySection &remove = transaction_summary_model_get_section(model, 1);
+  REQUIRE(remove.action == TransactionPreviewAction::REMOVE);
+  REQUIRE(remove.count == 1);
+  REQUIRE(remove.download_size == 0);
+
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 5);
+  REQUIRE(text_at(model, 0).empty());
+  REQUIRE(text_at(model, 1) == "bash-5.2-1.x86_64");
+  REQUIRE(text_at(model, 2) == "zsh-5.9-1.x86_64");
+  REQUIRE(text_at(model, 4) == "remove-me-1-1.noarch");
+  REQUIRE(g_list_model_get_item(G_LIST_MODEL(model), 5) == nullptr);
+
+  TransactionSummaryRow row;
+  REQUIRE(transaction_summary_model_get_row(model, 3, row));
+  REQUIRE(row.header);
+  REQUIRE(row.section == 1);
+  REQUIRE(transaction_summary_model_get_row(model, 2, row));
+  REQUIRE_FALSE(row.header);
+  REQUIRE(row.section == 0);
+  REQUIRE(row.item == 1);
+  REQUIRE_FALSE(transaction_summary_model_get_row(model, 5, row));
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that collapsing a section keeps its header, shifts the later rows,
+// and announces the change.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction summary model collapses and expands sections")
+{
+  DnfuiTransactionSummaryModel *model = transaction_summary_model_new(make_preview());
+  guint changes = 0;
+  g_signal_connect(
+      model,
+      "items-changed",
+      G_CALLBACK(+[](GListModel *, guint, guint, guint, gpointer count) { ++*static_cast<guint *>(count); }),
+      &changes);
+
+  REQUIRE_FALSE(transaction_summary_model_toggle_header(model, 1));
+  REQUIRE(transaction_summary_model_toggle_header(model, 0));
+  REQUIRE_FALSE(transaction_summary_model_get_section(model, 0).expanded);
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 3);
+  REQUIRE(text_at(model, 2) == "remove-me-1-1.noarch");
+
+  TransactionSummaryRow row;
+  REQUIRE(transaction_summary_model_get_row(model, 1, row));
+  REQUIRE(row.header);
+  REQUIRE(row.section == 1);
+
+  transaction_summary_model_set_expanded(model, 0, false);
+  REQUIRE(changes == 1);
+  transaction_summary_model_set_expanded(model, 0, true);
+  REQUIRE(changes == 2);
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 5);
+  REQUIRE(text_at(model, 1) == "bash-5.2-1.x86_64");
+  g_object_unref(model);
+}
+
+// -----------------------------------------------------------------------------
+// Verify that previews without items, as read through the array fallback,
+// still list their labels with zero sizes.
+// -----------------------------------------------------------------------------
+TEST_CASE("Transaction summary model shows label-only previews")
+{
+  auto preview = std::make_shared<TransactionPreview>();
+  preview->install = { "a-1-1.noarch", "b-1-1.noarch" };
+  DnfuiTransactionSummaryModel *model = transaction_summary_model_new(preview);
+
+  REQUIRE(transaction_summary_model_get_section_count(model) == 1);
+  REQUIRE(transaction_summary_model_get_section(model, 0).count == 2);
+  REQUIRE(transaction_summary_model_get_section(model, 0).download_size == 0);
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(model)) == 3);
+  REQUIRE(text_at(model, 2) == "b-1-1.noarch");
+  g_object_unref(model);
+
+  DnfuiTransactionSummaryModel *empty = transaction_summary_model_new(nullptr);
+  REQUIRE(g_list_model_get_n_items(G_LIST_MODEL(empty)) == 0);
+  g_object_unref(empty);
+}